@@ -113,4 +113,40 @@ ggit_blob_is_binary (GgitBlob *blob)
 	return git_blob_is_binary (_ggit_native_get (blob));
 }
 
+/**
+ * ggit_blob_open_stream:
+ * @blob: a #GgitBlob.
+ *
+ * Opens a seekable stream over the content of @blob. The content is not
+ * copied, the stream keeps a reference on @blob instead.
+ *
+ * A #GgitBlob always holds its whole content in memory, use
+ * ggit_repository_open_blob_stream() to read a large blob without
+ * loading it first.
+ *
+ * Returns: (transfer full): a #GInputStream.
+ *
+ **/
+GInputStream *
+ggit_blob_open_stream (GgitBlob *blob)
+{
+	git_blob *b;
+	GBytes *bytes;
+	GInputStream *stream;
+
+	g_return_val_if_fail (GGIT_IS_BLOB (blob), NULL);
+
+	b = _ggit_native_get (blob);
+
+	bytes = g_bytes_new_with_free_func (git_blob_rawcontent (b),
+	                                    (gsize)git_blob_rawsize (b),
+	                                    g_object_unref,
+	                                    g_object_ref (blob));
+
+	stream = g_memory_input_stream_new_from_bytes (bytes);
+	g_bytes_unref (bytes);
+
+	return stream;
+}
+
 /* ex:set ts=8 noet: */
@@ -23,6 +23,7 @@
 #define __GGIT_BLOB_H__
 
 #include <glib-object.h>
+#include <gio/gio.h>
 #include <git2.h>
 
 #include "ggit-object.h"
@@ -41,6 +42,8 @@ const guchar     *ggit_blob_get_raw_content  (GgitBlob *blob,
 
 gboolean          ggit_blob_is_binary        (GgitBlob *blob);
 
+GInputStream     *ggit_blob_open_stream      (GgitBlob *blob);
+
 G_END_DECLS
 
 #endif /* __GGIT_BLOB_H__ */
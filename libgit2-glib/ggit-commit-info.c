@@ -0,0 +1,708 @@
+/*
+ * ggit-commit-info.c
+ * This file is part of libgit2-glib
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include <git2.h>
+
+#include "ggit-commit-info.h"
+#include "ggit-convert.h"
+#include "ggit-error.h"
+#include "ggit-oid.h"
+
+enum
+{
+	AUTHOR_NAME,
+	AUTHOR_EMAIL,
+	COMMITTER_NAME,
+	COMMITTER_EMAIL,
+	SUBJECT,
+	ENCODING,
+	N_STRINGS
+};
+
+struct _GgitCommitInfo
+{
+	gint ref_count;
+
+	git_oid id;
+	git_oid tree_id;
+
+	guint n_parents;
+	git_oid *parent_ids;
+
+	gint64 author_time;
+	gint64 committer_time;
+	gint author_offset;
+	gint committer_offset;
+
+	/* to the first parent, if computed */
+	gboolean has_diff_stats;
+	gsize files_changed;
+	gsize insertions;
+	gsize deletions;
+
+	/* nul terminated utf-8 strings, one after the other */
+	gchar *strings;
+	guint32 offsets[N_STRINGS];
+};
+
+G_DEFINE_BOXED_TYPE (GgitCommitInfo, ggit_commit_info,
+                     ggit_commit_info_ref, ggit_commit_info_unref)
+
+typedef struct
+{
+	const gchar *name;
+	gsize name_len;
+	const gchar *email;
+	gsize email_len;
+	gint64 time;
+	gint offset;
+} Signature;
+
+static gboolean
+has_header (const gchar *line,
+            const gchar *eol,
+            const gchar *header)
+{
+	gsize len = strlen (header);
+
+	return (gsize)(eol - line) >= len && memcmp (line, header, len) == 0;
+}
+
+static gboolean
+parse_oid (git_oid     *oid,
+           const gchar *str,
+           const gchar *eol)
+{
+	return eol - str >= GIT_OID_HEXSZ &&
+	       git_oid_fromstrn (oid, str, GIT_OID_HEXSZ) == 0;
+}
+
+static const gchar *
+parse_number (const gchar *p,
+              const gchar *eol,
+              gint64      *value)
+{
+	*value = 0;
+
+	while (p < eol && g_ascii_isdigit (*p))
+	{
+		*value = *value * 10 + (*p - '0');
+		++p;
+	}
+
+	return p;
+}
+
+/* "Name <email> time +hhmm", the time being optional */
+static gboolean
+parse_signature (const gchar *line,
+                 const gchar *eol,
+                 Signature   *signature)
+{
+	const gchar *lt;
+	const gchar *gt;
+	const gchar *p;
+	const gchar *name_end;
+	gint64 tz;
+	gint sign = 1;
+
+	for (gt = eol; gt > line && gt[-1] != '>'; --gt);
+	for (lt = gt; lt > line && lt[-1] != '<'; --lt);
+
+	if (gt == line || lt == line)
+	{
+		return FALSE;
+	}
+
+	/* both point one past the bracket */
+	for (name_end = lt - 1; name_end > line && name_end[-1] == ' '; --name_end);
+
+	signature->name = line;
+	signature->name_len = name_end - line;
+	signature->email = lt;
+	signature->email_len = gt - 1 - lt;
+
+	for (p = gt; p < eol && *p == ' '; ++p);
+	p = parse_number (p, eol, &signature->time);
+
+	for (; p < eol && *p == ' '; ++p);
+
+	if (p < eol && (*p == '-' || *p == '+'))
+	{
+		sign = *p == '-' ? -1 : 1;
+		++p;
+	}
+
+	parse_number (p, eol, &tz);
+	signature->offset = sign * (gint)((tz / 100) * 60 + tz % 100);
+
+	return TRUE;
+}
+
+/*
+ * _ggit_commit_info_new:
+ * @id: the id of the commit.
+ * @data: the raw commit object.
+ * @size: the size of @data.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Parses the headers and the subject of a raw commit object.
+ */
+GgitCommitInfo *
+_ggit_commit_info_new (const git_oid  *id,
+                       const gchar    *data,
+                       gsize           size,
+                       GError        **error)
+{
+	GgitCommitInfo *info;
+	GArray *parents;
+	Signature author = { 0 };
+	Signature committer = { 0 };
+	const gchar *encoding = NULL;
+	gsize encoding_len = 0;
+	const gchar *strs[ENCODING];
+	gssize sizes[ENCODING];
+	gchar *converted[ENCODING];
+	gchar *charset;
+	const gchar *p = data;
+	const gchar *end = data + size;
+	const gchar *subject_end;
+	gboolean has_tree = FALSE;
+	gboolean has_author = FALSE;
+	gboolean has_committer = FALSE;
+	GString *strings;
+	gint i;
+
+	info = g_slice_new0 (GgitCommitInfo);
+	info->ref_count = 1;
+	git_oid_cpy (&info->id, id);
+
+	parents = g_array_new (FALSE, FALSE, sizeof (git_oid));
+
+	/* headers up to the first empty line, then the message */
+	while (p < end)
+	{
+		const gchar *eol;
+
+		eol = memchr (p, '\n', end - p);
+
+		if (eol == NULL)
+		{
+			eol = end;
+		}
+
+		if (eol == p)
+		{
+			p = eol + 1;
+			break;
+		}
+
+		if (has_header (p, eol, "tree "))
+		{
+			has_tree = parse_oid (&info->tree_id, p + strlen ("tree "), eol);
+		}
+		else if (has_header (p, eol, "parent "))
+		{
+			git_oid parent;
+
+			if (!parse_oid (&parent, p + strlen ("parent "), eol))
+			{
+				break;
+			}
+
+			g_array_append_val (parents, parent);
+		}
+		else if (has_header (p, eol, "author "))
+		{
+			has_author = parse_signature (p + strlen ("author "), eol, &author);
+		}
+		else if (has_header (p, eol, "committer "))
+		{
+			has_committer = parse_signature (p + strlen ("committer "), eol, &committer);
+		}
+		else if (has_header (p, eol, "encoding "))
+		{
+			encoding = p + strlen ("encoding ");
+			encoding_len = eol - encoding;
+		}
+
+		p = eol + 1;
+	}
+
+	if (!has_tree || !has_author || !has_committer)
+	{
+		gchar hex[GIT_OID_HEXSZ + 1];
+
+		g_set_error (error, GGIT_ERROR, GGIT_ERROR_GIT_ERROR,
+		             "Failed to parse commit %s",
+		             git_oid_tostr (hex, sizeof (hex), id));
+
+		g_array_unref (parents);
+		g_slice_free (GgitCommitInfo, info);
+
+		return NULL;
+	}
+
+	info->n_parents = parents->len;
+	info->parent_ids = (git_oid *)g_array_free (parents, FALSE);
+
+	info->author_time = author.time;
+	info->author_offset = author.offset;
+	info->committer_time = committer.time;
+	info->committer_offset = committer.offset;
+
+	/* the subject is the first line, leading empty lines are skipped */
+	for (p = MIN (p, end); p < end && *p == '\n'; ++p);
+
+	subject_end = memchr (p, '\n', end - p);
+
+	if (subject_end == NULL)
+	{
+		subject_end = end;
+	}
+
+	strs[AUTHOR_NAME] = author.name;
+	sizes[AUTHOR_NAME] = author.name_len;
+	strs[AUTHOR_EMAIL] = author.email;
+	sizes[AUTHOR_EMAIL] = author.email_len;
+	strs[COMMITTER_NAME] = committer.name;
+	sizes[COMMITTER_NAME] = committer.name_len;
+	strs[COMMITTER_EMAIL] = committer.email;
+	sizes[COMMITTER_EMAIL] = committer.email_len;
+	strs[SUBJECT] = p;
+	sizes[SUBJECT] = subject_end - p;
+
+	/* like ggit_commit_get_message_encoding(), assume UTF-8 by default */
+	charset = encoding != NULL ? g_strndup (encoding, encoding_len) : g_strdup ("UTF-8");
+	ggit_convert_utf8_batch (strs, sizes, ENCODING, charset, converted);
+
+	strings = g_string_new (NULL);
+
+	for (i = 0; i < ENCODING; ++i)
+	{
+		info->offsets[i] = strings->len;
+		g_string_append_len (strings, converted[i], strlen (converted[i]) + 1);
+		g_free (converted[i]);
+	}
+
+	info->offsets[ENCODING] = strings->len;
+	g_string_append_len (strings, charset, strlen (charset) + 1);
+	g_free (charset);
+
+	info->strings = g_string_free (strings, FALSE);
+
+	return info;
+}
+
+/*
+ * _ggit_commit_info_read:
+ * @odb: a #git_odb.
+ * @id: the id of a commit.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Reads the commit @id from @odb without parsing it into a #git_commit.
+ */
+GgitCommitInfo *
+_ggit_commit_info_read (git_odb        *odb,
+                        const git_oid  *id,
+                        GError        **error)
+{
+	git_odb_object *obj;
+	GgitCommitInfo *info;
+	gint ret;
+
+	ret = git_odb_read (&obj, odb, id);
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (error, ret);
+		return NULL;
+	}
+
+	if (git_odb_object_type (obj) != GIT_OBJ_COMMIT)
+	{
+		gchar hex[GIT_OID_HEXSZ + 1];
+
+		g_set_error (error, GGIT_ERROR, GGIT_ERROR_NOTFOUND,
+		             "Object %s is not a commit",
+		             git_oid_tostr (hex, sizeof (hex), id));
+
+		git_odb_object_free (obj);
+		return NULL;
+	}
+
+	info = _ggit_commit_info_new (id,
+	                              git_odb_object_data (obj),
+	                              git_odb_object_size (obj),
+	                              error);
+
+	git_odb_object_free (obj);
+
+	return info;
+}
+
+/**
+ * ggit_commit_info_ref:
+ * @info: a #GgitCommitInfo.
+ *
+ * Atomically increments the reference count of @info by one.
+ * This function is MT-safe and may be called from any thread.
+ *
+ * Returns: (transfer none) (nullable): a #GgitCommitInfo or %NULL.
+ **/
+GgitCommitInfo *
+ggit_commit_info_ref (GgitCommitInfo *info)
+{
+	g_return_val_if_fail (info != NULL, NULL);
+
+	g_atomic_int_inc (&info->ref_count);
+
+	return info;
+}
+
+/**
+ * ggit_commit_info_unref:
+ * @info: a #GgitCommitInfo.
+ *
+ * Atomically decrements the reference count of @info by one.
+ * If the reference count drops to 0, @info is freed.
+ **/
+void
+ggit_commit_info_unref (GgitCommitInfo *info)
+{
+	g_return_if_fail (info != NULL);
+
+	if (g_atomic_int_dec_and_test (&info->ref_count))
+	{
+		g_free (info->parent_ids);
+		g_free (info->strings);
+
+		g_slice_free (GgitCommitInfo, info);
+	}
+}
+
+const git_oid *
+_ggit_commit_info_get_id (GgitCommitInfo *info)
+{
+	return &info->id;
+}
+
+const git_oid *
+_ggit_commit_info_get_tree_id (GgitCommitInfo *info)
+{
+	return &info->tree_id;
+}
+
+const git_oid *
+_ggit_commit_info_get_parent_id (GgitCommitInfo *info,
+                                 guint           idx)
+{
+	return idx < info->n_parents ? &info->parent_ids[idx] : NULL;
+}
+
+/**
+ * ggit_commit_info_get_id:
+ * @info: a #GgitCommitInfo.
+ *
+ * Gets the id of the commit.
+ *
+ * Returns: (transfer full) (nullable): the id of the commit.
+ */
+GgitOId *
+ggit_commit_info_get_id (GgitCommitInfo *info)
+{
+	g_return_val_if_fail (info != NULL, NULL);
+
+	return _ggit_oid_wrap (&info->id);
+}
+
+/**
+ * ggit_commit_info_get_tree_id:
+ * @info: a #GgitCommitInfo.
+ *
+ * Gets the id of the tree of the commit.
+ *
+ * Returns: (transfer full) (nullable): the id of the tree.
+ */
+GgitOId *
+ggit_commit_info_get_tree_id (GgitCommitInfo *info)
+{
+	g_return_val_if_fail (info != NULL, NULL);
+
+	return _ggit_oid_wrap (&info->tree_id);
+}
+
+/**
+ * ggit_commit_info_get_n_parents:
+ * @info: a #GgitCommitInfo.
+ *
+ * Gets the number of parents of the commit.
+ *
+ * Returns: the number of parents.
+ */
+guint
+ggit_commit_info_get_n_parents (GgitCommitInfo *info)
+{
+	g_return_val_if_fail (info != NULL, 0);
+
+	return info->n_parents;
+}
+
+/**
+ * ggit_commit_info_get_parent_id:
+ * @info: a #GgitCommitInfo.
+ * @idx: the index of the parent.
+ *
+ * Gets the id of the @idx'th parent of the commit.
+ *
+ * Returns: (transfer full) (nullable): the id of the parent, or %NULL if
+ *          @idx is out of range.
+ */
+GgitOId *
+ggit_commit_info_get_parent_id (GgitCommitInfo *info,
+                                guint           idx)
+{
+	g_return_val_if_fail (info != NULL, NULL);
+
+	if (idx >= info->n_parents)
+	{
+		return NULL;
+	}
+
+	return _ggit_oid_wrap (&info->parent_ids[idx]);
+}
+
+/**
+ * ggit_commit_info_get_author_name:
+ * @info: a #GgitCommitInfo.
+ *
+ * Gets the name of the author of the commit, encoded in UTF-8.
+ *
+ * Returns: (transfer none): the name of the author.
+ */
+const gchar *
+ggit_commit_info_get_author_name (GgitCommitInfo *info)
+{
+	g_return_val_if_fail (info != NULL, NULL);
+
+	return info->strings + info->offsets[AUTHOR_NAME];
+}
+
+/**
+ * ggit_commit_info_get_author_email:
+ * @info: a #GgitCommitInfo.
+ *
+ * Gets the email of the author of the commit, encoded in UTF-8.
+ *
+ * Returns: (transfer none): the email of the author.
+ */
+const gchar *
+ggit_commit_info_get_author_email (GgitCommitInfo *info)
+{
+	g_return_val_if_fail (info != NULL, NULL);
+
+	return info->strings + info->offsets[AUTHOR_EMAIL];
+}
+
+/**
+ * ggit_commit_info_get_author_time:
+ * @info: a #GgitCommitInfo.
+ *
+ * Gets the time the commit was authored, in seconds since the epoch.
+ *
+ * Returns: the author time.
+ */
+gint64
+ggit_commit_info_get_author_time (GgitCommitInfo *info)
+{
+	g_return_val_if_fail (info != NULL, 0);
+
+	return info->author_time;
+}
+
+/**
+ * ggit_commit_info_get_author_utc_offset:
+ * @info: a #GgitCommitInfo.
+ *
+ * Gets the timezone of the author time, as an offset from UTC in minutes.
+ *
+ * Returns: the offset in minutes.
+ */
+gint
+ggit_commit_info_get_author_utc_offset (GgitCommitInfo *info)
+{
+	g_return_val_if_fail (info != NULL, 0);
+
+	return info->author_offset;
+}
+
+/**
+ * ggit_commit_info_get_committer_name:
+ * @info: a #GgitCommitInfo.
+ *
+ * Gets the name of the committer of the commit, encoded in UTF-8.
+ *
+ * Returns: (transfer none): the name of the committer.
+ */
+const gchar *
+ggit_commit_info_get_committer_name (GgitCommitInfo *info)
+{
+	g_return_val_if_fail (info != NULL, NULL);
+
+	return info->strings + info->offsets[COMMITTER_NAME];
+}
+
+/**
+ * ggit_commit_info_get_committer_email:
+ * @info: a #GgitCommitInfo.
+ *
+ * Gets the email of the committer of the commit, encoded in UTF-8.
+ *
+ * Returns: (transfer none): the email of the committer.
+ */
+const gchar *
+ggit_commit_info_get_committer_email (GgitCommitInfo *info)
+{
+	g_return_val_if_fail (info != NULL, NULL);
+
+	return info->strings + info->offsets[COMMITTER_EMAIL];
+}
+
+/**
+ * ggit_commit_info_get_committer_time:
+ * @info: a #GgitCommitInfo.
+ *
+ * Gets the time the commit was committed, in seconds since the epoch.
+ *
+ * Returns: the committer time.
+ */
+gint64
+ggit_commit_info_get_committer_time (GgitCommitInfo *info)
+{
+	g_return_val_if_fail (info != NULL, 0);
+
+	return info->committer_time;
+}
+
+/**
+ * ggit_commit_info_get_committer_utc_offset:
+ * @info: a #GgitCommitInfo.
+ *
+ * Gets the timezone of the committer time, as an offset from UTC in
+ * minutes.
+ *
+ * Returns: the offset in minutes.
+ */
+gint
+ggit_commit_info_get_committer_utc_offset (GgitCommitInfo *info)
+{
+	g_return_val_if_fail (info != NULL, 0);
+
+	return info->committer_offset;
+}
+
+/**
+ * ggit_commit_info_get_subject:
+ * @info: a #GgitCommitInfo.
+ *
+ * Gets the subject of the commit, the first line of its message, encoded
+ * in UTF-8. See ggit_commit_get_subject().
+ *
+ * Returns: (transfer none): the subject of the commit.
+ */
+const gchar *
+ggit_commit_info_get_subject (GgitCommitInfo *info)
+{
+	g_return_val_if_fail (info != NULL, NULL);
+
+	return info->strings + info->offsets[SUBJECT];
+}
+
+/**
+ * ggit_commit_info_get_message_encoding:
+ * @info: a #GgitCommitInfo.
+ *
+ * Gets the encoding of the message of the commit. When the commit has no
+ * encoding header, UTF-8 is assumed, see
+ * ggit_commit_get_message_encoding().
+ *
+ * Returns: (transfer none): the encoding of the commit message.
+ */
+const gchar *
+ggit_commit_info_get_message_encoding (GgitCommitInfo *info)
+{
+	g_return_val_if_fail (info != NULL, NULL);
+
+	return info->strings + info->offsets[ENCODING];
+}
+
+void
+_ggit_commit_info_set_diff_stats (GgitCommitInfo *info,
+                                  gsize           files_changed,
+                                  gsize           insertions,
+                                  gsize           deletions)
+{
+	info->has_diff_stats = TRUE;
+	info->files_changed = files_changed;
+	info->insertions = insertions;
+	info->deletions = deletions;
+}
+
+/**
+ * ggit_commit_info_get_diff_stats:
+ * @info: a #GgitCommitInfo.
+ * @files_changed: (out) (optional): return location for the number of
+ *                 changed files, or %NULL.
+ * @insertions: (out) (optional): return location for the number of
+ *              inserted lines, or %NULL.
+ * @deletions: (out) (optional): return location for the number of deleted
+ *             lines, or %NULL.
+ *
+ * Gets the statistics of the diff between the commit and its first parent,
+ * when they were computed along with @info, see #GgitLogPipeline.
+ *
+ * Returns: %TRUE if the statistics are known, %FALSE otherwise.
+ */
+gboolean
+ggit_commit_info_get_diff_stats (GgitCommitInfo *info,
+                                 gsize          *files_changed,
+                                 gsize          *insertions,
+                                 gsize          *deletions)
+{
+	g_return_val_if_fail (info != NULL, FALSE);
+
+	if (files_changed != NULL)
+	{
+		*files_changed = info->files_changed;
+	}
+
+	if (insertions != NULL)
+	{
+		*insertions = info->insertions;
+	}
+
+	if (deletions != NULL)
+	{
+		*deletions = info->deletions;
+	}
+
+	return info->has_diff_stats;
+}
+
+/* ex:set ts=8 noet: */
@@ -0,0 +1,88 @@
+/*
+ * ggit-commit-info.h
+ * This file is part of libgit2-glib
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GGIT_COMMIT_INFO_H__
+#define __GGIT_COMMIT_INFO_H__
+
+#include <glib-object.h>
+#include <git2.h>
+
+#include <libgit2-glib/ggit-types.h>
+
+G_BEGIN_DECLS
+
+#define GGIT_TYPE_COMMIT_INFO       (ggit_commit_info_get_type ())
+#define GGIT_COMMIT_INFO(obj)       ((GgitCommitInfo *)obj)
+
+GType            ggit_commit_info_get_type               (void) G_GNUC_CONST;
+
+GgitCommitInfo  *_ggit_commit_info_new                   (const git_oid   *id,
+                                                          const gchar     *data,
+                                                          gsize            size,
+                                                          GError         **error);
+
+GgitCommitInfo  *_ggit_commit_info_read                  (git_odb         *odb,
+                                                          const git_oid   *id,
+                                                          GError         **error);
+
+GgitCommitInfo  *ggit_commit_info_ref                    (GgitCommitInfo  *info);
+void             ggit_commit_info_unref                  (GgitCommitInfo  *info);
+
+const git_oid   *_ggit_commit_info_get_id                (GgitCommitInfo  *info);
+const git_oid   *_ggit_commit_info_get_tree_id           (GgitCommitInfo  *info);
+const git_oid   *_ggit_commit_info_get_parent_id         (GgitCommitInfo  *info,
+                                                          guint            idx);
+
+GgitOId         *ggit_commit_info_get_id                 (GgitCommitInfo  *info);
+GgitOId         *ggit_commit_info_get_tree_id            (GgitCommitInfo  *info);
+
+guint            ggit_commit_info_get_n_parents          (GgitCommitInfo  *info);
+GgitOId         *ggit_commit_info_get_parent_id          (GgitCommitInfo  *info,
+                                                          guint            idx);
+
+const gchar     *ggit_commit_info_get_author_name        (GgitCommitInfo  *info);
+const gchar     *ggit_commit_info_get_author_email       (GgitCommitInfo  *info);
+gint64           ggit_commit_info_get_author_time        (GgitCommitInfo  *info);
+gint             ggit_commit_info_get_author_utc_offset  (GgitCommitInfo  *info);
+
+const gchar     *ggit_commit_info_get_committer_name     (GgitCommitInfo  *info);
+const gchar     *ggit_commit_info_get_committer_email    (GgitCommitInfo  *info);
+gint64           ggit_commit_info_get_committer_time     (GgitCommitInfo  *info);
+gint             ggit_commit_info_get_committer_utc_offset
+                                                         (GgitCommitInfo  *info);
+
+const gchar     *ggit_commit_info_get_subject            (GgitCommitInfo  *info);
+const gchar     *ggit_commit_info_get_message_encoding   (GgitCommitInfo  *info);
+
+void             _ggit_commit_info_set_diff_stats        (GgitCommitInfo  *info,
+                                                          gsize            files_changed,
+                                                          gsize            insertions,
+                                                          gsize            deletions);
+
+gboolean         ggit_commit_info_get_diff_stats         (GgitCommitInfo  *info,
+                                                          gsize           *files_changed,
+                                                          gsize           *insertions,
+                                                          gsize           *deletions);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (GgitCommitInfo, ggit_commit_info_unref)
+
+G_END_DECLS
+
+#endif /* __GGIT_COMMIT_INFO_H__ */
+
+/* ex:set ts=8 noet: */
@@ -21,6 +21,134 @@
 #include "ggit-convert.h"
 #include <string.h>
 
+/* An iconv descriptor to UTF-8, opened once per thread and charset since
+ * opening a descriptor is much more expensive than most conversions.
+ */
+typedef struct
+{
+	GIConv cd;
+	gboolean ascii_compatible;
+} Converter;
+
+static void
+converter_free (Converter *converter)
+{
+	if (converter->cd != (GIConv)-1)
+	{
+		g_iconv_close (converter->cd);
+	}
+
+	g_slice_free (Converter, converter);
+}
+
+static GPrivate converters = G_PRIVATE_INIT ((GDestroyNotify)g_hash_table_unref);
+
+static gchar *
+convert_with (Converter   *converter,
+              const gchar *str,
+              gsize        size,
+              gsize       *read,
+              gsize       *written)
+{
+	/* a previous failed conversion may have left a shift state behind */
+	g_iconv (converter->cd, NULL, NULL, NULL, NULL);
+
+	return g_convert_with_iconv (str, size, converter->cd, read, written, NULL);
+}
+
+static gboolean
+is_ascii_compatible (Converter *converter)
+{
+	gchar probe[127];
+	gchar *ret;
+	gsize written;
+	gboolean compatible;
+	gint i;
+
+	for (i = 0; i < (gint)sizeof (probe); ++i)
+	{
+		probe[i] = (gchar)(i + 1);
+	}
+
+	ret = convert_with (converter, probe, sizeof (probe), NULL, &written);
+
+	compatible = ret != NULL &&
+	             written == sizeof (probe) &&
+	             memcmp (ret, probe, sizeof (probe)) == 0;
+
+	g_free (ret);
+
+	return compatible;
+}
+
+/* Returns %NULL if @charset is not supported */
+static Converter *
+get_converter (const gchar *charset)
+{
+	GHashTable *table;
+	Converter *converter;
+
+	table = g_private_get (&converters);
+
+	if (table == NULL)
+	{
+		table = g_hash_table_new_full (g_str_hash,
+		                               g_str_equal,
+		                               g_free,
+		                               (GDestroyNotify)converter_free);
+
+		g_private_set (&converters, table);
+	}
+
+	converter = g_hash_table_lookup (table, charset);
+
+	if (converter == NULL)
+	{
+		converter = g_slice_new0 (Converter);
+		converter->cd = g_iconv_open ("UTF-8", charset);
+
+		if (converter->cd != (GIConv)-1)
+		{
+			converter->ascii_compatible = is_ascii_compatible (converter);
+		}
+
+		g_hash_table_insert (table, g_strdup (charset), converter);
+	}
+
+	return converter->cd != (GIConv)-1 ? converter : NULL;
+}
+
+/* Returns the length of the leading run of non NUL ASCII characters */
+static gsize
+ascii_prefix_length (const gchar *str,
+                     gsize        size)
+{
+	const guchar *p = (const guchar *)str;
+	gsize i = 0;
+
+	/* eight bytes at a time: stop at a word with a high bit or a NUL */
+	for (; i + sizeof (guint64) <= size; i += sizeof (guint64))
+	{
+		const guint64 ones = G_GUINT64_CONSTANT (0x0101010101010101);
+		const guint64 highs = G_GUINT64_CONSTANT (0x8080808080808080);
+		guint64 word;
+
+		memcpy (&word, p + i, sizeof (word));
+
+		if (((word | ((word - ones) & ~word)) & highs) != 0)
+		{
+			break;
+		}
+	}
+
+	while (i < size && p[i] != 0 && p[i] < 0x80)
+	{
+		++i;
+	}
+
+	return i;
+}
+
 static void
 utf8_validate_fallback (gchar  *text,
                         gssize  size)
@@ -29,58 +157,50 @@ utf8_validate_fallback (gchar  *text,
 
 	while (!g_utf8_validate (text, size, &end))
 	{
-		*((gchar *)end) = '?';
+		size -= end - text;
+		text = (gchar *)end;
+
+		*text = '?';
 	}
 }
 
 static gchar *
 convert_fallback (gchar const *text,
-                  gssize       size,
+                  gsize        size,
                   gchar const *fallback)
 {
-	gchar *res;
-	gsize read, written;
-	GString *str = g_string_new ("");
+	GString *str;
+	gsize i;
 
-	while ((res = g_convert (text,
-	                         size,
-	                         "UTF-8",
-	                         "ASCII",
-	                         &read,
-	                         &written,
-	                         NULL)) == NULL)
-	{
-		res = g_convert (text, read, "UTF-8", "ASCII", NULL, NULL, NULL);
-		str = g_string_append (str, res);
+	str = g_string_sized_new (size);
 
-		str = g_string_append (str, fallback);
-		text = text + read + 1;
-		size = size - read;
+	/* keep the ASCII characters, replace everything else */
+	for (i = 0; i < size; ++i)
+	{
+		if ((guchar)text[i] < 0x80)
+		{
+			g_string_append_c (str, text[i]);
+		}
+		else
+		{
+			g_string_append (str, fallback);
+		}
 	}
 
-	str = g_string_append (str, res);
-	g_free (res);
-
 	utf8_validate_fallback (str->str, str->len);
 	return g_string_free (str, FALSE);
 }
 
 static gboolean
-convert_and_check (const gchar  *str,
-                   gssize        size,
-                   const gchar  *from_charset,
+convert_and_check (Converter    *converter,
+                   const gchar  *str,
+                   gsize         size,
                    gchar       **ret)
 {
 	gsize read;
 	gsize written;
 
-	*ret = g_convert (str,
-	                  size,
-	                  "UTF-8",
-	                  from_charset,
-	                  &read,
-	                  &written,
-	                  NULL);
+	*ret = convert_with (converter, str, size, &read, &written);
 
 	if (*ret && read == size)
 	{
@@ -95,6 +215,60 @@ convert_and_check (const gchar  *str,
 
 }
 
+static gchar *
+convert_utf8 (const gchar *str,
+              gssize       size,
+              const gchar *from_charset,
+              Converter   *from,
+              Converter   *locale)
+{
+	gboolean from_utf8;
+	gsize ascii;
+	gchar *ret;
+
+	if (size == -1)
+	{
+		size = strlen (str);
+	}
+
+	from_utf8 = from_charset != NULL &&
+	            g_ascii_strcasecmp (from_charset, "UTF-8") == 0;
+
+	ascii = ascii_prefix_length (str, size);
+
+	if (ascii == (gsize)size &&
+	    (from_charset == NULL || from_utf8 || from == NULL || from->ascii_compatible))
+	{
+		return g_strndup (str, size);
+	}
+
+	if (from_charset == NULL)
+	{
+		if (g_utf8_validate (str + ascii, size - ascii, NULL))
+		{
+			return g_strndup (str, size);
+		}
+	}
+	else if (from_utf8)
+	{
+		ret = g_strndup (str, size);
+		utf8_validate_fallback (ret, size);
+
+		return ret;
+	}
+	else if (from != NULL && convert_and_check (from, str, size, &ret))
+	{
+		return ret;
+	}
+
+	if (locale != NULL && convert_and_check (locale, str, size, &ret))
+	{
+		return ret;
+	}
+
+	return convert_fallback (str, size, "?");
+}
+
 /**
  * ggit_convert_utf8:
  * @str: (array length=size): string to convert to utf-8.
@@ -110,49 +284,56 @@ ggit_convert_utf8 (const gchar *str,
                    gssize       size,
                    const gchar *from_charset)
 {
-	const gchar *locale_charset;
-
-	if (size == -1)
-	{
-		size = strlen (str);
-	}
+	gchar *ret;
 
-	if (from_charset == NULL)
-	{
-		if (g_utf8_validate (str, size, NULL))
-		{
-			return g_strndup (str, size);
-		}
-	}
+	ggit_convert_utf8_batch (&str, &size, 1, from_charset, &ret);
 
-	if (from_charset != NULL)
-	{
-		gchar *ret;
+	return ret;
+}
 
-		if (g_ascii_strcasecmp (from_charset, "UTF-8") == 0)
-		{
-			ret = g_strndup (str, size);
-			utf8_validate_fallback (ret, size);
+/**
+ * ggit_convert_utf8_batch:
+ * @strs: (array length=n_strs): the strings to convert to utf-8.
+ * @sizes: (array length=n_strs) (allow-none): the size of each string of
+ *         @strs, or %NULL if they are all nul terminated.
+ * @n_strs: the number of strings in @strs.
+ * @from_charset: the charset the strings are currently in.
+ * @results: (array length=n_strs) (out caller-allocates): return location
+ *           for the utf-8 representation of each string of @strs.
+ *
+ * Converts each string of @strs like ggit_convert_utf8() does, looking up
+ * the conversions for @from_charset only once.
+ */
+void
+ggit_convert_utf8_batch (const gchar * const *strs,
+                         const gssize        *sizes,
+                         gsize                n_strs,
+                         const gchar         *from_charset,
+                         gchar              **results)
+{
+	const gchar *locale_charset;
+	Converter *from = NULL;
+	Converter *locale = NULL;
+	gsize i;
 
-			return ret;
-		}
-		else if (convert_and_check (str, size, from_charset, &ret))
-		{
-			return ret;
-		}
+	if (from_charset != NULL && g_ascii_strcasecmp (from_charset, "UTF-8") != 0)
+	{
+		from = get_converter (from_charset);
 	}
 
 	if (!g_get_charset (&locale_charset))
 	{
-		gchar *ret;
-
-		if (convert_and_check (str, size, locale_charset, &ret))
-		{
-			return ret;
-		}
+		locale = get_converter (locale_charset);
 	}
 
-	return convert_fallback (str, size, "?");
+	for (i = 0; i < n_strs; ++i)
+	{
+		results[i] = convert_utf8 (strs[i],
+		                           sizes != NULL ? sizes[i] : -1,
+		                           from_charset,
+		                           from,
+		                           locale);
+	}
 }
 
 /* ex:set ts=8 noet: */
@@ -25,9 +25,15 @@
 
 G_BEGIN_DECLS
 
-gchar *ggit_convert_utf8 (const gchar *str,
-                          gssize       size,
-                          const gchar *from_charset);
+gchar *ggit_convert_utf8       (const gchar         *str,
+                                gssize               size,
+                                const gchar         *from_charset);
+
+void   ggit_convert_utf8_batch (const gchar * const *strs,
+                                const gssize        *sizes,
+                                gsize                n_strs,
+                                const gchar         *from_charset,
+                                gchar              **results);
 
 G_END_DECLS
 
@@ -32,37 +32,148 @@ struct _GgitDiffLine {
 	gint new_lineno;
 	gint num_lines;
 	gint64 content_offset;
-	GBytes *content;
+
+	/* points either into memory kept alive by owner (or by the caller
+	 * for the duration of a callback), or into content_bytes.
+	 */
+	const guint8 *content;
+	gsize content_len;
+	GBytes *content_bytes;
+
+	gpointer owner;
+	GDestroyNotify owner_destroy;
 
 	gchar *text;
-	gchar *encoding;
+
+	/* interned */
+	const gchar *encoding;
 };
 
 G_DEFINE_BOXED_TYPE (GgitDiffLine, ggit_diff_line,
                      ggit_diff_line_ref, ggit_diff_line_unref)
 
+static void
+diff_line_set (GgitDiffLine        *gline,
+               const git_diff_line *line,
+               const gchar         *encoding)
+{
+	gline->origin = (GgitDiffLineType)line->origin;
+	gline->old_lineno = line->old_lineno;
+	gline->new_lineno = line->new_lineno;
+	gline->content_offset = line->content_offset;
+	gline->content = (const guint8 *)line->content;
+	gline->content_len = line->content_len;
+	gline->encoding = encoding;
+}
 
+/*
+ * _ggit_diff_line_wrap_borrowed:
+ * @line: a #git_diff_line.
+ * @encoding: (allow-none): an interned encoding, or %NULL.
+ * @owner: (allow-none): the owner of the memory of @line, or %NULL.
+ * @owner_destroy: (allow-none): called to release @owner.
+ *
+ * Wraps @line without copying its content. The content stays valid until
+ * @owner is released. When @owner is %NULL, the caller is responsible for
+ * keeping the content alive, or calling _ggit_diff_line_detach() before it
+ * goes away.
+ */
 GgitDiffLine *
-_ggit_diff_line_wrap (const git_diff_line *line,
-                      const gchar         *encoding)
+_ggit_diff_line_wrap_borrowed (const git_diff_line *line,
+                               const gchar         *encoding,
+                               gpointer             owner,
+                               GDestroyNotify       owner_destroy)
 {
 	GgitDiffLine *gline;
 
 	g_return_val_if_fail (line != NULL, NULL);
 
-	gline = g_slice_new (GgitDiffLine);
+	gline = g_slice_new0 (GgitDiffLine);
 	gline->ref_count = 1;
-	gline->origin = (GgitDiffLineType)line->origin;
-	gline->old_lineno = line->old_lineno;
-	gline->new_lineno = line->new_lineno;
-	gline->content_offset = line->content_offset;
-	gline->content = g_bytes_new (line->content, line->content_len);
-	gline->encoding = g_strdup (encoding);
-	gline->text = NULL;
+	gline->owner = owner;
+	gline->owner_destroy = owner_destroy;
+
+	diff_line_set (gline, line, encoding);
+
+	return gline;
+}
+
+GgitDiffLine *
+_ggit_diff_line_wrap (const git_diff_line *line,
+                      const gchar         *encoding)
+{
+	GgitDiffLine *gline;
+
+	gline = _ggit_diff_line_wrap_borrowed (line, encoding, NULL, NULL);
+
+	if (gline != NULL)
+	{
+		_ggit_diff_line_detach (gline);
+	}
 
 	return gline;
 }
 
+/*
+ * _ggit_diff_line_set_borrowed:
+ * @gline: a #GgitDiffLine created by _ggit_diff_line_wrap_borrowed() without
+ *         an owner, that is not referenced by anyone else.
+ * @line: a #git_diff_line.
+ * @encoding: (allow-none): an interned encoding, or %NULL.
+ *
+ * Points @gline at @line, so that a single #GgitDiffLine can be reused
+ * for all the line callbacks of a diff.
+ */
+void
+_ggit_diff_line_set_borrowed (GgitDiffLine        *gline,
+                              const git_diff_line *line,
+                              const gchar         *encoding)
+{
+	g_return_if_fail (gline != NULL);
+	g_return_if_fail (line != NULL);
+	g_return_if_fail (gline->owner == NULL);
+
+	g_clear_pointer (&gline->content_bytes, g_bytes_unref);
+	g_clear_pointer (&gline->text, g_free);
+
+	diff_line_set (gline, line, encoding);
+}
+
+/*
+ * _ggit_diff_line_is_shared:
+ * @gline: a #GgitDiffLine.
+ *
+ * Returns: %TRUE if somebody else holds a reference to @gline.
+ */
+gboolean
+_ggit_diff_line_is_shared (GgitDiffLine *gline)
+{
+	g_return_val_if_fail (gline != NULL, FALSE);
+
+	return g_atomic_int_get (&gline->ref_count) > 1;
+}
+
+/*
+ * _ggit_diff_line_detach:
+ * @gline: a #GgitDiffLine.
+ *
+ * Copies borrowed content into @gline, so that it no longer depends on the
+ * memory it was created from.
+ */
+void
+_ggit_diff_line_detach (GgitDiffLine *gline)
+{
+	g_return_if_fail (gline != NULL);
+
+	if (gline->content_bytes != NULL || gline->owner != NULL)
+	{
+		return;
+	}
+
+	gline->content_bytes = g_bytes_new (gline->content, gline->content_len);
+	gline->content = g_bytes_get_data (gline->content_bytes, NULL);
+}
+
 /**
  * ggit_diff_line_ref:
  * @line: a #GgitDiffLine.
@@ -96,7 +207,16 @@ ggit_diff_line_unref (GgitDiffLine *line)
 
 	if (g_atomic_int_dec_and_test (&line->ref_count))
 	{
-		g_bytes_unref (line->content);
+		if (line->content_bytes != NULL)
+		{
+			g_bytes_unref (line->content_bytes);
+		}
+
+		if (line->owner_destroy != NULL)
+		{
+			line->owner_destroy (line->owner);
+		}
+
 		g_free (line->text);
 		g_slice_free (GgitDiffLine, line);
 	}
@@ -183,10 +303,10 @@ ggit_diff_line_get_content (GgitDiffLine *line,
 
 	if (length)
 	{
-		*length = g_bytes_get_size (line->content);
+		*length = line->content_len;
 	}
 
-	return g_bytes_get_data (line->content, NULL);
+	return line->content;
 }
 
 /**
@@ -205,12 +325,8 @@ ggit_diff_line_get_text (GgitDiffLine *line)
 
 	if (line->text == NULL)
 	{
-		const gchar *content;
-		gsize content_len;
-
-		content = g_bytes_get_data (line->content, &content_len);
-		line->text = ggit_convert_utf8 (content,
-		                                content_len,
+		line->text = ggit_convert_utf8 ((const gchar *)line->content,
+		                                line->content_len,
 		                                line->encoding);
 	}
 
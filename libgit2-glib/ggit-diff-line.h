@@ -35,6 +35,19 @@ GType             ggit_diff_line_get_type           (void) G_GNUC_CONST;
 GgitDiffLine     *_ggit_diff_line_wrap              (const git_diff_line *line,
                                                      const gchar         *encoding);
 
+GgitDiffLine     *_ggit_diff_line_wrap_borrowed     (const git_diff_line *line,
+                                                     const gchar         *encoding,
+                                                     gpointer             owner,
+                                                     GDestroyNotify       owner_destroy);
+
+void              _ggit_diff_line_set_borrowed      (GgitDiffLine        *gline,
+                                                     const git_diff_line *line,
+                                                     const gchar         *encoding);
+
+gboolean          _ggit_diff_line_is_shared         (GgitDiffLine        *gline);
+
+void              _ggit_diff_line_detach            (GgitDiffLine        *gline);
+
 GgitDiffLine     *ggit_diff_line_ref                (GgitDiffLine        *line);
 void              ggit_diff_line_unref              (GgitDiffLine        *line);
 
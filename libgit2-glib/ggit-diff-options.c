@@ -38,6 +38,8 @@ typedef struct _GgitDiffOptionsPrivate
 	gchar *new_prefix;
 
 	gchar **pathspec;
+
+	guint detect_encoding : 1;
 } GgitDiffOptionsPrivate;
 
 G_DEFINE_TYPE_WITH_PRIVATE (GgitDiffOptions, ggit_diff_options, G_TYPE_OBJECT)
@@ -50,7 +52,8 @@ enum
 	PROP_N_INTERHUNK_LINES,
 	PROP_OLD_PREFIX,
 	PROP_NEW_PREFIX,
-	PROP_PATHSPEC
+	PROP_PATHSPEC,
+	PROP_DETECT_ENCODING
 };
 
 static void
@@ -102,6 +105,9 @@ ggit_diff_options_set_property (GObject      *object,
 		ggit_diff_options_set_pathspec (options,
 		                                g_value_get_boxed (value));
 		break;
+	case PROP_DETECT_ENCODING:
+		priv->detect_encoding = g_value_get_boolean (value);
+		break;
 	default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
 		break;
@@ -139,6 +145,9 @@ ggit_diff_options_get_property (GObject    *object,
 	case PROP_PATHSPEC:
 		g_value_set_boxed (value, priv->pathspec);
 		break;
+	case PROP_DETECT_ENCODING:
+		g_value_set_boolean (value, priv->detect_encoding);
+		break;
 	default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
 		break;
@@ -224,6 +233,23 @@ ggit_diff_options_class_init (GgitDiffOptionsClass *klass)
 	                                                     G_PARAM_READWRITE |
 	                                                     G_PARAM_CONSTRUCT |
 	                                                     G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GgitDiffOptions:detect-encoding:
+	 *
+	 * Whether the encoding of the diffed files is looked up from the
+	 * "encoding" attribute and the gui.encoding setting. When disabled,
+	 * the lines of the diff are reported as raw bytes without an encoding.
+	 */
+	g_object_class_install_property (object_class,
+	                                 PROP_DETECT_ENCODING,
+	                                 g_param_spec_boolean ("detect-encoding",
+	                                                       "Detect Encoding",
+	                                                       "Detect encoding",
+	                                                       TRUE,
+	                                                       G_PARAM_READWRITE |
+	                                                       G_PARAM_CONSTRUCT |
+	                                                       G_PARAM_STATIC_STRINGS));
 }
 
 static void
@@ -545,4 +571,50 @@ ggit_diff_options_set_pathspec (GgitDiffOptions  *options,
 	g_object_notify (G_OBJECT (options), "pathspec");
 }
 
+/**
+ * ggit_diff_options_get_detect_encoding:
+ * @options: a #GgitDiffOptions.
+ *
+ * Get whether the encoding of the diffed files is detected.
+ *
+ * Returns: %TRUE if the encoding is detected, %FALSE otherwise.
+ *
+ **/
+gboolean
+ggit_diff_options_get_detect_encoding (GgitDiffOptions *options)
+{
+	GgitDiffOptionsPrivate *priv;
+
+	g_return_val_if_fail (GGIT_IS_DIFF_OPTIONS (options), TRUE);
+
+	priv = ggit_diff_options_get_instance_private (options);
+
+	return priv->detect_encoding;
+}
+
+/**
+ * ggit_diff_options_set_detect_encoding:
+ * @options: a #GgitDiffOptions.
+ * @detect_encoding: whether to detect the encoding.
+ *
+ * Set whether the encoding of the diffed files is looked up from the
+ * "encoding" attribute and the gui.encoding setting. Callers that only
+ * want the raw bytes of the diff can disable this to avoid resolving
+ * attributes for every file.
+ *
+ **/
+void
+ggit_diff_options_set_detect_encoding (GgitDiffOptions *options,
+                                       gboolean         detect_encoding)
+{
+	GgitDiffOptionsPrivate *priv;
+
+	g_return_if_fail (GGIT_IS_DIFF_OPTIONS (options));
+
+	priv = ggit_diff_options_get_instance_private (options);
+
+	priv->detect_encoding = detect_encoding ? 1 : 0;
+	g_object_notify (G_OBJECT (options), "detect-encoding");
+}
+
 /* ex:set ts=8 noet: */
@@ -65,6 +65,10 @@ const gchar    **ggit_diff_options_get_pathspec          (GgitDiffOptions  *opti
 void             ggit_diff_options_set_pathspec          (GgitDiffOptions  *options,
                                                           const gchar     **pathspec);
 
+gboolean         ggit_diff_options_get_detect_encoding   (GgitDiffOptions  *options);
+void             ggit_diff_options_set_detect_encoding   (GgitDiffOptions  *options,
+                                                          gboolean          detect_encoding);
+
 G_END_DECLS
 
 #endif /* __GGIT_DIFF_OPTIONS_H__ */
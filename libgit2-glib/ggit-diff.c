@@ -45,7 +45,16 @@
 typedef struct _GgitDiffPrivate
 {
 	GgitRepository *repository;
-	gchar *encoding;
+
+	/* interned */
+	const gchar *encoding;
+
+	/* the options the diff was created with, to generate patches
+	 * outside of the diff in ggit_diff_foreach_parallel
+	 */
+	GgitDiffOptions *options;
+
+	guint detect_encoding : 1;
 } GgitDiffPrivate;
 
 typedef struct {
@@ -54,8 +63,23 @@ typedef struct {
 
 	gpointer user_data;
 
-	GHashTable *cached_deltas;
-	GHashTable *cached_hunks;
+	/* whether to look up the "encoding" attribute of each file */
+	gboolean detect_encoding;
+
+	/* libgit2 reports the file, hunks and lines of a delta one after the
+	 * other, so remembering the current delta and hunk is enough to hand
+	 * out the same wrappers for all of their callbacks.
+	 */
+	const git_diff_delta *cached_delta_native;
+	GgitDiffDelta *cached_delta;
+
+	git_diff_hunk cached_hunk_native;
+	GgitDiffHunk *cached_hunk;
+
+	/* reused for every line callback as long as the callback does
+	 * not keep a reference to it.
+	 */
+	GgitDiffLine *line;
 
 	GgitDiffFileCallback file_cb;
 	GgitDiffBinaryCallback binary_cb;
@@ -72,21 +96,32 @@ enum
 };
 
 static void
-wrapper_data_init (CallbackWrapperData *data)
+wrapper_data_clear_hunk (CallbackWrapperData *data)
+{
+	if (data->cached_hunk != NULL)
+	{
+		ggit_diff_hunk_unref (data->cached_hunk);
+		data->cached_hunk = NULL;
+	}
+}
+
+static void
+wrapper_data_clear (CallbackWrapperData *data)
 {
-	if (data != NULL)
+	wrapper_data_clear_hunk (data);
+
+	if (data->cached_delta != NULL)
 	{
-		data->cached_deltas =
-			g_hash_table_new_full (g_str_hash,
-			                       g_str_equal,
-			                       g_free,
-			                       (GDestroyNotify) ggit_diff_delta_unref);
+		ggit_diff_delta_unref (data->cached_delta);
+		data->cached_delta = NULL;
+	}
+
+	data->cached_delta_native = NULL;
 
-		data->cached_hunks =
-			g_hash_table_new_full (g_str_hash,
-			                       g_str_equal,
-			                       g_free,
-			                       (GDestroyNotify) ggit_diff_hunk_unref);
+	if (data->line != NULL)
+	{
+		ggit_diff_line_unref (data->line);
+		data->line = NULL;
 	}
 }
 
@@ -94,40 +129,35 @@ static GgitDiffDelta *
 wrap_diff_delta_cached (CallbackWrapperData  *data,
                         const git_diff_delta *delta)
 {
-	GgitDiffDelta *gdelta;
-	gchar *key;
-
 	if (!delta)
 	{
 		return NULL;
 	}
 
-	if (delta->old_file.path != NULL)
+	if (delta != data->cached_delta_native)
 	{
-		key = g_strdup_printf ("%s%s",
-		                       delta->old_file.path,
-		                       git_oid_tostr_s (&delta->old_file.id));
-	}
-	else
-	{
-		key = g_strdup_printf ("%s%s",
-		                       delta->new_file.path,
-		                       git_oid_tostr_s (&delta->new_file.id));
-	}
+		wrapper_data_clear (data);
 
-	gdelta = g_hash_table_lookup (data->cached_deltas, key);
-
-	if (!gdelta)
-	{
-		gdelta = _ggit_diff_delta_wrap (delta);
-		g_hash_table_insert (data->cached_deltas, key, gdelta);
-	}
-	else
-	{
-		g_free (key);
+		data->cached_delta_native = delta;
+		data->cached_delta = _ggit_diff_delta_wrap (delta);
 	}
 
-	return gdelta;
+	return data->cached_delta;
+}
+
+static gboolean
+diff_hunk_equal (const git_diff_hunk *a,
+                 const git_diff_hunk *b)
+{
+	/* The ranges identify a hunk within its delta, comparing them
+	 * instead of the pointer also covers libgit2 moving the hunk
+	 * around in memory while the patch is being generated.
+	 */
+	return a->old_start == b->old_start &&
+	       a->old_lines == b->old_lines &&
+	       a->new_start == b->new_start &&
+	       a->new_lines == b->new_lines &&
+	       a->header_len == b->header_len;
 }
 
 static GgitDiffHunk *
@@ -135,42 +165,24 @@ wrap_diff_hunk_cached (CallbackWrapperData *data,
                        const git_diff_delta *delta,
                        const git_diff_hunk *hunk)
 {
-	GgitDiffHunk *ghunk;
-	gchar *key;
-
 	if (!delta || !hunk)
 	{
 		return NULL;
 	}
 
-	if (delta->old_file.path != NULL)
-	{
-		key = g_strdup_printf ("%s%s%s",
-		                       delta->old_file.path,
-		                       git_oid_tostr_s (&delta->old_file.id),
-		                       hunk->header);
-	}
-	else
-	{
-		key = g_strdup_printf ("%s%s%s",
-		                       delta->new_file.path,
-		                       git_oid_tostr_s (&delta->new_file.id),
-		                       hunk->header);
-	}
-
-	ghunk = g_hash_table_lookup (data->cached_hunks, key);
+	/* Make sure the hunk belongs to the currently cached delta */
+	wrap_diff_delta_cached (data, delta);
 
-	if (!ghunk)
+	if (data->cached_hunk == NULL ||
+	    !diff_hunk_equal (&data->cached_hunk_native, hunk))
 	{
-		ghunk = _ggit_diff_hunk_wrap (hunk);
-		g_hash_table_insert (data->cached_hunks, g_strdup (key), ghunk);
-	}
-	else
-	{
-		g_free (key);
+		wrapper_data_clear_hunk (data);
+
+		data->cached_hunk_native = *hunk;
+		data->cached_hunk = _ggit_diff_hunk_wrap (hunk);
 	}
 
-	return ghunk;
+	return data->cached_hunk;
 }
 
 static gint
@@ -186,7 +198,7 @@ ggit_diff_file_callback_wrapper (const git_diff_delta *delta,
 
 	data->encoding = NULL;
 
-	if (data->diff != NULL)
+	if (data->diff != NULL && data->detect_encoding)
 	{
 		GgitDiffPrivate *priv;
 		GgitDiffFile *file;
@@ -209,11 +221,10 @@ ggit_diff_file_callback_wrapper (const git_diff_delta *delta,
 			path = ggit_diff_file_get_path (file);
 
 			data->encoding =
-				ggit_repository_get_attribute (priv->repository,
-			                                       path,
-			                                       "encoding",
-			                                       GGIT_ATTRIBUTE_CHECK_FILE_THEN_INDEX,
-			                                       NULL);
+				_ggit_repository_get_attribute_cached (priv->repository,
+				                                       path,
+				                                       "encoding",
+				                                       GGIT_ATTRIBUTE_CHECK_FILE_THEN_INDEX);
 		}
 	}
 
@@ -269,7 +280,7 @@ ggit_diff_line_callback_wrapper (const git_diff_delta *delta,
 	CallbackWrapperData *data = user_data;
 	GgitDiffDelta *gdelta;
 	GgitDiffHunk *ghunk = NULL;
-	GgitDiffLine *gline;
+	GgitDiffLine *gline = NULL;
 	gint ret;
 	const gchar *encoding = NULL;
 
@@ -288,13 +299,33 @@ ggit_diff_line_callback_wrapper (const git_diff_delta *delta,
 	gdelta = wrap_diff_delta_cached (data, delta);
 	ghunk = wrap_diff_hunk_cached (data, delta, hunk);
 
-	gline = line == NULL ? NULL : _ggit_diff_line_wrap (line, encoding);
+	if (line != NULL)
+	{
+		if (data->line == NULL)
+		{
+			data->line = _ggit_diff_line_wrap_borrowed (line,
+			                                            encoding,
+			                                            NULL,
+			                                            NULL);
+		}
+		else
+		{
+			_ggit_diff_line_set_borrowed (data->line, line, encoding);
+		}
+
+		gline = data->line;
+	}
 
 	ret = data->line_cb (gdelta, ghunk, gline, data->user_data);
 
-	if (gline != NULL)
+	/* The content of the line is only valid during the callback, if
+	 * the callback kept the line around give it its own copy.
+	 */
+	if (gline != NULL && _ggit_diff_line_is_shared (gline))
 	{
+		_ggit_diff_line_detach (gline);
 		ggit_diff_line_unref (gline);
+		data->line = NULL;
 	}
 
 	return ret;
@@ -308,7 +339,7 @@ ggit_diff_finalize (GObject *object)
 
 	priv = ggit_diff_get_instance_private (diff);
 
-	g_free (priv->encoding);
+	g_clear_object (&priv->options);
 
 	G_OBJECT_CLASS (ggit_diff_parent_class)->finalize (object);
 }
@@ -379,7 +410,7 @@ ggit_diff_constructed (GObject *object)
 
 		if (enc != NULL)
 		{
-			priv->encoding = g_strdup (enc);
+			priv->encoding = g_intern_string (enc);
 		}
 
 		g_object_unref (config);
@@ -411,17 +442,37 @@ ggit_diff_class_init (GgitDiffClass *klass)
 static void
 ggit_diff_init (GgitDiff *self)
 {
+	GgitDiffPrivate *priv;
+
+	priv = ggit_diff_get_instance_private (self);
+
+	priv->detect_encoding = TRUE;
 }
 
 static GgitDiff *
-_ggit_diff_wrap (GgitRepository *repository,
-                 git_diff       *diff)
+_ggit_diff_wrap (GgitRepository  *repository,
+                 git_diff        *diff,
+                 GgitDiffOptions *diff_options)
 {
 	GgitDiff *gdiff;
+	GgitDiffPrivate *priv;
 
 	gdiff = g_object_new (GGIT_TYPE_DIFF, "repository", repository, NULL);
 	_ggit_native_set (gdiff, diff, (GDestroyNotify)git_diff_free);
 
+	priv = ggit_diff_get_instance_private (gdiff);
+
+	if (diff_options != NULL)
+	{
+		priv->options = g_object_ref (diff_options);
+
+		if (!ggit_diff_options_get_detect_encoding (diff_options))
+		{
+			priv->detect_encoding = FALSE;
+			priv->encoding = NULL;
+		}
+	}
+
 	return gdiff;
 }
 
@@ -469,7 +520,7 @@ ggit_diff_new_tree_to_tree (GgitRepository   *repository,
 		return NULL;
 	}
 
-	return _ggit_diff_wrap (repository, diff);
+	return _ggit_diff_wrap (repository, diff, diff_options);
 }
 
 /**
@@ -516,7 +567,7 @@ ggit_diff_new_tree_to_index (GgitRepository   *repository,
 		return NULL;
 	}
 
-	return _ggit_diff_wrap (repository, diff);
+	return _ggit_diff_wrap (repository, diff, diff_options);
 }
 
 /**
@@ -559,7 +610,7 @@ ggit_diff_new_index_to_workdir (GgitRepository   *repository,
 		return NULL;
 	}
 
-	return _ggit_diff_wrap (repository, diff);
+	return _ggit_diff_wrap (repository, diff, diff_options);
 }
 
 /**
@@ -601,7 +652,7 @@ ggit_diff_new_tree_to_workdir (GgitRepository   *repository,
 		return NULL;
 	}
 
-	return _ggit_diff_wrap (repository, diff);
+	return _ggit_diff_wrap (repository, diff, diff_options);
 }
 
 /**
@@ -657,6 +708,7 @@ ggit_diff_foreach (GgitDiff              *diff,
                    gpointer              *user_data,
                    GError               **error)
 {
+	GgitDiffPrivate *priv;
 	gint ret;
 	CallbackWrapperData wrapper_data = { 0 };
 	git_diff_file_cb real_file_cb = NULL;
@@ -668,11 +720,16 @@ ggit_diff_foreach (GgitDiff              *diff,
 	g_return_if_fail (file_cb != NULL && binary_cb != NULL && hunk_cb != NULL && line_cb != NULL);
 	g_return_if_fail (error == NULL || *error == NULL);
 
-	wrapper_data_init (&wrapper_data);
-
 	wrapper_data.user_data = user_data;
 	wrapper_data.diff = diff;
 
+	priv = ggit_diff_get_instance_private (diff);
+
+	if (priv->repository != NULL && priv->detect_encoding)
+	{
+		wrapper_data.detect_encoding = TRUE;
+		_ggit_repository_begin_attribute_batch (priv->repository);
+	}
 
 	if (file_cb != NULL)
 	{
@@ -703,8 +760,12 @@ ggit_diff_foreach (GgitDiff              *diff,
 	                        real_hunk_cb, real_line_cb,
 	                        &wrapper_data);
 
-	g_hash_table_destroy (wrapper_data.cached_deltas);
-	g_hash_table_destroy (wrapper_data.cached_hunks);
+	if (wrapper_data.detect_encoding)
+	{
+		_ggit_repository_end_attribute_batch (priv->repository);
+	}
+
+	wrapper_data_clear (&wrapper_data);
 
 	if (ret != GIT_OK)
 	{
@@ -712,6 +773,432 @@ ggit_diff_foreach (GgitDiff              *diff,
 	}
 }
 
+typedef struct
+{
+	gsize idx;
+
+	/* set when the patch has to be generated from the diff itself on
+	 * the calling thread, for example for working directory content
+	 * that is not in the object database.
+	 */
+	gboolean serial;
+
+	gboolean has_old;
+	git_oid old_id;
+	gchar *old_path;
+
+	gboolean has_new;
+	git_oid new_id;
+	gchar *new_path;
+
+	/* the worker repository the patch was generated in */
+	GgitRepository *repository;
+	git_patch *patch;
+	GError *error;
+} PatchJob;
+
+typedef struct
+{
+	git_diff_options options;
+	GAsyncQueue *repositories;
+	GAsyncQueue *results;
+} ParallelData;
+
+static void
+patch_job_free (PatchJob *job)
+{
+	if (job->patch != NULL)
+	{
+		git_patch_free (job->patch);
+	}
+
+	g_clear_object (&job->repository);
+	g_clear_error (&job->error);
+
+	g_free (job->old_path);
+	g_free (job->new_path);
+
+	g_slice_free (PatchJob, job);
+}
+
+/* A patch generated from the blobs of a file describes the file as a
+ * regular file, and derives the status of the delta from the blobs. Only
+ * such deltas give the same patch as the diff itself.
+ */
+static gboolean
+diff_file_is_regular_blob (const git_diff_file *file)
+{
+	return (file->flags & GIT_DIFF_FLAG_VALID_ID) != 0 &&
+	       !git_oid_iszero (&file->id) &&
+	       file->mode == GIT_FILEMODE_BLOB;
+}
+
+static PatchJob *
+patch_job_new (git_diff *diff,
+               gsize     idx,
+               gboolean  parallel)
+{
+	const git_diff_delta *delta;
+	PatchJob *job;
+
+	delta = git_diff_get_delta (diff, idx);
+
+	job = g_slice_new0 (PatchJob);
+	job->idx = idx;
+	job->serial = TRUE;
+
+	if (!parallel)
+	{
+		return job;
+	}
+
+	switch (delta->status)
+	{
+		case GIT_DELTA_ADDED:
+			job->has_new = TRUE;
+			break;
+		case GIT_DELTA_DELETED:
+			job->has_old = TRUE;
+			break;
+		case GIT_DELTA_MODIFIED:
+			job->has_old = TRUE;
+			job->has_new = TRUE;
+			break;
+		default:
+			/* renames and copies carry a similarity and both paths,
+			 * which a patch generated from blobs loses
+			 */
+			return job;
+	}
+
+	if ((job->has_old && !diff_file_is_regular_blob (&delta->old_file)) ||
+	    (job->has_new && !diff_file_is_regular_blob (&delta->new_file)))
+	{
+		return job;
+	}
+
+	job->serial = FALSE;
+
+	git_oid_cpy (&job->old_id, &delta->old_file.id);
+	git_oid_cpy (&job->new_id, &delta->new_file.id);
+
+	job->old_path = g_strdup (delta->old_file.path);
+	job->new_path = g_strdup (delta->new_file.path);
+
+	return job;
+}
+
+static gint
+lookup_job_blob (git_blob       **blob,
+                 git_repository  *repository,
+                 gboolean         has_blob,
+                 const git_oid   *id)
+{
+	*blob = NULL;
+
+	if (!has_blob)
+	{
+		return GIT_OK;
+	}
+
+	return git_blob_lookup (blob, repository, id);
+}
+
+static void
+generate_patch_worker (gpointer data,
+                       gpointer user_data)
+{
+	PatchJob *job = data;
+	ParallelData *parallel = user_data;
+	GgitRepository *repository;
+	git_repository *repo;
+	git_blob *old_blob = NULL;
+	git_blob *new_blob = NULL;
+	gint ret;
+
+	repository = g_async_queue_pop (parallel->repositories);
+	repo = _ggit_native_get (repository);
+
+	ret = lookup_job_blob (&old_blob, repo, job->has_old, &job->old_id);
+
+	if (ret == GIT_OK)
+	{
+		ret = lookup_job_blob (&new_blob, repo, job->has_new, &job->new_id);
+	}
+
+	if (ret == GIT_OK)
+	{
+		ret = git_patch_from_blobs (&job->patch,
+		                            old_blob,
+		                            job->old_path,
+		                            new_blob,
+		                            job->new_path,
+		                            &parallel->options);
+	}
+
+	if (ret == GIT_OK)
+	{
+		job->repository = g_object_ref (repository);
+	}
+	else if (ret == GIT_ENOTFOUND)
+	{
+		job->serial = TRUE;
+	}
+	else
+	{
+		/* libgit2 errors are per thread, so collect it here */
+		_ggit_error_set (&job->error, ret);
+	}
+
+	if (old_blob != NULL)
+	{
+		git_blob_free (old_blob);
+	}
+
+	if (new_blob != NULL)
+	{
+		git_blob_free (new_blob);
+	}
+
+	g_async_queue_push (parallel->repositories, repository);
+	g_async_queue_push (parallel->results, job);
+}
+
+static gint
+deliver_patch_job (GgitDiff               *diff,
+                   PatchJob               *job,
+                   GgitDiffPatchCallback   patch_cb,
+                   gpointer                user_data,
+                   GError                **error)
+{
+	git_diff *native = _ggit_native_get (diff);
+	const git_diff_delta *delta;
+	GgitDiffDelta *gdelta;
+	GgitPatch *gpatch;
+	gint ret;
+
+	if (job->error != NULL)
+	{
+		g_propagate_error (error, job->error);
+		job->error = NULL;
+
+		return GIT_ERROR;
+	}
+
+	if (job->serial)
+	{
+		ret = git_patch_from_diff (&job->patch, native, job->idx);
+
+		if (ret != GIT_OK)
+		{
+			_ggit_error_set (error, ret);
+			return ret;
+		}
+	}
+
+	delta = git_diff_get_delta (native, job->idx);
+
+	gdelta = _ggit_diff_delta_wrap (delta);
+	gpatch = _ggit_patch_wrap_owned (job->patch,
+	                                 job->repository,
+	                                 _ggit_diff_get_delta_encoding (diff, delta));
+	job->patch = NULL;
+
+	ret = patch_cb (gdelta, gpatch, job->idx, user_data);
+
+	ggit_patch_unref (gpatch);
+	ggit_diff_delta_unref (gdelta);
+
+	if (ret < 0)
+	{
+		_ggit_error_set (error, ret);
+	}
+
+	return ret;
+}
+
+/**
+ * ggit_diff_foreach_parallel:
+ * @diff: a #GgitDiff.
+ * @n_threads: the number of worker threads, or 0 to use one per processor.
+ * @ordered: whether @patch_cb is called in the order of the deltas.
+ * @patch_cb: (scope call) (closure user_data): a #GgitDiffPatchCallback.
+ * @user_data: callback user data.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Generates the patch of every delta in @diff and calls @patch_cb with it.
+ * The patches are generated on a pool of @n_threads worker threads, each
+ * with its own handle on the repository, while @patch_cb is always called
+ * on the calling thread. If @ordered is %TRUE, @patch_cb is called in the
+ * order of the deltas, otherwise in the order the patches are finished.
+ *
+ * Patches are generated in the workers from the blobs of the files, which
+ * gives the same patch as ggit_patch_new_from_diff() for added, deleted
+ * and modified regular files. All other deltas, such as renames, copies,
+ * executable files, symbolic links and modified files in the working
+ * directory, are generated from the diff on the calling thread. So is
+ * everything when objects are stored in backends added to the object
+ * database of the repository, which the worker handles cannot see.
+ *
+ * Returns: %TRUE if all deltas were processed, %FALSE if there was an
+ * error or @patch_cb returned non-zero.
+ *
+ **/
+gboolean
+ggit_diff_foreach_parallel (GgitDiff               *diff,
+                            gint                    n_threads,
+                            gboolean                ordered,
+                            GgitDiffPatchCallback   patch_cb,
+                            gpointer                user_data,
+                            GError                **error)
+{
+	GgitDiffPrivate *priv;
+	git_diff *native;
+	ParallelData parallel;
+	GThreadPool *pool = NULL;
+	GHashTable *pending;
+	gsize n_deltas;
+	gsize next_dispatch = 0;
+	gsize next_deliver = 0;
+	gsize in_flight = 0;
+	gsize window;
+	gboolean stopped = FALSE;
+
+	g_return_val_if_fail (GGIT_IS_DIFF (diff), FALSE);
+	g_return_val_if_fail (patch_cb != NULL, FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	priv = ggit_diff_get_instance_private (diff);
+	native = _ggit_native_get (diff);
+	n_deltas = git_diff_num_deltas (native);
+
+	if (n_threads <= 0)
+	{
+		n_threads = g_get_num_processors ();
+	}
+
+	if (priv->options != NULL)
+	{
+		parallel.options = *_ggit_diff_options_get_diff_options (priv->options);
+	}
+	else
+	{
+		git_diff_init_options (&parallel.options, GIT_DIFF_OPTIONS_VERSION);
+	}
+
+	/* the sides of the deltas are already swapped */
+	parallel.options.flags &= ~GIT_DIFF_REVERSE;
+
+	parallel.results = g_async_queue_new ();
+	parallel.repositories = NULL;
+
+	if (priv->repository != NULL && n_deltas > 1)
+	{
+		parallel.repositories = _ggit_repository_open_workers (priv->repository,
+		                                                       n_threads);
+		n_threads = g_async_queue_length (parallel.repositories);
+
+		if (n_threads > 0)
+		{
+			pool = g_thread_pool_new (generate_patch_worker,
+			                          &parallel,
+			                          n_threads,
+			                          FALSE,
+			                          NULL);
+		}
+	}
+
+	/* bound the number of finished but undelivered patches */
+	window = MAX (n_threads, 1) * 4;
+	pending = g_hash_table_new_full (g_direct_hash,
+	                                 g_direct_equal,
+	                                 NULL,
+	                                 (GDestroyNotify)patch_job_free);
+
+	while (TRUE)
+	{
+		PatchJob *job;
+
+		while (!stopped &&
+		       next_dispatch < n_deltas &&
+		       next_dispatch - next_deliver < window)
+		{
+			job = patch_job_new (native, next_dispatch++, pool != NULL);
+
+			if (job->serial)
+			{
+				g_async_queue_push (parallel.results, job);
+			}
+			else
+			{
+				g_thread_pool_push (pool, job, NULL);
+			}
+
+			++in_flight;
+		}
+
+		if (in_flight == 0)
+		{
+			break;
+		}
+
+		job = g_async_queue_pop (parallel.results);
+		--in_flight;
+
+		if (stopped)
+		{
+			patch_job_free (job);
+			continue;
+		}
+
+		if (!ordered)
+		{
+			++next_deliver;
+
+			if (deliver_patch_job (diff, job, patch_cb, user_data, error) != 0)
+			{
+				stopped = TRUE;
+			}
+
+			patch_job_free (job);
+			continue;
+		}
+
+		g_hash_table_insert (pending, GSIZE_TO_POINTER (job->idx), job);
+
+		while (!stopped &&
+		       (job = g_hash_table_lookup (pending,
+		                                   GSIZE_TO_POINTER (next_deliver))) != NULL)
+		{
+			g_hash_table_steal (pending, GSIZE_TO_POINTER (next_deliver));
+			++next_deliver;
+
+			if (deliver_patch_job (diff, job, patch_cb, user_data, error) != 0)
+			{
+				stopped = TRUE;
+			}
+
+			patch_job_free (job);
+		}
+	}
+
+	if (pool != NULL)
+	{
+		g_thread_pool_free (pool, FALSE, TRUE);
+	}
+
+	g_hash_table_destroy (pending);
+
+	if (parallel.repositories != NULL)
+	{
+		g_async_queue_unref (parallel.repositories);
+	}
+
+	g_async_queue_unref (parallel.results);
+
+	return !stopped;
+}
+
 /**
  * ggit_diff_print:
  * @diff: a #GgitDiff.
@@ -736,8 +1223,6 @@ ggit_diff_print (GgitDiff              *diff,
 	g_return_if_fail (print_cb != NULL);
 	g_return_if_fail (error == NULL || *error == NULL);
 
-	wrapper_data_init (&wrapper_data);
-
 	wrapper_data.user_data = user_data;
 	wrapper_data.diff = diff;
 
@@ -747,8 +1232,7 @@ ggit_diff_print (GgitDiff              *diff,
 	                      ggit_diff_line_callback_wrapper,
 	                      &wrapper_data);
 
-	g_hash_table_destroy (wrapper_data.cached_deltas);
-	g_hash_table_destroy (wrapper_data.cached_hunks);
+	wrapper_data_clear (&wrapper_data);
 
 	if (ret != GIT_OK)
 	{
@@ -845,6 +1329,61 @@ ggit_diff_get_delta (GgitDiff *diff,
 	return _ggit_diff_delta_wrap (delta);
 }
 
+/*
+ * _ggit_diff_get_delta_encoding:
+ * @diff: a #GgitDiff.
+ * @delta: a delta of @diff.
+ *
+ * Gets the encoding the lines of @delta are converted from, the same
+ * one ggit_diff_foreach() hands to the lines of @delta: the "encoding"
+ * attribute of the file if the diff detects encodings, or else the
+ * gui.encoding of the repository.
+ *
+ * Returns: (transfer none) (nullable): the interned encoding, or %NULL.
+ */
+const gchar *
+_ggit_diff_get_delta_encoding (GgitDiff             *diff,
+                               const git_diff_delta *delta)
+{
+	GgitDiffPrivate *priv;
+	const gchar *encoding = NULL;
+
+	g_return_val_if_fail (GGIT_IS_DIFF (diff), NULL);
+	g_return_val_if_fail (delta != NULL, NULL);
+
+	priv = ggit_diff_get_instance_private (diff);
+
+	if (priv->repository != NULL && priv->detect_encoding)
+	{
+		const git_diff_file *file;
+
+		if (delta->status == GIT_DELTA_DELETED)
+		{
+			file = &delta->old_file;
+		}
+		else
+		{
+			file = &delta->new_file;
+		}
+
+		if (file->path != NULL)
+		{
+			encoding =
+				_ggit_repository_get_attribute_cached (priv->repository,
+				                                       file->path,
+				                                       "encoding",
+				                                       GGIT_ATTRIBUTE_CHECK_FILE_THEN_INDEX);
+		}
+	}
+
+	if (encoding == NULL)
+	{
+		encoding = priv->encoding;
+	}
+
+	return encoding;
+}
+
 /**
  * ggit_diff_blobs:
  * @old_blob: (allow-none): a #GgitBlob to diff from.
@@ -896,8 +1435,6 @@ ggit_diff_blobs (GgitBlob              *old_blob,
 
 	gdiff_options = _ggit_diff_options_get_diff_options (diff_options);
 
-	wrapper_data_init (&wrapper_data);
-
 	wrapper_data.user_data = user_data;
 
 	if (file_cb != NULL)
@@ -933,8 +1470,7 @@ ggit_diff_blobs (GgitBlob              *old_blob,
 	                      real_hunk_cb, real_line_cb,
 	                      &wrapper_data);
 
-	g_hash_table_destroy (wrapper_data.cached_deltas);
-	g_hash_table_destroy (wrapper_data.cached_hunks);
+	wrapper_data_clear (&wrapper_data);
 
 	if (ret != GIT_OK)
 	{
@@ -1022,7 +1558,7 @@ ggit_diff_new_buffers (const guint8          *buffer1,
 	git_buf_free (&buf);
 #endif
 
-	return _ggit_diff_wrap (NULL, diff);
+	return _ggit_diff_wrap (NULL, diff, diff_options);
 }
 
 /**
@@ -1072,8 +1608,6 @@ ggit_diff_blob_to_buffer (GgitBlob              *old_blob,
 
 	gdiff_options = _ggit_diff_options_get_diff_options (diff_options);
 
-	wrapper_data_init (&wrapper_data);
-
 	wrapper_data.user_data = user_data;
 
 	if (buffer_len == -1)
@@ -1115,8 +1649,7 @@ ggit_diff_blob_to_buffer (GgitBlob              *old_blob,
 	                               real_hunk_cb, real_line_cb,
 	                               &wrapper_data);
 
-	g_hash_table_destroy (wrapper_data.cached_deltas);
-	g_hash_table_destroy (wrapper_data.cached_hunks);
+	wrapper_data_clear (&wrapper_data);
 
 	if (ret != GIT_OK)
 	{
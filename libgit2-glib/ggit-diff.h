@@ -86,6 +86,12 @@ void           ggit_diff_foreach                   (GgitDiff              *diff,
                                                     GgitDiffLineCallback   line_cb,
                                                     gpointer              *user_data,
                                                     GError               **error);
+gboolean       ggit_diff_foreach_parallel          (GgitDiff              *diff,
+                                                    gint                   n_threads,
+                                                    gboolean               ordered,
+                                                    GgitDiffPatchCallback  patch_cb,
+                                                    gpointer               user_data,
+                                                    GError               **error);
 void           ggit_diff_print                     (GgitDiff              *diff,
                                                     GgitDiffFormatType     type,
                                                     GgitDiffLineCallback   print_cb,
@@ -130,6 +136,9 @@ gboolean       ggit_diff_find_similar              (GgitDiff              *diff,
                                                     GgitDiffFindOptions   *options,
                                                     GError               **error);
 
+const gchar   *_ggit_diff_get_delta_encoding       (GgitDiff              *diff,
+                                                    const git_diff_delta  *delta);
+
 G_END_DECLS
 
 #endif /* __GGIT_DIFF_H__ */
@@ -0,0 +1,350 @@
+/*
+ * ggit-index-snapshot.c
+ * This file is part of libgit2-glib
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include <git2.h>
+
+#include "ggit-index-snapshot.h"
+
+struct _GgitIndexSnapshot
+{
+	gint ref_count;
+	gsize size;
+
+	/* nul-separated paths, in index order */
+	GBytes *paths;
+	/* offset of each path in paths */
+	GArray *offsets;
+
+	/* raw ids, GIT_OID_RAWSZ bytes each */
+	GBytes *ids;
+	/* guint32 mode of each entry */
+	GBytes *modes;
+	/* guint64 size of each file */
+	GBytes *file_sizes;
+	/* gint64 modification time of each file, in nanoseconds */
+	GBytes *mtimes;
+	/* guint32 flags of each entry, extended flags in the high half */
+	GBytes *flags;
+};
+
+G_DEFINE_BOXED_TYPE (GgitIndexSnapshot, ggit_index_snapshot,
+                     ggit_index_snapshot_ref, ggit_index_snapshot_unref)
+
+/*
+ * _ggit_index_snapshot_new:
+ * @index: a #git_index.
+ *
+ * Copies the entries of @index into columns, in a single pass.
+ */
+GgitIndexSnapshot *
+_ggit_index_snapshot_new (git_index *index)
+{
+	GgitIndexSnapshot *snapshot;
+	GString *paths;
+	guint8 *ids;
+	guint32 *modes;
+	guint64 *file_sizes;
+	gint64 *mtimes;
+	guint32 *flags;
+	gsize i;
+
+	snapshot = g_slice_new (GgitIndexSnapshot);
+	snapshot->ref_count = 1;
+	snapshot->size = git_index_entrycount (index);
+
+	paths = g_string_sized_new (snapshot->size * 32);
+	snapshot->offsets = g_array_sized_new (FALSE, FALSE, sizeof (gsize), snapshot->size);
+
+	ids = g_new (guint8, snapshot->size * GIT_OID_RAWSZ);
+	modes = g_new (guint32, snapshot->size);
+	file_sizes = g_new (guint64, snapshot->size);
+	mtimes = g_new (gint64, snapshot->size);
+	flags = g_new (guint32, snapshot->size);
+
+	for (i = 0; i < snapshot->size; ++i)
+	{
+		const git_index_entry *entry;
+		gsize offset = paths->len;
+
+		entry = git_index_get_byindex (index, i);
+
+		g_array_append_val (snapshot->offsets, offset);
+		g_string_append_len (paths, entry->path, strlen (entry->path) + 1);
+
+		memcpy (ids + i * GIT_OID_RAWSZ, entry->id.id, GIT_OID_RAWSZ);
+		modes[i] = entry->mode;
+		file_sizes[i] = entry->file_size;
+		mtimes[i] = (gint64)entry->mtime.seconds * G_GINT64_CONSTANT (1000000000) +
+		            entry->mtime.nanoseconds;
+		flags[i] = entry->flags | ((guint32)entry->flags_extended << 16);
+	}
+
+	snapshot->paths = g_string_free_to_bytes (paths);
+	snapshot->ids = g_bytes_new_take (ids, snapshot->size * GIT_OID_RAWSZ);
+	snapshot->modes = g_bytes_new_take (modes, snapshot->size * sizeof (guint32));
+	snapshot->file_sizes = g_bytes_new_take (file_sizes, snapshot->size * sizeof (guint64));
+	snapshot->mtimes = g_bytes_new_take (mtimes, snapshot->size * sizeof (gint64));
+	snapshot->flags = g_bytes_new_take (flags, snapshot->size * sizeof (guint32));
+
+	return snapshot;
+}
+
+/**
+ * ggit_index_snapshot_ref:
+ * @snapshot: a #GgitIndexSnapshot.
+ *
+ * Atomically increments the reference count of @snapshot by one.
+ * This function is MT-safe and may be called from any thread.
+ *
+ * Returns: (transfer none) (nullable): a #GgitIndexSnapshot or %NULL.
+ **/
+GgitIndexSnapshot *
+ggit_index_snapshot_ref (GgitIndexSnapshot *snapshot)
+{
+	g_return_val_if_fail (snapshot != NULL, NULL);
+
+	g_atomic_int_inc (&snapshot->ref_count);
+
+	return snapshot;
+}
+
+/**
+ * ggit_index_snapshot_unref:
+ * @snapshot: a #GgitIndexSnapshot.
+ *
+ * Atomically decrements the reference count of @snapshot by one.
+ * If the reference count drops to 0, @snapshot is freed.
+ **/
+void
+ggit_index_snapshot_unref (GgitIndexSnapshot *snapshot)
+{
+	g_return_if_fail (snapshot != NULL);
+
+	if (g_atomic_int_dec_and_test (&snapshot->ref_count))
+	{
+		g_bytes_unref (snapshot->paths);
+		g_array_unref (snapshot->offsets);
+		g_bytes_unref (snapshot->ids);
+		g_bytes_unref (snapshot->modes);
+		g_bytes_unref (snapshot->file_sizes);
+		g_bytes_unref (snapshot->mtimes);
+		g_bytes_unref (snapshot->flags);
+
+		g_slice_free (GgitIndexSnapshot, snapshot);
+	}
+}
+
+/**
+ * ggit_index_snapshot_get_size:
+ * @snapshot: a #GgitIndexSnapshot.
+ *
+ * Gets the number of entries in @snapshot.
+ *
+ * Returns: the number of entries in @snapshot.
+ **/
+gsize
+ggit_index_snapshot_get_size (GgitIndexSnapshot *snapshot)
+{
+	g_return_val_if_fail (snapshot != NULL, 0);
+
+	return snapshot->size;
+}
+
+/**
+ * ggit_index_snapshot_get_path:
+ * @snapshot: a #GgitIndexSnapshot.
+ * @index: the index of the entry.
+ *
+ * Gets the path of the entry at @index.
+ *
+ * Returns: (transfer none) (nullable): the path, or %NULL if @index is out
+ * of bounds.
+ **/
+const gchar *
+ggit_index_snapshot_get_path (GgitIndexSnapshot *snapshot,
+                              gsize              index)
+{
+	g_return_val_if_fail (snapshot != NULL, NULL);
+	g_return_val_if_fail (index < snapshot->size, NULL);
+
+	return (const gchar *)g_bytes_get_data (snapshot->paths, NULL) +
+	       g_array_index (snapshot->offsets, gsize, index);
+}
+
+/**
+ * ggit_index_snapshot_get_paths:
+ * @snapshot: a #GgitIndexSnapshot.
+ *
+ * Gets the paths of all the entries, in index order.
+ *
+ * Returns: (transfer full) (array zero-terminated=1): the paths.
+ **/
+gchar **
+ggit_index_snapshot_get_paths (GgitIndexSnapshot *snapshot)
+{
+	gchar **paths;
+	gsize i;
+
+	g_return_val_if_fail (snapshot != NULL, NULL);
+
+	paths = g_new (gchar *, snapshot->size + 1);
+
+	for (i = 0; i < snapshot->size; ++i)
+	{
+		paths[i] = g_strdup (ggit_index_snapshot_get_path (snapshot, i));
+	}
+
+	paths[snapshot->size] = NULL;
+	return paths;
+}
+
+/**
+ * ggit_index_snapshot_get_path_data:
+ * @snapshot: a #GgitIndexSnapshot.
+ *
+ * Gets the paths of all the entries as a single buffer, in index order,
+ * each path followed by a nul byte.
+ *
+ * Returns: (transfer full): a #GBytes.
+ **/
+GBytes *
+ggit_index_snapshot_get_path_data (GgitIndexSnapshot *snapshot)
+{
+	g_return_val_if_fail (snapshot != NULL, NULL);
+
+	return g_bytes_ref (snapshot->paths);
+}
+
+/**
+ * ggit_index_snapshot_get_ids:
+ * @snapshot: a #GgitIndexSnapshot.
+ *
+ * Gets the ids of all the entries, in index order.
+ *
+ * Returns: (transfer full): a #GgitOIdArray.
+ **/
+GgitOIdArray *
+ggit_index_snapshot_get_ids (GgitIndexSnapshot *snapshot)
+{
+	GgitOIdArray *array;
+	const guint8 *ids;
+	gsize i;
+
+	g_return_val_if_fail (snapshot != NULL, NULL);
+
+	array = ggit_oid_array_new (snapshot->size);
+	ids = g_bytes_get_data (snapshot->ids, NULL);
+
+	for (i = 0; i < snapshot->size; ++i)
+	{
+		git_oid oid;
+
+		git_oid_fromraw (&oid, ids + i * GIT_OID_RAWSZ);
+		_ggit_oid_array_append_oid (array, &oid);
+	}
+
+	return array;
+}
+
+/**
+ * ggit_index_snapshot_get_id_data:
+ * @snapshot: a #GgitIndexSnapshot.
+ *
+ * Gets the raw ids of all the entries, in index order, 20 bytes each.
+ *
+ * Returns: (transfer full): a #GBytes.
+ **/
+GBytes *
+ggit_index_snapshot_get_id_data (GgitIndexSnapshot *snapshot)
+{
+	g_return_val_if_fail (snapshot != NULL, NULL);
+
+	return g_bytes_ref (snapshot->ids);
+}
+
+/**
+ * ggit_index_snapshot_get_modes:
+ * @snapshot: a #GgitIndexSnapshot.
+ *
+ * Gets the modes of all the entries, in index order, as an array of
+ * #guint32 in host byte order.
+ *
+ * Returns: (transfer full): a #GBytes.
+ **/
+GBytes *
+ggit_index_snapshot_get_modes (GgitIndexSnapshot *snapshot)
+{
+	g_return_val_if_fail (snapshot != NULL, NULL);
+
+	return g_bytes_ref (snapshot->modes);
+}
+
+/**
+ * ggit_index_snapshot_get_file_sizes:
+ * @snapshot: a #GgitIndexSnapshot.
+ *
+ * Gets the file sizes of all the entries, in index order, as an array
+ * of #guint64 in host byte order.
+ *
+ * Returns: (transfer full): a #GBytes.
+ **/
+GBytes *
+ggit_index_snapshot_get_file_sizes (GgitIndexSnapshot *snapshot)
+{
+	g_return_val_if_fail (snapshot != NULL, NULL);
+
+	return g_bytes_ref (snapshot->file_sizes);
+}
+
+/**
+ * ggit_index_snapshot_get_mtimes:
+ * @snapshot: a #GgitIndexSnapshot.
+ *
+ * Gets the modification times of all the entries, in index order, as an
+ * array of #gint64 nanoseconds since the epoch in host byte order.
+ *
+ * Returns: (transfer full): a #GBytes.
+ **/
+GBytes *
+ggit_index_snapshot_get_mtimes (GgitIndexSnapshot *snapshot)
+{
+	g_return_val_if_fail (snapshot != NULL, NULL);
+
+	return g_bytes_ref (snapshot->mtimes);
+}
+
+/**
+ * ggit_index_snapshot_get_flags:
+ * @snapshot: a #GgitIndexSnapshot.
+ *
+ * Gets the flags of all the entries, in index order, as an array of
+ * #guint32 in host byte order. The low 16 bits hold the flags and the
+ * high 16 bits the extended flags of each entry.
+ *
+ * Returns: (transfer full): a #GBytes.
+ **/
+GBytes *
+ggit_index_snapshot_get_flags (GgitIndexSnapshot *snapshot)
+{
+	g_return_val_if_fail (snapshot != NULL, NULL);
+
+	return g_bytes_ref (snapshot->flags);
+}
+
+/* ex:set ts=8 noet: */
@@ -0,0 +1,62 @@
+/*
+ * ggit-index-snapshot.h
+ * This file is part of libgit2-glib
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GGIT_INDEX_SNAPSHOT_H__
+#define __GGIT_INDEX_SNAPSHOT_H__
+
+#include <glib-object.h>
+#include <git2.h>
+
+#include <libgit2-glib/ggit-types.h>
+#include <libgit2-glib/ggit-oid-array.h>
+
+G_BEGIN_DECLS
+
+#define GGIT_TYPE_INDEX_SNAPSHOT       (ggit_index_snapshot_get_type ())
+#define GGIT_INDEX_SNAPSHOT(obj)       ((GgitIndexSnapshot *)obj)
+
+GType               ggit_index_snapshot_get_type       (void) G_GNUC_CONST;
+
+GgitIndexSnapshot  *_ggit_index_snapshot_new          (git_index         *index);
+
+GgitIndexSnapshot  *ggit_index_snapshot_ref           (GgitIndexSnapshot *snapshot);
+void                ggit_index_snapshot_unref         (GgitIndexSnapshot *snapshot);
+
+gsize               ggit_index_snapshot_get_size      (GgitIndexSnapshot *snapshot);
+
+const gchar        *ggit_index_snapshot_get_path      (GgitIndexSnapshot *snapshot,
+                                                       gsize              index);
+
+gchar             **ggit_index_snapshot_get_paths     (GgitIndexSnapshot *snapshot);
+GBytes             *ggit_index_snapshot_get_path_data (GgitIndexSnapshot *snapshot);
+
+GgitOIdArray       *ggit_index_snapshot_get_ids       (GgitIndexSnapshot *snapshot);
+GBytes             *ggit_index_snapshot_get_id_data   (GgitIndexSnapshot *snapshot);
+
+GBytes             *ggit_index_snapshot_get_modes     (GgitIndexSnapshot *snapshot);
+GBytes             *ggit_index_snapshot_get_file_sizes (GgitIndexSnapshot *snapshot);
+GBytes             *ggit_index_snapshot_get_mtimes    (GgitIndexSnapshot *snapshot);
+GBytes             *ggit_index_snapshot_get_flags     (GgitIndexSnapshot *snapshot);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (GgitIndexSnapshot, ggit_index_snapshot_unref)
+
+G_END_DECLS
+
+#endif /* __GGIT_INDEX_SNAPSHOT_H__ */
+
+/* ex:set ts=8 noet: */
@@ -18,6 +18,8 @@
  * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <string.h>
+
 #include "ggit-index.h"
 #include <git2.h>
 #include "ggit-error.h"
@@ -431,6 +433,25 @@ ggit_index_get_entries_resolve_undo (GgitIndex *idx)
 	return _ggit_index_entries_resolve_undo_wrap (idx);
 }
 
+/**
+ * ggit_index_get_snapshot:
+ * @idx: a #GgitIndex.
+ *
+ * Copies all the entries of the index in a single call. The entries are
+ * stored by column, so that language bindings can scan a large index
+ * without wrapping each entry in a #GgitIndexEntry.
+ *
+ * Returns: (transfer full): a #GgitIndexSnapshot.
+ *
+ **/
+GgitIndexSnapshot *
+ggit_index_get_snapshot (GgitIndex *idx)
+{
+	g_return_val_if_fail (GGIT_IS_INDEX (idx), NULL);
+
+	return _ggit_index_snapshot_new (_ggit_native_get (idx));
+}
+
 /**
  * ggit_index_add_file:
  * @idx: a #GgitIndex.
@@ -537,6 +558,521 @@ ggit_index_add_path (GgitIndex    *idx,
 	return ret;
 }
 
+#if GLIB_CHECK_VERSION (2, 74, 0)
+#define ADD_PATH_TIME_ATTRIBUTES                              \
+	G_FILE_ATTRIBUTE_TIME_MODIFIED_NSEC ","               \
+	G_FILE_ATTRIBUTE_TIME_CHANGED_NSEC
+#else
+#define ADD_PATH_TIME_ATTRIBUTES                              \
+	G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC ","               \
+	G_FILE_ATTRIBUTE_TIME_CHANGED_USEC
+#endif
+
+#define ADD_PATH_ATTRIBUTES                                   \
+	G_FILE_ATTRIBUTE_STANDARD_TYPE ","                    \
+	G_FILE_ATTRIBUTE_STANDARD_SIZE ","                    \
+	G_FILE_ATTRIBUTE_UNIX_MODE ","                        \
+	G_FILE_ATTRIBUTE_UNIX_DEVICE ","                      \
+	G_FILE_ATTRIBUTE_UNIX_INODE ","                       \
+	G_FILE_ATTRIBUTE_UNIX_UID ","                         \
+	G_FILE_ATTRIBUTE_UNIX_GID ","                         \
+	G_FILE_ATTRIBUTE_TIME_MODIFIED ","                    \
+	G_FILE_ATTRIBUTE_TIME_CHANGED ","                     \
+	ADD_PATH_TIME_ATTRIBUTES
+
+typedef struct
+{
+	GFile *workdir;
+	GAsyncQueue *repositories;
+	GAsyncQueue *results;
+	GCancellable *cancellable;
+	gboolean trust_filemode;
+	gint stopped;
+} AddPathsData;
+
+/* the stages of an index entry, 0 for a normal entry and 1 to 3 for the
+ * ancestor, ours and theirs sides of a conflict
+ */
+#define N_INDEX_STAGES 4
+
+typedef struct
+{
+	gchar *path;
+	guint32 old_mode;
+	git_index_entry entry;
+	GError *error;
+
+	/* the entries of the path before the job was added to the index */
+	git_index_entry saved[N_INDEX_STAGES];
+	gboolean has_saved[N_INDEX_STAGES];
+} AddPathJob;
+
+static void
+add_path_job_free (AddPathJob *job)
+{
+	gint stage;
+
+	for (stage = 0; stage < N_INDEX_STAGES; ++stage)
+	{
+		if (job->has_saved[stage])
+		{
+			g_free ((gchar *)job->saved[stage].path);
+		}
+	}
+
+	g_clear_error (&job->error);
+	g_free (job->path);
+	g_slice_free (AddPathJob, job);
+}
+
+static void
+add_path_job_save (AddPathJob *job,
+                   git_index  *index)
+{
+	gint stage;
+
+	for (stage = 0; stage < N_INDEX_STAGES; ++stage)
+	{
+		const git_index_entry *entry;
+
+		entry = git_index_get_bypath (index, job->path, stage);
+
+		if (entry != NULL)
+		{
+			job->saved[stage] = *entry;
+			job->saved[stage].path = g_strdup (entry->path);
+			job->has_saved[stage] = TRUE;
+		}
+	}
+}
+
+/* Puts back the entries saved by add_path_job_save() */
+static void
+add_path_job_restore (AddPathJob *job,
+                      git_index  *index)
+{
+	git_index_remove (index, job->path, 0);
+	git_index_conflict_remove (index, job->path);
+
+	if (job->has_saved[0])
+	{
+		git_index_add (index, &job->saved[0]);
+	}
+
+	if (job->has_saved[1] || job->has_saved[2] || job->has_saved[3])
+	{
+		git_index_conflict_add (index,
+		                        job->has_saved[1] ? &job->saved[1] : NULL,
+		                        job->has_saved[2] ? &job->saved[2] : NULL,
+		                        job->has_saved[3] ? &job->saved[3] : NULL);
+	}
+}
+
+static gboolean
+fill_index_entry (AddPathJob    *job,
+                  AddPathsData  *add,
+                  GFileInfo     *info)
+{
+	git_index_entry *entry = &job->entry;
+	guint32 unix_mode;
+
+	unix_mode = g_file_info_get_attribute_uint32 (info, G_FILE_ATTRIBUTE_UNIX_MODE);
+
+	switch (g_file_info_get_file_type (info))
+	{
+	case G_FILE_TYPE_SYMBOLIC_LINK:
+		entry->mode = GIT_FILEMODE_LINK;
+		break;
+	case G_FILE_TYPE_REGULAR:
+		if (!add->trust_filemode)
+		{
+			/* keep the executable bit that is already in the index */
+			entry->mode = job->old_mode == GIT_FILEMODE_BLOB_EXECUTABLE ?
+			              GIT_FILEMODE_BLOB_EXECUTABLE : GIT_FILEMODE_BLOB;
+		}
+		else
+		{
+			entry->mode = (unix_mode & 0100) ?
+			              GIT_FILEMODE_BLOB_EXECUTABLE : GIT_FILEMODE_BLOB;
+		}
+		break;
+	default:
+		g_set_error (&job->error,
+		             G_IO_ERROR,
+		             G_IO_ERROR_NOT_REGULAR_FILE,
+		             "'%s' is not a regular file or a symbolic link",
+		             job->path);
+		return FALSE;
+	}
+
+	entry->path = job->path;
+	entry->file_size = (guint32)g_file_info_get_size (info);
+	entry->dev = g_file_info_get_attribute_uint32 (info, G_FILE_ATTRIBUTE_UNIX_DEVICE);
+	entry->ino = (guint32)g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_UNIX_INODE);
+	entry->uid = g_file_info_get_attribute_uint32 (info, G_FILE_ATTRIBUTE_UNIX_UID);
+	entry->gid = g_file_info_get_attribute_uint32 (info, G_FILE_ATTRIBUTE_UNIX_GID);
+
+	entry->mtime.seconds = (gint32)g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED);
+	entry->ctime.seconds = (gint32)g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_TIME_CHANGED);
+
+#if GLIB_CHECK_VERSION (2, 74, 0)
+	entry->mtime.nanoseconds = g_file_info_get_attribute_uint32 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED_NSEC);
+	entry->ctime.nanoseconds = g_file_info_get_attribute_uint32 (info, G_FILE_ATTRIBUTE_TIME_CHANGED_NSEC);
+#else
+	entry->mtime.nanoseconds = g_file_info_get_attribute_uint32 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC) * 1000;
+	entry->ctime.nanoseconds = g_file_info_get_attribute_uint32 (info, G_FILE_ATTRIBUTE_TIME_CHANGED_USEC) * 1000;
+#endif
+
+	return TRUE;
+}
+
+static void
+add_path_worker (gpointer data,
+                 gpointer user_data)
+{
+	AddPathJob *job = data;
+	AddPathsData *add = user_data;
+	GgitRepository *repository;
+	GFileInfo *info;
+	GFile *file;
+	gint ret;
+
+	if (g_atomic_int_get (&add->stopped) ||
+	    g_cancellable_is_cancelled (add->cancellable))
+	{
+		g_async_queue_push (add->results, job);
+		return;
+	}
+
+	file = g_file_resolve_relative_path (add->workdir, job->path);
+	info = g_file_query_info (file,
+	                          ADD_PATH_ATTRIBUTES,
+	                          G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+	                          add->cancellable,
+	                          &job->error);
+	g_object_unref (file);
+
+	if (info != NULL && fill_index_entry (job, add, info))
+	{
+		repository = g_async_queue_pop (add->repositories);
+
+		/* applies the filters and writes the blob to the object database */
+		ret = git_blob_create_fromworkdir (&job->entry.id,
+		                                   _ggit_native_get (repository),
+		                                   job->path);
+
+		if (ret != GIT_OK)
+		{
+			/* libgit2 errors are per thread, so collect it here */
+			_ggit_error_set (&job->error, ret);
+		}
+
+		g_async_queue_push (add->repositories, repository);
+	}
+
+	g_clear_object (&info);
+	g_async_queue_push (add->results, job);
+}
+
+static gboolean
+finish_add_path_job (AddPathsData                  *add,
+                     gsize                          n_done,
+                     gsize                          n_total,
+                     GgitIndexAddProgressCallback   progress,
+                     gpointer                       user_data,
+                     GError                       **error)
+{
+	AddPathJob *job;
+
+	job = g_async_queue_pop (add->results);
+
+	if (g_cancellable_set_error_if_cancelled (add->cancellable, error))
+	{
+		return FALSE;
+	}
+
+	if (job->error != NULL)
+	{
+		g_propagate_error (error, job->error);
+		job->error = NULL;
+
+		return FALSE;
+	}
+
+	if (progress != NULL)
+	{
+		progress (job->path, n_done, n_total, user_data);
+	}
+
+	return TRUE;
+}
+
+static gboolean
+trust_filemode (GgitRepository *repository)
+{
+	git_config *config;
+	gint value = 1;
+
+	if (git_repository_config_snapshot (&config,
+	                                    _ggit_native_get (repository)) != GIT_OK)
+	{
+		return TRUE;
+	}
+
+	if (git_config_get_bool (&value, config, "core.filemode") != GIT_OK)
+	{
+		value = 1;
+	}
+
+	git_config_free (config);
+	return value != 0;
+}
+
+/**
+ * ggit_index_add_paths:
+ * @idx: a #GgitIndex.
+ * @paths: (array zero-terminated=1): the paths of the files to add.
+ * @n_threads: the number of worker threads, or 0 to use one per processor.
+ * @progress: (allow-none) (scope call) (closure user_data): a
+ *            #GgitIndexAddProgressCallback, or %NULL.
+ * @user_data: callback user data.
+ * @cancellable: (allow-none): a #GCancellable, or %NULL.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Add several files to the index at once. Like ggit_index_add_path(),
+ * @paths can be relative to the working directory or absolute paths
+ * inside it, and must point to regular files or symbolic links.
+ *
+ * The files are stat'ed and written to the object database on a pool of
+ * @n_threads worker threads, each with its own handle on the repository,
+ * while @progress is called on the calling thread as each file is done.
+ * The entries are only added to the index once all files were written,
+ * and if adding one of them fails the entries added before it are
+ * reverted, so on error or cancellation the index is left unchanged.
+ *
+ * libgit2 has no API to insert several entries at once, so the entries
+ * are still inserted one by one, each moving the entries sorted after it.
+ * Adding m files to an index of n entries thus costs O(n * m) memory moves
+ * on the calling thread, which is small next to hashing and writing the
+ * files but may show for very large indexes.
+ *
+ * Returns: %TRUE if the files were added to the index or %FALSE if there was an error.
+ *
+ **/
+gboolean
+ggit_index_add_paths (GgitIndex                     *idx,
+                      const gchar * const           *paths,
+                      gint                           n_threads,
+                      GgitIndexAddProgressCallback   progress,
+                      gpointer                       user_data,
+                      GCancellable                  *cancellable,
+                      GError                       **error)
+{
+	GgitRepository *repository;
+	git_index *index;
+	AddPathsData add;
+	GThreadPool *pool = NULL;
+	GPtrArray *jobs;
+	gsize n_total;
+	gsize n_done = 0;
+	gsize i;
+	gboolean ret = TRUE;
+
+	g_return_val_if_fail (GGIT_IS_INDEX (idx), FALSE);
+	g_return_val_if_fail (paths != NULL, FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	repository = ggit_index_get_owner (idx);
+	g_return_val_if_fail (repository != NULL, FALSE);
+
+	index = _ggit_native_get (idx);
+	add.workdir = ggit_repository_get_workdir (repository);
+
+	if (add.workdir == NULL)
+	{
+		g_set_error_literal (error,
+		                     G_IO_ERROR,
+		                     G_IO_ERROR_NOT_SUPPORTED,
+		                     "Cannot add files to the index of a bare repository");
+
+		g_object_unref (repository);
+		return FALSE;
+	}
+
+	n_total = g_strv_length ((gchar **)paths);
+	jobs = g_ptr_array_new_full (n_total, (GDestroyNotify)add_path_job_free);
+
+	for (i = 0; i < n_total; ++i)
+	{
+		const git_index_entry *existing;
+		AddPathJob *job;
+		GFile *file;
+		gchar *path;
+
+		file = g_file_resolve_relative_path (add.workdir, paths[i]);
+		path = g_file_get_relative_path (add.workdir, file);
+		g_object_unref (file);
+
+		if (path == NULL)
+		{
+			g_set_error (error,
+			             G_IO_ERROR,
+			             G_IO_ERROR_INVALID_ARGUMENT,
+			             "'%s' is outside of the working directory",
+			             paths[i]);
+
+			ret = FALSE;
+			break;
+		}
+
+#ifdef TRANSLATE_WINDOWS_PATHS
+		g_strdelimit (path, "\\", '/');
+#endif
+
+		job = g_slice_new0 (AddPathJob);
+		job->path = path;
+
+		existing = git_index_get_bypath (index, path, 0);
+
+		if (existing != NULL)
+		{
+			job->old_mode = existing->mode;
+		}
+
+		g_ptr_array_add (jobs, job);
+	}
+
+	if (!ret)
+	{
+		g_ptr_array_unref (jobs);
+		g_object_unref (add.workdir);
+		g_object_unref (repository);
+
+		return FALSE;
+	}
+
+	if (n_threads <= 0)
+	{
+		n_threads = g_get_num_processors ();
+	}
+
+	add.cancellable = cancellable;
+	add.trust_filemode = trust_filemode (repository);
+	add.stopped = FALSE;
+	add.results = g_async_queue_new ();
+
+	if (n_total > 1)
+	{
+		add.repositories = _ggit_repository_open_workers (repository, n_threads);
+		n_threads = g_async_queue_length (add.repositories);
+
+		if (n_threads > 0)
+		{
+			pool = g_thread_pool_new (add_path_worker,
+			                          &add,
+			                          n_threads,
+			                          FALSE,
+			                          NULL);
+		}
+	}
+	else
+	{
+		add.repositories = g_async_queue_new_full (g_object_unref);
+	}
+
+	if (pool == NULL)
+	{
+		g_async_queue_push (add.repositories, g_object_ref (repository));
+
+		for (i = 0; i < n_total && ret; ++i)
+		{
+			add_path_worker (g_ptr_array_index (jobs, i), &add);
+			ret = finish_add_path_job (&add, ++n_done, n_total,
+			                           progress, user_data, error);
+		}
+	}
+	else
+	{
+		for (i = 0; i < n_total; ++i)
+		{
+			g_thread_pool_push (pool, g_ptr_array_index (jobs, i), NULL);
+		}
+
+		for (i = 0; i < n_total; ++i)
+		{
+			if (!ret)
+			{
+				/* drain the remaining results */
+				g_async_queue_pop (add.results);
+				continue;
+			}
+
+			ret = finish_add_path_job (&add, ++n_done, n_total,
+			                           progress, user_data, error);
+
+			if (!ret)
+			{
+				g_atomic_int_set (&add.stopped, TRUE);
+			}
+		}
+
+		g_thread_pool_free (pool, FALSE, TRUE);
+	}
+
+	g_async_queue_unref (add.repositories);
+	g_async_queue_unref (add.results);
+
+	if (ret)
+	{
+		/* there is no bulk insertion in libgit2, git_index_add() keeps
+		 * the entries sorted by moving the ones after the new entry
+		 */
+		for (i = 0; i < n_total; ++i)
+		{
+			AddPathJob *job = g_ptr_array_index (jobs, i);
+			gint err;
+
+			add_path_job_save (job, index);
+
+			err = git_index_add (index, &job->entry);
+
+			if (err == GIT_OK)
+			{
+				err = git_index_conflict_remove (index, job->path);
+
+				if (err == GIT_ENOTFOUND)
+				{
+					err = GIT_OK;
+				}
+			}
+
+			if (err != GIT_OK)
+			{
+				_ggit_error_set (error, err);
+				ret = FALSE;
+				break;
+			}
+		}
+
+		if (!ret)
+		{
+			/* in reverse order, in case a path was given twice */
+			do
+			{
+				add_path_job_restore (g_ptr_array_index (jobs, i), index);
+			}
+			while (i-- > 0);
+		}
+	}
+
+	g_ptr_array_unref (jobs);
+	g_object_unref (add.workdir);
+	g_object_unref (repository);
+
+	return ret;
+}
+
 /**
  * ggit_index_get_owner:
  * @idx: a #GgitIndex.
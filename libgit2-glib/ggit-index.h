@@ -25,6 +25,7 @@
 #include <gio/gio.h>
 #include <git2.h>
 #include <libgit2-glib/ggit-types.h>
+#include <libgit2-glib/ggit-index-snapshot.h>
 #include "ggit-native.h"
 
 G_BEGIN_DECLS
@@ -69,6 +70,14 @@ gboolean                  ggit_index_add_path                 (GgitIndex       *
                                                                const gchar     *path,
                                                                GError         **error);
 
+gboolean                  ggit_index_add_paths                (GgitIndex                     *idx,
+                                                               const gchar * const           *paths,
+                                                               gint                           n_threads,
+                                                               GgitIndexAddProgressCallback   progress,
+                                                               gpointer                       user_data,
+                                                               GCancellable                  *cancellable,
+                                                               GError                       **error);
+
 GgitRepository           *ggit_index_get_owner                (GgitIndex  *idx);
 
 gboolean                  ggit_index_has_conflicts            (GgitIndex  *idx);
@@ -77,6 +86,8 @@ GgitIndexEntries         *ggit_index_get_entries              (GgitIndex  *idx);
 GgitIndexEntriesResolveUndo *
                           ggit_index_get_entries_resolve_undo (GgitIndex  *idx);
 
+GgitIndexSnapshot        *ggit_index_get_snapshot             (GgitIndex  *idx);
+
 G_END_DECLS
 
 #endif /* __GGIT_INDEX_H__ */
@@ -0,0 +1,472 @@
+/*
+ * ggit-log-pipeline.c
+ * This file is part of libgit2-glib
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <git2.h>
+
+#include "ggit-log-pipeline.h"
+#include "ggit-commit-info.h"
+#include "ggit-error.h"
+#include "ggit-repository.h"
+
+/* the number of commits read ahead of the consumer, per worker */
+#define PREFETCH_PER_THREAD 16
+
+/**
+ * GgitLogPipeline:
+ *
+ * Reads the commits of a revision walk on a pool of worker threads, ahead
+ * of the consumer.
+ */
+struct _GgitLogPipeline
+{
+	GObject parent_instance;
+
+	GgitRevisionWalker *walker;
+	gint n_threads;
+	gboolean diff_stats;
+
+	/* set up on the first call to ggit_log_pipeline_next() */
+	gboolean started;
+	GThreadPool *pool;
+	GAsyncQueue *repositories;
+	GAsyncQueue *results;
+	gsize window;
+
+	/* finished LogJob, by index, waiting for their turn */
+	GHashTable *pending;
+	gsize next_dispatch;
+	gsize next_deliver;
+	gsize in_flight;
+	gboolean walk_done;
+
+	/* reported by the next call, after the commits that preceded it */
+	GError *error;
+};
+
+typedef struct
+{
+	gsize idx;
+	git_oid id;
+
+	GgitCommitInfo *info;
+	GError *error;
+} LogJob;
+
+G_DEFINE_TYPE (GgitLogPipeline, ggit_log_pipeline, G_TYPE_OBJECT)
+
+static void
+log_job_free (LogJob *job)
+{
+	if (job->info != NULL)
+	{
+		ggit_commit_info_unref (job->info);
+	}
+
+	g_clear_error (&job->error);
+
+	g_slice_free (LogJob, job);
+}
+
+static void
+ggit_log_pipeline_finalize (GObject *object)
+{
+	GgitLogPipeline *pipeline = GGIT_LOG_PIPELINE (object);
+
+	if (pipeline->pool != NULL)
+	{
+		/* the jobs still queued were read ahead, let them finish */
+		g_thread_pool_free (pipeline->pool, FALSE, TRUE);
+	}
+
+	if (pipeline->results != NULL)
+	{
+		LogJob *job;
+
+		while ((job = g_async_queue_try_pop (pipeline->results)) != NULL)
+		{
+			log_job_free (job);
+		}
+
+		g_async_queue_unref (pipeline->results);
+	}
+
+	if (pipeline->repositories != NULL)
+	{
+		g_async_queue_unref (pipeline->repositories);
+	}
+
+	g_hash_table_destroy (pipeline->pending);
+	g_clear_error (&pipeline->error);
+	g_clear_object (&pipeline->walker);
+
+	G_OBJECT_CLASS (ggit_log_pipeline_parent_class)->finalize (object);
+}
+
+static void
+ggit_log_pipeline_class_init (GgitLogPipelineClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+	object_class->finalize = ggit_log_pipeline_finalize;
+}
+
+static void
+ggit_log_pipeline_init (GgitLogPipeline *pipeline)
+{
+	pipeline->pending = g_hash_table_new_full (g_direct_hash,
+	                                           g_direct_equal,
+	                                           NULL,
+	                                           (GDestroyNotify)log_job_free);
+}
+
+static gint
+compute_diff_stats (git_repository *repo,
+                    GgitCommitInfo *info)
+{
+	const git_oid *parent_id;
+	git_commit *parent = NULL;
+	git_tree *parent_tree = NULL;
+	git_tree *tree = NULL;
+	git_diff *diff = NULL;
+	git_diff_stats *stats = NULL;
+	gint ret;
+
+	ret = git_tree_lookup (&tree, repo, _ggit_commit_info_get_tree_id (info));
+	parent_id = _ggit_commit_info_get_parent_id (info, 0);
+
+	/* a root commit is compared to the empty tree */
+	if (ret == GIT_OK && parent_id != NULL)
+	{
+		ret = git_commit_lookup (&parent, repo, parent_id);
+
+		if (ret == GIT_OK)
+		{
+			ret = git_commit_tree (&parent_tree, parent);
+		}
+	}
+
+	if (ret == GIT_OK)
+	{
+		ret = git_diff_tree_to_tree (&diff, repo, parent_tree, tree, NULL);
+	}
+
+	if (ret == GIT_OK)
+	{
+		ret = git_diff_get_stats (&stats, diff);
+	}
+
+	if (ret == GIT_OK)
+	{
+		_ggit_commit_info_set_diff_stats (info,
+		                                  git_diff_stats_files_changed (stats),
+		                                  git_diff_stats_insertions (stats),
+		                                  git_diff_stats_deletions (stats));
+	}
+
+	git_diff_stats_free (stats);
+	git_diff_free (diff);
+	git_tree_free (parent_tree);
+	git_commit_free (parent);
+	git_tree_free (tree);
+
+	return ret;
+}
+
+static void
+read_commit_worker (gpointer data,
+                    gpointer user_data)
+{
+	LogJob *job = data;
+	GgitLogPipeline *pipeline = user_data;
+	GgitRepository *repository;
+	git_repository *repo;
+	git_odb *odb;
+	gint ret;
+
+	repository = g_async_queue_pop (pipeline->repositories);
+	repo = _ggit_native_get (repository);
+
+	ret = git_repository_odb (&odb, repo);
+
+	if (ret == GIT_OK)
+	{
+		job->info = _ggit_commit_info_read (odb, &job->id, &job->error);
+		git_odb_free (odb);
+	}
+	else
+	{
+		/* libgit2 errors are per thread, so collect it here */
+		_ggit_error_set (&job->error, ret);
+	}
+
+	if (job->info != NULL && pipeline->diff_stats)
+	{
+		ret = compute_diff_stats (repo, job->info);
+
+		if (ret != GIT_OK)
+		{
+			_ggit_error_set (&job->error, ret);
+		}
+	}
+
+	g_async_queue_push (pipeline->repositories, repository);
+	g_async_queue_push (pipeline->results, job);
+}
+
+static void
+start (GgitLogPipeline *pipeline)
+{
+	GgitRepository *repository;
+	gint n_threads;
+
+	pipeline->started = TRUE;
+	pipeline->results = g_async_queue_new ();
+
+	repository = ggit_revision_walker_get_repository (pipeline->walker);
+
+	pipeline->repositories = _ggit_repository_open_workers (repository,
+	                                                        pipeline->n_threads);
+	n_threads = g_async_queue_length (pipeline->repositories);
+
+	if (n_threads > 0)
+	{
+		pipeline->pool = g_thread_pool_new (read_commit_worker,
+		                                    pipeline,
+		                                    n_threads,
+		                                    FALSE,
+		                                    NULL);
+
+		pipeline->window = n_threads * PREFETCH_PER_THREAD;
+	}
+
+	if (pipeline->pool == NULL)
+	{
+		/* read the commits on the calling thread, as they are needed */
+		g_async_queue_push (pipeline->repositories, g_object_ref (repository));
+	}
+}
+
+/* Walks up to the @limit'th commit, handing the commits to the workers */
+static void
+dispatch (GgitLogPipeline *pipeline,
+          gsize            limit)
+{
+	while (!pipeline->walk_done && pipeline->next_dispatch < limit)
+	{
+		LogJob *job;
+		gint ret;
+
+		job = g_slice_new0 (LogJob);
+		ret = _ggit_revision_walker_next_id (pipeline->walker, &job->id);
+
+		if (ret == GIT_ITEROVER)
+		{
+			pipeline->walk_done = TRUE;
+			g_slice_free (LogJob, job);
+
+			break;
+		}
+
+		job->idx = pipeline->next_dispatch++;
+		++pipeline->in_flight;
+
+		if (ret != GIT_OK)
+		{
+			/* delivered in order, after the commits walked so far */
+			pipeline->walk_done = TRUE;
+			_ggit_error_set (&job->error, ret);
+
+			g_async_queue_push (pipeline->results, job);
+		}
+		else if (pipeline->pool != NULL)
+		{
+			g_thread_pool_push (pipeline->pool, job, NULL);
+		}
+		else
+		{
+			read_commit_worker (job, pipeline);
+		}
+	}
+}
+
+/**
+ * ggit_log_pipeline_new:
+ * @walker: a #GgitRevisionWalker.
+ * @n_threads: the number of worker threads, or 0 to use one per processor.
+ * @diff_stats: whether to compute the diff statistics of each commit.
+ *
+ * Creates a pipeline reading the commits of @walker. The commits are read
+ * and parsed into #GgitCommitInfo on @n_threads worker threads, each with
+ * its own handle on the repository. The workers keep reading the next
+ * commits while the previous batch is being consumed.
+ *
+ * The walk itself happens on the thread calling ggit_log_pipeline_next(),
+ * on the handle of @walker, which is the one its commits were pushed on.
+ * It only touches the commit graph, but when @walker is limited with
+ * ggit_revision_walker_set_paths(), comparing each commit to its parents
+ * also looks up their trees on that thread. Such a walk is bounded by one
+ * thread however many workers there are.
+ *
+ * If @diff_stats is %TRUE, the workers also diff each commit against its
+ * first parent, see ggit_commit_info_get_diff_stats().
+ *
+ * @walker must be set up (sorting, paths, pushed and hidden commits)
+ * before the first call to ggit_log_pipeline_next() and must not be used
+ * directly afterwards.
+ *
+ * Returns: (transfer full): a new #GgitLogPipeline.
+ */
+GgitLogPipeline *
+ggit_log_pipeline_new (GgitRevisionWalker *walker,
+                       gint                n_threads,
+                       gboolean            diff_stats)
+{
+	GgitLogPipeline *pipeline;
+
+	g_return_val_if_fail (GGIT_IS_REVISION_WALKER (walker), NULL);
+
+	pipeline = g_object_new (GGIT_TYPE_LOG_PIPELINE, NULL);
+
+	pipeline->walker = g_object_ref (walker);
+	pipeline->n_threads = n_threads > 0 ? n_threads : (gint)g_get_num_processors ();
+	pipeline->diff_stats = diff_stats;
+
+	return pipeline;
+}
+
+/**
+ * ggit_log_pipeline_get_walker:
+ * @pipeline: a #GgitLogPipeline.
+ *
+ * Gets the revision walker of @pipeline.
+ *
+ * Returns: (transfer none): a #GgitRevisionWalker.
+ */
+GgitRevisionWalker *
+ggit_log_pipeline_get_walker (GgitLogPipeline *pipeline)
+{
+	g_return_val_if_fail (GGIT_IS_LOG_PIPELINE (pipeline), NULL);
+
+	return pipeline->walker;
+}
+
+/**
+ * ggit_log_pipeline_next:
+ * @pipeline: a #GgitLogPipeline.
+ * @max_count: the maximum number of commits to return.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Gets up to @max_count next commits of the walk, in the order of the
+ * walk. An empty array is returned when the walk is over.
+ *
+ * If a commit can not be walked or read, the commits before it are
+ * returned first and the error is reported by the next call. The walk
+ * goes on after a commit that could not be read, but not after a walk
+ * error.
+ *
+ * Returns: (transfer container) (element-type GgitCommitInfo) (nullable):
+ *          the next commits or %NULL if there was an error.
+ */
+GPtrArray *
+ggit_log_pipeline_next (GgitLogPipeline  *pipeline,
+                        guint             max_count,
+                        GError          **error)
+{
+	GPtrArray *batch;
+
+	g_return_val_if_fail (GGIT_IS_LOG_PIPELINE (pipeline), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	if (pipeline->error != NULL)
+	{
+		g_propagate_error (error, pipeline->error);
+		pipeline->error = NULL;
+
+		return NULL;
+	}
+
+	if (!pipeline->started)
+	{
+		start (pipeline);
+	}
+
+	/* max_count can be far more than the walk has left, only reserve what
+	 * the workers read ahead, which is nothing without a thread pool */
+	batch = g_ptr_array_new_full (MIN (max_count, pipeline->window),
+	                              (GDestroyNotify)ggit_commit_info_unref);
+
+	while (batch->len < max_count)
+	{
+		LogJob *job;
+
+		dispatch (pipeline,
+		          pipeline->next_deliver + (max_count - batch->len) + pipeline->window);
+
+		job = g_hash_table_lookup (pipeline->pending,
+		                           GSIZE_TO_POINTER (pipeline->next_deliver));
+
+		if (job == NULL)
+		{
+			if (pipeline->in_flight == 0)
+			{
+				break;
+			}
+
+			job = g_async_queue_pop (pipeline->results);
+			--pipeline->in_flight;
+
+			g_hash_table_insert (pipeline->pending, GSIZE_TO_POINTER (job->idx), job);
+			continue;
+		}
+
+		g_hash_table_steal (pipeline->pending, GSIZE_TO_POINTER (pipeline->next_deliver));
+		++pipeline->next_deliver;
+
+		if (job->error != NULL && batch->len > 0)
+		{
+			/* do not lose the commits read before the error */
+			pipeline->error = job->error;
+			job->error = NULL;
+
+			log_job_free (job);
+			break;
+		}
+		else if (job->error != NULL)
+		{
+			g_propagate_error (error, job->error);
+			job->error = NULL;
+
+			log_job_free (job);
+			g_ptr_array_unref (batch);
+
+			return NULL;
+		}
+
+		g_ptr_array_add (batch, job->info);
+		job->info = NULL;
+
+		log_job_free (job);
+	}
+
+	/* keep the workers busy while this batch is consumed */
+	dispatch (pipeline, pipeline->next_deliver + pipeline->window);
+
+	return batch;
+}
+
+/* ex:set ts=8 noet: */
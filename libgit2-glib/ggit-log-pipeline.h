@@ -0,0 +1,47 @@
+/*
+ * ggit-log-pipeline.h
+ * This file is part of libgit2-glib
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GGIT_LOG_PIPELINE_H__
+#define __GGIT_LOG_PIPELINE_H__
+
+#include <glib-object.h>
+#include <git2.h>
+
+#include <libgit2-glib/ggit-types.h>
+#include <libgit2-glib/ggit-revision-walker.h>
+
+G_BEGIN_DECLS
+
+#define GGIT_TYPE_LOG_PIPELINE (ggit_log_pipeline_get_type ())
+G_DECLARE_FINAL_TYPE (GgitLogPipeline, ggit_log_pipeline, GGIT, LOG_PIPELINE, GObject)
+
+GgitLogPipeline    *ggit_log_pipeline_new        (GgitRevisionWalker  *walker,
+                                                  gint                 n_threads,
+                                                  gboolean             diff_stats);
+
+GgitRevisionWalker *ggit_log_pipeline_get_walker (GgitLogPipeline     *pipeline);
+
+GPtrArray          *ggit_log_pipeline_next       (GgitLogPipeline     *pipeline,
+                                                  guint                max_count,
+                                                  GError             **error);
+
+G_END_DECLS
+
+#endif /* __GGIT_LOG_PIPELINE_H__ */
+
+/* ex:set ts=8 noet: */
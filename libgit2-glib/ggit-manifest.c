@@ -0,0 +1,332 @@
+/*
+ * ggit-manifest.c
+ * This file is part of libgit2-glib
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include <git2.h>
+
+#include "ggit-manifest.h"
+#include "ggit-oid.h"
+
+struct _GgitManifest
+{
+	gint ref_count;
+
+	/* nul-separated paths, sorted */
+	GString *paths;
+	/* offset of each path in paths */
+	GArray *offsets;
+
+	GgitOIdArray *oids;
+	/* GgitFileMode of each entry */
+	GArray *modes;
+};
+
+G_DEFINE_BOXED_TYPE (GgitManifest, ggit_manifest,
+                     ggit_manifest_ref, ggit_manifest_unref)
+
+/*
+ * _ggit_manifest_new:
+ * @paths: (transfer full): the paths, each followed by a nul byte.
+ * @offsets: (transfer full): the gsize offset of each path in @paths.
+ * @oids: (transfer full): the id of each entry.
+ * @modes: (transfer full): the guint32 mode of each entry.
+ *
+ * Creates a manifest from its columns, which must be sorted by path.
+ */
+GgitManifest *
+_ggit_manifest_new (GString      *paths,
+                    GArray       *offsets,
+                    GgitOIdArray *oids,
+                    GArray       *modes)
+{
+	GgitManifest *manifest;
+
+	manifest = g_slice_new (GgitManifest);
+	manifest->ref_count = 1;
+	manifest->paths = paths;
+	manifest->offsets = offsets;
+	manifest->oids = oids;
+	manifest->modes = modes;
+
+	return manifest;
+}
+
+/**
+ * ggit_manifest_ref:
+ * @manifest: a #GgitManifest.
+ *
+ * Atomically increments the reference count of @manifest by one.
+ * This function is MT-safe and may be called from any thread.
+ *
+ * Returns: (transfer none) (nullable): a #GgitManifest or %NULL.
+ **/
+GgitManifest *
+ggit_manifest_ref (GgitManifest *manifest)
+{
+	g_return_val_if_fail (manifest != NULL, NULL);
+
+	g_atomic_int_inc (&manifest->ref_count);
+
+	return manifest;
+}
+
+/**
+ * ggit_manifest_unref:
+ * @manifest: a #GgitManifest.
+ *
+ * Atomically decrements the reference count of @manifest by one.
+ * If the reference count drops to 0, @manifest is freed.
+ **/
+void
+ggit_manifest_unref (GgitManifest *manifest)
+{
+	g_return_if_fail (manifest != NULL);
+
+	if (g_atomic_int_dec_and_test (&manifest->ref_count))
+	{
+		g_string_free (manifest->paths, TRUE);
+		g_array_unref (manifest->offsets);
+		ggit_oid_array_unref (manifest->oids);
+		g_array_unref (manifest->modes);
+
+		g_slice_free (GgitManifest, manifest);
+	}
+}
+
+/**
+ * ggit_manifest_get_size:
+ * @manifest: a #GgitManifest.
+ *
+ * Gets the number of files in @manifest.
+ *
+ * Returns: the number of files in @manifest.
+ **/
+gsize
+ggit_manifest_get_size (GgitManifest *manifest)
+{
+	g_return_val_if_fail (manifest != NULL, 0);
+
+	return manifest->offsets->len;
+}
+
+/**
+ * ggit_manifest_get_path:
+ * @manifest: a #GgitManifest.
+ * @index: the index of the file.
+ *
+ * Gets the path of the file at @index, relative to the root of the tree.
+ *
+ * Returns: (transfer none) (nullable): the path, or %NULL if @index is out
+ * of bounds.
+ **/
+const gchar *
+ggit_manifest_get_path (GgitManifest *manifest,
+                        gsize         index)
+{
+	g_return_val_if_fail (manifest != NULL, NULL);
+	g_return_val_if_fail (index < manifest->offsets->len, NULL);
+
+	return manifest->paths->str + g_array_index (manifest->offsets, gsize, index);
+}
+
+/**
+ * ggit_manifest_get_id:
+ * @manifest: a #GgitManifest.
+ * @index: the index of the file.
+ *
+ * Gets the id of the object of the file at @index.
+ *
+ * Returns: (transfer full) (nullable): a #GgitOId, or %NULL if @index is
+ * out of bounds.
+ **/
+GgitOId *
+ggit_manifest_get_id (GgitManifest *manifest,
+                      gsize         index)
+{
+	g_return_val_if_fail (manifest != NULL, NULL);
+
+	return ggit_oid_array_get (manifest->oids, index);
+}
+
+/**
+ * ggit_manifest_get_mode:
+ * @manifest: a #GgitManifest.
+ * @index: the index of the file.
+ *
+ * Gets the mode of the file at @index.
+ *
+ * Returns: the #GgitFileMode of the file.
+ **/
+GgitFileMode
+ggit_manifest_get_mode (GgitManifest *manifest,
+                        gsize         index)
+{
+	g_return_val_if_fail (manifest != NULL, GGIT_FILE_MODE_UNREADABLE);
+	g_return_val_if_fail (index < manifest->modes->len, GGIT_FILE_MODE_UNREADABLE);
+
+	return (GgitFileMode)g_array_index (manifest->modes, guint32, index);
+}
+
+/**
+ * ggit_manifest_get_ids:
+ * @manifest: a #GgitManifest.
+ *
+ * Gets the ids of all the files of @manifest, in the order of their paths.
+ * The returned array must not be modified.
+ *
+ * Returns: (transfer none): the ids of the files.
+ **/
+GgitOIdArray *
+ggit_manifest_get_ids (GgitManifest *manifest)
+{
+	g_return_val_if_fail (manifest != NULL, NULL);
+
+	return manifest->oids;
+}
+
+/**
+ * ggit_manifest_lookup:
+ * @manifest: a #GgitManifest.
+ * @path: the path of a file.
+ *
+ * Finds the file at @path in @manifest.
+ *
+ * Returns: the index of the file, or -1 if it is not in @manifest.
+ **/
+gssize
+ggit_manifest_lookup (GgitManifest *manifest,
+                      const gchar  *path)
+{
+	gsize lo = 0;
+	gsize hi;
+
+	g_return_val_if_fail (manifest != NULL, -1);
+	g_return_val_if_fail (path != NULL, -1);
+
+	hi = manifest->offsets->len;
+
+	while (lo < hi)
+	{
+		gsize mid = lo + (hi - lo) / 2;
+		gint cmp;
+
+		cmp = strcmp (ggit_manifest_get_path (manifest, mid), path);
+
+		if (cmp == 0)
+		{
+			return mid;
+		}
+		else if (cmp < 0)
+		{
+			lo = mid + 1;
+		}
+		else
+		{
+			hi = mid;
+		}
+	}
+
+	return -1;
+}
+
+static gboolean
+manifest_entries_equal (GgitManifest *a,
+                        gsize         ia,
+                        GgitManifest *b,
+                        gsize         ib)
+{
+	return g_array_index (a->modes, guint32, ia) == g_array_index (b->modes, guint32, ib) &&
+	       git_oid_equal (_ggit_oid_array_get_oid (a->oids, ia),
+	                      _ggit_oid_array_get_oid (b->oids, ib));
+}
+
+/**
+ * ggit_manifest_diff:
+ * @old_manifest: a #GgitManifest.
+ * @new_manifest: a #GgitManifest.
+ * @callback: (scope call): the callback to call for each difference.
+ * @user_data: (closure): user data for the callback.
+ *
+ * Compares two manifests by merging their sorted paths, and calls
+ * @callback for each file that was added, removed, or whose id or mode
+ * changed, in the order of the paths.
+ *
+ * Returns: 0, or the non-zero value returned by @callback to stop.
+ **/
+gint
+ggit_manifest_diff (GgitManifest             *old_manifest,
+                    GgitManifest             *new_manifest,
+                    GgitManifestDiffCallback  callback,
+                    gpointer                  user_data)
+{
+	gsize n_old;
+	gsize n_new;
+	gsize i = 0;
+	gsize j = 0;
+	gint ret = 0;
+
+	g_return_val_if_fail (old_manifest != NULL, 0);
+	g_return_val_if_fail (new_manifest != NULL, 0);
+	g_return_val_if_fail (callback != NULL, 0);
+
+	n_old = ggit_manifest_get_size (old_manifest);
+	n_new = ggit_manifest_get_size (new_manifest);
+
+	while (ret == 0 && (i < n_old || j < n_new))
+	{
+		const gchar *old_path = i < n_old ? ggit_manifest_get_path (old_manifest, i) : NULL;
+		const gchar *new_path = j < n_new ? ggit_manifest_get_path (new_manifest, j) : NULL;
+		gint cmp;
+
+		if (old_path == NULL)
+		{
+			cmp = 1;
+		}
+		else if (new_path == NULL)
+		{
+			cmp = -1;
+		}
+		else
+		{
+			cmp = strcmp (old_path, new_path);
+		}
+
+		if (cmp < 0)
+		{
+			ret = callback (old_path, i++, -1, user_data);
+		}
+		else if (cmp > 0)
+		{
+			ret = callback (new_path, -1, j++, user_data);
+		}
+		else
+		{
+			if (!manifest_entries_equal (old_manifest, i, new_manifest, j))
+			{
+				ret = callback (new_path, i, j, user_data);
+			}
+
+			++i;
+			++j;
+		}
+	}
+
+	return ret;
+}
+
+/* ex:set ts=8 noet: */
@@ -0,0 +1,70 @@
+/*
+ * ggit-manifest.h
+ * This file is part of libgit2-glib
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GGIT_MANIFEST_H__
+#define __GGIT_MANIFEST_H__
+
+#include <glib-object.h>
+#include <git2.h>
+
+#include <libgit2-glib/ggit-types.h>
+#include <libgit2-glib/ggit-oid-array.h>
+
+G_BEGIN_DECLS
+
+#define GGIT_TYPE_MANIFEST       (ggit_manifest_get_type ())
+#define GGIT_MANIFEST(obj)       ((GgitManifest *)obj)
+
+GType           ggit_manifest_get_type   (void) G_GNUC_CONST;
+
+GgitManifest   *_ggit_manifest_new       (GString                  *paths,
+                                          GArray                   *offsets,
+                                          GgitOIdArray             *oids,
+                                          GArray                   *modes);
+
+GgitManifest   *ggit_manifest_ref        (GgitManifest             *manifest);
+void            ggit_manifest_unref      (GgitManifest             *manifest);
+
+gsize           ggit_manifest_get_size   (GgitManifest             *manifest);
+
+const gchar    *ggit_manifest_get_path   (GgitManifest             *manifest,
+                                          gsize                     index);
+
+GgitOId        *ggit_manifest_get_id     (GgitManifest             *manifest,
+                                          gsize                     index);
+
+GgitFileMode    ggit_manifest_get_mode   (GgitManifest             *manifest,
+                                          gsize                     index);
+
+GgitOIdArray   *ggit_manifest_get_ids    (GgitManifest             *manifest);
+
+gssize          ggit_manifest_lookup     (GgitManifest             *manifest,
+                                          const gchar              *path);
+
+gint            ggit_manifest_diff       (GgitManifest             *old_manifest,
+                                          GgitManifest             *new_manifest,
+                                          GgitManifestDiffCallback  callback,
+                                          gpointer                  user_data);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (GgitManifest, ggit_manifest_unref)
+
+G_END_DECLS
+
+#endif /* __GGIT_MANIFEST_H__ */
+
+/* ex:set ts=8 noet: */
@@ -0,0 +1,236 @@
+/*
+ * ggit-mempack.c
+ * This file is part of libgit2-glib
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ggit-mempack.h"
+
+#include <git2.h>
+#include <git2/sys/odb_backend.h>
+#include <git2/sys/mempack.h>
+
+#include "ggit-error.h"
+#include "ggit-repository.h"
+
+/**
+ * GgitMempack:
+ *
+ * An object database backend that keeps every object written to it in
+ * memory. Once added to the object database of a repository with a high
+ * priority, objects created in the repository are not written as loose
+ * objects but collected in the mempack, and can be written to a single
+ * packfile with ggit_mempack_write_pack().
+ *
+ * A mempack is not thread safe, objects must not be written to it from
+ * several threads at once.
+ */
+struct _GgitMempack
+{
+	GgitOdbBackend parent_instance;
+};
+
+G_DEFINE_TYPE (GgitMempack, ggit_mempack, GGIT_TYPE_ODB_BACKEND)
+
+static void
+ggit_mempack_class_init (GgitMempackClass *klass)
+{
+}
+
+static void
+ggit_mempack_init (GgitMempack *mempack)
+{
+}
+
+/**
+ * ggit_mempack_new:
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Create a new in-memory object database backend. Add it to the object
+ * database of a repository with ggit_odb_add_backend(), using a priority
+ * higher than the default backends (which use 1 and 2) so that new objects
+ * are written to it.
+ *
+ * Returns: (transfer full) (nullable): a new #GgitMempack, or %NULL on
+ * error.
+ *
+ **/
+GgitMempack *
+ggit_mempack_new (GError **error)
+{
+	GgitMempack *mempack;
+	git_odb_backend *backend;
+	gint ret;
+
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	ret = git_mempack_new (&backend);
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (error, ret);
+		return NULL;
+	}
+
+	mempack = g_object_new (GGIT_TYPE_MEMPACK, NULL);
+	_ggit_odb_backend_set_native_backend (GGIT_ODB_BACKEND (mempack), backend);
+
+	return mempack;
+}
+
+/**
+ * ggit_mempack_dump:
+ * @mempack: a #GgitMempack.
+ * @repository: the #GgitRepository the objects belong to.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Write all the objects stored in @mempack to a packfile in memory. The
+ * objects are kept in @mempack.
+ *
+ * Returns: (transfer full) (nullable): the content of the packfile, or
+ * %NULL on error.
+ *
+ **/
+GBytes *
+ggit_mempack_dump (GgitMempack     *mempack,
+                   GgitRepository  *repository,
+                   GError         **error)
+{
+	git_buf buf = {0,};
+	GBytes *bytes;
+	gint ret;
+
+	g_return_val_if_fail (GGIT_IS_MEMPACK (mempack), NULL);
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	ret = git_mempack_dump (&buf,
+	                        _ggit_native_get (repository),
+	                        _ggit_odb_backend_get_native_backend (GGIT_ODB_BACKEND (mempack)));
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (error, ret);
+		return NULL;
+	}
+
+	bytes = g_bytes_new (buf.ptr, buf.size);
+
+#if LIBGIT2_VER_MAJOR > 0 || (LIBGIT2_VER_MAJOR == 0 && LIBGIT2_VER_MINOR >= 28)
+	git_buf_dispose (&buf);
+#else
+	git_buf_free (&buf);
+#endif
+
+	return bytes;
+}
+
+/**
+ * ggit_mempack_write_pack:
+ * @mempack: a #GgitMempack.
+ * @repository: the #GgitRepository the objects belong to.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Write all the objects stored in @mempack to a single packfile in the
+ * object database of @repository, and remove them from @mempack.
+ *
+ * Returns: %TRUE if the packfile was written, %FALSE otherwise.
+ *
+ **/
+gboolean
+ggit_mempack_write_pack (GgitMempack     *mempack,
+                         GgitRepository  *repository,
+                         GError         **error)
+{
+	git_odb_backend *backend;
+	git_odb_writepack *writepack = NULL;
+	git_transfer_progress stats = {0,};
+	git_odb *odb = NULL;
+	git_buf buf = {0,};
+	gint ret;
+
+	g_return_val_if_fail (GGIT_IS_MEMPACK (mempack), FALSE);
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	backend = _ggit_odb_backend_get_native_backend (GGIT_ODB_BACKEND (mempack));
+
+	ret = git_mempack_dump (&buf, _ggit_native_get (repository), backend);
+
+	if (ret == GIT_OK)
+	{
+		ret = git_repository_odb (&odb, _ggit_native_get (repository));
+	}
+
+	if (ret == GIT_OK)
+	{
+		ret = git_odb_write_pack (&writepack, odb, NULL, NULL);
+	}
+
+	if (ret == GIT_OK)
+	{
+		ret = writepack->append (writepack, buf.ptr, buf.size, &stats);
+	}
+
+	if (ret == GIT_OK)
+	{
+		ret = writepack->commit (writepack, &stats);
+	}
+
+	if (writepack != NULL)
+	{
+		writepack->free (writepack);
+	}
+
+	if (odb != NULL)
+	{
+		git_odb_free (odb);
+	}
+
+#if LIBGIT2_VER_MAJOR > 0 || (LIBGIT2_VER_MAJOR == 0 && LIBGIT2_VER_MINOR >= 28)
+	git_buf_dispose (&buf);
+#else
+	git_buf_free (&buf);
+#endif
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (error, ret);
+		return FALSE;
+	}
+
+	git_mempack_reset (backend);
+
+	return TRUE;
+}
+
+/**
+ * ggit_mempack_reset:
+ * @mempack: a #GgitMempack.
+ *
+ * Remove all the objects stored in @mempack. Objects that are still
+ * referenced elsewhere, for example by a tree that was not written to a
+ * packfile, become unreachable.
+ *
+ **/
+void
+ggit_mempack_reset (GgitMempack *mempack)
+{
+	g_return_if_fail (GGIT_IS_MEMPACK (mempack));
+
+	git_mempack_reset (_ggit_odb_backend_get_native_backend (GGIT_ODB_BACKEND (mempack)));
+}
+
+/* ex:set ts=8 noet: */
@@ -0,0 +1,49 @@
+/*
+ * ggit-mempack.h
+ * This file is part of libgit2-glib
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GGIT_MEMPACK_H__
+#define __GGIT_MEMPACK_H__
+
+#include <glib-object.h>
+#include <git2.h>
+
+#include <libgit2-glib/ggit-types.h>
+#include <libgit2-glib/ggit-odb-backend.h>
+
+G_BEGIN_DECLS
+
+#define GGIT_TYPE_MEMPACK (ggit_mempack_get_type ())
+G_DECLARE_FINAL_TYPE (GgitMempack, ggit_mempack, GGIT, MEMPACK, GgitOdbBackend)
+
+GgitMempack *ggit_mempack_new        (GError         **error);
+
+GBytes      *ggit_mempack_dump       (GgitMempack     *mempack,
+                                      GgitRepository  *repository,
+                                      GError         **error);
+
+gboolean     ggit_mempack_write_pack (GgitMempack     *mempack,
+                                      GgitRepository  *repository,
+                                      GError         **error);
+
+void         ggit_mempack_reset      (GgitMempack     *mempack);
+
+G_END_DECLS
+
+#endif /* __GGIT_MEMPACK_H__ */
+
+/* ex:set ts=8 noet: */
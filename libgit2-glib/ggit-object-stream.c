@@ -0,0 +1,396 @@
+/*
+ * ggit-object-stream.c
+ * This file is part of libgit2-glib
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "ggit-object-stream.h"
+#include "ggit-pack-index.h"
+#include "ggit-utils.h"
+
+/* libgit2 can only stream loose objects (git_odb_open_rstream), so blobs
+ * stored whole in a pack are read directly from the pack file, and their
+ * content is inflated while the stream is consumed instead of all at
+ * once. Deltified objects need their base to be reconstructed first and
+ * can not be streamed this way.
+ *
+ * As libgit2 does when it reads an object, the content is checked against
+ * the size in the pack and against the id of the blob once the whole
+ * content has been read, and reading the end of the stream fails if they
+ * do not match.
+ */
+
+#define PACK_OBJ_BLOB 3
+#define PACK_OBJ_HEADER_MAX 16
+
+#define GGIT_TYPE_VERIFY_STREAM (_ggit_verify_stream_get_type ())
+G_DECLARE_FINAL_TYPE (GgitVerifyStream, _ggit_verify_stream, GGIT, VERIFY_STREAM, GFilterInputStream)
+
+struct _GgitVerifyStream
+{
+	GFilterInputStream parent_instance;
+
+	git_oid oid;
+	guint64 size;
+	guint64 n_read;
+
+	/* of the object header and the content read so far */
+	GChecksum *checksum;
+	gboolean verified;
+};
+
+G_DEFINE_TYPE (GgitVerifyStream, _ggit_verify_stream, G_TYPE_FILTER_INPUT_STREAM)
+
+static gboolean
+verify_stream_check (GgitVerifyStream  *stream,
+                     GError           **error)
+{
+	guint8 digest[GIT_OID_RAWSZ];
+	gsize length = sizeof (digest);
+
+	if (stream->n_read != stream->size)
+	{
+		g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+		             "Packed blob has %" G_GUINT64_FORMAT " bytes instead of %" G_GUINT64_FORMAT,
+		             stream->n_read, stream->size);
+
+		return FALSE;
+	}
+
+	g_checksum_get_digest (stream->checksum, digest, &length);
+
+	if (length != GIT_OID_RAWSZ || memcmp (digest, stream->oid.id, GIT_OID_RAWSZ) != 0)
+	{
+		gchar hex[GIT_OID_HEXSZ + 1];
+
+		git_oid_tostr (hex, sizeof (hex), &stream->oid);
+
+		g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+		             "Packed blob %s does not match its id", hex);
+
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+static gssize
+_ggit_verify_stream_read (GInputStream  *object,
+                          void          *buffer,
+                          gsize          count,
+                          GCancellable  *cancellable,
+                          GError       **error)
+{
+	GgitVerifyStream *stream = GGIT_VERIFY_STREAM (object);
+	GInputStream *base;
+	gssize n_read;
+
+	base = g_filter_input_stream_get_base_stream (G_FILTER_INPUT_STREAM (object));
+	n_read = g_input_stream_read (base, buffer, count, cancellable, error);
+
+	if (n_read < 0)
+	{
+		return -1;
+	}
+
+	stream->n_read += n_read;
+
+	if (stream->n_read > stream->size)
+	{
+		/* fails on the size */
+		verify_stream_check (stream, error);
+		return -1;
+	}
+
+	if (n_read > 0)
+	{
+		g_checksum_update (stream->checksum, buffer, n_read);
+	}
+	else if (!stream->verified)
+	{
+		stream->verified = TRUE;
+
+		if (!verify_stream_check (stream, error))
+		{
+			return -1;
+		}
+	}
+
+	return n_read;
+}
+
+static void
+_ggit_verify_stream_finalize (GObject *object)
+{
+	GgitVerifyStream *stream = GGIT_VERIFY_STREAM (object);
+
+	g_checksum_free (stream->checksum);
+
+	G_OBJECT_CLASS (_ggit_verify_stream_parent_class)->finalize (object);
+}
+
+static void
+_ggit_verify_stream_class_init (GgitVerifyStreamClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+	GInputStreamClass *stream_class = G_INPUT_STREAM_CLASS (klass);
+
+	object_class->finalize = _ggit_verify_stream_finalize;
+	stream_class->read_fn = _ggit_verify_stream_read;
+}
+
+static void
+_ggit_verify_stream_init (GgitVerifyStream *stream)
+{
+	stream->checksum = g_checksum_new (G_CHECKSUM_SHA1);
+}
+
+static GInputStream *
+verify_stream_new (GInputStream  *base,
+                   const git_oid *oid,
+                   guint64        size)
+{
+	GgitVerifyStream *stream;
+	gchar *header;
+
+	stream = g_object_new (GGIT_TYPE_VERIFY_STREAM,
+	                       "base-stream", base,
+	                       NULL);
+
+	git_oid_cpy (&stream->oid, oid);
+	stream->size = size;
+
+	/* the id is the hash of the loose object, header included */
+	header = g_strdup_printf ("blob %" G_GUINT64_FORMAT, size);
+	g_checksum_update (stream->checksum, (const guchar *)header, strlen (header) + 1);
+	g_free (header);
+
+	return G_INPUT_STREAM (stream);
+}
+
+static GInputStream *
+inflate_stream_new (GInputStream *base)
+{
+	GZlibDecompressor *decompressor;
+	GInputStream *stream;
+
+	decompressor = g_zlib_decompressor_new (G_ZLIB_COMPRESSOR_FORMAT_ZLIB);
+	stream = g_converter_input_stream_new (base, G_CONVERTER (decompressor));
+	g_object_unref (decompressor);
+
+	return stream;
+}
+
+static GInputStream *
+open_file (const gchar  *path,
+           GError      **error)
+{
+	GFile *file;
+	GFileInputStream *stream;
+	GError *err = NULL;
+
+	file = g_file_new_for_path (path);
+	stream = g_file_read (file, NULL, &err);
+	g_object_unref (file);
+
+	if (stream == NULL)
+	{
+		/* the object may have been packed or pruned meanwhile */
+		if (!g_error_matches (err, G_IO_ERROR, G_IO_ERROR_NOT_FOUND))
+		{
+			g_propagate_error (error, err);
+		}
+		else
+		{
+			g_error_free (err);
+		}
+	}
+
+	return G_INPUT_STREAM (stream);
+}
+
+static GInputStream *
+open_packed (const gchar    *pack_path,
+             guint64         offset,
+             const git_oid  *oid,
+             goffset        *size,
+             GError        **error)
+{
+	GInputStream *base;
+	GInputStream *inflated;
+	GInputStream *stream;
+	guint8 header[PACK_OBJ_HEADER_MAX];
+	gsize n_read;
+	guint64 obj_size;
+	guint shift;
+	gsize i;
+
+	base = open_file (pack_path, error);
+
+	if (base == NULL)
+	{
+		return NULL;
+	}
+
+	if (!g_seekable_seek (G_SEEKABLE (base), offset, G_SEEK_SET, NULL, error) ||
+	    !g_input_stream_read_all (base, header, sizeof (header), &n_read, NULL, error))
+	{
+		g_object_unref (base);
+		return NULL;
+	}
+
+	if (n_read == 0 || ((header[0] >> 4) & 0x07) != PACK_OBJ_BLOB)
+	{
+		/* deltas and other object types go through libgit2 */
+		g_object_unref (base);
+		return NULL;
+	}
+
+	/* type and size, the size continued in little endian groups of 7 bits */
+	obj_size = header[0] & 0x0f;
+	shift = 4;
+
+	for (i = 0; i < n_read && (header[i] & 0x80) != 0; ++i)
+	{
+		if (i + 1 >= n_read || shift > 57)
+		{
+			g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+			             "Invalid object header in pack file '%s'", pack_path);
+
+			g_object_unref (base);
+			return NULL;
+		}
+
+		obj_size |= (guint64)(header[i + 1] & 0x7f) << shift;
+		shift += 7;
+	}
+
+	if (!g_seekable_seek (G_SEEKABLE (base), offset + i + 1, G_SEEK_SET, NULL, error))
+	{
+		g_object_unref (base);
+		return NULL;
+	}
+
+	inflated = inflate_stream_new (base);
+	g_object_unref (base);
+
+	stream = verify_stream_new (inflated, oid, obj_size);
+	g_object_unref (inflated);
+
+	if (size != NULL)
+	{
+		*size = (goffset)obj_size;
+	}
+
+	return stream;
+}
+
+static GInputStream *
+open_from_packs (const gchar    *dir,
+                 const git_oid  *oid,
+                 goffset        *size,
+                 GError        **error)
+{
+	GInputStream *stream = NULL;
+	GDir *d;
+	gchar *path;
+	const gchar *name;
+
+	path = g_build_filename (dir, "pack", NULL);
+	d = g_dir_open (path, 0, NULL);
+
+	if (d == NULL)
+	{
+		g_free (path);
+		return NULL;
+	}
+
+	while ((name = g_dir_read_name (d)) != NULL)
+	{
+		GgitPackIndex *index;
+		gchar *filename;
+		guint64 offset;
+		gboolean found;
+
+		if (!g_str_has_suffix (name, ".idx"))
+		{
+			continue;
+		}
+
+		filename = g_build_filename (path, name, NULL);
+		index = _ggit_pack_index_open (filename, NULL);
+		found = index != NULL && _ggit_pack_index_find (index, oid, &offset);
+		_ggit_pack_index_free (index);
+
+		if (found)
+		{
+			gchar *pack;
+
+			pack = g_strdup_printf ("%.*s.pack",
+			                        (gint)(strlen (filename) - strlen (".idx")),
+			                        filename);
+
+			stream = open_packed (pack, offset, oid, size, error);
+			g_free (pack);
+		}
+
+		g_free (filename);
+
+		if (found)
+		{
+			break;
+		}
+	}
+
+	g_dir_close (d);
+	g_free (path);
+
+	return stream;
+}
+
+GInputStream *
+_ggit_object_stream_open_packed_blob (const gchar    *objects_dir,
+                                      const git_oid  *oid,
+                                      goffset        *size,
+                                      GError        **error)
+{
+	GPtrArray *dirs;
+	GInputStream *stream = NULL;
+	GError *err = NULL;
+	guint i;
+
+	g_return_val_if_fail (objects_dir != NULL, NULL);
+	g_return_val_if_fail (oid != NULL, NULL);
+
+	dirs = ggit_utils_get_object_dirs (objects_dir);
+
+	for (i = 0; i < dirs->len && stream == NULL && err == NULL; ++i)
+	{
+		stream = open_from_packs (g_ptr_array_index (dirs, i), oid, size, &err);
+	}
+
+	g_ptr_array_unref (dirs);
+
+	if (err != NULL)
+	{
+		g_propagate_error (error, err);
+	}
+
+	return stream;
+}
+
+/* ex:set ts=8 noet: */
@@ -0,0 +1,41 @@
+/*
+ * ggit-object-stream.h
+ * This file is part of libgit2-glib
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GGIT_OBJECT_STREAM_H__
+#define __GGIT_OBJECT_STREAM_H__
+
+#include <gio/gio.h>
+#include <git2.h>
+
+G_BEGIN_DECLS
+
+/* Returns %NULL without setting @error when the blob is not stored as a
+ * whole in a pack below @objects_dir (e.g. it is loose, deltified or lives
+ * in a custom backend), in which case the caller should fall back to
+ * reading it through libgit2.
+ */
+GInputStream *_ggit_object_stream_open_packed_blob (const gchar    *objects_dir,
+                                                    const git_oid  *oid,
+                                                    goffset        *size,
+                                                    GError        **error);
+
+G_END_DECLS
+
+#endif /* __GGIT_OBJECT_STREAM_H__ */
+
+/* ex:set ts=8 noet: */
@@ -0,0 +1,542 @@
+/*
+ * ggit-odb-backend.c
+ * This file is part of libgit2-glib
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ggit-odb-backend.h"
+
+#include <string.h>
+#include <gio/gio.h>
+#include <git2.h>
+#include <git2/sys/odb_backend.h>
+
+#include "ggit-error.h"
+#include "ggit-oid.h"
+#include "ggit-utils.h"
+
+/**
+ * GgitOdbBackend:
+ *
+ * Represents a storage backend of an object database. Subclasses implement
+ * the #GgitOdbBackendClass virtual methods and are added to an object
+ * database with ggit_odb_add_backend().
+ */
+
+typedef struct _GgitOdbBackendPrivate
+{
+	/* a libgit2 backend that the object forwards to, like the mempack */
+	git_odb_backend *native_backend;
+} GgitOdbBackendPrivate;
+
+/* The git_odb_backend handed to libgit2. It holds a reference on the
+ * backend object for as long as it is part of an object database.
+ */
+typedef struct
+{
+	git_odb_backend parent;
+
+	GgitOdbBackend *backend;
+	git_odb_backend *inner;
+} NativeOdbBackend;
+
+G_DEFINE_TYPE_WITH_PRIVATE (GgitOdbBackend, ggit_odb_backend, G_TYPE_OBJECT)
+
+static void
+ggit_odb_backend_finalize (GObject *object)
+{
+	GgitOdbBackend *backend = GGIT_ODB_BACKEND (object);
+	GgitOdbBackendPrivate *priv;
+
+	priv = ggit_odb_backend_get_instance_private (backend);
+
+	if (priv->native_backend != NULL)
+	{
+		priv->native_backend->free (priv->native_backend);
+	}
+
+	G_OBJECT_CLASS (ggit_odb_backend_parent_class)->finalize (object);
+}
+
+static void
+ggit_odb_backend_class_init (GgitOdbBackendClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+	object_class->finalize = ggit_odb_backend_finalize;
+}
+
+static void
+ggit_odb_backend_init (GgitOdbBackend *backend)
+{
+}
+
+static gint
+native_backend_set_error (GError *error)
+{
+	gint ret = GIT_ERROR;
+
+	if (error == NULL)
+	{
+		return GIT_ENOTFOUND;
+	}
+
+	if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND) ||
+	    g_error_matches (error, GGIT_ERROR, GGIT_ERROR_NOTFOUND))
+	{
+		ret = GIT_ENOTFOUND;
+	}
+	else if (g_error_matches (error, GGIT_ERROR, GGIT_ERROR_AMBIGUOUS))
+	{
+		ret = GIT_EAMBIGUOUS;
+	}
+
+#if LIBGIT2_VER_MAJOR > 0 || (LIBGIT2_VER_MAJOR == 0 && LIBGIT2_VER_MINOR >= 28)
+	git_error_set_str (GIT_ERROR_ODB, error->message);
+#else
+	giterr_set_str (GITERR_ODB, error->message);
+#endif
+	g_error_free (error);
+
+	return ret;
+}
+
+/* Copies @bytes, which is consumed, into a buffer for libgit2 */
+static gint
+native_backend_take_bytes (git_odb_backend  *parent,
+                           GBytes           *bytes,
+                           GType             type,
+                           void            **buffer_p,
+                           size_t           *len_p,
+                           git_otype        *type_p)
+{
+	gconstpointer data;
+	gsize size;
+
+	/* libgit2 takes ownership of the buffer, so it has to come from its
+	 * own allocator.
+	 */
+	data = g_bytes_get_data (bytes, &size);
+
+#if LIBGIT2_VER_MAJOR > 0 || (LIBGIT2_VER_MAJOR == 0 && LIBGIT2_VER_MINOR >= 26)
+	*buffer_p = git_odb_backend_data_alloc (parent, size);
+#else
+	*buffer_p = git_odb_backend_malloc (parent, size);
+#endif
+
+	if (*buffer_p == NULL)
+	{
+		g_bytes_unref (bytes);
+		return GIT_ERROR;
+	}
+
+	if (size > 0)
+	{
+		memcpy (*buffer_p, data, size);
+	}
+
+	*len_p = size;
+	*type_p = ggit_utils_get_otype_from_gtype (type);
+
+	g_bytes_unref (bytes);
+
+	return GIT_OK;
+}
+
+static gchar *
+format_prefix (const git_oid *short_oid,
+               size_t         len)
+{
+	gchar *prefix;
+
+	len = MIN (len, GIT_OID_HEXSZ);
+
+	prefix = g_malloc (len + 1);
+	git_oid_nfmt (prefix, len, short_oid);
+	prefix[len] = '\0';
+
+	return prefix;
+}
+
+static gint
+native_backend_read (void            **buffer_p,
+                     size_t           *len_p,
+                     git_otype        *type_p,
+                     git_odb_backend  *parent,
+                     const git_oid    *oid)
+{
+	NativeOdbBackend *native = (NativeOdbBackend *)parent;
+	GgitOId *id;
+	GBytes *bytes;
+	GType type = G_TYPE_NONE;
+	GError *error = NULL;
+
+	if (native->inner != NULL)
+	{
+		return native->inner->read (buffer_p, len_p, type_p, native->inner, oid);
+	}
+
+	id = _ggit_oid_wrap (oid);
+	bytes = GGIT_ODB_BACKEND_GET_CLASS (native->backend)->read (native->backend,
+	                                                           id,
+	                                                           &type,
+	                                                           &error);
+	ggit_oid_free (id);
+
+	if (bytes == NULL)
+	{
+		return native_backend_set_error (error);
+	}
+
+	return native_backend_take_bytes (parent, bytes, type, buffer_p, len_p, type_p);
+}
+
+static gint
+native_backend_read_header (size_t           *len_p,
+                            git_otype        *type_p,
+                            git_odb_backend  *parent,
+                            const git_oid    *oid)
+{
+	NativeOdbBackend *native = (NativeOdbBackend *)parent;
+	GgitOId *id;
+	GType type = G_TYPE_NONE;
+	gsize size = 0;
+	GError *error = NULL;
+	gboolean ret;
+
+	if (native->inner != NULL)
+	{
+		return native->inner->read_header (len_p, type_p, native->inner, oid);
+	}
+
+	id = _ggit_oid_wrap (oid);
+	ret = GGIT_ODB_BACKEND_GET_CLASS (native->backend)->read_header (native->backend,
+	                                                                id,
+	                                                                &type,
+	                                                                &size,
+	                                                                &error);
+	ggit_oid_free (id);
+
+	if (!ret)
+	{
+		return native_backend_set_error (error);
+	}
+
+	*len_p = size;
+	*type_p = ggit_utils_get_otype_from_gtype (type);
+
+	return GIT_OK;
+}
+
+static gint
+native_backend_write (git_odb_backend *parent,
+                      const git_oid   *oid,
+                      const void      *data,
+                      size_t           len,
+                      git_otype        otype)
+{
+	NativeOdbBackend *native = (NativeOdbBackend *)parent;
+	GgitOId *id;
+	GBytes *bytes;
+	GError *error = NULL;
+	gboolean ret;
+
+	if (native->inner != NULL)
+	{
+		return native->inner->write (native->inner, oid, data, len, otype);
+	}
+
+	/* @data is only valid for the duration of the call, and the backend
+	 * may keep the bytes around.
+	 */
+	id = _ggit_oid_wrap (oid);
+	bytes = g_bytes_new (data, len);
+
+	ret = GGIT_ODB_BACKEND_GET_CLASS (native->backend)->write (native->backend,
+	                                                          id,
+	                                                          bytes,
+	                                                          ggit_utils_get_gtype_from_otype (otype),
+	                                                          &error);
+
+	g_bytes_unref (bytes);
+	ggit_oid_free (id);
+
+	if (!ret)
+	{
+		gint err = native_backend_set_error (error);
+
+		/* GIT_ENOTFOUND has no meaning for a write */
+		return err == GIT_ENOTFOUND ? GIT_ERROR : err;
+	}
+
+	return GIT_OK;
+}
+
+static gint
+native_backend_exists (git_odb_backend *parent,
+                       const git_oid   *oid)
+{
+	NativeOdbBackend *native = (NativeOdbBackend *)parent;
+	GgitOId *id;
+	gboolean ret;
+
+	if (native->inner != NULL)
+	{
+		return native->inner->exists (native->inner, oid);
+	}
+
+	id = _ggit_oid_wrap (oid);
+	ret = GGIT_ODB_BACKEND_GET_CLASS (native->backend)->exists (native->backend, id);
+	ggit_oid_free (id);
+
+	return ret ? 1 : 0;
+}
+
+static gint
+native_backend_read_prefix (git_oid          *out_oid,
+                            void            **buffer_p,
+                            size_t           *len_p,
+                            git_otype        *type_p,
+                            git_odb_backend  *parent,
+                            const git_oid    *short_oid,
+                            size_t            len)
+{
+	NativeOdbBackend *native = (NativeOdbBackend *)parent;
+	GgitOId *id = NULL;
+	GBytes *bytes;
+	GType type = G_TYPE_NONE;
+	GError *error = NULL;
+	gchar *prefix;
+
+	if (native->inner != NULL)
+	{
+		return native->inner->read_prefix (out_oid, buffer_p, len_p, type_p,
+		                                   native->inner, short_oid, len);
+	}
+
+	prefix = format_prefix (short_oid, len);
+	bytes = GGIT_ODB_BACKEND_GET_CLASS (native->backend)->read_prefix (native->backend,
+	                                                                  prefix,
+	                                                                  &id,
+	                                                                  &type,
+	                                                                  &error);
+	g_free (prefix);
+
+	if (bytes == NULL)
+	{
+		if (id != NULL)
+		{
+			ggit_oid_free (id);
+		}
+
+		return native_backend_set_error (error);
+	}
+
+	g_return_val_if_fail (id != NULL, GIT_ERROR);
+
+	git_oid_cpy (out_oid, _ggit_oid_get_oid (id));
+	ggit_oid_free (id);
+
+	return native_backend_take_bytes (parent, bytes, type, buffer_p, len_p, type_p);
+}
+
+static gint
+native_backend_exists_prefix (git_oid         *out_oid,
+                              git_odb_backend *parent,
+                              const git_oid   *short_oid,
+                              size_t           len)
+{
+	NativeOdbBackend *native = (NativeOdbBackend *)parent;
+	GgitOId *id;
+	GError *error = NULL;
+	gchar *prefix;
+
+	if (native->inner != NULL)
+	{
+		return native->inner->exists_prefix (out_oid, native->inner, short_oid, len);
+	}
+
+	prefix = format_prefix (short_oid, len);
+	id = GGIT_ODB_BACKEND_GET_CLASS (native->backend)->exists_prefix (native->backend,
+	                                                                 prefix,
+	                                                                 &error);
+	g_free (prefix);
+
+	if (id == NULL)
+	{
+		return native_backend_set_error (error);
+	}
+
+	git_oid_cpy (out_oid, _ggit_oid_get_oid (id));
+	ggit_oid_free (id);
+
+	return GIT_OK;
+}
+
+typedef struct
+{
+	git_odb_foreach_cb cb;
+	gpointer payload;
+	gint ret;
+} ForeachData;
+
+static gint
+native_backend_foreach_cb (GgitOId  *oid,
+                           gpointer  user_data)
+{
+	ForeachData *data = user_data;
+
+	data->ret = data->cb (_ggit_oid_get_oid (oid), data->payload);
+
+	return data->ret;
+}
+
+static gint
+native_backend_foreach (git_odb_backend    *parent,
+                        git_odb_foreach_cb  cb,
+                        void               *payload)
+{
+	NativeOdbBackend *native = (NativeOdbBackend *)parent;
+	ForeachData data = { cb, payload, GIT_OK };
+	GError *error = NULL;
+	gboolean ret;
+
+	if (native->inner != NULL)
+	{
+		return native->inner->foreach (native->inner, cb, payload);
+	}
+
+	ret = GGIT_ODB_BACKEND_GET_CLASS (native->backend)->foreach (native->backend,
+	                                                            native_backend_foreach_cb,
+	                                                            &data,
+	                                                            &error);
+
+	/* a callback asking to stop is not an error of the backend */
+	if (data.ret != GIT_OK)
+	{
+		g_clear_error (&error);
+		return data.ret;
+	}
+
+	if (!ret)
+	{
+		gint err = native_backend_set_error (error);
+
+		return err == GIT_ENOTFOUND ? GIT_ERROR : err;
+	}
+
+	return GIT_OK;
+}
+
+static void
+native_backend_free (git_odb_backend *parent)
+{
+	NativeOdbBackend *native = (NativeOdbBackend *)parent;
+
+	g_object_unref (native->backend);
+	g_slice_free (NativeOdbBackend, native);
+}
+
+git_odb_backend *
+_ggit_odb_backend_create_native (GgitOdbBackend *backend)
+{
+	GgitOdbBackendClass *klass;
+	GgitOdbBackendPrivate *priv;
+	NativeOdbBackend *native;
+	git_odb_backend *inner;
+
+	g_return_val_if_fail (GGIT_IS_ODB_BACKEND (backend), NULL);
+
+	klass = GGIT_ODB_BACKEND_GET_CLASS (backend);
+	priv = ggit_odb_backend_get_instance_private (backend);
+	inner = priv->native_backend;
+
+	native = g_slice_new0 (NativeOdbBackend);
+	git_odb_init_backend (&native->parent, GIT_ODB_BACKEND_VERSION);
+
+	native->backend = g_object_ref (backend);
+	native->inner = inner;
+
+	if (inner != NULL ? inner->read != NULL : klass->read != NULL)
+	{
+		native->parent.read = native_backend_read;
+	}
+
+	if (inner != NULL ? inner->read_header != NULL : klass->read_header != NULL)
+	{
+		native->parent.read_header = native_backend_read_header;
+	}
+
+	if (inner != NULL ? inner->write != NULL : klass->write != NULL)
+	{
+		native->parent.write = native_backend_write;
+	}
+
+	if (inner != NULL ? inner->exists != NULL : klass->exists != NULL)
+	{
+		native->parent.exists = native_backend_exists;
+	}
+
+	if (inner != NULL ? inner->read_prefix != NULL : klass->read_prefix != NULL)
+	{
+		native->parent.read_prefix = native_backend_read_prefix;
+	}
+
+	if (inner != NULL ? inner->exists_prefix != NULL : klass->exists_prefix != NULL)
+	{
+		native->parent.exists_prefix = native_backend_exists_prefix;
+	}
+
+	if (inner != NULL ? inner->foreach != NULL : klass->foreach != NULL)
+	{
+		native->parent.foreach = native_backend_foreach;
+	}
+
+	native->parent.free = native_backend_free;
+
+	return &native->parent;
+}
+
+void
+_ggit_odb_backend_set_native_backend (GgitOdbBackend  *backend,
+                                      git_odb_backend *native)
+{
+	GgitOdbBackendPrivate *priv;
+
+	g_return_if_fail (GGIT_IS_ODB_BACKEND (backend));
+
+	priv = ggit_odb_backend_get_instance_private (backend);
+
+	if (priv->native_backend != NULL)
+	{
+		priv->native_backend->free (priv->native_backend);
+	}
+
+	priv->native_backend = native;
+}
+
+git_odb_backend *
+_ggit_odb_backend_get_native_backend (GgitOdbBackend *backend)
+{
+	GgitOdbBackendPrivate *priv;
+
+	g_return_val_if_fail (GGIT_IS_ODB_BACKEND (backend), NULL);
+
+	priv = ggit_odb_backend_get_instance_private (backend);
+
+	return priv->native_backend;
+}
+
+/* ex:set ts=8 noet: */
@@ -0,0 +1,108 @@
+/*
+ * ggit-odb-backend.h
+ * This file is part of libgit2-glib
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GGIT_ODB_BACKEND_H__
+#define __GGIT_ODB_BACKEND_H__
+
+#include <glib-object.h>
+#include <git2.h>
+
+#include <libgit2-glib/ggit-types.h>
+
+G_BEGIN_DECLS
+
+#define GGIT_TYPE_ODB_BACKEND (ggit_odb_backend_get_type ())
+G_DECLARE_DERIVABLE_TYPE (GgitOdbBackend, ggit_odb_backend, GGIT, ODB_BACKEND, GObject)
+
+/**
+ * GgitOdbBackendClass:
+ * @parent_class: The parent class.
+ * @read: read the content and the type of an object. Return %NULL without
+ *        setting an error if the object is not stored in the backend.
+ * @read_header: read the type and the size of an object.
+ * @write: store an object in the backend. The backend has to take a
+ *         reference on the data if it keeps it.
+ * @exists: check whether an object is stored in the backend.
+ * @read_prefix: read the content and the type of the single object whose
+ *               id starts with the given hexadecimal prefix, and return its
+ *               full id. Return %NULL without setting an error if no object
+ *               matches, or set %GGIT_ERROR_AMBIGUOUS if several do.
+ * @exists_prefix: return the full id of the single object whose id starts
+ *                 with the given hexadecimal prefix, with the same errors
+ *                 as @read_prefix.
+ * @foreach: call the callback for every object stored in the backend, until
+ *           it returns a non-zero value.
+ *
+ * The class structure for #GgitOdbBackendClass. Virtual methods that are
+ * not implemented are skipped by the object database, so a backend without
+ * @read_prefix and @exists_prefix can not resolve short ids.
+ */
+struct _GgitOdbBackendClass
+{
+	/*< private >*/
+	GObjectClass parent_class;
+
+	/*< public >*/
+	GBytes   *(*read)        (GgitOdbBackend  *backend,
+	                          GgitOId         *oid,
+	                          GType           *type,
+	                          GError         **error);
+
+	gboolean  (*read_header) (GgitOdbBackend  *backend,
+	                          GgitOId         *oid,
+	                          GType           *type,
+	                          gsize           *size,
+	                          GError         **error);
+
+	gboolean  (*write)       (GgitOdbBackend  *backend,
+	                          GgitOId         *oid,
+	                          GBytes          *data,
+	                          GType            type,
+	                          GError         **error);
+
+	gboolean  (*exists)      (GgitOdbBackend  *backend,
+	                          GgitOId         *oid);
+
+	GBytes   *(*read_prefix)   (GgitOdbBackend          *backend,
+	                            const gchar             *prefix,
+	                            GgitOId                **oid,
+	                            GType                   *type,
+	                            GError                 **error);
+
+	GgitOId  *(*exists_prefix) (GgitOdbBackend          *backend,
+	                            const gchar             *prefix,
+	                            GError                 **error);
+
+	gboolean  (*foreach)       (GgitOdbBackend          *backend,
+	                            GgitOdbForeachCallback   callback,
+	                            gpointer                 user_data,
+	                            GError                 **error);
+};
+
+git_odb_backend *_ggit_odb_backend_create_native     (GgitOdbBackend  *backend);
+
+void             _ggit_odb_backend_set_native_backend (GgitOdbBackend  *backend,
+                                                       git_odb_backend *native);
+
+git_odb_backend *_ggit_odb_backend_get_native_backend (GgitOdbBackend  *backend);
+
+G_END_DECLS
+
+#endif /* __GGIT_ODB_BACKEND_H__ */
+
+/* ex:set ts=8 noet: */
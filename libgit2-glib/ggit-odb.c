@@ -0,0 +1,555 @@
+/*
+ * ggit-odb.c
+ * This file is part of libgit2-glib
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ggit-odb.h"
+
+#include <git2.h>
+
+#include "ggit-error.h"
+#include "ggit-odb-backend.h"
+#include "ggit-oid.h"
+#include "ggit-utils.h"
+
+/**
+ * GgitOdb:
+ *
+ * Represents the object database of a repository. It gives access to the
+ * raw content of objects without creating a #GgitObject for each of them.
+ */
+struct _GgitOdb
+{
+	GgitNative parent_instance;
+};
+
+G_DEFINE_TYPE (GgitOdb, ggit_odb, GGIT_TYPE_NATIVE)
+
+GgitOdb *
+_ggit_odb_wrap (git_odb *odb)
+{
+	GgitOdb *ret;
+
+	g_return_val_if_fail (odb != NULL, NULL);
+
+	ret = g_object_new (GGIT_TYPE_ODB, "native", odb, NULL);
+
+	return ret;
+}
+
+static void
+ggit_odb_class_init (GgitOdbClass *klass)
+{
+}
+
+static void
+ggit_odb_init (GgitOdb *odb)
+{
+	_ggit_native_set_destroy_func (odb, (GDestroyNotify) git_odb_free);
+}
+
+#if LIBGIT2_VER_MAJOR > 0 || (LIBGIT2_VER_MAJOR == 0 && LIBGIT2_VER_MINOR >= 28)
+
+/* Input stream reading from a git_odb_stream, for the backends that can
+ * inflate objects incrementally.
+ */
+#define GGIT_TYPE_ODB_READ_STREAM (_ggit_odb_read_stream_get_type ())
+G_DECLARE_FINAL_TYPE (GgitOdbReadStream, _ggit_odb_read_stream, GGIT, ODB_READ_STREAM, GInputStream)
+
+struct _GgitOdbReadStream
+{
+	GInputStream parent_instance;
+
+	/* the backends of the stream belong to the object database */
+	GgitOdb *odb;
+	git_odb_stream *stream;
+};
+
+G_DEFINE_TYPE (GgitOdbReadStream, _ggit_odb_read_stream, G_TYPE_INPUT_STREAM)
+
+static gssize
+_ggit_odb_read_stream_read (GInputStream  *object,
+                            void          *buffer,
+                            gsize          count,
+                            GCancellable  *cancellable,
+                            GError       **error)
+{
+	GgitOdbReadStream *stream = GGIT_ODB_READ_STREAM (object);
+	gint ret;
+
+	if (g_cancellable_set_error_if_cancelled (cancellable, error))
+	{
+		return -1;
+	}
+
+	ret = git_odb_stream_read (stream->stream, (char *)buffer, MIN (count, G_MAXINT));
+
+	if (ret < 0)
+	{
+		_ggit_error_set (error, ret);
+		return -1;
+	}
+
+	return ret;
+}
+
+static void
+_ggit_odb_read_stream_finalize (GObject *object)
+{
+	GgitOdbReadStream *stream = GGIT_ODB_READ_STREAM (object);
+
+	git_odb_stream_free (stream->stream);
+	g_object_unref (stream->odb);
+
+	G_OBJECT_CLASS (_ggit_odb_read_stream_parent_class)->finalize (object);
+}
+
+static void
+_ggit_odb_read_stream_class_init (GgitOdbReadStreamClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+	GInputStreamClass *stream_class = G_INPUT_STREAM_CLASS (klass);
+
+	object_class->finalize = _ggit_odb_read_stream_finalize;
+	stream_class->read_fn = _ggit_odb_read_stream_read;
+}
+
+static void
+_ggit_odb_read_stream_init (GgitOdbReadStream *stream)
+{
+}
+
+#endif
+
+/**
+ * ggit_odb_exists:
+ * @odb: a #GgitOdb.
+ * @oid: a #GgitOId.
+ *
+ * Check whether the object database contains the object @oid.
+ *
+ * Returns: %TRUE if the object exists, %FALSE otherwise.
+ *
+ **/
+gboolean
+ggit_odb_exists (GgitOdb *odb,
+                 GgitOId *oid)
+{
+	g_return_val_if_fail (GGIT_IS_ODB (odb), FALSE);
+	g_return_val_if_fail (oid != NULL, FALSE);
+
+	return git_odb_exists (_ggit_native_get (odb),
+	                       _ggit_oid_get_oid (oid)) == 1;
+}
+
+/**
+ * ggit_odb_exists_many:
+ * @odb: a #GgitOdb.
+ * @oids: (array length=n_oids): the ids of the objects to check.
+ * @n_oids: the number of ids in @oids.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Check which of the objects in @oids are contained in the object
+ * database, in a single pass over the object database backends.
+ *
+ * Returns: (transfer full) (element-type gboolean) (nullable): for every id
+ * in @oids whether the object exists, or %NULL on error.
+ *
+ **/
+GArray *
+ggit_odb_exists_many (GgitOdb  *odb,
+                      GgitOId **oids,
+                      gsize     n_oids,
+                      GError  **error)
+{
+	git_odb_expand_id *ids;
+	GArray *exists;
+	gsize i;
+	gint ret;
+
+	g_return_val_if_fail (GGIT_IS_ODB (odb), NULL);
+	g_return_val_if_fail (oids != NULL || n_oids == 0, NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	ids = g_new0 (git_odb_expand_id, n_oids);
+
+	for (i = 0; i < n_oids; ++i)
+	{
+		git_oid_cpy (&ids[i].id, _ggit_oid_get_oid (oids[i]));
+		ids[i].length = GIT_OID_HEXSZ;
+		ids[i].type = GIT_OBJ_ANY;
+	}
+
+	ret = git_odb_expand_ids (_ggit_native_get (odb), ids, n_oids);
+
+	if (ret != GIT_OK)
+	{
+		g_free (ids);
+
+		_ggit_error_set (error, ret);
+		return NULL;
+	}
+
+	exists = g_array_sized_new (FALSE, FALSE, sizeof (gboolean), n_oids);
+
+	for (i = 0; i < n_oids; ++i)
+	{
+		/* ids that were not found are zeroed out */
+		gboolean found = ids[i].length != 0;
+
+		g_array_append_val (exists, found);
+	}
+
+	g_free (ids);
+
+	return exists;
+}
+
+typedef struct
+{
+	GgitOdbForeachCallback callback;
+	gpointer user_data;
+} OdbForeachInfo;
+
+static gint
+odb_foreach_wrapper (const git_oid *oid,
+                     gpointer       payload)
+{
+	OdbForeachInfo *info = payload;
+	GgitOId *id;
+	gint ret;
+
+	id = _ggit_oid_wrap (oid);
+	ret = info->callback (id, info->user_data);
+	ggit_oid_free (id);
+
+	return ret;
+}
+
+/**
+ * ggit_odb_foreach:
+ * @odb: a #GgitOdb.
+ * @callback: (scope call): a #GgitOdbForeachCallback.
+ * @user_data: callback user data.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Call @callback for every object of every backend of the object database.
+ * An object stored in several backends is listed once for each of them.
+ * If the callback returns something other than 0, the iteration will stop
+ * and @error will be set.
+ *
+ * Returns: %TRUE if there was no error, %FALSE otherwise.
+ *
+ **/
+gboolean
+ggit_odb_foreach (GgitOdb                 *odb,
+                  GgitOdbForeachCallback   callback,
+                  gpointer                 user_data,
+                  GError                 **error)
+{
+	OdbForeachInfo info;
+	gint ret;
+
+	g_return_val_if_fail (GGIT_IS_ODB (odb), FALSE);
+	g_return_val_if_fail (callback != NULL, FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	info.callback = callback;
+	info.user_data = user_data;
+
+	ret = git_odb_foreach (_ggit_native_get (odb), odb_foreach_wrapper, &info);
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (error, ret);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+/**
+ * ggit_odb_read_header:
+ * @odb: a #GgitOdb.
+ * @oid: a #GgitOId.
+ * @type: (out) (optional): return location for the type of the object.
+ * @size: (out) (optional): return location for the size of the object.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Read the type and the size of the object @oid. For most objects this
+ * does not require inflating the content of the object. The type is one of
+ * the #GgitBlob, #GgitTree, #GgitCommit or #GgitTag #GType<!-- -->s.
+ *
+ * Returns: %TRUE if the header was read, %FALSE otherwise.
+ *
+ **/
+gboolean
+ggit_odb_read_header (GgitOdb  *odb,
+                      GgitOId  *oid,
+                      GType    *type,
+                      gsize    *size,
+                      GError  **error)
+{
+	git_otype otype;
+	size_t len;
+	gint ret;
+
+	g_return_val_if_fail (GGIT_IS_ODB (odb), FALSE);
+	g_return_val_if_fail (oid != NULL, FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	ret = git_odb_read_header (&len,
+	                           &otype,
+	                           _ggit_native_get (odb),
+	                           _ggit_oid_get_oid (oid));
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (error, ret);
+		return FALSE;
+	}
+
+	if (type != NULL)
+	{
+		*type = ggit_utils_get_gtype_from_otype (otype);
+	}
+
+	if (size != NULL)
+	{
+		*size = len;
+	}
+
+	return TRUE;
+}
+
+/**
+ * ggit_odb_read:
+ * @odb: a #GgitOdb.
+ * @oid: a #GgitOId.
+ * @type: (out) (optional): return location for the type of the object.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Read the content of the object @oid. The returned buffer refers directly
+ * to the data of the object database, no copy is made.
+ *
+ * Returns: (transfer full) (nullable): the content of the object, or %NULL
+ * on error.
+ *
+ **/
+GBytes *
+ggit_odb_read (GgitOdb  *odb,
+               GgitOId  *oid,
+               GType    *type,
+               GError  **error)
+{
+	git_odb_object *obj;
+	gint ret;
+
+	g_return_val_if_fail (GGIT_IS_ODB (odb), NULL);
+	g_return_val_if_fail (oid != NULL, NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	ret = git_odb_read (&obj, _ggit_native_get (odb), _ggit_oid_get_oid (oid));
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (error, ret);
+		return NULL;
+	}
+
+	if (type != NULL)
+	{
+		*type = ggit_utils_get_gtype_from_otype (git_odb_object_type (obj));
+	}
+
+	return g_bytes_new_with_free_func (git_odb_object_data (obj),
+	                                   git_odb_object_size (obj),
+	                                   (GDestroyNotify)git_odb_object_free,
+	                                   obj);
+}
+
+/**
+ * ggit_odb_open_read_stream:
+ * @odb: a #GgitOdb.
+ * @oid: a #GgitOId.
+ * @type: (out) (optional): return location for the type of the object.
+ * @size: (out) (optional): return location for the size of the object.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Open a stream to read the content of the object @oid. When the backend
+ * storing the object supports it, the object is inflated while reading
+ * from the stream. Otherwise the stream reads from the object as returned
+ * by ggit_odb_read().
+ *
+ * Returns: (transfer full) (nullable): a #GInputStream, or %NULL on error.
+ *
+ **/
+GInputStream *
+ggit_odb_open_read_stream (GgitOdb  *odb,
+                           GgitOId  *oid,
+                           GType    *type,
+                           gsize    *size,
+                           GError  **error)
+{
+	GBytes *bytes;
+	GInputStream *ret;
+
+	g_return_val_if_fail (GGIT_IS_ODB (odb), NULL);
+	g_return_val_if_fail (oid != NULL, NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+#if LIBGIT2_VER_MAJOR > 0 || (LIBGIT2_VER_MAJOR == 0 && LIBGIT2_VER_MINOR >= 28)
+	{
+		git_odb_stream *stream;
+		git_otype otype;
+		size_t len;
+
+		if (git_odb_open_rstream (&stream,
+		                          &len,
+		                          &otype,
+		                          _ggit_native_get (odb),
+		                          _ggit_oid_get_oid (oid)) == GIT_OK)
+		{
+			GgitOdbReadStream *rstream;
+
+			if (type != NULL)
+			{
+				*type = ggit_utils_get_gtype_from_otype (otype);
+			}
+
+			if (size != NULL)
+			{
+				*size = len;
+			}
+
+			rstream = g_object_new (GGIT_TYPE_ODB_READ_STREAM, NULL);
+			rstream->odb = g_object_ref (odb);
+			rstream->stream = stream;
+
+			return G_INPUT_STREAM (rstream);
+		}
+	}
+#endif
+
+	/* Packed objects can not be streamed by libgit2 */
+	bytes = ggit_odb_read (odb, oid, type, error);
+
+	if (bytes == NULL)
+	{
+		return NULL;
+	}
+
+	if (size != NULL)
+	{
+		*size = g_bytes_get_size (bytes);
+	}
+
+	ret = g_memory_input_stream_new_from_bytes (bytes);
+	g_bytes_unref (bytes);
+
+	return ret;
+}
+
+/**
+ * ggit_odb_write:
+ * @odb: a #GgitOdb.
+ * @data: (array length=size): the content of the object.
+ * @size: the size of @data.
+ * @type: the #GType of the object, one of #GgitBlob, #GgitTree,
+ *        #GgitCommit or #GgitTag.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Write an object with content @data to the object database.
+ *
+ * Returns: (transfer full) (nullable): the #GgitOId of the written object,
+ * or %NULL on error.
+ *
+ **/
+GgitOId *
+ggit_odb_write (GgitOdb       *odb,
+                const guint8  *data,
+                gsize          size,
+                GType          type,
+                GError       **error)
+{
+	git_oid oid;
+	git_otype otype;
+	gint ret;
+
+	g_return_val_if_fail (GGIT_IS_ODB (odb), NULL);
+	g_return_val_if_fail (data != NULL || size == 0, NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	otype = ggit_utils_get_otype_from_gtype (type);
+	g_return_val_if_fail (otype != GIT_OBJ_ANY && otype != GIT_OBJ_BAD, NULL);
+
+	ret = git_odb_write (&oid, _ggit_native_get (odb), data, size, otype);
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (error, ret);
+		return NULL;
+	}
+
+	return _ggit_oid_wrap (&oid);
+}
+
+/**
+ * ggit_odb_add_backend:
+ * @odb: a #GgitOdb.
+ * @backend: a #GgitOdbBackend.
+ * @priority: the priority of @backend.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Add @backend to the backends used by @odb. Backends with a higher
+ * priority are queried first, and new objects are written to the backend
+ * with the highest priority that can store them. The default loose and
+ * packed backends of a repository use priorities 1 and 2.
+ *
+ * @odb keeps a reference on @backend for as long as it is used.
+ *
+ * Returns: %TRUE if the backend was added, %FALSE otherwise.
+ *
+ **/
+gboolean
+ggit_odb_add_backend (GgitOdb         *odb,
+                      GgitOdbBackend  *backend,
+                      gint             priority,
+                      GError         **error)
+{
+	git_odb_backend *native;
+	gint ret;
+
+	g_return_val_if_fail (GGIT_IS_ODB (odb), FALSE);
+	g_return_val_if_fail (GGIT_IS_ODB_BACKEND (backend), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	native = _ggit_odb_backend_create_native (backend);
+
+	ret = git_odb_add_backend (_ggit_native_get (odb), native, priority);
+
+	if (ret != GIT_OK)
+	{
+		native->free (native);
+
+		_ggit_error_set (error, ret);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+/* ex:set ts=8 noet: */
@@ -0,0 +1,82 @@
+/*
+ * ggit-odb.h
+ * This file is part of libgit2-glib
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GGIT_ODB_H__
+#define __GGIT_ODB_H__
+
+#include <glib-object.h>
+#include <gio/gio.h>
+#include <git2.h>
+
+#include <libgit2-glib/ggit-types.h>
+#include <libgit2-glib/ggit-odb-backend.h>
+#include "ggit-native.h"
+
+G_BEGIN_DECLS
+
+#define GGIT_TYPE_ODB (ggit_odb_get_type ())
+G_DECLARE_FINAL_TYPE (GgitOdb, ggit_odb, GGIT, ODB, GgitNative)
+
+GgitOdb      *_ggit_odb_wrap            (git_odb   *odb);
+
+gboolean      ggit_odb_exists           (GgitOdb   *odb,
+                                         GgitOId   *oid);
+
+GArray       *ggit_odb_exists_many      (GgitOdb   *odb,
+                                         GgitOId  **oids,
+                                         gsize      n_oids,
+                                         GError   **error);
+
+gboolean      ggit_odb_foreach          (GgitOdb                 *odb,
+                                         GgitOdbForeachCallback   callback,
+                                         gpointer                 user_data,
+                                         GError                 **error);
+
+gboolean      ggit_odb_read_header      (GgitOdb   *odb,
+                                         GgitOId   *oid,
+                                         GType     *type,
+                                         gsize     *size,
+                                         GError   **error);
+
+GBytes       *ggit_odb_read             (GgitOdb   *odb,
+                                         GgitOId   *oid,
+                                         GType     *type,
+                                         GError   **error);
+
+GInputStream *ggit_odb_open_read_stream (GgitOdb   *odb,
+                                         GgitOId   *oid,
+                                         GType     *type,
+                                         gsize     *size,
+                                         GError   **error);
+
+GgitOId      *ggit_odb_write            (GgitOdb       *odb,
+                                         const guint8  *data,
+                                         gsize          size,
+                                         GType          type,
+                                         GError       **error);
+
+gboolean      ggit_odb_add_backend      (GgitOdb         *odb,
+                                         GgitOdbBackend  *backend,
+                                         gint             priority,
+                                         GError         **error);
+
+G_END_DECLS
+
+#endif /* __GGIT_ODB_H__ */
+
+/* ex:set ts=8 noet: */
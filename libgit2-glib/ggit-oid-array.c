@@ -0,0 +1,512 @@
+/*
+ * ggit-oid-array.c
+ * This file is part of libgit2-glib
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <gio/gio.h>
+#include <git2.h>
+
+#include "ggit-oid-array.h"
+#include "ggit-oid.h"
+
+struct _GgitOIdArray
+{
+	gint ref_count;
+
+	/* contiguous git_oid records */
+	GArray *oids;
+	gboolean sorted;
+};
+
+G_STATIC_ASSERT (sizeof (git_oid) == GIT_OID_RAWSZ);
+
+G_DEFINE_BOXED_TYPE (GgitOIdArray, ggit_oid_array,
+                     ggit_oid_array_ref, ggit_oid_array_unref)
+
+/**
+ * ggit_oid_array_new:
+ * @n_reserved: the number of ids to reserve space for, or 0.
+ *
+ * Creates a new empty #GgitOIdArray. The ids are stored contiguously as
+ * raw #GGIT_OID_RAWSZ byte records, without an allocation per id.
+ *
+ * Returns: (transfer full): a new #GgitOIdArray.
+ */
+GgitOIdArray *
+ggit_oid_array_new (gsize n_reserved)
+{
+	GgitOIdArray *array;
+
+	array = g_slice_new (GgitOIdArray);
+	array->ref_count = 1;
+	array->oids = g_array_sized_new (FALSE, FALSE, sizeof (git_oid), n_reserved);
+	array->sorted = TRUE;
+
+	return array;
+}
+
+/**
+ * ggit_oid_array_new_from_hex:
+ * @hex: hex formatted ids separated by whitespace.
+ * @length: the length of @hex, or -1 if @hex is nul-terminated.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Creates a new #GgitOIdArray from the ids in @hex. See
+ * ggit_oid_array_append_hex().
+ *
+ * Returns: (transfer full) (nullable): a new #GgitOIdArray, or %NULL if
+ * @hex could not be parsed.
+ */
+GgitOIdArray *
+ggit_oid_array_new_from_hex (const gchar  *hex,
+                             gssize        length,
+                             GError      **error)
+{
+	GgitOIdArray *array;
+
+	g_return_val_if_fail (hex != NULL, NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	if (length < 0)
+	{
+		length = strlen (hex);
+	}
+
+	array = ggit_oid_array_new (length / (GIT_OID_HEXSZ + 1) + 1);
+
+	if (!ggit_oid_array_append_hex (array, hex, length, error))
+	{
+		ggit_oid_array_unref (array);
+		return NULL;
+	}
+
+	return array;
+}
+
+/**
+ * ggit_oid_array_ref:
+ * @array: a #GgitOIdArray.
+ *
+ * Atomically increments the reference count of @array by one.
+ * This function is MT-safe and may be called from any thread.
+ *
+ * Returns: (transfer none) (nullable): a #GgitOIdArray or %NULL.
+ **/
+GgitOIdArray *
+ggit_oid_array_ref (GgitOIdArray *array)
+{
+	g_return_val_if_fail (array != NULL, NULL);
+
+	g_atomic_int_inc (&array->ref_count);
+
+	return array;
+}
+
+/**
+ * ggit_oid_array_unref:
+ * @array: a #GgitOIdArray.
+ *
+ * Atomically decrements the reference count of @array by one.
+ * If the reference count drops to 0, @array is freed.
+ **/
+void
+ggit_oid_array_unref (GgitOIdArray *array)
+{
+	g_return_if_fail (array != NULL);
+
+	if (g_atomic_int_dec_and_test (&array->ref_count))
+	{
+		g_array_unref (array->oids);
+		g_slice_free (GgitOIdArray, array);
+	}
+}
+
+/**
+ * ggit_oid_array_get_size:
+ * @array: a #GgitOIdArray.
+ *
+ * Gets the number of ids in @array.
+ *
+ * Returns: the number of ids in @array.
+ **/
+gsize
+ggit_oid_array_get_size (GgitOIdArray *array)
+{
+	g_return_val_if_fail (array != NULL, 0);
+
+	return array->oids->len;
+}
+
+const git_oid *
+_ggit_oid_array_get_oid (GgitOIdArray *array,
+                         gsize         index)
+{
+	return &g_array_index (array->oids, git_oid, index);
+}
+
+void
+_ggit_oid_array_append_oid (GgitOIdArray  *array,
+                            const git_oid *oid)
+{
+	/* appending in increasing order keeps the array sorted */
+	if (array->sorted && array->oids->len > 0 &&
+	    memcmp (_ggit_oid_array_get_oid (array, array->oids->len - 1)->id,
+	            oid->id,
+	            GIT_OID_RAWSZ) > 0)
+	{
+		array->sorted = FALSE;
+	}
+
+	g_array_append_vals (array->oids, oid, 1);
+}
+
+/**
+ * ggit_oid_array_get:
+ * @array: a #GgitOIdArray.
+ * @index: the index of the id.
+ *
+ * Gets the id at @index in @array.
+ *
+ * Returns: (transfer full) (nullable): a #GgitOId, or %NULL if @index is
+ * out of bounds.
+ **/
+GgitOId *
+ggit_oid_array_get (GgitOIdArray *array,
+                    gsize         index)
+{
+	g_return_val_if_fail (array != NULL, NULL);
+	g_return_val_if_fail (index < array->oids->len, NULL);
+
+	return _ggit_oid_wrap (_ggit_oid_array_get_oid (array, index));
+}
+
+/**
+ * ggit_oid_array_get_raw:
+ * @array: a #GgitOIdArray.
+ * @size: (out): return location for the size in bytes of the data.
+ *
+ * Gets the raw ids in @array, stored contiguously as #GGIT_OID_RAWSZ byte
+ * records. The data is owned by @array and is valid until @array is
+ * modified.
+ *
+ * Returns: (transfer none) (array length=size): the raw ids.
+ **/
+const guint8 *
+ggit_oid_array_get_raw (GgitOIdArray *array,
+                        gsize        *size)
+{
+	g_return_val_if_fail (array != NULL, NULL);
+	g_return_val_if_fail (size != NULL, NULL);
+
+	*size = array->oids->len * GIT_OID_RAWSZ;
+
+	return (const guint8 *)array->oids->data;
+}
+
+/**
+ * ggit_oid_array_append:
+ * @array: a #GgitOIdArray.
+ * @oid: a #GgitOId.
+ *
+ * Appends @oid to @array.
+ **/
+void
+ggit_oid_array_append (GgitOIdArray *array,
+                       GgitOId      *oid)
+{
+	g_return_if_fail (array != NULL);
+	g_return_if_fail (oid != NULL);
+
+	_ggit_oid_array_append_oid (array, _ggit_oid_get_oid (oid));
+}
+
+/**
+ * ggit_oid_array_append_raw:
+ * @array: a #GgitOIdArray.
+ * @raw: (array): @n_oids raw ids of #GGIT_OID_RAWSZ bytes each, stored
+ *       contiguously.
+ * @n_oids: the number of ids in @raw.
+ *
+ * Appends the raw ids in @raw to @array.
+ **/
+void
+ggit_oid_array_append_raw (GgitOIdArray *array,
+                           const guint8 *raw,
+                           gsize         n_oids)
+{
+	g_return_if_fail (array != NULL);
+	g_return_if_fail (raw != NULL || n_oids == 0);
+
+	if (n_oids > 0)
+	{
+		g_array_append_vals (array->oids, raw, n_oids);
+		array->sorted = FALSE;
+	}
+}
+
+/**
+ * ggit_oid_array_append_hex:
+ * @array: a #GgitOIdArray.
+ * @hex: hex formatted ids separated by whitespace.
+ * @length: the length of @hex, or -1 if @hex is nul-terminated.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Parses the full length hex formatted ids in @hex, such as the output of
+ * git rev-list, and appends them to @array. If @hex contains an invalid
+ * id, @array is left unchanged.
+ *
+ * Returns: %TRUE if @hex was parsed, %FALSE otherwise.
+ **/
+gboolean
+ggit_oid_array_append_hex (GgitOIdArray  *array,
+                           const gchar   *hex,
+                           gssize         length,
+                           GError       **error)
+{
+	const gchar *ptr;
+	const gchar *end;
+	guint old_len;
+	gboolean old_sorted;
+
+	g_return_val_if_fail (array != NULL, FALSE);
+	g_return_val_if_fail (hex != NULL, FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	if (length < 0)
+	{
+		length = strlen (hex);
+	}
+
+	old_len = array->oids->len;
+	old_sorted = array->sorted;
+	ptr = hex;
+	end = hex + length;
+
+	while (ptr < end)
+	{
+		git_oid oid;
+
+		if (g_ascii_isspace (*ptr))
+		{
+			ptr++;
+			continue;
+		}
+
+		if (end - ptr < GIT_OID_HEXSZ ||
+		    (end - ptr > GIT_OID_HEXSZ && !g_ascii_isspace (ptr[GIT_OID_HEXSZ])) ||
+		    !_ggit_oid_parse_hex (ptr, oid.id))
+		{
+			g_array_set_size (array->oids, old_len);
+			array->sorted = old_sorted;
+
+			g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+			             "Invalid object id at offset %" G_GSIZE_FORMAT,
+			             (gsize)(ptr - hex));
+			return FALSE;
+		}
+
+		_ggit_oid_array_append_oid (array, &oid);
+		ptr += GIT_OID_HEXSZ;
+	}
+
+	return TRUE;
+}
+
+/**
+ * ggit_oid_array_to_hex:
+ * @array: a #GgitOIdArray.
+ * @separator: (allow-none): the string to put between the ids, or %NULL.
+ *
+ * Formats all the ids in @array into a single string.
+ *
+ * Returns: (transfer full): the hex formatted ids.
+ **/
+gchar *
+ggit_oid_array_to_hex (GgitOIdArray *array,
+                       const gchar  *separator)
+{
+	gsize separator_len;
+	gchar *ret;
+	gchar *ptr;
+	guint i;
+
+	g_return_val_if_fail (array != NULL, NULL);
+
+	separator_len = separator != NULL ? strlen (separator) : 0;
+
+	if (array->oids->len == 0)
+	{
+		return g_strdup ("");
+	}
+
+	ret = g_malloc (array->oids->len * GIT_OID_HEXSZ +
+	                (array->oids->len - 1) * separator_len + 1);
+	ptr = ret;
+
+	for (i = 0; i < array->oids->len; ++i)
+	{
+		if (i > 0 && separator_len > 0)
+		{
+			memcpy (ptr, separator, separator_len);
+			ptr += separator_len;
+		}
+
+		_ggit_oid_format_hex (_ggit_oid_array_get_oid (array, i)->id, ptr);
+		ptr += GIT_OID_HEXSZ;
+	}
+
+	*ptr = '\0';
+
+	return ret;
+}
+
+static gint
+compare_oids (gconstpointer a,
+              gconstpointer b)
+{
+	return memcmp (a, b, GIT_OID_RAWSZ);
+}
+
+/**
+ * ggit_oid_array_sort:
+ * @array: a #GgitOIdArray.
+ *
+ * Sorts the ids in @array. Once sorted, ggit_oid_array_find_prefix() uses
+ * a binary search until @array is modified.
+ **/
+void
+ggit_oid_array_sort (GgitOIdArray *array)
+{
+	g_return_if_fail (array != NULL);
+
+	if (!array->sorted)
+	{
+		qsort (array->oids->data, array->oids->len, sizeof (git_oid), compare_oids);
+		array->sorted = TRUE;
+	}
+}
+
+/* Removes the duplicates from a sorted array */
+void
+_ggit_oid_array_unique (GgitOIdArray *array)
+{
+	guint n = 0;
+	guint i;
+
+	g_return_if_fail (array->sorted);
+
+	for (i = 0; i < array->oids->len; ++i)
+	{
+		if (n > 0 &&
+		    memcmp (_ggit_oid_array_get_oid (array, i)->id,
+		            _ggit_oid_array_get_oid (array, n - 1)->id,
+		            GIT_OID_RAWSZ) == 0)
+		{
+			continue;
+		}
+
+		if (n != i)
+		{
+			g_array_index (array->oids, git_oid, n) =
+				g_array_index (array->oids, git_oid, i);
+		}
+
+		n++;
+	}
+
+	g_array_set_size (array->oids, n);
+}
+
+/* Finds the index of the first id not smaller than @raw in a sorted array */
+gsize
+_ggit_oid_array_lower_bound (GgitOIdArray *array,
+                             const guint8 *raw)
+{
+	gsize lo = 0;
+	gsize hi = array->oids->len;
+
+	while (lo < hi)
+	{
+		gsize mid = lo + (hi - lo) / 2;
+
+		if (memcmp (_ggit_oid_array_get_oid (array, mid)->id, raw, GIT_OID_RAWSZ) < 0)
+		{
+			lo = mid + 1;
+		}
+		else
+		{
+			hi = mid;
+		}
+	}
+
+	return lo;
+}
+
+/**
+ * ggit_oid_array_find_prefix:
+ * @array: a #GgitOIdArray.
+ * @prefix: a hex formatted prefix.
+ *
+ * Finds the ids in @array which start with @prefix. See
+ * ggit_oid_has_prefix().
+ *
+ * Returns: (transfer full) (element-type gsize): the indices of the
+ * matching ids, in increasing order.
+ **/
+GArray *
+ggit_oid_array_find_prefix (GgitOIdArray *array,
+                            const gchar  *prefix)
+{
+	guint8 raw[GIT_OID_RAWSZ];
+	gsize length;
+	gsize start = 0;
+	GArray *ret;
+	gsize i;
+
+	g_return_val_if_fail (array != NULL, NULL);
+	g_return_val_if_fail (prefix != NULL, NULL);
+
+	ret = g_array_new (FALSE, FALSE, sizeof (gsize));
+
+	if (!_ggit_oid_parse_prefix (prefix, raw, &length))
+	{
+		return ret;
+	}
+
+	if (array->sorted)
+	{
+		/* the prefix padded with zeros sorts before all its matches */
+		start = _ggit_oid_array_lower_bound (array, raw);
+	}
+
+	for (i = start; i < array->oids->len; ++i)
+	{
+		if (_ggit_oid_raw_has_prefix (_ggit_oid_array_get_oid (array, i)->id, raw, length))
+		{
+			g_array_append_val (ret, i);
+		}
+		else if (array->sorted)
+		{
+			break;
+		}
+	}
+
+	return ret;
+}
+
+/* ex:set ts=8 noet: */
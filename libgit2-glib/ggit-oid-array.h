@@ -0,0 +1,88 @@
+/*
+ * ggit-oid-array.h
+ * This file is part of libgit2-glib
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GGIT_OID_ARRAY_H__
+#define __GGIT_OID_ARRAY_H__
+
+#include <glib-object.h>
+#include <git2.h>
+
+#include <libgit2-glib/ggit-types.h>
+
+G_BEGIN_DECLS
+
+#define GGIT_TYPE_OID_ARRAY       (ggit_oid_array_get_type ())
+#define GGIT_OID_ARRAY(obj)       ((GgitOIdArray *)obj)
+
+GType          ggit_oid_array_get_type     (void) G_GNUC_CONST;
+
+GgitOIdArray  *ggit_oid_array_new          (gsize           n_reserved);
+
+GgitOIdArray  *ggit_oid_array_new_from_hex (const gchar    *hex,
+                                            gssize          length,
+                                            GError        **error);
+
+GgitOIdArray  *ggit_oid_array_ref          (GgitOIdArray   *array);
+void           ggit_oid_array_unref        (GgitOIdArray   *array);
+
+gsize          ggit_oid_array_get_size     (GgitOIdArray   *array);
+
+GgitOId       *ggit_oid_array_get          (GgitOIdArray   *array,
+                                            gsize           index);
+
+const guint8  *ggit_oid_array_get_raw      (GgitOIdArray   *array,
+                                            gsize          *size);
+
+void           ggit_oid_array_append       (GgitOIdArray   *array,
+                                            GgitOId        *oid);
+
+void           ggit_oid_array_append_raw   (GgitOIdArray   *array,
+                                            const guint8   *raw,
+                                            gsize           n_oids);
+
+gboolean       ggit_oid_array_append_hex   (GgitOIdArray   *array,
+                                            const gchar    *hex,
+                                            gssize          length,
+                                            GError        **error);
+
+gchar         *ggit_oid_array_to_hex       (GgitOIdArray   *array,
+                                            const gchar    *separator);
+
+void           ggit_oid_array_sort         (GgitOIdArray   *array);
+
+GArray        *ggit_oid_array_find_prefix  (GgitOIdArray   *array,
+                                            const gchar    *prefix);
+
+void           _ggit_oid_array_append_oid  (GgitOIdArray   *array,
+                                            const git_oid  *oid);
+
+const git_oid *_ggit_oid_array_get_oid     (GgitOIdArray   *array,
+                                            gsize           index);
+
+void           _ggit_oid_array_unique      (GgitOIdArray   *array);
+
+gsize          _ggit_oid_array_lower_bound (GgitOIdArray   *array,
+                                            const guint8   *raw);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (GgitOIdArray, ggit_oid_array_unref)
+
+G_END_DECLS
+
+#endif /* __GGIT_OID_ARRAY_H__ */
+
+/* ex:set ts=8 noet: */
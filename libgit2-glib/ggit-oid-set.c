@@ -0,0 +1,886 @@
+/*
+ * ggit-oid-set.c
+ * This file is part of libgit2-glib
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include <git2.h>
+
+#include "ggit-oid-set.h"
+#include "ggit-oid.h"
+
+/* Open addressing table with linear probing, shared by the set and the
+ * map. Keys are stored inline and since object ids are uniformly
+ * distributed, the first bytes of the id are used as the hash directly.
+ */
+typedef struct
+{
+	git_oid *keys;
+	gpointer *values;
+	guint8 *used;
+
+	gsize capacity;
+	gsize size;
+
+	guint with_values : 1;
+} OIdTable;
+
+#define OID_TABLE_MIN_CAPACITY 16
+
+struct _GgitOIdSet
+{
+	gint ref_count;
+
+	OIdTable table;
+};
+
+struct _GgitOIdMap
+{
+	gint ref_count;
+
+	OIdTable table;
+	GDestroyNotify value_destroy;
+};
+
+G_DEFINE_BOXED_TYPE (GgitOIdSet, ggit_oid_set,
+                     ggit_oid_set_ref, ggit_oid_set_unref)
+
+G_DEFINE_BOXED_TYPE (GgitOIdMap, ggit_oid_map,
+                     ggit_oid_map_ref, ggit_oid_map_unref)
+
+static inline gsize
+oid_table_hash (const git_oid *oid)
+{
+	guint64 hash;
+
+	memcpy (&hash, oid->id, sizeof (hash));
+
+	return (gsize)hash;
+}
+
+static inline gboolean
+oid_table_find (OIdTable      *table,
+                const git_oid *oid,
+                gsize         *index)
+{
+	gsize mask;
+	gsize i;
+
+	if (table->capacity == 0)
+	{
+		return FALSE;
+	}
+
+	mask = table->capacity - 1;
+	i = oid_table_hash (oid) & mask;
+
+	while (table->used[i])
+	{
+		if (memcmp (table->keys[i].id, oid->id, GIT_OID_RAWSZ) == 0)
+		{
+			*index = i;
+			return TRUE;
+		}
+
+		i = (i + 1) & mask;
+	}
+
+	*index = i;
+	return FALSE;
+}
+
+static void
+oid_table_resize (OIdTable *table,
+                  gsize     capacity)
+{
+	OIdTable old = *table;
+	gsize i;
+
+	table->keys = g_new (git_oid, capacity);
+	table->values = table->with_values ? g_new (gpointer, capacity) : NULL;
+	table->used = g_new0 (guint8, capacity);
+	table->capacity = capacity;
+
+	for (i = 0; i < old.capacity; ++i)
+	{
+		gsize index;
+
+		if (!old.used[i])
+		{
+			continue;
+		}
+
+		oid_table_find (table, &old.keys[i], &index);
+
+		table->keys[index] = old.keys[i];
+		table->used[index] = 1;
+
+		if (table->values != NULL)
+		{
+			table->values[index] = old.values[i];
+		}
+	}
+
+	g_free (old.keys);
+	g_free (old.values);
+	g_free (old.used);
+}
+
+static void
+oid_table_reserve (OIdTable *table,
+                   gsize     size)
+{
+	gsize capacity;
+
+	/* keep the load factor under 3/4 */
+	if (size < table->capacity - table->capacity / 4)
+	{
+		return;
+	}
+
+	capacity = MAX (table->capacity, OID_TABLE_MIN_CAPACITY);
+
+	while (size >= capacity - capacity / 4)
+	{
+		capacity <<= 1;
+	}
+
+	oid_table_resize (table, capacity);
+}
+
+static void
+oid_table_init (OIdTable *table,
+                gboolean  with_values,
+                gsize     n_reserved)
+{
+	memset (table, 0, sizeof (OIdTable));
+	table->with_values = with_values;
+
+	oid_table_reserve (table, n_reserved);
+}
+
+static gboolean
+oid_table_insert (OIdTable      *table,
+                  const git_oid *oid,
+                  gsize         *index)
+{
+	oid_table_reserve (table, table->size + 1);
+
+	if (oid_table_find (table, oid, index))
+	{
+		return FALSE;
+	}
+
+	git_oid_cpy (&table->keys[*index], oid);
+	table->used[*index] = 1;
+	table->size++;
+
+	return TRUE;
+}
+
+static void
+oid_table_remove_index (OIdTable *table,
+                        gsize     index)
+{
+	gsize mask = table->capacity - 1;
+	gsize i = index;
+	gsize j = index;
+
+	table->used[i] = 0;
+	table->size--;
+
+	/* shift back the entries of the probe sequence to close the gap */
+	for (;;)
+	{
+		gsize k;
+
+		j = (j + 1) & mask;
+
+		if (!table->used[j])
+		{
+			break;
+		}
+
+		k = oid_table_hash (&table->keys[j]) & mask;
+
+		if (i <= j ? (i < k && k <= j) : (i < k || k <= j))
+		{
+			continue;
+		}
+
+		table->keys[i] = table->keys[j];
+		table->used[i] = 1;
+
+		if (table->values != NULL)
+		{
+			table->values[i] = table->values[j];
+		}
+
+		table->used[j] = 0;
+		i = j;
+	}
+}
+
+static void
+oid_table_clear (OIdTable       *table,
+                 GDestroyNotify  value_destroy)
+{
+	gsize i;
+
+	if (value_destroy != NULL)
+	{
+		for (i = 0; i < table->capacity; ++i)
+		{
+			if (table->used[i])
+			{
+				value_destroy (table->values[i]);
+			}
+		}
+	}
+
+	if (table->used != NULL)
+	{
+		memset (table->used, 0, table->capacity);
+	}
+
+	table->size = 0;
+}
+
+static void
+oid_table_free (OIdTable       *table,
+                GDestroyNotify  value_destroy)
+{
+	oid_table_clear (table, value_destroy);
+
+	g_free (table->keys);
+	g_free (table->values);
+	g_free (table->used);
+}
+
+static GPtrArray *
+oid_table_get_keys (OIdTable *table)
+{
+	GPtrArray *ret;
+	gsize i;
+
+	ret = g_ptr_array_new_full (table->size, (GDestroyNotify)ggit_oid_free);
+
+	for (i = 0; i < table->capacity; ++i)
+	{
+		if (table->used[i])
+		{
+			g_ptr_array_add (ret, _ggit_oid_wrap (&table->keys[i]));
+		}
+	}
+
+	return ret;
+}
+
+/**
+ * ggit_oid_set_new:
+ * @n_reserved: the number of ids to reserve space for, or 0.
+ *
+ * Creates a new empty #GgitOIdSet. Ids are stored inline in the set, so
+ * adding an id does not allocate memory unless the set has to grow.
+ * Reserving space upfront avoids growing the set while it is filled.
+ *
+ * A #GgitOIdSet is not thread safe.
+ *
+ * Returns: (transfer full): a new #GgitOIdSet.
+ */
+GgitOIdSet *
+ggit_oid_set_new (gsize n_reserved)
+{
+	GgitOIdSet *set;
+
+	set = g_slice_new (GgitOIdSet);
+	set->ref_count = 1;
+	oid_table_init (&set->table, FALSE, n_reserved);
+
+	return set;
+}
+
+/**
+ * ggit_oid_set_ref:
+ * @set: a #GgitOIdSet.
+ *
+ * Atomically increments the reference count of @set by one.
+ * This function is MT-safe and may be called from any thread.
+ *
+ * Returns: (transfer none) (nullable): a #GgitOIdSet or %NULL.
+ **/
+GgitOIdSet *
+ggit_oid_set_ref (GgitOIdSet *set)
+{
+	g_return_val_if_fail (set != NULL, NULL);
+
+	g_atomic_int_inc (&set->ref_count);
+
+	return set;
+}
+
+/**
+ * ggit_oid_set_unref:
+ * @set: a #GgitOIdSet.
+ *
+ * Atomically decrements the reference count of @set by one.
+ * If the reference count drops to 0, @set is freed.
+ **/
+void
+ggit_oid_set_unref (GgitOIdSet *set)
+{
+	g_return_if_fail (set != NULL);
+
+	if (g_atomic_int_dec_and_test (&set->ref_count))
+	{
+		oid_table_free (&set->table, NULL);
+		g_slice_free (GgitOIdSet, set);
+	}
+}
+
+/**
+ * ggit_oid_set_get_size:
+ * @set: a #GgitOIdSet.
+ *
+ * Gets the number of ids in @set.
+ *
+ * Returns: the number of ids in @set.
+ **/
+gsize
+ggit_oid_set_get_size (GgitOIdSet *set)
+{
+	g_return_val_if_fail (set != NULL, 0);
+
+	return set->table.size;
+}
+
+gboolean
+_ggit_oid_set_add_oid (GgitOIdSet    *set,
+                       const git_oid *oid)
+{
+	gsize index;
+
+	return oid_table_insert (&set->table, oid, &index);
+}
+
+gboolean
+_ggit_oid_set_contains_oid (GgitOIdSet    *set,
+                            const git_oid *oid)
+{
+	gsize index;
+
+	return oid_table_find (&set->table, oid, &index);
+}
+
+gboolean
+_ggit_oid_set_remove_oid (GgitOIdSet    *set,
+                          const git_oid *oid)
+{
+	gsize index;
+
+	if (!oid_table_find (&set->table, oid, &index))
+	{
+		return FALSE;
+	}
+
+	oid_table_remove_index (&set->table, index);
+
+	return TRUE;
+}
+
+/**
+ * ggit_oid_set_add:
+ * @set: a #GgitOIdSet.
+ * @oid: a #GgitOId.
+ *
+ * Adds @oid to @set.
+ *
+ * Returns: %TRUE if @oid was added, %FALSE if it was already in @set.
+ **/
+gboolean
+ggit_oid_set_add (GgitOIdSet *set,
+                  GgitOId    *oid)
+{
+	g_return_val_if_fail (set != NULL, FALSE);
+	g_return_val_if_fail (oid != NULL, FALSE);
+
+	return _ggit_oid_set_add_oid (set, _ggit_oid_get_oid (oid));
+}
+
+/**
+ * ggit_oid_set_add_many:
+ * @set: a #GgitOIdSet.
+ * @oids: (array length=n_oids): the ids to add.
+ * @n_oids: the number of ids in @oids.
+ *
+ * Adds all the ids in @oids to @set.
+ *
+ * Returns: the number of ids that were not already in @set.
+ **/
+gsize
+ggit_oid_set_add_many (GgitOIdSet  *set,
+                       GgitOId    **oids,
+                       gsize        n_oids)
+{
+	gsize added = 0;
+	gsize i;
+
+	g_return_val_if_fail (set != NULL, 0);
+	g_return_val_if_fail (oids != NULL || n_oids == 0, 0);
+
+	oid_table_reserve (&set->table, set->table.size + n_oids);
+
+	for (i = 0; i < n_oids; ++i)
+	{
+		if (_ggit_oid_set_add_oid (set, _ggit_oid_get_oid (oids[i])))
+		{
+			added++;
+		}
+	}
+
+	return added;
+}
+
+/**
+ * ggit_oid_set_add_raw:
+ * @set: a #GgitOIdSet.
+ * @raw: (array): @n_oids raw ids of #GGIT_OID_RAWSZ bytes each, stored
+ *       contiguously.
+ * @n_oids: the number of ids in @raw.
+ *
+ * Adds all the raw ids in @raw to @set, without creating a #GgitOId for
+ * each of them.
+ *
+ * Returns: the number of ids that were not already in @set.
+ **/
+gsize
+ggit_oid_set_add_raw (GgitOIdSet   *set,
+                      const guint8 *raw,
+                      gsize         n_oids)
+{
+	gsize added = 0;
+	gsize i;
+
+	g_return_val_if_fail (set != NULL, 0);
+	g_return_val_if_fail (raw != NULL || n_oids == 0, 0);
+
+	oid_table_reserve (&set->table, set->table.size + n_oids);
+
+	for (i = 0; i < n_oids; ++i)
+	{
+		git_oid oid;
+
+		git_oid_fromraw (&oid, raw + i * GIT_OID_RAWSZ);
+
+		if (_ggit_oid_set_add_oid (set, &oid))
+		{
+			added++;
+		}
+	}
+
+	return added;
+}
+
+/**
+ * ggit_oid_set_contains:
+ * @set: a #GgitOIdSet.
+ * @oid: a #GgitOId.
+ *
+ * Checks whether @oid is in @set.
+ *
+ * Returns: %TRUE if @oid is in @set, %FALSE otherwise.
+ **/
+gboolean
+ggit_oid_set_contains (GgitOIdSet *set,
+                       GgitOId    *oid)
+{
+	g_return_val_if_fail (set != NULL, FALSE);
+	g_return_val_if_fail (oid != NULL, FALSE);
+
+	return _ggit_oid_set_contains_oid (set, _ggit_oid_get_oid (oid));
+}
+
+/**
+ * ggit_oid_set_contains_many:
+ * @set: a #GgitOIdSet.
+ * @oids: (array length=n_oids): the ids to check.
+ * @n_oids: the number of ids in @oids.
+ *
+ * Checks which of the ids in @oids are in @set.
+ *
+ * Returns: (transfer full) (element-type gboolean): for every id in @oids
+ * whether it is in @set.
+ **/
+GArray *
+ggit_oid_set_contains_many (GgitOIdSet  *set,
+                            GgitOId    **oids,
+                            gsize        n_oids)
+{
+	GArray *ret;
+	gsize i;
+
+	g_return_val_if_fail (set != NULL, NULL);
+	g_return_val_if_fail (oids != NULL || n_oids == 0, NULL);
+
+	ret = g_array_sized_new (FALSE, FALSE, sizeof (gboolean), n_oids);
+	g_array_set_size (ret, n_oids);
+
+	for (i = 0; i < n_oids; ++i)
+	{
+		g_array_index (ret, gboolean, i) =
+			_ggit_oid_set_contains_oid (set, _ggit_oid_get_oid (oids[i]));
+	}
+
+	return ret;
+}
+
+/**
+ * ggit_oid_set_remove:
+ * @set: a #GgitOIdSet.
+ * @oid: a #GgitOId.
+ *
+ * Removes @oid from @set.
+ *
+ * Returns: %TRUE if @oid was in @set, %FALSE otherwise.
+ **/
+gboolean
+ggit_oid_set_remove (GgitOIdSet *set,
+                     GgitOId    *oid)
+{
+	g_return_val_if_fail (set != NULL, FALSE);
+	g_return_val_if_fail (oid != NULL, FALSE);
+
+	return _ggit_oid_set_remove_oid (set, _ggit_oid_get_oid (oid));
+}
+
+/**
+ * ggit_oid_set_clear:
+ * @set: a #GgitOIdSet.
+ *
+ * Removes all the ids from @set. The memory used by @set is kept to be
+ * reused.
+ **/
+void
+ggit_oid_set_clear (GgitOIdSet *set)
+{
+	g_return_if_fail (set != NULL);
+
+	oid_table_clear (&set->table, NULL);
+}
+
+/**
+ * ggit_oid_set_get_oids:
+ * @set: a #GgitOIdSet.
+ *
+ * Gets all the ids in @set, in no particular order.
+ *
+ * Returns: (transfer full) (element-type GgitOId): the ids in @set.
+ **/
+GPtrArray *
+ggit_oid_set_get_oids (GgitOIdSet *set)
+{
+	g_return_val_if_fail (set != NULL, NULL);
+
+	return oid_table_get_keys (&set->table);
+}
+
+/**
+ * ggit_oid_map_new: (skip)
+ * @n_reserved: the number of ids to reserve space for, or 0.
+ * @value_destroy: (allow-none): a function to free the values, or %NULL.
+ *
+ * Creates a new empty #GgitOIdMap. Like #GgitOIdSet, the ids are stored
+ * inline in the map.
+ *
+ * A #GgitOIdMap is not thread safe. Bindings should use
+ * ggit_oid_map_new_for_objects() instead.
+ *
+ * Returns: (transfer full): a new #GgitOIdMap.
+ */
+GgitOIdMap *
+ggit_oid_map_new (gsize          n_reserved,
+                  GDestroyNotify value_destroy)
+{
+	GgitOIdMap *map;
+
+	map = g_slice_new (GgitOIdMap);
+	map->ref_count = 1;
+	map->value_destroy = value_destroy;
+	oid_table_init (&map->table, TRUE, n_reserved);
+
+	return map;
+}
+
+/**
+ * ggit_oid_map_new_for_objects:
+ * @n_reserved: the number of ids to reserve space for, or 0.
+ *
+ * Creates a new empty #GgitOIdMap whose values are #GObject<!-- -->s. The
+ * map holds a reference on its values. Use ggit_oid_map_insert_object()
+ * and ggit_oid_map_lookup_object() to access them.
+ *
+ * Returns: (transfer full): a new #GgitOIdMap.
+ */
+GgitOIdMap *
+ggit_oid_map_new_for_objects (gsize n_reserved)
+{
+	return ggit_oid_map_new (n_reserved, g_object_unref);
+}
+
+/**
+ * ggit_oid_map_ref:
+ * @map: a #GgitOIdMap.
+ *
+ * Atomically increments the reference count of @map by one.
+ * This function is MT-safe and may be called from any thread.
+ *
+ * Returns: (transfer none) (nullable): a #GgitOIdMap or %NULL.
+ **/
+GgitOIdMap *
+ggit_oid_map_ref (GgitOIdMap *map)
+{
+	g_return_val_if_fail (map != NULL, NULL);
+
+	g_atomic_int_inc (&map->ref_count);
+
+	return map;
+}
+
+/**
+ * ggit_oid_map_unref:
+ * @map: a #GgitOIdMap.
+ *
+ * Atomically decrements the reference count of @map by one.
+ * If the reference count drops to 0, @map is freed.
+ **/
+void
+ggit_oid_map_unref (GgitOIdMap *map)
+{
+	g_return_if_fail (map != NULL);
+
+	if (g_atomic_int_dec_and_test (&map->ref_count))
+	{
+		oid_table_free (&map->table, map->value_destroy);
+		g_slice_free (GgitOIdMap, map);
+	}
+}
+
+/**
+ * ggit_oid_map_get_size:
+ * @map: a #GgitOIdMap.
+ *
+ * Gets the number of ids in @map.
+ *
+ * Returns: the number of ids in @map.
+ **/
+gsize
+ggit_oid_map_get_size (GgitOIdMap *map)
+{
+	g_return_val_if_fail (map != NULL, 0);
+
+	return map->table.size;
+}
+
+/**
+ * ggit_oid_map_insert: (skip)
+ * @map: a #GgitOIdMap.
+ * @oid: a #GgitOId.
+ * @value: (allow-none): the value to associate with @oid.
+ *
+ * Associates @value with @oid in @map. If @oid was already in @map, its
+ * previous value is freed.
+ *
+ * Returns: %TRUE if @oid was not in @map yet, %FALSE otherwise.
+ **/
+gboolean
+ggit_oid_map_insert (GgitOIdMap *map,
+                     GgitOId    *oid,
+                     gpointer    value)
+{
+	gsize index;
+	gboolean added;
+
+	g_return_val_if_fail (map != NULL, FALSE);
+	g_return_val_if_fail (oid != NULL, FALSE);
+
+	added = oid_table_insert (&map->table, _ggit_oid_get_oid (oid), &index);
+
+	if (!added && map->value_destroy != NULL)
+	{
+		map->value_destroy (map->table.values[index]);
+	}
+
+	map->table.values[index] = value;
+
+	return added;
+}
+
+/**
+ * ggit_oid_map_lookup: (skip)
+ * @map: a #GgitOIdMap.
+ * @oid: a #GgitOId.
+ *
+ * Looks up the value associated with @oid in @map.
+ *
+ * Returns: (transfer none) (nullable): the value associated with @oid, or
+ * %NULL if @oid is not in @map.
+ **/
+gpointer
+ggit_oid_map_lookup (GgitOIdMap *map,
+                     GgitOId    *oid)
+{
+	gsize index;
+
+	g_return_val_if_fail (map != NULL, NULL);
+	g_return_val_if_fail (oid != NULL, NULL);
+
+	if (!oid_table_find (&map->table, _ggit_oid_get_oid (oid), &index))
+	{
+		return NULL;
+	}
+
+	return map->table.values[index];
+}
+
+/**
+ * ggit_oid_map_insert_object:
+ * @map: a #GgitOIdMap created with ggit_oid_map_new_for_objects().
+ * @oid: a #GgitOId.
+ * @value: (type GObject): the object to associate with @oid.
+ *
+ * Associates @value with @oid in @map, taking a reference on @value. If
+ * @oid was already in @map, the reference on its previous value is
+ * released.
+ *
+ * Returns: %TRUE if @oid was not in @map yet, %FALSE otherwise.
+ **/
+gboolean
+ggit_oid_map_insert_object (GgitOIdMap *map,
+                            GgitOId    *oid,
+                            gpointer    value)
+{
+	g_return_val_if_fail (map != NULL, FALSE);
+	g_return_val_if_fail (map->value_destroy == g_object_unref, FALSE);
+	g_return_val_if_fail (G_IS_OBJECT (value), FALSE);
+
+	return ggit_oid_map_insert (map, oid, g_object_ref (value));
+}
+
+/**
+ * ggit_oid_map_lookup_object:
+ * @map: a #GgitOIdMap created with ggit_oid_map_new_for_objects().
+ * @oid: a #GgitOId.
+ *
+ * Looks up the object associated with @oid in @map.
+ *
+ * Returns: (transfer none) (type GObject) (nullable): the object
+ * associated with @oid, or %NULL if @oid is not in @map.
+ **/
+gpointer
+ggit_oid_map_lookup_object (GgitOIdMap *map,
+                            GgitOId    *oid)
+{
+	g_return_val_if_fail (map != NULL, NULL);
+	g_return_val_if_fail (map->value_destroy == g_object_unref, NULL);
+
+	return ggit_oid_map_lookup (map, oid);
+}
+
+/**
+ * ggit_oid_map_contains:
+ * @map: a #GgitOIdMap.
+ * @oid: a #GgitOId.
+ *
+ * Checks whether @oid is in @map.
+ *
+ * Returns: %TRUE if @oid is in @map, %FALSE otherwise.
+ **/
+gboolean
+ggit_oid_map_contains (GgitOIdMap *map,
+                       GgitOId    *oid)
+{
+	gsize index;
+
+	g_return_val_if_fail (map != NULL, FALSE);
+	g_return_val_if_fail (oid != NULL, FALSE);
+
+	return oid_table_find (&map->table, _ggit_oid_get_oid (oid), &index);
+}
+
+/**
+ * ggit_oid_map_remove:
+ * @map: a #GgitOIdMap.
+ * @oid: a #GgitOId.
+ *
+ * Removes @oid and its value from @map.
+ *
+ * Returns: %TRUE if @oid was in @map, %FALSE otherwise.
+ **/
+gboolean
+ggit_oid_map_remove (GgitOIdMap *map,
+                     GgitOId    *oid)
+{
+	gsize index;
+
+	g_return_val_if_fail (map != NULL, FALSE);
+	g_return_val_if_fail (oid != NULL, FALSE);
+
+	if (!oid_table_find (&map->table, _ggit_oid_get_oid (oid), &index))
+	{
+		return FALSE;
+	}
+
+	if (map->value_destroy != NULL)
+	{
+		map->value_destroy (map->table.values[index]);
+	}
+
+	oid_table_remove_index (&map->table, index);
+
+	return TRUE;
+}
+
+/**
+ * ggit_oid_map_clear:
+ * @map: a #GgitOIdMap.
+ *
+ * Removes all the ids and their values from @map.
+ **/
+void
+ggit_oid_map_clear (GgitOIdMap *map)
+{
+	g_return_if_fail (map != NULL);
+
+	oid_table_clear (&map->table, map->value_destroy);
+}
+
+/**
+ * ggit_oid_map_get_keys:
+ * @map: a #GgitOIdMap.
+ *
+ * Gets all the ids in @map, in no particular order.
+ *
+ * Returns: (transfer full) (element-type GgitOId): the ids in @map.
+ **/
+GPtrArray *
+ggit_oid_map_get_keys (GgitOIdMap *map)
+{
+	g_return_val_if_fail (map != NULL, NULL);
+
+	return oid_table_get_keys (&map->table);
+}
+
+/* ex:set ts=8 noet: */
@@ -0,0 +1,121 @@
+/*
+ * ggit-oid-set.h
+ * This file is part of libgit2-glib
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GGIT_OID_SET_H__
+#define __GGIT_OID_SET_H__
+
+#include <glib-object.h>
+#include <git2.h>
+
+#include <libgit2-glib/ggit-types.h>
+
+G_BEGIN_DECLS
+
+#define GGIT_TYPE_OID_SET       (ggit_oid_set_get_type ())
+#define GGIT_OID_SET(obj)       ((GgitOIdSet *)obj)
+
+#define GGIT_TYPE_OID_MAP       (ggit_oid_map_get_type ())
+#define GGIT_OID_MAP(obj)       ((GgitOIdMap *)obj)
+
+GType           ggit_oid_set_get_type      (void) G_GNUC_CONST;
+
+GgitOIdSet     *ggit_oid_set_new           (gsize           n_reserved);
+
+GgitOIdSet     *ggit_oid_set_ref           (GgitOIdSet     *set);
+void            ggit_oid_set_unref         (GgitOIdSet     *set);
+
+gsize           ggit_oid_set_get_size      (GgitOIdSet     *set);
+
+gboolean        ggit_oid_set_add           (GgitOIdSet     *set,
+                                            GgitOId        *oid);
+
+gsize           ggit_oid_set_add_many      (GgitOIdSet     *set,
+                                            GgitOId       **oids,
+                                            gsize           n_oids);
+
+gsize           ggit_oid_set_add_raw       (GgitOIdSet     *set,
+                                            const guint8   *raw,
+                                            gsize           n_oids);
+
+gboolean        ggit_oid_set_contains      (GgitOIdSet     *set,
+                                            GgitOId        *oid);
+
+GArray         *ggit_oid_set_contains_many (GgitOIdSet     *set,
+                                            GgitOId       **oids,
+                                            gsize           n_oids);
+
+gboolean        ggit_oid_set_remove        (GgitOIdSet     *set,
+                                            GgitOId        *oid);
+
+void            ggit_oid_set_clear         (GgitOIdSet     *set);
+
+GPtrArray      *ggit_oid_set_get_oids      (GgitOIdSet     *set);
+
+gboolean        _ggit_oid_set_add_oid      (GgitOIdSet     *set,
+                                            const git_oid  *oid);
+
+gboolean        _ggit_oid_set_contains_oid (GgitOIdSet     *set,
+                                            const git_oid  *oid);
+
+gboolean        _ggit_oid_set_remove_oid   (GgitOIdSet     *set,
+                                            const git_oid  *oid);
+
+GType           ggit_oid_map_get_type      (void) G_GNUC_CONST;
+
+GgitOIdMap     *ggit_oid_map_new           (gsize           n_reserved,
+                                            GDestroyNotify  value_destroy);
+
+GgitOIdMap     *ggit_oid_map_new_for_objects (gsize         n_reserved);
+
+GgitOIdMap     *ggit_oid_map_ref           (GgitOIdMap     *map);
+void            ggit_oid_map_unref         (GgitOIdMap     *map);
+
+gsize           ggit_oid_map_get_size      (GgitOIdMap     *map);
+
+gboolean        ggit_oid_map_insert        (GgitOIdMap     *map,
+                                            GgitOId        *oid,
+                                            gpointer        value);
+
+gpointer        ggit_oid_map_lookup        (GgitOIdMap     *map,
+                                            GgitOId        *oid);
+
+gboolean        ggit_oid_map_insert_object (GgitOIdMap     *map,
+                                            GgitOId        *oid,
+                                            gpointer        value);
+
+gpointer        ggit_oid_map_lookup_object (GgitOIdMap     *map,
+                                            GgitOId        *oid);
+
+gboolean        ggit_oid_map_contains      (GgitOIdMap     *map,
+                                            GgitOId        *oid);
+
+gboolean        ggit_oid_map_remove        (GgitOIdMap     *map,
+                                            GgitOId        *oid);
+
+void            ggit_oid_map_clear         (GgitOIdMap     *map);
+
+GPtrArray      *ggit_oid_map_get_keys      (GgitOIdMap     *map);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (GgitOIdSet, ggit_oid_set_unref)
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (GgitOIdMap, ggit_oid_map_unref)
+
+G_END_DECLS
+
+#endif /* __GGIT_OID_SET_H__ */
+
+/* ex:set ts=8 noet: */
@@ -18,6 +18,7 @@
  * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <string.h>
 #include <git2.h>
 
 #include "ggit-oid.h"
@@ -29,6 +30,118 @@ struct _GgitOId
 
 G_DEFINE_BOXED_TYPE (GgitOId, ggit_oid, ggit_oid_copy, ggit_oid_free)
 
+/* Lookup tables for hex conversion. Formatting copies two characters per
+ * byte and parsing accumulates invalid digits in a single check per id,
+ * which keeps the loops free of branches so the compiler can vectorize
+ * them.
+ */
+static const gchar hex_pairs[] =
+	"000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f"
+	"202122232425262728292a2b2c2d2e2f303132333435363738393a3b3c3d3e3f"
+	"404142434445464748494a4b4c4d4e4f505152535455565758595a5b5c5d5e5f"
+	"606162636465666768696a6b6c6d6e6f707172737475767778797a7b7c7d7e7f"
+	"808182838485868788898a8b8c8d8e8f909192939495969798999a9b9c9d9e9f"
+	"a0a1a2a3a4a5a6a7a8a9aaabacadaeafb0b1b2b3b4b5b6b7b8b9babbbcbdbebf"
+	"c0c1c2c3c4c5c6c7c8c9cacbcccdcecfd0d1d2d3d4d5d6d7d8d9dadbdcdddedf"
+	"e0e1e2e3e4e5e6e7e8e9eaebecedeeeff0f1f2f3f4f5f6f7f8f9fafbfcfdfeff";
+
+static const gint8 hex_values[256] = {
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	 0,  1,  2,  3,  4,  5,  6,  7,  8,  9, -1, -1, -1, -1, -1, -1,
+	-1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+};
+
+void
+_ggit_oid_format_hex (const guint8 *raw,
+                      gchar        *hex)
+{
+	gint i;
+
+	for (i = 0; i < GIT_OID_RAWSZ; ++i)
+	{
+		memcpy (hex + i * 2, hex_pairs + raw[i] * 2, 2);
+	}
+}
+
+gboolean
+_ggit_oid_parse_hex (const gchar *hex,
+                     guint8      *raw)
+{
+	gint8 invalid = 0;
+	gint i;
+
+	for (i = 0; i < GIT_OID_RAWSZ; ++i)
+	{
+		gint8 hi = hex_values[(guint8)hex[i * 2]];
+		gint8 lo = hex_values[(guint8)hex[i * 2 + 1]];
+
+		invalid |= hi | lo;
+		raw[i] = (guint8)(((guint8)hi << 4) | ((guint8)lo & 0xf));
+	}
+
+	return invalid >= 0;
+}
+
+gboolean
+_ggit_oid_parse_prefix (const gchar *prefix,
+                        guint8      *raw,
+                        gsize       *length)
+{
+	gsize i;
+
+	memset (raw, 0, GIT_OID_RAWSZ);
+
+	for (i = 0; prefix[i] != '\0'; ++i)
+	{
+		gint8 v;
+
+		if (i == GIT_OID_HEXSZ)
+		{
+			return FALSE;
+		}
+
+		v = hex_values[(guint8)prefix[i]];
+
+		if (v < 0)
+		{
+			return FALSE;
+		}
+
+		raw[i / 2] |= (i % 2) == 0 ? v << 4 : v;
+	}
+
+	*length = i;
+	return TRUE;
+}
+
+gboolean
+_ggit_oid_raw_has_prefix (const guint8 *raw,
+                          const guint8 *prefix,
+                          gsize         length)
+{
+	gsize n_bytes = length / 2;
+
+	if (memcmp (raw, prefix, n_bytes) != 0)
+	{
+		return FALSE;
+	}
+
+	return (length % 2) == 0 || (raw[n_bytes] & 0xf0) == prefix[n_bytes];
+}
+
 GgitOId *
 _ggit_oid_wrap (const git_oid *oid)
 {
@@ -157,8 +270,10 @@ ggit_oid_to_string (GgitOId *oid)
 	g_return_val_if_fail (oid != NULL, NULL);
 
 	hex = g_new (char, GIT_OID_HEXSZ + 1);
+	_ggit_oid_format_hex (oid->oid.id, hex);
+	hex[GIT_OID_HEXSZ] = '\0';
 
-	return git_oid_tostr (hex, GIT_OID_HEXSZ + 1, &oid->oid);
+	return hex;
 }
 
 /**
@@ -234,27 +349,6 @@ ggit_oid_is_zero (GgitOId const *oid)
 	return git_oid_iszero (&oid->oid) == 1;
 }
 
-static gint
-c_to_h (gchar c)
-{
-	if (c >= '0' && c <= '9')
-	{
-		return c - '0';
-	}
-	else if (c >= 'A' && c <= 'F')
-	{
-		return 10 + (c - 'A');
-	}
-	else if (c >= 'a' && c <= 'f')
-	{
-		return 10 + (c - 'a');
-	}
-	else
-	{
-		return -1;
-	}
-}
-
 /**
  * ggit_oid_has_prefix:
  * @oid: a #GgitOId.
@@ -269,47 +363,18 @@ gboolean
 ggit_oid_has_prefix (GgitOId     *oid,
                      const gchar *prefix)
 {
-	gint i;
+	guint8 raw[GIT_OID_RAWSZ];
+	gsize length;
 
-	for (i = 0; i < GIT_OID_RAWSZ; ++i)
-	{
-		gint v1;
-
-		if (*prefix == '\0')
-		{
-			return TRUE;
-		}
-
-		v1 = c_to_h (*prefix++);
-
-		if (v1 == -1)
-		{
-			return FALSE;
-		}
-
-		if (*prefix != '\0')
-		{
-			gint v2;
-
-			v2 = c_to_h (*prefix++);
-
-			if (v2 == -1)
-			{
-				return FALSE;
-			}
+	g_return_val_if_fail (oid != NULL, FALSE);
+	g_return_val_if_fail (prefix != NULL, FALSE);
 
-			if (oid->oid.id[i] != (v1 << 4) + v2)
-			{
-				return FALSE;
-			}
-		}
-		else if (oid->oid.id[i] >> 4 != v1)
-		{
-			return FALSE;
-		}
+	if (!_ggit_oid_parse_prefix (prefix, raw, &length))
+	{
+		return FALSE;
 	}
 
-	return *prefix == '\0';
+	return _ggit_oid_raw_has_prefix (oid->oid.id, raw, length);
 }
 
 /* ex:set ts=8 noet: */
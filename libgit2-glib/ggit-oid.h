@@ -32,12 +32,40 @@ G_BEGIN_DECLS
 #define GGIT_TYPE_OID       (ggit_oid_get_type ())
 #define GGIT_OID(obj)       ((GgitOId *)obj)
 
+/**
+ * GGIT_OID_RAWSZ:
+ *
+ * The size in bytes of a raw (binary) object id.
+ */
+#define GGIT_OID_RAWSZ      20
+
+/**
+ * GGIT_OID_HEXSZ:
+ *
+ * The size in characters of a hex formatted object id.
+ */
+#define GGIT_OID_HEXSZ      (GGIT_OID_RAWSZ * 2)
+
 GType          ggit_oid_get_type        (void) G_GNUC_CONST;
 
 GgitOId       *_ggit_oid_wrap           (const git_oid *oid);
 
 const git_oid *_ggit_oid_get_oid        (GgitOId       *oid);
 
+void           _ggit_oid_format_hex     (const guint8  *raw,
+                                         gchar         *hex);
+
+gboolean       _ggit_oid_parse_hex      (const gchar   *hex,
+                                         guint8        *raw);
+
+gboolean       _ggit_oid_parse_prefix   (const gchar   *prefix,
+                                         guint8        *raw,
+                                         gsize         *length);
+
+gboolean       _ggit_oid_raw_has_prefix (const guint8  *raw,
+                                         const guint8  *prefix,
+                                         gsize          length);
+
 GgitOId       *ggit_oid_copy            (GgitOId       *oid);
 void           ggit_oid_free            (GgitOId       *oid);
 
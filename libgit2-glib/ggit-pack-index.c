@@ -0,0 +1,265 @@
+/*
+ * ggit-pack-index.c
+ * This file is part of libgit2-glib
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include <gio/gio.h>
+
+#include "ggit-pack-index.h"
+
+/* A pack index (.idx) file, mapped in memory.
+ *
+ * Version 1 is the fan-out table followed by offset and id pairs.
+ * Version 2 is a header, the fan-out table, the sorted ids, their CRCs,
+ * their 31 bit offsets and the 64 bit offsets that do not fit in those.
+ */
+struct _GgitPackIndex
+{
+	GMappedFile *file;
+	const guint8 *data;
+	gsize size;
+
+	guint version;
+	guint32 n_objects;
+
+	const guint8 *fanout;
+	const guint8 *ids;
+	gsize stride;
+
+	/* version 2 only */
+	const guint8 *offsets;
+	const guint8 *large_offsets;
+};
+
+#define PACK_IDX_SIGNATURE "\377tOc"
+#define PACK_IDX_FANOUT_SIZE (256 * 4)
+
+static inline guint32
+read_be32 (const guint8 *data)
+{
+	guint32 value;
+
+	memcpy (&value, data, sizeof (value));
+
+	return GUINT32_FROM_BE (value);
+}
+
+static inline guint64
+read_be64 (const guint8 *data)
+{
+	guint64 value;
+
+	memcpy (&value, data, sizeof (value));
+
+	return GUINT64_FROM_BE (value);
+}
+
+static gboolean
+parse_v2 (GgitPackIndex *index)
+{
+	index->fanout = index->data + 8;
+	index->n_objects = read_be32 (index->fanout + PACK_IDX_FANOUT_SIZE - 4);
+
+	/* ids, crcs and offsets, followed by the large offsets */
+	if (read_be32 (index->data + 4) != 2 ||
+	    index->size < 8 + PACK_IDX_FANOUT_SIZE +
+	                  (gsize)index->n_objects * (GIT_OID_RAWSZ + 8))
+	{
+		return FALSE;
+	}
+
+	index->version = 2;
+	index->ids = index->fanout + PACK_IDX_FANOUT_SIZE;
+	index->stride = GIT_OID_RAWSZ;
+	index->offsets = index->ids + (gsize)index->n_objects * (GIT_OID_RAWSZ + 4);
+	index->large_offsets = index->offsets + (gsize)index->n_objects * 4;
+
+	return TRUE;
+}
+
+static gboolean
+parse_v1 (GgitPackIndex *index)
+{
+	index->fanout = index->data;
+	index->n_objects = read_be32 (index->fanout + PACK_IDX_FANOUT_SIZE - 4);
+
+	if (index->size < PACK_IDX_FANOUT_SIZE +
+	                  (gsize)index->n_objects * (4 + GIT_OID_RAWSZ))
+	{
+		return FALSE;
+	}
+
+	index->version = 1;
+	index->ids = index->fanout + PACK_IDX_FANOUT_SIZE + 4;
+	index->stride = 4 + GIT_OID_RAWSZ;
+
+	return TRUE;
+}
+
+GgitPackIndex *
+_ggit_pack_index_open (const gchar  *path,
+                       GError      **error)
+{
+	GgitPackIndex *index;
+	GMappedFile *file;
+	gboolean valid = FALSE;
+
+	g_return_val_if_fail (path != NULL, NULL);
+
+	file = g_mapped_file_new (path, FALSE, NULL);
+
+	if (file == NULL)
+	{
+		return NULL;
+	}
+
+	index = g_slice_new0 (GgitPackIndex);
+	index->file = file;
+	index->data = (const guint8 *)g_mapped_file_get_contents (file);
+	index->size = g_mapped_file_get_length (file);
+
+	if (index->size >= 8 + PACK_IDX_FANOUT_SIZE &&
+	    memcmp (index->data, PACK_IDX_SIGNATURE, 4) == 0)
+	{
+		valid = parse_v2 (index);
+	}
+	else if (index->size >= PACK_IDX_FANOUT_SIZE)
+	{
+		valid = parse_v1 (index);
+	}
+
+	if (!valid)
+	{
+		g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+		             "Invalid pack index file '%s'", path);
+
+		_ggit_pack_index_free (index);
+		return NULL;
+	}
+
+	return index;
+}
+
+void
+_ggit_pack_index_free (GgitPackIndex *index)
+{
+	if (index == NULL)
+	{
+		return;
+	}
+
+	g_mapped_file_unref (index->file);
+	g_slice_free (GgitPackIndex, index);
+}
+
+guint32
+_ggit_pack_index_get_n_objects (GgitPackIndex *index)
+{
+	g_return_val_if_fail (index != NULL, 0);
+
+	return index->n_objects;
+}
+
+const guint8 *
+_ggit_pack_index_get_ids (GgitPackIndex *index,
+                          gsize         *stride)
+{
+	g_return_val_if_fail (index != NULL, NULL);
+
+	if (stride != NULL)
+	{
+		*stride = index->stride;
+	}
+
+	return index->ids;
+}
+
+static guint64
+get_offset (GgitPackIndex *index,
+            guint32        pos,
+            gboolean      *valid)
+{
+	guint32 offset;
+
+	if (index->version == 1)
+	{
+		return read_be32 (index->ids + (gsize)pos * index->stride - 4);
+	}
+
+	offset = read_be32 (index->offsets + (gsize)pos * 4);
+
+	if ((offset & 0x80000000) == 0)
+	{
+		return offset;
+	}
+
+	offset &= 0x7fffffff;
+
+	if (index->large_offsets + ((gsize)offset + 1) * 8 > index->data + index->size)
+	{
+		*valid = FALSE;
+		return 0;
+	}
+
+	return read_be64 (index->large_offsets + (gsize)offset * 8);
+}
+
+gboolean
+_ggit_pack_index_find (GgitPackIndex *index,
+                       const git_oid *oid,
+                       guint64       *offset)
+{
+	guint32 lo;
+	guint32 hi;
+
+	g_return_val_if_fail (index != NULL, FALSE);
+	g_return_val_if_fail (oid != NULL, FALSE);
+
+	lo = oid->id[0] == 0 ? 0 : read_be32 (index->fanout + (oid->id[0] - 1) * 4);
+	hi = read_be32 (index->fanout + oid->id[0] * 4);
+
+	/* do not trust a corrupt fan-out table to stay within the file */
+	hi = MIN (hi, index->n_objects);
+
+	while (lo < hi)
+	{
+		guint32 mid = lo + (hi - lo) / 2;
+		gint cmp;
+
+		cmp = memcmp (index->ids + (gsize)mid * index->stride, oid->id, GIT_OID_RAWSZ);
+
+		if (cmp == 0)
+		{
+			gboolean valid = TRUE;
+
+			*offset = get_offset (index, mid, &valid);
+			return valid;
+		}
+		else if (cmp < 0)
+		{
+			lo = mid + 1;
+		}
+		else
+		{
+			hi = mid;
+		}
+	}
+
+	return FALSE;
+}
+
+/* ex:set ts=8 noet: */
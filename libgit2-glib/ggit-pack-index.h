@@ -0,0 +1,50 @@
+/*
+ * ggit-pack-index.h
+ * This file is part of libgit2-glib
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GGIT_PACK_INDEX_H__
+#define __GGIT_PACK_INDEX_H__
+
+#include <glib.h>
+#include <git2.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GgitPackIndex GgitPackIndex;
+
+/* Returns %NULL without setting @error when the file does not exist, e.g.
+ * because the pack was removed by a concurrent repack.
+ */
+GgitPackIndex *_ggit_pack_index_open          (const gchar    *path,
+                                               GError        **error);
+void           _ggit_pack_index_free          (GgitPackIndex  *index);
+
+guint32        _ggit_pack_index_get_n_objects (GgitPackIndex  *index);
+
+/* The sorted raw ids, @stride bytes apart */
+const guint8  *_ggit_pack_index_get_ids       (GgitPackIndex  *index,
+                                               gsize          *stride);
+
+gboolean       _ggit_pack_index_find          (GgitPackIndex  *index,
+                                               const git_oid  *oid,
+                                               guint64        *offset);
+
+G_END_DECLS
+
+#endif /* __GGIT_PACK_INDEX_H__ */
+
+/* ex:set ts=8 noet: */
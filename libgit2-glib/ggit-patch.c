@@ -22,6 +22,8 @@
 #include "ggit-diff.h"
 #include "ggit-diff-delta.h"
 #include "ggit-diff-hunk.h"
+#include "ggit-diff-line.h"
+#include "ggit-convert.h"
 #include "ggit-error.h"
 #include "ggit-diff-options.h"
 
@@ -29,6 +31,12 @@ struct _GgitPatch
 {
 	git_patch *patch;
 	gint ref_count;
+
+	/* keeps the repository the patch was generated in alive */
+	GObject *owner;
+
+	/* interned, the encoding the lines are converted from */
+	const gchar *encoding;
 };
 
 G_DEFINE_BOXED_TYPE (GgitPatch, ggit_patch,
@@ -42,6 +50,26 @@ _ggit_patch_wrap (git_patch *patch)
 	gpatch = g_slice_new (GgitPatch);
 	gpatch->patch = patch;
 	gpatch->ref_count = 1;
+	gpatch->owner = NULL;
+	gpatch->encoding = NULL;
+
+	return gpatch;
+}
+
+GgitPatch *
+_ggit_patch_wrap_owned (git_patch   *patch,
+                        gpointer     owner,
+                        const gchar *encoding)
+{
+	GgitPatch *gpatch;
+
+	gpatch = _ggit_patch_wrap (patch);
+	gpatch->encoding = encoding;
+
+	if (owner != NULL)
+	{
+		gpatch->owner = g_object_ref (owner);
+	}
 
 	return gpatch;
 }
@@ -80,6 +108,12 @@ ggit_patch_unref (GgitPatch *patch)
 	if (g_atomic_int_dec_and_test (&patch->ref_count))
 	{
 		git_patch_free (patch->patch);
+
+		if (patch->owner != NULL)
+		{
+			g_object_unref (patch->owner);
+		}
+
 		g_slice_free (GgitPatch, patch);
 	}
 }
@@ -103,6 +137,7 @@ ggit_patch_new_from_diff (GgitDiff  *diff,
                           GError   **error)
 {
 	git_patch *patch;
+	GgitPatch *gpatch;
 	gint ret;
 
 	g_return_val_if_fail (GGIT_IS_DIFF (diff), NULL);
@@ -116,7 +151,13 @@ ggit_patch_new_from_diff (GgitDiff  *diff,
 		return NULL;
 	}
 
-	return _ggit_patch_wrap (patch);
+	gpatch = _ggit_patch_wrap (patch);
+	gpatch->encoding =
+		_ggit_diff_get_delta_encoding (diff,
+		                               git_diff_get_delta (_ggit_native_get (diff),
+		                                                   idx));
+
+	return gpatch;
 }
 
 /**
@@ -418,4 +459,112 @@ ggit_patch_get_hunk (GgitPatch  *patch,
 	return _ggit_diff_hunk_wrap (hunk);
 }
 
+/**
+ * ggit_patch_get_line_in_hunk:
+ * @patch: a #GgitPatch.
+ * @hunk: the hunk index.
+ * @line: the index of the line in @hunk.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Get the @line'th line of the @hunk'th hunk in the patch. The content of
+ * the returned line is not copied, it refers to the text of @patch which
+ * is kept alive for as long as the line is. Its text is converted from the
+ * same encoding as the lines handed out by ggit_diff_foreach().
+ *
+ * Returns: (transfer full) (nullable): a new #GgitDiffLine or %NULL on error.
+ */
+GgitDiffLine *
+ggit_patch_get_line_in_hunk (GgitPatch  *patch,
+                             gsize       hunk,
+                             gsize       line,
+                             GError    **error)
+{
+	const git_diff_line *diff_line;
+	gint ret;
+
+	g_return_val_if_fail (patch != NULL, NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	ret = git_patch_get_line_in_hunk (&diff_line, patch->patch, hunk, line);
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (error, ret);
+		return NULL;
+	}
+
+	return _ggit_diff_line_wrap_borrowed (diff_line,
+	                                      patch->encoding,
+	                                      ggit_patch_ref (patch),
+	                                      (GDestroyNotify)ggit_patch_unref);
+}
+
+/**
+ * ggit_patch_get_hunk_text:
+ * @patch: a #GgitPatch.
+ * @hunk: the hunk index.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Get the content of all the lines of the @hunk'th hunk in the patch as
+ * UTF-8 encoded text, as ggit_diff_line_get_text() would return for each
+ * of them. Converting a whole hunk at once is cheaper than converting its
+ * lines one by one.
+ *
+ * Returns: (transfer full) (array zero-terminated=1) (nullable): a %NULL
+ *          terminated array with the text of each line, or %NULL on error.
+ */
+gchar **
+ggit_patch_get_hunk_text (GgitPatch  *patch,
+                          gsize       hunk,
+                          GError    **error)
+{
+	const gchar **strs;
+	gssize *sizes;
+	gchar **text;
+	gint n_lines;
+	gint i;
+
+	g_return_val_if_fail (patch != NULL, NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	n_lines = git_patch_num_lines_in_hunk (patch->patch, hunk);
+
+	if (n_lines < 0)
+	{
+		_ggit_error_set (error, n_lines);
+		return NULL;
+	}
+
+	strs = g_new (const gchar *, n_lines);
+	sizes = g_new (gssize, n_lines);
+
+	for (i = 0; i < n_lines; ++i)
+	{
+		const git_diff_line *diff_line;
+		gint ret;
+
+		ret = git_patch_get_line_in_hunk (&diff_line, patch->patch, hunk, i);
+
+		if (ret != GIT_OK)
+		{
+			_ggit_error_set (error, ret);
+
+			g_free (strs);
+			g_free (sizes);
+			return NULL;
+		}
+
+		strs[i] = diff_line->content;
+		sizes[i] = diff_line->content_len;
+	}
+
+	text = g_new0 (gchar *, n_lines + 1);
+	ggit_convert_utf8_batch (strs, sizes, n_lines, patch->encoding, text);
+
+	g_free (strs);
+	g_free (sizes);
+
+	return text;
+}
+
 /* ex:set ts=8 noet: */
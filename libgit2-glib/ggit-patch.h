@@ -37,6 +37,10 @@ GType            ggit_patch_get_type        (void) G_GNUC_CONST;
 
 GgitPatch      *_ggit_patch_wrap            (git_patch      *patch);
 
+GgitPatch      *_ggit_patch_wrap_owned      (git_patch      *patch,
+                                             gpointer        owner,
+                                             const gchar    *encoding);
+
 GgitPatch       *ggit_patch_ref             (GgitPatch      *patch);
 
 void             ggit_patch_unref           (GgitPatch      *patch);
@@ -77,6 +81,15 @@ GgitDiffHunk    *ggit_patch_get_hunk         (GgitPatch     *patch,
                                               gsize          idx,
                                               GError       **error);
 
+GgitDiffLine    *ggit_patch_get_line_in_hunk (GgitPatch     *patch,
+                                              gsize          hunk,
+                                              gsize          line,
+                                              GError       **error);
+
+gchar          **ggit_patch_get_hunk_text    (GgitPatch     *patch,
+                                              gsize          hunk,
+                                              GError       **error);
+
 G_DEFINE_AUTOPTR_CLEANUP_FUNC (GgitPatch, ggit_patch_unref)
 
 G_END_DECLS
@@ -0,0 +1,585 @@
+/*
+ * ggit-prefix-index.c
+ * This file is part of libgit2-glib
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include <gio/gio.h>
+#include <glib/gstdio.h>
+
+#include "ggit-prefix-index.h"
+#include "ggit-pack-index.h"
+#include "ggit-oid.h"
+#include "ggit-utils.h"
+
+/* The sorted object ids of a repository, read directly from the pack
+ * indexes and the loose object directories, including those of the
+ * alternate object directories.
+ *
+ * The ids of the packs are read at once and read again when the pack
+ * directory of an object directory changes. The loose objects are read
+ * per fan-out directory, only when an id of that directory is looked up,
+ * so validating the index costs one stat of each pack directory plus one
+ * of the fan-out directory of the looked up id.
+ */
+typedef struct
+{
+	/* sorted, NULL until the fan-out directory is read */
+	GgitOIdArray *oids;
+
+	GArray *stamps;
+	gint64 built_at;
+} LooseFanout;
+
+struct _GgitPrefixIndex
+{
+	gchar *objects_dir;
+
+	/* the object directory followed by its alternates */
+	GPtrArray *dirs;
+	gint64 alternates_stamp;
+	gint64 dirs_built_at;
+
+	GgitOIdArray *packed;
+	GArray *pack_stamps;
+	gint64 packed_built_at;
+
+	LooseFanout loose[256];
+};
+
+GgitPrefixIndex *
+_ggit_prefix_index_new (const gchar *objects_dir)
+{
+	GgitPrefixIndex *index;
+
+	index = g_slice_new0 (GgitPrefixIndex);
+	index->objects_dir = g_strdup (objects_dir);
+
+	return index;
+}
+
+static void
+clear_loose (GgitPrefixIndex *index)
+{
+	gint i;
+
+	for (i = 0; i < 256; ++i)
+	{
+		LooseFanout *fanout = &index->loose[i];
+
+		g_clear_pointer (&fanout->oids, ggit_oid_array_unref);
+		g_clear_pointer (&fanout->stamps, g_array_unref);
+	}
+}
+
+void
+_ggit_prefix_index_free (GgitPrefixIndex *index)
+{
+	if (index == NULL)
+	{
+		return;
+	}
+
+	clear_loose (index);
+
+	g_clear_pointer (&index->packed, ggit_oid_array_unref);
+	g_clear_pointer (&index->pack_stamps, g_array_unref);
+	g_clear_pointer (&index->dirs, g_ptr_array_unref);
+
+	g_free (index->objects_dir);
+	g_slice_free (GgitPrefixIndex, index);
+}
+
+static gint64
+get_mtime (const gchar *path)
+{
+	GStatBuf buf;
+
+	if (g_stat (path, &buf) != 0)
+	{
+		return -1;
+	}
+
+	return buf.st_mtime;
+}
+
+static gint64
+now_in_seconds (void)
+{
+	return g_get_real_time () / G_USEC_PER_SEC;
+}
+
+/* Stats @name in each of the object directories */
+static GArray *
+get_stamps (GgitPrefixIndex *index,
+            const gchar     *name)
+{
+	GArray *stamps;
+	guint i;
+
+	stamps = g_array_sized_new (FALSE, FALSE, sizeof (gint64), index->dirs->len);
+
+	for (i = 0; i < index->dirs->len; ++i)
+	{
+		gchar *path;
+		gint64 mtime;
+
+		path = g_build_filename (g_ptr_array_index (index->dirs, i), name, NULL);
+		mtime = get_mtime (path);
+		g_array_append_val (stamps, mtime);
+		g_free (path);
+	}
+
+	return stamps;
+}
+
+static gboolean
+stamps_are_valid (GArray *old_stamps,
+                  gint64  built_at,
+                  GArray *stamps)
+{
+	guint i;
+
+	if (old_stamps == NULL || old_stamps->len != stamps->len)
+	{
+		return FALSE;
+	}
+
+	for (i = 0; i < stamps->len; ++i)
+	{
+		gint64 stamp = g_array_index (stamps, gint64, i);
+
+		/* a directory modified in the second the index was built in
+		 * might have changed after it was read
+		 */
+		if (stamp != g_array_index (old_stamps, gint64, i) ||
+		    stamp >= built_at)
+		{
+			return FALSE;
+		}
+	}
+
+	return TRUE;
+}
+
+static gboolean
+add_pack_index (GgitOIdArray  *oids,
+                const gchar   *path,
+                GError       **error)
+{
+	GgitPackIndex *index;
+	GError *err = NULL;
+	const guint8 *ids;
+	gsize stride;
+	guint32 n_objects;
+	guint32 i;
+
+	index = _ggit_pack_index_open (path, &err);
+
+	if (index == NULL)
+	{
+		/* the pack may have been removed by a concurrent repack */
+		if (err == NULL)
+		{
+			return TRUE;
+		}
+
+		g_propagate_error (error, err);
+		return FALSE;
+	}
+
+	ids = _ggit_pack_index_get_ids (index, &stride);
+	n_objects = _ggit_pack_index_get_n_objects (index);
+
+	if (stride == GIT_OID_RAWSZ)
+	{
+		ggit_oid_array_append_raw (oids, ids, n_objects);
+	}
+	else
+	{
+		for (i = 0; i < n_objects; ++i)
+		{
+			ggit_oid_array_append_raw (oids, ids + (gsize)i * stride, 1);
+		}
+	}
+
+	_ggit_pack_index_free (index);
+
+	return TRUE;
+}
+
+static gboolean
+add_pack_dir (GgitOIdArray  *oids,
+              const gchar   *dir,
+              GError       **error)
+{
+	GDir *d;
+	gchar *path;
+	const gchar *name;
+	gboolean ret = TRUE;
+
+	path = g_build_filename (dir, "pack", NULL);
+	d = g_dir_open (path, 0, NULL);
+
+	if (d == NULL)
+	{
+		g_free (path);
+		return TRUE;
+	}
+
+	while (ret && (name = g_dir_read_name (d)) != NULL)
+	{
+		gchar *filename;
+
+		if (!g_str_has_suffix (name, ".idx"))
+		{
+			continue;
+		}
+
+		filename = g_build_filename (path, name, NULL);
+		ret = add_pack_index (oids, filename, error);
+		g_free (filename);
+	}
+
+	g_dir_close (d);
+	g_free (path);
+
+	return ret;
+}
+
+static void
+add_loose_dir (GgitOIdArray *oids,
+               const gchar  *dir,
+               guint8        byte)
+{
+	GDir *d;
+	gchar *path;
+	const gchar *name;
+	gchar hex[GIT_OID_HEXSZ];
+
+	g_snprintf (hex, 3, "%02x", byte);
+
+	path = g_build_filename (dir, hex, NULL);
+	d = g_dir_open (path, 0, NULL);
+	g_free (path);
+
+	if (d == NULL)
+	{
+		return;
+	}
+
+	while ((name = g_dir_read_name (d)) != NULL)
+	{
+		git_oid oid;
+
+		if (strlen (name) != GIT_OID_HEXSZ - 2)
+		{
+			continue;
+		}
+
+		memcpy (hex + 2, name, GIT_OID_HEXSZ - 2);
+
+		if (_ggit_oid_parse_hex (hex, oid.id))
+		{
+			_ggit_oid_array_append_oid (oids, &oid);
+		}
+	}
+
+	g_dir_close (d);
+}
+
+static void
+refresh_dirs (GgitPrefixIndex *index)
+{
+	gchar *path;
+	gint64 stamp;
+
+	path = g_build_filename (index->objects_dir, "info", "alternates", NULL);
+	stamp = get_mtime (path);
+	g_free (path);
+
+	if (index->dirs != NULL &&
+	    stamp == index->alternates_stamp &&
+	    stamp < index->dirs_built_at)
+	{
+		return;
+	}
+
+	/* everything depends on the list of object directories */
+	clear_loose (index);
+	g_clear_pointer (&index->packed, ggit_oid_array_unref);
+	g_clear_pointer (&index->pack_stamps, g_array_unref);
+	g_clear_pointer (&index->dirs, g_ptr_array_unref);
+
+	index->dirs_built_at = now_in_seconds ();
+	index->dirs = ggit_utils_get_object_dirs (index->objects_dir);
+	index->alternates_stamp = stamp;
+}
+
+gboolean
+_ggit_prefix_index_refresh (GgitPrefixIndex  *index,
+                            GError          **error)
+{
+	GArray *stamps;
+	GgitOIdArray *oids;
+	gint64 now;
+	guint i;
+
+	g_return_val_if_fail (index != NULL, FALSE);
+
+	refresh_dirs (index);
+
+	stamps = get_stamps (index, "pack");
+
+	if (index->packed != NULL &&
+	    stamps_are_valid (index->pack_stamps, index->packed_built_at, stamps))
+	{
+		g_array_unref (stamps);
+		return TRUE;
+	}
+
+	now = now_in_seconds ();
+	oids = ggit_oid_array_new (0);
+
+	for (i = 0; i < index->dirs->len; ++i)
+	{
+		if (!add_pack_dir (oids, g_ptr_array_index (index->dirs, i), error))
+		{
+			ggit_oid_array_unref (oids);
+			g_array_unref (stamps);
+
+			return FALSE;
+		}
+	}
+
+	ggit_oid_array_sort (oids);
+	_ggit_oid_array_unique (oids);
+
+	g_clear_pointer (&index->packed, ggit_oid_array_unref);
+	g_clear_pointer (&index->pack_stamps, g_array_unref);
+
+	index->packed = oids;
+	index->pack_stamps = stamps;
+	index->packed_built_at = now;
+
+	return TRUE;
+}
+
+/* Gets the sorted loose ids starting with @byte, reading the fan-out
+ * directory again if it changed.
+ */
+static GgitOIdArray *
+get_loose (GgitPrefixIndex *index,
+           guint8           byte)
+{
+	LooseFanout *fanout = &index->loose[byte];
+	GArray *stamps;
+	GgitOIdArray *oids;
+	gchar name[3];
+	gint64 now;
+	guint i;
+
+	g_snprintf (name, sizeof (name), "%02x", byte);
+	stamps = get_stamps (index, name);
+
+	if (fanout->oids != NULL &&
+	    stamps_are_valid (fanout->stamps, fanout->built_at, stamps))
+	{
+		g_array_unref (stamps);
+		return fanout->oids;
+	}
+
+	now = now_in_seconds ();
+	oids = ggit_oid_array_new (0);
+
+	for (i = 0; i < index->dirs->len; ++i)
+	{
+		add_loose_dir (oids, g_ptr_array_index (index->dirs, i), byte);
+	}
+
+	ggit_oid_array_sort (oids);
+	_ggit_oid_array_unique (oids);
+
+	g_clear_pointer (&fanout->oids, ggit_oid_array_unref);
+	g_clear_pointer (&fanout->stamps, g_array_unref);
+
+	fanout->oids = oids;
+	fanout->stamps = stamps;
+	fanout->built_at = now;
+
+	return oids;
+}
+
+static guint
+common_prefix_length (const guint8 *a,
+                      const guint8 *b)
+{
+	guint i;
+
+	for (i = 0; i < GIT_OID_RAWSZ; ++i)
+	{
+		if (a[i] != b[i])
+		{
+			return i * 2 + ((a[i] & 0xf0) == (b[i] & 0xf0) ? 1 : 0);
+		}
+	}
+
+	return GIT_OID_HEXSZ;
+}
+
+/* The longest prefix @oid shares with another id of the sorted @oids */
+static guint
+neighbour_prefix_length (GgitOIdArray  *oids,
+                         const git_oid *oid)
+{
+	gsize size;
+	gsize pos;
+	guint common = 0;
+
+	size = ggit_oid_array_get_size (oids);
+	pos = _ggit_oid_array_lower_bound (oids, oid->id);
+
+	/* only the neighbours in sorted order can share a longer prefix */
+	if (pos > 0)
+	{
+		common = common_prefix_length (oid->id,
+		                               _ggit_oid_array_get_oid (oids, pos - 1)->id);
+	}
+
+	if (pos < size && git_oid_equal (oid, _ggit_oid_array_get_oid (oids, pos)))
+	{
+		pos++;
+	}
+
+	if (pos < size)
+	{
+		common = MAX (common,
+		              common_prefix_length (oid->id,
+		                                    _ggit_oid_array_get_oid (oids, pos)->id));
+	}
+
+	return common;
+}
+
+guint
+_ggit_prefix_index_get_unique_length (GgitPrefixIndex *index,
+                                      const git_oid   *oid,
+                                      guint            min_length)
+{
+	guint common;
+
+	g_return_val_if_fail (index != NULL && index->packed != NULL, GIT_OID_HEXSZ);
+
+	common = MAX (neighbour_prefix_length (index->packed, oid),
+	              neighbour_prefix_length (get_loose (index, oid->id[0]), oid));
+
+	/* the loose objects of the other fan-out directories are not read,
+	 * they can share the first hex digit, but not the first two
+	 */
+	common = MAX (common, 1);
+
+	return CLAMP (common + 1, min_length, GIT_OID_HEXSZ);
+}
+
+GgitOIdArray *
+_ggit_prefix_index_find (GgitPrefixIndex *index,
+                         const gchar     *prefix)
+{
+	GgitOIdArray *ret;
+	GgitOIdArray *loose;
+	GArray *packed_matches;
+	guint8 raw[GIT_OID_RAWSZ];
+	gsize length;
+	guint first;
+	guint last;
+	guint i;
+	guint j;
+
+	g_return_val_if_fail (index != NULL && index->packed != NULL, NULL);
+
+	ret = ggit_oid_array_new (0);
+
+	if (!_ggit_oid_parse_prefix (prefix, raw, &length))
+	{
+		return ret;
+	}
+
+	/* the fan-out directories the prefix can be in */
+	first = length >= 1 ? raw[0] : 0;
+	last = length >= 2 ? raw[0] : (length == 1 ? raw[0] | 0x0f : 0xff);
+
+	packed_matches = ggit_oid_array_find_prefix (index->packed, prefix);
+	j = 0;
+
+	/* merge the packed and loose matches, which are both sorted, so that
+	 * the result stays sorted
+	 */
+	for (i = first; i <= last; ++i)
+	{
+		GArray *loose_matches;
+		guint k;
+
+		loose = get_loose (index, i);
+		loose_matches = ggit_oid_array_find_prefix (loose, prefix);
+
+		for (k = 0; k < loose_matches->len; ++k)
+		{
+			const git_oid *oid;
+
+			oid = _ggit_oid_array_get_oid (loose, g_array_index (loose_matches, gsize, k));
+
+			while (j < packed_matches->len)
+			{
+				const git_oid *packed_oid;
+				gint cmp;
+
+				packed_oid = _ggit_oid_array_get_oid (index->packed,
+				                                      g_array_index (packed_matches, gsize, j));
+				cmp = git_oid_cmp (packed_oid, oid);
+
+				if (cmp > 0)
+				{
+					break;
+				}
+
+				/* objects both packed and loose are listed once */
+				if (cmp < 0)
+				{
+					_ggit_oid_array_append_oid (ret, packed_oid);
+				}
+
+				j++;
+			}
+
+			_ggit_oid_array_append_oid (ret, oid);
+		}
+
+		g_array_unref (loose_matches);
+	}
+
+	for (; j < packed_matches->len; ++j)
+	{
+		_ggit_oid_array_append_oid (ret,
+		                            _ggit_oid_array_get_oid (index->packed,
+		                                                     g_array_index (packed_matches, gsize, j)));
+	}
+
+	g_array_unref (packed_matches);
+
+	return ret;
+}
+
+/* ex:set ts=8 noet: */
@@ -0,0 +1,48 @@
+/*
+ * ggit-prefix-index.h
+ * This file is part of libgit2-glib
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GGIT_PREFIX_INDEX_H__
+#define __GGIT_PREFIX_INDEX_H__
+
+#include <glib-object.h>
+#include <git2.h>
+
+#include "ggit-oid-array.h"
+
+G_BEGIN_DECLS
+
+typedef struct _GgitPrefixIndex GgitPrefixIndex;
+
+GgitPrefixIndex *_ggit_prefix_index_new               (const gchar      *objects_dir);
+void             _ggit_prefix_index_free              (GgitPrefixIndex  *index);
+
+gboolean         _ggit_prefix_index_refresh           (GgitPrefixIndex  *index,
+                                                       GError          **error);
+
+guint            _ggit_prefix_index_get_unique_length (GgitPrefixIndex  *index,
+                                                       const git_oid    *oid,
+                                                       guint             min_length);
+
+GgitOIdArray    *_ggit_prefix_index_find              (GgitPrefixIndex  *index,
+                                                       const gchar      *prefix);
+
+G_END_DECLS
+
+#endif /* __GGIT_PREFIX_INDEX_H__ */
+
+/* ex:set ts=8 noet: */
@@ -18,12 +18,22 @@
  * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <stdlib.h>
+#include <string.h>
 #include <gio/gio.h>
+#include <glib/gstdio.h>
 #include <git2.h>
 #include <git2/sys/commit.h>
+#if LIBGIT2_VER_MAJOR > 1 || (LIBGIT2_VER_MAJOR == 1 && LIBGIT2_VER_MINOR >= 2)
+#include <git2/sys/commit_graph.h>
+#endif
 
 #include "ggit-error.h"
 #include "ggit-oid.h"
+#include "ggit-object-stream.h"
+#include "ggit-odb.h"
+#include "ggit-oid-array.h"
+#include "ggit-prefix-index.h"
 #include "ggit-ref.h"
 #include "ggit-repository.h"
 #include "ggit-utils.h"
@@ -45,6 +55,7 @@
 #include "ggit-rebase-options.h"
 #include "ggit-blob.h"
 #include "ggit-tag.h"
+#include "ggit-untracked-cache.h"
 
 
 typedef struct _GgitRepositoryPrivate
@@ -55,6 +66,18 @@ typedef struct _GgitRepositoryPrivate
 
 	GgitCloneOptions *clone_options;
 
+	/* cached attribute lookups, see _ggit_repository_get_attribute_cached */
+	GMutex attribute_lock;
+	GHashTable *attribute_cache;
+	GHashTable *attribute_files;
+	GHashTable *attribute_values;
+	guint attribute_batches;
+
+	/* sorted object ids, see ggit_repository_shorten_oids */
+	GMutex prefix_index_lock;
+	GgitPrefixIndex *prefix_index;
+	gint n_default_odb_backends;
+
 	guint is_bare : 1;
 	guint init : 1;
 } GgitRepositoryPrivate;
@@ -72,13 +95,20 @@ enum
 };
 
 static void ggit_repository_initable_iface_init (GInitableIface  *iface);
+static void ggit_repository_async_initable_iface_init (GAsyncInitableIface  *iface);
 
 G_DEFINE_TYPE_EXTENDED (GgitRepository, ggit_repository, GGIT_TYPE_NATIVE,
                         0,
                         G_ADD_PRIVATE (GgitRepository)
                         G_IMPLEMENT_INTERFACE (G_TYPE_INITABLE,
-                                               ggit_repository_initable_iface_init))
+                                               ggit_repository_initable_iface_init)
+                        G_IMPLEMENT_INTERFACE (G_TYPE_ASYNC_INITABLE,
+                                               ggit_repository_async_initable_iface_init))
 
+/* Repositories may be created and destroyed from worker threads, so all
+ * access to the registry must happen with the registry lock held.
+ */
+G_LOCK_DEFINE_STATIC (registry);
 static GHashTable *registry = NULL;
 
 static GgitRepository *
@@ -121,6 +151,130 @@ unregister_repository (git_repository *repository)
 	}
 }
 
+typedef struct
+{
+	GCancellable *cancellable;
+
+	git_checkout_notify_cb notify_cb;
+	gpointer notify_payload;
+	guint notify_flags;
+
+	git_transfer_progress_cb transfer_progress;
+	gpointer transfer_progress_payload;
+} CancellableCallbacks;
+
+static gint
+cancellable_checkout_notify (git_checkout_notify_t  why,
+                             const gchar           *path,
+                             const git_diff_file   *baseline,
+                             const git_diff_file   *target,
+                             const git_diff_file   *workdir,
+                             gpointer               payload)
+{
+	CancellableCallbacks *callbacks = payload;
+
+	if (g_cancellable_is_cancelled (callbacks->cancellable))
+	{
+		return GIT_EUSER;
+	}
+
+	if (callbacks->notify_cb != NULL && (callbacks->notify_flags & why) != 0)
+	{
+		return callbacks->notify_cb (why,
+		                             path,
+		                             baseline,
+		                             target,
+		                             workdir,
+		                             callbacks->notify_payload);
+	}
+
+	return GIT_OK;
+}
+
+static gint
+cancellable_transfer_progress (const git_transfer_progress *stats,
+                               gpointer                     payload)
+{
+	CancellableCallbacks *callbacks = payload;
+
+	if (g_cancellable_is_cancelled (callbacks->cancellable))
+	{
+		return GIT_EUSER;
+	}
+
+	if (callbacks->transfer_progress != NULL)
+	{
+		return callbacks->transfer_progress (stats,
+		                                     callbacks->transfer_progress_payload);
+	}
+
+	return GIT_OK;
+}
+
+/* Chain the checkout notify callback so that libgit2 aborts the checkout
+ * when @cancellable is triggered while it works out which files to update.
+ * The previous callback keeps being called for the events it originally
+ * asked for.
+ */
+static void
+cancellable_callbacks_wrap_checkout (CancellableCallbacks *callbacks,
+                                     git_checkout_options *options)
+{
+	if (callbacks->cancellable == NULL)
+	{
+		return;
+	}
+
+	callbacks->notify_cb = options->notify_cb;
+	callbacks->notify_payload = options->notify_payload;
+	callbacks->notify_flags = options->notify_flags;
+
+	/* libgit2 notifies about every file it is going to update, which is
+	 * enough to poll for cancellation. Asking for all notifications would
+	 * also report every untracked and ignored file in the working tree.
+	 */
+	options->notify_cb = cancellable_checkout_notify;
+	options->notify_payload = callbacks;
+	options->notify_flags |= GIT_CHECKOUT_NOTIFY_UPDATED;
+}
+
+static void
+cancellable_callbacks_wrap_clone (CancellableCallbacks *callbacks,
+                                  git_clone_options    *options)
+{
+	if (callbacks->cancellable == NULL)
+	{
+		return;
+	}
+
+	/* The remote callbacks payload is shared by all the remote callbacks,
+	 * so we can only hook into the transfer progress when the caller
+	 * did not install any #GgitRemoteCallbacks of its own.
+	 */
+	if (options->fetch_opts.callbacks.payload == NULL)
+	{
+		callbacks->transfer_progress = options->fetch_opts.callbacks.transfer_progress;
+		callbacks->transfer_progress_payload = NULL;
+
+		options->fetch_opts.callbacks.transfer_progress = cancellable_transfer_progress;
+		options->fetch_opts.callbacks.payload = callbacks;
+	}
+
+	cancellable_callbacks_wrap_checkout (callbacks, &options->checkout_opts);
+}
+
+static void
+set_error_cancellable (GError       **error,
+                       gint           err,
+                       GCancellable  *cancellable)
+{
+	/* Report a cancelled operation as such instead of as a GIT_EUSER */
+	if (!g_cancellable_set_error_if_cancelled (cancellable, error))
+	{
+		_ggit_error_set (error, err);
+	}
+}
+
 /**
  * ggit_repository_path_is_ignored:
  * @repository: A #GgitRepository.
@@ -174,9 +328,24 @@ ggit_repository_finalize (GObject *object)
 
 	if (repo != NULL)
 	{
+		G_LOCK (registry);
 		unregister_repository (repo);
+		G_UNLOCK (registry);
+	}
+
+
+	if (priv->attribute_cache != NULL)
+	{
+		g_hash_table_destroy (priv->attribute_cache);
+		g_hash_table_destroy (priv->attribute_files);
+		g_hash_table_destroy (priv->attribute_values);
 	}
 
+	g_mutex_clear (&priv->attribute_lock);
+
+	_ggit_prefix_index_free (priv->prefix_index);
+	g_mutex_clear (&priv->prefix_index_lock);
+
 	G_OBJECT_CLASS (ggit_repository_parent_class)->finalize (object);
 }
 
@@ -384,6 +553,12 @@ ggit_repository_class_init (GgitRepositoryClass *klass)
 static void
 ggit_repository_init (GgitRepository *repository)
 {
+	GgitRepositoryPrivate *priv;
+
+	priv = ggit_repository_get_instance_private (repository);
+
+	g_mutex_init (&priv->attribute_lock);
+	g_mutex_init (&priv->prefix_index_lock);
 }
 
 static gboolean
@@ -398,10 +573,8 @@ ggit_repository_initable_init (GInitable    *initable,
 	gchar *path = NULL;
 	git_repository *repo = NULL;
 
-	if (cancellable != NULL)
+	if (g_cancellable_set_error_if_cancelled (cancellable, error))
 	{
-		g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
-		                     "Cancellable initialization not supported");
 		return FALSE;
 	}
 
@@ -424,10 +597,20 @@ ggit_repository_initable_init (GInitable    *initable,
 	}
 	else if (priv->url != NULL)
 	{
+		git_clone_options options = GIT_CLONE_OPTIONS_INIT;
+		CancellableCallbacks callbacks = { cancellable, };
+
+		if (priv->clone_options != NULL)
+		{
+			options = *_ggit_clone_options_get_native (priv->clone_options);
+		}
+
+		cancellable_callbacks_wrap_clone (&callbacks, &options);
+
 		err = git_clone (&repo,
 		                 priv->url,
 		                 path,
-		                 _ggit_clone_options_get_native (priv->clone_options));
+		                 &options);
 	}
 	else
 	{
@@ -439,7 +622,7 @@ ggit_repository_initable_init (GInitable    *initable,
 
 	if (err != GIT_OK)
 	{
-		_ggit_error_set (error, err);
+		set_error_cancellable (error, err, cancellable);
 
 		success = FALSE;
 	}
@@ -474,6 +657,14 @@ ggit_repository_initable_iface_init (GInitableIface *iface)
 	iface->init = ggit_repository_initable_init;
 }
 
+static void
+ggit_repository_async_initable_iface_init (GAsyncInitableIface *iface)
+{
+	/* The default implementation runs ggit_repository_initable_init
+	 * on a worker thread, which is exactly what we want.
+	 */
+}
+
 GgitRepository *
 _ggit_repository_wrap (git_repository *repository,
                        gboolean        owned)
@@ -481,11 +672,15 @@ _ggit_repository_wrap (git_repository *repository,
 	GgitRepository *ret;
 	GgitRepositoryPrivate *priv;
 
+	G_LOCK (registry);
 	ret = repository_from_registry (repository);
 
 	if (ret != NULL)
 	{
-		return g_object_ref (ret);
+		g_object_ref (ret);
+		G_UNLOCK (registry);
+
+		return ret;
 	}
 
 	ret = g_object_new (GGIT_TYPE_REPOSITORY,
@@ -507,6 +702,8 @@ _ggit_repository_wrap (git_repository *repository,
 		register_repository (repository, ret);
 	}
 
+	G_UNLOCK (registry);
+
 	return ret;
 }
 
@@ -518,6 +715,122 @@ _ggit_repository_get_repository (GgitRepository *repository)
 	return _ggit_native_get (repository);
 }
 
+/*
+ * _ggit_repository_open_worker:
+ * @repository: a #GgitRepository.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Opens a new handle on @repository, with the same working directory, for
+ * use on a worker thread while @repository stays usable on the caller's
+ * thread.
+ *
+ * Returns: (transfer full) (nullable): a new #GgitRepository.
+ */
+GgitRepository *
+_ggit_repository_open_worker (GgitRepository  *repository,
+                              GError         **error)
+{
+	git_repository *native;
+	git_repository *repo;
+	const gchar *workdir;
+	gint ret;
+
+	native = _ggit_native_get (repository);
+
+	ret = git_repository_open (&repo, git_repository_path (native));
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (error, ret);
+		return NULL;
+	}
+
+	workdir = git_repository_workdir (native);
+
+	if (workdir != NULL && g_strcmp0 (workdir, git_repository_workdir (repo)) != 0)
+	{
+		git_repository_set_workdir (repo, workdir, FALSE);
+	}
+
+	return _ggit_repository_wrap (repo, TRUE);
+}
+
+/* Whether the object database of @repository has backends that a handle
+ * opened from disk, such as @worker, does not have.
+ */
+static gboolean
+has_extra_odb_backends (GgitRepository *repository,
+                        GgitRepository *worker)
+{
+	git_odb *odb;
+	git_odb *worker_odb;
+	gboolean ret = FALSE;
+
+	if (git_repository_odb (&odb, _ggit_native_get (repository)) != GIT_OK)
+	{
+		return FALSE;
+	}
+
+	if (git_repository_odb (&worker_odb, _ggit_native_get (worker)) == GIT_OK)
+	{
+		ret = git_odb_num_backends (odb) > git_odb_num_backends (worker_odb);
+		git_odb_free (worker_odb);
+	}
+
+	git_odb_free (odb);
+
+	return ret;
+}
+
+/*
+ * _ggit_repository_open_workers:
+ * @repository: a #GgitRepository.
+ * @n_workers: the number of handles to open.
+ *
+ * Opens up to @n_workers new handles on @repository, for worker threads.
+ * libgit2 objects such as the attribute and diff driver caches of a
+ * repository are not thread safe, so each worker needs its own. Workers
+ * pop a handle from the returned queue and push it back when done.
+ *
+ * The handles are opened from disk and would not see the objects of
+ * backends added to the object database of @repository, such as a
+ * #GgitMempack, so no handles are opened in that case and the callers do
+ * the work on the calling thread instead.
+ *
+ * Returns: (transfer full): a queue of #GgitRepository, which may be empty.
+ */
+GAsyncQueue *
+_ggit_repository_open_workers (GgitRepository *repository,
+                               gint            n_workers)
+{
+	GAsyncQueue *repositories;
+	gint i;
+
+	repositories = g_async_queue_new_full (g_object_unref);
+
+	for (i = 0; i < n_workers; ++i)
+	{
+		GgitRepository *worker;
+
+		worker = _ggit_repository_open_worker (repository, NULL);
+
+		if (worker == NULL)
+		{
+			break;
+		}
+
+		if (i == 0 && has_extra_odb_backends (repository, worker))
+		{
+			g_object_unref (worker);
+			break;
+		}
+
+		g_async_queue_push (repositories, worker);
+	}
+
+	return repositories;
+}
+
 /**
  * ggit_repository_open:
  * @location: the location of the repository.
@@ -554,6 +867,74 @@ ggit_repository_open (GFile   *location,
 	                       NULL);
 }
 
+/**
+ * ggit_repository_open_async:
+ * @location: the location of the repository.
+ * @cancellable: (allow-none): a #GCancellable or %NULL.
+ * @callback: (scope async): a #GAsyncReadyCallback to call when the
+ *            repository has been opened.
+ * @user_data: (closure): the data to pass to @callback.
+ *
+ * Asynchronously open a git repository. See ggit_repository_open() for
+ * the synchronous version of this call.
+ *
+ * When the operation is finished, @callback will be called in the
+ * thread-default main context of the calling thread. You can then call
+ * ggit_repository_open_finish() to get the result of the operation.
+ */
+void
+ggit_repository_open_async (GFile               *location,
+                            GCancellable        *cancellable,
+                            GAsyncReadyCallback  callback,
+                            gpointer             user_data)
+{
+	g_return_if_fail (G_IS_FILE (location));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+	g_async_initable_new_async (GGIT_TYPE_REPOSITORY,
+	                            G_PRIORITY_DEFAULT,
+	                            cancellable,
+	                            callback,
+	                            user_data,
+	                            "location", location,
+	                            NULL);
+}
+
+static GgitRepository *
+repository_new_finish (GAsyncResult  *result,
+                       GError       **error)
+{
+	GObject *source;
+	GObject *ret;
+
+	source = g_async_result_get_source_object (result);
+	ret = g_async_initable_new_finish (G_ASYNC_INITABLE (source),
+	                                   result,
+	                                   error);
+	g_object_unref (source);
+
+	return ret != NULL ? GGIT_REPOSITORY (ret) : NULL;
+}
+
+/**
+ * ggit_repository_open_finish:
+ * @result: a #GAsyncResult.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Finishes an operation started with ggit_repository_open_async().
+ *
+ * Returns: (transfer full) (nullable): a newly created #GgitRepository.
+ */
+GgitRepository *
+ggit_repository_open_finish (GAsyncResult  *result,
+                             GError       **error)
+{
+	g_return_val_if_fail (G_IS_ASYNC_RESULT (result), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	return repository_new_finish (result, error);
+}
+
 /**
  * ggit_repository_init_repository:
  * @location: the location of the repository.
@@ -581,6 +962,60 @@ ggit_repository_init_repository (GFile     *location,
 	                       NULL);
 }
 
+/**
+ * ggit_repository_init_repository_async:
+ * @location: the location of the repository.
+ * @is_bare: if %TRUE, a git repository without a working directory is created
+ *           at the pointed path. If %FALSE, provided path will be considered as the working
+ *           directory into which the .git directory will be created.
+ * @cancellable: (allow-none): a #GCancellable or %NULL.
+ * @callback: (scope async): a #GAsyncReadyCallback to call when the
+ *            repository has been created.
+ * @user_data: (closure): the data to pass to @callback.
+ *
+ * Asynchronously creates a new git repository in the given folder. See
+ * ggit_repository_init_repository() for the synchronous version of this call.
+ */
+void
+ggit_repository_init_repository_async (GFile               *location,
+                                       gboolean             is_bare,
+                                       GCancellable        *cancellable,
+                                       GAsyncReadyCallback  callback,
+                                       gpointer             user_data)
+{
+	g_return_if_fail (G_IS_FILE (location));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+	g_async_initable_new_async (GGIT_TYPE_REPOSITORY,
+	                            G_PRIORITY_DEFAULT,
+	                            cancellable,
+	                            callback,
+	                            user_data,
+	                            "location", location,
+	                            "is-bare", is_bare,
+	                            "init", TRUE,
+	                            NULL);
+}
+
+/**
+ * ggit_repository_init_repository_finish:
+ * @result: a #GAsyncResult.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Finishes an operation started with ggit_repository_init_repository_async().
+ *
+ * Returns: (transfer full) (nullable): a newly created #GgitRepository.
+ */
+GgitRepository *
+ggit_repository_init_repository_finish (GAsyncResult  *result,
+                                        GError       **error)
+{
+	g_return_val_if_fail (G_IS_ASYNC_RESULT (result), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	return repository_new_finish (result, error);
+}
+
 /**
  * ggit_repository_clone:
  * @url: url to fetch the repository from.
@@ -609,6 +1044,67 @@ ggit_repository_clone (const gchar       *url,
 	                       NULL);
 }
 
+/**
+ * ggit_repository_clone_async:
+ * @url: url to fetch the repository from.
+ * @location: the location of the repository.
+ * @options: (allow-none): a #GgitCloneOptions.
+ * @cancellable: (allow-none): a #GCancellable or %NULL.
+ * @callback: (scope async): a #GAsyncReadyCallback to call when the
+ *            repository has been cloned.
+ * @user_data: (closure): the data to pass to @callback.
+ *
+ * Asynchronously clones a new git repository in the given folder. See
+ * ggit_repository_clone() for the synchronous version of this call.
+ *
+ * Cancelling @cancellable aborts the transfer and the checkout of the
+ * working directory as soon as libgit2 reports progress for them. Note
+ * that the remote callbacks of @options will be invoked from a worker
+ * thread.
+ */
+void
+ggit_repository_clone_async (const gchar         *url,
+                             GFile               *location,
+                             GgitCloneOptions    *options,
+                             GCancellable        *cancellable,
+                             GAsyncReadyCallback  callback,
+                             gpointer             user_data)
+{
+	g_return_if_fail (url != NULL);
+	g_return_if_fail (G_IS_FILE (location));
+	g_return_if_fail (options == NULL || GGIT_IS_CLONE_OPTIONS (options));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+	g_async_initable_new_async (GGIT_TYPE_REPOSITORY,
+	                            G_PRIORITY_DEFAULT,
+	                            cancellable,
+	                            callback,
+	                            user_data,
+	                            "url", url,
+	                            "location", location,
+	                            "clone-options", options,
+	                            NULL);
+}
+
+/**
+ * ggit_repository_clone_finish:
+ * @result: a #GAsyncResult.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Finishes an operation started with ggit_repository_clone_async().
+ *
+ * Returns: (transfer full) (nullable): a newly created #GgitRepository.
+ */
+GgitRepository *
+ggit_repository_clone_finish (GAsyncResult  *result,
+                              GError       **error)
+{
+	g_return_val_if_fail (G_IS_ASYNC_RESULT (result), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	return repository_new_finish (result, error);
+}
+
 /**
  * ggit_repository_lookup:
  * @repository: a #GgitRepository.
@@ -661,754 +1157,976 @@ ggit_repository_lookup (GgitRepository  *repository,
 	return object;
 }
 
+typedef struct
+{
+	const git_oid *id;
+	gsize idx;
+} LookupManyEntry;
+
+static gint
+compare_lookup_many_entry (gconstpointer a,
+                           gconstpointer b)
+{
+	return git_oid_cmp (((const LookupManyEntry *)a)->id,
+	                    ((const LookupManyEntry *)b)->id);
+}
+
+/* Loading in id order keeps the lookups in the pack indexes close
+ * together and makes repeated ids hit the object cache.
+ */
+static LookupManyEntry *
+lookup_many_sort (GgitOId **oids,
+                  gsize     n_oids)
+{
+	LookupManyEntry *order;
+	gsize i;
+
+	order = g_new (LookupManyEntry, n_oids);
+
+	for (i = 0; i < n_oids; ++i)
+	{
+		order[i].id = _ggit_oid_get_oid (oids[i]);
+		order[i].idx = i;
+	}
+
+	qsort (order,
+	       n_oids,
+	       sizeof (LookupManyEntry),
+	       compare_lookup_many_entry);
+
+	return order;
+}
+
 /**
- * ggit_repository_revparse:
+ * ggit_repository_lookup_many:
  * @repository: a #GgitRepository.
- * @spec: the revision specification.
+ * @oids: (array length=n_oids): the ids of the objects to look up.
+ * @n_oids: the number of ids in @oids.
+ * @gtype: a #GType.
  * @error: a #GError for error reporting, or %NULL.
  *
- * Find an object, as specified by a revision string. See `man gitrevisions`,
- * or the documentation for `git rev-parse` for information on the syntax
- * accepted.
+ * Lookups all the objects in @oids at once. This is equivalent to calling
+ * ggit_repository_lookup() for every id, but the objects are loaded in id
+ * order. The objects belong to @repository, so they are all loaded on the
+ * calling thread; use ggit_repository_read_many() to read the raw content
+ * of many objects on several threads.
  *
- * Returns: (transfer full) (nullable): a #GgitObject or %NULL if the revision could not be found.
+ * The @gtype must match the type of all the objects in the odb, or be
+ * %G_TYPE_NONE to let the method guess the type of each object. The
+ * lookup fails if any of the objects can not be found, in which case none
+ * of the objects are returned.
  *
- **/
-GgitObject *
-ggit_repository_revparse (GgitRepository  *repository,
-                          const gchar     *spec,
-                          GError         **error)
+ * Returns: (transfer full) (element-type GgitObject) (nullable): the found
+ * objects, in the same order as @oids, or %NULL on error.
+ */
+GPtrArray *
+ggit_repository_lookup_many (GgitRepository  *repository,
+                             GgitOId        **oids,
+                             gsize            n_oids,
+                             GType            gtype,
+                             GError         **error)
 {
-	GgitObject *object = NULL;
-	git_object *obj = NULL;
-	gint ret;
-
-	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
-	g_return_val_if_fail (spec != NULL, NULL);
+	LookupManyEntry *order;
+	git_repository *repo;
+	git_object **results;
+	GPtrArray *objects = NULL;
+	git_otype otype;
+	gint ret = GIT_OK;
+	gsize i;
 
-	ret = git_revparse_single (&obj, _ggit_native_get (repository), spec);
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
+	g_return_val_if_fail (oids != NULL || n_oids == 0, NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
-	if (ret == GIT_OK)
-	{
-		object = ggit_utils_create_real_object (obj, TRUE);
-	}
-	else
+	if (n_oids == 0)
 	{
-		_ggit_error_set (error, ret);
+		return g_ptr_array_new_with_free_func (g_object_unref);
 	}
 
-	return object;
-}
-
-/**
- * ggit_repository_lookup_reference:
- * @repository: a #GgitRepository.
- * @name: the long name for the reference (e.g. HEAD, ref/heads/master, refs/tags/v0.1.0, ...).
- * @error: a #GError for error reporting, or %NULL.
- *
- * Lookups a reference by its name in @repository. The returned #GgitRef must
- * be freed with g_object_unref().
- *
- * Returns: (transfer full) (nullable): the searched reference.
- */
-GgitRef *
-ggit_repository_lookup_reference (GgitRepository  *repository,
-                                  const gchar     *name,
-                                  GError         **error)
-{
-	GgitRef *ref = NULL;
-	git_reference *reference;
-	gint ret;
+	repo = _ggit_native_get (repository);
+	otype = ggit_utils_get_otype_from_gtype (gtype);
 
-	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
-	g_return_val_if_fail (name != NULL, NULL);
+	order = lookup_many_sort (oids, n_oids);
+	results = g_new0 (git_object *, n_oids);
 
-	ret = git_reference_lookup (&reference, _ggit_native_get (repository),
-	                            name);
+	for (i = 0; i < n_oids && ret == GIT_OK; ++i)
+	{
+		ret = git_object_lookup (&results[order[i].idx],
+		                         repo,
+		                         order[i].id,
+		                         otype);
+	}
 
 	if (ret == GIT_OK)
 	{
-		ref = _ggit_ref_wrap (reference, FALSE);
+		objects = g_ptr_array_new_full (n_oids, g_object_unref);
+
+		for (i = 0; i < n_oids; ++i)
+		{
+			g_ptr_array_add (objects,
+			                 ggit_utils_create_real_object (results[i], TRUE));
+		}
 	}
 	else
 	{
 		_ggit_error_set (error, ret);
+
+		for (i = 0; i < n_oids; ++i)
+		{
+			if (results[i] != NULL)
+			{
+				git_object_free (results[i]);
+			}
+		}
 	}
 
-	return ref;
+	g_free (results);
+	g_free (order);
+
+	return objects;
 }
 
-/**
- * ggit_repository_lookup_reference_dwim:
- * @repository: a #GgitRepository.
- * @short_name: the short name for the reference (e.g. master, v0.1.0, ...).
- * @error: a #GError for error reporting, or %NULL.
- *
- * Lookups a reference by its short name in @repository applying the git precendence
- * rules to the given shorthand to determine which reference the user is referring to.
- * The returned #GgitRef must be freed with g_object_unref().
- *
- * Returns: (transfer full) (nullable): the searched reference.
- */
-GgitRef *
-ggit_repository_lookup_reference_dwim (GgitRepository  *repository,
-                                       const gchar     *short_name,
-                                       GError         **error)
+typedef struct
 {
-	GgitRef *ref = NULL;
-	git_reference *reference;
+	GAsyncQueue *repositories;
+	GAsyncQueue *results;
+
+	/* the requested ids, sorted */
+	LookupManyEntry *order;
+	git_odb_object **objects;
+} ReadMany;
+
+typedef struct
+{
+	ReadMany *read;
+	gsize begin;
+	gsize end;
+	GError *error;
+} ReadManyChunk;
+
+static void
+read_many_chunk (ReadManyChunk  *chunk,
+                 git_repository *repo)
+{
+	ReadMany *read = chunk->read;
+	git_odb *odb = NULL;
+	gsize i;
 	gint ret;
 
-	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
-	g_return_val_if_fail (short_name != NULL, NULL);
+	ret = git_repository_odb (&odb, repo);
 
-	ret = git_reference_dwim (&reference, _ggit_native_get (repository),
-	                          short_name);
+	for (i = chunk->begin; i < chunk->end && ret == GIT_OK; ++i)
+	{
+		LookupManyEntry *entry = &read->order[i];
 
-	if (ret == GIT_OK)
+		ret = git_odb_read (&read->objects[entry->idx], odb, entry->id);
+	}
+
+	if (ret != GIT_OK)
 	{
-		ref = _ggit_ref_wrap (reference, FALSE);
+		/* libgit2 errors are per thread, so collect it here */
+		_ggit_error_set (&chunk->error, ret);
 	}
-	else
+
+	if (odb != NULL)
 	{
-		_ggit_error_set (error, ret);
+		git_odb_free (odb);
 	}
+}
 
-	return ref;
+static void
+read_many_worker (gpointer data,
+                  gpointer user_data)
+{
+	ReadManyChunk *chunk = data;
+	ReadMany *read = user_data;
+	GgitRepository *repository;
+
+	repository = g_async_queue_pop (read->repositories);
+	read_many_chunk (chunk, _ggit_native_get (repository));
+	g_async_queue_push (read->repositories, repository);
+
+	g_async_queue_push (read->results, chunk);
 }
 
 /**
- * ggit_repository_create_reference:
+ * ggit_repository_read_many:
  * @repository: a #GgitRepository.
- * @name: the name for the new #GgitRef.
- * @oid: the #GgitOId pointed to by the reference.
- * @log_message: The one line long message to be appended to the reflog.
+ * @oids: (array length=n_oids): the ids of the objects to read.
+ * @n_oids: the number of ids in @oids.
+ * @n_threads: the number of threads to use, or 0 to use one per processor.
+ * @types: (out) (optional) (element-type GType) (transfer full): return
+ *         location for the types of the objects, or %NULL.
  * @error: a #GError for error reporting, or %NULL.
  *
- * Creates a new object id reference.
+ * Reads the raw content of all the objects in @oids from the object
+ * database without creating a #GgitObject for each of them. The objects
+ * are read in id order and, for large requests, on a pool of up to
+ * @n_threads threads, each with its own handle on the repository. The
+ * returned buffers refer directly to the data of the object database, no
+ * copies are made.
  *
- * The reference will be created in the repository and written
- * to the disk. The returned value must be freed with g_object_unref().
+ * The types of the objects are stored in @types as #GgitBlob, #GgitTree,
+ * #GgitCommit or #GgitTag #GType<!-- -->s.
  *
- * Returns: (transfer full) (nullable): the newly created reference.
+ * If any of the objects can not be read, @error is set and none of the
+ * objects are returned.
+ *
+ * Returns: (transfer full) (element-type GBytes) (nullable): the content
+ * of the objects, in the same order as @oids, or %NULL on error.
  */
-GgitRef *
-ggit_repository_create_reference (GgitRepository  *repository,
-                                  const gchar     *name,
-                                  GgitOId         *oid,
-                                  const gchar     *log_message,
-                                  GError         **error)
+GPtrArray *
+ggit_repository_read_many (GgitRepository  *repository,
+                           GgitOId        **oids,
+                           gsize            n_oids,
+                           guint            n_threads,
+                           GArray         **types,
+                           GError         **error)
 {
-	GgitRef *ref = NULL;
-	git_reference *reference;
-	gint ret;
+	ReadMany read = { 0, };
+	ReadManyChunk *chunks;
+	GThreadPool *pool = NULL;
+	GPtrArray *buffers = NULL;
+	gsize chunk_size;
+	guint n_chunks;
+	gboolean success = TRUE;
+	gsize i;
 
 	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
-	g_return_val_if_fail (name != NULL, NULL);
-	g_return_val_if_fail (oid != NULL, NULL);
-	g_return_val_if_fail (log_message != NULL, NULL);
+	g_return_val_if_fail (oids != NULL || n_oids == 0, NULL);
 	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
-	ret = git_reference_create (&reference, _ggit_native_get (repository),
-	                            name, _ggit_oid_get_oid (oid), FALSE,
-	                            log_message);
-
-	if (ret == GIT_OK)
+	if (n_threads == 0)
 	{
-		ref = _ggit_ref_wrap (reference, FALSE);
+		n_threads = g_get_num_processors ();
 	}
-	else
+
+	read.order = lookup_many_sort (oids, n_oids);
+	read.objects = g_new0 (git_odb_object *, n_oids);
+	read.results = g_async_queue_new ();
+
+	/* not worth a thread for just a few objects */
+	n_chunks = (guint)MIN ((gsize)n_threads, n_oids / 64 + 1);
+	chunk_size = (n_oids + n_chunks - 1) / n_chunks;
+
+	chunks = g_new0 (ReadManyChunk, n_chunks);
+
+	for (i = 0; i < n_chunks; ++i)
 	{
-		_ggit_error_set (error, ret);
+		chunks[i].read = &read;
+		chunks[i].begin = MIN (i * chunk_size, n_oids);
+		chunks[i].end = MIN ((i + 1) * chunk_size, n_oids);
 	}
 
-	return ref;
-}
-
-/**
- * ggit_repository_create_symbolic_reference:
- * @repository: a #GgitRepository.
- * @name: the name for the new #GgitRef.
- * @target: the full name to the reference.
- * @log_message: The one line long message to be appended to the reflog.
- * @error: a #GError for error reporting, or %NULL.
- *
- * Creates a new symbolic reference.
- *
- * The reference will be created in the repository and written
- * to the disk. The returned value must be freed with g_object_unref().
- *
- * Returns: (transfer full) (nullable): the newly created reference.
- */
-GgitRef *
-ggit_repository_create_symbolic_reference (GgitRepository  *repository,
-                                           const gchar     *name,
-                                           const gchar     *target,
-                                           const gchar     *log_message,
-                                           GError         **error)
-{
-	GgitRef *ref = NULL;
-	git_reference *reference;
-	gint ret;
+	if (n_chunks > 1)
+	{
+		gint n_workers;
 
-	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
-	g_return_val_if_fail (name != NULL, NULL);
-	g_return_val_if_fail (target != NULL, NULL);
-	g_return_val_if_fail (log_message != NULL, NULL);
-	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+		read.repositories = _ggit_repository_open_workers (repository, n_chunks);
+		n_workers = g_async_queue_length (read.repositories);
 
-	ret = git_reference_symbolic_create (&reference, _ggit_native_get (repository),
-	                                     name, target, FALSE,
-	                                     log_message);
+		if (n_workers > 0)
+		{
+			pool = g_thread_pool_new (read_many_worker,
+			                          &read,
+			                          n_workers,
+			                          FALSE,
+			                          NULL);
+		}
+	}
 
-	if (ret == GIT_OK)
+	if (pool != NULL)
 	{
-		ref = _ggit_ref_wrap (reference, FALSE);
+		for (i = 0; i < n_chunks; ++i)
+		{
+			g_thread_pool_push (pool, &chunks[i], NULL);
+		}
+
+		for (i = 0; i < n_chunks; ++i)
+		{
+			g_async_queue_pop (read.results);
+		}
+
+		g_thread_pool_free (pool, FALSE, TRUE);
 	}
 	else
 	{
-		_ggit_error_set (error, ret);
+		for (i = 0; i < n_chunks; ++i)
+		{
+			read_many_chunk (&chunks[i], _ggit_native_get (repository));
+		}
 	}
 
-	return ref;
-}
+	for (i = 0; i < n_chunks; ++i)
+	{
+		if (chunks[i].error == NULL)
+		{
+			continue;
+		}
 
-/**
- * ggit_repository_get_head:
- * @repository: a #GgitRepository.
- * @error: a #GError for error reporting, or %NULL.
- *
- * Get and resolves the current HEAD reference of the repository. Note that the
- * returned ref is already resolved (if HEAD is symbolic). If you want to
- * retrieve the symbolic ref called HEAD, then use #ggit_repository_lookup_reference
- * instead.
- *
- * Returns: (transfer full) (nullable): a #GgitRef
- *
- **/
-GgitRef *
-ggit_repository_get_head (GgitRepository  *repository,
-                          GError         **error)
-{
-	GgitRef *ref = NULL;
-	git_reference *reference;
-	gint ret;
+		if (success)
+		{
+			g_propagate_error (error, chunks[i].error);
+			success = FALSE;
+		}
+		else
+		{
+			g_error_free (chunks[i].error);
+		}
+	}
 
-	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
-	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+	if (success)
+	{
+		buffers = g_ptr_array_new_full (n_oids,
+		                                (GDestroyNotify)g_bytes_unref);
 
-	ret = git_repository_head (&reference, _ggit_native_get (repository));
+		if (types != NULL)
+		{
+			*types = g_array_sized_new (FALSE, FALSE, sizeof (GType), n_oids);
+		}
 
-	if (ret == GIT_OK)
-	{
-		ref = _ggit_ref_wrap (reference, TRUE);
+		for (i = 0; i < n_oids; ++i)
+		{
+			git_odb_object *obj = read.objects[i];
+
+			g_ptr_array_add (buffers,
+			                 g_bytes_new_with_free_func (git_odb_object_data (obj),
+			                                             git_odb_object_size (obj),
+			                                             (GDestroyNotify)git_odb_object_free,
+			                                             obj));
+
+			if (types != NULL)
+			{
+				GType gtype;
+
+				gtype = ggit_utils_get_gtype_from_otype (git_odb_object_type (obj));
+				g_array_append_val (*types, gtype);
+			}
+		}
 	}
 	else
 	{
-		_ggit_error_set (error, ret);
+		for (i = 0; i < n_oids; ++i)
+		{
+			if (read.objects[i] != NULL)
+			{
+				git_odb_object_free (read.objects[i]);
+			}
+		}
 	}
 
-	return ref;
+	if (read.repositories != NULL)
+	{
+		g_async_queue_unref (read.repositories);
+	}
+
+	g_async_queue_unref (read.results);
+
+	g_free (chunks);
+	g_free (read.objects);
+	g_free (read.order);
+
+	return buffers;
 }
 
-/**
- * ggit_repository_set_head:
- * @repository: a #GgitRepository.
- * @ref_name: canonical name of the reference HEAD should point to.
- * @error: a #GError for error reporting, or %NULL.
- *
- * Returns: %TRUE if head was successfully set, %FALSE otherwise.
- *
- **/
-gboolean
-ggit_repository_set_head (GgitRepository   *repository,
-                          const gchar      *ref_name,
-                          GError          **error)
+static gchar *
+get_objects_dir (git_repository *repo)
 {
-	gint ret;
+#if LIBGIT2_VER_MAJOR > 0 || (LIBGIT2_VER_MAJOR == 0 && LIBGIT2_VER_MINOR >= 26)
+	return g_build_filename (git_repository_commondir (repo), "objects", NULL);
+#else
+	return g_build_filename (git_repository_path (repo), "objects", NULL);
+#endif
+}
 
-	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), FALSE);
-	g_return_val_if_fail (ref_name != NULL, FALSE);
-	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+/* Must be called with the prefix index lock held */
+static GgitPrefixIndex *
+get_prefix_index (GgitRepository  *repository,
+                  GError         **error)
+{
+	GgitRepositoryPrivate *priv;
 
-	ret = git_repository_set_head (_ggit_native_get (repository), ref_name);
+	priv = ggit_repository_get_instance_private (repository);
 
-	if (ret != GIT_OK)
+	if (priv->prefix_index == NULL)
 	{
-		_ggit_error_set (error, ret);
-		return FALSE;
+		gchar *objects_dir;
+
+		objects_dir = get_objects_dir (_ggit_native_get (repository));
+		priv->prefix_index = _ggit_prefix_index_new (objects_dir);
+		g_free (objects_dir);
 	}
 
-	return TRUE;
+	if (!_ggit_prefix_index_refresh (priv->prefix_index, error))
+	{
+		return NULL;
+	}
+
+	return priv->prefix_index;
 }
 
-/**
- * ggit_repository_set_head_detached:
- * @repository: a #GgitRepository.
- * @ref_name: canonical name of the reference HEAD should point to.
- * @error: a #GError for error reporting, or %NULL.
- *
- * Returns: %TRUE if head was successfully set, %FALSE otherwise.
- *
- **/
-gboolean
-ggit_repository_set_head_detached (GgitRepository  *repository,
-                                   GgitOId         *oid,
-                                   GError         **error)
+/* Must be called with the prefix index lock held. Returns the object
+ * database of @repository if backends were added to it, like a
+ * #GgitMempack, since the prefix index only sees the objects on disk.
+ */
+static git_odb *
+get_custom_odb (GgitRepository *repository)
 {
-	gint ret;
+	GgitRepositoryPrivate *priv;
+	git_odb *odb;
 
-	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), FALSE);
-	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+	priv = ggit_repository_get_instance_private (repository);
 
-	ret = git_repository_set_head_detached (_ggit_native_get(repository),
-                                                (const git_oid *)_ggit_oid_get_oid(oid));
+	if (git_repository_odb (&odb, _ggit_native_get (repository)) != GIT_OK)
+	{
+		return NULL;
+	}
 
-	if (ret != GIT_OK)
+	if (priv->n_default_odb_backends == 0)
 	{
-		_ggit_error_set (error, ret);
-		return FALSE;
+		GgitRepository *fresh;
+		git_odb *fresh_odb;
+
+		fresh = _ggit_repository_open_worker (repository, NULL);
+
+		if (fresh == NULL)
+		{
+			return odb;
+		}
+
+		if (git_repository_odb (&fresh_odb, _ggit_native_get (fresh)) == GIT_OK)
+		{
+			priv->n_default_odb_backends = git_odb_num_backends (fresh_odb);
+			git_odb_free (fresh_odb);
+		}
+
+		g_object_unref (fresh);
 	}
 
-	return TRUE;
+	if (priv->n_default_odb_backends > 0 &&
+	    git_odb_num_backends (odb) <= (gsize)priv->n_default_odb_backends)
+	{
+		git_odb_free (odb);
+		return NULL;
+	}
+
+	return odb;
 }
 
-/**
- * ggit_repository_discover:
- * @location: the base location where the lookup starts.
- * @error: a #GError for error reporting, or %NULL.
- *
- * Looks for a git repository.
- *
- * The lookup starts from @path and walks up the parent directories
- * and stops when a repository is found.
- *
- * Returns: (transfer full) (nullable): the repository location.
- */
-GFile *
-ggit_repository_discover (GFile   *location,
-                          GError **error)
+static gchar *
+shorten_oid_with_odb (git_odb        *odb,
+                      const git_oid  *oid,
+                      guint           min_length,
+                      GError        **error)
 {
-	g_return_val_if_fail (G_IS_FILE (location), NULL);
-	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+	gchar *ret;
+	guint length;
 
-	return ggit_repository_discover_full (location, FALSE, NULL, error);
+	/* prefixes shorter than 4 characters are always ambiguous */
+	for (length = MIN (min_length, GIT_OID_HEXSZ); length < GIT_OID_HEXSZ; ++length)
+	{
+		git_oid out;
+		gint err;
+
+		err = git_odb_exists_prefix (&out, odb, oid, length);
+
+		if (err == GIT_OK || err == GIT_ENOTFOUND)
+		{
+			break;
+		}
+
+		if (err != GIT_EAMBIGUOUS)
+		{
+			_ggit_error_set (error, err);
+			return NULL;
+		}
+	}
+
+	ret = g_new (gchar, GIT_OID_HEXSZ + 1);
+	_ggit_oid_format_hex (oid->id, ret);
+	ret[length] = '\0';
+
+	return ret;
 }
 
-/**
- * ggit_repository_discover_full:
- * @location: the base location where the lookup starts.
- * @across_fs: indictaes whether lookup will work across filesystem devices.
- * @ceiling_dirs: (array zero-terminated=1) (allow-none): a list of absolute paths
- *   at which lookup will stop when reached, or %NULL.
- * @error: a #GError for error reporting, or %NULL.
- *
- * Looks for a git repository.
- *
- * The lookup starts from @path and walks up the parent directories
- * and stops when a repository is found.
- *
- * Returns: (transfer full) (nullable): the repository location.
- */
-GFile *
-ggit_repository_discover_full (GFile        *location,
-                               gboolean      across_fs,
-                               const gchar **ceiling_dirs,
-                               GError      **error)
+typedef struct
 {
-	gchar *path;
-	gint ret;
-	git_buf buf = {0,};
-	GFile *rep = NULL;
-	gchar *dirs_path = NULL;
-	gchar path_sep[2] = { GIT_PATH_LIST_SEPARATOR, 0 };
-
-	g_return_val_if_fail (G_IS_FILE (location), NULL);
-	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+	guint8 raw[GIT_OID_RAWSZ];
+	gsize length;
+	GgitOIdArray *oids;
+} FindByPrefixData;
 
-	path = g_file_get_path (location);
-	g_return_val_if_fail (path != NULL, NULL);
+static gint
+find_by_prefix_cb (const git_oid *oid,
+                   gpointer       payload)
+{
+	FindByPrefixData *data = payload;
 
-	if (ceiling_dirs != NULL) {
-		dirs_path = g_strjoinv (path_sep, (gchar **)ceiling_dirs);
+	if (_ggit_oid_raw_has_prefix (oid->id, data->raw, data->length))
+	{
+		_ggit_oid_array_append_oid (data->oids, oid);
 	}
 
-	ret = git_repository_discover (&buf,
-	                               path,
-	                               across_fs ? 1 : 0,
-	                               dirs_path);
+	return 0;
+}
 
-	g_free (path);
-	g_free (dirs_path);
+static GgitOIdArray *
+find_oids_with_odb (git_odb      *odb,
+                    const gchar  *prefix,
+                    GError      **error)
+{
+	FindByPrefixData data;
+	gint ret;
 
-	if (ret == GIT_OK)
+	data.oids = ggit_oid_array_new (0);
+
+	if (!_ggit_oid_parse_prefix (prefix, data.raw, &data.length))
 	{
-		rep = g_file_new_for_path (buf.ptr);
-#if LIBGIT2_VER_MAJOR > 0 || (LIBGIT2_VER_MAJOR == 0 && LIBGIT2_VER_MINOR >= 28)
-		git_buf_dispose (&buf);
-#else
-		git_buf_free (&buf);
-#endif
+		return data.oids;
 	}
-	else
+
+	/* the backends can not list the ids by prefix */
+	ret = git_odb_foreach (odb, find_by_prefix_cb, &data);
+
+	if (ret != GIT_OK)
 	{
+		ggit_oid_array_unref (data.oids);
+
 		_ggit_error_set (error, ret);
+		return NULL;
 	}
 
-	return rep;
+	ggit_oid_array_sort (data.oids);
+	_ggit_oid_array_unique (data.oids);
+
+	return data.oids;
 }
 
 /**
- * ggit_repository_is_head_detached:
+ * ggit_repository_shorten_oids:
  * @repository: a #GgitRepository.
+ * @oids: (array length=n_oids): the ids to shorten.
+ * @n_oids: the number of ids in @oids.
+ * @min_length: the minimum length of the abbreviated ids, or 0 for the
+ *              default of 7 characters.
  * @error: a #GError for error reporting, or %NULL.
  *
- * Checks if @repository's HEAD is detached.
+ * Abbreviate the ids in @oids to the shortest hex prefix of at least
+ * @min_length characters that does not match any other object of the
+ * repository.
  *
- * A repository's HEAD is detached when it points directly to a commit
- * instead of a branch.
+ * The ids of the packed objects of the repository are read once from the
+ * pack indexes, and those of the loose objects when a loose object
+ * directory is first needed. They are kept sorted so that abbreviating an
+ * id only needs a binary search, and read again when packs or loose
+ * objects are added or removed. When backends were added to the object
+ * database, such as a #GgitMempack, each id is looked up in the object
+ * database instead. The abbreviated ids have at least two characters.
  *
- * Returns: %TRUE if HEAD is detached.
- */
-gboolean
-ggit_repository_is_head_detached (GgitRepository  *repository,
-                                  GError         **error)
+ * Returns: (transfer full) (array zero-terminated=1) (nullable): the
+ * abbreviated ids, in the order of @oids, or %NULL on error.
+ *
+ **/
+gchar **
+ggit_repository_shorten_oids (GgitRepository  *repository,
+                              GgitOId        **oids,
+                              gsize            n_oids,
+                              guint            min_length,
+                              GError         **error)
 {
-	gint ret;
+	GgitRepositoryPrivate *priv;
+	GgitPrefixIndex *index;
+	git_odb *odb;
+	gchar **ret;
+	gsize i;
 
-	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), FALSE);
-	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
+	g_return_val_if_fail (oids != NULL || n_oids == 0, NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
-	ret = git_repository_head_detached (_ggit_native_get (repository));
+	priv = ggit_repository_get_instance_private (repository);
 
-	if (ret < 0)
+	if (min_length == 0)
 	{
-		_ggit_error_set (error, ret);
+		min_length = 7;
 	}
 
-	return ret == 1;
-}
+	g_mutex_lock (&priv->prefix_index_lock);
 
-/**
- * ggit_repository_is_head_unborn:
- * @repository: a #GgitRepository.
- * @error: a #GError for error reporting, or %NULL.
- *
- * Checks if @repository's HEAD is an orphan.
- *
- * An orphan branch is one named from HEAD but doesn't exist in
- * the refs namespace, because it doesn't have any commit to point to.
- *
- * Returns: %TRUE if the current branch is an orphan.
- */
-gboolean
-ggit_repository_is_head_unborn (GgitRepository  *repository,
-                                GError         **error)
-{
-	gint ret;
+	odb = get_custom_odb (repository);
+	index = odb == NULL ? get_prefix_index (repository, error) : NULL;
 
-	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), FALSE);
-	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+	if (odb == NULL && index == NULL)
+	{
+		g_mutex_unlock (&priv->prefix_index_lock);
+		return NULL;
+	}
 
-	ret = git_repository_head_unborn (_ggit_native_get (repository));
+	ret = g_new0 (gchar *, n_oids + 1);
 
-	if (ret < 0)
+	for (i = 0; i < n_oids; ++i)
 	{
-		_ggit_error_set (error, ret);
+		const git_oid *oid = _ggit_oid_get_oid (oids[i]);
+		guint length;
+
+		if (odb != NULL)
+		{
+			ret[i] = shorten_oid_with_odb (odb, oid, min_length, error);
+
+			if (ret[i] == NULL)
+			{
+				g_strfreev (ret);
+				ret = NULL;
+				break;
+			}
+
+			continue;
+		}
+
+		length = _ggit_prefix_index_get_unique_length (index, oid, min_length);
+
+		ret[i] = g_new (gchar, GIT_OID_HEXSZ + 1);
+		_ggit_oid_format_hex (oid->id, ret[i]);
+		ret[i][length] = '\0';
 	}
 
-	return ret == 1;
+	if (odb != NULL)
+	{
+		git_odb_free (odb);
+	}
+
+	g_mutex_unlock (&priv->prefix_index_lock);
+
+	return ret;
 }
 
 /**
- * ggit_repository_is_empty:
+ * ggit_repository_find_oids_by_prefix:
  * @repository: a #GgitRepository.
+ * @prefix: a hex formatted prefix.
  * @error: a #GError for error reporting, or %NULL.
  *
- * Checks if @repository is empty.
+ * Find the ids of all the objects of the repository which start with
+ * @prefix, for example to resolve an abbreviated id typed by a user or to
+ * list the candidates of an ambiguous one. This uses the same index as
+ * ggit_repository_shorten_oids(). When backends were added to the object
+ * database, all the objects are listed to find the matching ones instead.
  *
- * An empty repository has just been initialized and contains
- * no commits.
+ * Returns: (transfer full) (nullable): the sorted matching ids, or %NULL
+ * on error.
  *
- * Returns: %TRUE if the repository is empty.
- */
-gboolean
-ggit_repository_is_empty (GgitRepository  *repository,
-                          GError         **error)
+ **/
+GgitOIdArray *
+ggit_repository_find_oids_by_prefix (GgitRepository  *repository,
+                                     const gchar     *prefix,
+                                     GError         **error)
 {
-	gint ret;
+	GgitRepositoryPrivate *priv;
+	GgitPrefixIndex *index;
+	GgitOIdArray *ret = NULL;
+	git_odb *odb;
 
-	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), FALSE);
-	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
+	g_return_val_if_fail (prefix != NULL, NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
-	ret = git_repository_is_empty (_ggit_native_get (repository));
+	priv = ggit_repository_get_instance_private (repository);
 
-	if (ret < 0)
+	g_mutex_lock (&priv->prefix_index_lock);
+
+	odb = get_custom_odb (repository);
+
+	if (odb != NULL)
 	{
-		_ggit_error_set (error, ret);
+		ret = find_oids_with_odb (odb, prefix, error);
+		git_odb_free (odb);
+	}
+	else
+	{
+		index = get_prefix_index (repository, error);
+
+		if (index != NULL)
+		{
+			ret = _ggit_prefix_index_find (index, prefix);
+		}
 	}
 
-	return ret == 1;
+	g_mutex_unlock (&priv->prefix_index_lock);
+
+	return ret;
 }
 
 /**
- * ggit_repository_get_location:
+ * ggit_repository_revparse:
  * @repository: a #GgitRepository.
+ * @spec: the revision specification.
+ * @error: a #GError for error reporting, or %NULL.
  *
- * Get the gitdir location of the repository.
+ * Find an object, as specified by a revision string. See `man gitrevisions`,
+ * or the documentation for `git rev-parse` for information on the syntax
+ * accepted.
  *
- * Returns: (transfer full) (nullable): the location of the gitdir of the repository.
- */
-GFile *
-ggit_repository_get_location (GgitRepository *repository)
+ * Returns: (transfer full) (nullable): a #GgitObject or %NULL if the revision could not be found.
+ *
+ **/
+GgitObject *
+ggit_repository_revparse (GgitRepository  *repository,
+                          const gchar     *spec,
+                          GError         **error)
 {
-	const gchar *path;
+	GgitObject *object = NULL;
+	git_object *obj = NULL;
+	gint ret;
 
 	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
+	g_return_val_if_fail (spec != NULL, NULL);
 
-	path = git_repository_path (_ggit_native_get (repository));
+	ret = git_revparse_single (&obj, _ggit_native_get (repository), spec);
 
-	return path ? g_file_new_for_path (path) : NULL;
+	if (ret == GIT_OK)
+	{
+		object = ggit_utils_create_real_object (obj, TRUE);
+	}
+	else
+	{
+		_ggit_error_set (error, ret);
+	}
+
+	return object;
 }
 
 /**
- * ggit_repository_get_workdir:
+ * ggit_repository_lookup_reference:
  * @repository: a #GgitRepository.
+ * @name: the long name for the reference (e.g. HEAD, ref/heads/master, refs/tags/v0.1.0, ...).
+ * @error: a #GError for error reporting, or %NULL.
  *
- * Gets the working directory of the repository.
+ * Lookups a reference by its name in @repository. The returned #GgitRef must
+ * be freed with g_object_unref().
  *
- * Returns: (transfer full) (nullable): the location of the working directory of the repository.
+ * Returns: (transfer full) (nullable): the searched reference.
  */
-GFile *
-ggit_repository_get_workdir (GgitRepository *repository)
+GgitRef *
+ggit_repository_lookup_reference (GgitRepository  *repository,
+                                  const gchar     *name,
+                                  GError         **error)
 {
-	const gchar *path;
+	GgitRef *ref = NULL;
+	git_reference *reference;
+	gint ret;
 
 	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
+	g_return_val_if_fail (name != NULL, NULL);
 
-	path = git_repository_workdir (_ggit_native_get (repository));
-
-	return path ? g_file_new_for_path (path) : NULL;
-}
+	ret = git_reference_lookup (&reference, _ggit_native_get (repository),
+	                            name);
 
-/**
- * ggit_repository_set_workdir:
- * @repository: a #GgitRepository.
- * @workdir: the working directory.
- * @update_gitlink: create/update gitlink in workdir.
- *
- * Sets the working directory of the repository. If @update_gitlink is set to
- * %TRUE "core.worktree" will be set in the config if workdir is not the parent
- * of the .git directory).
- */
-void
-ggit_repository_set_workdir (GgitRepository *repository,
-                             GFile          *workdir,
-                             gboolean        update_gitlink)
-{
-	g_return_if_fail (GGIT_IS_REPOSITORY (repository));
-	g_return_if_fail (G_IS_FILE (workdir));
+	if (ret == GIT_OK)
+	{
+		ref = _ggit_ref_wrap (reference, FALSE);
+	}
+	else
+	{
+		_ggit_error_set (error, ret);
+	}
 
-	set_workdir (repository, workdir, update_gitlink);
+	return ref;
 }
 
 /**
- * ggit_repository_is_bare:
+ * ggit_repository_lookup_reference_dwim:
  * @repository: a #GgitRepository.
+ * @short_name: the short name for the reference (e.g. master, v0.1.0, ...).
+ * @error: a #GError for error reporting, or %NULL.
  *
- * Checks if @repository is bare.
+ * Lookups a reference by its short name in @repository applying the git precendence
+ * rules to the given shorthand to determine which reference the user is referring to.
+ * The returned #GgitRef must be freed with g_object_unref().
  *
- * Returns: %TRUE if the repository is empty.
+ * Returns: (transfer full) (nullable): the searched reference.
  */
-gboolean
-ggit_repository_is_bare (GgitRepository *repository)
+GgitRef *
+ggit_repository_lookup_reference_dwim (GgitRepository  *repository,
+                                       const gchar     *short_name,
+                                       GError         **error)
 {
-	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), FALSE);
+	GgitRef *ref = NULL;
+	git_reference *reference;
+	gint ret;
 
-	return git_repository_is_bare (_ggit_native_get (repository));
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
+	g_return_val_if_fail (short_name != NULL, NULL);
+
+	ret = git_reference_dwim (&reference, _ggit_native_get (repository),
+	                          short_name);
+
+	if (ret == GIT_OK)
+	{
+		ref = _ggit_ref_wrap (reference, FALSE);
+	}
+	else
+	{
+		_ggit_error_set (error, ret);
+	}
+
+	return ref;
 }
 
 /**
- * ggit_repository_file_status:
+ * ggit_repository_create_reference:
  * @repository: a #GgitRepository.
- * @location: the file to retrieve status for, rooted at the repository working dir.
+ * @name: the name for the new #GgitRef.
+ * @oid: the #GgitOId pointed to by the reference.
+ * @log_message: The one line long message to be appended to the reflog.
  * @error: a #GError for error reporting, or %NULL.
  *
- * Gets the file status for a single file.
+ * Creates a new object id reference.
  *
- * Returns: the status for a single file.
+ * The reference will be created in the repository and written
+ * to the disk. The returned value must be freed with g_object_unref().
+ *
+ * Returns: (transfer full) (nullable): the newly created reference.
  */
-GgitStatusFlags
-ggit_repository_file_status (GgitRepository  *repository,
-                             GFile           *location,
-                             GError         **error)
+GgitRef *
+ggit_repository_create_reference (GgitRepository  *repository,
+                                  const gchar     *name,
+                                  GgitOId         *oid,
+                                  const gchar     *log_message,
+                                  GError         **error)
 {
-	GgitRepositoryPrivate *priv;
-	GgitStatusFlags status_flags;
+	GgitRef *ref = NULL;
+	git_reference *reference;
 	gint ret;
-	gchar *path;
-
-	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), GGIT_STATUS_IGNORED);
-	g_return_val_if_fail (G_IS_FILE (location), GGIT_STATUS_IGNORED);
-	g_return_val_if_fail (error == NULL || *error == NULL, GGIT_STATUS_IGNORED);
-
-	priv = ggit_repository_get_instance_private (repository);
 
-	path = g_file_get_relative_path (priv->workdir, location);
-
-	g_return_val_if_fail (path != NULL, GGIT_STATUS_IGNORED);
-
-	ret = git_status_file (&status_flags,
-	                       _ggit_native_get (repository),
-	                       path);
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
+	g_return_val_if_fail (name != NULL, NULL);
+	g_return_val_if_fail (oid != NULL, NULL);
+	g_return_val_if_fail (log_message != NULL, NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
-	g_free (path);
+	ret = git_reference_create (&reference, _ggit_native_get (repository),
+	                            name, _ggit_oid_get_oid (oid), FALSE,
+	                            log_message);
 
-	if (ret != GIT_OK)
+	if (ret == GIT_OK)
+	{
+		ref = _ggit_ref_wrap (reference, FALSE);
+	}
+	else
 	{
 		_ggit_error_set (error, ret);
 	}
 
-	return status_flags;
+	return ref;
 }
 
 /**
- * ggit_repository_file_status_foreach:
+ * ggit_repository_create_symbolic_reference:
  * @repository: a #GgitRepository.
- * @options: (allow-none): status options, or %NULL.
- * @callback: (scope call): a #GgitStatusCallback.
- * @user_data: callback user data.
+ * @name: the name for the new #GgitRef.
+ * @target: the full name to the reference.
+ * @log_message: The one line long message to be appended to the reflog.
  * @error: a #GError for error reporting, or %NULL.
  *
- * Gathers file statuses and run a callback for each one.
- *
- * To the callback is passed the path of the file, the status and the data pointer
- * passed to this function. If the callback returns something other than
- * 0, the iteration will stop and @error will be set.
- *
- * Set @options to %NULL to get the default status options.
+ * Creates a new symbolic reference.
  *
- * Returns: %TRUE if there was no error, %FALSE otherwise
+ * The reference will be created in the repository and written
+ * to the disk. The returned value must be freed with g_object_unref().
  *
+ * Returns: (transfer full) (nullable): the newly created reference.
  */
-gboolean
-ggit_repository_file_status_foreach (GgitRepository     *repository,
-                                     GgitStatusOptions  *options,
-                                     GgitStatusCallback  callback,
-                                     gpointer            user_data,
-                                     GError            **error)
+GgitRef *
+ggit_repository_create_symbolic_reference (GgitRepository  *repository,
+                                           const gchar     *name,
+                                           const gchar     *target,
+                                           const gchar     *log_message,
+                                           GError         **error)
 {
+	GgitRef *ref = NULL;
+	git_reference *reference;
 	gint ret;
 
-	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), FALSE);
-	g_return_val_if_fail (callback != NULL, FALSE);
-	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
+	g_return_val_if_fail (name != NULL, NULL);
+	g_return_val_if_fail (target != NULL, NULL);
+	g_return_val_if_fail (log_message != NULL, NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
-	ret = git_status_foreach_ext (_ggit_native_get (repository),
-	                              _ggit_status_options_get_status_options (options),
-	                              callback,
-	                              user_data);
+	ret = git_reference_symbolic_create (&reference, _ggit_native_get (repository),
+	                                     name, target, FALSE,
+	                                     log_message);
 
-	if (ret != GIT_OK)
+	if (ret == GIT_OK)
+	{
+		ref = _ggit_ref_wrap (reference, FALSE);
+	}
+	else
 	{
 		_ggit_error_set (error, ret);
-		return FALSE;
 	}
 
-	return TRUE;
-}
-
-typedef struct
-{
-	GgitReferencesCallback callback;
-	gpointer user_data;
-} ReferenceForeachInfo;
-
-static gint
-references_foreach_wrapper (git_reference *reference,
-                            gpointer       payload)
-{
-	ReferenceForeachInfo *info = (ReferenceForeachInfo *)payload;
-
-	return info->callback(_ggit_ref_wrap (reference, TRUE), info->user_data);
+	return ref;
 }
 
 /**
- * ggit_repository_references_foreach:
+ * ggit_repository_get_head:
  * @repository: a #GgitRepository.
- * @callback: (scope call): a #GgitReferencesCallback.
- * @user_data: callback user data.
  * @error: a #GError for error reporting, or %NULL.
  *
- * Gathers references and run a callback for each one.
- *
- * To the callback is passed the reference and the data pointer
- * passed to this function. If the callback returns something other than
- * 0, the iteration will stop and @error will be set.
+ * Get and resolves the current HEAD reference of the repository. Note that the
+ * returned ref is already resolved (if HEAD is symbolic). If you want to
+ * retrieve the symbolic ref called HEAD, then use #ggit_repository_lookup_reference
+ * instead.
  *
- * Returns: %TRUE if there was no error, %FALSE otherwise
+ * Returns: (transfer full) (nullable): a #GgitRef
  *
- */
-gboolean
-ggit_repository_references_foreach (GgitRepository          *repository,
-                                    GgitReferencesCallback   callback,
-                                    gpointer                 user_data,
-                                    GError                 **error)
+ **/
+GgitRef *
+ggit_repository_get_head (GgitRepository  *repository,
+                          GError         **error)
 {
+	GgitRef *ref = NULL;
+	git_reference *reference;
 	gint ret;
-	ReferenceForeachInfo info;
-
-	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), FALSE);
-	g_return_val_if_fail (callback != NULL, FALSE);
-	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
 
-	info.callback = callback;
-	info.user_data = user_data;
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
-	ret = git_reference_foreach (_ggit_native_get (repository),
-	                             references_foreach_wrapper,
-	                             &info);
+	ret = git_repository_head (&reference, _ggit_native_get (repository));
 
-	if (ret != GIT_OK)
+	if (ret == GIT_OK)
+	{
+		ref = _ggit_ref_wrap (reference, TRUE);
+	}
+	else
 	{
 		_ggit_error_set (error, ret);
-		return FALSE;
 	}
 
-	return TRUE;
+	return ref;
 }
 
 /**
- * ggit_repository_references_foreach_name:
+ * ggit_repository_set_head:
  * @repository: a #GgitRepository.
- * @callback: (scope call): a #GgitReferencesNameCallback.
- * @user_data: callback user data.
+ * @ref_name: canonical name of the reference HEAD should point to.
  * @error: a #GError for error reporting, or %NULL.
  *
- * Gathers reference names and run a callback for each one.
- *
- * To the callback is passed the name of the reference and the data pointer
- * passed to this function. If the callback returns something other than
- * 0, the iteration will stop and @error will be set.
- *
- * Returns: %TRUE if there was no error, %FALSE otherwise
+ * Returns: %TRUE if head was successfully set, %FALSE otherwise.
  *
- */
+ **/
 gboolean
-ggit_repository_references_foreach_name (GgitRepository             *repository,
-                                         GgitReferencesNameCallback  callback,
-                                         gpointer                    user_data,
-                                         GError                    **error)
+ggit_repository_set_head (GgitRepository   *repository,
+                          const gchar      *ref_name,
+                          GError          **error)
 {
 	gint ret;
 
 	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), FALSE);
-	g_return_val_if_fail (callback != NULL, FALSE);
+	g_return_val_if_fail (ref_name != NULL, FALSE);
 	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
 
-	ret = git_reference_foreach_name (_ggit_native_get (repository),
-	                                  callback,
-	                                  user_data);
+	ret = git_repository_set_head (_ggit_native_get (repository), ref_name);
 
 	if (ret != GIT_OK)
 	{
@@ -1420,430 +2138,371 @@ ggit_repository_references_foreach_name (GgitRepository             *repository,
 }
 
 /**
- * ggit_repository_get_config:
+ * ggit_repository_set_head_detached:
  * @repository: a #GgitRepository.
+ * @ref_name: canonical name of the reference HEAD should point to.
  * @error: a #GError for error reporting, or %NULL.
  *
- * Get the config for a specific repository.
- *
- * Returns: (transfer full) (nullable): a #GgitConfig.
+ * Returns: %TRUE if head was successfully set, %FALSE otherwise.
  *
  **/
-GgitConfig *
-ggit_repository_get_config (GgitRepository  *repository,
-                            GError         **error)
+gboolean
+ggit_repository_set_head_detached (GgitRepository  *repository,
+                                   GgitOId         *oid,
+                                   GError         **error)
 {
-	git_config *config;
 	gint ret;
 
-	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
-	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
 
-	ret = git_repository_config (&config,
-	                             _ggit_native_get (repository));
+	ret = git_repository_set_head_detached (_ggit_native_get(repository),
+                                                (const git_oid *)_ggit_oid_get_oid(oid));
 
 	if (ret != GIT_OK)
 	{
 		_ggit_error_set (error, ret);
-		return NULL;
+		return FALSE;
 	}
 
-	return _ggit_config_wrap (config);
+	return TRUE;
 }
 
 /**
- * ggit_repository_get_index:
- * @repository: a #GgitRepository.
+ * ggit_repository_discover:
+ * @location: the base location where the lookup starts.
  * @error: a #GError for error reporting, or %NULL.
  *
- * Get the index for a specific repository.
+ * Looks for a git repository.
  *
- * Returns: (transfer full) (nullable): a #GgitIndex.
+ * The lookup starts from @path and walks up the parent directories
+ * and stops when a repository is found.
  *
- **/
-GgitIndex *
-ggit_repository_get_index (GgitRepository  *repository,
-                           GError         **error)
+ * Returns: (transfer full) (nullable): the repository location.
+ */
+GFile *
+ggit_repository_discover (GFile   *location,
+                          GError **error)
 {
-	git_index *idx;
+	g_return_val_if_fail (G_IS_FILE (location), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	return ggit_repository_discover_full (location, FALSE, NULL, error);
+}
+
+/**
+ * ggit_repository_discover_full:
+ * @location: the base location where the lookup starts.
+ * @across_fs: indictaes whether lookup will work across filesystem devices.
+ * @ceiling_dirs: (array zero-terminated=1) (allow-none): a list of absolute paths
+ *   at which lookup will stop when reached, or %NULL.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Looks for a git repository.
+ *
+ * The lookup starts from @path and walks up the parent directories
+ * and stops when a repository is found.
+ *
+ * Returns: (transfer full) (nullable): the repository location.
+ */
+GFile *
+ggit_repository_discover_full (GFile        *location,
+                               gboolean      across_fs,
+                               const gchar **ceiling_dirs,
+                               GError      **error)
+{
+	gchar *path;
 	gint ret;
+	git_buf buf = {0,};
+	GFile *rep = NULL;
+	gchar *dirs_path = NULL;
+	gchar path_sep[2] = { GIT_PATH_LIST_SEPARATOR, 0 };
 
-	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
+	g_return_val_if_fail (G_IS_FILE (location), NULL);
 	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
-	ret = git_repository_index (&idx,
-	                            _ggit_native_get (repository));
+	path = g_file_get_path (location);
+	g_return_val_if_fail (path != NULL, NULL);
 
-	if (ret != GIT_OK)
+	if (ceiling_dirs != NULL) {
+		dirs_path = g_strjoinv (path_sep, (gchar **)ceiling_dirs);
+	}
+
+	ret = git_repository_discover (&buf,
+	                               path,
+	                               across_fs ? 1 : 0,
+	                               dirs_path);
+
+	g_free (path);
+	g_free (dirs_path);
+
+	if (ret == GIT_OK)
+	{
+		rep = g_file_new_for_path (buf.ptr);
+#if LIBGIT2_VER_MAJOR > 0 || (LIBGIT2_VER_MAJOR == 0 && LIBGIT2_VER_MINOR >= 28)
+		git_buf_dispose (&buf);
+#else
+		git_buf_free (&buf);
+#endif
+	}
+	else
 	{
 		_ggit_error_set (error, ret);
-		return NULL;
 	}
 
-	return _ggit_index_wrap (idx);
+	return rep;
 }
 
 /**
- * ggit_repository_create_tag:
+ * ggit_repository_is_head_detached:
  * @repository: a #GgitRepository.
- * @tag_name: the tag name.
- * @target: a #GgitObject.
- * @tagger: a #GgitSignature.
- * @message: the tag message.
- * @flags: a #GgitCreateFlags.
  * @error: a #GError for error reporting, or %NULL.
  *
- * Create a new tag object.
+ * Checks if @repository's HEAD is detached.
  *
- * Returns: (transfer full) (nullable): the id to which the tag points, or
- *                                        %NULL in case of an error.
+ * A repository's HEAD is detached when it points directly to a commit
+ * instead of a branch.
  *
- **/
-GgitOId *
-ggit_repository_create_tag (GgitRepository   *repository,
-                            gchar const      *tag_name,
-                            GgitObject       *target,
-                            GgitSignature    *tagger,
-                            gchar const      *message,
-                            GgitCreateFlags   flags,
-                            GError          **error)
+ * Returns: %TRUE if HEAD is detached.
+ */
+gboolean
+ggit_repository_is_head_detached (GgitRepository  *repository,
+                                  GError         **error)
 {
-	git_oid oid;
-	gboolean force;
 	gint ret;
 
-	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
-	g_return_val_if_fail (tag_name != NULL, NULL);
-	g_return_val_if_fail (GGIT_IS_OBJECT (target), NULL);
-	g_return_val_if_fail (tagger != NULL, NULL);
-	g_return_val_if_fail (message != NULL, NULL);
-	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
-
-	force = flags & GGIT_CREATE_FORCE;
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
 
-	ret = git_tag_create (&oid,
-	                     _ggit_native_get (repository),
-	                     tag_name,
-	                     _ggit_native_get (target),
-	                     _ggit_native_get (tagger),
-	                     message,
-	                     force ? 1 : 0);
+	ret = git_repository_head_detached (_ggit_native_get (repository));
 
-	if (ret != GIT_OK)
+	if (ret < 0)
 	{
 		_ggit_error_set (error, ret);
-		return NULL;
 	}
 
-	return _ggit_oid_wrap (&oid);
+	return ret == 1;
 }
 
 /**
- * ggit_repository_create_tag_from_buffer:
+ * ggit_repository_is_head_unborn:
  * @repository: a #GgitRepository.
- * @tag: the tag buffer.
- * @flags: a #GgitCreateFlags.
  * @error: a #GError for error reporting, or %NULL.
  *
- * Create a new tag from a buffer describing the tag object. The buffer must
- * be correctly formatted.
+ * Checks if @repository's HEAD is an orphan.
  *
- * Returns: (transfer full) (nullable): the id to which the tag points, or
- *                                        %NULL in case of an error.
+ * An orphan branch is one named from HEAD but doesn't exist in
+ * the refs namespace, because it doesn't have any commit to point to.
  *
- **/
-GgitOId *
-ggit_repository_create_tag_from_buffer (GgitRepository   *repository,
-                                        const gchar      *tag,
-                                        GgitCreateFlags   flags,
-                                        GError          **error)
+ * Returns: %TRUE if the current branch is an orphan.
+ */
+gboolean
+ggit_repository_is_head_unborn (GgitRepository  *repository,
+                                GError         **error)
 {
-	git_oid oid;
-	gboolean force;
 	gint ret;
 
-	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
-	g_return_val_if_fail (tag != NULL, NULL);
-	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
-
-	force = flags & GGIT_CREATE_FORCE;
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
 
-	ret = git_tag_create_frombuffer (&oid,
-	                                 _ggit_native_get (repository),
-	                                 tag,
-	                                 force ? 1 : 0);
+	ret = git_repository_head_unborn (_ggit_native_get (repository));
 
-	if (ret != GIT_OK)
+	if (ret < 0)
 	{
 		_ggit_error_set (error, ret);
-		return NULL;
 	}
 
-	return _ggit_oid_wrap (&oid);
+	return ret == 1;
 }
 
 /**
- * ggit_repository_create_tag_lightweight:
+ * ggit_repository_is_empty:
  * @repository: a #GgitRepository.
- * @tag_name: the name of the tag.
- * @target: a #GgitObject.
- * @flags: a #GgitCreateFlags.
  * @error: a #GError for error reporting, or %NULL.
  *
- * Creates a new lightweight tag.
+ * Checks if @repository is empty.
  *
- * Returns: (transfer full) (nullable): the id to which the tag points, or
- *                                        %NULL in case of an error.
+ * An empty repository has just been initialized and contains
+ * no commits.
  *
- **/
-GgitOId *
-ggit_repository_create_tag_lightweight (GgitRepository   *repository,
-                                        const gchar      *tag_name,
-                                        GgitObject       *target,
-                                        GgitCreateFlags   flags,
-                                        GError          **error)
+ * Returns: %TRUE if the repository is empty.
+ */
+gboolean
+ggit_repository_is_empty (GgitRepository  *repository,
+                          GError         **error)
 {
-	gboolean force;
-	git_oid oid;
 	gint ret;
 
-	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
-	g_return_val_if_fail (tag_name != NULL, NULL);
-	g_return_val_if_fail (GGIT_IS_OBJECT (target), NULL);
-	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
-
-	force = flags & GGIT_CREATE_FORCE;
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
 
-	ret = git_tag_create_lightweight (&oid,
-	                                  _ggit_native_get (repository),
-	                                  tag_name,
-	                                  _ggit_native_get (target),
-	                                  force ? 1 : 0);
+	ret = git_repository_is_empty (_ggit_native_get (repository));
 
-	if (ret != GIT_OK)
+	if (ret < 0)
 	{
 		_ggit_error_set (error, ret);
-		return NULL;
 	}
 
-	return _ggit_oid_wrap (&oid);
+	return ret == 1;
 }
 
 /**
- * ggit_repository_create_tag_annotation:
+ * ggit_repository_get_location:
  * @repository: a #GgitRepository.
- * @tag_name: the name of the tag.
- * @target: a #GgitObject.
- * @signature: a #GgitObject.
- * @message: the tag message.
- * @error: a #GError for error reporting, or %NULL.
  *
- * Creates a new annotated tag.
- *
- * Returns: (transfer full) (nullable): the id to which the tag points, or
- *                                        %NULL in case of an error.
+ * Get the gitdir location of the repository.
  *
- **/
-GgitOId *
-ggit_repository_create_tag_annotation (GgitRepository  *repository,
-                                       const gchar     *tag_name,
-                                       GgitObject      *target,
-                                       GgitSignature   *signature,
-                                       const gchar     *message,
-                                       GError         **error)
+ * Returns: (transfer full) (nullable): the location of the gitdir of the repository.
+ */
+GFile *
+ggit_repository_get_location (GgitRepository *repository)
 {
-	git_oid oid;
-	gint ret;
+	const gchar *path;
 
 	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
-	g_return_val_if_fail (tag_name != NULL, NULL);
-	g_return_val_if_fail (GGIT_IS_OBJECT (target), NULL);
-	g_return_val_if_fail (GGIT_IS_SIGNATURE (signature), NULL);
-	g_return_val_if_fail (message != NULL, NULL);
-	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
-
-	ret = git_tag_annotation_create (&oid,
-	                                 _ggit_native_get (repository),
-	                                 tag_name,
-	                                 _ggit_native_get (target),
-	                                 _ggit_native_get (signature),
-	                                 message);
 
-	if (ret != GIT_OK)
-	{
-		_ggit_error_set (error, ret);
-		return NULL;
-	}
+	path = git_repository_path (_ggit_native_get (repository));
 
-	return _ggit_oid_wrap (&oid);
+	return path ? g_file_new_for_path (path) : NULL;
 }
 
 /**
- * ggit_repository_list_tags:
+ * ggit_repository_get_workdir:
  * @repository: a #GgitRepository.
- * @error: a #GError for error reporting, or %NULL.
  *
- * Fill a list with all the tags in the @repository.
+ * Gets the working directory of the repository.
  *
- * Returns: (transfer full) (nullable): a list with the tags in @repository.
- **/
-gchar **
-ggit_repository_list_tags (GgitRepository  *repository,
-                           GError         **error)
+ * Returns: (transfer full) (nullable): the location of the working directory of the repository.
+ */
+GFile *
+ggit_repository_get_workdir (GgitRepository *repository)
 {
-	gint ret;
-	git_strarray tag_names;
-	gchar **tags;
+	const gchar *path;
 
 	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
-	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
-
-	ret = git_tag_list (&tag_names,
-	                    _ggit_native_get (repository));
 
-	if (ret != GIT_OK)
-	{
-		_ggit_error_set (error, ret);
-		tags = NULL;
-	}
-	else
-	{
-		tags = ggit_utils_get_str_array_from_git_strarray (&tag_names);
-	}
+	path = git_repository_workdir (_ggit_native_get (repository));
 
-	return tags;
+	return path ? g_file_new_for_path (path) : NULL;
 }
 
 /**
- * ggit_repository_list_tags_match:
+ * ggit_repository_set_workdir:
  * @repository: a #GgitRepository.
- * @pattern: (allow-none): a pattern to match.
- * @error: a #GError for error reporting, or %NULL.
- *
- * Fill a list with all the tags in the @repository matching the provided
- * pattern. The pattern can use standard fnmatch syntax.
+ * @workdir: the working directory.
+ * @update_gitlink: create/update gitlink in workdir.
  *
- * Returns: (transfer full) (nullable): a list with matching tags in @repository.
- **/
-gchar **
-ggit_repository_list_tags_match (GgitRepository  *repository,
-                                 const gchar     *pattern,
-                                 GError         **error)
+ * Sets the working directory of the repository. If @update_gitlink is set to
+ * %TRUE "core.worktree" will be set in the config if workdir is not the parent
+ * of the .git directory).
+ */
+void
+ggit_repository_set_workdir (GgitRepository *repository,
+                             GFile          *workdir,
+                             gboolean        update_gitlink)
 {
-	gint ret;
-	git_strarray tag_names;
-	gchar **tags;
-
-	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
-	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+	g_return_if_fail (GGIT_IS_REPOSITORY (repository));
+	g_return_if_fail (G_IS_FILE (workdir));
 
-	ret = git_tag_list_match (&tag_names,
-	                          pattern ? pattern : "",
-	                          _ggit_native_get (repository));
+	set_workdir (repository, workdir, update_gitlink);
+}
 
-	if (ret != GIT_OK)
-	{
-		_ggit_error_set (error, ret);
-		tags = NULL;
-	}
-	else
-	{
-		tags = ggit_utils_get_str_array_from_git_strarray (&tag_names);
-	}
+/**
+ * ggit_repository_is_bare:
+ * @repository: a #GgitRepository.
+ *
+ * Checks if @repository is bare.
+ *
+ * Returns: %TRUE if the repository is empty.
+ */
+gboolean
+ggit_repository_is_bare (GgitRepository *repository)
+{
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), FALSE);
 
-	return tags;
+	return git_repository_is_bare (_ggit_native_get (repository));
 }
 
 /**
- * ggit_repository_delete_tag:
+ * ggit_repository_file_status:
  * @repository: a #GgitRepository.
- * @name: the name of the tag.
- * @error: a #GError.
+ * @location: the file to retrieve status for, rooted at the repository working dir.
+ * @error: a #GError for error reporting, or %NULL.
  *
- * Delete an existing tag reference by name.
+ * Gets the file status for a single file.
  *
- * Returns: %TRUE if the tag was deleted successfully, %FALSE otherwise.
- **/
-gboolean
-ggit_repository_delete_tag (GgitRepository  *repository,
-                            gchar const     *name,
-                            GError         **error)
+ * Returns: the status for a single file.
+ */
+GgitStatusFlags
+ggit_repository_file_status (GgitRepository  *repository,
+                             GFile           *location,
+                             GError         **error)
 {
+	GgitRepositoryPrivate *priv;
+	GgitStatusFlags status_flags;
 	gint ret;
+	gchar *path;
 
-	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), FALSE);
-	g_return_val_if_fail (name != NULL, FALSE);
-	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), GGIT_STATUS_IGNORED);
+	g_return_val_if_fail (G_IS_FILE (location), GGIT_STATUS_IGNORED);
+	g_return_val_if_fail (error == NULL || *error == NULL, GGIT_STATUS_IGNORED);
 
-	ret = git_tag_delete (_ggit_native_get (repository), name);
+	priv = ggit_repository_get_instance_private (repository);
+
+	path = g_file_get_relative_path (priv->workdir, location);
+
+	g_return_val_if_fail (path != NULL, GGIT_STATUS_IGNORED);
+
+	ret = git_status_file (&status_flags,
+	                       _ggit_native_get (repository),
+	                       path);
+
+	g_free (path);
 
 	if (ret != GIT_OK)
 	{
 		_ggit_error_set (error, ret);
-		return FALSE;
-	}
-	else
-	{
-		return TRUE;
 	}
-}
 
-typedef struct
-{
-	gpointer user_data;
-
-	GgitTagCallback callback;
-} TagCallbackWrapperData;
-
-static gint
-tag_callback_wrapper (const gchar *name,
-                      git_oid     *tag_oid,
-                      gpointer     user_data)
-{
-	TagCallbackWrapperData *wrapper_data = (TagCallbackWrapperData *)user_data;
-	GgitOId *oid;
-	gint ret;
-
-	oid = _ggit_oid_wrap (tag_oid);
-
-	ret = wrapper_data->callback (name, oid, wrapper_data->user_data);
-	ggit_oid_free (oid);
-
-	return ret;
+	return status_flags;
 }
 
 /**
- * ggit_repository_tag_foreach:
+ * ggit_repository_file_status_foreach:
  * @repository: a #GgitRepository.
- * @callback: (scope call): a #GgitTagCallback.
+ * @options: (allow-none): status options, or %NULL.
+ * @callback: (scope call): a #GgitStatusCallback.
  * @user_data: callback user data.
  * @error: a #GError for error reporting, or %NULL.
  *
- * Get all the tags in the repository and run the provided callback on each. If
- * the callback returns something other than 0, the iteration will stop and
- * @error will be set.
+ * Gathers file statuses and run a callback for each one.
+ *
+ * To the callback is passed the path of the file, the status and the data pointer
+ * passed to this function. If the callback returns something other than
+ * 0, the iteration will stop and @error will be set.
+ *
+ * Set @options to %NULL to get the default status options.
  *
  * Returns: %TRUE if there was no error, %FALSE otherwise
- **/
+ *
+ */
 gboolean
-ggit_repository_tag_foreach (GgitRepository   *repository,
-                             GgitTagCallback   callback,
-                             gpointer          user_data,
-                             GError          **error)
+ggit_repository_file_status_foreach (GgitRepository     *repository,
+                                     GgitStatusOptions  *options,
+                                     GgitStatusCallback  callback,
+                                     gpointer            user_data,
+                                     GError            **error)
 {
-	TagCallbackWrapperData wrapper_data;
 	gint ret;
 
 	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), FALSE);
 	g_return_val_if_fail (callback != NULL, FALSE);
 	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
 
-	wrapper_data.user_data = user_data;
-	wrapper_data.callback = callback;
-
-	ret = git_tag_foreach (_ggit_native_get (repository),
-	                       tag_callback_wrapper,
-	                       &wrapper_data);
+	ret = git_status_foreach_ext (_ggit_native_get (repository),
+	                              _ggit_status_options_get_status_options (options),
+	                              callback,
+	                              user_data);
 
 	if (ret != GIT_OK)
 	{
@@ -1854,364 +2513,391 @@ ggit_repository_tag_foreach (GgitRepository   *repository,
 	return TRUE;
 }
 
-/**
- * ggit_repository_create_branch:
- * @repository: a #GgitRepository.
- * @branch_name: the name of the branch.
- * @target: a #GgitObject.
- * @flags: a #GgitCreateFlags.
- * @error: a #GError for error reporting, or %NULL.
- *
- * Creates a new branch pointing at a target commit.
- *
- * Returns: (transfer full) (nullable): the reference to which the branch
- *                                        points, or %NULL in case of an error.
- **/
-GgitBranch *
-ggit_repository_create_branch (GgitRepository   *repository,
-                               const gchar      *branch_name,
-                               GgitObject       *target,
-                               GgitCreateFlags   flags,
-                               GError          **error)
+typedef struct
 {
-	gboolean force;
-	git_reference *reference;
-	gint ret;
+	GgitStatusOptions *options;
+	GHashTable *statuses;
+} StatusForeachData;
 
-	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
-	g_return_val_if_fail (branch_name != NULL, NULL);
-	g_return_val_if_fail (GGIT_IS_OBJECT (target), NULL);
-	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+static void
+status_foreach_data_free (StatusForeachData *data)
+{
+	if (data->options != NULL)
+	{
+		ggit_status_options_free (data->options);
+	}
 
-	force = flags & GGIT_CREATE_FORCE;
+	g_hash_table_unref (data->statuses);
+	g_slice_free (StatusForeachData, data);
+}
 
-	ret = git_branch_create (&reference,
-	                         _ggit_native_get (repository),
-	                         branch_name,
-	                         _ggit_native_get (target),
-	                         force ? 1 : 0);
+static gint
+status_foreach_collect (const gchar *path,
+                        guint        status_flags,
+                        gpointer     payload)
+{
+	GTask *task = payload;
+	StatusForeachData *data = g_task_get_task_data (task);
 
-	if (ret != GIT_OK)
+	if (g_cancellable_is_cancelled (g_task_get_cancellable (task)))
 	{
-		_ggit_error_set (error, ret);
-		return NULL;
+		return GIT_EUSER;
 	}
 
-	return _ggit_branch_wrap (reference);
+	g_hash_table_insert (data->statuses,
+	                     g_strdup (path),
+	                     GUINT_TO_POINTER (status_flags));
+
+	return GIT_OK;
 }
 
-/**
- * ggit_repository_enumerate_branches:
- * @repository: a #GgitRepository.
- * @list_type: a #GgitBranchType.
- * @error: a #GError for error reporting, or %NULL.
- *
- * Get a branch enumerator to enumerate over all branches of the specified
- * @list_type in @repository.
- *
- * Returns: (transfer full) (nullable): a branch enumerator.
- **/
-GgitBranchEnumerator *
-ggit_repository_enumerate_branches (GgitRepository  *repository,
-                                    GgitBranchType   list_type,
-                                    GError         **error)
+static void
+status_foreach_thread (GTask        *task,
+                       gpointer      source_object,
+                       gpointer      task_data,
+                       GCancellable *cancellable)
 {
-	git_branch_iterator *iter;
+	StatusForeachData *data = task_data;
+	GgitRepository *worker;
+	GError *error = NULL;
 	gint ret;
 
-	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
-	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+	if (g_task_return_error_if_cancelled (task))
+	{
+		return;
+	}
 
-	ret = git_branch_iterator_new (&iter,
-	                               _ggit_native_get (repository),
-	                               (git_branch_t)list_type);
+	/* Run on a handle of our own so that the repository stays usable,
+	 * and other async operations can run, while we gather the statuses.
+	 */
+	worker = _ggit_repository_open_worker (source_object, &error);
 
-	if (ret != GIT_OK)
+	if (worker == NULL)
 	{
-		_ggit_error_set (error, ret);
-		return NULL;
+		g_task_return_error (task, error);
+		return;
 	}
 
-	return _ggit_branch_enumerator_wrap (iter);
+	ret = git_status_foreach_ext (_ggit_native_get (worker),
+	                              _ggit_status_options_get_status_options (data->options),
+	                              status_foreach_collect,
+	                              task);
+
+	g_object_unref (worker);
+
+	if (ret != GIT_OK)
+	{
+		set_error_cancellable (&error, ret, cancellable);
+		g_task_return_error (task, error);
+	}
+	else
+	{
+		g_task_return_pointer (task,
+		                       g_hash_table_ref (data->statuses),
+		                       (GDestroyNotify)g_hash_table_unref);
+	}
 }
 
 /**
- * ggit_repository_lookup_branch:
+ * ggit_repository_file_status_foreach_async:
  * @repository: a #GgitRepository.
- * @branch_name: the name of the branch.
- * @branch_type: a #GgitBranchType.
- * @error: a #GError for error reporting, or %NULL.
+ * @options: (allow-none): status options, or %NULL.
+ * @cancellable: (allow-none): a #GCancellable or %NULL.
+ * @callback: (scope async): a #GAsyncReadyCallback to call when the
+ *            statuses have been gathered.
+ * @user_data: (closure): the data to pass to @callback.
  *
- * Lookups a branch by its name in a repository.
+ * Asynchronously gathers file statuses on a worker thread. Use
+ * ggit_repository_file_status_foreach_finish() to retrieve the result.
  *
- * Returns: (transfer full) (nullable): a branch by its name in a repository.
+ * The statuses are gathered on a separate handle on the repository, so
+ * @repository can be used, and other asynchronous operations can run,
+ * in the meantime. That handle is opened from disk and does not see
+ * object database backends added to @repository.
+ *
+ * Set @options to %NULL to get the default status options.
  */
-GgitBranch *
-ggit_repository_lookup_branch (GgitRepository *repository,
-                               const gchar    *branch_name,
-                               GgitBranchType  branch_type,
-                               GError         **error)
+void
+ggit_repository_file_status_foreach_async (GgitRepository      *repository,
+                                           GgitStatusOptions   *options,
+                                           GCancellable        *cancellable,
+                                           GAsyncReadyCallback  callback,
+                                           gpointer             user_data)
 {
-	gint ret;
-	git_reference *branch;
+	StatusForeachData *data;
+	GTask *task;
 
-	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
-	g_return_val_if_fail (branch_name != NULL, NULL);
-	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+	g_return_if_fail (GGIT_IS_REPOSITORY (repository));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
 
-	ret = git_branch_lookup (&branch,
-	                         _ggit_native_get (repository),
-	                         branch_name,
-	                         (git_branch_t)branch_type);
+	data = g_slice_new0 (StatusForeachData);
 
-	if (ret != GIT_OK)
+	if (options != NULL)
 	{
-		_ggit_error_set (error, ret);
-		return NULL;
+		data->options = ggit_status_options_copy (options);
 	}
 
-	return _ggit_branch_wrap (branch);
+	data->statuses = g_hash_table_new_full (g_str_hash,
+	                                        g_str_equal,
+	                                        g_free,
+	                                        NULL);
+
+	task = g_task_new (repository, cancellable, callback, user_data);
+	g_task_set_source_tag (task, ggit_repository_file_status_foreach_async);
+	g_task_set_task_data (task,
+	                      data,
+	                      (GDestroyNotify)status_foreach_data_free);
+
+	g_task_run_in_thread (task, status_foreach_thread);
+	g_object_unref (task);
 }
 
 /**
- * ggit_repository_lookup_blob:
+ * ggit_repository_file_status_foreach_finish:
  * @repository: a #GgitRepository.
- * @oid: a #GgitOId.
+ * @result: a #GAsyncResult.
  * @error: a #GError for error reporting, or %NULL.
  *
- * Lookups a branch by its name in a repository.
+ * Finishes an operation started with
+ * ggit_repository_file_status_foreach_async().
  *
- * Returns: (transfer full) (nullable): a #GgitBlog pointer.
+ * Returns: (transfer full) (element-type utf8 guint) (nullable): a
+ *          #GHashTable mapping paths to their #GgitStatusFlags, or %NULL
+ *          if there was an error.
  */
-GgitBlob *
-ggit_repository_lookup_blob (GgitRepository *repository,
-                             GgitOId        *oid,
-                             GError         **error)
+GHashTable *
+ggit_repository_file_status_foreach_finish (GgitRepository  *repository,
+                                            GAsyncResult    *result,
+                                            GError         **error)
 {
-	gint ret;
-	git_blob *blob;
-	const git_oid *id;
-
 	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
+	g_return_val_if_fail (g_task_is_valid (result, repository), NULL);
 	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
-	id = (const git_oid *)_ggit_oid_get_oid (oid);
-	ret = git_blob_lookup (&blob,
-	                       _ggit_native_get (repository),
-	                       id);
+	return g_task_propagate_pointer (G_TASK (result), error);
+}
 
-	if (ret != GIT_OK)
+typedef struct
+{
+	GAsyncQueue *repositories;
+	GAsyncQueue *results;
+	git_status_options options;
+	GgitUntrackedCache *cache;
+} StatusParallelData;
+
+typedef struct
+{
+	/* the top-level directory, or NULL for the top-level files */
+	gchar *directory;
+	GPtrArray *pathspec;
+
+	/* the stamps of a directory that was not cached */
+	GArray *stamps;
+	gboolean cached;
+
+	GArray *entries;
+	GArray *untracked;
+	GError *error;
+} StatusPartition;
+
+static StatusPartition *
+status_partition_new (const gchar *directory)
+{
+	StatusPartition *partition;
+
+	partition = g_slice_new0 (StatusPartition);
+	partition->directory = g_strdup (directory);
+	partition->pathspec = g_ptr_array_new_with_free_func (g_free);
+	partition->entries = _ggit_untracked_entries_new ();
+
+	if (directory != NULL)
 	{
-		_ggit_error_set (error, ret);
-		return NULL;
+		g_ptr_array_add (partition->pathspec, g_strdup (directory));
 	}
 
-	return _ggit_blob_wrap (blob, TRUE);
+	return partition;
 }
 
-/**
- * ggit_repository_lookup_commit:
- * @repository: a #GgitRepository.
- * @oid: a #GgitOId.
- * @error: a #GError for error reporting, or %NULL.
- *
- * Lookups a branch by its name in a repository.
- *
- * Returns: (transfer full) (nullable): a #GgitCommit pointer.
- */
-GgitCommit *
-ggit_repository_lookup_commit (GgitRepository *repository,
-                               GgitOId        *oid,
-                               GError         **error)
+static void
+status_partition_free (StatusPartition *partition)
 {
-	gint ret;
-	git_commit *commit;
-	const git_oid *id;
-
-	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
-	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+	g_free (partition->directory);
+	g_ptr_array_unref (partition->pathspec);
+	g_array_unref (partition->entries);
 
-	id = (const git_oid *)_ggit_oid_get_oid (oid);
-	ret = git_commit_lookup (&commit,
-	                         _ggit_native_get (repository),
-	                         id);
+	if (partition->stamps != NULL)
+	{
+		g_array_unref (partition->stamps);
+	}
 
-	if (ret != GIT_OK)
+	if (partition->untracked != NULL)
 	{
-		_ggit_error_set (error, ret);
-		return NULL;
+		g_array_unref (partition->untracked);
 	}
 
-	return _ggit_commit_wrap (commit, TRUE);
+	g_clear_error (&partition->error);
+	g_slice_free (StatusPartition, partition);
 }
 
-/**
- * ggit_repository_lookup_tag:
- * @repository: a #GgitRepository.
- * @oid: a #GgitOId.
- * @error: a #GError for error reporting, or %NULL.
- *
- * Lookups a branch by its name in a repository.
- *
- * Returns: (transfer full) (nullable): a #GgitTag pointer.
- */
-GgitTag *
-ggit_repository_lookup_tag (GgitRepository *repository,
-                            GgitOId        *oid,
-                            GError         **error)
+static gint
+status_partition_collect (const gchar *path,
+                          guint        status_flags,
+                          gpointer     payload)
 {
-	gint ret;
-	git_tag *tag;
-	const git_oid *id;
+	StatusPartition *partition = payload;
+	GgitUntrackedEntry entry;
 
-	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
-	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
-
-	id = (const git_oid *)_ggit_oid_get_oid (oid);
-	ret = git_tag_lookup (&tag,
-	                      _ggit_native_get (repository),
-	                      id);
+	entry.path = g_strdup (path);
+	entry.status = status_flags;
+	g_array_append_val (partition->entries, entry);
 
-	if (ret != GIT_OK)
+	if (partition->untracked != NULL &&
+	    (status_flags == GIT_STATUS_WT_NEW || status_flags == GIT_STATUS_IGNORED))
 	{
-		_ggit_error_set (error, ret);
-		return NULL;
+		entry.path = g_strdup (path);
+		g_array_append_val (partition->untracked, entry);
 	}
 
-	return _ggit_tag_wrap (tag, TRUE);
+	return GIT_OK;
 }
 
-/**
- * ggit_repository_lookup_tree:
- * @repository: a #GgitRepository.
- * @oid: a #GgitOId.
- * @error: a #GError for error reporting, or %NULL.
- *
- * Lookups a branch by its name in a repository.
- *
- * Returns: (transfer full) (nullable): a #GgitTree pointer.
- */
-GgitTree *
-ggit_repository_lookup_tree (GgitRepository *repository,
-                             GgitOId        *oid,
-                             GError         **error)
+static void
+status_partition_worker (gpointer data,
+                         gpointer user_data)
 {
+	StatusPartition *partition = data;
+	StatusParallelData *parallel = user_data;
+	GgitRepository *repository;
+	git_repository *repo;
+	git_status_options options;
+	GArray *cached = NULL;
 	gint ret;
-	git_tree *tree;
-	const git_oid *id;
 
-	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
-	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+	repository = g_async_queue_pop (parallel->repositories);
+	repo = _ggit_native_get (repository);
 
-	id = (const git_oid *)_ggit_oid_get_oid (oid);
-	ret = git_tree_lookup (&tree,
-	                       _ggit_native_get (repository),
-	                       id);
+	options = parallel->options;
+	options.pathspec.strings = (gchar **)partition->pathspec->pdata;
+	options.pathspec.count = partition->pathspec->len;
+
+	if (parallel->cache != NULL && partition->directory != NULL)
+	{
+		cached = _ggit_untracked_cache_lookup (parallel->cache,
+		                                       repo,
+		                                       partition->directory);
+
+		if (cached != NULL)
+		{
+			/* only look for changes to the tracked files */
+			options.flags &= ~(GIT_STATUS_OPT_INCLUDE_UNTRACKED |
+			                   GIT_STATUS_OPT_INCLUDE_IGNORED);
+			partition->cached = TRUE;
+		}
+		else
+		{
+			/* stamped before the scan, so that changes made during it
+			 * invalidate the cache */
+			partition->stamps =
+				_ggit_untracked_cache_stamp_directory (repo,
+				                                       partition->directory,
+				                                       options.flags & GIT_STATUS_OPT_RECURSE_IGNORED_DIRS);
+			partition->untracked = _ggit_untracked_entries_new ();
+		}
+	}
+
+	ret = git_status_foreach_ext (repo, &options, status_partition_collect, partition);
 
 	if (ret != GIT_OK)
 	{
-		_ggit_error_set (error, ret);
-		return NULL;
+		/* libgit2 errors are per thread, so collect it here */
+		_ggit_error_set (&partition->error, ret);
 	}
+	else if (cached != NULL)
+	{
+		guint i;
 
-	return _ggit_tree_wrap (tree, TRUE);
-}
+		for (i = 0; i < cached->len; ++i)
+		{
+			GgitUntrackedEntry entry = g_array_index (cached, GgitUntrackedEntry, i);
 
-/**
- * ggit_repository_lookup_remote:
- * @repository: a #GgitRepository.
- * @name: the remote's name.
- * @error: a #GError for error reporting, or %NULL.
- *
- * Gets the remote called @name.
- *
- * Returns: (transfer full) (nullable): a new #GgitRemote or %NULL if there is an error.
- */
-GgitRemote *
-ggit_repository_lookup_remote (GgitRepository  *repository,
-                               const gchar     *name,
-                               GError         **error)
-{
-	gint ret;
-	git_remote *remote;
+			entry.path = g_strdup (entry.path);
+			g_array_append_val (partition->entries, entry);
+		}
+	}
 
-	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
-	g_return_val_if_fail (name != NULL, NULL);
-	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+	g_async_queue_push (parallel->repositories, repository);
+	g_async_queue_push (parallel->results, partition);
+}
 
-	ret = git_remote_lookup (&remote,
-	                       _ggit_native_get (repository),
-	                       name);
+static void
+add_partition_name (GHashTable  *names,
+                    const gchar *path,
+                    gboolean     is_directory)
+{
+	const gchar *slash = strchr (path, '/');
 
-	if (ret != GIT_OK)
+	if (slash != NULL)
 	{
-		_ggit_error_set (error, ret);
-		return NULL;
+		g_hash_table_insert (names, g_strndup (path, slash - path), GINT_TO_POINTER (TRUE));
+	}
+	else if (is_directory || !g_hash_table_contains (names, path))
+	{
+		g_hash_table_insert (names, g_strdup (path), GINT_TO_POINTER (is_directory));
 	}
-
-	return _ggit_remote_wrap (remote);
 }
 
-/**
- * ggit_repository_create_remote:
- * @repository: a #GgitRepository.
- * @name: the name of the new remote.
- * @url: the url of the remote.
- * @error: a #GError for error reporting, or %NULL.
- *
- * Adds a remote with the default fetch refspec to the repository's configuration.
- *
- * Returns: (transfer full) (nullable): a new #GgitRemote or %NULL if there is an error.
- */
-GgitRemote *
-ggit_repository_create_remote (GgitRepository  *repository,
-                               const gchar     *name,
-                               const gchar     *url,
-                               GError         **error)
+static gboolean
+collect_partition_names (GgitRepository  *repository,
+                         GHashTable      *names,
+                         GError         **error)
 {
+	git_repository *repo = _ggit_native_get (repository);
+	git_index *index;
+	git_object *head;
+	GDir *dir;
+	const gchar *name;
+	gsize i;
 	gint ret;
-	git_remote *remote;
 
-	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
-	g_return_val_if_fail (name != NULL, NULL);
-	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+	/* the working directory */
+	dir = g_dir_open (git_repository_workdir (repo), 0, error);
 
-	ret = git_remote_create (&remote,
-	                         _ggit_native_get (repository),
-	                         name,
-	                         url);
+	if (dir == NULL)
+	{
+		return FALSE;
+	}
 
-	if (ret != GIT_OK)
+	while ((name = g_dir_read_name (dir)) != NULL)
 	{
-		_ggit_error_set (error, ret);
-		return NULL;
+		gchar *filename;
+
+		if (strcmp (name, ".git") == 0)
+		{
+			continue;
+		}
+
+		filename = g_build_filename (git_repository_workdir (repo), name, NULL);
+		add_partition_name (names, name, g_file_test (filename, G_FILE_TEST_IS_DIR) &&
+		                                 !g_file_test (filename, G_FILE_TEST_IS_SYMLINK));
+		g_free (filename);
 	}
 
-	return _ggit_remote_wrap (remote);
-}
+	g_dir_close (dir);
 
-/**
- * ggit_repository_remove_remote:
- * @repository: a #GgitRepository.
- * @name: the remote's name.
- * @error: a #GError for error reporting, or %NULL.
- *
- * Removes @remote from the @repository.
- *
- * Returns: %TRUE if there was no error, %FALSE otherwise
- */
-gboolean
-ggit_repository_remove_remote (GgitRepository   *repository,
-                               const gchar      *name,
-                               GError          **error)
-{
-	gint ret;
+	/* the index, for the deleted files */
+	ret = git_repository_index (&index, repo);
 
-	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), FALSE);
-	g_return_val_if_fail (name != NULL, FALSE);
+	if (ret == GIT_OK)
+	{
+		ret = git_index_read (index, FALSE);
 
-	ret = git_remote_delete (_ggit_native_get (repository),
-	                         name);
+		for (i = 0; ret == GIT_OK && i < git_index_entrycount (index); ++i)
+		{
+			add_partition_name (names, git_index_get_byindex (index, i)->path, FALSE);
+		}
+
+		git_index_free (index);
+	}
 
 	if (ret != GIT_OK)
 	{
@@ -2219,37 +2905,25 @@ ggit_repository_remove_remote (GgitRepository   *repository,
 		return FALSE;
 	}
 
-	return TRUE;
-}
+	/* and HEAD, for the files deleted from the index */
+	ret = git_revparse_single (&head, repo, "HEAD^{tree}");
 
-/**
- * ggit_repository_set_remote_url:
- * @repository: a #GgitRepository.
- * @remote: the remote name who's url is to be set.
- * @url: url of the remote.
- * @error: a #GError for error reporting, or %NULL.
- *
- * Sets url for the @remote from the @repository.
- *
- * Returns: %TRUE if there was no error, %FALSE otherwise
- */
-gboolean
-ggit_repository_set_remote_url (GgitRepository   *repository,
-                                const gchar      *remote,
-                                const gchar      *url,
-                                GError          **error)
-{
-	gint ret;
+	if (ret == GIT_OK)
+	{
+		git_tree *tree = (git_tree *)head;
 
-	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), FALSE);
-	g_return_val_if_fail (remote != NULL, FALSE);
-	g_return_val_if_fail (url != NULL, FALSE);
+		for (i = 0; i < git_tree_entrycount (tree); ++i)
+		{
+			const git_tree_entry *entry = git_tree_entry_byindex (tree, i);
 
-	ret = git_remote_set_url(_ggit_native_get (repository),
-	                                           remote,
-	                                           url);
+			add_partition_name (names,
+			                    git_tree_entry_name (entry),
+			                    git_tree_entry_type (entry) == GIT_OBJ_TREE);
+		}
 
-	if (ret != GIT_OK)
+		git_object_free (head);
+	}
+	else if (ret != GIT_ENOTFOUND && ret != GIT_EUNBORNBRANCH)
 	{
 		_ggit_error_set (error, ret);
 		return FALSE;
@@ -2258,251 +2932,332 @@ ggit_repository_set_remote_url (GgitRepository   *repository,
 	return TRUE;
 }
 
+static gint
+compare_status_entries (gconstpointer a,
+                        gconstpointer b)
+{
+	return strcmp (((const GgitUntrackedEntry *)a)->path,
+	               ((const GgitUntrackedEntry *)b)->path);
+}
+
 /**
- * ggit_repository_rename_remote:
+ * ggit_repository_file_status_foreach_parallel:
  * @repository: a #GgitRepository.
- * @name: the remote name to be renamed.
- * @new_name: new name of the remote.
+ * @options: (allow-none): status options, or %NULL.
+ * @n_threads: the number of worker threads, or 0 to use one per processor.
+ * @use_untracked_cache: whether to use and update the untracked cache.
+ * @callback: (scope call): a #GgitStatusCallback.
+ * @user_data: callback user data.
  * @error: a #GError for error reporting, or %NULL.
  *
- * Rename the remote of @repository from @name to @new_name.
+ * Gathers file statuses like ggit_repository_file_status_foreach(), but
+ * scans each top-level directory of the working directory on a pool of
+ * @n_threads worker threads, each with its own handle on the repository.
+ * @callback is called on the calling thread, in path order, once all the
+ * statuses have been gathered.
+ *
+ * If @use_untracked_cache is %TRUE, the untracked and ignored files found
+ * below each top-level directory are saved in the repository directory,
+ * along with the modification time of each directory and ignore file below
+ * it. On the next call, these are checked with one stat each, without
+ * listing the directories again. If none changed, the untracked and ignored
+ * files come from the cache and only the tracked files are checked, so
+ * libgit2 still lists the directories that hold tracked files but skips the
+ * untracked and ignored ones. The whole cache is invalidated when the
+ * index, the global ignore rules or @options change.
+ *
+ * Rename detection is not supported and the rename options of @options
+ * are ignored. If @options has a pathspec, the statuses are gathered
+ * serially without the cache.
+ *
+ * Returns: %TRUE if there was no error, %FALSE otherwise.
  *
- * Returns: (transfer full) (nullable): non-default refspecs that
- * cannot be renamed.
  */
-gchar **
-ggit_repository_rename_remote (GgitRepository   *repository,
-                               const gchar      *name,
-                               const gchar      *new_name,
-                               GError          **error)
+gboolean
+ggit_repository_file_status_foreach_parallel (GgitRepository      *repository,
+                                              GgitStatusOptions   *options,
+                                              gint                 n_threads,
+                                              gboolean             use_untracked_cache,
+                                              GgitStatusCallback   callback,
+                                              gpointer             user_data,
+                                              GError             **error)
 {
-	gint ret;
-	git_strarray problems;
+	git_repository *repo;
+	const git_status_options *user_options;
+	StatusParallelData parallel;
+	GThreadPool *pool = NULL;
+	GHashTable *names;
+	GHashTableIter iter;
+	gpointer key;
+	gpointer value;
+	GPtrArray *partitions;
+	StatusPartition *files = NULL;
+	GArray *entries;
+	GgitUntrackedCache *updated = NULL;
+	gchar *cache_filename = NULL;
+	gboolean ret = TRUE;
+	guint i;
 
-	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
-	g_return_val_if_fail (name != NULL, NULL);
-	g_return_val_if_fail (new_name != NULL, NULL);
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), FALSE);
+	g_return_val_if_fail (callback != NULL, FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
 
-	ret = git_remote_rename (&problems,
-	                         _ggit_native_get (repository),
-	                         name,
-	                         new_name);
+	repo = _ggit_native_get (repository);
+	user_options = _ggit_status_options_get_status_options (options);
 
-	if (ret != GIT_OK)
+	if (git_repository_is_bare (repo) ||
+	    (user_options != NULL && user_options->pathspec.count > 0))
 	{
-		_ggit_error_set (error, ret);
-		return NULL;
+		return ggit_repository_file_status_foreach (repository,
+		                                            options,
+		                                            callback,
+		                                            user_data,
+		                                            error);
 	}
 
-	return ggit_utils_get_str_array_from_git_strarray (&problems);
-}
-
-/**
- * ggit_repository_list_remotes:
- * @repository: a #GgitRepository.
- * @error: a #GError for error reporting, or %NULL.
- *
- * Fill a list with all the remotes in @repository.
- *
- * Returns: (transfer full) (nullable): a list with the remotes.
- **/
-gchar **
-ggit_repository_list_remotes (GgitRepository  *repository,
-                              GError         **error)
-{
-	gint ret;
-	git_strarray remote_names;
-	gchar **remotes;
-
-	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
-	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
-
-	ret = git_remote_list (&remote_names,
-	                       _ggit_native_get (repository));
+	git_status_init_options (&parallel.options, GIT_STATUS_OPTIONS_VERSION);
 
-	if (ret != GIT_OK)
+	if (user_options != NULL)
 	{
-		_ggit_error_set (error, ret);
-		remotes = NULL;
+		parallel.options = *user_options;
 	}
 	else
 	{
-		remotes = ggit_utils_get_str_array_from_git_strarray (&remote_names);
+		parallel.options.flags = GIT_STATUS_OPT_DEFAULTS;
 	}
 
-	return remotes;
-}
+	/* renames pair paths of different directories */
+	parallel.options.flags &= ~(GIT_STATUS_OPT_RENAMES_HEAD_TO_INDEX |
+	                            GIT_STATUS_OPT_RENAMES_INDEX_TO_WORKDIR |
+	                            GIT_STATUS_OPT_RENAMES_FROM_REWRITES);
+	parallel.options.flags |= GIT_STATUS_OPT_DISABLE_PATHSPEC_MATCH;
 
-/**
- * ggit_repository_add_remote_push:
- * @repository: a #GgitRepository.
- * @remote: a #GgitRemote.
- * @refspec: the push refspec.
- * @error: a #GError for error reporting, or %NULL.
- *
- * Adds a push refspec to @remote's configuration.
- * Adds the given refspec to the push list in the configuration. No
- * loaded remote instances will be affected.
- */
-void
-ggit_repository_add_remote_push (GgitRepository  *repository,
-                                 GgitRemote      *remote,
-                                 const gchar     *refspec,
-                                 GError         **error)
-{
-	gint ret;
+	names = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
 
-	g_return_if_fail (GGIT_IS_REMOTE (remote));
-	g_return_if_fail (refspec != NULL && refspec[0] != '\0');
-	g_return_if_fail (error == NULL || *error == NULL);
+	if (!collect_partition_names (repository, names, error))
+	{
+		g_hash_table_unref (names);
+		return FALSE;
+	}
 
-	ret = git_remote_add_push (_ggit_native_get (repository),
-	                           ggit_remote_get_name (remote),
-	                           refspec);
+	partitions = g_ptr_array_new_with_free_func ((GDestroyNotify)status_partition_free);
+	g_hash_table_iter_init (&iter, names);
 
-	if (ret != GIT_OK)
+	while (g_hash_table_iter_next (&iter, &key, &value))
 	{
-		_ggit_error_set (error, ret);
+		if (GPOINTER_TO_INT (value))
+		{
+			g_ptr_array_add (partitions, status_partition_new (key));
+		}
+		else
+		{
+			if (files == NULL)
+			{
+				files = status_partition_new (NULL);
+				g_ptr_array_add (partitions, files);
+			}
+
+			g_ptr_array_add (files->pathspec, g_strdup (key));
+		}
 	}
-}
 
-/**
- * ggit_repository_add_remote_fetch:
- * @repository: a #GgitRepository.
- * @remote: a #GgitRemote.
- * @refspec: the fetch refspec.
- * @error: a #GError for error reporting, or %NULL.
- *
- * Adds a fetch refspec to the @remote's configuration.
- * Adds @refspec to the fetch list in the configuration. No
- * loaded remote instances will be affected.
- */
-void
-ggit_repository_add_remote_fetch (GgitRepository  *repository,
-                                  GgitRemote      *remote,
-                                  const gchar     *refspec,
-                                  GError         **error)
-{
-	gint ret;
+	g_hash_table_unref (names);
 
-	g_return_if_fail (GGIT_IS_REMOTE (remote));
-	g_return_if_fail (refspec != NULL && refspec[0] != '\0');
-	g_return_if_fail (error == NULL || *error == NULL);
+	parallel.cache = NULL;
 
-	ret = git_remote_add_fetch (_ggit_native_get (repository),
-	                            _ggit_native_get (remote),
-	                            refspec);
+	if (use_untracked_cache)
+	{
+		guint64 stamp;
 
-	if (ret != GIT_OK)
+		stamp = _ggit_untracked_cache_stamp_repository (repo, &parallel.options);
+		cache_filename = g_build_filename (git_repository_path (repo),
+		                                   "ggit-untracked-cache",
+		                                   NULL);
+
+		parallel.cache = _ggit_untracked_cache_load (cache_filename, stamp);
+		updated = _ggit_untracked_cache_new (stamp);
+	}
+
+	if (n_threads <= 0)
 	{
-		_ggit_error_set (error, ret);
+		n_threads = g_get_num_processors ();
 	}
-}
 
-/**
- * ggit_repository_lookup_submodule:
- * @repository: a #GgitRepository.
- * @name: the name of the submodule.
- * @error: a #GError for error reporting, or %NULL.
- *
- * Lookups a submodule information by name or path. If the submodule
- * does not exist, %NULL is returned and a GGIT_ERROR_NOTFOUND error set.
- *
- * Returns: (transfer full) (nullable): a newly-allocated #GgitSubmodule.
- */
-GgitSubmodule *
-ggit_repository_lookup_submodule (GgitRepository  *repository,
-                                  const gchar     *name,
-                                  GError         **error)
-{
-	GgitSubmodule *gsubmodule = NULL;
-	gint ret;
-	git_submodule *submodule;
+	parallel.results = g_async_queue_new ();
 
-	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
-	g_return_val_if_fail (name != NULL, NULL);
-	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+	if (partitions->len > 1)
+	{
+		parallel.repositories = _ggit_repository_open_workers (repository, n_threads);
+		n_threads = g_async_queue_length (parallel.repositories);
 
-	ret = git_submodule_lookup (&submodule,
-	                            _ggit_native_get (repository),
-	                            name);
+		if (n_threads > 0)
+		{
+			pool = g_thread_pool_new (status_partition_worker,
+			                          &parallel,
+			                          n_threads,
+			                          FALSE,
+			                          NULL);
+		}
+	}
+	else
+	{
+		parallel.repositories = g_async_queue_new_full (g_object_unref);
+	}
 
-	if (ret == GIT_OK)
+	if (pool == NULL)
 	{
-		gsubmodule = _ggit_submodule_wrap (submodule);
+		g_async_queue_push (parallel.repositories, g_object_ref (repository));
 	}
-	else
+
+	for (i = 0; i < partitions->len; ++i)
 	{
-		_ggit_error_set (error, ret);
+		if (pool != NULL)
+		{
+			g_thread_pool_push (pool, g_ptr_array_index (partitions, i), NULL);
+		}
+		else
+		{
+			status_partition_worker (g_ptr_array_index (partitions, i), &parallel);
+		}
 	}
 
-	return gsubmodule;
+	entries = _ggit_untracked_entries_new ();
+
+	for (i = 0; i < partitions->len; ++i)
+	{
+		StatusPartition *partition = g_async_queue_pop (parallel.results);
+
+		if (!ret)
+		{
+			continue;
+		}
+
+		if (partition->error != NULL)
+		{
+			g_propagate_error (error, partition->error);
+			partition->error = NULL;
+			ret = FALSE;
+
+			continue;
+		}
+
+		/* the paths are moved to entries */
+		g_array_append_vals (entries, partition->entries->data, partition->entries->len);
+		g_array_set_clear_func (partition->entries, NULL);
+
+		if (updated == NULL || partition->directory == NULL)
+		{
+			continue;
+		}
+
+		if (partition->cached)
+		{
+			_ggit_untracked_cache_copy (updated, parallel.cache, partition->directory);
+		}
+		else
+		{
+			_ggit_untracked_cache_insert (updated,
+			                              partition->directory,
+			                              partition->stamps,
+			                              partition->untracked);
+			partition->stamps = NULL;
+			partition->untracked = NULL;
+		}
+	}
+
+	if (pool != NULL)
+	{
+		g_thread_pool_free (pool, FALSE, TRUE);
+	}
+
+	g_async_queue_unref (parallel.repositories);
+	g_async_queue_unref (parallel.results);
+	g_ptr_array_unref (partitions);
+
+	if (ret && updated != NULL)
+	{
+		/* the cache only speeds up the next call, so failing to save is fine */
+		_ggit_untracked_cache_save (updated, cache_filename, NULL);
+	}
+
+	if (ret)
+	{
+		gint cb_ret = 0;
+
+		g_array_sort (entries, compare_status_entries);
+
+		for (i = 0; i < entries->len && cb_ret == 0; ++i)
+		{
+			GgitUntrackedEntry *entry = &g_array_index (entries, GgitUntrackedEntry, i);
+
+			cb_ret = callback (entry->path, entry->status, user_data);
+		}
+
+		if (cb_ret != 0)
+		{
+			_ggit_error_set (error, cb_ret);
+			ret = FALSE;
+		}
+	}
+
+	g_array_unref (entries);
+	_ggit_untracked_cache_free (parallel.cache);
+	_ggit_untracked_cache_free (updated);
+	g_free (cache_filename);
+
+	return ret;
 }
 
 typedef struct
 {
+	GgitReferencesCallback callback;
 	gpointer user_data;
-
-	GgitSubmoduleCallback callback;
-} SubmoduleCallbackWrapperData;
+} ReferenceForeachInfo;
 
 static gint
-submodule_wrapper_callback (git_submodule *submodule,
-                            const gchar   *name,
-                            gpointer       user_data)
+references_foreach_wrapper (git_reference *reference,
+                            gpointer       payload)
 {
-	SubmoduleCallbackWrapperData *wrapper_data = (SubmoduleCallbackWrapperData *)user_data;
-	GgitSubmodule *gsubmodule;
-	gint ret;
-
-	gsubmodule = _ggit_submodule_wrap (submodule);
-
-	ret = wrapper_data->callback (gsubmodule, name, wrapper_data->user_data);
-
-	_ggit_submodule_invalidate (gsubmodule);
-	ggit_submodule_unref (gsubmodule);
+	ReferenceForeachInfo *info = (ReferenceForeachInfo *)payload;
 
-	return ret;
+	return info->callback(_ggit_ref_wrap (reference, TRUE), info->user_data);
 }
 
 /**
- * ggit_repository_submodule_foreach:
+ * ggit_repository_references_foreach:
  * @repository: a #GgitRepository.
- * @callback: (scope call): a #GgitStatusCallback.
+ * @callback: (scope call): a #GgitReferencesCallback.
  * @user_data: callback user data.
  * @error: a #GError for error reporting, or %NULL.
  *
- * Gathers submodules and run a callback for each one.
- *
- * To the callback is passed the submodule instance and name. If the callback
- * returns something other than 0, the iteration will stop and @error
- * will be set.
+ * Gathers references and run a callback for each one.
  *
- * NOTE: the submodule instance passed to the callback is only valid during
- * the call to ggit_repository_submodule_foreach and may not be used after the
- * call has finished.
+ * To the callback is passed the reference and the data pointer
+ * passed to this function. If the callback returns something other than
+ * 0, the iteration will stop and @error will be set.
  *
  * Returns: %TRUE if there was no error, %FALSE otherwise
+ *
  */
 gboolean
-ggit_repository_submodule_foreach (GgitRepository        *repository,
-                                   GgitSubmoduleCallback  callback,
-                                   gpointer               user_data,
-                                   GError               **error)
+ggit_repository_references_foreach (GgitRepository          *repository,
+                                    GgitReferencesCallback   callback,
+                                    gpointer                 user_data,
+                                    GError                 **error)
 {
-	SubmoduleCallbackWrapperData wrapper_data;
 	gint ret;
+	ReferenceForeachInfo info;
 
 	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), FALSE);
 	g_return_val_if_fail (callback != NULL, FALSE);
 	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
 
-	wrapper_data.user_data = user_data;
-	wrapper_data.callback = callback;
+	info.callback = callback;
+	info.user_data = user_data;
 
-	ret = git_submodule_foreach (_ggit_native_get (repository),
-	                             submodule_wrapper_callback,
-	                             &wrapper_data);
+	ret = git_reference_foreach (_ggit_native_get (repository),
+	                             references_foreach_wrapper,
+	                             &info);
 
 	if (ret != GIT_OK)
 	{
@@ -2514,287 +3269,326 @@ ggit_repository_submodule_foreach (GgitRepository        *repository,
 }
 
 /**
- * ggit_repository_set_submodule_ignore:
+ * ggit_repository_references_foreach_name:
  * @repository: a #GgitRepository.
- * @name: the name of the submodule.
- * @ignore: a #GgitSubmoduleIgnore.
+ * @callback: (scope call): a #GgitReferencesNameCallback.
+ * @user_data: callback user data.
  * @error: a #GError for error reporting, or %NULL.
  *
- * Sets the ignore rule for the submodule in the configuration.
- * This does not affect any currently-loaded instances..
+ * Gathers reference names and run a callback for each one.
+ *
+ * To the callback is passed the name of the reference and the data pointer
+ * passed to this function. If the callback returns something other than
+ * 0, the iteration will stop and @error will be set.
+ *
+ * Returns: %TRUE if there was no error, %FALSE otherwise
+ *
  */
-void
-ggit_repository_set_submodule_ignore (GgitRepository       *repository,
-                                      const gchar          *name,
-                                      GgitSubmoduleIgnore   ignore,
-                                      GError              **error)
+gboolean
+ggit_repository_references_foreach_name (GgitRepository             *repository,
+                                         GgitReferencesNameCallback  callback,
+                                         gpointer                    user_data,
+                                         GError                    **error)
 {
 	gint ret;
 
-	g_return_if_fail (GGIT_IS_REPOSITORY (repository));
-	g_return_if_fail (name != NULL);
-	g_return_if_fail (error == NULL || *error == NULL);
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), FALSE);
+	g_return_val_if_fail (callback != NULL, FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
 
-	ret = git_submodule_set_ignore (_ggit_native_get (repository),
-	                                name,
-	                                (git_submodule_ignore_t)ignore);
+	ret = git_reference_foreach_name (_ggit_native_get (repository),
+	                                  callback,
+	                                  user_data);
 
 	if (ret != GIT_OK)
 	{
 		_ggit_error_set (error, ret);
+		return FALSE;
 	}
+
+	return TRUE;
 }
 
 /**
- * ggit_repository_set_submodule_update:
+ * ggit_repository_get_config:
  * @repository: a #GgitRepository.
- * @name: the name of the submodule.
- * @update: a #GgitSubmoduleUpdate.
  * @error: a #GError for error reporting, or %NULL.
  *
- * Sets the update rule for the submodule in the configuration.
- * This setting won't affect any existing instances.
- */
-void
-ggit_repository_set_submodule_update (GgitRepository       *repository,
-                                      const gchar          *name,
-                                      GgitSubmoduleUpdate   update,
-                                      GError              **error)
+ * Get the config for a specific repository.
+ *
+ * Returns: (transfer full) (nullable): a #GgitConfig.
+ *
+ **/
+GgitConfig *
+ggit_repository_get_config (GgitRepository  *repository,
+                            GError         **error)
 {
+	git_config *config;
 	gint ret;
 
-	g_return_if_fail (GGIT_IS_REPOSITORY (repository));
-	g_return_if_fail (name != NULL);
-	g_return_if_fail (error == NULL || *error == NULL);
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
-	ret = git_submodule_set_update (_ggit_native_get (repository),
-	                                name,
-	                                (git_submodule_update_t)update);
+	ret = git_repository_config (&config,
+	                             _ggit_native_get (repository));
 
 	if (ret != GIT_OK)
 	{
 		_ggit_error_set (error, ret);
+		return NULL;
 	}
+
+	return _ggit_config_wrap (config);
 }
 
 /**
- * ggit_repository_set_submodule_url:
+ * ggit_repository_get_odb:
  * @repository: a #GgitRepository.
- * @name: the name of the submodule to configure.
- * @url: URL that should be used for the submodule.
  * @error: a #GError for error reporting, or %NULL.
  *
- * Sets the URL for the submodule in the configuration.
+ * Get the object database for a specific repository.
  *
- * After calling this, you may wish to call ggit_submodule_sync() to
- * write the changes to the checked out submodule repository.
- */
-void
-ggit_repository_set_submodule_url (GgitRepository  *repository,
-                                   const gchar     *name,
-                                   const gchar     *url,
-                                   GError         **error)
+ * Returns: (transfer full) (nullable): a #GgitOdb.
+ *
+ **/
+GgitOdb *
+ggit_repository_get_odb (GgitRepository  *repository,
+                         GError         **error)
 {
+	git_odb *odb;
 	gint ret;
 
-	g_return_if_fail (GGIT_IS_REPOSITORY (repository));
-	g_return_if_fail (name != NULL);
-	g_return_if_fail (url != NULL);
-	g_return_if_fail (error == NULL || *error == NULL);
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
-	ret = git_submodule_set_url (_ggit_native_get (repository),
-	                             name,
-	                             url);
+	ret = git_repository_odb (&odb, _ggit_native_get (repository));
 
 	if (ret != GIT_OK)
 	{
 		_ggit_error_set (error, ret);
+		return NULL;
 	}
+
+	return _ggit_odb_wrap (odb);
 }
 
 /**
- * ggit_repository_set_submodule_fetch_recurse:
+ * ggit_repository_get_index:
  * @repository: a #GgitRepository.
- * @name: the name of the submodule.
- * @fetch_recurse_submodules: a #GgitSubmoduleRecurse.
  * @error: a #GError for error reporting, or %NULL.
  *
- * Sets the submodule.'name'.fetchRecurseSubmodules value for
- * the submodule. This setting won't affect any existing instances..
- */
-void
-ggit_repository_set_submodule_fetch_recurse (GgitRepository        *repository,
-                                             const gchar           *name,
-                                             GgitSubmoduleRecurse   fetch_recurse_submodules,
-                                             GError               **error)
+ * Get the index for a specific repository.
+ *
+ * Returns: (transfer full) (nullable): a #GgitIndex.
+ *
+ **/
+GgitIndex *
+ggit_repository_get_index (GgitRepository  *repository,
+                           GError         **error)
 {
+	git_index *idx;
 	gint ret;
 
-	g_return_if_fail (GGIT_IS_REPOSITORY (repository));
-	g_return_if_fail (name != NULL);
-	g_return_if_fail (error == NULL || *error == NULL);
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
-	ret = git_submodule_set_fetch_recurse_submodules (_ggit_native_get (repository),
-	                                                  name,
-	                                                  (git_submodule_recurse_t)fetch_recurse_submodules);
+	ret = git_repository_index (&idx,
+	                            _ggit_native_get (repository));
 
 	if (ret != GIT_OK)
 	{
 		_ggit_error_set (error, ret);
+		return NULL;
 	}
+
+	return _ggit_index_wrap (idx);
 }
 
 /**
- * ggit_repository_get_submodule_status:
+ * ggit_repository_create_tag:
  * @repository: a #GgitRepository.
- * @name: the name of the submodule.
- * @ignore: the ignore rules to follow.
+ * @tag_name: the tag name.
+ * @target: a #GgitObject.
+ * @tagger: a #GgitSignature.
+ * @message: the tag message.
+ * @flags: a #GgitCreateFlags.
  * @error: a #GError for error reporting, or %NULL.
  *
- * Gets the status for a submodule.
- * This looks at a submodule and tries to determine the status.  It
- * will return a combination of the %GGIT_SUBMODULE_STATUS values.
- * How deeply it examines the working directory to do this will depend
- * on @ignore.
+ * Create a new tag object.
  *
- * Returns: the #GgitSubmoduleStatus for @submodule.
- */
-GgitSubmoduleStatus
-ggit_repository_get_submodule_status (GgitRepository      *repository,
-                                      const gchar         *name,
-                                      GgitSubmoduleIgnore  ignore,
-                                      GError             **error)
+ * Returns: (transfer full) (nullable): the id to which the tag points, or
+ *                                        %NULL in case of an error.
+ *
+ **/
+GgitOId *
+ggit_repository_create_tag (GgitRepository   *repository,
+                            gchar const      *tag_name,
+                            GgitObject       *target,
+                            GgitSignature    *tagger,
+                            gchar const      *message,
+                            GgitCreateFlags   flags,
+                            GError          **error)
 {
+	git_oid oid;
+	gboolean force;
 	gint ret;
-	GgitSubmoduleStatus status;
 
-	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), 0);
-	g_return_val_if_fail (name != NULL, 0);
-	g_return_val_if_fail (error == NULL || *error == NULL, 0);
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
+	g_return_val_if_fail (tag_name != NULL, NULL);
+	g_return_val_if_fail (GGIT_IS_OBJECT (target), NULL);
+	g_return_val_if_fail (tagger != NULL, NULL);
+	g_return_val_if_fail (message != NULL, NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
-	ret = git_submodule_status (&status,
-	                            _ggit_native_get (repository),
-	                            name,
-	                            (git_submodule_ignore_t)ignore);
+	force = flags & GGIT_CREATE_FORCE;
+
+	ret = git_tag_create (&oid,
+	                     _ggit_native_get (repository),
+	                     tag_name,
+	                     _ggit_native_get (target),
+	                     _ggit_native_get (tagger),
+	                     message,
+	                     force ? 1 : 0);
 
 	if (ret != GIT_OK)
 	{
 		_ggit_error_set (error, ret);
+		return NULL;
 	}
 
-	return status;
+	return _ggit_oid_wrap (&oid);
 }
 
 /**
- * ggit_repository_reset:
+ * ggit_repository_create_tag_from_buffer:
  * @repository: a #GgitRepository.
- * @target: the target #GgitObject which is a commit or a tag.
- * @reset_type: the #GgitResetType to perform.
- * @checkout_options: the #GgitCheckoutOptions to be used for a HARD reset.
+ * @tag: the tag buffer.
+ * @flags: a #GgitCreateFlags.
  * @error: a #GError for error reporting, or %NULL.
  *
- * Performs a reset of type @reset_type on @repository to @target,
- * or @error will be set.
- */
-void
-ggit_repository_reset (GgitRepository       *repository,
-                       GgitObject           *target,
-                       GgitResetType         reset_type,
-                       GgitCheckoutOptions  *checkout_options,
-                       GError              **error)
+ * Create a new tag from a buffer describing the tag object. The buffer must
+ * be correctly formatted.
+ *
+ * Returns: (transfer full) (nullable): the id to which the tag points, or
+ *                                        %NULL in case of an error.
+ *
+ **/
+GgitOId *
+ggit_repository_create_tag_from_buffer (GgitRepository   *repository,
+                                        const gchar      *tag,
+                                        GgitCreateFlags   flags,
+                                        GError          **error)
 {
+	git_oid oid;
+	gboolean force;
 	gint ret;
 
-	g_return_if_fail (GGIT_IS_REPOSITORY (repository));
-	g_return_if_fail (GGIT_IS_OBJECT (target));
-	g_return_if_fail (GGIT_IS_CHECKOUT_OPTIONS (checkout_options));
-	g_return_if_fail (error == NULL || *error == NULL);
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
+	g_return_val_if_fail (tag != NULL, NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
-	ret = git_reset (_ggit_native_get (repository),
-	                 _ggit_native_get (target),
-	                 (git_reset_t)reset_type,
-	                 (git_checkout_options *)_ggit_checkout_options_get_checkout_options (checkout_options));
+	force = flags & GGIT_CREATE_FORCE;
+
+	ret = git_tag_create_frombuffer (&oid,
+	                                 _ggit_native_get (repository),
+	                                 tag,
+	                                 force ? 1 : 0);
 
 	if (ret != GIT_OK)
 	{
 		_ggit_error_set (error, ret);
+		return NULL;
 	}
+
+	return _ggit_oid_wrap (&oid);
 }
 
 /**
- * ggit_repository_reset_default:
+ * ggit_repository_create_tag_lightweight:
  * @repository: a #GgitRepository.
- * @target: (allow-none): the target #GgitObject which is a commit or a tag.
- * @pathspecs: (array zero-terminated=1): a list of file paths to reset.
- * @error: a #GError for error reporting or %NULL.
+ * @tag_name: the name of the tag.
+ * @target: a #GgitObject.
+ * @flags: a #GgitCreateFlags.
+ * @error: a #GError for error reporting, or %NULL.
  *
- * Update some entries in the index from the target commit tree. The scope of
- * the updated entries is determined by the paths specified in @pathspecs.
- * Passing %NULL in @target will result in removing entries in the index
- * matching the provided pathspecs.
+ * Creates a new lightweight tag.
+ *
+ * Returns: (transfer full) (nullable): the id to which the tag points, or
+ *                                        %NULL in case of an error.
  *
  **/
-void
-ggit_repository_reset_default (GgitRepository       *repository,
-                               GgitObject           *target,
-                               const gchar * const  *pathspecs,
-                               GError              **error)
+GgitOId *
+ggit_repository_create_tag_lightweight (GgitRepository   *repository,
+                                        const gchar      *tag_name,
+                                        GgitObject       *target,
+                                        GgitCreateFlags   flags,
+                                        GError          **error)
 {
+	gboolean force;
+	git_oid oid;
 	gint ret;
-	git_strarray pp;
-
-	g_return_if_fail (GGIT_IS_REPOSITORY (repository));
-	g_return_if_fail (target == NULL || GGIT_IS_OBJECT (target));
-	g_return_if_fail (pathspecs != NULL && *pathspecs != NULL);
-	g_return_if_fail (error == NULL || *error == NULL);
 
-	ggit_utils_get_git_strarray_from_str_array (pathspecs, &pp);
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
+	g_return_val_if_fail (tag_name != NULL, NULL);
+	g_return_val_if_fail (GGIT_IS_OBJECT (target), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
-	ret = git_reset_default (_ggit_native_get (repository),
-	                         _ggit_native_get (target),
-	                         &pp);
+	force = flags & GGIT_CREATE_FORCE;
 
-	git_strarray_free (&pp);
+	ret = git_tag_create_lightweight (&oid,
+	                                  _ggit_native_get (repository),
+	                                  tag_name,
+	                                  _ggit_native_get (target),
+	                                  force ? 1 : 0);
 
 	if (ret != GIT_OK)
 	{
 		_ggit_error_set (error, ret);
+		return NULL;
 	}
+
+	return _ggit_oid_wrap (&oid);
 }
 
 /**
- * ggit_repository_save_stash:
+ * ggit_repository_create_tag_annotation:
  * @repository: a #GgitRepository.
- * @stasher: a #GgitSignature.
- * @message: description along with the stashed state or %NULL to be autogenerated.
- * @flags: a #GgitStashFlags to control the stashing process.
- * @error: a #GError for error reporting, #GGIT_ENOTFOUND if there's nothing to stash or %NULL.
+ * @tag_name: the name of the tag.
+ * @target: a #GgitObject.
+ * @signature: a #GgitObject.
+ * @message: the tag message.
+ * @error: a #GError for error reporting, or %NULL.
  *
- * Saves the local modifications to a new stash.
- * It returns the commit containing the stashed state.
- * This commit is also the target of the direct reference refs/stash.
+ * Creates a new annotated tag.
  *
- * Returns: (transfer full) (nullable): a new object id of the commit containing the stashed state.
- */
+ * Returns: (transfer full) (nullable): the id to which the tag points, or
+ *                                        %NULL in case of an error.
+ *
+ **/
 GgitOId *
-ggit_repository_save_stash (GgitRepository  *repository,
-                            GgitSignature   *stasher,
-                            const gchar     *message,
-                            GgitStashFlags   flags,
-                            GError         **error)
+ggit_repository_create_tag_annotation (GgitRepository  *repository,
+                                       const gchar     *tag_name,
+                                       GgitObject      *target,
+                                       GgitSignature   *signature,
+                                       const gchar     *message,
+                                       GError         **error)
 {
-	gint ret;
 	git_oid oid;
+	gint ret;
 
 	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
-	g_return_val_if_fail (GGIT_IS_SIGNATURE (stasher), NULL);
+	g_return_val_if_fail (tag_name != NULL, NULL);
+	g_return_val_if_fail (GGIT_IS_OBJECT (target), NULL);
+	g_return_val_if_fail (GGIT_IS_SIGNATURE (signature), NULL);
+	g_return_val_if_fail (message != NULL, NULL);
 	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
-	ret = git_stash_save (&oid,
-	                      _ggit_native_get (repository),
-	                      _ggit_native_get (stasher),
-	                      message,
-	                      flags);
+	ret = git_tag_annotation_create (&oid,
+	                                 _ggit_native_get (repository),
+	                                 tag_name,
+	                                 _ggit_native_get (target),
+	                                 _ggit_native_get (signature),
+	                                 message);
 
 	if (ret != GIT_OK)
 	{
@@ -2806,30 +3600,112 @@ ggit_repository_save_stash (GgitRepository  *repository,
 }
 
 /**
- * ggit_repository_drop_stash:
+ * ggit_repository_list_tags:
  * @repository: a #GgitRepository.
- * @index: the position within the stash list. 0 points to the.
- * most recent stashed state.
  * @error: a #GError for error reporting, or %NULL.
  *
- * Removes a single stashed state from the stash list.
- */
-void
-ggit_repository_drop_stash (GgitRepository  *repository,
-                            gsize            index,
+ * Fill a list with all the tags in the @repository.
+ *
+ * Returns: (transfer full) (nullable): a list with the tags in @repository.
+ **/
+gchar **
+ggit_repository_list_tags (GgitRepository  *repository,
+                           GError         **error)
+{
+	gint ret;
+	git_strarray tag_names;
+	gchar **tags;
+
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	ret = git_tag_list (&tag_names,
+	                    _ggit_native_get (repository));
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (error, ret);
+		tags = NULL;
+	}
+	else
+	{
+		tags = ggit_utils_get_str_array_from_git_strarray (&tag_names);
+	}
+
+	return tags;
+}
+
+/**
+ * ggit_repository_list_tags_match:
+ * @repository: a #GgitRepository.
+ * @pattern: (allow-none): a pattern to match.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Fill a list with all the tags in the @repository matching the provided
+ * pattern. The pattern can use standard fnmatch syntax.
+ *
+ * Returns: (transfer full) (nullable): a list with matching tags in @repository.
+ **/
+gchar **
+ggit_repository_list_tags_match (GgitRepository  *repository,
+                                 const gchar     *pattern,
+                                 GError         **error)
+{
+	gint ret;
+	git_strarray tag_names;
+	gchar **tags;
+
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	ret = git_tag_list_match (&tag_names,
+	                          pattern ? pattern : "",
+	                          _ggit_native_get (repository));
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (error, ret);
+		tags = NULL;
+	}
+	else
+	{
+		tags = ggit_utils_get_str_array_from_git_strarray (&tag_names);
+	}
+
+	return tags;
+}
+
+/**
+ * ggit_repository_delete_tag:
+ * @repository: a #GgitRepository.
+ * @name: the name of the tag.
+ * @error: a #GError.
+ *
+ * Delete an existing tag reference by name.
+ *
+ * Returns: %TRUE if the tag was deleted successfully, %FALSE otherwise.
+ **/
+gboolean
+ggit_repository_delete_tag (GgitRepository  *repository,
+                            gchar const     *name,
                             GError         **error)
 {
 	gint ret;
 
-	g_return_if_fail (GGIT_IS_REPOSITORY (repository));
-	g_return_if_fail (error == NULL || *error == NULL);
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), FALSE);
+	g_return_val_if_fail (name != NULL, FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
 
-	ret = git_stash_drop (_ggit_native_get (repository),
-	                      index);
+	ret = git_tag_delete (_ggit_native_get (repository), name);
 
 	if (ret != GIT_OK)
 	{
 		_ggit_error_set (error, ret);
+		return FALSE;
+	}
+	else
+	{
+		return TRUE;
 	}
 }
 
@@ -2837,46 +3713,46 @@ typedef struct
 {
 	gpointer user_data;
 
-	GgitStashCallback callback;
-} StashCallbackWrapperData;
+	GgitTagCallback callback;
+} TagCallbackWrapperData;
 
 static gint
-stash_callback_wrapper (gsize          index,
-                        const gchar   *message,
-                        const git_oid *stash_oid,
-                        gpointer       user_data)
+tag_callback_wrapper (const gchar *name,
+                      git_oid     *tag_oid,
+                      gpointer     user_data)
 {
-	StashCallbackWrapperData *wrapper_data = (StashCallbackWrapperData *)user_data;
+	TagCallbackWrapperData *wrapper_data = (TagCallbackWrapperData *)user_data;
 	GgitOId *oid;
 	gint ret;
 
-	oid = _ggit_oid_wrap (stash_oid);
+	oid = _ggit_oid_wrap (tag_oid);
 
-	ret = wrapper_data->callback (index, message, oid, wrapper_data->user_data);
+	ret = wrapper_data->callback (name, oid, wrapper_data->user_data);
 	ggit_oid_free (oid);
 
 	return ret;
 }
 
 /**
- * ggit_repository_stash_foreach:
+ * ggit_repository_tag_foreach:
  * @repository: a #GgitRepository.
- * @callback: (scope call): a #GgitStashCallback.
+ * @callback: (scope call): a #GgitTagCallback.
  * @user_data: callback user data.
  * @error: a #GError for error reporting, or %NULL.
  *
- * Loops over all the stashed states and issue a callback for each one.
- * If @callback returns a non-zero value, this will stop looping.
+ * Get all the tags in the repository and run the provided callback on each. If
+ * the callback returns something other than 0, the iteration will stop and
+ * @error will be set.
  *
- * Returns: %TRUE if there was no error, %FALSE otherwise.
- */
+ * Returns: %TRUE if there was no error, %FALSE otherwise
+ **/
 gboolean
-ggit_repository_stash_foreach (GgitRepository     *repository,
-                               GgitStashCallback   callback,
-                               gpointer            user_data,
-                               GError            **error)
+ggit_repository_tag_foreach (GgitRepository   *repository,
+                             GgitTagCallback   callback,
+                             gpointer          user_data,
+                             GError          **error)
 {
-	StashCallbackWrapperData wrapper_data;
+	TagCallbackWrapperData wrapper_data;
 	gint ret;
 
 	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), FALSE);
@@ -2886,9 +3762,9 @@ ggit_repository_stash_foreach (GgitRepository     *repository,
 	wrapper_data.user_data = user_data;
 	wrapper_data.callback = callback;
 
-	ret = git_stash_foreach (_ggit_native_get (repository),
-	                         stash_callback_wrapper,
-	                         &wrapper_data);
+	ret = git_tag_foreach (_ggit_native_get (repository),
+	                       tag_callback_wrapper,
+	                       &wrapper_data);
 
 	if (ret != GIT_OK)
 	{
@@ -2900,142 +3776,150 @@ ggit_repository_stash_foreach (GgitRepository     *repository,
 }
 
 /**
- * ggit_repository_get_ahead_behind:
+ * ggit_repository_create_branch:
  * @repository: a #GgitRepository.
- * @local: the commit for local.
- * @upstream: the commit for upstream.
- * @ahead: (out): number of unique from commits in @upstream.
- * @behind: (out): number of unique from commits in @local.
+ * @branch_name: the name of the branch.
+ * @target: a #GgitObject.
+ * @flags: a #GgitCreateFlags.
  * @error: a #GError for error reporting, or %NULL.
  *
- * Count the number of unique commits between two commit objects.
+ * Creates a new branch pointing at a target commit.
  *
- * There is no need for branches containing the commits to have any
- * upstream relationship, but it helps to think of one as a branch and
- * the other as its upstream, the @ahead and @behind values will be
- * what git would report for the branches.
- */
-void
-ggit_repository_get_ahead_behind (GgitRepository  *repository,
-                                  GgitOId         *local,
-                                  GgitOId         *upstream,
-                                  gsize           *ahead,
-                                  gsize           *behind,
-                                  GError         **error)
+ * Returns: (transfer full) (nullable): the reference to which the branch
+ *                                        points, or %NULL in case of an error.
+ **/
+GgitBranch *
+ggit_repository_create_branch (GgitRepository   *repository,
+                               const gchar      *branch_name,
+                               GgitObject       *target,
+                               GgitCreateFlags   flags,
+                               GError          **error)
 {
+	gboolean force;
+	git_reference *reference;
 	gint ret;
 
-	g_return_if_fail (GGIT_IS_REPOSITORY (repository));
-	g_return_if_fail (local != NULL);
-	g_return_if_fail (upstream != NULL);
-	g_return_if_fail (ahead != NULL);
-	g_return_if_fail (behind != NULL);
-	g_return_if_fail (error == NULL || *error == NULL);
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
+	g_return_val_if_fail (branch_name != NULL, NULL);
+	g_return_val_if_fail (GGIT_IS_OBJECT (target), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
-	ret = git_graph_ahead_behind (ahead, behind,
-	                              _ggit_native_get (repository),
-	                              _ggit_oid_get_oid (local),
-	                              _ggit_oid_get_oid (upstream));
+	force = flags & GGIT_CREATE_FORCE;
+
+	ret = git_branch_create (&reference,
+	                         _ggit_native_get (repository),
+	                         branch_name,
+	                         _ggit_native_get (target),
+	                         force ? 1 : 0);
 
 	if (ret != GIT_OK)
 	{
 		_ggit_error_set (error, ret);
+		return NULL;
 	}
+
+	return _ggit_branch_wrap (reference);
 }
 
 /**
- * ggit_repository_get_descendant_of:
+ * ggit_repository_enumerate_branches:
  * @repository: a #GgitRepository.
- * @commit: the commit.
- * @ancestor: the ancestor.
+ * @list_type: a #GgitBranchType.
  * @error: a #GError for error reporting, or %NULL.
  *
- * Check whether @com mit is a descendant of @ancestor. Note that if this
- * function returns %FALSE, an error might have occurred. If so, @error will
- * be set appropriately.
- *
- * Returns: %TRUE if @commit is a descendant of @ancestor, or %FALSE otherwise.
+ * Get a branch enumerator to enumerate over all branches of the specified
+ * @list_type in @repository.
  *
- */
-gboolean
-ggit_repository_get_descendant_of (GgitRepository  *repository,
-                                   GgitOId         *commit,
-                                   GgitOId         *ancestor,
-                                   GError         **error)
+ * Returns: (transfer full) (nullable): a branch enumerator.
+ **/
+GgitBranchEnumerator *
+ggit_repository_enumerate_branches (GgitRepository  *repository,
+                                    GgitBranchType   list_type,
+                                    GError         **error)
 {
+	git_branch_iterator *iter;
 	gint ret;
 
-	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), FALSE);
-	g_return_val_if_fail (commit != NULL, FALSE);
-	g_return_val_if_fail (ancestor != NULL, FALSE);
-	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
-
-	ret = git_graph_descendant_of (_ggit_native_get (repository),
-	                               _ggit_oid_get_oid (commit),
-	                               _ggit_oid_get_oid (ancestor));
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
-	if (ret == 1)
-	{
-		return TRUE;
-	}
+	ret = git_branch_iterator_new (&iter,
+	                               _ggit_native_get (repository),
+	                               (git_branch_t)list_type);
 
 	if (ret != GIT_OK)
 	{
 		_ggit_error_set (error, ret);
-
+		return NULL;
 	}
 
-	return FALSE;
+	return _ggit_branch_enumerator_wrap (iter);
 }
 
 /**
- * ggit_repository_create_blob:
+ * ggit_repository_lookup_branch:
  * @repository: a #GgitRepository.
+ * @branch_name: the name of the branch.
+ * @branch_type: a #GgitBranchType.
+ * @error: a #GError for error reporting, or %NULL.
  *
- * Create a new blob and return a #GOutputStream to write contents to the blob.
- * This is an efficient way to create new blobs without copying data. The
- * blob id can be obtained from the blob output stream using
- * #ggit_blob_output_stream_get_id, after you close the stream.
- *
- * Returns: (transfer full) (nullable): a #GgitBlobOutputStream.
+ * Lookups a branch by its name in a repository.
  *
- **/
-GgitBlobOutputStream *
-ggit_repository_create_blob (GgitRepository *repository)
+ * Returns: (transfer full) (nullable): a branch by its name in a repository.
+ */
+GgitBranch *
+ggit_repository_lookup_branch (GgitRepository *repository,
+                               const gchar    *branch_name,
+                               GgitBranchType  branch_type,
+                               GError         **error)
 {
+	gint ret;
+	git_reference *branch;
+
 	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
-	return _ggit_blob_output_stream_new (repository);
+	g_return_val_if_fail (branch_name != NULL, NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	ret = git_branch_lookup (&branch,
+	                         _ggit_native_get (repository),
+	                         branch_name,
+	                         (git_branch_t)branch_type);
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (error, ret);
+		return NULL;
+	}
+
+	return _ggit_branch_wrap (branch);
 }
 
 /**
- * ggit_repository_create_blob_from_buffer:
+ * ggit_repository_lookup_blob:
  * @repository: a #GgitRepository.
- * @buffer: (array length=size) (element-type guint8): the data.
- * @size: the length (in bytes) of the data.
+ * @oid: a #GgitOId.
  * @error: a #GError for error reporting, or %NULL.
  *
- * Write an in-memory buffer to the object database as a blob.
+ * Lookups a branch by its name in a repository.
  *
- * Returns: (transfer full) (nullable): the new #GgitOid of the written blob,
- * or %NULL if writing the blob failed.
+ * Returns: (transfer full) (nullable): a #GgitBlog pointer.
  */
-GgitOId *
-ggit_repository_create_blob_from_buffer (GgitRepository  *repository,
-                                         gconstpointer    buffer,
-                                         gsize            size,
-                                         GError         **error)
+GgitBlob *
+ggit_repository_lookup_blob (GgitRepository *repository,
+                             GgitOId        *oid,
+                             GError         **error)
 {
 	gint ret;
-	git_oid oid;
+	git_blob *blob;
+	const git_oid *id;
 
 	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
-	g_return_val_if_fail (buffer != NULL, NULL);
 	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
-	ret = git_blob_create_frombuffer (&oid,
-	                                  _ggit_native_get (repository),
-	                                  buffer,
-	                                  size);
+	id = (const git_oid *)_ggit_oid_get_oid (oid);
+	ret = git_blob_lookup (&blob,
+	                       _ggit_native_get (repository),
+	                       id);
 
 	if (ret != GIT_OK)
 	{
@@ -3043,77 +3927,127 @@ ggit_repository_create_blob_from_buffer (GgitRepository  *repository,
 		return NULL;
 	}
 
-	return _ggit_oid_wrap (&oid);
+	return _ggit_blob_wrap (blob, TRUE);
 }
 
 /**
- * ggit_repository_create_blob_from_file:
+ * ggit_repository_open_blob_stream:
  * @repository: a #GgitRepository.
- * @file: a #GFile.
+ * @oid: the #GgitOId of a blob.
+ * @size: (out) (optional): return location for the size of the blob, or %NULL.
  * @error: a #GError for error reporting, or %NULL.
  *
- * Write a file to the object database as a blob.
+ * Opens a stream over the content of the blob @oid without loading it in
+ * memory first. When the blob is stored as a whole in a pack file or a
+ * loose object, its content is inflated from the object file as the stream
+ * is read. Otherwise (e.g. the blob is stored as a delta in a pack) it is
+ * read at once, see ggit_odb_open_read_stream().
  *
- * Returns (transfer full) (nullable): the new #GgitOid of the written blob,
- * or %NULL if writing the blob failed.
- */
-GgitOId *
-ggit_repository_create_blob_from_file (GgitRepository  *repository,
-                                       GFile           *file,
-                                       GError         **error)
+ * Returns: (transfer full) (nullable): a #GInputStream or %NULL if there
+ *          was an error.
+ *
+ **/
+GInputStream *
+ggit_repository_open_blob_stream (GgitRepository  *repository,
+                                  GgitOId         *oid,
+                                  goffset         *size,
+                                  GError         **error)
 {
-	gint ret;
-	git_oid oid;
-	gchar *path;
+	git_repository *repo;
+	GInputStream *stream;
+	GgitOdb *odb;
+	gchar *objects_dir;
+	GError *err = NULL;
+	GType type;
+	gsize len;
 
 	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
-	g_return_val_if_fail (G_IS_FILE (file), NULL);
+	g_return_val_if_fail (oid != NULL, NULL);
 	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
-	path = g_file_get_path (file);
+	repo = _ggit_native_get (repository);
 
-	ret = git_blob_create_fromdisk (&oid,
-	                                _ggit_native_get (repository),
-	                                path);
+	/* libgit2 can not stream packed objects, and repositories without a
+	 * path only have custom object backends */
+	if (git_repository_path (repo) != NULL)
+	{
+		objects_dir = get_objects_dir (repo);
+		stream = _ggit_object_stream_open_packed_blob (objects_dir,
+		                                               _ggit_oid_get_oid (oid),
+		                                               size,
+		                                               &err);
+		g_free (objects_dir);
+
+		if (stream != NULL || err != NULL)
+		{
+			if (err != NULL)
+			{
+				g_propagate_error (error, err);
+			}
 
-	g_free (path);
+			return stream;
+		}
+	}
 
-	if (ret != GIT_OK)
+	odb = ggit_repository_get_odb (repository, error);
+
+	if (odb == NULL)
 	{
-		_ggit_error_set (error, ret);
 		return NULL;
 	}
 
-	return _ggit_oid_wrap (&oid);
+	stream = ggit_odb_open_read_stream (odb, oid, &type, &len, error);
+	g_object_unref (odb);
+
+	if (stream == NULL)
+	{
+		return NULL;
+	}
+
+	if (type != GGIT_TYPE_BLOB)
+	{
+		/* like git_blob_lookup() */
+		g_set_error (error, GGIT_ERROR, GGIT_ERROR_NOTFOUND,
+		             "the requested type does not match the type in the ODB");
+
+		g_object_unref (stream);
+		return NULL;
+	}
+
+	if (size != NULL)
+	{
+		*size = (goffset)len;
+	}
+
+	return stream;
 }
 
 /**
- * ggit_repository_create_blob_from_path:
+ * ggit_repository_lookup_commit:
  * @repository: a #GgitRepository.
- * @path: the file path.
+ * @oid: a #GgitOId.
  * @error: a #GError for error reporting, or %NULL.
  *
- * Write a path relative to the repository working directory to the object
- * database as a blob.
+ * Lookups a branch by its name in a repository.
  *
- * Returns: (transfer full) (nullable): the new #GgitOid of the written blob,
- * or %NULL if writing the blob failed.
+ * Returns: (transfer full) (nullable): a #GgitCommit pointer.
  */
-GgitOId *
-ggit_repository_create_blob_from_path (GgitRepository  *repository,
-                                       const gchar     *path,
-                                       GError         **error)
+GgitCommit *
+ggit_repository_lookup_commit (GgitRepository *repository,
+                               GgitOId        *oid,
+                               GError         **error)
 {
 	gint ret;
-	git_oid oid;
+	git_commit *commit;
+	const git_oid *id;
 
 	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
-	g_return_val_if_fail (path != NULL, NULL);
 	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
-	ret = git_blob_create_fromworkdir (&oid,
-	                                _ggit_native_get (repository),
-	                                path);
+	id = (const git_oid *)_ggit_oid_get_oid (oid);
+	ret = git_commit_lookup (&commit,
+	                         _ggit_native_get (repository),
+	                         id);
 
 	if (ret != GIT_OK)
 	{
@@ -3121,70 +4055,35 @@ ggit_repository_create_blob_from_path (GgitRepository  *repository,
 		return NULL;
 	}
 
-	return _ggit_oid_wrap (&oid);
+	return _ggit_commit_wrap (commit, TRUE);
 }
 
 /**
- * ggit_repository_create_commit:
+ * ggit_repository_lookup_commit_info:
  * @repository: a #GgitRepository.
- * @update_ref: (allow-none): name of the reference to update.
- * @author: author signature.
- * @committer: committer signature (and time of commit).
- * @message_encoding: (allow-none): message encoding.
- * @message: commit message.
- * @tree: the tree of objects to commit.
- * @parents: (array length=parent_count): parent commits.
- * @parent_count: number of parent commits in @parents.
+ * @oid: a #GgitOId.
  * @error: a #GError for error reporting, or %NULL.
  *
- * Create a new commit. If @update_ref is not %NULL, the given reference will
- * be updated to point to the newly created commit. Use "HEAD" to update the
- * HEAD of the current branch and make it point to this commit.
- *
- * If @message_encoding is set to %NULL, "UTF-8" encoding is assumed for the
- * provided @message. Note that @message will not be cleaned up automatically.
- * You can use #ggit_message_prettify to do this yourself if needed.
- *
- * Returns: (transfer full) (nullable): the #GgitOId of the created commit object,
- * or %NULL in case of an error.
+ * Looks up the metadata of the commit @oid needed to show it in a log,
+ * without creating a #GgitCommit and its signatures.
  *
+ * Returns: (transfer full) (nullable): a #GgitCommitInfo or %NULL if
+ *          there was an error.
  */
-GgitOId *
-ggit_repository_create_commit (GgitRepository  *repository,
-                               const gchar     *update_ref,
-                               GgitSignature   *author,
-                               GgitSignature   *committer,
-                               const gchar     *message_encoding,
-                               const gchar     *message,
-                               GgitTree        *tree,
-                               GgitCommit     **parents,
-                               gint             parent_count,
-                               GError         **error)
+GgitCommitInfo *
+ggit_repository_lookup_commit_info (GgitRepository  *repository,
+                                    GgitOId         *oid,
+                                    GError         **error)
 {
+	GgitCommitInfo *info;
+	git_odb *odb;
 	gint ret;
-	git_oid oid;
-	git_commit **parents_native;
-	gint i;
-
-	parents_native = g_new0 (git_commit *, parent_count);
-
-	for (i = 0; i < parent_count; ++i)
-	{
-		parents_native[i] = _ggit_native_get (parents[i]);
-	}
 
-	ret = git_commit_create (&oid,
-	                         _ggit_native_get (repository),
-	                         update_ref,
-	                         _ggit_native_get (author),
-	                         _ggit_native_get (committer),
-	                         message_encoding,
-	                         message,
-	                         _ggit_native_get (tree),
-	                         parent_count,
-	                         (const git_commit **)parents_native);
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
+	g_return_val_if_fail (oid != NULL, NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
-	g_free (parents_native);
+	ret = git_repository_odb (&odb, _ggit_native_get (repository));
 
 	if (ret != GIT_OK)
 	{
@@ -3192,360 +4091,2216 @@ ggit_repository_create_commit (GgitRepository  *repository,
 		return NULL;
 	}
 
-	return _ggit_oid_wrap (&oid);
+	info = _ggit_commit_info_read (odb, _ggit_oid_get_oid (oid), error);
+	git_odb_free (odb);
+
+	return info;
 }
 
 /**
- * ggit_repository_create_commit_from_ids:
+ * ggit_repository_lookup_tag:
  * @repository: a #GgitRepository.
- * @update_ref: (allow-none): name of the reference to update.
- * @author: author signature.
- * @committer: committer signature (and time of commit).
- * @message_encoding: (allow-none): message encoding.
- * @message: commit message.
- * @tree: the tree of objects to commit.
- * @parents: (array length=parent_count): parent commits.
- * @parent_count: number of parent commits in @parents.
+ * @oid: a #GgitOId.
  * @error: a #GError for error reporting, or %NULL.
  *
- * Create a new commit. If @update_ref is not %NULL, the given reference will
- * be updated to point to the newly created commit. Use "HEAD" to update the
- * HEAD of the current branch and make it point to this commit.
+ * Lookups a branch by its name in a repository.
  *
- * If @message_encoding is set to %NULL, "UTF-8" encoding is assumed for the
- * provided @message. Note that @message will not be cleaned up automatically.
- * You can use #ggit_message_prettify to do this yourself if needed.
+ * Returns: (transfer full) (nullable): a #GgitTag pointer.
+ */
+GgitTag *
+ggit_repository_lookup_tag (GgitRepository *repository,
+                            GgitOId        *oid,
+                            GError         **error)
+{
+	gint ret;
+	git_tag *tag;
+	const git_oid *id;
+
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	id = (const git_oid *)_ggit_oid_get_oid (oid);
+	ret = git_tag_lookup (&tag,
+	                      _ggit_native_get (repository),
+	                      id);
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (error, ret);
+		return NULL;
+	}
+
+	return _ggit_tag_wrap (tag, TRUE);
+}
+
+/**
+ * ggit_repository_lookup_tree:
+ * @repository: a #GgitRepository.
+ * @oid: a #GgitOId.
+ * @error: a #GError for error reporting, or %NULL.
  *
- * Returns: (transfer full) (nullable): the #GgitOId of the created commit object,
- * or %NULL in case of an error.
+ * Lookups a branch by its name in a repository.
  *
+ * Returns: (transfer full) (nullable): a #GgitTree pointer.
  */
-GgitOId *
-ggit_repository_create_commit_from_ids (GgitRepository  *repository,
-                                        const gchar     *update_ref,
-                                        GgitSignature   *author,
-                                        GgitSignature   *committer,
-                                        const gchar     *message_encoding,
-                                        const gchar     *message,
-                                        GgitOId         *tree,
-                                        GgitOId        **parents,
-                                        gint             parent_count,
-                                        GError         **error)
+GgitTree *
+ggit_repository_lookup_tree (GgitRepository *repository,
+                             GgitOId        *oid,
+                             GError         **error)
 {
 	gint ret;
-	git_oid id;
-	git_oid **parents_native;
-	gint i;
+	git_tree *tree;
+	const git_oid *id;
 
-	parents_native = g_new0 (git_oid *, parent_count);
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
-	for (i = 0; i < parent_count; ++i)
+	id = (const git_oid *)_ggit_oid_get_oid (oid);
+	ret = git_tree_lookup (&tree,
+	                       _ggit_native_get (repository),
+	                       id);
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (error, ret);
+		return NULL;
+	}
+
+	return _ggit_tree_wrap (tree, TRUE);
+}
+
+/**
+ * ggit_repository_lookup_remote:
+ * @repository: a #GgitRepository.
+ * @name: the remote's name.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Gets the remote called @name.
+ *
+ * Returns: (transfer full) (nullable): a new #GgitRemote or %NULL if there is an error.
+ */
+GgitRemote *
+ggit_repository_lookup_remote (GgitRepository  *repository,
+                               const gchar     *name,
+                               GError         **error)
+{
+	gint ret;
+	git_remote *remote;
+
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
+	g_return_val_if_fail (name != NULL, NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	ret = git_remote_lookup (&remote,
+	                       _ggit_native_get (repository),
+	                       name);
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (error, ret);
+		return NULL;
+	}
+
+	return _ggit_remote_wrap (remote);
+}
+
+/**
+ * ggit_repository_create_remote:
+ * @repository: a #GgitRepository.
+ * @name: the name of the new remote.
+ * @url: the url of the remote.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Adds a remote with the default fetch refspec to the repository's configuration.
+ *
+ * Returns: (transfer full) (nullable): a new #GgitRemote or %NULL if there is an error.
+ */
+GgitRemote *
+ggit_repository_create_remote (GgitRepository  *repository,
+                               const gchar     *name,
+                               const gchar     *url,
+                               GError         **error)
+{
+	gint ret;
+	git_remote *remote;
+
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
+	g_return_val_if_fail (name != NULL, NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	ret = git_remote_create (&remote,
+	                         _ggit_native_get (repository),
+	                         name,
+	                         url);
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (error, ret);
+		return NULL;
+	}
+
+	return _ggit_remote_wrap (remote);
+}
+
+/**
+ * ggit_repository_remove_remote:
+ * @repository: a #GgitRepository.
+ * @name: the remote's name.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Removes @remote from the @repository.
+ *
+ * Returns: %TRUE if there was no error, %FALSE otherwise
+ */
+gboolean
+ggit_repository_remove_remote (GgitRepository   *repository,
+                               const gchar      *name,
+                               GError          **error)
+{
+	gint ret;
+
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), FALSE);
+	g_return_val_if_fail (name != NULL, FALSE);
+
+	ret = git_remote_delete (_ggit_native_get (repository),
+	                         name);
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (error, ret);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+/**
+ * ggit_repository_set_remote_url:
+ * @repository: a #GgitRepository.
+ * @remote: the remote name who's url is to be set.
+ * @url: url of the remote.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Sets url for the @remote from the @repository.
+ *
+ * Returns: %TRUE if there was no error, %FALSE otherwise
+ */
+gboolean
+ggit_repository_set_remote_url (GgitRepository   *repository,
+                                const gchar      *remote,
+                                const gchar      *url,
+                                GError          **error)
+{
+	gint ret;
+
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), FALSE);
+	g_return_val_if_fail (remote != NULL, FALSE);
+	g_return_val_if_fail (url != NULL, FALSE);
+
+	ret = git_remote_set_url(_ggit_native_get (repository),
+	                                           remote,
+	                                           url);
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (error, ret);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+/**
+ * ggit_repository_rename_remote:
+ * @repository: a #GgitRepository.
+ * @name: the remote name to be renamed.
+ * @new_name: new name of the remote.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Rename the remote of @repository from @name to @new_name.
+ *
+ * Returns: (transfer full) (nullable): non-default refspecs that
+ * cannot be renamed.
+ */
+gchar **
+ggit_repository_rename_remote (GgitRepository   *repository,
+                               const gchar      *name,
+                               const gchar      *new_name,
+                               GError          **error)
+{
+	gint ret;
+	git_strarray problems;
+
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
+	g_return_val_if_fail (name != NULL, NULL);
+	g_return_val_if_fail (new_name != NULL, NULL);
+
+	ret = git_remote_rename (&problems,
+	                         _ggit_native_get (repository),
+	                         name,
+	                         new_name);
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (error, ret);
+		return NULL;
+	}
+
+	return ggit_utils_get_str_array_from_git_strarray (&problems);
+}
+
+/**
+ * ggit_repository_list_remotes:
+ * @repository: a #GgitRepository.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Fill a list with all the remotes in @repository.
+ *
+ * Returns: (transfer full) (nullable): a list with the remotes.
+ **/
+gchar **
+ggit_repository_list_remotes (GgitRepository  *repository,
+                              GError         **error)
+{
+	gint ret;
+	git_strarray remote_names;
+	gchar **remotes;
+
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	ret = git_remote_list (&remote_names,
+	                       _ggit_native_get (repository));
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (error, ret);
+		remotes = NULL;
+	}
+	else
+	{
+		remotes = ggit_utils_get_str_array_from_git_strarray (&remote_names);
+	}
+
+	return remotes;
+}
+
+/**
+ * ggit_repository_add_remote_push:
+ * @repository: a #GgitRepository.
+ * @remote: a #GgitRemote.
+ * @refspec: the push refspec.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Adds a push refspec to @remote's configuration.
+ * Adds the given refspec to the push list in the configuration. No
+ * loaded remote instances will be affected.
+ */
+void
+ggit_repository_add_remote_push (GgitRepository  *repository,
+                                 GgitRemote      *remote,
+                                 const gchar     *refspec,
+                                 GError         **error)
+{
+	gint ret;
+
+	g_return_if_fail (GGIT_IS_REMOTE (remote));
+	g_return_if_fail (refspec != NULL && refspec[0] != '\0');
+	g_return_if_fail (error == NULL || *error == NULL);
+
+	ret = git_remote_add_push (_ggit_native_get (repository),
+	                           ggit_remote_get_name (remote),
+	                           refspec);
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (error, ret);
+	}
+}
+
+/**
+ * ggit_repository_add_remote_fetch:
+ * @repository: a #GgitRepository.
+ * @remote: a #GgitRemote.
+ * @refspec: the fetch refspec.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Adds a fetch refspec to the @remote's configuration.
+ * Adds @refspec to the fetch list in the configuration. No
+ * loaded remote instances will be affected.
+ */
+void
+ggit_repository_add_remote_fetch (GgitRepository  *repository,
+                                  GgitRemote      *remote,
+                                  const gchar     *refspec,
+                                  GError         **error)
+{
+	gint ret;
+
+	g_return_if_fail (GGIT_IS_REMOTE (remote));
+	g_return_if_fail (refspec != NULL && refspec[0] != '\0');
+	g_return_if_fail (error == NULL || *error == NULL);
+
+	ret = git_remote_add_fetch (_ggit_native_get (repository),
+	                            _ggit_native_get (remote),
+	                            refspec);
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (error, ret);
+	}
+}
+
+/**
+ * ggit_repository_lookup_submodule:
+ * @repository: a #GgitRepository.
+ * @name: the name of the submodule.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Lookups a submodule information by name or path. If the submodule
+ * does not exist, %NULL is returned and a GGIT_ERROR_NOTFOUND error set.
+ *
+ * Returns: (transfer full) (nullable): a newly-allocated #GgitSubmodule.
+ */
+GgitSubmodule *
+ggit_repository_lookup_submodule (GgitRepository  *repository,
+                                  const gchar     *name,
+                                  GError         **error)
+{
+	GgitSubmodule *gsubmodule = NULL;
+	gint ret;
+	git_submodule *submodule;
+
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
+	g_return_val_if_fail (name != NULL, NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	ret = git_submodule_lookup (&submodule,
+	                            _ggit_native_get (repository),
+	                            name);
+
+	if (ret == GIT_OK)
+	{
+		gsubmodule = _ggit_submodule_wrap (submodule);
+	}
+	else
+	{
+		_ggit_error_set (error, ret);
+	}
+
+	return gsubmodule;
+}
+
+typedef struct
+{
+	gpointer user_data;
+
+	GgitSubmoduleCallback callback;
+} SubmoduleCallbackWrapperData;
+
+static gint
+submodule_wrapper_callback (git_submodule *submodule,
+                            const gchar   *name,
+                            gpointer       user_data)
+{
+	SubmoduleCallbackWrapperData *wrapper_data = (SubmoduleCallbackWrapperData *)user_data;
+	GgitSubmodule *gsubmodule;
+	gint ret;
+
+	gsubmodule = _ggit_submodule_wrap (submodule);
+
+	ret = wrapper_data->callback (gsubmodule, name, wrapper_data->user_data);
+
+	_ggit_submodule_invalidate (gsubmodule);
+	ggit_submodule_unref (gsubmodule);
+
+	return ret;
+}
+
+/**
+ * ggit_repository_submodule_foreach:
+ * @repository: a #GgitRepository.
+ * @callback: (scope call): a #GgitStatusCallback.
+ * @user_data: callback user data.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Gathers submodules and run a callback for each one.
+ *
+ * To the callback is passed the submodule instance and name. If the callback
+ * returns something other than 0, the iteration will stop and @error
+ * will be set.
+ *
+ * NOTE: the submodule instance passed to the callback is only valid during
+ * the call to ggit_repository_submodule_foreach and may not be used after the
+ * call has finished.
+ *
+ * Returns: %TRUE if there was no error, %FALSE otherwise
+ */
+gboolean
+ggit_repository_submodule_foreach (GgitRepository        *repository,
+                                   GgitSubmoduleCallback  callback,
+                                   gpointer               user_data,
+                                   GError               **error)
+{
+	SubmoduleCallbackWrapperData wrapper_data;
+	gint ret;
+
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), FALSE);
+	g_return_val_if_fail (callback != NULL, FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	wrapper_data.user_data = user_data;
+	wrapper_data.callback = callback;
+
+	ret = git_submodule_foreach (_ggit_native_get (repository),
+	                             submodule_wrapper_callback,
+	                             &wrapper_data);
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (error, ret);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+/**
+ * ggit_repository_set_submodule_ignore:
+ * @repository: a #GgitRepository.
+ * @name: the name of the submodule.
+ * @ignore: a #GgitSubmoduleIgnore.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Sets the ignore rule for the submodule in the configuration.
+ * This does not affect any currently-loaded instances..
+ */
+void
+ggit_repository_set_submodule_ignore (GgitRepository       *repository,
+                                      const gchar          *name,
+                                      GgitSubmoduleIgnore   ignore,
+                                      GError              **error)
+{
+	gint ret;
+
+	g_return_if_fail (GGIT_IS_REPOSITORY (repository));
+	g_return_if_fail (name != NULL);
+	g_return_if_fail (error == NULL || *error == NULL);
+
+	ret = git_submodule_set_ignore (_ggit_native_get (repository),
+	                                name,
+	                                (git_submodule_ignore_t)ignore);
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (error, ret);
+	}
+}
+
+/**
+ * ggit_repository_set_submodule_update:
+ * @repository: a #GgitRepository.
+ * @name: the name of the submodule.
+ * @update: a #GgitSubmoduleUpdate.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Sets the update rule for the submodule in the configuration.
+ * This setting won't affect any existing instances.
+ */
+void
+ggit_repository_set_submodule_update (GgitRepository       *repository,
+                                      const gchar          *name,
+                                      GgitSubmoduleUpdate   update,
+                                      GError              **error)
+{
+	gint ret;
+
+	g_return_if_fail (GGIT_IS_REPOSITORY (repository));
+	g_return_if_fail (name != NULL);
+	g_return_if_fail (error == NULL || *error == NULL);
+
+	ret = git_submodule_set_update (_ggit_native_get (repository),
+	                                name,
+	                                (git_submodule_update_t)update);
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (error, ret);
+	}
+}
+
+/**
+ * ggit_repository_set_submodule_url:
+ * @repository: a #GgitRepository.
+ * @name: the name of the submodule to configure.
+ * @url: URL that should be used for the submodule.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Sets the URL for the submodule in the configuration.
+ *
+ * After calling this, you may wish to call ggit_submodule_sync() to
+ * write the changes to the checked out submodule repository.
+ */
+void
+ggit_repository_set_submodule_url (GgitRepository  *repository,
+                                   const gchar     *name,
+                                   const gchar     *url,
+                                   GError         **error)
+{
+	gint ret;
+
+	g_return_if_fail (GGIT_IS_REPOSITORY (repository));
+	g_return_if_fail (name != NULL);
+	g_return_if_fail (url != NULL);
+	g_return_if_fail (error == NULL || *error == NULL);
+
+	ret = git_submodule_set_url (_ggit_native_get (repository),
+	                             name,
+	                             url);
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (error, ret);
+	}
+}
+
+/**
+ * ggit_repository_set_submodule_fetch_recurse:
+ * @repository: a #GgitRepository.
+ * @name: the name of the submodule.
+ * @fetch_recurse_submodules: a #GgitSubmoduleRecurse.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Sets the submodule.'name'.fetchRecurseSubmodules value for
+ * the submodule. This setting won't affect any existing instances..
+ */
+void
+ggit_repository_set_submodule_fetch_recurse (GgitRepository        *repository,
+                                             const gchar           *name,
+                                             GgitSubmoduleRecurse   fetch_recurse_submodules,
+                                             GError               **error)
+{
+	gint ret;
+
+	g_return_if_fail (GGIT_IS_REPOSITORY (repository));
+	g_return_if_fail (name != NULL);
+	g_return_if_fail (error == NULL || *error == NULL);
+
+	ret = git_submodule_set_fetch_recurse_submodules (_ggit_native_get (repository),
+	                                                  name,
+	                                                  (git_submodule_recurse_t)fetch_recurse_submodules);
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (error, ret);
+	}
+}
+
+/**
+ * ggit_repository_get_submodule_status:
+ * @repository: a #GgitRepository.
+ * @name: the name of the submodule.
+ * @ignore: the ignore rules to follow.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Gets the status for a submodule.
+ * This looks at a submodule and tries to determine the status.  It
+ * will return a combination of the %GGIT_SUBMODULE_STATUS values.
+ * How deeply it examines the working directory to do this will depend
+ * on @ignore.
+ *
+ * Returns: the #GgitSubmoduleStatus for @submodule.
+ */
+GgitSubmoduleStatus
+ggit_repository_get_submodule_status (GgitRepository      *repository,
+                                      const gchar         *name,
+                                      GgitSubmoduleIgnore  ignore,
+                                      GError             **error)
+{
+	gint ret;
+	GgitSubmoduleStatus status;
+
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), 0);
+	g_return_val_if_fail (name != NULL, 0);
+	g_return_val_if_fail (error == NULL || *error == NULL, 0);
+
+	ret = git_submodule_status (&status,
+	                            _ggit_native_get (repository),
+	                            name,
+	                            (git_submodule_ignore_t)ignore);
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (error, ret);
+	}
+
+	return status;
+}
+
+/**
+ * ggit_repository_reset:
+ * @repository: a #GgitRepository.
+ * @target: the target #GgitObject which is a commit or a tag.
+ * @reset_type: the #GgitResetType to perform.
+ * @checkout_options: the #GgitCheckoutOptions to be used for a HARD reset.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Performs a reset of type @reset_type on @repository to @target,
+ * or @error will be set.
+ */
+void
+ggit_repository_reset (GgitRepository       *repository,
+                       GgitObject           *target,
+                       GgitResetType         reset_type,
+                       GgitCheckoutOptions  *checkout_options,
+                       GError              **error)
+{
+	gint ret;
+
+	g_return_if_fail (GGIT_IS_REPOSITORY (repository));
+	g_return_if_fail (GGIT_IS_OBJECT (target));
+	g_return_if_fail (GGIT_IS_CHECKOUT_OPTIONS (checkout_options));
+	g_return_if_fail (error == NULL || *error == NULL);
+
+	ret = git_reset (_ggit_native_get (repository),
+	                 _ggit_native_get (target),
+	                 (git_reset_t)reset_type,
+	                 (git_checkout_options *)_ggit_checkout_options_get_checkout_options (checkout_options));
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (error, ret);
+	}
+}
+
+/**
+ * ggit_repository_reset_default:
+ * @repository: a #GgitRepository.
+ * @target: (allow-none): the target #GgitObject which is a commit or a tag.
+ * @pathspecs: (array zero-terminated=1): a list of file paths to reset.
+ * @error: a #GError for error reporting or %NULL.
+ *
+ * Update some entries in the index from the target commit tree. The scope of
+ * the updated entries is determined by the paths specified in @pathspecs.
+ * Passing %NULL in @target will result in removing entries in the index
+ * matching the provided pathspecs.
+ *
+ **/
+void
+ggit_repository_reset_default (GgitRepository       *repository,
+                               GgitObject           *target,
+                               const gchar * const  *pathspecs,
+                               GError              **error)
+{
+	gint ret;
+	git_strarray pp;
+
+	g_return_if_fail (GGIT_IS_REPOSITORY (repository));
+	g_return_if_fail (target == NULL || GGIT_IS_OBJECT (target));
+	g_return_if_fail (pathspecs != NULL && *pathspecs != NULL);
+	g_return_if_fail (error == NULL || *error == NULL);
+
+	ggit_utils_get_git_strarray_from_str_array (pathspecs, &pp);
+
+	ret = git_reset_default (_ggit_native_get (repository),
+	                         _ggit_native_get (target),
+	                         &pp);
+
+	git_strarray_free (&pp);
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (error, ret);
+	}
+}
+
+/**
+ * ggit_repository_save_stash:
+ * @repository: a #GgitRepository.
+ * @stasher: a #GgitSignature.
+ * @message: description along with the stashed state or %NULL to be autogenerated.
+ * @flags: a #GgitStashFlags to control the stashing process.
+ * @error: a #GError for error reporting, #GGIT_ENOTFOUND if there's nothing to stash or %NULL.
+ *
+ * Saves the local modifications to a new stash.
+ * It returns the commit containing the stashed state.
+ * This commit is also the target of the direct reference refs/stash.
+ *
+ * Returns: (transfer full) (nullable): a new object id of the commit containing the stashed state.
+ */
+GgitOId *
+ggit_repository_save_stash (GgitRepository  *repository,
+                            GgitSignature   *stasher,
+                            const gchar     *message,
+                            GgitStashFlags   flags,
+                            GError         **error)
+{
+	gint ret;
+	git_oid oid;
+
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
+	g_return_val_if_fail (GGIT_IS_SIGNATURE (stasher), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	ret = git_stash_save (&oid,
+	                      _ggit_native_get (repository),
+	                      _ggit_native_get (stasher),
+	                      message,
+	                      flags);
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (error, ret);
+		return NULL;
+	}
+
+	return _ggit_oid_wrap (&oid);
+}
+
+/**
+ * ggit_repository_drop_stash:
+ * @repository: a #GgitRepository.
+ * @index: the position within the stash list. 0 points to the.
+ * most recent stashed state.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Removes a single stashed state from the stash list.
+ */
+void
+ggit_repository_drop_stash (GgitRepository  *repository,
+                            gsize            index,
+                            GError         **error)
+{
+	gint ret;
+
+	g_return_if_fail (GGIT_IS_REPOSITORY (repository));
+	g_return_if_fail (error == NULL || *error == NULL);
+
+	ret = git_stash_drop (_ggit_native_get (repository),
+	                      index);
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (error, ret);
+	}
+}
+
+typedef struct
+{
+	gpointer user_data;
+
+	GgitStashCallback callback;
+} StashCallbackWrapperData;
+
+static gint
+stash_callback_wrapper (gsize          index,
+                        const gchar   *message,
+                        const git_oid *stash_oid,
+                        gpointer       user_data)
+{
+	StashCallbackWrapperData *wrapper_data = (StashCallbackWrapperData *)user_data;
+	GgitOId *oid;
+	gint ret;
+
+	oid = _ggit_oid_wrap (stash_oid);
+
+	ret = wrapper_data->callback (index, message, oid, wrapper_data->user_data);
+	ggit_oid_free (oid);
+
+	return ret;
+}
+
+/**
+ * ggit_repository_stash_foreach:
+ * @repository: a #GgitRepository.
+ * @callback: (scope call): a #GgitStashCallback.
+ * @user_data: callback user data.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Loops over all the stashed states and issue a callback for each one.
+ * If @callback returns a non-zero value, this will stop looping.
+ *
+ * Returns: %TRUE if there was no error, %FALSE otherwise.
+ */
+gboolean
+ggit_repository_stash_foreach (GgitRepository     *repository,
+                               GgitStashCallback   callback,
+                               gpointer            user_data,
+                               GError            **error)
+{
+	StashCallbackWrapperData wrapper_data;
+	gint ret;
+
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), FALSE);
+	g_return_val_if_fail (callback != NULL, FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	wrapper_data.user_data = user_data;
+	wrapper_data.callback = callback;
+
+	ret = git_stash_foreach (_ggit_native_get (repository),
+	                         stash_callback_wrapper,
+	                         &wrapper_data);
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (error, ret);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+/**
+ * ggit_repository_get_ahead_behind:
+ * @repository: a #GgitRepository.
+ * @local: the commit for local.
+ * @upstream: the commit for upstream.
+ * @ahead: (out): number of unique from commits in @upstream.
+ * @behind: (out): number of unique from commits in @local.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Count the number of unique commits between two commit objects.
+ *
+ * There is no need for branches containing the commits to have any
+ * upstream relationship, but it helps to think of one as a branch and
+ * the other as its upstream, the @ahead and @behind values will be
+ * what git would report for the branches.
+ */
+void
+ggit_repository_get_ahead_behind (GgitRepository  *repository,
+                                  GgitOId         *local,
+                                  GgitOId         *upstream,
+                                  gsize           *ahead,
+                                  gsize           *behind,
+                                  GError         **error)
+{
+	gint ret;
+
+	g_return_if_fail (GGIT_IS_REPOSITORY (repository));
+	g_return_if_fail (local != NULL);
+	g_return_if_fail (upstream != NULL);
+	g_return_if_fail (ahead != NULL);
+	g_return_if_fail (behind != NULL);
+	g_return_if_fail (error == NULL || *error == NULL);
+
+	ret = git_graph_ahead_behind (ahead, behind,
+	                              _ggit_native_get (repository),
+	                              _ggit_oid_get_oid (local),
+	                              _ggit_oid_get_oid (upstream));
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (error, ret);
+	}
+}
+
+/**
+ * ggit_repository_get_descendant_of:
+ * @repository: a #GgitRepository.
+ * @commit: the commit.
+ * @ancestor: the ancestor.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Check whether @com mit is a descendant of @ancestor. Note that if this
+ * function returns %FALSE, an error might have occurred. If so, @error will
+ * be set appropriately.
+ *
+ * Returns: %TRUE if @commit is a descendant of @ancestor, or %FALSE otherwise.
+ *
+ */
+gboolean
+ggit_repository_get_descendant_of (GgitRepository  *repository,
+                                   GgitOId         *commit,
+                                   GgitOId         *ancestor,
+                                   GError         **error)
+{
+	gint ret;
+
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), FALSE);
+	g_return_val_if_fail (commit != NULL, FALSE);
+	g_return_val_if_fail (ancestor != NULL, FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	ret = git_graph_descendant_of (_ggit_native_get (repository),
+	                               _ggit_oid_get_oid (commit),
+	                               _ggit_oid_get_oid (ancestor));
+
+	if (ret == 1)
+	{
+		return TRUE;
+	}
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (error, ret);
+
+	}
+
+	return FALSE;
+}
+
+/**
+ * ggit_repository_write_commit_graph:
+ * @repository: a #GgitRepository.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Writes the commit-graph file (objects/info/commit-graph) of @repository
+ * for all the commits reachable from its references and HEAD.
+ *
+ * The commit-graph stores the parents, root tree, commit time and
+ * generation number of every commit in a compact, memory-mapped index.
+ * libgit2 only reads it when the "core.commitGraph" configuration option
+ * is enabled, which this function does not do: the caller must set it,
+ * e.g. with ggit_config_set_bool(), for the file to be used. It is then
+ * used to answer ggit_repository_get_ahead_behind(),
+ * ggit_repository_get_descendant_of(), ggit_repository_merge_base() and
+ * revision walks without inflating and parsing each commit object.
+ *
+ * Commits that are not yet part of the commit-graph are still found by
+ * reading them from the object database, so the file only needs to be
+ * refreshed from time to time, for example after a fetch, by calling this
+ * function again.
+ *
+ * This requires libgit2 1.2 or newer, %G_IO_ERROR_NOT_SUPPORTED is
+ * reported otherwise.
+ *
+ * Returns: %TRUE if the commit-graph was written, %FALSE otherwise.
+ */
+gboolean
+ggit_repository_write_commit_graph (GgitRepository  *repository,
+                                    GError         **error)
+{
+#if LIBGIT2_VER_MAJOR > 1 || (LIBGIT2_VER_MAJOR == 1 && LIBGIT2_VER_MINOR >= 2)
+	git_commit_graph_writer_options options = GIT_COMMIT_GRAPH_WRITER_OPTIONS_INIT;
+	git_commit_graph_writer *writer = NULL;
+	git_revwalk *walk = NULL;
+	git_repository *repo;
+	gchar *info_dir;
+	gint ret;
+
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	repo = _ggit_native_get (repository);
+
+	ret = git_revwalk_new (&walk, repo);
+
+	if (ret == GIT_OK)
+	{
+		ret = git_revwalk_push_glob (walk, "*");
+	}
+
+	if (ret == GIT_OK && !git_repository_head_unborn (repo))
+	{
+		ret = git_revwalk_push_head (walk);
+	}
+
+	if (ret == GIT_OK)
+	{
+		info_dir = g_build_filename (git_repository_commondir (repo),
+		                             "objects",
+		                             "info",
+		                             NULL);
+
+		ret = git_commit_graph_writer_new (&writer, info_dir);
+		g_free (info_dir);
+	}
+
+	if (ret == GIT_OK)
+	{
+		ret = git_commit_graph_writer_add_revwalk (writer, walk);
+	}
+
+	if (ret == GIT_OK)
+	{
+		ret = git_commit_graph_writer_commit (writer, &options);
+	}
+
+	git_commit_graph_writer_free (writer);
+	git_revwalk_free (walk);
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (error, ret);
+		return FALSE;
+	}
+
+	return TRUE;
+#else
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+	                     "Writing a commit-graph requires libgit2 1.2 or newer");
+
+	return FALSE;
+#endif
+}
+
+/**
+ * ggit_repository_create_blob:
+ * @repository: a #GgitRepository.
+ *
+ * Create a new blob and return a #GOutputStream to write contents to the blob.
+ * This is an efficient way to create new blobs without copying data. The
+ * blob id can be obtained from the blob output stream using
+ * #ggit_blob_output_stream_get_id, after you close the stream.
+ *
+ * Returns: (transfer full) (nullable): a #GgitBlobOutputStream.
+ *
+ **/
+GgitBlobOutputStream *
+ggit_repository_create_blob (GgitRepository *repository)
+{
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
+	return _ggit_blob_output_stream_new (repository);
+}
+
+/**
+ * ggit_repository_create_blob_from_buffer:
+ * @repository: a #GgitRepository.
+ * @buffer: (array length=size) (element-type guint8): the data.
+ * @size: the length (in bytes) of the data.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Write an in-memory buffer to the object database as a blob.
+ *
+ * Returns: (transfer full) (nullable): the new #GgitOid of the written blob,
+ * or %NULL if writing the blob failed.
+ */
+GgitOId *
+ggit_repository_create_blob_from_buffer (GgitRepository  *repository,
+                                         gconstpointer    buffer,
+                                         gsize            size,
+                                         GError         **error)
+{
+	gint ret;
+	git_oid oid;
+
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
+	g_return_val_if_fail (buffer != NULL, NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	ret = git_blob_create_frombuffer (&oid,
+	                                  _ggit_native_get (repository),
+	                                  buffer,
+	                                  size);
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (error, ret);
+		return NULL;
+	}
+
+	return _ggit_oid_wrap (&oid);
+}
+
+/**
+ * ggit_repository_create_blob_from_file:
+ * @repository: a #GgitRepository.
+ * @file: a #GFile.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Write a file to the object database as a blob.
+ *
+ * Returns (transfer full) (nullable): the new #GgitOid of the written blob,
+ * or %NULL if writing the blob failed.
+ */
+GgitOId *
+ggit_repository_create_blob_from_file (GgitRepository  *repository,
+                                       GFile           *file,
+                                       GError         **error)
+{
+	gint ret;
+	git_oid oid;
+	gchar *path;
+
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
+	g_return_val_if_fail (G_IS_FILE (file), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	path = g_file_get_path (file);
+
+	ret = git_blob_create_fromdisk (&oid,
+	                                _ggit_native_get (repository),
+	                                path);
+
+	g_free (path);
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (error, ret);
+		return NULL;
+	}
+
+	return _ggit_oid_wrap (&oid);
+}
+
+/**
+ * ggit_repository_create_blob_from_path:
+ * @repository: a #GgitRepository.
+ * @path: the file path.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Write a path relative to the repository working directory to the object
+ * database as a blob.
+ *
+ * Returns: (transfer full) (nullable): the new #GgitOid of the written blob,
+ * or %NULL if writing the blob failed.
+ */
+GgitOId *
+ggit_repository_create_blob_from_path (GgitRepository  *repository,
+                                       const gchar     *path,
+                                       GError         **error)
+{
+	gint ret;
+	git_oid oid;
+
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
+	g_return_val_if_fail (path != NULL, NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	ret = git_blob_create_fromworkdir (&oid,
+	                                _ggit_native_get (repository),
+	                                path);
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (error, ret);
+		return NULL;
+	}
+
+	return _ggit_oid_wrap (&oid);
+}
+
+/**
+ * ggit_repository_create_commit:
+ * @repository: a #GgitRepository.
+ * @update_ref: (allow-none): name of the reference to update.
+ * @author: author signature.
+ * @committer: committer signature (and time of commit).
+ * @message_encoding: (allow-none): message encoding.
+ * @message: commit message.
+ * @tree: the tree of objects to commit.
+ * @parents: (array length=parent_count): parent commits.
+ * @parent_count: number of parent commits in @parents.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Create a new commit. If @update_ref is not %NULL, the given reference will
+ * be updated to point to the newly created commit. Use "HEAD" to update the
+ * HEAD of the current branch and make it point to this commit.
+ *
+ * If @message_encoding is set to %NULL, "UTF-8" encoding is assumed for the
+ * provided @message. Note that @message will not be cleaned up automatically.
+ * You can use #ggit_message_prettify to do this yourself if needed.
+ *
+ * Returns: (transfer full) (nullable): the #GgitOId of the created commit object,
+ * or %NULL in case of an error.
+ *
+ */
+GgitOId *
+ggit_repository_create_commit (GgitRepository  *repository,
+                               const gchar     *update_ref,
+                               GgitSignature   *author,
+                               GgitSignature   *committer,
+                               const gchar     *message_encoding,
+                               const gchar     *message,
+                               GgitTree        *tree,
+                               GgitCommit     **parents,
+                               gint             parent_count,
+                               GError         **error)
+{
+	gint ret;
+	git_oid oid;
+	git_commit **parents_native;
+	gint i;
+
+	parents_native = g_new0 (git_commit *, parent_count);
+
+	for (i = 0; i < parent_count; ++i)
+	{
+		parents_native[i] = _ggit_native_get (parents[i]);
+	}
+
+	ret = git_commit_create (&oid,
+	                         _ggit_native_get (repository),
+	                         update_ref,
+	                         _ggit_native_get (author),
+	                         _ggit_native_get (committer),
+	                         message_encoding,
+	                         message,
+	                         _ggit_native_get (tree),
+	                         parent_count,
+	                         (const git_commit **)parents_native);
+
+	g_free (parents_native);
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (error, ret);
+		return NULL;
+	}
+
+	return _ggit_oid_wrap (&oid);
+}
+
+/**
+ * ggit_repository_create_commit_from_ids:
+ * @repository: a #GgitRepository.
+ * @update_ref: (allow-none): name of the reference to update.
+ * @author: author signature.
+ * @committer: committer signature (and time of commit).
+ * @message_encoding: (allow-none): message encoding.
+ * @message: commit message.
+ * @tree: the tree of objects to commit.
+ * @parents: (array length=parent_count): parent commits.
+ * @parent_count: number of parent commits in @parents.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Create a new commit. If @update_ref is not %NULL, the given reference will
+ * be updated to point to the newly created commit. Use "HEAD" to update the
+ * HEAD of the current branch and make it point to this commit.
+ *
+ * If @message_encoding is set to %NULL, "UTF-8" encoding is assumed for the
+ * provided @message. Note that @message will not be cleaned up automatically.
+ * You can use #ggit_message_prettify to do this yourself if needed.
+ *
+ * Returns: (transfer full) (nullable): the #GgitOId of the created commit object,
+ * or %NULL in case of an error.
+ *
+ */
+GgitOId *
+ggit_repository_create_commit_from_ids (GgitRepository  *repository,
+                                        const gchar     *update_ref,
+                                        GgitSignature   *author,
+                                        GgitSignature   *committer,
+                                        const gchar     *message_encoding,
+                                        const gchar     *message,
+                                        GgitOId         *tree,
+                                        GgitOId        **parents,
+                                        gint             parent_count,
+                                        GError         **error)
+{
+	gint ret;
+	git_oid id;
+	git_oid **parents_native;
+	gint i;
+
+	parents_native = g_new0 (git_oid *, parent_count);
+
+	for (i = 0; i < parent_count; ++i)
+	{
+		parents_native[i] = (git_oid *)_ggit_oid_get_oid (parents[i]);
+	}
+
+	ret = git_commit_create_from_ids (&id,
+	                                  _ggit_native_get (repository),
+	                                  update_ref,
+	                                  _ggit_native_get (author),
+	                                  _ggit_native_get (committer),
+	                                  message_encoding,
+	                                  message,
+	                                  _ggit_oid_get_oid (tree),
+	                                  parent_count,
+	                                  (git_oid const **)parents_native);
+
+	g_free (parents_native);
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (error, ret);
+		return NULL;
+	}
+
+	return _ggit_oid_wrap (&id);
+}
+
+/**
+ * ggit_repository_create_tree_builder:
+ * @repository: a #GgitRepository.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Create a new tree builder.
+ *
+ * Returns: (transfer full) (nullable): a new #GgitTreeBuilder,
+ * or %NULL if there was an error.
+ **/
+GgitTreeBuilder *
+ggit_repository_create_tree_builder (GgitRepository  *repository,
+                                     GError         **error)
+{
+	gint ret;
+	git_treebuilder *builder;
+
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
+
+	ret = git_treebuilder_new (&builder,
+	                           _ggit_native_get (repository),
+	                           NULL);
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (error, ret);
+		return NULL;
+	}
+
+	return _ggit_tree_builder_wrap (builder, repository, TRUE);
+}
+
+/**
+ * ggit_repository_create_tree_builder_from_tree:
+ * @tree: a #GgitTree.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Create a tree builder for initialized with @tree. To create an empty
+ * tree builder, use #ggit_repository_create_tree_builder instead.
+ *
+ * Returns: (transfer full) (nullable): a new #GgitTreeBuilder object,
+ * or %NULL if there was an error.
+ **/
+GgitTreeBuilder *
+ggit_repository_create_tree_builder_from_tree (GgitRepository  *repository,
+                                               GgitTree        *tree,
+                                               GError         **error)
+{
+	gint ret;
+	git_treebuilder *builder;
+
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
+	g_return_val_if_fail (GGIT_IS_TREE (tree), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	ret = git_treebuilder_new (&builder,
+	                           _ggit_native_get (repository),
+	                           _ggit_native_get (tree));
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (error, ret);
+		return NULL;
+	}
+
+	return _ggit_tree_builder_wrap (builder, repository, TRUE);
+}
+
+/**
+ * ggit_repository_create_index_entry_for_file:
+ * @repository: a #GgitRepository.
+ * @file: (allow-none): a #GFile.
+ * @id: (allow-none): a #GgitOId.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Create a new index entry. When @file is not %NULL, the path of the returned
+ * entry (#ggit_index_entry_get_path) is set to the path of @file relative to
+ * the working directory of @repository. The file must reside in the working
+ * directory of @repository. The file related
+ * fields of the returned entry are also queried from this file (if the file exists).
+ *
+ * If @id is not %NULL, then the id of the returned entry is set to @id
+ * (see #ggit_index_entry_get_id) which could point to a blob (for a file)
+ * or a tree (for a directory).
+ *
+ * Returns: (transfer full) (nullable): a #GgitIndexEntry or %NULL when an error occurred.
+ *
+ **/
+GgitIndexEntry *
+ggit_repository_create_index_entry_for_file (GgitRepository  *repository,
+                                             GFile           *file,
+                                             GgitOId         *id,
+                                             GError         **error)
+{
+	GgitRepositoryPrivate *priv;
+	gchar *path = NULL;
+	GgitIndexEntry *ret;
+
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
+	g_return_val_if_fail (file == NULL || G_IS_FILE (file), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	priv = ggit_repository_get_instance_private (repository);
+
+	if (file != NULL)
+	{
+		path = g_file_get_relative_path (priv->workdir, file);
+
+		if (!path)
+		{
+			g_set_error_literal (error,
+			                     G_IO_ERROR,
+			                     G_IO_ERROR_NOT_FOUND,
+			                     "File is not in the working directory");
+
+			return NULL;
+		}
+	}
+
+	ret = _ggit_index_entry_new (path, id);
+	g_free (path);
+
+	if (file && !id)
+	{
+		ggit_index_entry_stat (ret, file, NULL);
+	}
+
+	return ret;
+}
+
+/**
+ * ggit_repository_create_index_entry_for_path:
+ * @repository: a #GgitRepository.
+ * @path: (allow-none): a path.
+ * @id: (allow-none): a #GgitOId.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Create a new index entry. When @path is not %NULL, the path of the returned
+ * entry (#ggit_index_entry_get_path) is set to @path. The specified path can be
+ * either absolute or relative. In the case of
+ * an absolute path, the path must reside within the working directory of
+ * @repository. The file related fields of the returned entry are also queried
+ * from this path (if the file exists).
+ *
+ * If @id is not %NULL, then the id of the returned entry is set to @id
+ * (see #ggit_index_entry_get_id) which could point to a blob (for a file)
+ * or a tree (for a directory).
+ *
+ * Returns: (transfer full) (nullable): a #GgitIndexEntry or %NULL when an error occurred.
+ *
+ **/
+GgitIndexEntry *
+ggit_repository_create_index_entry_for_path (GgitRepository  *repository,
+                                             const gchar     *path,
+                                             GgitOId         *id,
+                                             GError         **error)
+{
+	GgitRepositoryPrivate *priv;
+	GFile *f;
+	GgitIndexEntry *ret;
+
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	priv = ggit_repository_get_instance_private (repository);
+
+	if (path)
+	{
+		if (!g_path_is_absolute (path))
+		{
+			f = g_file_resolve_relative_path (priv->workdir, path);
+		}
+		else
+		{
+			f = g_file_new_for_path (path);
+		}
+	}
+	else
+	{
+		f = NULL;
+	}
+
+	ret = ggit_repository_create_index_entry_for_file (repository,
+	                                                   f,
+	                                                   id,
+	                                                   error);
+
+	g_object_unref (f);
+
+	return ret;
+}
+
+/* The path of @file relative to the working directory of @repository, as
+ * libgit2 expects it.
+ */
+static gchar *
+get_workdir_path (GgitRepository  *repository,
+                  GFile           *file,
+                  GError         **error)
+{
+	GgitRepositoryPrivate *priv;
+	gchar *path = NULL;
+
+	priv = ggit_repository_get_instance_private (repository);
+
+	if (priv->workdir == NULL)
+	{
+		g_set_error_literal (error,
+		                     G_IO_ERROR,
+		                     G_IO_ERROR_NOT_SUPPORTED,
+		                     "The repository has no working directory");
+
+		return NULL;
+	}
+
+	path = g_file_get_relative_path (priv->workdir, file);
+
+	if (path == NULL)
+	{
+		g_set_error_literal (error,
+		                     G_IO_ERROR,
+		                     G_IO_ERROR_NOT_FOUND,
+		                     "File is not in the working directory");
+	}
+
+	return path;
+}
+
+/**
+ * ggit_repository_blame_file:
+ * @repository: a #GgitRepository.
+ * @file: the file to blame.
+ * @blame_options: (allow-none): blame options.
+ * @error: a #GError.
+ *
+ * Get a blame for a single file. @file must be in the working directory
+ * of @repository, otherwise a %G_IO_ERROR is set.
+ *
+ * Returns: (transfer full) (nullable): a #GgitBlame.
+ *
+ **/
+GgitBlame *
+ggit_repository_blame_file (GgitRepository    *repository,
+                            GFile             *file,
+                            GgitBlameOptions  *blame_options,
+                            GError           **error)
+{
+	git_blame *blame;
+	gchar *path;
+	int ret;
+
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
+	g_return_val_if_fail (G_IS_FILE (file), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	path = get_workdir_path (repository, file, error);
+
+	if (path == NULL)
+	{
+		return NULL;
+	}
+
+	ret = git_blame_file (&blame,
+	                      _ggit_native_get (repository),
+	                      path,
+	                      _ggit_blame_options_get_blame_options (blame_options));
+
+	g_free (path);
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (error, ret);
+		return NULL;
+	}
+
+	return _ggit_blame_wrap (blame);
+}
+
+typedef struct
+{
+	gchar *path;
+	GgitBlameOptions *options;
+} BlameFileData;
+
+static void
+blame_file_data_free (BlameFileData *data)
+{
+	g_free (data->path);
+
+	if (data->options != NULL)
+	{
+		ggit_blame_options_free (data->options);
+	}
+
+	g_slice_free (BlameFileData, data);
+}
+
+static void
+blame_file_thread (GTask        *task,
+                   gpointer      source_object,
+                   gpointer      task_data,
+                   GCancellable *cancellable)
+{
+	BlameFileData *data = task_data;
+	GgitRepository *worker;
+	GgitBlame *ret_blame;
+	GError *error = NULL;
+	git_blame *blame;
+	gint ret;
+
+	if (g_task_return_error_if_cancelled (task))
+	{
+		return;
+	}
+
+	worker = _ggit_repository_open_worker (source_object, &error);
+
+	if (worker == NULL)
+	{
+		g_task_return_error (task, error);
+		return;
+	}
+
+	ret = git_blame_file (&blame,
+	                      _ggit_native_get (worker),
+	                      data->path,
+	                      _ggit_blame_options_get_blame_options (data->options));
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (&error, ret);
+		g_task_return_error (task, error);
+
+		g_object_unref (worker);
+		return;
+	}
+
+	/* the blame refers to the repository it was computed on, for
+	 * ggit_blame_from_buffer(), so keep the handle alive with it.
+	 */
+	ret_blame = _ggit_blame_wrap (blame);
+	g_object_set_data_full (G_OBJECT (ret_blame),
+	                        "ggit-repository",
+	                        worker,
+	                        g_object_unref);
+
+	g_task_return_pointer (task, ret_blame, g_object_unref);
+}
+
+/**
+ * ggit_repository_blame_file_async:
+ * @repository: a #GgitRepository.
+ * @file: the file to blame.
+ * @blame_options: (allow-none): blame options.
+ * @cancellable: (allow-none): a #GCancellable or %NULL.
+ * @callback: (scope async): a #GAsyncReadyCallback to call when the
+ *            blame is ready.
+ * @user_data: (closure): the data to pass to @callback.
+ *
+ * Asynchronously get a blame for a single file on a worker thread. libgit2
+ * cannot interrupt a running blame, so @cancellable is only honored before
+ * the blame starts.
+ *
+ * Like ggit_repository_file_status_foreach_async(), the blame is computed
+ * on a separate handle on the repository, so @repository stays usable in
+ * the meantime. As with ggit_repository_blame_file(), @file must be in the
+ * working directory of @repository, otherwise the operation fails with a
+ * %G_IO_ERROR.
+ */
+void
+ggit_repository_blame_file_async (GgitRepository      *repository,
+                                  GFile               *file,
+                                  GgitBlameOptions    *blame_options,
+                                  GCancellable        *cancellable,
+                                  GAsyncReadyCallback  callback,
+                                  gpointer             user_data)
+{
+	BlameFileData *data;
+	GError *error = NULL;
+	GTask *task;
+
+	g_return_if_fail (GGIT_IS_REPOSITORY (repository));
+	g_return_if_fail (G_IS_FILE (file));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+	task = g_task_new (repository, cancellable, callback, user_data);
+	g_task_set_source_tag (task, ggit_repository_blame_file_async);
+
+	data = g_slice_new0 (BlameFileData);
+	data->path = get_workdir_path (repository, file, &error);
+
+	if (blame_options != NULL)
+	{
+		data->options = ggit_blame_options_copy (blame_options);
+	}
+
+	g_task_set_task_data (task, data, (GDestroyNotify)blame_file_data_free);
+
+	if (data->path == NULL)
+	{
+		g_task_return_error (task, error);
+	}
+	else
+	{
+		g_task_run_in_thread (task, blame_file_thread);
+	}
+
+	g_object_unref (task);
+}
+
+/**
+ * ggit_repository_blame_file_finish:
+ * @repository: a #GgitRepository.
+ * @result: a #GAsyncResult.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Finishes an operation started with ggit_repository_blame_file_async().
+ *
+ * Returns: (transfer full) (nullable): a #GgitBlame.
+ */
+GgitBlame *
+ggit_repository_blame_file_finish (GgitRepository  *repository,
+                                   GAsyncResult    *result,
+                                   GError         **error)
+{
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
+	g_return_val_if_fail (g_task_is_valid (result, repository), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	return g_task_propagate_pointer (G_TASK (result), error);
+}
+
+/**
+ * ggit_repository_get_attribute:
+ * @repository: a #GgitRepository.
+ * @path: the relative path to the file.
+ * @name: the name of the attribute.
+ * @flags: a #GgitAttributeCheckFlags.
+ * @error: a #GError.
+ *
+ * Get the attribute value of the specified attribute for the given file.
+ *
+ * Returns: (transfer none) (nullable): the attribute value, or %NULL.
+ *
+ **/
+const gchar *
+ggit_repository_get_attribute (GgitRepository           *repository,
+                               const gchar              *path,
+                               const gchar              *name,
+                               GgitAttributeCheckFlags   flags,
+                               GError                  **error)
+{
+	const char *value;
+	int ret;
+
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
+	g_return_val_if_fail (path != NULL, NULL);
+	g_return_val_if_fail (name != NULL, NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	ret = git_attr_get (&value,
+	                    _ggit_native_get (repository),
+	                    flags,
+	                    path,
+	                    name);
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (error, ret);
+		return NULL;
+	}
+
+	return value;
+}
+
+typedef struct
+{
+	GgitAttributeCheckFlags flags;
+	gchar *name;
+	gchar *path;
+} AttributeKey;
+
+typedef struct
+{
+	gboolean exists;
+	gint64 mtime;
+	gint64 size;
+	guint64 ino;
+} AttributeFileStamp;
+
+static guint
+attribute_key_hash (gconstpointer v)
+{
+	const AttributeKey *key = v;
+
+	return (g_str_hash (key->path) * 31 + g_str_hash (key->name)) ^ key->flags;
+}
+
+static gboolean
+attribute_key_equal (gconstpointer a,
+                     gconstpointer b)
+{
+	const AttributeKey *ka = a;
+	const AttributeKey *kb = b;
+
+	return ka->flags == kb->flags &&
+	       strcmp (ka->path, kb->path) == 0 &&
+	       strcmp (ka->name, kb->name) == 0;
+}
+
+static void
+attribute_key_free (AttributeKey *key)
+{
+	g_free (key->name);
+	g_free (key->path);
+	g_slice_free (AttributeKey, key);
+}
+
+static void
+attribute_file_stamp_free (AttributeFileStamp *stamp)
+{
+	g_slice_free (AttributeFileStamp, stamp);
+}
+
+static void
+attribute_file_stamp_read (const gchar        *filename,
+                           AttributeFileStamp *stamp)
+{
+	GStatBuf buf;
+
+	if (g_stat (filename, &buf) != 0)
+	{
+		stamp->exists = FALSE;
+		stamp->mtime = 0;
+		stamp->size = 0;
+		stamp->ino = 0;
+	}
+	else
 	{
-		parents_native[i] = (git_oid *)_ggit_oid_get_oid (parents[i]);
+		stamp->exists = TRUE;
+		stamp->mtime = buf.st_mtime;
+		stamp->size = buf.st_size;
+		stamp->ino = buf.st_ino;
 	}
+}
 
-	ret = git_commit_create_from_ids (&id,
-	                                  _ggit_native_get (repository),
-	                                  update_ref,
-	                                  _ggit_native_get (author),
-	                                  _ggit_native_get (committer),
-	                                  message_encoding,
-	                                  message,
-	                                  _ggit_oid_get_oid (tree),
-	                                  parent_count,
-	                                  (git_oid const **)parents_native);
-
-	g_free (parents_native);
+/* Takes ownership of @filename */
+static void
+attribute_cache_track_file (GgitRepositoryPrivate *priv,
+                            gchar                 *filename)
+{
+	AttributeFileStamp *stamp;
 
-	if (ret != GIT_OK)
+	if (g_hash_table_contains (priv->attribute_files, filename))
 	{
-		_ggit_error_set (error, ret);
-		return NULL;
+		g_free (filename);
+		return;
 	}
 
-	return _ggit_oid_wrap (&id);
+	stamp = g_slice_new (AttributeFileStamp);
+	attribute_file_stamp_read (filename, stamp);
+
+	g_hash_table_insert (priv->attribute_files, filename, stamp);
 }
 
-/**
- * ggit_repository_create_tree_builder:
- * @repository: a #GgitRepository.
- * @error: a #GError for error reporting, or %NULL.
- *
- * Create a new tree builder.
- *
- * Returns: (transfer full) (nullable): a new #GgitTreeBuilder,
- * or %NULL if there was an error.
- **/
-GgitTreeBuilder *
-ggit_repository_create_tree_builder (GgitRepository  *repository,
-                                     GError         **error)
+static void
+attribute_cache_track_path (GgitRepositoryPrivate *priv,
+                            git_repository        *repo,
+                            const gchar           *path)
 {
-	gint ret;
-	git_treebuilder *builder;
-
-	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
+	const gchar *workdir;
+	const gchar *sep;
 
-	ret = git_treebuilder_new (&builder,
-	                           _ggit_native_get (repository),
-	                           NULL);
+	workdir = git_repository_workdir (repo);
 
-	if (ret != GIT_OK)
+	if (workdir == NULL)
 	{
-		_ggit_error_set (error, ret);
-		return NULL;
+		return;
 	}
 
-	return _ggit_tree_builder_wrap (builder, repository, TRUE);
+	/* Every directory leading up to @path may have a .gitattributes
+	 * file that contributes to the attributes of @path.
+	 */
+	attribute_cache_track_file (priv,
+	                            g_build_filename (workdir,
+	                                              ".gitattributes",
+	                                              NULL));
+
+	for (sep = strchr (path, '/'); sep != NULL; sep = strchr (sep + 1, '/'))
+	{
+		gchar *dir;
+
+		dir = g_strndup (path, sep - path);
+
+		attribute_cache_track_file (priv,
+		                            g_build_filename (workdir,
+		                                              dir,
+		                                              ".gitattributes",
+		                                              NULL));
+
+		g_free (dir);
+	}
 }
 
-/**
- * ggit_repository_create_tree_builder_from_tree:
- * @tree: a #GgitTree.
- * @error: a #GError for error reporting, or %NULL.
- *
- * Create a tree builder for initialized with @tree. To create an empty
- * tree builder, use #ggit_repository_create_tree_builder instead.
- *
- * Returns: (transfer full) (nullable): a new #GgitTreeBuilder object,
- * or %NULL if there was an error.
- **/
-GgitTreeBuilder *
-ggit_repository_create_tree_builder_from_tree (GgitRepository  *repository,
-                                               GgitTree        *tree,
-                                               GError         **error)
+static void
+attribute_cache_ensure (GgitRepositoryPrivate *priv,
+                        git_repository        *repo)
 {
-	gint ret;
-	git_treebuilder *builder;
+	const gchar *gitdir;
 
-	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
-	g_return_val_if_fail (GGIT_IS_TREE (tree), NULL);
-	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+	if (priv->attribute_cache != NULL)
+	{
+		return;
+	}
 
-	ret = git_treebuilder_new (&builder,
-	                           _ggit_native_get (repository),
-	                           _ggit_native_get (tree));
+	priv->attribute_cache =
+		g_hash_table_new_full (attribute_key_hash,
+		                       attribute_key_equal,
+		                       (GDestroyNotify)attribute_key_free,
+		                       NULL);
+
+	priv->attribute_files =
+		g_hash_table_new_full (g_str_hash,
+		                       g_str_equal,
+		                       g_free,
+		                       (GDestroyNotify)attribute_file_stamp_free);
+
+	priv->attribute_values =
+		g_hash_table_new_full (g_str_hash,
+		                       g_str_equal,
+		                       g_free,
+		                       NULL);
+
+	gitdir = git_repository_path (repo);
+
+	attribute_cache_track_file (priv,
+	                            g_build_filename (gitdir,
+	                                              "info",
+	                                              "attributes",
+	                                              NULL));
+
+	/* .gitattributes can also be read from the index */
+	attribute_cache_track_file (priv,
+	                            g_build_filename (gitdir, "index", NULL));
+}
 
-	if (ret != GIT_OK)
+static void
+attribute_cache_clear (GgitRepositoryPrivate *priv)
+{
+	if (priv->attribute_cache == NULL)
 	{
-		_ggit_error_set (error, ret);
-		return NULL;
+		return;
 	}
 
-	return _ggit_tree_builder_wrap (builder, repository, TRUE);
+	g_hash_table_destroy (priv->attribute_cache);
+	priv->attribute_cache = NULL;
+
+	g_hash_table_destroy (priv->attribute_files);
+	priv->attribute_files = NULL;
+
+	g_hash_table_destroy (priv->attribute_values);
+	priv->attribute_values = NULL;
 }
 
-/**
- * ggit_repository_create_index_entry_for_file:
- * @repository: a #GgitRepository.
- * @file: (allow-none): a #GFile.
- * @id: (allow-none): a #GgitOId.
- * @error: a #GError for error reporting, or %NULL.
- *
- * Create a new index entry. When @file is not %NULL, the path of the returned
- * entry (#ggit_index_entry_get_path) is set to the path of @file relative to
- * the working directory of @repository. The file must reside in the working
- * directory of @repository. The file related
- * fields of the returned entry are also queried from this file (if the file exists).
- *
- * If @id is not %NULL, then the id of the returned entry is set to @id
- * (see #ggit_index_entry_get_id) which could point to a blob (for a file)
- * or a tree (for a directory).
- *
- * Returns: (transfer full) (nullable): a #GgitIndexEntry or %NULL when an error occurred.
- *
- **/
-GgitIndexEntry *
-ggit_repository_create_index_entry_for_file (GgitRepository  *repository,
-                                             GFile           *file,
-                                             GgitOId         *id,
-                                             GError         **error)
+static void
+attribute_cache_revalidate (GgitRepositoryPrivate *priv)
 {
-	GgitRepositoryPrivate *priv;
-	gchar *path = NULL;
-	GgitIndexEntry *ret;
+	GHashTableIter iter;
+	gpointer key;
+	gpointer value;
 
-	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
-	g_return_val_if_fail (file == NULL || G_IS_FILE (file), NULL);
-	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+	if (priv->attribute_cache == NULL)
+	{
+		return;
+	}
 
-	priv = ggit_repository_get_instance_private (repository);
+	g_hash_table_iter_init (&iter, priv->attribute_files);
 
-	if (file != NULL)
+	while (g_hash_table_iter_next (&iter, &key, &value))
 	{
-		path = g_file_get_relative_path (priv->workdir, file);
+		AttributeFileStamp *stamp = value;
+		AttributeFileStamp current;
 
-		if (!path)
-		{
-			g_set_error_literal (error,
-			                     G_IO_ERROR,
-			                     G_IO_ERROR_NOT_FOUND,
-			                     "File is not in the working directory");
+		attribute_file_stamp_read (key, &current);
 
-			return NULL;
+		if (current.exists != stamp->exists ||
+		    current.mtime != stamp->mtime ||
+		    current.size != stamp->size ||
+		    current.ino != stamp->ino)
+		{
+			attribute_cache_clear (priv);
+			break;
 		}
 	}
+}
 
-	ret = _ggit_index_entry_new (path, id);
-	g_free (path);
+/* libgit2 only keeps attribute values alive as long as the attribute file
+ * they came from, so the cache keeps its own copy. Values of the
+ * "encoding" attribute are handed out to diff lines, which may outlive the
+ * cache, so those are interned; that set of values is small. Everything
+ * else lives in the cache's own string table.
+ */
+static const gchar *
+attribute_cache_keep_value (GgitRepositoryPrivate *priv,
+                            const gchar           *name,
+                            const gchar           *native_value)
+{
+	gchar *value;
 
-	if (file && !id)
+	/* the special true, false and unset values are static */
+	if (native_value == NULL || git_attr_value (native_value) != GIT_ATTR_VALUE_T)
 	{
-		ggit_index_entry_stat (ret, file, NULL);
+		return native_value;
 	}
 
-	return ret;
+	if (strcmp (name, "encoding") == 0)
+	{
+		return g_intern_string (native_value);
+	}
+
+	value = g_hash_table_lookup (priv->attribute_values, native_value);
+
+	if (value == NULL)
+	{
+		value = g_strdup (native_value);
+		g_hash_table_add (priv->attribute_values, value);
+	}
+
+	return value;
 }
 
-/**
- * ggit_repository_create_index_entry_for_path:
+/*
+ * _ggit_repository_get_attribute_cached:
  * @repository: a #GgitRepository.
- * @path: (allow-none): a path.
- * @id: (allow-none): a #GgitOId.
- * @error: a #GError for error reporting, or %NULL.
- *
- * Create a new index entry. When @path is not %NULL, the path of the returned
- * entry (#ggit_index_entry_get_path) is set to @path. The specified path can be
- * either absolute or relative. In the case of
- * an absolute path, the path must reside within the working directory of
- * @repository. The file related fields of the returned entry are also queried
- * from this path (if the file exists).
- *
- * If @id is not %NULL, then the id of the returned entry is set to @id
- * (see #ggit_index_entry_get_id) which could point to a blob (for a file)
- * or a tree (for a directory).
+ * @path: the relative path to the file.
+ * @name: the name of the attribute.
+ * @flags: a #GgitAttributeCheckFlags.
  *
- * Returns: (transfer full) (nullable): a #GgitIndexEntry or %NULL when an error occurred.
+ * Like ggit_repository_get_attribute(), but remembers the result so that
+ * later lookups of the same attribute for the same path do not resolve
+ * the attribute files again. The cached values are dropped when any of
+ * the attribute files changed. Outside of a batch started with
+ * _ggit_repository_begin_attribute_batch() this is checked on every
+ * call; within a batch it is checked once, when the batch starts.
  *
- **/
-GgitIndexEntry *
-ggit_repository_create_index_entry_for_path (GgitRepository  *repository,
-                                             const gchar     *path,
-                                             GgitOId         *id,
-                                             GError         **error)
+ * Returns: (transfer none) (nullable): the attribute value, or %NULL.
+ *          Values of the "encoding" attribute are interned, other values
+ *          are valid until the attribute cache is cleared.
+ */
+const gchar *
+_ggit_repository_get_attribute_cached (GgitRepository          *repository,
+                                       const gchar             *path,
+                                       const gchar             *name,
+                                       GgitAttributeCheckFlags  flags)
 {
 	GgitRepositoryPrivate *priv;
-	GFile *f;
-	GgitIndexEntry *ret;
+	git_repository *repo;
+	AttributeKey lookup;
+	AttributeKey *key;
+	gpointer value;
+	const char *native_value;
 
 	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
-	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+	g_return_val_if_fail (path != NULL, NULL);
+	g_return_val_if_fail (name != NULL, NULL);
 
 	priv = ggit_repository_get_instance_private (repository);
+	repo = _ggit_native_get (repository);
 
-	if (path)
+	lookup.flags = flags;
+	lookup.name = (gchar *)name;
+	lookup.path = (gchar *)path;
+
+	g_mutex_lock (&priv->attribute_lock);
+
+	if (priv->attribute_batches == 0)
 	{
-		if (!g_path_is_absolute (path))
-		{
-			f = g_file_resolve_relative_path (priv->workdir, path);
-		}
-		else
-		{
-			f = g_file_new_for_path (path);
-		}
+		attribute_cache_revalidate (priv);
 	}
-	else
+
+	attribute_cache_ensure (priv, repo);
+
+	if (g_hash_table_lookup_extended (priv->attribute_cache,
+	                                  &lookup,
+	                                  NULL,
+	                                  &value))
 	{
-		f = NULL;
+		g_mutex_unlock (&priv->attribute_lock);
+		return value;
 	}
 
-	ret = ggit_repository_create_index_entry_for_file (repository,
-	                                                   f,
-	                                                   id,
-	                                                   error);
+	if (git_attr_get (&native_value, repo, flags, path, name) != GIT_OK)
+	{
+		g_mutex_unlock (&priv->attribute_lock);
+		return NULL;
+	}
 
-	g_object_unref (f);
+	value = (gpointer)attribute_cache_keep_value (priv, name, native_value);
 
-	return ret;
+	key = g_slice_new (AttributeKey);
+	key->flags = flags;
+	key->name = g_strdup (name);
+	key->path = g_strdup (path);
+
+	g_hash_table_insert (priv->attribute_cache, key, value);
+	attribute_cache_track_path (priv, repo, path);
+
+	g_mutex_unlock (&priv->attribute_lock);
+
+	return value;
 }
 
-/**
- * ggit_repository_blame_file:
+/*
+ * _ggit_repository_begin_attribute_batch:
  * @repository: a #GgitRepository.
- * @file: the file to blame.
- * @blame_options: (allow-none): blame options.
- * @error: a #GError.
- *
- * Get a blame for a single file.
- *
- * Returns: (transfer full) (nullable): a #GgitBlame.
  *
- **/
-GgitBlame *
-ggit_repository_blame_file (GgitRepository    *repository,
-                            GFile             *file,
-                            GgitBlameOptions  *blame_options,
-                            GError           **error)
+ * Starts a batch of attribute lookups. The attribute cache is dropped if
+ * any of the attribute files that contributed to it were created,
+ * modified or removed since, and is then trusted until the batch is ended
+ * with _ggit_repository_end_attribute_batch().
+ */
+void
+_ggit_repository_begin_attribute_batch (GgitRepository *repository)
 {
 	GgitRepositoryPrivate *priv;
-	git_blame *blame;
-	gchar *path;
-	int ret;
 
-	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
-	g_return_val_if_fail (G_IS_FILE (file), NULL);
-	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+	g_return_if_fail (GGIT_IS_REPOSITORY (repository));
 
 	priv = ggit_repository_get_instance_private (repository);
 
-	path = g_file_get_relative_path (priv->workdir, file);
+	g_mutex_lock (&priv->attribute_lock);
+
+	attribute_cache_revalidate (priv);
+	priv->attribute_batches++;
+
+	g_mutex_unlock (&priv->attribute_lock);
+}
+
+/*
+ * _ggit_repository_end_attribute_batch:
+ * @repository: a #GgitRepository.
+ *
+ * Ends a batch of attribute lookups started with
+ * _ggit_repository_begin_attribute_batch().
+ */
+void
+_ggit_repository_end_attribute_batch (GgitRepository *repository)
+{
+	GgitRepositoryPrivate *priv;
+
+	g_return_if_fail (GGIT_IS_REPOSITORY (repository));
 
-	ret = git_blame_file (&blame,
-	                      _ggit_native_get (repository),
-	                      path,
-	                      _ggit_blame_options_get_blame_options (blame_options));
+	priv = ggit_repository_get_instance_private (repository);
 
-	g_free (path);
+	g_mutex_lock (&priv->attribute_lock);
 
-	if (ret != GIT_OK)
-	{
-		_ggit_error_set (error, ret);
-		return NULL;
-	}
+	g_assert (priv->attribute_batches > 0);
+	priv->attribute_batches--;
 
-	return _ggit_blame_wrap (blame);
+	g_mutex_unlock (&priv->attribute_lock);
 }
 
 /**
- * ggit_repository_get_attribute:
+ * ggit_repository_clear_attribute_cache:
  * @repository: a #GgitRepository.
- * @path: the relative path to the file.
- * @name: the name of the attribute.
- * @flags: a #GgitAttributeCheckFlags.
- * @error: a #GError.
- *
- * Get the attribute value of the specified attribute for the given file.
  *
- * Returns: (transfer none) (nullable): the attribute value, or %NULL.
+ * Clears the attribute values cached by @repository. The cache is used when
+ * looking up the encoding of files during a diff and is cleared automatically
+ * when a .gitattributes file, the info/attributes file or the index changes.
+ * Use this function when attributes were changed by other means, for example
+ * through the core.attributesFile setting.
  *
  **/
-const gchar *
-ggit_repository_get_attribute (GgitRepository           *repository,
-                               const gchar              *path,
-                               const gchar              *name,
-                               GgitAttributeCheckFlags   flags,
-                               GError                  **error)
+void
+ggit_repository_clear_attribute_cache (GgitRepository *repository)
 {
-	const char *value;
-	int ret;
-
-	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
-	g_return_val_if_fail (path != NULL, NULL);
-	g_return_val_if_fail (name != NULL, NULL);
-	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+	GgitRepositoryPrivate *priv;
 
-	ret = git_attr_get (&value,
-	                    _ggit_native_get (repository),
-	                    flags,
-	                    path,
-	                    name);
+	g_return_if_fail (GGIT_IS_REPOSITORY (repository));
 
-	if (ret != GIT_OK)
-	{
-		_ggit_error_set (error, ret);
-		return NULL;
-	}
+	priv = ggit_repository_get_instance_private (repository);
 
-	return value;
+	g_mutex_lock (&priv->attribute_lock);
+	attribute_cache_clear (priv);
+	g_mutex_unlock (&priv->attribute_lock);
 }
 
 /**
@@ -3669,6 +6424,186 @@ ggit_repository_checkout_tree (GgitRepository       *repository,
 	return TRUE;
 }
 
+typedef struct
+{
+	GgitRepository *worker;
+	GgitObject *tree;
+	GgitCheckoutOptions *options;
+} CheckoutTreeData;
+
+static void
+checkout_tree_data_free (CheckoutTreeData *data)
+{
+	g_clear_object (&data->worker);
+	g_clear_object (&data->tree);
+	g_clear_object (&data->options);
+
+	g_slice_free (CheckoutTreeData, data);
+}
+
+/* Opens the handle an asynchronous operation that writes to the working
+ * tree runs on, so that @repository stays usable on the caller's thread.
+ * %NULL is returned when such a handle would not see the objects of
+ * @repository, as with _ggit_repository_open_workers(), in which case the
+ * operation runs on the calling thread instead.
+ */
+static GgitRepository *
+open_async_worker (GgitRepository *repository)
+{
+	GAsyncQueue *workers;
+	GgitRepository *worker;
+
+	workers = _ggit_repository_open_workers (repository, 1);
+	worker = g_async_queue_try_pop (workers);
+	g_async_queue_unref (workers);
+
+	return worker;
+}
+
+static void
+checkout_tree_thread (GTask        *task,
+                      gpointer      source_object,
+                      gpointer      task_data,
+                      GCancellable *cancellable)
+{
+	CheckoutTreeData *data = task_data;
+	GgitRepository *repository = source_object;
+	git_checkout_options options = GIT_CHECKOUT_OPTIONS_INIT;
+	CancellableCallbacks callbacks = { cancellable, };
+	git_object *tree = NULL;
+	GError *error = NULL;
+	gint ret = GIT_OK;
+
+	if (g_task_return_error_if_cancelled (task))
+	{
+		return;
+	}
+
+	if (data->worker != NULL)
+	{
+		repository = data->worker;
+	}
+
+	if (data->options != NULL)
+	{
+		options = *_ggit_checkout_options_get_checkout_options (data->options);
+	}
+
+	cancellable_callbacks_wrap_checkout (&callbacks, &options);
+
+	/* The object belongs to the caller's handle, look it up again on the
+	 * one we run on.
+	 */
+	if (data->tree != NULL)
+	{
+		ret = git_object_lookup (&tree,
+		                         _ggit_native_get (repository),
+		                         git_object_id (_ggit_native_get (data->tree)),
+		                         GIT_OBJ_ANY);
+	}
+
+	if (ret == GIT_OK)
+	{
+		ret = git_checkout_tree (_ggit_native_get (repository),
+		                         tree,
+		                         &options);
+
+		git_object_free (tree);
+	}
+
+	if (ret != GIT_OK)
+	{
+		set_error_cancellable (&error, ret, cancellable);
+		g_task_return_error (task, error);
+	}
+	else
+	{
+		g_task_return_boolean (task, TRUE);
+	}
+}
+
+/**
+ * ggit_repository_checkout_tree_async:
+ * @repository: a #GgitRepository.
+ * @tree: (allow-none): a #GgitObject or %NULL.
+ * @options: (allow-none): a #GgitCheckoutOptions or %NULL.
+ * @cancellable: (allow-none): a #GCancellable or %NULL.
+ * @callback: (scope async): a #GAsyncReadyCallback to call when the
+ *            checkout is finished.
+ * @user_data: (closure): the data to pass to @callback.
+ *
+ * Asynchronously update files in the working tree to reflect the contents
+ * of the specified commit, tag or tree object. See
+ * ggit_repository_checkout_tree() for the synchronous version of this call.
+ *
+ * The checkout runs on a worker thread, on a separate handle on the
+ * repository, so @repository stays usable in the meantime and the notify
+ * and progress callbacks of @options are invoked from that thread. When
+ * object database backends were added to @repository, which a separate
+ * handle would not see, the checkout runs on the calling thread instead.
+ * Cancelling @cancellable aborts the checkout while libgit2 works out
+ * which files to update; once files are being written the checkout runs
+ * to completion.
+ */
+void
+ggit_repository_checkout_tree_async (GgitRepository      *repository,
+                                     GgitObject          *tree,
+                                     GgitCheckoutOptions *options,
+                                     GCancellable        *cancellable,
+                                     GAsyncReadyCallback  callback,
+                                     gpointer             user_data)
+{
+	CheckoutTreeData *data;
+	GTask *task;
+
+	g_return_if_fail (GGIT_IS_REPOSITORY (repository));
+	g_return_if_fail (tree == NULL || GGIT_IS_OBJECT (tree));
+	g_return_if_fail (options == NULL || GGIT_IS_CHECKOUT_OPTIONS (options));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+	data = g_slice_new0 (CheckoutTreeData);
+	data->worker = open_async_worker (repository);
+	data->tree = tree != NULL ? g_object_ref (tree) : NULL;
+	data->options = options != NULL ? g_object_ref (options) : NULL;
+
+	task = g_task_new (repository, cancellable, callback, user_data);
+	g_task_set_source_tag (task, ggit_repository_checkout_tree_async);
+	g_task_set_task_data (task, data, (GDestroyNotify)checkout_tree_data_free);
+
+	if (data->worker != NULL)
+	{
+		g_task_run_in_thread (task, checkout_tree_thread);
+	}
+	else
+	{
+		checkout_tree_thread (task, repository, data, cancellable);
+	}
+
+	g_object_unref (task);
+}
+
+/**
+ * ggit_repository_checkout_tree_finish:
+ * @repository: a #GgitRepository.
+ * @result: a #GAsyncResult.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Finishes an operation started with ggit_repository_checkout_tree_async().
+ *
+ * Returns: %TRUE if the checkout was successfull, %FALSE otherwise.
+ */
+gboolean
+ggit_repository_checkout_tree_finish (GgitRepository  *repository,
+                                      GAsyncResult    *result,
+                                      GError         **error)
+{
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), FALSE);
+	g_return_val_if_fail (g_task_is_valid (result, repository), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	return g_task_propagate_boolean (G_TASK (result), error);
+}
+
 /**
  * ggit_repository_revert:
  * @repository: a #GgitRepository.
@@ -4090,6 +7025,264 @@ ggit_repository_merge (GgitRepository       *repository,
 	}
 }
 
+typedef struct
+{
+	GgitRepository *worker;
+	GgitAnnotatedCommit **their_heads;
+	gsize their_heads_length;
+	GgitMergeOptions *merge_opts;
+	GgitCheckoutOptions *checkout_opts;
+} MergeData;
+
+static void
+merge_data_free (MergeData *data)
+{
+	gsize i;
+
+	for (i = 0; i < data->their_heads_length; ++i)
+	{
+		ggit_annotated_commit_unref (data->their_heads[i]);
+	}
+
+	g_free (data->their_heads);
+
+	if (data->merge_opts != NULL)
+	{
+		ggit_merge_options_free (data->merge_opts);
+	}
+
+	g_clear_object (&data->checkout_opts);
+	g_clear_object (&data->worker);
+
+	g_slice_free (MergeData, data);
+}
+
+/* Look up @head again on @repository, keeping the reference it was made
+ * from, if any, so that the merge message names the same branch.
+ */
+static gint
+annotated_commit_lookup_on (git_annotated_commit       **out,
+                            git_repository              *repository,
+                            const git_annotated_commit  *head)
+{
+	const git_oid *id;
+
+	id = git_annotated_commit_id (head);
+
+#if LIBGIT2_VER_MAJOR > 0 || (LIBGIT2_VER_MAJOR == 0 && LIBGIT2_VER_MINOR >= 28)
+	if (git_annotated_commit_ref (head) != NULL)
+	{
+		git_reference *ref;
+
+		if (git_reference_lookup (&ref,
+		                          repository,
+		                          git_annotated_commit_ref (head)) == GIT_OK)
+		{
+			gint ret;
+
+			ret = git_annotated_commit_from_ref (out, repository, ref);
+			git_reference_free (ref);
+
+			if (ret == GIT_OK &&
+			    git_oid_equal (git_annotated_commit_id (*out), id))
+			{
+				return GIT_OK;
+			}
+
+			if (ret == GIT_OK)
+			{
+				/* the branch moved since, merge what the caller asked for */
+				git_annotated_commit_free (*out);
+			}
+		}
+	}
+#endif
+
+	return git_annotated_commit_lookup (out, repository, id);
+}
+
+static void
+merge_thread (GTask        *task,
+              gpointer      source_object,
+              gpointer      task_data,
+              GCancellable *cancellable)
+{
+	MergeData *data = task_data;
+	GgitRepository *repository = source_object;
+	git_checkout_options options = GIT_CHECKOUT_OPTIONS_INIT;
+	CancellableCallbacks callbacks = { cancellable, };
+	git_annotated_commit **their_heads_native;
+	GError *error = NULL;
+	gsize i;
+	gint ret = GIT_OK;
+
+	if (g_task_return_error_if_cancelled (task))
+	{
+		return;
+	}
+
+	if (data->worker != NULL)
+	{
+		repository = data->worker;
+	}
+
+	if (data->checkout_opts != NULL)
+	{
+		options = *_ggit_checkout_options_get_checkout_options (data->checkout_opts);
+	}
+
+	cancellable_callbacks_wrap_checkout (&callbacks, &options);
+
+	their_heads_native = g_new0 (git_annotated_commit *,
+	                             data->their_heads_length);
+
+	/* The heads belong to the caller's handle, look them up again on the
+	 * one we run on.
+	 */
+	for (i = 0; i < data->their_heads_length && ret == GIT_OK; ++i)
+	{
+		git_annotated_commit *head;
+
+		head = _ggit_annotated_commit_get_annotated_commit (data->their_heads[i]);
+
+		if (data->worker != NULL)
+		{
+			ret = annotated_commit_lookup_on (&their_heads_native[i],
+			                                  _ggit_native_get (repository),
+			                                  head);
+		}
+		else
+		{
+			their_heads_native[i] = head;
+		}
+	}
+
+	if (ret == GIT_OK)
+	{
+		ret = git_merge (_ggit_native_get (repository),
+		                 (const git_annotated_commit **)their_heads_native,
+		                 data->their_heads_length,
+		                 _ggit_merge_options_get_merge_options (data->merge_opts),
+		                 &options);
+	}
+
+	if (data->worker != NULL)
+	{
+		for (i = 0; i < data->their_heads_length; ++i)
+		{
+			git_annotated_commit_free (their_heads_native[i]);
+		}
+	}
+
+	g_free (their_heads_native);
+
+	if (ret != GIT_OK)
+	{
+		set_error_cancellable (&error, ret, cancellable);
+		g_task_return_error (task, error);
+	}
+	else
+	{
+		g_task_return_boolean (task, TRUE);
+	}
+}
+
+/**
+ * ggit_repository_merge_async:
+ * @repository: a #GgitRepository.
+ * @their_heads: (array length=their_heads_length): the heads to merge into
+ * @their_heads_length: the length of their_heads
+ * @merge_opts: (allow-none): merge options
+ * @checkout_opts: (allow-none): checkout options
+ * @cancellable: (allow-none): a #GCancellable or %NULL.
+ * @callback: (scope async): a #GAsyncReadyCallback to call when the
+ *            merge is finished.
+ * @user_data: (closure): the data to pass to @callback.
+ *
+ * Asynchronously merges the given commit(s) into HEAD on a worker thread.
+ * See ggit_repository_merge() for the synchronous version of this call.
+ * Like ggit_repository_checkout_tree_async(), the merge runs on a separate
+ * handle on the repository, so @repository stays usable in the meantime,
+ * unless object database backends were added to @repository, in which
+ * case the merge runs on the calling thread. Cancelling @cancellable
+ * aborts the checkout of the merge result before libgit2 starts writing
+ * files.
+ */
+void
+ggit_repository_merge_async (GgitRepository       *repository,
+                             GgitAnnotatedCommit **their_heads,
+                             gsize                 their_heads_length,
+                             GgitMergeOptions     *merge_opts,
+                             GgitCheckoutOptions  *checkout_opts,
+                             GCancellable         *cancellable,
+                             GAsyncReadyCallback   callback,
+                             gpointer              user_data)
+{
+	MergeData *data;
+	GTask *task;
+	gsize i;
+
+	g_return_if_fail (GGIT_IS_REPOSITORY (repository));
+	g_return_if_fail (their_heads != NULL);
+	g_return_if_fail (their_heads_length > 0);
+	g_return_if_fail (checkout_opts == NULL || GGIT_IS_CHECKOUT_OPTIONS (checkout_opts));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+	data = g_slice_new0 (MergeData);
+	data->worker = open_async_worker (repository);
+	data->their_heads = g_new (GgitAnnotatedCommit *, their_heads_length);
+	data->their_heads_length = their_heads_length;
+
+	for (i = 0; i < their_heads_length; ++i)
+	{
+		data->their_heads[i] = ggit_annotated_commit_ref (their_heads[i]);
+	}
+
+	if (merge_opts != NULL)
+	{
+		data->merge_opts = ggit_merge_options_copy (merge_opts);
+	}
+
+	data->checkout_opts = checkout_opts != NULL ? g_object_ref (checkout_opts) : NULL;
+
+	task = g_task_new (repository, cancellable, callback, user_data);
+	g_task_set_source_tag (task, ggit_repository_merge_async);
+	g_task_set_task_data (task, data, (GDestroyNotify)merge_data_free);
+
+	if (data->worker != NULL)
+	{
+		g_task_run_in_thread (task, merge_thread);
+	}
+	else
+	{
+		merge_thread (task, repository, data, cancellable);
+	}
+
+	g_object_unref (task);
+}
+
+/**
+ * ggit_repository_merge_finish:
+ * @repository: a #GgitRepository.
+ * @result: a #GAsyncResult.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Finishes an operation started with ggit_repository_merge_async().
+ *
+ * Returns: %TRUE if the merge was successfull, %FALSE otherwise.
+ */
+gboolean
+ggit_repository_merge_finish (GgitRepository  *repository,
+                              GAsyncResult    *result,
+                              GError         **error)
+{
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), FALSE);
+	g_return_val_if_fail (g_task_is_valid (result, repository), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	return g_task_propagate_boolean (G_TASK (result), error);
+}
+
 /**
  * ggit_repository_merge_base:
  * @repository: a #GgitRepository.
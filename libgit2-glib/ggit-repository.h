@@ -27,6 +27,8 @@
 #include <gio/gio.h>
 #include <libgit2-glib/ggit-config.h>
 #include <libgit2-glib/ggit-index.h>
+#include <libgit2-glib/ggit-odb.h>
+#include <libgit2-glib/ggit-oid-array.h>
 #include <libgit2-glib/ggit-types.h>
 #include <libgit2-glib/ggit-native.h>
 #include <libgit2-glib/ggit-object.h>
@@ -38,6 +40,7 @@
 #include <libgit2-glib/ggit-blame.h>
 #include <libgit2-glib/ggit-cherry-pick-options.h>
 #include <libgit2-glib/ggit-commit.h>
+#include <libgit2-glib/ggit-commit-info.h>
 #include <libgit2-glib/ggit-tree-builder.h>
 #include <libgit2-glib/ggit-remote.h>
 #include <libgit2-glib/ggit-rebase.h>
@@ -80,23 +83,93 @@ GgitRepository     *_ggit_repository_wrap             (git_repository        *re
 
 git_repository     *_ggit_repository_get_repository   (GgitRepository        *repository);
 
+const gchar        *_ggit_repository_get_attribute_cached (
+                                                       GgitRepository          *repository,
+                                                       const gchar             *path,
+                                                       const gchar             *name,
+                                                       GgitAttributeCheckFlags  flags);
+
+void                _ggit_repository_begin_attribute_batch (
+                                                       GgitRepository        *repository);
+
+void                _ggit_repository_end_attribute_batch (
+                                                       GgitRepository        *repository);
+
+GgitRepository     *_ggit_repository_open_worker      (GgitRepository        *repository,
+                                                       GError               **error);
+
+GAsyncQueue        *_ggit_repository_open_workers     (GgitRepository        *repository,
+                                                       gint                   n_workers);
+
 GgitRepository     *ggit_repository_open              (GFile                 *location,
                                                        GError               **error);
 
+void                ggit_repository_open_async        (GFile                 *location,
+                                                       GCancellable          *cancellable,
+                                                       GAsyncReadyCallback    callback,
+                                                       gpointer               user_data);
+
+GgitRepository     *ggit_repository_open_finish       (GAsyncResult          *result,
+                                                       GError               **error);
+
 GgitRepository     *ggit_repository_init_repository   (GFile                 *location,
                                                        gboolean               is_bare,
                                                        GError               **error);
 
+void                ggit_repository_init_repository_async (
+                                                       GFile                 *location,
+                                                       gboolean               is_bare,
+                                                       GCancellable          *cancellable,
+                                                       GAsyncReadyCallback    callback,
+                                                       gpointer               user_data);
+
+GgitRepository     *ggit_repository_init_repository_finish (
+                                                       GAsyncResult          *result,
+                                                       GError               **error);
+
 GgitRepository     *ggit_repository_clone             (const gchar           *url,
                                                        GFile                 *location,
                                                        GgitCloneOptions      *options,
                                                        GError               **error);
 
+void                ggit_repository_clone_async       (const gchar           *url,
+                                                       GFile                 *location,
+                                                       GgitCloneOptions      *options,
+                                                       GCancellable          *cancellable,
+                                                       GAsyncReadyCallback    callback,
+                                                       gpointer               user_data);
+
+GgitRepository     *ggit_repository_clone_finish      (GAsyncResult          *result,
+                                                       GError               **error);
+
 GgitObject         *ggit_repository_lookup            (GgitRepository        *repository,
                                                        GgitOId               *oid,
                                                        GType                  gtype,
                                                        GError               **error);
 
+GPtrArray          *ggit_repository_lookup_many       (GgitRepository        *repository,
+                                                       GgitOId              **oids,
+                                                       gsize                  n_oids,
+                                                       GType                  gtype,
+                                                       GError               **error);
+
+GPtrArray          *ggit_repository_read_many         (GgitRepository        *repository,
+                                                       GgitOId              **oids,
+                                                       gsize                  n_oids,
+                                                       guint                  n_threads,
+                                                       GArray               **types,
+                                                       GError               **error);
+
+gchar             **ggit_repository_shorten_oids      (GgitRepository        *repository,
+                                                       GgitOId              **oids,
+                                                       gsize                  n_oids,
+                                                       guint                  min_length,
+                                                       GError               **error);
+
+GgitOIdArray       *ggit_repository_find_oids_by_prefix (GgitRepository      *repository,
+                                                         const gchar         *prefix,
+                                                         GError             **error);
+
 GgitRef            *ggit_repository_lookup_reference  (GgitRepository        *repository,
                                                        const gchar           *name,
                                                        GError               **error);
@@ -246,10 +319,19 @@ GgitBlob           *ggit_repository_lookup_blob       (GgitRepository        *re
                                                        GgitOId               *oid,
                                                              GError         **error);
 
+GInputStream       *ggit_repository_open_blob_stream  (GgitRepository        *repository,
+                                                       GgitOId               *oid,
+                                                       goffset               *size,
+                                                       GError               **error);
+
 GgitCommit         *ggit_repository_lookup_commit     (GgitRepository        *repository,
                                                        GgitOId               *oid,
                                                        GError               **error);
 
+GgitCommitInfo     *ggit_repository_lookup_commit_info (GgitRepository       *repository,
+                                                        GgitOId              *oid,
+                                                        GError              **error);
+
 GgitTag            *ggit_repository_lookup_tag        (GgitRepository        *repository,
                                                        GgitOId               *oid,
                                                        GError               **error);
@@ -342,6 +424,27 @@ gboolean            ggit_repository_file_status_foreach
                                                       gpointer                user_data,
                                                       GError                **error);
 
+void                ggit_repository_file_status_foreach_async
+                                                     (GgitRepository         *repository,
+                                                      GgitStatusOptions      *options,
+                                                      GCancellable           *cancellable,
+                                                      GAsyncReadyCallback     callback,
+                                                      gpointer                user_data);
+
+GHashTable         *ggit_repository_file_status_foreach_finish
+                                                     (GgitRepository         *repository,
+                                                      GAsyncResult           *result,
+                                                      GError                **error);
+
+gboolean            ggit_repository_file_status_foreach_parallel
+                                                     (GgitRepository         *repository,
+                                                      GgitStatusOptions      *options,
+                                                      gint                    n_threads,
+                                                      gboolean                use_untracked_cache,
+                                                      GgitStatusCallback      callback,
+                                                      gpointer                user_data,
+                                                      GError                **error);
+
 gboolean            ggit_repository_references_foreach (GgitRepository             *repository,
                                                         GgitReferencesCallback      callback,
                                                         gpointer                    user_data,
@@ -355,6 +458,9 @@ gboolean            ggit_repository_references_foreach_name (GgitRepository
 GgitConfig         *ggit_repository_get_config         (GgitRepository          *repository,
                                                         GError                 **error);
 
+GgitOdb            *ggit_repository_get_odb           (GgitRepository        *repository,
+                                                       GError               **error);
+
 GgitIndex          *ggit_repository_get_index          (GgitRepository          *repository,
                                                         GError                 **error);
 
@@ -434,17 +540,34 @@ gboolean            ggit_repository_get_descendant_of (GgitRepository        *re
                                                        GgitOId               *ancestor,
                                                        GError               **error);
 
+gboolean            ggit_repository_write_commit_graph (GgitRepository       *repository,
+                                                        GError              **error);
+
 GgitBlame          *ggit_repository_blame_file        (GgitRepository        *repository,
                                                        GFile                 *file,
                                                        GgitBlameOptions      *blame_options,
                                                        GError               **error);
 
+void                ggit_repository_blame_file_async  (GgitRepository        *repository,
+                                                       GFile                 *file,
+                                                       GgitBlameOptions      *blame_options,
+                                                       GCancellable          *cancellable,
+                                                       GAsyncReadyCallback    callback,
+                                                       gpointer               user_data);
+
+GgitBlame          *ggit_repository_blame_file_finish (GgitRepository        *repository,
+                                                       GAsyncResult          *result,
+                                                       GError               **error);
+
 const gchar        *ggit_repository_get_attribute     (GgitRepository           *repository,
                                                        const gchar              *path,
                                                        const gchar              *name,
                                                        GgitAttributeCheckFlags   flags,
                                                        GError                  **error);
 
+void                ggit_repository_clear_attribute_cache (
+                                                       GgitRepository           *repository);
+
 gboolean            ggit_repository_checkout_head     (GgitRepository           *repository,
                                                        GgitCheckoutOptions      *options,
                                                        GError                  **error);
@@ -459,6 +582,17 @@ gboolean            ggit_repository_checkout_tree     (GgitRepository
                                                        GgitCheckoutOptions      *options,
                                                        GError                  **error);
 
+void                ggit_repository_checkout_tree_async (GgitRepository         *repository,
+                                                         GgitObject             *tree,
+                                                         GgitCheckoutOptions    *options,
+                                                         GCancellable           *cancellable,
+                                                         GAsyncReadyCallback     callback,
+                                                         gpointer                user_data);
+
+gboolean            ggit_repository_checkout_tree_finish (GgitRepository        *repository,
+                                                          GAsyncResult          *result,
+                                                          GError               **error);
+
 gboolean            ggit_repository_revert            (GgitRepository           *repository,
                                                        GgitCommit               *commit,
                                                        GgitRevertOptions        *options,
@@ -516,6 +650,19 @@ void                ggit_repository_merge              (GgitRepository
                                                         GgitCheckoutOptions     *checkout_opts,
                                                         GError                 **error);
 
+void                ggit_repository_merge_async        (GgitRepository          *repository,
+                                                        GgitAnnotatedCommit    **their_heads,
+                                                        gsize                    their_heads_length,
+                                                        GgitMergeOptions        *merge_opts,
+                                                        GgitCheckoutOptions     *checkout_opts,
+                                                        GCancellable            *cancellable,
+                                                        GAsyncReadyCallback      callback,
+                                                        gpointer                 user_data);
+
+gboolean            ggit_repository_merge_finish       (GgitRepository          *repository,
+                                                        GAsyncResult            *result,
+                                                        GError                 **error);
+
 GgitOId            *ggit_repository_merge_base         (GgitRepository          *repository,
                                                         GgitOId                 *oid_one,
                                                         GgitOId                 *oid_two,
@@ -19,11 +19,13 @@
  */
 
 
+#include <string.h>
 #include <gio/gio.h>
 #include <git2.h>
 
 #include "ggit-error.h"
 #include "ggit-oid.h"
+#include "ggit-oid-set.h"
 #include "ggit-repository.h"
 #include "ggit-revision-walker.h"
 
@@ -33,9 +35,25 @@
  * Represents a revision walker.
  */
 
+G_STATIC_ASSERT (sizeof (git_oid) == GGIT_OID_RAWSZ);
+
 typedef struct _GgitRevisionWalkerPrivate
 {
 	GgitRepository *repository;
+	GgitSortMode sort_mode;
+
+	/* the paths the walk is limited to, each split in components */
+	gchar **paths;
+	GPtrArray *path_components;
+
+	/* parents followed and pruned by the commits walked so far */
+	GgitOIdSet *followed;
+	GgitOIdSet *pruned;
+
+	/* an error hit by a batch call after it walked some commits, it is
+	 * reported by the next call instead
+	 */
+	gint pending_error;
 } GgitRevisionWalkerPrivate;
 
 enum
@@ -109,6 +127,27 @@ ggit_revision_walker_dispose (GObject *object)
 	G_OBJECT_CLASS (ggit_revision_walker_parent_class)->dispose (object);
 }
 
+static void
+ggit_revision_walker_finalize (GObject *object)
+{
+	GgitRevisionWalker *walker = GGIT_REVISION_WALKER (object);
+	GgitRevisionWalkerPrivate *priv;
+
+	priv = ggit_revision_walker_get_instance_private (walker);
+
+	g_strfreev (priv->paths);
+
+	if (priv->path_components != NULL)
+	{
+		g_ptr_array_unref (priv->path_components);
+	}
+
+	ggit_oid_set_unref (priv->followed);
+	ggit_oid_set_unref (priv->pruned);
+
+	G_OBJECT_CLASS (ggit_revision_walker_parent_class)->finalize (object);
+}
+
 static void
 ggit_revision_walker_class_init (GgitRevisionWalkerClass *klass)
 {
@@ -117,6 +156,7 @@ ggit_revision_walker_class_init (GgitRevisionWalkerClass *klass)
 	object_class->get_property = ggit_revision_walker_get_property;
 	object_class->set_property = ggit_revision_walker_set_property;
 	object_class->dispose = ggit_revision_walker_dispose;
+	object_class->finalize = ggit_revision_walker_finalize;
 
 	g_object_class_install_property (object_class,
 	                                 PROP_REPOSITORY,
@@ -132,6 +172,12 @@ ggit_revision_walker_class_init (GgitRevisionWalkerClass *klass)
 static void
 ggit_revision_walker_init (GgitRevisionWalker *revwalk)
 {
+	GgitRevisionWalkerPrivate *priv;
+
+	priv = ggit_revision_walker_get_instance_private (revwalk);
+
+	priv->followed = ggit_oid_set_new (0);
+	priv->pruned = ggit_oid_set_new (0);
 }
 
 static gboolean
@@ -206,6 +252,352 @@ ggit_revision_walker_new (GgitRepository  *repository,
 	                       NULL);
 }
 
+static void
+clear_simplification (GgitRevisionWalker *walker)
+{
+	GgitRevisionWalkerPrivate *priv;
+
+	priv = ggit_revision_walker_get_instance_private (walker);
+
+	ggit_oid_set_clear (priv->followed);
+	ggit_oid_set_clear (priv->pruned);
+}
+
+/* Keeps the commits walked by a batch call before it hit an error, which
+ * the walker has already moved past, and reports @err on the next call.
+ * Returns %TRUE if the batch should be returned.
+ */
+static gboolean
+defer_error (GgitRevisionWalker *walker,
+             guint               n_walked,
+             gint                err)
+{
+	GgitRevisionWalkerPrivate *priv;
+
+	if (n_walked == 0)
+	{
+		return FALSE;
+	}
+
+	priv = ggit_revision_walker_get_instance_private (walker);
+	priv->pending_error = err;
+
+	return TRUE;
+}
+
+/* Compares the entries of @a and @b along @components, descending only
+ * into subtrees that differ. A missing tree is treated as empty.
+ */
+static gint
+same_along_path (git_repository  *repo,
+                 git_tree        *a,
+                 git_tree        *b,
+                 gchar          **components,
+                 gboolean        *same)
+{
+	git_tree *owned_a = NULL;
+	git_tree *owned_b = NULL;
+	gint ret = GIT_OK;
+
+	if (*components == NULL)
+	{
+		/* the whole tree */
+		if (a != NULL && b != NULL)
+		{
+			*same = git_oid_equal (git_tree_id (a), git_tree_id (b));
+		}
+		else
+		{
+			*same = (a == NULL || git_tree_entrycount (a) == 0) &&
+			        (b == NULL || git_tree_entrycount (b) == 0);
+		}
+
+		return GIT_OK;
+	}
+
+	for (; *components != NULL; ++components)
+	{
+		const git_tree_entry *entry_a;
+		const git_tree_entry *entry_b;
+		git_tree *next_a = NULL;
+		git_tree *next_b = NULL;
+
+		entry_a = a != NULL ? git_tree_entry_byname (a, *components) : NULL;
+		entry_b = b != NULL ? git_tree_entry_byname (b, *components) : NULL;
+
+		if (entry_a == NULL && entry_b == NULL)
+		{
+			*same = TRUE;
+			break;
+		}
+
+		if (entry_a == NULL || entry_b == NULL)
+		{
+			*same = FALSE;
+			break;
+		}
+
+		if (git_oid_equal (git_tree_entry_id (entry_a), git_tree_entry_id (entry_b)) &&
+		    git_tree_entry_filemode (entry_a) == git_tree_entry_filemode (entry_b))
+		{
+			*same = TRUE;
+			break;
+		}
+
+		if (components[1] == NULL)
+		{
+			*same = FALSE;
+			break;
+		}
+
+		/* a file on one side only has nothing below it */
+		if (git_tree_entry_type (entry_a) == GIT_OBJ_TREE)
+		{
+			ret = git_tree_lookup (&next_a, repo, git_tree_entry_id (entry_a));
+		}
+
+		if (ret == GIT_OK && git_tree_entry_type (entry_b) == GIT_OBJ_TREE)
+		{
+			ret = git_tree_lookup (&next_b, repo, git_tree_entry_id (entry_b));
+		}
+
+		git_tree_free (owned_a);
+		git_tree_free (owned_b);
+
+		a = owned_a = next_a;
+		b = owned_b = next_b;
+
+		if (ret != GIT_OK)
+		{
+			break;
+		}
+	}
+
+	git_tree_free (owned_a);
+	git_tree_free (owned_b);
+
+	return ret;
+}
+
+static gint
+same_along_paths (GgitRevisionWalkerPrivate *priv,
+                  git_repository            *repo,
+                  git_tree                  *a,
+                  git_tree                  *b,
+                  gboolean                  *same)
+{
+	guint i;
+	gint ret = GIT_OK;
+
+	*same = TRUE;
+
+	for (i = 0; i < priv->path_components->len && *same && ret == GIT_OK; ++i)
+	{
+		ret = same_along_path (repo,
+		                       a,
+		                       b,
+		                       g_ptr_array_index (priv->path_components, i),
+		                       same);
+	}
+
+	return ret;
+}
+
+/* Decides whether the commit @id touches the paths of the walk. Like
+ * "git log -- paths", a merge that leaves the paths as in one of its
+ * parents is not shown and only that parent is followed, which prunes the
+ * other side of the merge unless it is also reachable otherwise.
+ */
+static gint
+filter_commit (GgitRevisionWalker *walker,
+               const git_oid      *id,
+               gboolean           *shown)
+{
+	GgitRevisionWalkerPrivate *priv;
+	git_repository *repo;
+	git_commit *commit;
+	git_tree *tree = NULL;
+	gboolean simplify;
+	gboolean live;
+	guint n_parents;
+	gint same_parent = -1;
+	guint i;
+	gint ret;
+
+	priv = ggit_revision_walker_get_instance_private (walker);
+	repo = _ggit_repository_get_repository (priv->repository);
+
+	/* pruning needs all the children of a commit to be walked before it */
+	simplify = (priv->sort_mode & GGIT_SORT_TOPOLOGICAL) != 0;
+
+	live = !simplify ||
+	       _ggit_oid_set_remove_oid (priv->followed, id) ||
+	       !_ggit_oid_set_contains_oid (priv->pruned, id);
+
+	_ggit_oid_set_remove_oid (priv->pruned, id);
+
+	ret = git_commit_lookup (&commit, repo, id);
+
+	if (ret != GIT_OK)
+	{
+		return ret;
+	}
+
+	n_parents = git_commit_parentcount (commit);
+	*shown = FALSE;
+
+	if (!live)
+	{
+		for (i = 0; i < n_parents; ++i)
+		{
+			_ggit_oid_set_add_oid (priv->pruned, git_commit_parent_id (commit, i));
+		}
+
+		git_commit_free (commit);
+		return GIT_OK;
+	}
+
+	if (n_parents == 0)
+	{
+		gboolean same;
+
+		ret = git_commit_tree (&tree, commit);
+
+		if (ret == GIT_OK)
+		{
+			ret = same_along_paths (priv, repo, NULL, tree, &same);
+			*shown = !same;
+		}
+	}
+
+	for (i = 0; i < n_parents && same_parent < 0 && ret == GIT_OK; ++i)
+	{
+		git_commit *parent;
+		git_tree *parent_tree;
+		gboolean same;
+
+		ret = git_commit_parent (&parent, commit, i);
+
+		if (ret != GIT_OK)
+		{
+			break;
+		}
+
+		if (git_oid_equal (git_commit_tree_id (parent), git_commit_tree_id (commit)))
+		{
+			same_parent = i;
+			git_commit_free (parent);
+
+			break;
+		}
+
+		if (tree == NULL)
+		{
+			ret = git_commit_tree (&tree, commit);
+		}
+
+		if (ret == GIT_OK)
+		{
+			ret = git_commit_tree (&parent_tree, parent);
+		}
+
+		if (ret == GIT_OK)
+		{
+			ret = same_along_paths (priv, repo, parent_tree, tree, &same);
+			git_tree_free (parent_tree);
+
+			if (ret == GIT_OK && same)
+			{
+				same_parent = i;
+			}
+		}
+
+		git_commit_free (parent);
+	}
+
+	if (ret == GIT_OK && n_parents > 0)
+	{
+		*shown = same_parent < 0;
+	}
+
+	if (ret == GIT_OK && simplify)
+	{
+		for (i = 0; i < n_parents; ++i)
+		{
+			const git_oid *parent_id = git_commit_parent_id (commit, i);
+
+			if (same_parent < 0 || (guint)same_parent == i)
+			{
+				_ggit_oid_set_add_oid (priv->followed, parent_id);
+			}
+			else
+			{
+				_ggit_oid_set_add_oid (priv->pruned, parent_id);
+			}
+		}
+	}
+
+	git_tree_free (tree);
+	git_commit_free (commit);
+
+	return ret;
+}
+
+/*
+ * _ggit_revision_walker_next_id:
+ * @walker: a #GgitRevisionWalker.
+ * @oid: return location for the id of the next commit.
+ *
+ * Gets the next commit of the walk, skipping the commits which do not
+ * touch the paths set with ggit_revision_walker_set_paths().
+ *
+ * Returns: %GIT_OK, %GIT_ITEROVER at the end of the walk or an error code.
+ */
+gint
+_ggit_revision_walker_next_id (GgitRevisionWalker *walker,
+                               git_oid            *oid)
+{
+	GgitRevisionWalkerPrivate *priv;
+	git_revwalk *revwalk;
+
+	priv = ggit_revision_walker_get_instance_private (walker);
+	revwalk = _ggit_native_get (walker);
+
+	if (priv->pending_error != GIT_OK)
+	{
+		gint ret = priv->pending_error;
+
+		priv->pending_error = GIT_OK;
+		return ret;
+	}
+
+	while (TRUE)
+	{
+		gboolean shown;
+		gint ret;
+
+		ret = git_revwalk_next (oid, revwalk);
+
+		if (ret == GIT_ITEROVER)
+		{
+			/* the walker resets itself at the end of the walk */
+			clear_simplification (walker);
+		}
+
+		if (ret != GIT_OK || priv->path_components == NULL)
+		{
+			return ret;
+		}
+
+		ret = filter_commit (walker, oid, &shown);
+
+		if (ret != GIT_OK || shown)
+		{
+			return ret;
+		}
+	}
+}
+
 /**
  * ggit_revision_walker_reset:
  * @walker: a #GgitRevisionWalker.
@@ -223,9 +615,15 @@ ggit_revision_walker_new (GgitRepository  *repository,
 void
 ggit_revision_walker_reset (GgitRevisionWalker *walker)
 {
+	GgitRevisionWalkerPrivate *priv;
+
 	g_return_if_fail (GGIT_IS_REVISION_WALKER (walker));
 
+	priv = ggit_revision_walker_get_instance_private (walker);
+
 	git_revwalk_reset (_ggit_native_get (walker));
+	clear_simplification (walker);
+	priv->pending_error = GIT_OK;
 }
 
 /**
@@ -530,7 +928,7 @@ ggit_revision_walker_next (GgitRevisionWalker  *walker,
 	g_return_val_if_fail (GGIT_IS_REVISION_WALKER (walker), NULL);
 	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
-	ret = git_revwalk_next (&oid, _ggit_native_get (walker));
+	ret = _ggit_revision_walker_next_id (walker, &oid);
 
 	if (ret == GIT_OK)
 	{
@@ -544,6 +942,145 @@ ggit_revision_walker_next (GgitRevisionWalker  *walker,
 	return goid;
 }
 
+/**
+ * ggit_revision_walker_next_n:
+ * @walker: a #GgitRevisionWalker.
+ * @max_count: the maximum number of commits to return.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Gets up to @max_count next commits from the revision walk in a single
+ * call. The ids are returned as consecutive raw object ids of
+ * %GGIT_OID_RAWSZ bytes each, so the number of commits returned is the
+ * size of the buffer divided by %GGIT_OID_RAWSZ.
+ *
+ * This avoids allocating a #GgitOId for every step of the walk, which
+ * matters when walking large histories (or from language bindings). An
+ * empty buffer is returned when the walk is over.
+ *
+ * When an error occurs after some commits were walked, those commits are
+ * returned and the error is reported by the next call.
+ *
+ * Returns: (transfer full) (nullable): the raw ids of the next commits
+ *          or %NULL if there was an error.
+ */
+GBytes *
+ggit_revision_walker_next_n (GgitRevisionWalker  *walker,
+                             guint                max_count,
+                             GError             **error)
+{
+	git_oid *oids;
+	guint n = 0;
+	gint ret = GIT_OK;
+
+	g_return_val_if_fail (GGIT_IS_REVISION_WALKER (walker), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	oids = g_new (git_oid, max_count);
+
+	while (n < max_count)
+	{
+		ret = _ggit_revision_walker_next_id (walker, &oids[n]);
+
+		if (ret != GIT_OK)
+		{
+			break;
+		}
+
+		++n;
+	}
+
+	if (ret != GIT_OK && ret != GIT_ITEROVER && !defer_error (walker, n, ret))
+	{
+		_ggit_error_set (error, ret);
+		g_free (oids);
+
+		return NULL;
+	}
+
+	return g_bytes_new_take (oids, n * sizeof (git_oid));
+}
+
+/**
+ * ggit_revision_walker_next_commits:
+ * @walker: a #GgitRevisionWalker.
+ * @max_count: the maximum number of commits to return.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Gets up to @max_count next commits from the revision walk, together with
+ * their parsed metadata, in a single call. This is equivalent to calling
+ * ggit_revision_walker_next() and looking up each commit, but no objects
+ * are created for the individual commits. An empty array is returned when
+ * the walk is over. As with ggit_revision_walker_next_n(), an error that
+ * occurs after some commits were walked is reported by the next call.
+ *
+ * Returns: (transfer full) (element-type GgitRevisionWalkerCommit) (nullable):
+ *          the next commits or %NULL if there was an error.
+ */
+GArray *
+ggit_revision_walker_next_commits (GgitRevisionWalker  *walker,
+                                   guint                max_count,
+                                   GError             **error)
+{
+	GgitRevisionWalkerPrivate *priv;
+	git_repository *repo;
+	GArray *ret;
+	gint err = GIT_OK;
+
+	g_return_val_if_fail (GGIT_IS_REVISION_WALKER (walker), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	priv = ggit_revision_walker_get_instance_private (walker);
+
+	repo = _ggit_repository_get_repository (priv->repository);
+
+	ret = g_array_sized_new (FALSE,
+	                         FALSE,
+	                         sizeof (GgitRevisionWalkerCommit),
+	                         max_count);
+
+	while (ret->len < max_count)
+	{
+		GgitRevisionWalkerCommit *entry;
+		git_commit *commit;
+		git_oid oid;
+
+		err = _ggit_revision_walker_next_id (walker, &oid);
+
+		if (err != GIT_OK)
+		{
+			break;
+		}
+
+		err = git_commit_lookup (&commit, repo, &oid);
+
+		if (err != GIT_OK)
+		{
+			break;
+		}
+
+		g_array_set_size (ret, ret->len + 1);
+		entry = &g_array_index (ret, GgitRevisionWalkerCommit, ret->len - 1);
+
+		memcpy (entry->id, oid.id, GGIT_OID_RAWSZ);
+		memcpy (entry->tree_id, git_commit_tree_id (commit)->id, GGIT_OID_RAWSZ);
+		entry->time = git_commit_time (commit);
+		entry->time_offset = git_commit_time_offset (commit);
+		entry->parent_count = git_commit_parentcount (commit);
+
+		git_commit_free (commit);
+	}
+
+	if (err != GIT_OK && err != GIT_ITEROVER && !defer_error (walker, ret->len, err))
+	{
+		_ggit_error_set (error, err);
+		g_array_unref (ret);
+
+		return NULL;
+	}
+
+	return ret;
+}
+
 /**
  * ggit_revision_walker_set_sort_mode:
  * @walker: a #GgitRevisionWalker.
@@ -558,9 +1095,119 @@ void
 ggit_revision_walker_set_sort_mode (GgitRevisionWalker *walker,
                                     GgitSortMode        sort_mode)
 {
+	GgitRevisionWalkerPrivate *priv;
+
 	g_return_if_fail (GGIT_IS_REVISION_WALKER (walker));
 
+	priv = ggit_revision_walker_get_instance_private (walker);
+	priv->sort_mode = sort_mode;
+
 	git_revwalk_sorting (_ggit_native_get (walker), sort_mode);
+	clear_simplification (walker);
+}
+
+/**
+ * ggit_revision_walker_set_paths:
+ * @walker: a #GgitRevisionWalker.
+ * @paths: (array zero-terminated=1) (allow-none): a %NULL terminated list
+ *         of paths, or %NULL.
+ *
+ * Limits the walk to the commits touching @paths, like "git log -- paths".
+ * The paths are literal and relative to the root of the repository, a
+ * directory includes everything below it. A commit is skipped when its
+ * tree is the same as the tree of one of its parents along @paths, which
+ * is decided by comparing only the tree entries leading to @paths, so
+ * identical subtrees are never read.
+ *
+ * When the sort mode includes %GGIT_SORT_TOPOLOGICAL, the history is also
+ * simplified: when a merge leaves @paths as in one of its parents, only
+ * that parent is followed, so the commits of the other side of the merge
+ * are only shown if they are otherwise reachable. Without topological
+ * sorting, the children of a commit are not guaranteed to be walked
+ * before it and commits are only filtered.
+ *
+ * The commits of a pruned side are not hidden from the underlying walk:
+ * hiding them would also hide their ancestors that are reachable through
+ * the followed parent. They are still walked, and each of them costs a
+ * commit lookup to carry the pruning on to its parents, but their trees
+ * are not compared.
+ *
+ * Pass %NULL to walk all the commits again.
+ */
+void
+ggit_revision_walker_set_paths (GgitRevisionWalker  *walker,
+                                const gchar * const *paths)
+{
+	GgitRevisionWalkerPrivate *priv;
+
+	g_return_if_fail (GGIT_IS_REVISION_WALKER (walker));
+
+	priv = ggit_revision_walker_get_instance_private (walker);
+
+	g_strfreev (priv->paths);
+	priv->paths = NULL;
+
+	if (priv->path_components != NULL)
+	{
+		g_ptr_array_unref (priv->path_components);
+		priv->path_components = NULL;
+	}
+
+	clear_simplification (walker);
+
+	if (paths == NULL || *paths == NULL)
+	{
+		return;
+	}
+
+	priv->paths = g_strdupv ((gchar **)paths);
+	priv->path_components = g_ptr_array_new_with_free_func ((GDestroyNotify)g_strfreev);
+
+	for (; *paths != NULL; ++paths)
+	{
+		GPtrArray *components;
+		gchar **parts;
+		gchar **part;
+
+		components = g_ptr_array_new ();
+		parts = g_strsplit (*paths, "/", -1);
+
+		/* "" and "." stand for the whole tree */
+		for (part = parts; *part != NULL; ++part)
+		{
+			if (**part != '\0' && strcmp (*part, ".") != 0)
+			{
+				g_ptr_array_add (components, g_strdup (*part));
+			}
+		}
+
+		g_ptr_array_add (components, NULL);
+		g_ptr_array_add (priv->path_components, g_ptr_array_free (components, FALSE));
+
+		g_strfreev (parts);
+	}
+}
+
+/**
+ * ggit_revision_walker_get_paths:
+ * @walker: a #GgitRevisionWalker.
+ *
+ * Gets the paths the walk is limited to, see
+ * ggit_revision_walker_set_paths().
+ *
+ * Returns: (transfer none) (array zero-terminated=1) (nullable): the paths
+ *          or %NULL if the walk is not limited.
+ */
+const gchar * const *
+ggit_revision_walker_get_paths (GgitRevisionWalker *walker)
+{
+	GgitRevisionWalkerPrivate *priv;
+
+	g_return_val_if_fail (GGIT_IS_REVISION_WALKER (walker), NULL);
+
+	priv = ggit_revision_walker_get_instance_private (walker);
+
+	return (const gchar * const *)priv->paths;
 }
 
 /**
@@ -25,6 +25,7 @@
 #include <glib-object.h>
 #include "ggit-types.h"
 #include "ggit-native.h"
+#include "ggit-oid.h"
 
 G_BEGIN_DECLS
 
@@ -43,6 +44,31 @@ struct _GgitRevisionWalkerClass
 	GgitNativeClass parent_class;
 };
 
+/**
+ * GgitRevisionWalkerCommit:
+ * @id: (array fixed-size=20): the raw id of the commit.
+ * @tree_id: (array fixed-size=20): the raw id of the tree of the commit.
+ * @time: the committer time, in seconds since the epoch.
+ * @time_offset: the committer timezone offset, in minutes.
+ * @parent_count: the number of parents of the commit.
+ *
+ * Packed commit metadata as returned by
+ * ggit_revision_walker_next_commits().
+ */
+typedef struct _GgitRevisionWalkerCommit GgitRevisionWalkerCommit;
+
+struct _GgitRevisionWalkerCommit
+{
+	guint8 id[GGIT_OID_RAWSZ];
+	guint8 tree_id[GGIT_OID_RAWSZ];
+	gint64 time;
+	gint time_offset;
+	guint parent_count;
+};
+
+gint                    _ggit_revision_walker_next_id       (GgitRevisionWalker  *walker,
+                                                             git_oid             *oid);
+
 GgitRevisionWalker     *ggit_revision_walker_new            (GgitRepository  *repository,
                                                              GError         **error);
 
@@ -85,9 +111,22 @@ void                    ggit_revision_walker_hide_head      (GgitRevisionWalker
 GgitOId                *ggit_revision_walker_next           (GgitRevisionWalker  *walker,
                                                              GError             **error);
 
+GBytes                 *ggit_revision_walker_next_n         (GgitRevisionWalker  *walker,
+                                                             guint                max_count,
+                                                             GError             **error);
+
+GArray                 *ggit_revision_walker_next_commits   (GgitRevisionWalker  *walker,
+                                                             guint                max_count,
+                                                             GError             **error);
+
 void                    ggit_revision_walker_set_sort_mode  (GgitRevisionWalker *walker,
                                                              GgitSortMode        sort_mode);
 
+void                    ggit_revision_walker_set_paths      (GgitRevisionWalker  *walker,
+                                                             const gchar * const *paths);
+
+const gchar * const    *ggit_revision_walker_get_paths      (GgitRevisionWalker  *walker);
+
 GgitRepository         *ggit_revision_walker_get_repository (GgitRevisionWalker *walker);
 
 G_END_DECLS
@@ -0,0 +1,624 @@
+/*
+ * ggit-status-list.c
+ * This file is part of libgit2-glib
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include <git2.h>
+
+#include "ggit-status-list.h"
+#include "ggit-error.h"
+#include "ggit-repository.h"
+#include "ggit-status-options.h"
+
+#define N_STATUS_BITS 16
+
+/**
+ * GgitStatusList:
+ *
+ * Represents the status of the files of a repository, sorted by path.
+ */
+struct _GgitStatusList
+{
+	GObject parent_instance;
+
+	GgitRepository *repository;
+	GgitStatusOptions *options;
+
+	/* StatusListEntry, sorted by path */
+	GArray *entries;
+
+	/* the number of entries with each status bit set */
+	gsize counts[N_STATUS_BITS];
+};
+
+typedef struct
+{
+	gchar *path;
+	guint status;
+} StatusListEntry;
+
+G_DEFINE_TYPE (GgitStatusList, ggit_status_list, G_TYPE_OBJECT)
+
+static void
+status_list_entry_clear (StatusListEntry *entry)
+{
+	g_free (entry->path);
+}
+
+static GArray *
+status_list_entries_new (gsize n_reserved)
+{
+	GArray *entries;
+
+	entries = g_array_sized_new (FALSE, FALSE, sizeof (StatusListEntry), n_reserved);
+	g_array_set_clear_func (entries, (GDestroyNotify)status_list_entry_clear);
+
+	return entries;
+}
+
+static void
+ggit_status_list_finalize (GObject *object)
+{
+	GgitStatusList *list = GGIT_STATUS_LIST (object);
+
+	g_clear_object (&list->repository);
+
+	if (list->options != NULL)
+	{
+		ggit_status_options_free (list->options);
+	}
+
+	g_array_unref (list->entries);
+
+	G_OBJECT_CLASS (ggit_status_list_parent_class)->finalize (object);
+}
+
+static void
+ggit_status_list_class_init (GgitStatusListClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+	object_class->finalize = ggit_status_list_finalize;
+}
+
+static void
+ggit_status_list_init (GgitStatusList *list)
+{
+	list->entries = status_list_entries_new (0);
+}
+
+static gint
+compare_entries (gconstpointer a,
+                 gconstpointer b)
+{
+	return strcmp (((const StatusListEntry *)a)->path,
+	               ((const StatusListEntry *)b)->path);
+}
+
+static void
+count_entry (GgitStatusList *list,
+             guint           status,
+             gint            delta)
+{
+	guint bit;
+
+	for (bit = 0; bit < N_STATUS_BITS; ++bit)
+	{
+		if (status & (1 << bit))
+		{
+			list->counts[bit] += delta;
+		}
+	}
+}
+
+static GArray *
+read_entries (GgitStatusList  *list,
+              gchar          **paths,
+              gsize            n_paths,
+              GError         **error)
+{
+	git_status_options options;
+	const git_status_options *user_options;
+	git_status_list *native;
+	GArray *entries;
+	gsize n_entries;
+	gsize i;
+	gint ret;
+
+	git_status_init_options (&options, GIT_STATUS_OPTIONS_VERSION);
+	user_options = _ggit_status_options_get_status_options (list->options);
+
+	if (user_options != NULL)
+	{
+		options = *user_options;
+	}
+	else
+	{
+		options.flags = GIT_STATUS_OPT_DEFAULTS;
+	}
+
+	/* renamed entries would have two paths */
+	options.flags &= ~(GIT_STATUS_OPT_RENAMES_HEAD_TO_INDEX |
+	                   GIT_STATUS_OPT_RENAMES_INDEX_TO_WORKDIR |
+	                   GIT_STATUS_OPT_RENAMES_FROM_REWRITES);
+
+	if (paths != NULL)
+	{
+		options.pathspec.strings = paths;
+		options.pathspec.count = n_paths;
+		options.flags |= GIT_STATUS_OPT_DISABLE_PATHSPEC_MATCH;
+	}
+
+	ret = git_status_list_new (&native, _ggit_native_get (list->repository), &options);
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (error, ret);
+		return NULL;
+	}
+
+	n_entries = git_status_list_entrycount (native);
+	entries = status_list_entries_new (n_entries);
+
+	for (i = 0; i < n_entries; ++i)
+	{
+		const git_status_entry *status_entry;
+		StatusListEntry entry;
+
+		status_entry = git_status_byindex (native, i);
+
+		if (status_entry->head_to_index != NULL)
+		{
+			entry.path = g_strdup (status_entry->head_to_index->old_file.path);
+		}
+		else
+		{
+			entry.path = g_strdup (status_entry->index_to_workdir->old_file.path);
+		}
+
+		entry.status = status_entry->status;
+		g_array_append_val (entries, entry);
+	}
+
+	git_status_list_free (native);
+
+	/* the list may be sorted case insensitively */
+	g_array_sort (entries, compare_entries);
+
+	return entries;
+}
+
+/**
+ * ggit_status_list_new:
+ * @repository: a #GgitRepository.
+ * @options: (allow-none): status options, or %NULL.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Gathers the status of the files of @repository in a list that can be
+ * searched by path, and refreshed one path at a time with
+ * ggit_status_list_refresh(). The rename options of @options are ignored.
+ *
+ * Returns: (transfer full) (nullable): a #GgitStatusList or %NULL if
+ * there was an error.
+ */
+GgitStatusList *
+ggit_status_list_new (GgitRepository     *repository,
+                      GgitStatusOptions  *options,
+                      GError            **error)
+{
+	GgitStatusList *list;
+	GArray *entries;
+	guint i;
+
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	list = g_object_new (GGIT_TYPE_STATUS_LIST, NULL);
+	list->repository = g_object_ref (repository);
+
+	if (options != NULL)
+	{
+		list->options = ggit_status_options_copy (options);
+	}
+
+	entries = read_entries (list, NULL, 0, error);
+
+	if (entries == NULL)
+	{
+		g_object_unref (list);
+		return NULL;
+	}
+
+	g_array_unref (list->entries);
+	list->entries = entries;
+
+	for (i = 0; i < entries->len; ++i)
+	{
+		count_entry (list, g_array_index (entries, StatusListEntry, i).status, 1);
+	}
+
+	return list;
+}
+
+/**
+ * ggit_status_list_get_repository:
+ * @list: a #GgitStatusList.
+ *
+ * Gets the repository of @list.
+ *
+ * Returns: (transfer none): a #GgitRepository.
+ */
+GgitRepository *
+ggit_status_list_get_repository (GgitStatusList *list)
+{
+	g_return_val_if_fail (GGIT_IS_STATUS_LIST (list), NULL);
+
+	return list->repository;
+}
+
+/**
+ * ggit_status_list_get_size:
+ * @list: a #GgitStatusList.
+ *
+ * Gets the number of files in @list.
+ *
+ * Returns: the number of files in @list.
+ */
+gsize
+ggit_status_list_get_size (GgitStatusList *list)
+{
+	g_return_val_if_fail (GGIT_IS_STATUS_LIST (list), 0);
+
+	return list->entries->len;
+}
+
+/**
+ * ggit_status_list_get_path:
+ * @list: a #GgitStatusList.
+ * @index: the index of the file.
+ *
+ * Gets the path of the file at @index, relative to the working directory.
+ *
+ * Returns: (transfer none) (nullable): the path, or %NULL if @index is out
+ * of bounds.
+ */
+const gchar *
+ggit_status_list_get_path (GgitStatusList *list,
+                           gsize           index)
+{
+	g_return_val_if_fail (GGIT_IS_STATUS_LIST (list), NULL);
+	g_return_val_if_fail (index < list->entries->len, NULL);
+
+	return g_array_index (list->entries, StatusListEntry, index).path;
+}
+
+/**
+ * ggit_status_list_get_status:
+ * @list: a #GgitStatusList.
+ * @index: the index of the file.
+ *
+ * Gets the status of the file at @index.
+ *
+ * Returns: the status of the file.
+ */
+GgitStatusFlags
+ggit_status_list_get_status (GgitStatusList *list,
+                             gsize           index)
+{
+	g_return_val_if_fail (GGIT_IS_STATUS_LIST (list), GGIT_STATUS_CURRENT);
+	g_return_val_if_fail (index < list->entries->len, GGIT_STATUS_CURRENT);
+
+	return g_array_index (list->entries, StatusListEntry, index).status;
+}
+
+/**
+ * ggit_status_list_lookup:
+ * @list: a #GgitStatusList.
+ * @path: the path of a file, relative to the working directory.
+ *
+ * Finds the file at @path in @list.
+ *
+ * Returns: the index of the file, or -1 if it is not in @list.
+ */
+gssize
+ggit_status_list_lookup (GgitStatusList *list,
+                         const gchar    *path)
+{
+	gsize lo = 0;
+	gsize hi;
+
+	g_return_val_if_fail (GGIT_IS_STATUS_LIST (list), -1);
+	g_return_val_if_fail (path != NULL, -1);
+
+	hi = list->entries->len;
+
+	while (lo < hi)
+	{
+		gsize mid = lo + (hi - lo) / 2;
+		gint cmp;
+
+		cmp = strcmp (g_array_index (list->entries, StatusListEntry, mid).path, path);
+
+		if (cmp == 0)
+		{
+			return mid;
+		}
+		else if (cmp < 0)
+		{
+			lo = mid + 1;
+		}
+		else
+		{
+			hi = mid;
+		}
+	}
+
+	return -1;
+}
+
+/* the untracked or ignored directory that @path is reported as, if any */
+static gchar *
+find_collapsed_directory (GgitStatusList *list,
+                          const gchar    *path)
+{
+	const gchar *slash;
+
+	for (slash = strchr (path, '/'); slash != NULL; slash = strchr (slash + 1, '/'))
+	{
+		gchar *parent = g_strndup (path, slash - path + 1);
+
+		if (slash[1] != '\0' && ggit_status_list_lookup (list, parent) >= 0)
+		{
+			return parent;
+		}
+
+		g_free (parent);
+	}
+
+	return NULL;
+}
+
+/**
+ * ggit_status_list_get_file_status:
+ * @list: a #GgitStatusList.
+ * @path: the path of a file, relative to the working directory.
+ *
+ * Gets the status of the file at @path. Files in an untracked or ignored
+ * directory that is listed as a whole get the status of the directory.
+ *
+ * Returns: the status of the file, %GGIT_STATUS_CURRENT if it is not in
+ * @list.
+ */
+GgitStatusFlags
+ggit_status_list_get_file_status (GgitStatusList *list,
+                                  const gchar    *path)
+{
+	gssize index;
+	gchar *directory;
+
+	g_return_val_if_fail (GGIT_IS_STATUS_LIST (list), GGIT_STATUS_CURRENT);
+	g_return_val_if_fail (path != NULL, GGIT_STATUS_CURRENT);
+
+	index = ggit_status_list_lookup (list, path);
+
+	if (index < 0)
+	{
+		directory = find_collapsed_directory (list, path);
+
+		if (directory == NULL)
+		{
+			return GGIT_STATUS_CURRENT;
+		}
+
+		index = ggit_status_list_lookup (list, directory);
+		g_free (directory);
+	}
+
+	return ggit_status_list_get_status (list, index);
+}
+
+/**
+ * ggit_status_list_get_count:
+ * @list: a #GgitStatusList.
+ * @status_flags: a #GgitStatusFlags.
+ *
+ * Gets the number of files that have any of @status_flags set, or of
+ * current files if @status_flags is %GGIT_STATUS_CURRENT. The count of a
+ * single flag is kept up to date and does not scan the list.
+ *
+ * Returns: the number of files.
+ */
+gsize
+ggit_status_list_get_count (GgitStatusList  *list,
+                            GgitStatusFlags  status_flags)
+{
+	gsize count = 0;
+	guint i;
+
+	g_return_val_if_fail (GGIT_IS_STATUS_LIST (list), 0);
+
+	if (status_flags != 0 && (status_flags & (status_flags - 1)) == 0)
+	{
+		gint bit = g_bit_nth_lsf (status_flags, -1);
+
+		return bit < N_STATUS_BITS ? list->counts[bit] : 0;
+	}
+
+	for (i = 0; i < list->entries->len; ++i)
+	{
+		guint status = g_array_index (list->entries, StatusListEntry, i).status;
+
+		if (status_flags == GGIT_STATUS_CURRENT ? status == 0 : (status & status_flags) != 0)
+		{
+			++count;
+		}
+	}
+
+	return count;
+}
+
+static gboolean
+is_below_paths (GHashTable  *paths,
+                const gchar *path)
+{
+	const gchar *slash;
+
+	if (g_hash_table_contains (paths, path))
+	{
+		return TRUE;
+	}
+
+	for (slash = strchr (path, '/'); slash != NULL; slash = strchr (slash + 1, '/'))
+	{
+		gchar *parent = g_strndup (path, slash - path);
+		gboolean found;
+
+		found = g_hash_table_contains (paths, parent);
+		g_free (parent);
+
+		if (found)
+		{
+			return TRUE;
+		}
+	}
+
+	return FALSE;
+}
+
+/**
+ * ggit_status_list_refresh:
+ * @list: a #GgitStatusList.
+ * @paths: (array zero-terminated=1): the paths to refresh, relative to the
+ *         working directory.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Recomputes the status of the files at @paths, and of all the files
+ * below them for directories, and updates @list in place. The other
+ * files of @list are left untouched. Paths in an untracked or ignored
+ * directory that is listed as a whole refresh the whole directory.
+ *
+ * Returns: %TRUE if there was no error, %FALSE otherwise.
+ */
+gboolean
+ggit_status_list_refresh (GgitStatusList       *list,
+                          const gchar * const  *paths,
+                          GError              **error)
+{
+	GHashTable *refreshed;
+	gchar **pathspec;
+	guint n_paths;
+	GArray *fresh;
+	GArray *merged;
+	guint i;
+	guint j;
+
+	g_return_val_if_fail (GGIT_IS_STATUS_LIST (list), FALSE);
+	g_return_val_if_fail (paths != NULL, FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	refreshed = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+	for (i = 0; paths[i] != NULL; ++i)
+	{
+		gchar *path = find_collapsed_directory (list, paths[i]);
+
+		if (path == NULL)
+		{
+			path = g_strdup (paths[i]);
+		}
+
+		/* directories are matched without their trailing slash */
+		if (g_str_has_suffix (path, "/"))
+		{
+			path[strlen (path) - 1] = '\0';
+		}
+
+		g_hash_table_add (refreshed, path);
+	}
+
+	if (g_hash_table_size (refreshed) == 0)
+	{
+		g_hash_table_unref (refreshed);
+		return TRUE;
+	}
+
+	pathspec = (gchar **)g_hash_table_get_keys_as_array (refreshed, &n_paths);
+	fresh = read_entries (list, pathspec, n_paths, error);
+	g_free (pathspec);
+
+	if (fresh == NULL)
+	{
+		g_hash_table_unref (refreshed);
+		return FALSE;
+	}
+
+	merged = status_list_entries_new (list->entries->len + fresh->len);
+	i = 0;
+	j = 0;
+
+	while (i < list->entries->len || j < fresh->len)
+	{
+		StatusListEntry *old_entry = NULL;
+		StatusListEntry *new_entry = NULL;
+
+		if (i < list->entries->len)
+		{
+			old_entry = &g_array_index (list->entries, StatusListEntry, i);
+
+			if (is_below_paths (refreshed, old_entry->path))
+			{
+				count_entry (list, old_entry->status, -1);
+				g_free (old_entry->path);
+				++i;
+
+				continue;
+			}
+		}
+
+		if (j < fresh->len)
+		{
+			new_entry = &g_array_index (fresh, StatusListEntry, j);
+		}
+
+		if (new_entry == NULL ||
+		    (old_entry != NULL && compare_entries (old_entry, new_entry) < 0))
+		{
+			g_array_append_val (merged, *old_entry);
+			++i;
+		}
+		else
+		{
+			count_entry (list, new_entry->status, 1);
+			g_array_append_val (merged, *new_entry);
+			++j;
+		}
+	}
+
+	/* the paths were moved to merged */
+	g_array_set_clear_func (list->entries, NULL);
+	g_array_set_clear_func (fresh, NULL);
+
+	g_array_unref (list->entries);
+	g_array_unref (fresh);
+	g_hash_table_unref (refreshed);
+
+	list->entries = merged;
+
+	return TRUE;
+}
+
+/* ex:set ts=8 noet: */
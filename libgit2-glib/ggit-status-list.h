@@ -0,0 +1,63 @@
+/*
+ * ggit-status-list.h
+ * This file is part of libgit2-glib
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GGIT_STATUS_LIST_H__
+#define __GGIT_STATUS_LIST_H__
+
+#include <glib-object.h>
+#include <git2.h>
+
+#include <libgit2-glib/ggit-types.h>
+
+G_BEGIN_DECLS
+
+#define GGIT_TYPE_STATUS_LIST (ggit_status_list_get_type ())
+G_DECLARE_FINAL_TYPE (GgitStatusList, ggit_status_list, GGIT, STATUS_LIST, GObject)
+
+GgitStatusList   *ggit_status_list_new            (GgitRepository      *repository,
+                                                   GgitStatusOptions   *options,
+                                                   GError             **error);
+
+GgitRepository   *ggit_status_list_get_repository (GgitStatusList      *list);
+
+gsize             ggit_status_list_get_size       (GgitStatusList      *list);
+
+const gchar      *ggit_status_list_get_path       (GgitStatusList      *list,
+                                                   gsize                index);
+
+GgitStatusFlags   ggit_status_list_get_status     (GgitStatusList      *list,
+                                                   gsize                index);
+
+gssize            ggit_status_list_lookup         (GgitStatusList      *list,
+                                                   const gchar         *path);
+
+GgitStatusFlags   ggit_status_list_get_file_status (GgitStatusList     *list,
+                                                   const gchar         *path);
+
+gsize             ggit_status_list_get_count      (GgitStatusList      *list,
+                                                   GgitStatusFlags      status_flags);
+
+gboolean          ggit_status_list_refresh        (GgitStatusList      *list,
+                                                   const gchar * const *paths,
+                                                   GError             **error);
+
+G_END_DECLS
+
+#endif /* __GGIT_STATUS_LIST_H__ */
+
+/* ex:set ts=8 noet: */
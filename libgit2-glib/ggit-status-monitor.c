@@ -0,0 +1,1153 @@
+/*
+ * ggit-status-monitor.c
+ * This file is part of libgit2-glib
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include <git2.h>
+#include <gio/gio.h>
+
+#include "ggit-status-monitor.h"
+#include "ggit-error.h"
+#include "ggit-enum-types.h"
+#include "ggit-repository.h"
+#include "ggit-status-options.h"
+
+/* above this many changed paths a full rescan is cheaper */
+#define MAX_DIRTY_PATHS 1024
+
+/* delay between the first event and the refresh, to coalesce events */
+#define REFRESH_LATENCY 100
+
+/**
+ * GgitStatusMonitor:
+ *
+ * Keeps the status of the files of a repository up to date by watching
+ * its working directory.
+ */
+struct _GgitStatusMonitor
+{
+	GObject parent_instance;
+
+	GgitRepository *repository;
+	GgitStatusOptions *options;
+
+	GFile *workdir;
+	GFile *location;
+
+	/* relative path of a directory => GFileMonitor */
+	GHashTable *monitors;
+	GFileMonitor *location_monitor;
+
+	/* the loose file of the branch HEAD points to */
+	gchar *head_ref;
+	GFileMonitor *head_monitor;
+
+	/* path => GgitStatusFlags, for all the files that are not current */
+	GHashTable *statuses;
+	/* paths that changed since the last refresh */
+	GHashTable *dirty;
+
+	/* of the last refresh from the main loop, for the next query */
+	GError *error;
+
+	git_oid head;
+	guint needs_rescan : 1;
+	guint unmonitored : 1;
+	guint refresh_id;
+};
+
+enum
+{
+	PROP_0,
+	PROP_REPOSITORY,
+	PROP_OPTIONS
+};
+
+enum
+{
+	CHANGED,
+	NUM_SIGNALS
+};
+
+static guint signals[NUM_SIGNALS] = {0,};
+
+static void ggit_status_monitor_initable_iface_init (GInitableIface *iface);
+
+static gboolean watch_directory (GgitStatusMonitor  *monitor,
+                                 GFile              *directory,
+                                 const gchar        *path,
+                                 GCancellable       *cancellable,
+                                 GError            **error);
+
+G_DEFINE_TYPE_EXTENDED (GgitStatusMonitor, ggit_status_monitor, G_TYPE_OBJECT,
+                        0,
+                        G_IMPLEMENT_INTERFACE (G_TYPE_INITABLE,
+                                               ggit_status_monitor_initable_iface_init))
+
+static void
+cancel_file_monitor (GFileMonitor      *file_monitor,
+                     GgitStatusMonitor *monitor)
+{
+	g_signal_handlers_disconnect_by_data (file_monitor, monitor);
+	g_file_monitor_cancel (file_monitor);
+}
+
+static void
+unwatch_all (GgitStatusMonitor *monitor)
+{
+	GHashTableIter iter;
+	gpointer value;
+
+	g_hash_table_iter_init (&iter, monitor->monitors);
+
+	while (g_hash_table_iter_next (&iter, NULL, &value))
+	{
+		cancel_file_monitor (value, monitor);
+	}
+
+	g_hash_table_remove_all (monitor->monitors);
+}
+
+static void
+ggit_status_monitor_dispose (GObject *object)
+{
+	GgitStatusMonitor *monitor = GGIT_STATUS_MONITOR (object);
+
+	if (monitor->refresh_id != 0)
+	{
+		g_source_remove (monitor->refresh_id);
+		monitor->refresh_id = 0;
+	}
+
+	unwatch_all (monitor);
+
+	if (monitor->location_monitor != NULL)
+	{
+		cancel_file_monitor (monitor->location_monitor, monitor);
+		g_clear_object (&monitor->location_monitor);
+	}
+
+	if (monitor->head_monitor != NULL)
+	{
+		cancel_file_monitor (monitor->head_monitor, monitor);
+		g_clear_object (&monitor->head_monitor);
+	}
+
+	g_clear_object (&monitor->repository);
+	g_clear_object (&monitor->workdir);
+	g_clear_object (&monitor->location);
+
+	G_OBJECT_CLASS (ggit_status_monitor_parent_class)->dispose (object);
+}
+
+static void
+ggit_status_monitor_finalize (GObject *object)
+{
+	GgitStatusMonitor *monitor = GGIT_STATUS_MONITOR (object);
+
+	if (monitor->options != NULL)
+	{
+		ggit_status_options_free (monitor->options);
+	}
+
+	g_hash_table_unref (monitor->monitors);
+	g_hash_table_unref (monitor->statuses);
+	g_hash_table_unref (monitor->dirty);
+
+	g_free (monitor->head_ref);
+	g_clear_error (&monitor->error);
+
+	G_OBJECT_CLASS (ggit_status_monitor_parent_class)->finalize (object);
+}
+
+static void
+ggit_status_monitor_get_property (GObject    *object,
+                                  guint       prop_id,
+                                  GValue     *value,
+                                  GParamSpec *pspec)
+{
+	GgitStatusMonitor *monitor = GGIT_STATUS_MONITOR (object);
+
+	switch (prop_id)
+	{
+		case PROP_REPOSITORY:
+			g_value_set_object (value, monitor->repository);
+			break;
+		case PROP_OPTIONS:
+			g_value_set_boxed (value, monitor->options);
+			break;
+		default:
+			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+			break;
+	}
+}
+
+static void
+ggit_status_monitor_set_property (GObject      *object,
+                                  guint         prop_id,
+                                  const GValue *value,
+                                  GParamSpec   *pspec)
+{
+	GgitStatusMonitor *monitor = GGIT_STATUS_MONITOR (object);
+
+	switch (prop_id)
+	{
+		case PROP_REPOSITORY:
+			monitor->repository = g_value_dup_object (value);
+			break;
+		case PROP_OPTIONS:
+			monitor->options = g_value_dup_boxed (value);
+			break;
+		default:
+			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+			break;
+	}
+}
+
+static void
+ggit_status_monitor_class_init (GgitStatusMonitorClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+	object_class->dispose = ggit_status_monitor_dispose;
+	object_class->finalize = ggit_status_monitor_finalize;
+	object_class->get_property = ggit_status_monitor_get_property;
+	object_class->set_property = ggit_status_monitor_set_property;
+
+	g_object_class_install_property (object_class,
+	                                 PROP_REPOSITORY,
+	                                 g_param_spec_object ("repository",
+	                                                      "Repository",
+	                                                      "The repository to monitor",
+	                                                      GGIT_TYPE_REPOSITORY,
+	                                                      G_PARAM_READWRITE |
+	                                                      G_PARAM_CONSTRUCT_ONLY |
+	                                                      G_PARAM_STATIC_STRINGS));
+
+	g_object_class_install_property (object_class,
+	                                 PROP_OPTIONS,
+	                                 g_param_spec_boxed ("options",
+	                                                     "Options",
+	                                                     "The status options",
+	                                                     GGIT_TYPE_STATUS_OPTIONS,
+	                                                     G_PARAM_READWRITE |
+	                                                     G_PARAM_CONSTRUCT_ONLY |
+	                                                     G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GgitStatusMonitor::changed:
+	 * @monitor: a #GgitStatusMonitor.
+	 * @path: the path of the file, relative to the working directory.
+	 * @status_flags: the new status of the file.
+	 *
+	 * Emitted when the status of a file changed. @status_flags is
+	 * %GGIT_STATUS_CURRENT when the file is no longer modified.
+	 */
+	signals[CHANGED] =
+		g_signal_new ("changed",
+		              G_TYPE_FROM_CLASS (object_class),
+		              G_SIGNAL_RUN_LAST,
+		              0,
+		              NULL, NULL,
+		              NULL,
+		              G_TYPE_NONE,
+		              2,
+		              G_TYPE_STRING,
+		              GGIT_TYPE_STATUS_FLAGS);
+}
+
+static void
+ggit_status_monitor_init (GgitStatusMonitor *monitor)
+{
+	monitor->monitors = g_hash_table_new_full (g_str_hash,
+	                                           g_str_equal,
+	                                           g_free,
+	                                           (GDestroyNotify)g_object_unref);
+
+	monitor->statuses = g_hash_table_new_full (g_str_hash,
+	                                           g_str_equal,
+	                                           g_free,
+	                                           NULL);
+
+	monitor->dirty = g_hash_table_new_full (g_str_hash,
+	                                        g_str_equal,
+	                                        g_free,
+	                                        NULL);
+}
+
+static gboolean refresh (GgitStatusMonitor  *monitor,
+                         GError            **error);
+
+static gboolean
+refresh_timeout (gpointer user_data)
+{
+	GgitStatusMonitor *monitor = user_data;
+
+	monitor->refresh_id = 0;
+
+	/* nobody to report to from here, keep the error for the next query */
+	g_clear_error (&monitor->error);
+	refresh (monitor, &monitor->error);
+
+	return G_SOURCE_REMOVE;
+}
+
+static void
+schedule_refresh (GgitStatusMonitor *monitor)
+{
+	if (monitor->refresh_id == 0)
+	{
+		monitor->refresh_id = g_timeout_add (REFRESH_LATENCY,
+		                                     refresh_timeout,
+		                                     monitor);
+	}
+}
+
+/**
+ * ggit_status_monitor_invalidate:
+ * @monitor: a #GgitStatusMonitor.
+ *
+ * Discards the cached statuses, so that the next refresh rescans the
+ * whole working directory.
+ */
+void
+ggit_status_monitor_invalidate (GgitStatusMonitor *monitor)
+{
+	g_return_if_fail (GGIT_IS_STATUS_MONITOR (monitor));
+
+	monitor->needs_rescan = TRUE;
+	g_hash_table_remove_all (monitor->dirty);
+
+	schedule_refresh (monitor);
+}
+
+static void
+mark_dirty (GgitStatusMonitor *monitor,
+            const gchar       *path)
+{
+	const gchar *slash;
+
+	if (monitor->needs_rescan)
+	{
+		return;
+	}
+
+	/* files in an untracked directory are reported as the directory */
+	for (slash = strchr (path, '/'); slash != NULL; slash = strchr (slash + 1, '/'))
+	{
+		gchar *parent = g_strndup (path, slash - path + 1);
+		gboolean collapsed;
+
+		collapsed = g_hash_table_contains (monitor->statuses, parent);
+
+		if (collapsed)
+		{
+			parent[slash - path] = '\0';
+			g_hash_table_add (monitor->dirty, parent);
+			schedule_refresh (monitor);
+			return;
+		}
+
+		g_free (parent);
+	}
+
+	g_hash_table_add (monitor->dirty, g_strdup (path));
+
+	if (g_hash_table_size (monitor->dirty) > MAX_DIRTY_PATHS)
+	{
+		ggit_status_monitor_invalidate (monitor);
+		return;
+	}
+
+	schedule_refresh (monitor);
+}
+
+static void
+unwatch_directory (GgitStatusMonitor *monitor,
+                   const gchar       *path)
+{
+	GHashTableIter iter;
+	gpointer key;
+	gpointer value;
+	gsize len = strlen (path);
+
+	g_hash_table_iter_init (&iter, monitor->monitors);
+
+	while (g_hash_table_iter_next (&iter, &key, &value))
+	{
+		const gchar *dir = key;
+
+		if (strncmp (dir, path, len) == 0 &&
+		    (dir[len] == '\0' || dir[len] == '/'))
+		{
+			cancel_file_monitor (value, monitor);
+			g_hash_table_iter_remove (&iter);
+		}
+	}
+}
+
+static gboolean
+is_ignored_directory (GgitStatusMonitor *monitor,
+                      const gchar       *path)
+{
+	gchar *dir;
+	gint ignored = 0;
+
+	dir = g_strconcat (path, "/", NULL);
+
+	if (git_ignore_path_is_ignored (&ignored,
+	                                _ggit_native_get (monitor->repository),
+	                                dir) != GIT_OK)
+	{
+		ignored = 0;
+	}
+
+	g_free (dir);
+	return ignored != 0;
+}
+
+static void
+on_directory_changed (GFileMonitor      *file_monitor,
+                      GFile             *file,
+                      GFile             *other_file,
+                      GFileMonitorEvent  event_type,
+                      GgitStatusMonitor *monitor)
+{
+	gchar *path;
+	gchar *basename;
+
+	switch (event_type)
+	{
+		case G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT:
+		case G_FILE_MONITOR_EVENT_PRE_UNMOUNT:
+			return;
+		case G_FILE_MONITOR_EVENT_UNMOUNTED:
+			ggit_status_monitor_invalidate (monitor);
+			return;
+		default:
+			break;
+	}
+
+	path = g_file_get_relative_path (monitor->workdir, file);
+
+	if (path == NULL)
+	{
+		return;
+	}
+
+	basename = g_file_get_basename (file);
+
+	if (g_strcmp0 (basename, ".git") == 0)
+	{
+		g_free (basename);
+		g_free (path);
+		return;
+	}
+
+	if (g_strcmp0 (basename, ".gitignore") == 0)
+	{
+		/* the ignore rules of the whole directory may have changed */
+		gchar *parent = g_path_get_dirname (path);
+
+		if (strcmp (parent, ".") == 0)
+		{
+			ggit_status_monitor_invalidate (monitor);
+		}
+		else
+		{
+			mark_dirty (monitor, parent);
+		}
+
+		g_free (parent);
+	}
+
+	if (event_type == G_FILE_MONITOR_EVENT_CREATED &&
+	    g_file_query_file_type (file, G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS, NULL) == G_FILE_TYPE_DIRECTORY &&
+	    !is_ignored_directory (monitor, path))
+	{
+		if (!watch_directory (monitor, file, path, NULL, NULL))
+		{
+			monitor->unmonitored = TRUE;
+		}
+	}
+	else if (event_type == G_FILE_MONITOR_EVENT_DELETED)
+	{
+		unwatch_directory (monitor, path);
+	}
+
+	mark_dirty (monitor, path);
+
+	g_free (basename);
+	g_free (path);
+}
+
+static void
+on_location_changed (GFileMonitor      *file_monitor,
+                     GFile             *file,
+                     GFile             *other_file,
+                     GFileMonitorEvent  event_type,
+                     GgitStatusMonitor *monitor)
+{
+	gchar *basename;
+
+	if (event_type == G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT)
+	{
+		return;
+	}
+
+	basename = g_file_get_basename (file);
+
+	if (g_strcmp0 (basename, "index") == 0)
+	{
+		ggit_status_monitor_invalidate (monitor);
+	}
+	else if (!g_str_has_suffix (basename, ".lock"))
+	{
+		/* HEAD may have moved, checked when refreshing */
+		schedule_refresh (monitor);
+	}
+
+	g_free (basename);
+}
+
+static gboolean
+watch_directory (GgitStatusMonitor  *monitor,
+                 GFile              *directory,
+                 const gchar        *path,
+                 GCancellable       *cancellable,
+                 GError            **error)
+{
+	GFileMonitor *file_monitor;
+	GFileEnumerator *enumerator;
+	GFileInfo *info;
+	gboolean ret = TRUE;
+
+	if (g_file_equal (directory, monitor->location))
+	{
+		return TRUE;
+	}
+
+	file_monitor = g_file_monitor_directory (directory,
+	                                         G_FILE_MONITOR_NONE,
+	                                         cancellable,
+	                                         error);
+
+	if (file_monitor == NULL)
+	{
+		return FALSE;
+	}
+
+	g_signal_connect (file_monitor,
+	                  "changed",
+	                  G_CALLBACK (on_directory_changed),
+	                  monitor);
+
+	g_hash_table_replace (monitor->monitors, g_strdup (path), file_monitor);
+
+	enumerator = g_file_enumerate_children (directory,
+	                                        G_FILE_ATTRIBUTE_STANDARD_NAME ","
+	                                        G_FILE_ATTRIBUTE_STANDARD_TYPE,
+	                                        G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+	                                        cancellable,
+	                                        error);
+
+	if (enumerator == NULL)
+	{
+		return FALSE;
+	}
+
+	while (ret && (info = g_file_enumerator_next_file (enumerator, cancellable, error)) != NULL)
+	{
+		const gchar *name = g_file_info_get_name (info);
+
+		if (g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY &&
+		    strcmp (name, ".git") != 0)
+		{
+			gchar *child_path;
+
+			child_path = *path != '\0' ? g_strconcat (path, "/", name, NULL)
+			                           : g_strdup (name);
+
+			if (!is_ignored_directory (monitor, child_path))
+			{
+				GFile *child = g_file_get_child (directory, name);
+
+				ret = watch_directory (monitor, child, child_path, cancellable, error);
+				g_object_unref (child);
+			}
+
+			g_free (child_path);
+		}
+
+		g_object_unref (info);
+	}
+
+	if (ret && error != NULL && *error != NULL)
+	{
+		ret = FALSE;
+	}
+
+	g_object_unref (enumerator);
+	return ret;
+}
+
+static gint
+collect_status (const gchar *path,
+                guint        status_flags,
+                gpointer     payload)
+{
+	g_hash_table_insert (payload, g_strdup (path), GUINT_TO_POINTER (status_flags));
+
+	return GIT_OK;
+}
+
+static gboolean
+gather_statuses (GgitStatusMonitor  *monitor,
+                 GHashTable         *statuses,
+                 GHashTable         *paths,
+                 GError            **error)
+{
+	git_status_options options = GIT_STATUS_OPTIONS_INIT;
+	const git_status_options *user_options;
+	gint ret;
+
+	user_options = _ggit_status_options_get_status_options (monitor->options);
+
+	if (user_options != NULL)
+	{
+		options = *user_options;
+	}
+	else
+	{
+		options.flags = GIT_STATUS_OPT_DEFAULTS;
+	}
+
+	/* renames pair paths that are not refreshed together */
+	options.flags &= ~(GIT_STATUS_OPT_RENAMES_HEAD_TO_INDEX |
+	                   GIT_STATUS_OPT_RENAMES_INDEX_TO_WORKDIR);
+	options.pathspec.strings = NULL;
+	options.pathspec.count = 0;
+
+	if (paths != NULL)
+	{
+		options.pathspec.strings = (gchar **)g_hash_table_get_keys_as_array (paths, NULL);
+		options.pathspec.count = g_hash_table_size (paths);
+		options.flags |= GIT_STATUS_OPT_DISABLE_PATHSPEC_MATCH;
+	}
+
+	ret = git_status_foreach_ext (_ggit_native_get (monitor->repository),
+	                              &options,
+	                              collect_status,
+	                              statuses);
+
+	g_free (options.pathspec.strings);
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (error, ret);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+static gboolean
+is_below_dirty_path (GgitStatusMonitor *monitor,
+                     const gchar       *path)
+{
+	const gchar *slash;
+
+	if (g_hash_table_contains (monitor->dirty, path))
+	{
+		return TRUE;
+	}
+
+	for (slash = strchr (path, '/'); slash != NULL; slash = strchr (slash + 1, '/'))
+	{
+		gchar *parent = g_strndup (path, slash - path);
+		gboolean found;
+
+		found = g_hash_table_contains (monitor->dirty, parent);
+		g_free (parent);
+
+		if (found)
+		{
+			return TRUE;
+		}
+	}
+
+	return FALSE;
+}
+
+static void
+merge_statuses (GgitStatusMonitor *monitor,
+                GHashTable        *fresh,
+                gboolean           full)
+{
+	GHashTableIter iter;
+	gpointer key;
+	gpointer value;
+	GPtrArray *removed;
+	guint i;
+
+	removed = g_ptr_array_new_with_free_func (g_free);
+	g_hash_table_iter_init (&iter, monitor->statuses);
+
+	while (g_hash_table_iter_next (&iter, &key, &value))
+	{
+		if ((full || is_below_dirty_path (monitor, key)) &&
+		    !g_hash_table_contains (fresh, key))
+		{
+			g_hash_table_iter_steal (&iter);
+			g_ptr_array_add (removed, key);
+		}
+	}
+
+	g_hash_table_iter_init (&iter, fresh);
+
+	while (g_hash_table_iter_next (&iter, &key, &value))
+	{
+		gpointer old_value;
+
+		if (g_hash_table_lookup_extended (monitor->statuses, key, NULL, &old_value) &&
+		    old_value == value)
+		{
+			continue;
+		}
+
+		g_hash_table_iter_steal (&iter);
+		g_hash_table_replace (monitor->statuses, key, value);
+
+		g_signal_emit (monitor, signals[CHANGED], 0, key, GPOINTER_TO_UINT (value));
+	}
+
+	for (i = 0; i < removed->len; ++i)
+	{
+		g_signal_emit (monitor,
+		               signals[CHANGED],
+		               0,
+		               g_ptr_array_index (removed, i),
+		               GGIT_STATUS_CURRENT);
+	}
+
+	g_ptr_array_unref (removed);
+}
+
+static void
+on_head_ref_changed (GFileMonitor      *file_monitor,
+                     GFile             *file,
+                     GFile             *other_file,
+                     GFileMonitorEvent  event_type,
+                     GgitStatusMonitor *monitor)
+{
+	if (event_type != G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT)
+	{
+		/* a commit moved the current branch, checked when refreshing */
+		schedule_refresh (monitor);
+	}
+}
+
+/* The directory of the repository only tells about HEAD itself and the
+ * packed refs, so also watch the loose ref HEAD points to, which moves
+ * when committing to the current branch.
+ */
+static void
+watch_head_ref (GgitStatusMonitor *monitor)
+{
+	git_repository *repo;
+	git_reference *head;
+	const gchar *target = NULL;
+
+	repo = _ggit_native_get (monitor->repository);
+
+	if (git_reference_lookup (&head, repo, "HEAD") != GIT_OK)
+	{
+		head = NULL;
+	}
+	else if (git_reference_type (head) == GIT_REF_SYMBOLIC)
+	{
+		target = git_reference_symbolic_target (head);
+	}
+
+	if (g_strcmp0 (target, monitor->head_ref) != 0)
+	{
+		if (monitor->head_monitor != NULL)
+		{
+			cancel_file_monitor (monitor->head_monitor, monitor);
+			g_clear_object (&monitor->head_monitor);
+		}
+
+		g_free (monitor->head_ref);
+		monitor->head_ref = g_strdup (target);
+
+		if (target != NULL)
+		{
+			GFile *file;
+			gchar *path;
+
+			path = g_build_filename (git_repository_commondir (repo), target, NULL);
+			file = g_file_new_for_path (path);
+
+			/* without it, a commit is only noticed with the next change */
+			monitor->head_monitor = g_file_monitor_file (file,
+			                                             G_FILE_MONITOR_NONE,
+			                                             NULL,
+			                                             NULL);
+
+			if (monitor->head_monitor != NULL)
+			{
+				g_signal_connect (monitor->head_monitor,
+				                  "changed",
+				                  G_CALLBACK (on_head_ref_changed),
+				                  monitor);
+			}
+
+			g_object_unref (file);
+			g_free (path);
+		}
+	}
+
+	git_reference_free (head);
+}
+
+static void
+read_head (GgitStatusMonitor *monitor,
+           git_oid           *head)
+{
+	watch_head_ref (monitor);
+
+	if (git_reference_name_to_id (head,
+	                              _ggit_native_get (monitor->repository),
+	                              "HEAD") != GIT_OK)
+	{
+		memset (head, 0, sizeof (git_oid));
+	}
+}
+
+static gboolean
+refresh (GgitStatusMonitor  *monitor,
+         GError            **error)
+{
+	GHashTable *fresh;
+	git_oid head;
+	gboolean full;
+
+	if (monitor->refresh_id != 0)
+	{
+		g_source_remove (monitor->refresh_id);
+		monitor->refresh_id = 0;
+	}
+
+	read_head (monitor, &head);
+
+	full = monitor->needs_rescan ||
+	       monitor->unmonitored ||
+	       !git_oid_equal (&head, &monitor->head);
+
+	if (!full && g_hash_table_size (monitor->dirty) == 0)
+	{
+		return TRUE;
+	}
+
+	fresh = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+	if (!gather_statuses (monitor, fresh, full ? NULL : monitor->dirty, error))
+	{
+		g_hash_table_unref (fresh);
+		return FALSE;
+	}
+
+	merge_statuses (monitor, fresh, full);
+	g_hash_table_unref (fresh);
+
+	monitor->head = head;
+	monitor->needs_rescan = FALSE;
+	g_hash_table_remove_all (monitor->dirty);
+
+	return TRUE;
+}
+
+/**
+ * ggit_status_monitor_refresh:
+ * @monitor: a #GgitStatusMonitor.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Rechecks the status of the files that changed since the last refresh,
+ * emitting #GgitStatusMonitor::changed for each file whose status changed.
+ * The whole working directory is rescanned instead when the index or HEAD
+ * changed, when too many files changed, or when the working directory
+ * could not be fully monitored.
+ *
+ * This is done automatically from the main loop shortly after a change,
+ * and before answering a query. When the automatic refresh fails, its
+ * error is reported by the next call to this function,
+ * ggit_status_monitor_get_status() or ggit_status_monitor_foreach(), and
+ * the files that changed are rechecked by the call after that.
+ *
+ * Returns: %TRUE if there was no error, %FALSE otherwise.
+ */
+gboolean
+ggit_status_monitor_refresh (GgitStatusMonitor  *monitor,
+                             GError            **error)
+{
+	g_return_val_if_fail (GGIT_IS_STATUS_MONITOR (monitor), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	if (monitor->error != NULL)
+	{
+		g_propagate_error (error, monitor->error);
+		monitor->error = NULL;
+
+		return FALSE;
+	}
+
+	return refresh (monitor, error);
+}
+
+static gboolean
+ggit_status_monitor_initable_init (GInitable     *initable,
+                                   GCancellable  *cancellable,
+                                   GError       **error)
+{
+	GgitStatusMonitor *monitor = GGIT_STATUS_MONITOR (initable);
+	GError *watch_error = NULL;
+
+	if (monitor->repository == NULL)
+	{
+		g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+		                     "No repository to monitor");
+		return FALSE;
+	}
+
+	monitor->workdir = ggit_repository_get_workdir (monitor->repository);
+	monitor->location = ggit_repository_get_location (monitor->repository);
+
+	if (monitor->workdir == NULL)
+	{
+		g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+		                     "Cannot monitor the status of a bare repository");
+		return FALSE;
+	}
+
+	monitor->location_monitor = g_file_monitor_directory (monitor->location,
+	                                                      G_FILE_MONITOR_NONE,
+	                                                      cancellable,
+	                                                      &watch_error);
+
+	if (monitor->location_monitor != NULL)
+	{
+		g_signal_connect (monitor->location_monitor,
+		                  "changed",
+		                  G_CALLBACK (on_location_changed),
+		                  monitor);
+
+		watch_directory (monitor, monitor->workdir, "", cancellable, &watch_error);
+	}
+
+	if (watch_error != NULL)
+	{
+		if (g_error_matches (watch_error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+		{
+			g_propagate_error (error, watch_error);
+			return FALSE;
+		}
+
+		/* out of watches for example, rescan on every refresh instead */
+		g_clear_error (&watch_error);
+		unwatch_all (monitor);
+		monitor->unmonitored = TRUE;
+	}
+
+	monitor->needs_rescan = TRUE;
+
+	return ggit_status_monitor_refresh (monitor, error);
+}
+
+static void
+ggit_status_monitor_initable_iface_init (GInitableIface *iface)
+{
+	iface->init = ggit_status_monitor_initable_init;
+}
+
+/**
+ * ggit_status_monitor_new:
+ * @repository: a #GgitRepository.
+ * @options: (allow-none): status options, or %NULL.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Creates a new #GgitStatusMonitor for the working directory of
+ * @repository, and gathers the initial statuses. The working directory
+ * is watched for changes from the thread-default main context, so that
+ * later queries only recheck the files that changed.
+ *
+ * The rename options and the pathspec of @options are ignored.
+ * Directories that are ignored are not watched.
+ *
+ * Returns: (transfer full) (nullable): a #GgitStatusMonitor or %NULL if
+ * there was an error.
+ */
+GgitStatusMonitor *
+ggit_status_monitor_new (GgitRepository     *repository,
+                         GgitStatusOptions  *options,
+                         GError            **error)
+{
+	g_return_val_if_fail (GGIT_IS_REPOSITORY (repository), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	return g_initable_new (GGIT_TYPE_STATUS_MONITOR,
+	                       NULL, error,
+	                       "repository", repository,
+	                       "options", options,
+	                       NULL);
+}
+
+/**
+ * ggit_status_monitor_get_repository:
+ * @monitor: a #GgitStatusMonitor.
+ *
+ * Gets the repository that @monitor watches.
+ *
+ * Returns: (transfer none): a #GgitRepository.
+ */
+GgitRepository *
+ggit_status_monitor_get_repository (GgitStatusMonitor *monitor)
+{
+	g_return_val_if_fail (GGIT_IS_STATUS_MONITOR (monitor), NULL);
+
+	return monitor->repository;
+}
+
+/**
+ * ggit_status_monitor_get_status:
+ * @monitor: a #GgitStatusMonitor.
+ * @path: the path of a file, relative to the working directory.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Gets the status of the file at @path from the cached statuses, after
+ * rechecking the files that changed. Files in an untracked or ignored
+ * directory that is reported as a whole get the status of the directory.
+ *
+ * Returns: the status of the file.
+ */
+GgitStatusFlags
+ggit_status_monitor_get_status (GgitStatusMonitor  *monitor,
+                                const gchar        *path,
+                                GError            **error)
+{
+	gpointer value;
+	const gchar *slash;
+
+	g_return_val_if_fail (GGIT_IS_STATUS_MONITOR (monitor), GGIT_STATUS_CURRENT);
+	g_return_val_if_fail (path != NULL, GGIT_STATUS_CURRENT);
+	g_return_val_if_fail (error == NULL || *error == NULL, GGIT_STATUS_CURRENT);
+
+	if (!ggit_status_monitor_refresh (monitor, error))
+	{
+		return GGIT_STATUS_CURRENT;
+	}
+
+	if (g_hash_table_lookup_extended (monitor->statuses, path, NULL, &value))
+	{
+		return GPOINTER_TO_UINT (value);
+	}
+
+	for (slash = strchr (path, '/'); slash != NULL; slash = strchr (slash + 1, '/'))
+	{
+		gchar *parent = g_strndup (path, slash - path + 1);
+		gboolean found;
+
+		found = g_hash_table_lookup_extended (monitor->statuses, parent, NULL, &value);
+		g_free (parent);
+
+		if (found)
+		{
+			return GPOINTER_TO_UINT (value);
+		}
+	}
+
+	return GGIT_STATUS_CURRENT;
+}
+
+static gint
+compare_paths (gconstpointer a,
+               gconstpointer b)
+{
+	return strcmp (*(const gchar * const *)a, *(const gchar * const *)b);
+}
+
+/**
+ * ggit_status_monitor_foreach:
+ * @monitor: a #GgitStatusMonitor.
+ * @callback: (scope call): a #GgitStatusCallback.
+ * @user_data: callback user data.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Calls @callback for each file that is not current, in path order,
+ * after rechecking the files that changed. If @callback returns
+ * something other than 0, the iteration will stop and @error will be set.
+ *
+ * Returns: %TRUE if there was no error, %FALSE otherwise.
+ */
+gboolean
+ggit_status_monitor_foreach (GgitStatusMonitor   *monitor,
+                             GgitStatusCallback   callback,
+                             gpointer             user_data,
+                             GError             **error)
+{
+	gchar **paths;
+	guint n_paths;
+	guint i;
+	gint ret = 0;
+
+	g_return_val_if_fail (GGIT_IS_STATUS_MONITOR (monitor), FALSE);
+	g_return_val_if_fail (callback != NULL, FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	if (!ggit_status_monitor_refresh (monitor, error))
+	{
+		return FALSE;
+	}
+
+	/* the callback may trigger a refresh, so iterate over a copy */
+	paths = (gchar **)g_hash_table_get_keys_as_array (monitor->statuses, &n_paths);
+
+	for (i = 0; i < n_paths; ++i)
+	{
+		paths[i] = g_strdup (paths[i]);
+	}
+
+	qsort (paths, n_paths, sizeof (gchar *), compare_paths);
+
+	for (i = 0; i < n_paths && ret == 0; ++i)
+	{
+		gpointer value = g_hash_table_lookup (monitor->statuses, paths[i]);
+
+		ret = callback (paths[i], GPOINTER_TO_UINT (value), user_data);
+	}
+
+	g_strfreev (paths);
+
+	if (ret != 0)
+	{
+		_ggit_error_set (error, ret);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+/* ex:set ts=8 noet: */
@@ -0,0 +1,57 @@
+/*
+ * ggit-status-monitor.h
+ * This file is part of libgit2-glib
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GGIT_STATUS_MONITOR_H__
+#define __GGIT_STATUS_MONITOR_H__
+
+#include <glib-object.h>
+#include <gio/gio.h>
+#include <git2.h>
+
+#include <libgit2-glib/ggit-types.h>
+
+G_BEGIN_DECLS
+
+#define GGIT_TYPE_STATUS_MONITOR (ggit_status_monitor_get_type ())
+G_DECLARE_FINAL_TYPE (GgitStatusMonitor, ggit_status_monitor, GGIT, STATUS_MONITOR, GObject)
+
+GgitStatusMonitor *ggit_status_monitor_new            (GgitRepository      *repository,
+                                                       GgitStatusOptions   *options,
+                                                       GError             **error);
+
+GgitRepository    *ggit_status_monitor_get_repository (GgitStatusMonitor   *monitor);
+
+gboolean           ggit_status_monitor_refresh        (GgitStatusMonitor   *monitor,
+                                                       GError             **error);
+
+void               ggit_status_monitor_invalidate     (GgitStatusMonitor   *monitor);
+
+GgitStatusFlags    ggit_status_monitor_get_status     (GgitStatusMonitor   *monitor,
+                                                       const gchar         *path,
+                                                       GError             **error);
+
+gboolean           ggit_status_monitor_foreach        (GgitStatusMonitor   *monitor,
+                                                       GgitStatusCallback   callback,
+                                                       gpointer             user_data,
+                                                       GError             **error);
+
+G_END_DECLS
+
+#endif /* __GGIT_STATUS_MONITOR_H__ */
+
+/* ex:set ts=8 noet: */
@@ -49,6 +49,73 @@ _ggit_tree_entry_wrap (git_tree_entry *entry,
 	return ret;
 }
 
+/*
+ * _ggit_tree_entry_set_borrowed:
+ * @entry: a #GgitTreeEntry created with @free_entry set to %FALSE, that is
+ *         not referenced by anyone else.
+ * @native: a #git_tree_entry owned by its tree.
+ *
+ * Points @entry at @native, so that a single #GgitTreeEntry can be reused
+ * for all the callbacks of a tree walk.
+ */
+void
+_ggit_tree_entry_set_borrowed (GgitTreeEntry        *entry,
+                               const git_tree_entry *native)
+{
+	g_return_if_fail (entry != NULL);
+	g_return_if_fail (!entry->free_entry);
+
+	entry->entry = (git_tree_entry *)native;
+}
+
+/*
+ * _ggit_tree_entry_is_shared:
+ * @entry: a #GgitTreeEntry.
+ *
+ * Returns: %TRUE if somebody else holds a reference to @entry.
+ */
+gboolean
+_ggit_tree_entry_is_shared (GgitTreeEntry *entry)
+{
+	g_return_val_if_fail (entry != NULL, FALSE);
+
+	return g_atomic_int_get (&entry->ref_count) > 1;
+}
+
+/*
+ * _ggit_tree_entry_detach:
+ * @entry: a #GgitTreeEntry.
+ *
+ * Copies a borrowed native entry, so that @entry no longer depends on the
+ * tree it was taken from.
+ *
+ * Returns: %GIT_OK, or the error of copying the entry in which case
+ *          @entry still borrows it.
+ */
+gint
+_ggit_tree_entry_detach (GgitTreeEntry *entry)
+{
+	git_tree_entry *dest;
+	gint ret;
+
+	g_return_val_if_fail (entry != NULL, GIT_ERROR);
+
+	if (entry->free_entry)
+	{
+		return GIT_OK;
+	}
+
+	ret = git_tree_entry_dup (&dest, entry->entry);
+
+	if (ret == GIT_OK)
+	{
+		entry->entry = dest;
+		entry->free_entry = TRUE;
+	}
+
+	return ret;
+}
+
 /**
  * ggit_tree_entry_ref:
  * @entry: a #GgitTreeEntry.
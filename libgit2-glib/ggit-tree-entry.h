@@ -34,6 +34,12 @@ GType          ggit_tree_entry_get_type        (void) G_GNUC_CONST;
 
 GgitTreeEntry *_ggit_tree_entry_wrap           (git_tree_entry       *entry,
                                                 gboolean              free_entry);
+
+void           _ggit_tree_entry_set_borrowed   (GgitTreeEntry        *entry,
+                                                const git_tree_entry *native);
+gboolean       _ggit_tree_entry_is_shared      (GgitTreeEntry        *entry);
+gint           _ggit_tree_entry_detach         (GgitTreeEntry        *entry);
+
 GgitTreeEntry *ggit_tree_entry_ref             (GgitTreeEntry        *entry);
 void           ggit_tree_entry_unref           (GgitTreeEntry        *entry);
 
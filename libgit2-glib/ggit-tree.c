@@ -18,11 +18,15 @@
  * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <string.h>
 #include <git2.h>
 
 #include "ggit-tree.h"
 #include "ggit-oid.h"
+#include "ggit-oid-array.h"
 #include "ggit-error.h"
+#include "ggit-manifest.h"
+#include "ggit-repository.h"
 
 /**
  * GgitTree:
@@ -210,31 +214,58 @@ typedef struct
 {
 	GgitTreeWalkCallback callback;
 	gpointer user_data;
+
+	/* reused for all the entries, unless the callback keeps it */
+	GgitTreeEntry *entry;
 } WalkInfo;
 
-static int
-walk_callback_wrapper (const char           *root,
-                       const git_tree_entry *entry,
-                       gpointer              payload)
+static gint
+walk_invoke_callback (WalkInfo             *info,
+                      const gchar          *root,
+                      const git_tree_entry *entry)
 {
 	gint ret;
-	GgitTreeEntry *wentry;
-	WalkInfo *info = (WalkInfo *)payload;
-	git_tree_entry *dest;
 
-	ret = git_tree_entry_dup (&dest, entry);
-	if (ret == GIT_OK)
+	if (info->entry == NULL)
+	{
+		info->entry = _ggit_tree_entry_wrap ((git_tree_entry *)entry, FALSE);
+	}
+	else
 	{
-		wentry = _ggit_tree_entry_wrap (dest, TRUE);
+		_ggit_tree_entry_set_borrowed (info->entry, entry);
+	}
 
-		ret = info->callback(root, wentry, info->user_data);
+	ret = info->callback (root, info->entry, info->user_data);
 
-		ggit_tree_entry_unref (wentry);
+	if (_ggit_tree_entry_is_shared (info->entry))
+	{
+		gint detached;
+
+		/* the callback kept the entry, so it can not be reused */
+		detached = _ggit_tree_entry_detach (info->entry);
+		ggit_tree_entry_unref (info->entry);
+		info->entry = NULL;
+
+		/* the kept entry still refers to the tree being walked, so
+		 * stop before that tree goes away.
+		 */
+		if (detached != GIT_OK)
+		{
+			return detached;
+		}
 	}
 
 	return ret;
 }
 
+static int
+walk_callback_wrapper (const char           *root,
+                       const git_tree_entry *entry,
+                       gpointer              payload)
+{
+	return walk_invoke_callback ((WalkInfo *)payload, root, entry);
+}
+
 /**
  * ggit_tree_walk:
  * @tree: a #GgitTree.
@@ -247,6 +278,13 @@ walk_callback_wrapper (const char           *root,
  * subtrees of the tree as needed). The @error will be set to the error returned
  * by @callback (if any).
  *
+ * When walking in %GGIT_TREE_WALK_MODE_PRE order, @callback can return a
+ * positive value for an entry of a subtree to skip walking that subtree.
+ *
+ * The same #GgitTreeEntry may be reused for the next entries, so it is only
+ * valid during the call to @callback unless @callback takes a reference on
+ * it.
+ *
  **/
 void
 ggit_tree_walk (GgitTree              *tree,
@@ -270,10 +308,566 @@ ggit_tree_walk (GgitTree              *tree,
 	                     (git_treewalk_cb)walk_callback_wrapper,
 	                     &info);
 
+	if (info.entry != NULL)
+	{
+		ggit_tree_entry_unref (info.entry);
+	}
+
 	if (ret != GIT_OK)
 	{
 		_ggit_error_set (error, ret);
 	}
 }
 
+typedef struct
+{
+	WalkInfo info;
+
+	git_repository *repository;
+	GgitTreeWalkMode mode;
+
+	git_pathspec *pathspec;
+	/* the leading part of each pattern without wildcards */
+	GPtrArray *literal_prefixes;
+
+	GString *root;
+} PathspecWalk;
+
+static gboolean
+walk_may_contain_matches (PathspecWalk *walk)
+{
+	guint i;
+
+	for (i = 0; i < walk->literal_prefixes->len; ++i)
+	{
+		const gchar *prefix = g_ptr_array_index (walk->literal_prefixes, i);
+		gsize len = MIN (strlen (prefix), walk->root->len);
+
+		if (strncmp (prefix, walk->root->str, len) == 0)
+		{
+			return TRUE;
+		}
+	}
+
+	return FALSE;
+}
+
+static gint
+walk_tree_with_pathspec (PathspecWalk *walk,
+                         git_tree     *tree)
+{
+	size_t n_entries;
+	size_t i;
+
+	n_entries = git_tree_entrycount (tree);
+
+	for (i = 0; i < n_entries; ++i)
+	{
+		const git_tree_entry *entry;
+		gboolean is_tree;
+		gsize root_len;
+		gint ret = 0;
+
+		entry = git_tree_entry_byindex (tree, i);
+		is_tree = git_tree_entry_type (entry) == GIT_OBJ_TREE;
+
+		root_len = walk->root->len;
+		g_string_append (walk->root, git_tree_entry_name (entry));
+
+		if (is_tree)
+		{
+			g_string_append_c (walk->root, '/');
+
+			if (!walk_may_contain_matches (walk))
+			{
+				g_string_truncate (walk->root, root_len);
+				continue;
+			}
+		}
+		else if (!git_pathspec_matches_path (walk->pathspec, 0, walk->root->str))
+		{
+			g_string_truncate (walk->root, root_len);
+			continue;
+		}
+
+		g_string_truncate (walk->root, root_len);
+
+		if (walk->mode == GGIT_TREE_WALK_MODE_PRE || !is_tree)
+		{
+			ret = walk_invoke_callback (&walk->info, walk->root->str, entry);
+
+			if (ret < 0)
+			{
+				return ret;
+			}
+		}
+
+		if (is_tree && (walk->mode == GGIT_TREE_WALK_MODE_POST || ret == 0))
+		{
+			git_tree *subtree;
+
+			ret = git_tree_lookup (&subtree, walk->repository, git_tree_entry_id (entry));
+
+			if (ret != GIT_OK)
+			{
+				return ret;
+			}
+
+			g_string_append (walk->root, git_tree_entry_name (entry));
+			g_string_append_c (walk->root, '/');
+
+			ret = walk_tree_with_pathspec (walk, subtree);
+
+			g_string_truncate (walk->root, root_len);
+			git_tree_free (subtree);
+
+			if (ret < 0)
+			{
+				return ret;
+			}
+
+			if (walk->mode == GGIT_TREE_WALK_MODE_POST)
+			{
+				ret = walk_invoke_callback (&walk->info, walk->root->str, entry);
+
+				if (ret < 0)
+				{
+					return ret;
+				}
+			}
+		}
+	}
+
+	return GIT_OK;
+}
+
+/**
+ * ggit_tree_walk_with_pathspec:
+ * @tree: a #GgitTree.
+ * @mode: the walking order.
+ * @pathspec: (array zero-terminated=1) (allow-none): the patterns the
+ *            paths of the entries have to match, or %NULL.
+ * @callback: (scope call): the callback to call for each entry.
+ * @user_data: (closure): user data for the callback.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Walk the entries of a tree object recursively like ggit_tree_walk(),
+ * but only call @callback for the files matching @pathspec. Subtrees are
+ * only resolved and passed to @callback when they may contain matching
+ * files, so the parts of the tree that are not needed are never read.
+ *
+ * As with ggit_tree_walk(), @callback can return a positive value in
+ * %GGIT_TREE_WALK_MODE_PRE order to skip a subtree, and the
+ * #GgitTreeEntry is only valid during the call unless @callback takes a
+ * reference on it.
+ *
+ **/
+void
+ggit_tree_walk_with_pathspec (GgitTree              *tree,
+                              GgitTreeWalkMode       mode,
+                              const gchar * const   *pathspec,
+                              GgitTreeWalkCallback   callback,
+                              gpointer               user_data,
+                              GError               **error)
+{
+	PathspecWalk walk = {{0,},};
+	git_strarray patterns;
+	gint ret;
+	gint i;
+
+	g_return_if_fail (GGIT_IS_TREE (tree));
+	g_return_if_fail (callback != NULL);
+	g_return_if_fail (error == NULL || *error == NULL);
+
+	if (pathspec == NULL || *pathspec == NULL)
+	{
+		ggit_tree_walk (tree, mode, callback, user_data, error);
+		return;
+	}
+
+	/* git_pathspec_new() copies the patterns */
+	patterns.strings = (gchar **)pathspec;
+	patterns.count = g_strv_length ((gchar **)pathspec);
+
+	ret = git_pathspec_new (&walk.pathspec, &patterns);
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (error, ret);
+		return;
+	}
+
+	walk.info.callback = callback;
+	walk.info.user_data = user_data;
+	walk.repository = git_tree_owner (_ggit_native_get (tree));
+	walk.mode = mode;
+	walk.root = g_string_new (NULL);
+	walk.literal_prefixes = g_ptr_array_new_with_free_func (g_free);
+
+	for (i = 0; pathspec[i] != NULL; ++i)
+	{
+		const gchar *pattern = pathspec[i];
+		gsize len = 0;
+
+		/* excluding patterns can not be used to prune subtrees */
+		if (*pattern != '!' && *pattern != ':')
+		{
+			len = strcspn (pattern, "*?[\\");
+		}
+
+		g_ptr_array_add (walk.literal_prefixes, g_strndup (pattern, len));
+	}
+
+	ret = walk_tree_with_pathspec (&walk, _ggit_native_get (tree));
+
+	if (walk.info.entry != NULL)
+	{
+		ggit_tree_entry_unref (walk.info.entry);
+	}
+
+	g_ptr_array_unref (walk.literal_prefixes);
+	g_string_free (walk.root, TRUE);
+	git_pathspec_free (walk.pathspec);
+
+	if (ret < 0)
+	{
+		_ggit_error_set (error, ret);
+	}
+}
+
+typedef struct
+{
+	git_oid id;
+	/* the path of the tree, with a trailing slash unless it is the root */
+	gchar *prefix;
+} ManifestTask;
+
+typedef struct
+{
+	gchar *path;
+	git_oid id;
+	guint32 mode;
+} ManifestRecord;
+
+typedef struct
+{
+	GArray *records;
+	GPtrArray *subtasks;
+	GError *error;
+} ManifestResult;
+
+typedef struct
+{
+	GAsyncQueue *repositories;
+	GAsyncQueue *results;
+} ManifestExport;
+
+static ManifestTask *
+manifest_task_new (const git_oid *id,
+                   gchar         *prefix)
+{
+	ManifestTask *task;
+
+	task = g_slice_new (ManifestTask);
+	git_oid_cpy (&task->id, id);
+	task->prefix = prefix;
+
+	return task;
+}
+
+static void
+manifest_task_free (ManifestTask *task)
+{
+	if (task == NULL)
+	{
+		return;
+	}
+
+	g_free (task->prefix);
+	g_slice_free (ManifestTask, task);
+}
+
+static void
+manifest_result_free (ManifestResult *result)
+{
+	if (result->records != NULL)
+	{
+		g_array_unref (result->records);
+	}
+
+	if (result->subtasks != NULL)
+	{
+		g_ptr_array_unref (result->subtasks);
+	}
+
+	g_clear_error (&result->error);
+	g_slice_free (ManifestResult, result);
+}
+
+static ManifestResult *
+manifest_read_tree (git_repository *repo,
+                    ManifestTask   *task)
+{
+	ManifestResult *result;
+	git_tree *tree;
+	size_t n_entries;
+	size_t i;
+	gint ret;
+
+	result = g_slice_new0 (ManifestResult);
+
+	ret = git_tree_lookup (&tree, repo, &task->id);
+
+	if (ret != GIT_OK)
+	{
+		_ggit_error_set (&result->error, ret);
+		return result;
+	}
+
+	n_entries = git_tree_entrycount (tree);
+
+	result->records = g_array_sized_new (FALSE, FALSE, sizeof (ManifestRecord), n_entries);
+	result->subtasks = g_ptr_array_new_with_free_func ((GDestroyNotify)manifest_task_free);
+
+	for (i = 0; i < n_entries; ++i)
+	{
+		const git_tree_entry *entry = git_tree_entry_byindex (tree, i);
+
+		if (git_tree_entry_type (entry) == GIT_OBJ_TREE)
+		{
+			g_ptr_array_add (result->subtasks,
+			                 manifest_task_new (git_tree_entry_id (entry),
+			                                    g_strconcat (task->prefix,
+			                                                 git_tree_entry_name (entry),
+			                                                 "/",
+			                                                 NULL)));
+		}
+		else
+		{
+			ManifestRecord record;
+
+			record.path = g_strconcat (task->prefix, git_tree_entry_name (entry), NULL);
+			git_oid_cpy (&record.id, git_tree_entry_id (entry));
+			record.mode = git_tree_entry_filemode (entry);
+
+			g_array_append_val (result->records, record);
+		}
+	}
+
+	git_tree_free (tree);
+
+	return result;
+}
+
+static void
+manifest_worker (gpointer data,
+                 gpointer user_data)
+{
+	ManifestTask *task = data;
+	ManifestExport *export = user_data;
+	GgitRepository *repository;
+	ManifestResult *result;
+
+	repository = g_async_queue_pop (export->repositories);
+	result = manifest_read_tree (_ggit_native_get (repository), task);
+	g_async_queue_push (export->repositories, repository);
+
+	manifest_task_free (task);
+	g_async_queue_push (export->results, result);
+}
+
+static gint
+compare_manifest_records (gconstpointer a,
+                          gconstpointer b)
+{
+	return strcmp (((const ManifestRecord *)a)->path,
+	               ((const ManifestRecord *)b)->path);
+}
+
+static GgitManifest *
+manifest_from_records (GArray *records)
+{
+	GString *paths;
+	GArray *offsets;
+	GgitOIdArray *oids;
+	GArray *modes;
+	gsize total = 0;
+	guint i;
+
+	qsort (records->data, records->len, sizeof (ManifestRecord), compare_manifest_records);
+
+	for (i = 0; i < records->len; ++i)
+	{
+		total += strlen (g_array_index (records, ManifestRecord, i).path) + 1;
+	}
+
+	paths = g_string_sized_new (total);
+	offsets = g_array_sized_new (FALSE, FALSE, sizeof (gsize), records->len);
+	oids = ggit_oid_array_new (records->len);
+	modes = g_array_sized_new (FALSE, FALSE, sizeof (guint32), records->len);
+
+	for (i = 0; i < records->len; ++i)
+	{
+		ManifestRecord *record = &g_array_index (records, ManifestRecord, i);
+		gsize offset = paths->len;
+
+		g_array_append_val (offsets, offset);
+		g_string_append_len (paths, record->path, strlen (record->path) + 1);
+
+		_ggit_oid_array_append_oid (oids, &record->id);
+		g_array_append_val (modes, record->mode);
+	}
+
+	return _ggit_manifest_new (paths, offsets, oids, modes);
+}
+
+static void
+clear_manifest_record (ManifestRecord *record)
+{
+	g_free (record->path);
+}
+
+/**
+ * ggit_tree_export_manifest:
+ * @tree: a #GgitTree.
+ * @n_threads: the number of worker threads, or 0 to use one per processor.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Lists all the files of @tree recursively, with their ids and modes.
+ * Subtrees are read concurrently on a pool of @n_threads worker threads,
+ * each with its own handle on the repository.
+ *
+ * The returned #GgitManifest stores the paths in a single string table and
+ * the ids and modes in packed arrays, sorted by path. Two manifests can
+ * be compared with ggit_manifest_diff().
+ *
+ * Returns: (transfer full) (nullable): a #GgitManifest, or %NULL on error.
+ *
+ **/
+GgitManifest *
+ggit_tree_export_manifest (GgitTree  *tree,
+                           gint       n_threads,
+                           GError   **error)
+{
+	ManifestExport export = {0,};
+	ManifestTask root;
+	GThreadPool *pool = NULL;
+	GArray *records;
+	GError *first_error = NULL;
+	git_tree *native;
+	gsize outstanding;
+	GgitManifest *manifest = NULL;
+
+	g_return_val_if_fail (GGIT_IS_TREE (tree), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	native = _ggit_native_get (tree);
+
+	if (n_threads <= 0)
+	{
+		n_threads = g_get_num_processors ();
+	}
+
+	export.results = g_async_queue_new ();
+
+	if (n_threads > 1)
+	{
+		GgitRepository *repository;
+
+		repository = ggit_object_get_owner (GGIT_OBJECT (tree));
+		export.repositories = _ggit_repository_open_workers (repository, n_threads);
+		g_object_unref (repository);
+
+		n_threads = g_async_queue_length (export.repositories);
+
+		if (n_threads > 0)
+		{
+			pool = g_thread_pool_new (manifest_worker,
+			                          &export,
+			                          n_threads,
+			                          FALSE,
+			                          NULL);
+		}
+	}
+
+	records = g_array_new (FALSE, FALSE, sizeof (ManifestRecord));
+	g_array_set_clear_func (records, (GDestroyNotify)clear_manifest_record);
+
+	git_oid_cpy (&root.id, git_tree_id (native));
+	root.prefix = (gchar *)"";
+
+	g_async_queue_push (export.results,
+	                    manifest_read_tree (git_tree_owner (native), &root));
+	outstanding = 1;
+
+	while (outstanding > 0)
+	{
+		ManifestResult *result;
+		guint i;
+
+		result = g_async_queue_pop (export.results);
+		--outstanding;
+
+		if (result->error != NULL)
+		{
+			if (first_error == NULL)
+			{
+				first_error = g_steal_pointer (&result->error);
+			}
+
+			manifest_result_free (result);
+			continue;
+		}
+
+		/* the paths are now owned by records */
+		g_array_append_vals (records, result->records->data, result->records->len);
+
+		for (i = 0; first_error == NULL && i < result->subtasks->len; ++i)
+		{
+			ManifestTask *task = g_ptr_array_index (result->subtasks, i);
+
+			if (pool != NULL)
+			{
+				/* the worker frees the task */
+				g_ptr_array_index (result->subtasks, i) = NULL;
+				g_thread_pool_push (pool, task, NULL);
+			}
+			else
+			{
+				g_async_queue_push (export.results,
+				                    manifest_read_tree (git_tree_owner (native), task));
+			}
+
+			++outstanding;
+		}
+
+		manifest_result_free (result);
+	}
+
+	if (pool != NULL)
+	{
+		g_thread_pool_free (pool, FALSE, TRUE);
+	}
+
+	if (export.repositories != NULL)
+	{
+		g_async_queue_unref (export.repositories);
+	}
+
+	g_async_queue_unref (export.results);
+
+	if (first_error != NULL)
+	{
+		g_propagate_error (error, first_error);
+	}
+	else
+	{
+		manifest = manifest_from_records (records);
+	}
+
+	g_array_unref (records);
+
+	return manifest;
+}
+
 /* ex:set ts=8 noet: */
@@ -25,6 +25,7 @@
 #include <libgit2-glib/ggit-object.h>
 #include <libgit2-glib/ggit-types.h>
 #include <libgit2-glib/ggit-tree-entry.h>
+#include <libgit2-glib/ggit-manifest.h>
 #include <gio/gio.h>
 
 G_BEGIN_DECLS
@@ -67,6 +68,17 @@ void           ggit_tree_walk           (GgitTree              *tree,
                                          gpointer               user_data,
                                          GError               **error);
 
+void           ggit_tree_walk_with_pathspec (GgitTree              *tree,
+                                             GgitTreeWalkMode       mode,
+                                             const gchar * const   *pathspec,
+                                             GgitTreeWalkCallback   callback,
+                                             gpointer               user_data,
+                                             GError               **error);
+
+GgitManifest  *ggit_tree_export_manifest (GgitTree  *tree,
+                                          gint       n_threads,
+                                          GError   **error);
+
 G_END_DECLS
 
 #endif /* __GGIT_TREE_H__ */
@@ -46,6 +46,13 @@ typedef struct _GgitBranchEnumerator GgitBranchEnumerator;
  */
 typedef struct _GgitCloneOptions GgitCloneOptions;
 
+/**
+ * GgitCommitInfo:
+ *
+ * Represents the metadata of a commit needed to show it in a log.
+ */
+typedef struct _GgitCommitInfo GgitCommitInfo;
+
 /**
  * GgitConfigEntry:
  *
@@ -137,6 +144,13 @@ typedef struct _GgitIndexEntries GgitIndexEntries;
  */
 typedef struct _GgitIndexEntry GgitIndexEntry;
 
+/**
+ * GgitIndexSnapshot:
+ *
+ * Represents a copy of the entries of an index, stored by column.
+ */
+typedef struct _GgitIndexSnapshot GgitIndexSnapshot;
+
 /**
  * GgitIndexEntriesResolveUndo:
  *
@@ -151,6 +165,13 @@ typedef struct _GgitIndexEntriesResolveUndo GgitIndexEntriesResolveUndo;
  */
 typedef struct _GgitIndexEntryResolveUndo GgitIndexEntryResolveUndo;
 
+/**
+ * GgitManifest:
+ *
+ * Represents the flattened list of files of a tree.
+ */
+typedef struct _GgitManifest GgitManifest;
+
 /**
  * GgitMergeOptions:
  *
@@ -172,6 +193,27 @@ typedef struct _GgitNote GgitNote;
  */
 typedef struct _GgitOId GgitOId;
 
+/**
+ * GgitOIdArray:
+ *
+ * Represents a packed array of #GgitOId.
+ */
+typedef struct _GgitOIdArray GgitOIdArray;
+
+/**
+ * GgitOIdMap:
+ *
+ * Represents a map from #GgitOId to arbitrary values.
+ */
+typedef struct _GgitOIdMap GgitOIdMap;
+
+/**
+ * GgitOIdSet:
+ *
+ * Represents a set of #GgitOId.
+ */
+typedef struct _GgitOIdSet GgitOIdSet;
+
 /**
  * GgitPatch:
  *
@@ -1137,6 +1179,22 @@ typedef gint (* GgitDiffHunkCallback) (GgitDiffDelta *delta,
                                        GgitDiffHunk  *hunk,
                                        gpointer       user_data);
 
+/**
+ * GgitDiffPatchCallback:
+ * @delta: a #GgitDiffDelta.
+ * @patch: the #GgitPatch generated for @delta.
+ * @index: the index of @delta in the diff.
+ * @user_data: (closure): user-supplied data.
+ *
+ * Called for each delta of a diff with its patch.
+ *
+ * Returns: 0 to go continue or a #GgitError in case there was an error.
+ */
+typedef gint (* GgitDiffPatchCallback) (GgitDiffDelta *delta,
+                                        GgitPatch     *patch,
+                                        gsize          index,
+                                        gpointer       user_data);
+
 /**
  * GgitDiffLineCallback:
  * @delta: a #GgitDiffDelta.
@@ -1144,7 +1202,9 @@ typedef gint (* GgitDiffHunkCallback) (GgitDiffDelta *delta,
  * @line: a #GgitDiffLine.
  * @user_data: (closure): user-supplied data.
  *
- * Called for each line.
+ * Called for each line. The content of @line is not copied for the
+ * callback; take a reference with ggit_diff_line_ref() to keep @line
+ * around after the callback returns.
  *
  * Returns: 0 to go continue or a #GgitError in case there was an error.
  */
@@ -1176,6 +1236,40 @@ typedef gint (* GgitDiffSimilarityMetricSimilarityCallback) (gint     *score,
                                                              gpointer  signature_b,
                                                              gpointer  user_data);
 
+/**
+ * GgitIndexAddProgressCallback:
+ * @path: the path of the file that was processed.
+ * @n_done: the number of files processed so far.
+ * @n_total: the total number of files to process.
+ * @user_data: (closure): user-supplied data.
+ *
+ * The type of the callback functions reporting the progress of
+ * ggit_index_add_paths().
+ */
+typedef void (* GgitIndexAddProgressCallback) (const gchar *path,
+                                               gsize        n_done,
+                                               gsize        n_total,
+                                               gpointer     user_data);
+
+/**
+ * GgitManifestDiffCallback:
+ * @path: the path of the file.
+ * @old_index: the index of the file in the old manifest, or -1 if it was
+ *             added.
+ * @new_index: the index of the file in the new manifest, or -1 if it was
+ *             removed.
+ * @user_data: (closure): user-supplied data.
+ *
+ * The type of the callback functions for comparing two manifests. See
+ * ggit_manifest_diff().
+ *
+ * Returns: 0 to go for the next file, or a non-zero value to stop.
+ */
+typedef gint (* GgitManifestDiffCallback) (const gchar *path,
+                                           gssize       old_index,
+                                           gssize       new_index,
+                                           gpointer     user_data);
+
 /**
  * GgitNoteCallback:
  * @blob_id: id of the blob containing the message.
@@ -1191,6 +1285,19 @@ typedef gint (* GgitNoteCallback) (GgitOId *blob_id,
                                    GgitOId *annotated_object_id,
                                    gpointer user_data);
 
+/**
+ * GgitOdbForeachCallback:
+ * @oid: the id of the object.
+ * @user_data: (closure): user-supplied data.
+ *
+ * The type of the callback functions for listing the objects of an object
+ * database. See ggit_odb_foreach().
+ *
+ * Returns: 0 to go for the next object, or a non-zero value to stop.
+ */
+typedef gint (* GgitOdbForeachCallback) (GgitOId  *oid,
+                                         gpointer  user_data);
+
 /**
  * GgitReferencesNameCallback:
  * @name: the name of the reference
@@ -1320,7 +1427,9 @@ typedef gint (* GgitTransferProgressCallback) (GgitTransferProgress *stats,
  * The type of the callback functions for walking a tree.
  * See ggit_tree_walk().
  *
- * Returns: 0 to go for the next entry or a #GgitError in case there was an error.
+ * Returns: 0 to go for the next entry, a positive value to skip the
+ * subtree of @entry when walking in pre-order, or a #GgitError in case
+ * there was an error.
  *
  */
 typedef gint (* GgitTreeWalkCallback) (const gchar         *root,
@@ -0,0 +1,657 @@
+/*
+ * ggit-untracked-cache.c
+ * This file is part of libgit2-glib
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include <gio/gio.h>
+
+#include "ggit-untracked-cache.h"
+
+/* The untracked and ignored files found below each top-level directory of
+ * the working directory, with a stamp of the modification time of each
+ * directory and ignore file below it. Files can only be added to or
+ * removed from a directory by changing its modification time, so the
+ * cached files stay valid as long as the stamps do. Like the untracked
+ * cache of git, checking them costs one stat per directory and ignore
+ * file, but no directory is listed; the directories are only listed again
+ * when one of them changed. The stamp of the repository covers the index,
+ * the global ignore rules and the status options, and invalidates the
+ * whole cache.
+ */
+
+#define UNTRACKED_CACHE_TYPE "(ta{s(a(st)a(su))})"
+
+#define FNV_OFFSET_BASIS G_GUINT64_CONSTANT (14695981039346656037)
+#define FNV_PRIME        G_GUINT64_CONSTANT (1099511628211)
+
+struct _GgitUntrackedCache
+{
+	guint64 stamp;
+
+	/* directory => UntrackedDirectory */
+	GHashTable *directories;
+};
+
+typedef struct
+{
+	/* a directory or ignore file, relative to the working directory */
+	gchar *path;
+	guint64 stamp;
+} UntrackedStamp;
+
+typedef struct
+{
+	GArray *stamps;
+	GArray *entries;
+} UntrackedDirectory;
+
+static void
+untracked_directory_free (UntrackedDirectory *directory)
+{
+	g_array_unref (directory->stamps);
+	g_array_unref (directory->entries);
+	g_slice_free (UntrackedDirectory, directory);
+}
+
+static void
+untracked_entry_clear (GgitUntrackedEntry *entry)
+{
+	g_free (entry->path);
+}
+
+static void
+untracked_stamp_clear (UntrackedStamp *stamp)
+{
+	g_free (stamp->path);
+}
+
+static GArray *
+untracked_stamps_new (void)
+{
+	GArray *stamps;
+
+	stamps = g_array_new (FALSE, FALSE, sizeof (UntrackedStamp));
+	g_array_set_clear_func (stamps, (GDestroyNotify)untracked_stamp_clear);
+
+	return stamps;
+}
+
+GArray *
+_ggit_untracked_entries_new (void)
+{
+	GArray *entries;
+
+	entries = g_array_new (FALSE, FALSE, sizeof (GgitUntrackedEntry));
+	g_array_set_clear_func (entries, (GDestroyNotify)untracked_entry_clear);
+
+	return entries;
+}
+
+GgitUntrackedCache *
+_ggit_untracked_cache_new (guint64 stamp)
+{
+	GgitUntrackedCache *cache;
+
+	cache = g_slice_new (GgitUntrackedCache);
+	cache->stamp = stamp;
+	cache->directories = g_hash_table_new_full (g_str_hash,
+	                                            g_str_equal,
+	                                            g_free,
+	                                            (GDestroyNotify)untracked_directory_free);
+
+	return cache;
+}
+
+void
+_ggit_untracked_cache_free (GgitUntrackedCache *cache)
+{
+	if (cache == NULL)
+	{
+		return;
+	}
+
+	g_hash_table_unref (cache->directories);
+	g_slice_free (GgitUntrackedCache, cache);
+}
+
+/*
+ * _ggit_untracked_cache_load:
+ * @filename: the file the cache was saved to.
+ * @stamp: the current stamp of the repository.
+ *
+ * Loads the cache saved to @filename. The cache is empty if the file does
+ * not exist, is invalid, or was saved with another repository stamp.
+ */
+GgitUntrackedCache *
+_ggit_untracked_cache_load (const gchar *filename,
+                            guint64      stamp)
+{
+	GgitUntrackedCache *cache;
+	GVariant *data;
+	GVariant *normal;
+	GVariantIter *directories;
+	GVariantIter *stamps;
+	GVariantIter *files;
+	gchar *contents;
+	gsize length;
+	guint64 saved_stamp;
+	const gchar *directory;
+
+	cache = _ggit_untracked_cache_new (stamp);
+
+	if (!g_file_get_contents (filename, &contents, &length, NULL))
+	{
+		return cache;
+	}
+
+	data = g_variant_new_from_data (G_VARIANT_TYPE (UNTRACKED_CACHE_TYPE),
+	                                contents,
+	                                length,
+	                                FALSE,
+	                                g_free,
+	                                contents);
+
+	/* the file may be truncated or corrupt */
+	normal = g_variant_get_normal_form (data);
+	g_variant_unref (data);
+
+	g_variant_get (normal, UNTRACKED_CACHE_TYPE, &saved_stamp, &directories);
+
+	while (saved_stamp == stamp &&
+	       g_variant_iter_loop (directories, "{&s(a(st)a(su))}", &directory, &stamps, &files))
+	{
+		GArray *directory_stamps = untracked_stamps_new ();
+		GArray *entries = _ggit_untracked_entries_new ();
+		UntrackedStamp directory_stamp;
+		GgitUntrackedEntry entry;
+		const gchar *path;
+
+		while (g_variant_iter_loop (stamps, "(&st)", &path, &directory_stamp.stamp))
+		{
+			directory_stamp.path = g_strdup (path);
+			g_array_append_val (directory_stamps, directory_stamp);
+		}
+
+		while (g_variant_iter_loop (files, "(&su)", &path, &entry.status))
+		{
+			entry.path = g_strdup (path);
+			g_array_append_val (entries, entry);
+		}
+
+		_ggit_untracked_cache_insert (cache, directory, directory_stamps, entries);
+	}
+
+	g_variant_iter_free (directories);
+	g_variant_unref (normal);
+
+	return cache;
+}
+
+/*
+ * _ggit_untracked_cache_save:
+ * @cache: a #GgitUntrackedCache.
+ * @filename: the file to save the cache to.
+ * @error: a #GError for error reporting, or %NULL.
+ *
+ * Atomically replaces @filename with the contents of @cache.
+ */
+gboolean
+_ggit_untracked_cache_save (GgitUntrackedCache  *cache,
+                            const gchar         *filename,
+                            GError             **error)
+{
+	GVariantBuilder builder;
+	GHashTableIter iter;
+	gpointer key;
+	gpointer value;
+	GVariant *data;
+	gboolean ret;
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{s(a(st)a(su))}"));
+	g_hash_table_iter_init (&iter, cache->directories);
+
+	while (g_hash_table_iter_next (&iter, &key, &value))
+	{
+		UntrackedDirectory *directory = value;
+		guint i;
+
+		g_variant_builder_open (&builder, G_VARIANT_TYPE ("{s(a(st)a(su))}"));
+		g_variant_builder_add (&builder, "s", key);
+		g_variant_builder_open (&builder, G_VARIANT_TYPE ("(a(st)a(su))"));
+		g_variant_builder_open (&builder, G_VARIANT_TYPE ("a(st)"));
+
+		for (i = 0; i < directory->stamps->len; ++i)
+		{
+			UntrackedStamp *stamp;
+
+			stamp = &g_array_index (directory->stamps, UntrackedStamp, i);
+			g_variant_builder_add (&builder, "(st)", stamp->path, stamp->stamp);
+		}
+
+		g_variant_builder_close (&builder);
+		g_variant_builder_open (&builder, G_VARIANT_TYPE ("a(su)"));
+
+		for (i = 0; i < directory->entries->len; ++i)
+		{
+			GgitUntrackedEntry *entry;
+
+			entry = &g_array_index (directory->entries, GgitUntrackedEntry, i);
+			g_variant_builder_add (&builder, "(su)", entry->path, entry->status);
+		}
+
+		g_variant_builder_close (&builder);
+		g_variant_builder_close (&builder);
+		g_variant_builder_close (&builder);
+	}
+
+	data = g_variant_ref_sink (g_variant_new (UNTRACKED_CACHE_TYPE,
+	                                          cache->stamp,
+	                                          &builder));
+
+	ret = g_file_set_contents (filename,
+	                           g_variant_get_data (data),
+	                           g_variant_get_size (data),
+	                           error);
+
+	g_variant_unref (data);
+	return ret;
+}
+
+static guint64
+hash_bytes (guint64        hash,
+            gconstpointer  data,
+            gsize          length)
+{
+	const guint8 *bytes = data;
+	gsize i;
+
+	for (i = 0; i < length; ++i)
+	{
+		hash ^= bytes[i];
+		hash *= FNV_PRIME;
+	}
+
+	return hash;
+}
+
+static guint64
+hash_info_time (guint64    hash,
+                GFileInfo *info)
+{
+	guint64 seconds;
+	guint32 usec;
+	goffset size;
+
+	seconds = g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED);
+	usec = g_file_info_get_attribute_uint32 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC);
+	size = g_file_info_get_size (info);
+
+	hash = hash_bytes (hash, &seconds, sizeof (seconds));
+	hash = hash_bytes (hash, &usec, sizeof (usec));
+
+	return hash_bytes (hash, &size, sizeof (size));
+}
+
+static guint64
+hash_file (guint64      hash,
+           GFile       *file)
+{
+	GFileInfo *info;
+
+	info = g_file_query_info (file,
+	                          G_FILE_ATTRIBUTE_STANDARD_SIZE ","
+	                          G_FILE_ATTRIBUTE_TIME_MODIFIED ","
+	                          G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC,
+	                          G_FILE_QUERY_INFO_NONE,
+	                          NULL,
+	                          NULL);
+
+	if (info == NULL)
+	{
+		return hash_bytes (hash, "", 1);
+	}
+
+	hash = hash_info_time (hash, info);
+	g_object_unref (info);
+
+	return hash;
+}
+
+static guint64
+hash_filename (guint64      hash,
+               const gchar *filename)
+{
+	GFile *file;
+
+	file = g_file_new_for_path (filename);
+	hash = hash_file (hash, file);
+	g_object_unref (file);
+
+	return hash;
+}
+
+/*
+ * _ggit_untracked_cache_stamp_repository:
+ * @repository: a #git_repository.
+ * @options: the status options.
+ *
+ * Computes a stamp of what the untracked files of the whole working
+ * directory depend on: the index, the repository and global ignore rules,
+ * and @options. The global rules are read from "core.excludesfile" or,
+ * when it is not set, from the default XDG ignore file.
+ */
+guint64
+_ggit_untracked_cache_stamp_repository (git_repository           *repository,
+                                        const git_status_options *options)
+{
+	guint64 hash = FNV_OFFSET_BASIS;
+	gchar *filename;
+	git_config *config;
+
+	/* caches saved in another format are discarded */
+	hash = hash_bytes (hash, UNTRACKED_CACHE_TYPE, strlen (UNTRACKED_CACHE_TYPE));
+	hash = hash_bytes (hash, &options->flags, sizeof (options->flags));
+	hash = hash_bytes (hash, &options->show, sizeof (options->show));
+
+	filename = g_build_filename (git_repository_path (repository), "index", NULL);
+	hash = hash_filename (hash, filename);
+	g_free (filename);
+
+	filename = g_build_filename (git_repository_path (repository), "info", "exclude", NULL);
+	hash = hash_filename (hash, filename);
+	g_free (filename);
+
+	filename = g_build_filename (git_repository_workdir (repository), ".gitignore", NULL);
+	hash = hash_filename (hash, filename);
+	g_free (filename);
+
+	if (git_repository_config_snapshot (&config, repository) == GIT_OK)
+	{
+		git_buf buf = {0,};
+
+		/* the path is expanded like libgit2 does, e.g. for "~/" */
+		if (git_config_get_path (&buf, config, "core.excludesfile") == GIT_OK)
+		{
+			filename = g_strndup (buf.ptr, buf.size);
+		}
+		else
+		{
+			/* libgit2 falls back to the XDG ignore file */
+			filename = g_build_filename (g_get_user_config_dir (), "git", "ignore", NULL);
+		}
+
+		hash = hash_bytes (hash, filename, strlen (filename));
+		hash = hash_filename (hash, filename);
+		g_free (filename);
+
+#if LIBGIT2_VER_MAJOR > 0 || (LIBGIT2_VER_MAJOR == 0 && LIBGIT2_VER_MINOR >= 28)
+		git_buf_dispose (&buf);
+#else
+		git_buf_free (&buf);
+#endif
+
+		git_config_free (config);
+	}
+
+	return hash;
+}
+
+static void
+append_stamp (GArray      *stamps,
+              const gchar *path,
+              GFile       *file)
+{
+	UntrackedStamp stamp;
+
+	stamp.path = g_strdup (path);
+	stamp.stamp = hash_file (FNV_OFFSET_BASIS, file);
+
+	g_array_append_val (stamps, stamp);
+}
+
+static void
+stamp_directory (git_repository *repository,
+                 GFile          *directory,
+                 const gchar    *path,
+                 gboolean        recurse_ignored,
+                 GArray         *stamps)
+{
+	GFileEnumerator *enumerator;
+	GFileInfo *info;
+
+	append_stamp (stamps, path, directory);
+
+	/* only the names and types, which do not need a stat per file */
+	enumerator = g_file_enumerate_children (directory,
+	                                        G_FILE_ATTRIBUTE_STANDARD_NAME ","
+	                                        G_FILE_ATTRIBUTE_STANDARD_TYPE,
+	                                        G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+	                                        NULL,
+	                                        NULL);
+
+	if (enumerator == NULL)
+	{
+		return;
+	}
+
+	while ((info = g_file_enumerator_next_file (enumerator, NULL, NULL)) != NULL)
+	{
+		const gchar *name = g_file_info_get_name (info);
+		GFile *child;
+		gchar *child_path;
+
+		if (strcmp (name, ".gitignore") == 0)
+		{
+			/* adding or removing it changes the directory, but editing
+			 * it does not */
+			child_path = g_strconcat (path, "/", name, NULL);
+			child = g_file_get_child (directory, name);
+
+			append_stamp (stamps, child_path, child);
+
+			g_object_unref (child);
+			g_free (child_path);
+		}
+		else if (g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY &&
+		         strcmp (name, ".git") != 0)
+		{
+			gint ignored = 0;
+
+			child_path = g_strconcat (path, "/", name, "/", NULL);
+
+			if (!recurse_ignored &&
+			    git_ignore_path_is_ignored (&ignored, repository, child_path) != GIT_OK)
+			{
+				ignored = 0;
+			}
+
+			/* the contents of ignored directories are not listed */
+			if (!ignored)
+			{
+				child_path[strlen (child_path) - 1] = '\0';
+				child = g_file_get_child (directory, name);
+
+				stamp_directory (repository, child, child_path, recurse_ignored, stamps);
+				g_object_unref (child);
+			}
+
+			g_free (child_path);
+		}
+
+		g_object_unref (info);
+	}
+
+	g_object_unref (enumerator);
+}
+
+/*
+ * _ggit_untracked_cache_stamp_directory:
+ * @repository: a #git_repository.
+ * @directory: a top-level directory of the working directory.
+ * @recurse_ignored: whether the contents of ignored directories are listed.
+ *
+ * Lists @directory and all the directories below it to stamp their
+ * modification times and those of their ignore files. This is only needed
+ * when @directory is not cached, as libgit2 lists them all anyway.
+ *
+ * Returns: (transfer full): the stamps, to be passed to
+ * _ggit_untracked_cache_insert().
+ */
+GArray *
+_ggit_untracked_cache_stamp_directory (git_repository *repository,
+                                       const gchar    *directory,
+                                       gboolean        recurse_ignored)
+{
+	GFile *file;
+	gchar *filename;
+	GArray *stamps;
+
+	filename = g_build_filename (git_repository_workdir (repository), directory, NULL);
+	file = g_file_new_for_path (filename);
+
+	stamps = untracked_stamps_new ();
+	stamp_directory (repository, file, directory, recurse_ignored, stamps);
+
+	g_object_unref (file);
+	g_free (filename);
+
+	return stamps;
+}
+
+/*
+ * _ggit_untracked_cache_lookup:
+ * @cache: a #GgitUntrackedCache.
+ * @repository: a #git_repository.
+ * @directory: a top-level directory of the working directory.
+ *
+ * Checks the stamp of each directory and ignore file recorded for
+ * @directory, with one stat each and without listing any directory.
+ *
+ * Returns: (transfer none) (nullable): the cached files below @directory,
+ * or %NULL if they are not cached or one of the stamps changed.
+ */
+GArray *
+_ggit_untracked_cache_lookup (GgitUntrackedCache *cache,
+                              git_repository     *repository,
+                              const gchar        *directory)
+{
+	UntrackedDirectory *cached;
+	const gchar *workdir;
+	guint i;
+
+	cached = g_hash_table_lookup (cache->directories, directory);
+
+	if (cached == NULL)
+	{
+		return NULL;
+	}
+
+	workdir = git_repository_workdir (repository);
+
+	for (i = 0; i < cached->stamps->len; ++i)
+	{
+		UntrackedStamp *stamp = &g_array_index (cached->stamps, UntrackedStamp, i);
+		gchar *filename;
+		guint64 current;
+
+		filename = g_build_filename (workdir, stamp->path, NULL);
+		current = hash_filename (FNV_OFFSET_BASIS, filename);
+		g_free (filename);
+
+		/* also catches removed directories and ignore files */
+		if (current != stamp->stamp)
+		{
+			return NULL;
+		}
+	}
+
+	return cached->entries;
+}
+
+/*
+ * _ggit_untracked_cache_insert:
+ * @cache: a #GgitUntrackedCache.
+ * @directory: a top-level directory of the working directory.
+ * @stamps: (transfer full): the stamps of @directory, from
+ * _ggit_untracked_cache_stamp_directory().
+ * @entries: (transfer full): the untracked and ignored files below @directory.
+ */
+void
+_ggit_untracked_cache_insert (GgitUntrackedCache *cache,
+                              const gchar        *directory,
+                              GArray             *stamps,
+                              GArray             *entries)
+{
+	UntrackedDirectory *cached;
+
+	cached = g_slice_new (UntrackedDirectory);
+	cached->stamps = stamps;
+	cached->entries = entries;
+
+	g_hash_table_replace (cache->directories, g_strdup (directory), cached);
+}
+
+/*
+ * _ggit_untracked_cache_copy:
+ * @cache: a #GgitUntrackedCache.
+ * @from: the #GgitUntrackedCache to copy from.
+ * @directory: a top-level directory of the working directory.
+ *
+ * Copies the stamps and files of @directory from @from to @cache, if
+ * @from has them.
+ */
+void
+_ggit_untracked_cache_copy (GgitUntrackedCache *cache,
+                            GgitUntrackedCache *from,
+                            const gchar        *directory)
+{
+	UntrackedDirectory *cached;
+	GArray *stamps;
+	GArray *entries;
+	guint i;
+
+	cached = g_hash_table_lookup (from->directories, directory);
+
+	if (cached == NULL)
+	{
+		return;
+	}
+
+	stamps = untracked_stamps_new ();
+
+	for (i = 0; i < cached->stamps->len; ++i)
+	{
+		UntrackedStamp stamp = g_array_index (cached->stamps, UntrackedStamp, i);
+
+		stamp.path = g_strdup (stamp.path);
+		g_array_append_val (stamps, stamp);
+	}
+
+	entries = _ggit_untracked_entries_new ();
+
+	for (i = 0; i < cached->entries->len; ++i)
+	{
+		GgitUntrackedEntry entry = g_array_index (cached->entries, GgitUntrackedEntry, i);
+
+		entry.path = g_strdup (entry.path);
+		g_array_append_val (entries, entry);
+	}
+
+	_ggit_untracked_cache_insert (cache, directory, stamps, entries);
+}
+
+/* ex:set ts=8 noet: */
@@ -0,0 +1,71 @@
+/*
+ * ggit-untracked-cache.h
+ * This file is part of libgit2-glib
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GGIT_UNTRACKED_CACHE_H__
+#define __GGIT_UNTRACKED_CACHE_H__
+
+#include <glib-object.h>
+#include <gio/gio.h>
+#include <git2.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GgitUntrackedCache GgitUntrackedCache;
+
+typedef struct
+{
+	gchar *path;
+	guint status;
+} GgitUntrackedEntry;
+
+GArray             *_ggit_untracked_entries_new                 (void);
+
+GgitUntrackedCache *_ggit_untracked_cache_new                   (guint64                    stamp);
+GgitUntrackedCache *_ggit_untracked_cache_load                  (const gchar               *filename,
+                                                                 guint64                    stamp);
+void                _ggit_untracked_cache_free                  (GgitUntrackedCache        *cache);
+
+gboolean            _ggit_untracked_cache_save                  (GgitUntrackedCache        *cache,
+                                                                 const gchar               *filename,
+                                                                 GError                   **error);
+
+GArray             *_ggit_untracked_cache_lookup                (GgitUntrackedCache        *cache,
+                                                                 git_repository            *repository,
+                                                                 const gchar               *directory);
+
+void                _ggit_untracked_cache_insert                (GgitUntrackedCache        *cache,
+                                                                 const gchar               *directory,
+                                                                 GArray                    *stamps,
+                                                                 GArray                    *entries);
+
+void                _ggit_untracked_cache_copy                  (GgitUntrackedCache        *cache,
+                                                                 GgitUntrackedCache        *from,
+                                                                 const gchar               *directory);
+
+guint64             _ggit_untracked_cache_stamp_repository      (git_repository            *repository,
+                                                                 const git_status_options  *options);
+
+GArray             *_ggit_untracked_cache_stamp_directory       (git_repository            *repository,
+                                                                 const gchar               *directory,
+                                                                 gboolean                   recurse_ignored);
+
+G_END_DECLS
+
+#endif /* __GGIT_UNTRACKED_CACHE_H__ */
+
+/* ex:set ts=8 noet: */
@@ -139,4 +139,52 @@ ggit_utils_get_git_strarray_from_str_array (const gchar * const *array,
 	}
 }
 
+/* Returns the object directory followed by its alternates */
+GPtrArray *
+ggit_utils_get_object_dirs (const gchar *objects_dir)
+{
+	GPtrArray *dirs;
+	gchar *alternates;
+	gchar *contents;
+
+	dirs = g_ptr_array_new_with_free_func (g_free);
+	g_ptr_array_add (dirs, g_strdup (objects_dir));
+
+	alternates = g_build_filename (objects_dir, "info", "alternates", NULL);
+
+	if (g_file_get_contents (alternates, &contents, NULL, NULL))
+	{
+		gchar **lines;
+		gchar **line;
+
+		lines = g_strsplit (contents, "\n", -1);
+
+		for (line = lines; *line != NULL; ++line)
+		{
+			g_strstrip (*line);
+
+			if (**line == '\0' || **line == '#')
+			{
+				continue;
+			}
+
+			if (g_path_is_absolute (*line))
+			{
+				g_ptr_array_add (dirs, g_strdup (*line));
+			}
+			else
+			{
+				g_ptr_array_add (dirs, g_build_filename (objects_dir, *line, NULL));
+			}
+		}
+
+		g_strfreev (lines);
+		g_free (contents);
+	}
+
+	g_free (alternates);
+
+	return dirs;
+}
+
 /* ex:set ts=8 noet: */
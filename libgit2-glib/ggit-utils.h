@@ -42,6 +42,8 @@ void            ggit_utils_get_git_strarray_from_str_array
                                                       (const gchar * const *array,
                                                        git_strarray        *gitarray);
 
+GPtrArray      *ggit_utils_get_object_dirs            (const gchar         *objects_dir);
+
 G_END_DECLS
 
 #endif
@@ -0,0 +1,280 @@
+/*
+ * diff-benchmark.c
+ * This file is part of libgit2-glib
+ *
+ * libgit2-glib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libgit2-glib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libgit2-glib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+
+#include "libgit2-glib/ggit.h"
+
+/*
+ * Builds two trees with n_files files of n_lines lines each, where every
+ * other line differs between the trees, and measures how many diff lines
+ * per second ggit_diff_foreach() delivers to its callbacks.
+ *
+ * For comparison it also measures the cost of the wrapper cache that
+ * ggit_diff_foreach() used before it remembered the current delta and
+ * hunk: for every callback that cache built a key from the path and id
+ * of the delta, plus the header of the hunk, and looked it up in a hash
+ * table. The "before" run does the same work in its callbacks on top of
+ * the current ggit_diff_foreach(), whose own lookups are only pointer
+ * and range comparisons.
+ */
+
+typedef struct
+{
+	guint64 n_files;
+	guint64 n_hunks;
+	guint64 n_lines;
+
+	/* only used to reproduce the previous cache */
+	GHashTable *deltas;
+	GHashTable *hunks;
+} Counters;
+
+static gchar *
+delta_key (GgitDiffDelta *delta)
+{
+	GgitDiffFile *file;
+	gchar *id;
+	gchar *key;
+
+	file = ggit_diff_delta_get_old_file (delta);
+
+	if (ggit_diff_file_get_path (file) == NULL)
+	{
+		file = ggit_diff_delta_get_new_file (delta);
+	}
+
+	id = ggit_oid_to_string (ggit_diff_file_get_oid (file));
+	key = g_strconcat (ggit_diff_file_get_path (file), id, NULL);
+	g_free (id);
+
+	return key;
+}
+
+static void
+lookup_key (GHashTable *table,
+            gchar      *key)
+{
+	if (g_hash_table_contains (table, key))
+	{
+		g_free (key);
+	}
+	else
+	{
+		g_hash_table_add (table, key);
+	}
+}
+
+static void
+lookup_keys (Counters      *counters,
+             GgitDiffDelta *delta,
+             GgitDiffHunk  *hunk)
+{
+	gchar *key;
+
+	if (counters->deltas == NULL)
+	{
+		return;
+	}
+
+	key = delta_key (delta);
+
+	if (hunk != NULL)
+	{
+		lookup_key (counters->hunks,
+		            g_strconcat (key, ggit_diff_hunk_get_header (hunk), NULL));
+	}
+
+	lookup_key (counters->deltas, key);
+}
+
+static gint
+file_cb (GgitDiffDelta *delta,
+         gfloat         progress,
+         gpointer       user_data)
+{
+	Counters *counters = user_data;
+
+	lookup_keys (counters, delta, NULL);
+	counters->n_files++;
+
+	return 0;
+}
+
+static gint
+binary_cb (GgitDiffDelta  *delta,
+           GgitDiffBinary *binary,
+           gpointer        user_data)
+{
+	return 0;
+}
+
+static gint
+hunk_cb (GgitDiffDelta *delta,
+         GgitDiffHunk  *hunk,
+         gpointer       user_data)
+{
+	Counters *counters = user_data;
+
+	lookup_keys (counters, delta, hunk);
+	counters->n_hunks++;
+
+	return 0;
+}
+
+static gint
+line_cb (GgitDiffDelta *delta,
+         GgitDiffHunk  *hunk,
+         GgitDiffLine  *line,
+         gpointer       user_data)
+{
+	Counters *counters = user_data;
+
+	lookup_keys (counters, delta, hunk);
+	counters->n_lines++;
+
+	return 0;
+}
+
+static GgitTree *
+create_tree (GgitRepository *repo,
+             guint           n_files,
+             guint           n_lines,
+             gboolean        modified)
+{
+	GError *err = NULL;
+	GgitTreeBuilder *builder;
+	GgitTree *tree;
+	GgitOId *oid;
+	GString *content;
+	guint i;
+	guint j;
+
+	builder = ggit_repository_create_tree_builder (repo, &err);
+	g_assert_no_error (err);
+
+	content = g_string_new (NULL);
+
+	for (i = 0; i < n_files; ++i)
+	{
+		GgitTreeEntry *entry;
+		GgitOId *blob;
+		gchar *name;
+
+		g_string_truncate (content, 0);
+
+		for (j = 0; j < n_lines; ++j)
+		{
+			g_string_append_printf (content,
+			                        "file %u line %u%s\n",
+			                        i,
+			                        j,
+			                        modified && (j % 2) == 0 ? " changed" : "");
+		}
+
+		blob = ggit_repository_create_blob_from_buffer (repo,
+		                                                content->str,
+		                                                content->len,
+		                                                &err);
+		g_assert_no_error (err);
+
+		name = g_strdup_printf ("file%06u.txt", i);
+		entry = ggit_tree_builder_insert (builder,
+		                                  name,
+		                                  blob,
+		                                  GGIT_FILE_MODE_BLOB,
+		                                  &err);
+		g_assert_no_error (err);
+
+		ggit_tree_entry_unref (entry);
+		ggit_oid_free (blob);
+		g_free (name);
+	}
+
+	g_string_free (content, TRUE);
+
+	oid = ggit_tree_builder_write (builder, &err);
+	g_assert_no_error (err);
+
+	tree = ggit_repository_lookup_tree (repo, oid, &err);
+	g_assert_no_error (err);
+
+	ggit_oid_free (oid);
+	g_object_unref (builder);
+
+	return tree;
+}
+
+static gdouble
+run_foreach (GgitDiff *diff,
+             gboolean  keyed,
+             Counters *counters)
+{
+	GError *err = NULL;
+	gint64 start;
+	gdouble elapsed;
+
+	memset (counters, 0, sizeof (Counters));
+
+	if (keyed)
+	{
+		counters->deltas = g_hash_table_new_full (g_str_hash,
+		                                          g_str_equal,
+		                                          g_free,
+		                                          NULL);
+		counters->hunks = g_hash_table_new_full (g_str_hash,
+		                                         g_str_equal,
+		                                         g_free,
+		                                         NULL);
+	}
+
+	/* load the blobs once so that both runs find them in the cache */
+	run_foreach (diff, FALSE, &counters);
+
+	before = run_foreach (diff, TRUE, &counters);
+	after = run_foreach (diff, FALSE, &counters);
+
+	g_print ("files: %" G_GUINT64_FORMAT ", hunks: %" G_GUINT64_FORMAT
+	         ", lines: %" G_GUINT64_FORMAT "\n",
+	         counters.n_files, counters.n_hunks, counters.n_lines);
+
+	print_run ("before (string keyed cache)", before, &counters);
+	print_run ("after (current delta and hunk)", after, &counters);
+
+	g_print ("speedup: %.2fx\n", after > 0 ? before / after : 0.0);
+
+	g_object_unref (diff);
+	g_object_unref (new_tree);
+	g_object_unref (old_tree);
+	g_object_unref (repo);
+	g_object_unref (f);
+
+	cmd = g_strdup_printf ("rm -rf '%s'", dir);
+	ret = system (cmd);
+	g_assert (ret == 0);
+
+	g_free (cmd);
+	g_free (dir);
+
+	return 0;
+}
+
+/* ex:set ts=8 noet: */
@@ -32,6 +32,7 @@
 #include <glib/gstdio.h>
 
 #include "libgit2-glib/ggit.h"
+#include "libgit2-glib/ggit-convert.h"
 
 #define TESTREPO_NAME "testrepo.git"
 
@@ -200,6 +201,47 @@ test_repository_init_bare (const gchar *git_dir)
 	do_test_init (git_dir, TRUE);
 }
 
+static void
+on_open_ready (GObject      *source,
+               GAsyncResult *result,
+               gpointer      user_data)
+{
+	GgitRepository **repo = user_data;
+	GError *err = NULL;
+
+	*repo = ggit_repository_open_finish (result, &err);
+	g_assert_no_error (err);
+}
+
+static void
+test_repository_open_async (const gchar *git_dir)
+{
+	GError *err = NULL;
+	GgitRepository *repo;
+	GgitRepository *opened = NULL;
+	GFile *f;
+	GFile *location;
+
+	f = g_file_new_for_path (git_dir);
+	repo = ggit_repository_init_repository (f, FALSE, &err);
+	g_assert_no_error (err);
+	g_object_unref (repo);
+
+	ggit_repository_open_async (f, NULL, on_open_ready, &opened);
+
+	while (opened == NULL)
+	{
+		g_main_context_iteration (NULL, TRUE);
+	}
+
+	location = ggit_repository_get_workdir (opened);
+	g_assert (g_file_equal (location, f));
+
+	g_object_unref (location);
+	g_object_unref (opened);
+	g_object_unref (f);
+}
+
 static void
 test_repository_blob_stream (const gchar *git_dir)
 {
@@ -360,6 +402,4138 @@ test_repository_encoding (const gchar *git_dir)
 	g_object_unref (repo);
 }
 
+static void
+test_repository_shorten_oids (const gchar *git_dir)
+{
+	GFile *f;
+	GgitRepository *repo;
+	GError *err = NULL;
+	GgitOId *oids[2];
+	GgitOIdArray *candidates;
+	gchar **shortened;
+	gchar *hex;
+
+	f = g_file_new_for_path (git_dir);
+	repo = ggit_repository_init_repository (f, FALSE, &err);
+	g_object_unref (f);
+
+	g_assert_no_error (err);
+
+	oids[0] = ggit_repository_create_blob_from_buffer (repo, "a\n", 2, &err);
+	g_assert_no_error (err);
+
+	oids[1] = ggit_repository_create_blob_from_buffer (repo, "b\n", 2, &err);
+	g_assert_no_error (err);
+
+	shortened = ggit_repository_shorten_oids (repo, oids, 2, 0, &err);
+	g_assert_no_error (err);
+	g_assert (shortened != NULL);
+	g_assert_cmpuint (g_strv_length (shortened), ==, 2);
+
+	g_assert_cmpuint (strlen (shortened[0]), ==, 7);
+	g_assert (ggit_oid_has_prefix (oids[0], shortened[0]));
+	g_assert (ggit_oid_has_prefix (oids[1], shortened[1]));
+
+	candidates = ggit_repository_find_oids_by_prefix (repo, shortened[1], &err);
+	g_assert_no_error (err);
+	g_assert_cmpuint (ggit_oid_array_get_size (candidates), ==, 1);
+
+	hex = ggit_oid_array_to_hex (candidates, NULL);
+	g_assert (ggit_oid_has_prefix (oids[1], hex));
+
+	g_free (hex);
+	ggit_oid_array_unref (candidates);
+
+	/* a loose object added after the index was built is found */
+	ggit_oid_free (oids[1]);
+	oids[1] = ggit_repository_create_blob_from_buffer (repo, "c\n", 2, &err);
+	g_assert_no_error (err);
+
+	hex = ggit_oid_to_string (oids[1]);
+	candidates = ggit_repository_find_oids_by_prefix (repo, hex, &err);
+	g_assert_no_error (err);
+	g_assert_cmpuint (ggit_oid_array_get_size (candidates), ==, 1);
+
+	g_free (hex);
+	ggit_oid_array_unref (candidates);
+	g_strfreev (shortened);
+	ggit_oid_free (oids[0]);
+	ggit_oid_free (oids[1]);
+	g_object_unref (repo);
+}
+
+static gint
+append_status (const gchar *path,
+               guint        status_flags,
+               gpointer     user_data)
+{
+	g_string_append_printf (user_data, "%s:%u\n", path, status_flags);
+	return 0;
+}
+
+static void
+assert_parallel_status (GgitRepository *repo)
+{
+	GError *err = NULL;
+	GString *serial;
+	GString *parallel;
+	gint i;
+
+	serial = g_string_new (NULL);
+	ggit_repository_file_status_foreach (repo, NULL, append_status, serial, &err);
+	g_assert_no_error (err);
+
+	/* the second run is answered from the untracked cache */
+	for (i = 0; i < 2; ++i)
+	{
+		parallel = g_string_new (NULL);
+		ggit_repository_file_status_foreach_parallel (repo, NULL, 2, TRUE,
+		                                              append_status, parallel,
+		                                              &err);
+		g_assert_no_error (err);
+		g_assert_cmpstr (parallel->str, ==, serial->str);
+		g_string_free (parallel, TRUE);
+	}
+
+	g_string_free (serial, TRUE);
+}
+
+static void
+write_test_file (const gchar *git_dir,
+                 const gchar *path)
+{
+	GError *err = NULL;
+	gchar *filename;
+	gchar *dirname;
+
+	filename = g_build_filename (git_dir, path, NULL);
+	dirname = g_path_get_dirname (filename);
+
+	g_mkdir_with_parents (dirname, 0700);
+	g_file_set_contents (filename, path, -1, &err);
+	g_assert_no_error (err);
+
+	g_free (dirname);
+	g_free (filename);
+}
+
+static GgitBlob *
+create_test_blob (GgitRepository *repo,
+                  const gchar    *content)
+{
+	GError *err = NULL;
+	GgitOId *oid;
+	GgitBlob *blob;
+
+	oid = ggit_repository_create_blob_from_buffer (repo, content, strlen (content), &err);
+	g_assert_no_error (err);
+
+	blob = GGIT_BLOB (ggit_repository_lookup (repo, oid, GGIT_TYPE_BLOB, &err));
+	g_assert_no_error (err);
+
+	ggit_oid_free (oid);
+
+	return blob;
+}
+
+static void
+test_repository_patch_line (const gchar *git_dir)
+{
+	GFile *f;
+	GgitRepository *repo;
+	GError *err = NULL;
+	GgitBlob *old_blob;
+	GgitBlob *new_blob;
+	GgitPatch *patch;
+	GgitDiffLine *line;
+	const guint8 *content;
+	gsize size;
+
+	f = g_file_new_for_path (git_dir);
+	repo = ggit_repository_init_repository (f, FALSE, &err);
+	g_object_unref (f);
+
+	g_assert_no_error (err);
+
+	old_blob = create_test_blob (repo, "a\nb\n");
+	new_blob = create_test_blob (repo, "a\nc\n");
+
+	patch = ggit_patch_new_from_blobs (old_blob, "a.txt", new_blob, "a.txt", NULL, &err);
+	g_assert_no_error (err);
+
+	g_assert_cmpuint (ggit_patch_get_num_hunks (patch), ==, 1);
+	g_assert_cmpint (ggit_patch_get_num_lines_in_hunk (patch, 0), ==, 3);
+
+	line = ggit_patch_get_line_in_hunk (patch, 0, 1, &err);
+	g_assert_no_error (err);
+
+	/* the line borrows the text of the patch and keeps it alive */
+	ggit_patch_unref (patch);
+	g_object_unref (old_blob);
+	g_object_unref (new_blob);
+
+	g_assert_cmpint (ggit_diff_line_get_origin (line), ==, GGIT_DIFF_LINE_DELETION);
+	g_assert_cmpint (ggit_diff_line_get_old_lineno (line), ==, 2);
+
+	content = ggit_diff_line_get_content (line, &size);
+	g_assert_cmpuint (size, ==, 2);
+	g_assert (memcmp (content, "b\n", 2) == 0);
+	g_assert_cmpstr (ggit_diff_line_get_text (line), ==, "b\n");
+
+	ggit_diff_line_unref (line);
+	g_object_unref (repo);
+}
+
+static void
+test_repository_odb (const gchar *git_dir)
+{
+	GFile *f;
+	GgitRepository *repo;
+	GgitOdb *odb;
+	GError *err = NULL;
+	GgitOId *oids[2];
+	GArray *exists;
+	GBytes *bytes;
+	GType type;
+	gsize size;
+
+	f = g_file_new_for_path (git_dir);
+	repo = ggit_repository_init_repository (f, FALSE, &err);
+	g_object_unref (f);
+
+	g_assert_no_error (err);
+
+	oids[0] = ggit_repository_create_blob_from_buffer (repo, "hello\n", 6, &err);
+	g_assert_no_error (err);
+
+	oids[1] = ggit_oid_new_from_string ("0123456789012345678901234567890123456789");
+
+	odb = ggit_repository_get_odb (repo, &err);
+	g_assert_no_error (err);
+
+	g_assert (ggit_odb_exists (odb, oids[0]));
+	g_assert (!ggit_odb_exists (odb, oids[1]));
+
+	exists = ggit_odb_exists_many (odb, oids, 2, &err);
+	g_assert_no_error (err);
+	g_assert_cmpuint (exists->len, ==, 2);
+	g_assert (g_array_index (exists, gboolean, 0));
+	g_assert (!g_array_index (exists, gboolean, 1));
+	g_array_unref (exists);
+
+	ggit_odb_read_header (odb, oids[0], &type, &size, &err);
+	g_assert_no_error (err);
+	g_assert (type == GGIT_TYPE_BLOB);
+	g_assert_cmpuint (size, ==, 6);
+
+	bytes = ggit_odb_read (odb, oids[0], &type, &err);
+	g_assert_no_error (err);
+	g_assert (type == GGIT_TYPE_BLOB);
+	g_assert_cmpuint (g_bytes_get_size (bytes), ==, 6);
+	g_assert (memcmp (g_bytes_get_data (bytes, NULL), "hello\n", 6) == 0);
+	g_bytes_unref (bytes);
+
+	bytes = ggit_odb_read (odb, oids[1], NULL, &err);
+	g_assert (bytes == NULL);
+	g_assert_error (err, GGIT_ERROR, GGIT_ERROR_NOTFOUND);
+	g_clear_error (&err);
+
+	ggit_oid_free (oids[0]);
+	ggit_oid_free (oids[1]);
+	g_object_unref (odb);
+	g_object_unref (repo);
+}
+
+typedef struct
+{
+	GType type;
+	GBytes *bytes;
+} TestOdbObject;
+
+typedef struct
+{
+	GgitOdbBackend parent_instance;
+
+	/* hex id -> TestOdbObject */
+	GHashTable *objects;
+} TestOdbBackend;
+
+typedef struct
+{
+	GgitOdbBackendClass parent_class;
+} TestOdbBackendClass;
+
+GType test_odb_backend_get_type (void);
+
+G_DEFINE_TYPE (TestOdbBackend, test_odb_backend, GGIT_TYPE_ODB_BACKEND)
+
+static void
+test_odb_object_free (TestOdbObject *object)
+{
+	g_bytes_unref (object->bytes);
+	g_slice_free (TestOdbObject, object);
+}
+
+static TestOdbObject *
+test_odb_backend_find (GgitOdbBackend  *backend,
+                       const gchar     *prefix,
+                       GgitOId        **oid,
+                       GError         **error)
+{
+	TestOdbBackend *self = (TestOdbBackend *)backend;
+	TestOdbObject *found = NULL;
+	GHashTableIter iter;
+	gpointer key;
+	gpointer value;
+
+	g_hash_table_iter_init (&iter, self->objects);
+
+	while (g_hash_table_iter_next (&iter, &key, &value))
+	{
+		if (!g_str_has_prefix (key, prefix))
+		{
+			continue;
+		}
+
+		if (found != NULL)
+		{
+			ggit_oid_free (*oid);
+			*oid = NULL;
+
+			g_set_error_literal (error, GGIT_ERROR, GGIT_ERROR_AMBIGUOUS,
+			                     "ambiguous prefix");
+			return NULL;
+		}
+
+		found = value;
+		*oid = ggit_oid_new_from_string (key);
+	}
+
+	return found;
+}
+
+static GBytes *
+test_odb_backend_read (GgitOdbBackend  *backend,
+                       GgitOId         *oid,
+                       GType           *type,
+                       GError         **error)
+{
+	TestOdbBackend *self = (TestOdbBackend *)backend;
+	TestOdbObject *object;
+	gchar *hex;
+
+	hex = ggit_oid_to_string (oid);
+	object = g_hash_table_lookup (self->objects, hex);
+	g_free (hex);
+
+	if (object == NULL)
+	{
+		return NULL;
+	}
+
+	*type = object->type;
+	return g_bytes_ref (object->bytes);
+}
+
+static gboolean
+test_odb_backend_read_header (GgitOdbBackend  *backend,
+                              GgitOId         *oid,
+                              GType           *type,
+                              gsize           *size,
+                              GError         **error)
+{
+	GBytes *bytes;
+
+	bytes = test_odb_backend_read (backend, oid, type, error);
+
+	if (bytes == NULL)
+	{
+		return FALSE;
+	}
+
+	*size = g_bytes_get_size (bytes);
+	g_bytes_unref (bytes);
+
+	return TRUE;
+}
+
+static gboolean
+test_odb_backend_write (GgitOdbBackend  *backend,
+                        GgitOId         *oid,
+                        GBytes          *data,
+                        GType            type,
+                        GError         **error)
+{
+	TestOdbBackend *self = (TestOdbBackend *)backend;
+	TestOdbObject *object;
+
+	object = g_slice_new (TestOdbObject);
+	object->type = type;
+	object->bytes = g_bytes_ref (data);
+
+	g_hash_table_replace (self->objects, ggit_oid_to_string (oid), object);
+
+	return TRUE;
+}
+
+static gboolean
+test_odb_backend_exists (GgitOdbBackend *backend,
+                         GgitOId        *oid)
+{
+	TestOdbBackend *self = (TestOdbBackend *)backend;
+	gchar *hex;
+	gboolean ret;
+
+	hex = ggit_oid_to_string (oid);
+	ret = g_hash_table_contains (self->objects, hex);
+	g_free (hex);
+
+	return ret;
+}
+
+static GBytes *
+test_odb_backend_read_prefix (GgitOdbBackend  *backend,
+                              const gchar     *prefix,
+                              GgitOId        **oid,
+                              GType           *type,
+                              GError         **error)
+{
+	TestOdbObject *object;
+
+	object = test_odb_backend_find (backend, prefix, oid, error);
+
+	if (object == NULL)
+	{
+		return NULL;
+	}
+
+	*type = object->type;
+	return g_bytes_ref (object->bytes);
+}
+
+static GgitOId *
+test_odb_backend_exists_prefix (GgitOdbBackend  *backend,
+                                const gchar     *prefix,
+                                GError         **error)
+{
+	GgitOId *oid = NULL;
+
+	test_odb_backend_find (backend, prefix, &oid, error);
+
+	return oid;
+}
+
+static gboolean
+test_odb_backend_foreach (GgitOdbBackend          *backend,
+                          GgitOdbForeachCallback   callback,
+                          gpointer                 user_data,
+                          GError                 **error)
+{
+	TestOdbBackend *self = (TestOdbBackend *)backend;
+	GHashTableIter iter;
+	gpointer key;
+
+	g_hash_table_iter_init (&iter, self->objects);
+
+	while (g_hash_table_iter_next (&iter, &key, NULL))
+	{
+		GgitOId *oid;
+		gint ret;
+
+		oid = ggit_oid_new_from_string (key);
+		ret = callback (oid, user_data);
+		ggit_oid_free (oid);
+
+		if (ret != 0)
+		{
+			break;
+		}
+	}
+
+	return TRUE;
+}
+
+static void
+test_odb_backend_finalize (GObject *object)
+{
+	TestOdbBackend *self = (TestOdbBackend *)object;
+
+	g_hash_table_unref (self->objects);
+
+	G_OBJECT_CLASS (test_odb_backend_parent_class)->finalize (object);
+}
+
+static void
+test_odb_backend_class_init (TestOdbBackendClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+	GgitOdbBackendClass *backend_class = GGIT_ODB_BACKEND_CLASS (klass);
+
+	object_class->finalize = test_odb_backend_finalize;
+
+	backend_class->read = test_odb_backend_read;
+	backend_class->read_header = test_odb_backend_read_header;
+	backend_class->write = test_odb_backend_write;
+	backend_class->exists = test_odb_backend_exists;
+	backend_class->read_prefix = test_odb_backend_read_prefix;
+	backend_class->exists_prefix = test_odb_backend_exists_prefix;
+	backend_class->foreach = test_odb_backend_foreach;
+}
+
+static void
+test_odb_backend_init (TestOdbBackend *self)
+{
+	self->objects = g_hash_table_new_full (g_str_hash,
+	                                       g_str_equal,
+	                                       g_free,
+	                                       (GDestroyNotify)test_odb_object_free);
+}
+
+static gint
+collect_odb_oid (GgitOId  *oid,
+                 gpointer  user_data)
+{
+	GPtrArray *oids = user_data;
+
+	g_ptr_array_add (oids, ggit_oid_copy (oid));
+	return 0;
+}
+
+static void
+test_repository_odb_backend (const gchar *git_dir)
+{
+	GFile *f;
+	GgitRepository *repo;
+	GgitOdb *odb;
+	TestOdbBackend *backend;
+	TestOdbObject *stored;
+	GError *err = NULL;
+	GgitOId *oid;
+	GgitOId *found;
+	GgitObject *object;
+	GPtrArray *oids;
+	GBytes *bytes;
+	GType type;
+	gchar data[] = "custom backend\n";
+	gchar *hex;
+	gchar *prefix;
+
+	f = g_file_new_for_path (git_dir);
+	repo = ggit_repository_init_repository (f, FALSE, &err);
+	g_object_unref (f);
+
+	g_assert_no_error (err);
+
+	odb = ggit_repository_get_odb (repo, &err);
+	g_assert_no_error (err);
+
+	/* above the loose and packed backends, so that it gets the writes */
+	backend = g_object_new (test_odb_backend_get_type (), NULL);
+	ggit_odb_add_backend (odb, GGIT_ODB_BACKEND (backend), 10, &err);
+	g_assert_no_error (err);
+
+	oid = ggit_odb_write (odb, (const guint8 *)data, strlen (data), GGIT_TYPE_BLOB, &err);
+	g_assert_no_error (err);
+
+	/* the backend keeps its own copy of the written data */
+	memset (data, 'x', strlen (data));
+
+	hex = ggit_oid_to_string (oid);
+	stored = g_hash_table_lookup (backend->objects, hex);
+	g_assert (stored != NULL);
+	g_assert (stored->type == GGIT_TYPE_BLOB);
+	g_assert_cmpuint (g_bytes_get_size (stored->bytes), ==, 15);
+	g_assert (memcmp (g_bytes_get_data (stored->bytes, NULL), "custom backend\n", 15) == 0);
+
+	g_assert (ggit_odb_exists (odb, oid));
+
+	bytes = ggit_odb_read (odb, oid, &type, &err);
+	g_assert_no_error (err);
+	g_assert (type == GGIT_TYPE_BLOB);
+	g_assert (g_bytes_equal (bytes, stored->bytes));
+	g_bytes_unref (bytes);
+
+	/* short ids are resolved through read_prefix */
+	prefix = g_strndup (hex, 7);
+	object = ggit_repository_revparse (repo, prefix, &err);
+	g_assert_no_error (err);
+	g_assert (GGIT_IS_BLOB (object));
+	found = ggit_object_get_id (object);
+	g_assert (ggit_oid_equal (found, oid));
+	ggit_oid_free (found);
+	g_object_unref (object);
+	g_free (prefix);
+
+	/* the object is only in the custom backend */
+	oids = g_ptr_array_new_with_free_func ((GDestroyNotify)ggit_oid_free);
+	ggit_odb_foreach (odb, collect_odb_oid, oids, &err);
+	g_assert_no_error (err);
+	g_assert_cmpuint (oids->len, ==, 1);
+	g_assert (ggit_oid_equal (g_ptr_array_index (oids, 0), oid));
+	g_ptr_array_unref (oids);
+
+	g_free (hex);
+	ggit_oid_free (oid);
+	g_object_unref (backend);
+	g_object_unref (odb);
+	g_object_unref (repo);
+}
+
+static void
+test_repository_shorten_oids_backend (const gchar *git_dir)
+{
+	GFile *f;
+	GgitRepository *repo;
+	GgitOdb *odb;
+	TestOdbBackend *backend;
+	TestOdbObject *fake;
+	GError *err = NULL;
+	GgitOId *oid;
+	GgitOIdArray *candidates;
+	gchar **shortened;
+	gchar *hex;
+	gchar *fake_hex;
+	gchar *prefix;
+
+	f = g_file_new_for_path (git_dir);
+	repo = ggit_repository_init_repository (f, FALSE, &err);
+	g_object_unref (f);
+
+	g_assert_no_error (err);
+
+	oid = ggit_repository_create_blob_from_buffer (repo, "a\n", 2, &err);
+	g_assert_no_error (err);
+
+	/* build the prefix index before the backend is added */
+	shortened = ggit_repository_shorten_oids (repo, &oid, 1, 0, &err);
+	g_assert_no_error (err);
+	g_assert_cmpuint (strlen (shortened[0]), ==, 7);
+	g_strfreev (shortened);
+
+	odb = ggit_repository_get_odb (repo, &err);
+	g_assert_no_error (err);
+
+	backend = g_object_new (test_odb_backend_get_type (), NULL);
+	ggit_odb_add_backend (odb, GGIT_ODB_BACKEND (backend), 10, &err);
+	g_assert_no_error (err);
+
+	/* an object of the backend sharing the first 10 digits of the blob */
+	hex = ggit_oid_to_string (oid);
+	fake_hex = g_strdup (hex);
+	fake_hex[10] = hex[10] == '0' ? '1' : '0';
+
+	fake = g_slice_new (TestOdbObject);
+	fake->type = GGIT_TYPE_BLOB;
+	fake->bytes = g_bytes_new_static ("fake\n", 5);
+	g_hash_table_insert (backend->objects, fake_hex, fake);
+
+	shortened = ggit_repository_shorten_oids (repo, &oid, 1, 0, &err);
+	g_assert_no_error (err);
+	g_assert_cmpuint (strlen (shortened[0]), ==, 11);
+	g_assert (ggit_oid_has_prefix (oid, shortened[0]));
+	g_strfreev (shortened);
+
+	prefix = g_strndup (hex, 10);
+	candidates = ggit_repository_find_oids_by_prefix (repo, prefix, &err);
+	g_assert_no_error (err);
+	g_assert_cmpuint (ggit_oid_array_get_size (candidates), ==, 2);
+	ggit_oid_array_unref (candidates);
+	g_free (prefix);
+
+	g_free (hex);
+	ggit_oid_free (oid);
+	g_object_unref (backend);
+	g_object_unref (odb);
+	g_object_unref (repo);
+}
+
+static GgitOId *
+new_test_oid (guint8 hash_byte,
+              guint  n)
+{
+	guint8 raw[GGIT_OID_RAWSZ];
+
+	/* the set hashes the first 8 bytes, the rest tells the ids apart */
+	memset (raw, hash_byte, sizeof (raw));
+	raw[8] = n & 0xff;
+	raw[9] = (n >> 8) & 0xff;
+
+	return ggit_oid_new_from_raw (raw);
+}
+
+static void
+test_repository_oid_set (const gchar *git_dir)
+{
+	GgitOIdSet *set;
+	GgitOId *chain[4];
+	GgitOId *oids[200];
+	GPtrArray *keys;
+	guint i;
+
+	set = ggit_oid_set_new (0);
+
+	/* the same hash for all of them, in the last slot so that the probe
+	 * sequence wraps around the end of the table
+	 */
+	for (i = 0; i < G_N_ELEMENTS (chain); ++i)
+	{
+		chain[i] = new_test_oid (0xff, i);
+		g_assert (ggit_oid_set_add (set, chain[i]));
+	}
+
+	g_assert (!ggit_oid_set_add (set, chain[0]));
+	g_assert_cmpuint (ggit_oid_set_get_size (set), ==, 4);
+
+	/* removing the head and then the middle of the chain shifts the
+	 * following entries back, they have to stay reachable
+	 */
+	g_assert (ggit_oid_set_remove (set, chain[0]));
+	g_assert (!ggit_oid_set_remove (set, chain[0]));
+	g_assert (!ggit_oid_set_contains (set, chain[0]));
+	g_assert (ggit_oid_set_contains (set, chain[1]));
+	g_assert (ggit_oid_set_contains (set, chain[2]));
+	g_assert (ggit_oid_set_contains (set, chain[3]));
+
+	g_assert (ggit_oid_set_remove (set, chain[2]));
+	g_assert (ggit_oid_set_contains (set, chain[1]));
+	g_assert (!ggit_oid_set_contains (set, chain[2]));
+	g_assert (ggit_oid_set_contains (set, chain[3]));
+	g_assert_cmpuint (ggit_oid_set_get_size (set), ==, 2);
+
+	g_assert (ggit_oid_set_add (set, chain[0]));
+	g_assert (ggit_oid_set_contains (set, chain[0]));
+
+	/* grow the table past its initial capacity */
+	for (i = 0; i < G_N_ELEMENTS (oids); ++i)
+	{
+		oids[i] = new_test_oid (i, i);
+	}
+
+	g_assert_cmpuint (ggit_oid_set_add_many (set, oids, G_N_ELEMENTS (oids)), ==, 200);
+	g_assert_cmpuint (ggit_oid_set_get_size (set), ==, 203);
+
+	for (i = 0; i < G_N_ELEMENTS (oids); i += 2)
+	{
+		g_assert (ggit_oid_set_remove (set, oids[i]));
+	}
+
+	for (i = 0; i < G_N_ELEMENTS (oids); ++i)
+	{
+		g_assert (ggit_oid_set_contains (set, oids[i]) == (i % 2 == 1));
+	}
+
+	g_assert (ggit_oid_set_contains (set, chain[0]));
+	g_assert (ggit_oid_set_contains (set, chain[1]));
+	g_assert (ggit_oid_set_contains (set, chain[3]));
+
+	keys = ggit_oid_set_get_oids (set);
+	g_assert_cmpuint (keys->len, ==, 103);
+	g_ptr_array_unref (keys);
+
+	ggit_oid_set_clear (set);
+	g_assert_cmpuint (ggit_oid_set_get_size (set), ==, 0);
+	g_assert (!ggit_oid_set_contains (set, chain[1]));
+
+	for (i = 0; i < G_N_ELEMENTS (chain); ++i)
+	{
+		ggit_oid_free (chain[i]);
+	}
+
+	for (i = 0; i < G_N_ELEMENTS (oids); ++i)
+	{
+		ggit_oid_free (oids[i]);
+	}
+
+	ggit_oid_set_unref (set);
+}
+
+static void
+test_repository_oid_map (const gchar *git_dir)
+{
+	GgitOIdMap *map;
+	GgitOId *a;
+	GgitOId *b;
+	GObject *first;
+	GObject *second;
+
+	map = ggit_oid_map_new_for_objects (0);
+
+	a = new_test_oid (0x11, 0);
+	b = new_test_oid (0x11, 1);
+
+	first = g_object_new (G_TYPE_OBJECT, NULL);
+	second = g_object_new (G_TYPE_OBJECT, NULL);
+
+	g_object_add_weak_pointer (first, (gpointer *)&first);
+
+	g_assert (ggit_oid_map_insert_object (map, a, first));
+	g_assert (ggit_oid_map_insert_object (map, b, second));
+	g_assert (ggit_oid_map_lookup_object (map, a) == first);
+	g_assert (ggit_oid_map_lookup_object (map, b) == second);
+
+	/* the map holds its own reference */
+	g_object_unref (first);
+	g_assert (first != NULL);
+
+	/* replacing a value releases the previous one */
+	g_assert (!ggit_oid_map_insert_object (map, a, second));
+	g_assert (first == NULL);
+	g_assert (ggit_oid_map_lookup_object (map, a) == second);
+
+	g_assert (ggit_oid_map_remove (map, a));
+	g_assert (ggit_oid_map_lookup_object (map, a) == NULL);
+	g_assert (ggit_oid_map_contains (map, b));
+	g_assert_cmpuint (ggit_oid_map_get_size (map), ==, 1);
+
+	ggit_oid_map_unref (map);
+	g_object_unref (second);
+
+	ggit_oid_free (a);
+	ggit_oid_free (b);
+}
+
+static void
+test_repository_oid_array (const gchar *git_dir)
+{
+	const gchar *hex =
+		"  f0e1d2c3b4a5968778695a4b3c2d1e0f00112233\n"
+		"0123456789ABCDEF0123456789abcdef01234567\t"
+		"0123456789abcdef0123456789abcdef01234500\n";
+	GgitOIdArray *array;
+	GgitOId *oid;
+	GArray *found;
+	GError *err = NULL;
+	const guint8 *raw;
+	gchar *str;
+	gsize size;
+
+	array = ggit_oid_array_new_from_hex (hex, -1, &err);
+	g_assert_no_error (err);
+	g_assert_cmpuint (ggit_oid_array_get_size (array), ==, 3);
+
+	raw = ggit_oid_array_get_raw (array, &size);
+	g_assert_cmpuint (size, ==, 3 * GGIT_OID_RAWSZ);
+	g_assert_cmpuint (raw[0], ==, 0xf0);
+	g_assert_cmpuint (raw[GGIT_OID_RAWSZ + 7], ==, 0xef);
+
+	/* upper case digits are parsed, and formatted in lower case */
+	str = ggit_oid_array_to_hex (array, ",");
+	g_assert_cmpstr (str, ==,
+	                 "f0e1d2c3b4a5968778695a4b3c2d1e0f00112233,"
+	                 "0123456789abcdef0123456789abcdef01234567,"
+	                 "0123456789abcdef0123456789abcdef01234500");
+	g_free (str);
+
+	/* an invalid id leaves the array unchanged, including an invalid
+	 * character in the high nibble of a byte
+	 */
+	g_assert (!ggit_oid_array_append_hex (array,
+	                                      "0123456789abcdef0123456789abcdef01234567 "
+	                                      "g123456789abcdef0123456789abcdef01234567",
+	                                      -1, &err));
+	g_assert_error (err, G_IO_ERROR, G_IO_ERROR_INVALID_DATA);
+	g_clear_error (&err);
+
+	g_assert (!ggit_oid_array_append_hex (array, "0123456789abcdef", -1, &err));
+	g_assert_error (err, G_IO_ERROR, G_IO_ERROR_INVALID_DATA);
+	g_clear_error (&err);
+
+	g_assert (!ggit_oid_array_append_hex (array,
+	                                      "0123456789abcdef0123456789abcdef012345670",
+	                                      -1, &err));
+	g_assert_error (err, G_IO_ERROR, G_IO_ERROR_INVALID_DATA);
+	g_clear_error (&err);
+
+	g_assert_cmpuint (ggit_oid_array_get_size (array), ==, 3);
+
+	/* the length limits what is parsed */
+	g_assert (ggit_oid_array_append_hex (array, hex, 42, &err));
+	g_assert_no_error (err);
+	g_assert_cmpuint (ggit_oid_array_get_size (array), ==, 4);
+
+	found = ggit_oid_array_find_prefix (array, "0123456789abcdef0123456789abcdef012345");
+	g_assert_cmpuint (found->len, ==, 2);
+	g_assert_cmpuint (g_array_index (found, gsize, 0), ==, 1);
+	g_assert_cmpuint (g_array_index (found, gsize, 1), ==, 2);
+	g_array_unref (found);
+
+	/* the same matches through the binary search, with an odd prefix */
+	ggit_oid_array_sort (array);
+
+	found = ggit_oid_array_find_prefix (array, "0123456789abcdef0123456789abcdef0123456");
+	g_assert_cmpuint (found->len, ==, 1);
+	g_assert_cmpuint (g_array_index (found, gsize, 0), ==, 1);
+	g_array_unref (found);
+
+	found = ggit_oid_array_find_prefix (array, "f0e");
+	g_assert_cmpuint (found->len, ==, 2);
+	g_assert_cmpuint (g_array_index (found, gsize, 0), ==, 2);
+	g_assert_cmpuint (g_array_index (found, gsize, 1), ==, 3);
+	g_array_unref (found);
+
+	found = ggit_oid_array_find_prefix (array, "f0x");
+	g_assert_cmpuint (found->len, ==, 0);
+	g_array_unref (found);
+
+	oid = ggit_oid_array_get (array, 0);
+	str = ggit_oid_to_string (oid);
+	g_assert_cmpstr (str, ==, "0123456789abcdef0123456789abcdef01234500");
+	g_assert (ggit_oid_has_prefix (oid, "0123456789ABCDEF"));
+	g_assert (ggit_oid_has_prefix (oid, "01234"));
+	g_assert (!ggit_oid_has_prefix (oid, "01235"));
+	g_assert (!ggit_oid_has_prefix (oid, "0123456789abcdef0123456789abcdef012345000"));
+	g_free (str);
+	ggit_oid_free (oid);
+
+	/* appending ids in order keeps the array searchable, appending an
+	 * id out of order must not
+	 */
+	g_assert (ggit_oid_array_append_hex (array,
+	                                     "ffffffffffffffffffffffffffffffffffffffff",
+	                                     -1, &err));
+	g_assert_no_error (err);
+
+	found = ggit_oid_array_find_prefix (array, "ff");
+	g_assert_cmpuint (found->len, ==, 1);
+	g_assert_cmpuint (g_array_index (found, gsize, 0), ==, 4);
+	g_array_unref (found);
+
+	g_assert (ggit_oid_array_append_hex (array,
+	                                     "0000000000000000000000000000000000000000",
+	                                     -1, &err));
+	g_assert_no_error (err);
+
+	found = ggit_oid_array_find_prefix (array, "00");
+	g_assert_cmpuint (found->len, ==, 1);
+	g_assert_cmpuint (g_array_index (found, gsize, 0), ==, 5);
+	g_array_unref (found);
+
+	ggit_oid_array_unref (array);
+}
+
+static void
+test_repository_read_many (const gchar *git_dir)
+{
+	GFile *f;
+	GgitRepository *repo;
+	GError *err = NULL;
+	GgitOId *oids[200];
+	GPtrArray *buffers;
+	GPtrArray *objects;
+	GArray *types;
+	guint i;
+
+	f = g_file_new_for_path (git_dir);
+	repo = ggit_repository_init_repository (f, FALSE, &err);
+	g_object_unref (f);
+
+	g_assert_no_error (err);
+
+	/* enough objects to be read on several threads */
+	for (i = 0; i < G_N_ELEMENTS (oids); ++i)
+	{
+		gchar *content;
+
+		content = g_strdup_printf ("%u\n", i);
+		oids[i] = ggit_repository_create_blob_from_buffer (repo, content, strlen (content), &err);
+		g_assert_no_error (err);
+		g_free (content);
+	}
+
+	buffers = ggit_repository_read_many (repo, oids, G_N_ELEMENTS (oids), 4, &types, &err);
+	g_assert_no_error (err);
+	g_assert_cmpuint (buffers->len, ==, G_N_ELEMENTS (oids));
+	g_assert_cmpuint (types->len, ==, G_N_ELEMENTS (oids));
+
+	for (i = 0; i < G_N_ELEMENTS (oids); ++i)
+	{
+		GBytes *bytes = g_ptr_array_index (buffers, i);
+		gchar *content;
+
+		content = g_strdup_printf ("%u\n", i);
+		g_assert_cmpuint (g_bytes_get_size (bytes), ==, strlen (content));
+		g_assert (memcmp (g_bytes_get_data (bytes, NULL), content, strlen (content)) == 0);
+		g_assert (g_array_index (types, GType, i) == GGIT_TYPE_BLOB);
+		g_free (content);
+	}
+
+	g_ptr_array_unref (buffers);
+	g_array_unref (types);
+
+	objects = ggit_repository_lookup_many (repo, oids, G_N_ELEMENTS (oids), GGIT_TYPE_BLOB, &err);
+	g_assert_no_error (err);
+	g_assert_cmpuint (objects->len, ==, G_N_ELEMENTS (oids));
+
+	for (i = 0; i < G_N_ELEMENTS (oids); ++i)
+	{
+		GgitOId *id;
+
+		id = ggit_object_get_id (g_ptr_array_index (objects, i));
+		g_assert (ggit_oid_equal (id, oids[i]));
+		ggit_oid_free (id);
+	}
+
+	g_ptr_array_unref (objects);
+
+	/* nothing is returned when one of the objects is missing */
+	ggit_oid_free (oids[100]);
+	oids[100] = ggit_oid_new_from_string ("0123456789012345678901234567890123456789");
+
+	buffers = ggit_repository_read_many (repo, oids, G_N_ELEMENTS (oids), 4, NULL, &err);
+	g_assert (buffers == NULL);
+	g_assert_error (err, GGIT_ERROR, GGIT_ERROR_NOTFOUND);
+	g_clear_error (&err);
+
+	for (i = 0; i < G_N_ELEMENTS (oids); ++i)
+	{
+		ggit_oid_free (oids[i]);
+	}
+
+	g_object_unref (repo);
+}
+
+static void
+stage_test_file (GgitRepository *repo,
+                 const gchar    *git_dir,
+                 const gchar    *path,
+                 const gchar    *content)
+{
+	GError *err = NULL;
+	GgitIndex *index;
+	gchar *filename;
+
+	filename = g_build_filename (git_dir, path, NULL);
+	g_file_set_contents (filename, content, -1, &err);
+	g_assert_no_error (err);
+	g_free (filename);
+
+	index = ggit_repository_get_index (repo, &err);
+	g_assert_no_error (err);
+
+	ggit_index_add_path (index, path, &err);
+	g_assert_no_error (err);
+
+	ggit_index_write (index, &err);
+	g_assert_no_error (err);
+
+	g_object_unref (index);
+}
+
+static GgitOId *
+commit_test_file (GgitRepository  *repo,
+                  const gchar     *git_dir,
+                  const gchar     *path,
+                  const gchar     *content,
+                  GgitOId        **parents,
+                  gint             n_parents)
+{
+	GError *err = NULL;
+	GgitIndex *index;
+	GgitSignature *author;
+	GgitOId *tree;
+	GgitOId *commit;
+
+	stage_test_file (repo, git_dir, path, content);
+
+	index = ggit_repository_get_index (repo, &err);
+	g_assert_no_error (err);
+
+	tree = ggit_index_write_tree (index, &err);
+	g_assert_no_error (err);
+
+	author = ggit_signature_new_now ("Test", "test@example.com", &err);
+	g_assert_no_error (err);
+
+	commit = ggit_repository_create_commit_from_ids (repo,
+	                                                 NULL,
+	                                                 author,
+	                                                 author,
+	                                                 NULL,
+	                                                 path,
+	                                                 tree,
+	                                                 parents,
+	                                                 n_parents,
+	                                                 &err);
+	g_assert_no_error (err);
+
+	g_object_unref (author);
+	ggit_oid_free (tree);
+	g_object_unref (index);
+
+	return commit;
+}
+
+static GgitRevisionWalker *
+new_test_walker (GgitRepository *repo,
+                 GgitOId        *head)
+{
+	GError *err = NULL;
+	GgitRevisionWalker *walker;
+
+	walker = ggit_revision_walker_new (repo, &err);
+	g_assert_no_error (err);
+
+	ggit_revision_walker_set_sort_mode (walker, GGIT_SORT_TOPOLOGICAL);
+	ggit_revision_walker_push (walker, head, &err);
+	g_assert_no_error (err);
+
+	return walker;
+}
+
+static void
+assert_raw_oid (const guint8 *raw,
+                GgitOId      *oid)
+{
+	GgitOId *other;
+
+	other = ggit_oid_new_from_raw (raw);
+	g_assert (ggit_oid_equal (other, oid));
+	ggit_oid_free (other);
+}
+
+static void
+test_repository_revision_walker_batch (const gchar *git_dir)
+{
+	GFile *f;
+	GgitRepository *repo;
+	GgitRevisionWalker *walker;
+	GError *err = NULL;
+	GgitOId *oids[3];
+	GBytes *bytes;
+	GArray *commits;
+	const guint8 *raw;
+	gsize size;
+
+	f = g_file_new_for_path (git_dir);
+	repo = ggit_repository_init_repository (f, FALSE, &err);
+	g_object_unref (f);
+
+	g_assert_no_error (err);
+
+	oids[0] = commit_test_file (repo, git_dir, "a.txt", "a\n", NULL, 0);
+	oids[1] = commit_test_file (repo, git_dir, "a.txt", "b\n", &oids[0], 1);
+	oids[2] = commit_test_file (repo, git_dir, "a.txt", "c\n", &oids[1], 1);
+
+	walker = new_test_walker (repo, oids[2]);
+
+	bytes = ggit_revision_walker_next_n (walker, 2, &err);
+	g_assert_no_error (err);
+
+	raw = g_bytes_get_data (bytes, &size);
+	g_assert_cmpuint (size, ==, 2 * GGIT_OID_RAWSZ);
+	assert_raw_oid (raw, oids[2]);
+	assert_raw_oid (raw + GGIT_OID_RAWSZ, oids[1]);
+	g_bytes_unref (bytes);
+
+	bytes = ggit_revision_walker_next_n (walker, 2, &err);
+	g_assert_no_error (err);
+
+	raw = g_bytes_get_data (bytes, &size);
+	g_assert_cmpuint (size, ==, GGIT_OID_RAWSZ);
+	assert_raw_oid (raw, oids[0]);
+	g_bytes_unref (bytes);
+
+	bytes = ggit_revision_walker_next_n (walker, 2, &err);
+	g_assert_no_error (err);
+	g_assert_cmpuint (g_bytes_get_size (bytes), ==, 0);
+	g_bytes_unref (bytes);
+	g_object_unref (walker);
+
+	walker = new_test_walker (repo, oids[2]);
+
+	commits = ggit_revision_walker_next_commits (walker, 10, &err);
+	g_assert_no_error (err);
+	g_assert_cmpuint (commits->len, ==, 3);
+
+	assert_raw_oid (g_array_index (commits, GgitRevisionWalkerCommit, 0).id, oids[2]);
+	g_assert_cmpuint (g_array_index (commits, GgitRevisionWalkerCommit, 0).parent_count, ==, 1);
+	assert_raw_oid (g_array_index (commits, GgitRevisionWalkerCommit, 2).id, oids[0]);
+	g_assert_cmpuint (g_array_index (commits, GgitRevisionWalkerCommit, 2).parent_count, ==, 0);
+
+	g_array_unref (commits);
+	g_object_unref (walker);
+
+	ggit_oid_free (oids[0]);
+	ggit_oid_free (oids[1]);
+	ggit_oid_free (oids[2]);
+	g_object_unref (repo);
+}
+
+static void
+test_repository_revision_walker_batch_error (const gchar *git_dir)
+{
+	GFile *f;
+	GgitRepository *repo;
+	GgitRevisionWalker *walker;
+	GError *err = NULL;
+	GgitOId *oids[3];
+	GBytes *bytes;
+	gchar *hex;
+	gchar *object;
+	gint n_walked = 0;
+
+	f = g_file_new_for_path (git_dir);
+	repo = ggit_repository_init_repository (f, FALSE, &err);
+	g_object_unref (f);
+
+	g_assert_no_error (err);
+
+	oids[0] = commit_test_file (repo, git_dir, "a.txt", "a\n", NULL, 0);
+	oids[1] = commit_test_file (repo, git_dir, "a.txt", "b\n", &oids[0], 1);
+	oids[2] = commit_test_file (repo, git_dir, "a.txt", "c\n", &oids[1], 1);
+
+	/* break the history by removing the root commit */
+	hex = ggit_oid_to_string (oids[0]);
+	object = g_strdup_printf ("%s/.git/objects/%.2s/%s", git_dir, hex, hex + 2);
+	g_assert_cmpint (g_unlink (object), ==, 0);
+
+	/* reopen so that nothing is answered from the object cache */
+	g_object_unref (repo);
+
+	f = g_file_new_for_path (git_dir);
+	repo = ggit_repository_open (f, &err);
+	g_object_unref (f);
+
+	g_assert_no_error (err);
+
+	walker = new_test_walker (repo, oids[2]);
+
+	/* the commits walked before the error are returned first */
+	bytes = ggit_revision_walker_next_n (walker, 10, &err);
+
+	if (bytes != NULL)
+	{
+		g_assert_no_error (err);
+
+		n_walked = g_bytes_get_size (bytes) / GGIT_OID_RAWSZ;
+		g_assert_cmpint (n_walked, >, 0);
+		assert_raw_oid (g_bytes_get_data (bytes, NULL), oids[2]);
+
+		g_bytes_unref (bytes);
+
+		bytes = ggit_revision_walker_next_n (walker, 10, &err);
+	}
+
+	g_assert (bytes == NULL);
+	g_assert (err != NULL);
+	g_clear_error (&err);
+
+	g_free (object);
+	g_free (hex);
+	g_object_unref (walker);
+
+	ggit_oid_free (oids[0]);
+	ggit_oid_free (oids[1]);
+	ggit_oid_free (oids[2]);
+	g_object_unref (repo);
+}
+
+static GgitTree *
+lookup_commit_tree (GgitRepository *repo,
+                    GgitOId        *oid)
+{
+	GError *err = NULL;
+	GgitCommit *commit;
+	GgitTree *tree;
+
+	commit = GGIT_COMMIT (ggit_repository_lookup (repo, oid, GGIT_TYPE_COMMIT, &err));
+	g_assert_no_error (err);
+
+	tree = ggit_commit_get_tree (commit);
+	g_object_unref (commit);
+
+	return tree;
+}
+
+static gint
+append_patch (GgitDiffDelta *delta,
+              GgitPatch     *patch,
+              gsize          index,
+              gpointer       user_data)
+{
+	GError *err = NULL;
+	gchar *text;
+
+	text = ggit_patch_to_string (patch, &err);
+	g_assert_no_error (err);
+
+	g_string_append_printf (user_data, "%u:%d:%s",
+	                        (guint)index,
+	                        ggit_diff_delta_get_status (delta),
+	                        text);
+	g_free (text);
+
+	return 0;
+}
+
+static void
+test_repository_diff_parallel (const gchar *git_dir)
+{
+	GFile *f;
+	GFile *removed;
+	GgitRepository *repo;
+	GgitIndex *index;
+	GgitDiff *diff;
+	GgitTree *trees[2];
+	GError *err = NULL;
+	GgitOId *oids[4];
+	GString *serial;
+	GString *parallel;
+	gchar *filename;
+	gsize n_deltas;
+	gsize i;
+	const gchar *moved = "one\ntwo\nthree\nfour\nfive\nsix\nseven\neight\n";
+
+	f = g_file_new_for_path (git_dir);
+	repo = ggit_repository_init_repository (f, FALSE, &err);
+	g_object_unref (f);
+
+	g_assert_no_error (err);
+
+	oids[0] = commit_test_file (repo, git_dir, "a.txt", "a\nb\n", NULL, 0);
+	oids[1] = commit_test_file (repo, git_dir, "b.txt", moved, &oids[0], 1);
+	oids[2] = commit_test_file (repo, git_dir, "a.txt", "a\nc\n", &oids[1], 1);
+
+	/* move b.txt to c.txt */
+	index = ggit_repository_get_index (repo, &err);
+	g_assert_no_error (err);
+
+	filename = g_build_filename (git_dir, "b.txt", NULL);
+	removed = g_file_new_for_path (filename);
+	g_free (filename);
+
+	ggit_index_remove (index, removed, 0, &err);
+	g_assert_no_error (err);
+	g_object_unref (removed);
+
+	ggit_index_write (index, &err);
+	g_assert_no_error (err);
+	g_object_unref (index);
+
+	oids[3] = commit_test_file (repo, git_dir, "c.txt", moved, &oids[2], 1);
+
+	trees[0] = lookup_commit_tree (repo, oids[1]);
+	trees[1] = lookup_commit_tree (repo, oids[3]);
+
+	diff = ggit_diff_new_tree_to_tree (repo, trees[0], trees[1], NULL, &err);
+	g_assert_no_error (err);
+
+	ggit_diff_find_similar (diff, NULL, &err);
+	g_assert_no_error (err);
+
+	/* the parallel patches must be the same as the ones of the diff */
+	serial = g_string_new (NULL);
+	n_deltas = ggit_diff_get_num_deltas (diff);
+
+	for (i = 0; i < n_deltas; ++i)
+	{
+		GgitPatch *patch;
+		GgitDiffDelta *delta;
+
+		patch = ggit_patch_new_from_diff (diff, i, &err);
+		g_assert_no_error (err);
+
+		delta = ggit_patch_get_delta (patch);
+		append_patch (delta, patch, i, serial);
+
+		ggit_diff_delta_unref (delta);
+		ggit_patch_unref (patch);
+	}
+
+	parallel = g_string_new (NULL);
+	ggit_diff_foreach_parallel (diff, 2, TRUE, append_patch, parallel, &err);
+	g_assert_no_error (err);
+
+	g_assert_cmpstr (parallel->str, ==, serial->str);
+
+	g_string_free (parallel, TRUE);
+	g_string_free (serial, TRUE);
+
+	g_object_unref (diff);
+	g_object_unref (trees[0]);
+	g_object_unref (trees[1]);
+
+	for (i = 0; i < G_N_ELEMENTS (oids); ++i)
+	{
+		ggit_oid_free (oids[i]);
+	}
+
+	g_object_unref (repo);
+}
+
+static GgitTree *
+create_test_tree (GgitRepository      *repo,
+                  const gchar         *git_dir,
+                  const gchar * const *paths)
+{
+	GError *err = NULL;
+	GgitIndex *index;
+	GgitOId *oid;
+	GgitTree *tree;
+
+	index = ggit_repository_get_index (repo, &err);
+	g_assert_no_error (err);
+
+	for (; *paths != NULL; ++paths)
+	{
+		write_test_file (git_dir, *paths);
+
+		ggit_index_add_path (index, *paths, &err);
+		g_assert_no_error (err);
+	}
+
+	ggit_index_write (index, &err);
+	g_assert_no_error (err);
+
+	oid = ggit_index_write_tree (index, &err);
+	g_assert_no_error (err);
+
+	tree = GGIT_TREE (ggit_repository_lookup (repo, oid, GGIT_TYPE_TREE, &err));
+	g_assert_no_error (err);
+
+	ggit_oid_free (oid);
+	g_object_unref (index);
+
+	return tree;
+}
+
+typedef struct
+{
+	GString *paths;
+	GPtrArray *kept;
+	const gchar *skip;
+} TreeWalkData;
+
+static gint
+record_tree_entry (const gchar   *root,
+                   GgitTreeEntry *entry,
+                   gpointer       user_data)
+{
+	TreeWalkData *data = user_data;
+	gboolean is_tree;
+
+	is_tree = ggit_tree_entry_get_object_type (entry) == GGIT_TYPE_TREE;
+
+	g_string_append_printf (data->paths, "%s%s%s|",
+	                        root,
+	                        ggit_tree_entry_get_name (entry),
+	                        is_tree ? "/" : "");
+
+	if (data->kept != NULL)
+	{
+		g_ptr_array_add (data->kept, ggit_tree_entry_ref (entry));
+	}
+
+	return is_tree && g_strcmp0 (data->skip, ggit_tree_entry_get_name (entry)) == 0;
+}
+
+static gchar *
+walk_test_tree (GgitTree         *tree,
+                GgitTreeWalkMode  mode,
+                const gchar      *pattern,
+                const gchar      *skip)
+{
+	const gchar *pathspec[] = { pattern, NULL };
+	GError *err = NULL;
+	TreeWalkData data = { NULL, };
+
+	data.paths = g_string_new (NULL);
+	data.skip = skip;
+
+	ggit_tree_walk_with_pathspec (tree, mode, pathspec, record_tree_entry, &data, &err);
+	g_assert_no_error (err);
+
+	return g_string_free (data.paths, FALSE);
+}
+
+static void
+test_repository_tree_walk_pathspec (const gchar *git_dir)
+{
+	const gchar *paths[] = {
+		"README", "doc/d.c", "src/a.c", "src/b.h", "src/sub/c.c", NULL
+	};
+	const gchar *pathspec[] = { "src/*.c", NULL };
+	const gchar *kept_names[] = { "src", "a.c", "sub", "c.c" };
+	GFile *f;
+	GgitRepository *repo;
+	GgitTree *tree;
+	GError *err = NULL;
+	TreeWalkData data = { NULL, };
+	gchar *walked;
+	guint i;
+
+	f = g_file_new_for_path (git_dir);
+	repo = ggit_repository_init_repository (f, FALSE, &err);
+	g_object_unref (f);
+
+	g_assert_no_error (err);
+
+	tree = create_test_tree (repo, git_dir, paths);
+
+	/* doc/ can not contain matches and is never read, src/sub/ can */
+	walked = walk_test_tree (tree, GGIT_TREE_WALK_MODE_PRE, "src/*.c", NULL);
+	g_assert_cmpstr (walked, ==, "src/|src/a.c|src/sub/|src/sub/c.c|");
+	g_free (walked);
+
+	walked = walk_test_tree (tree, GGIT_TREE_WALK_MODE_POST, "src/*.c", NULL);
+	g_assert_cmpstr (walked, ==, "src/a.c|src/sub/c.c|src/sub/|src/|");
+	g_free (walked);
+
+	/* a positive return skips the subtree */
+	walked = walk_test_tree (tree, GGIT_TREE_WALK_MODE_PRE, "src/*.c", "sub");
+	g_assert_cmpstr (walked, ==, "src/|src/a.c|src/sub/|");
+	g_free (walked);
+
+	walked = walk_test_tree (tree, GGIT_TREE_WALK_MODE_PRE, "*.h", NULL);
+	g_assert_cmpstr (walked, ==, "doc/|src/|src/b.h|src/sub/|");
+	g_free (walked);
+
+	/* entries kept by the callback stay valid after the walk */
+	data.paths = g_string_new (NULL);
+	data.kept = g_ptr_array_new_with_free_func ((GDestroyNotify)ggit_tree_entry_unref);
+
+	ggit_tree_walk_with_pathspec (tree, GGIT_TREE_WALK_MODE_PRE, pathspec,
+	                              record_tree_entry, &data, &err);
+	g_assert_no_error (err);
+
+	g_assert_cmpuint (data.kept->len, ==, G_N_ELEMENTS (kept_names));
+
+	for (i = 0; i < data.kept->len; ++i)
+	{
+		GgitTreeEntry *entry = g_ptr_array_index (data.kept, i);
+
+		g_assert_cmpstr (ggit_tree_entry_get_name (entry), ==, kept_names[i]);
+	}
+
+	g_ptr_array_unref (data.kept);
+	g_string_free (data.paths, TRUE);
+
+	g_object_unref (tree);
+	g_object_unref (repo);
+}
+
+typedef struct
+{
+	GString *changes;
+	gint stop_with;
+} ManifestDiffData;
+
+static gint
+record_manifest_change (const gchar *path,
+                        gssize       old_index,
+                        gssize       new_index,
+                        gpointer     user_data)
+{
+	ManifestDiffData *data = user_data;
+
+	g_string_append_printf (data->changes, "%s:%d:%d|",
+	                        path, (gint)old_index, (gint)new_index);
+
+	return data->stop_with;
+}
+
+static void
+test_repository_manifest (const gchar *git_dir)
+{
+	const gchar *paths[] = {
+		"README", "doc/d.c", "src/a.c", "src/b.h", "src/sub/c.c", NULL
+	};
+	const gchar *added[] = { "src/e.c", NULL };
+	GFile *f;
+	GFile *removed;
+	GgitRepository *repo;
+	GgitIndex *index;
+	GgitTree *trees[2];
+	GgitManifest *manifests[2];
+	GgitManifest *serial;
+	GgitTreeEntry *entry;
+	GgitOId *expected;
+	GgitOId *oid;
+	GError *err = NULL;
+	ManifestDiffData data = { NULL, 0 };
+	gchar *filename;
+	gsize i;
+
+	f = g_file_new_for_path (git_dir);
+	repo = ggit_repository_init_repository (f, FALSE, &err);
+	g_object_unref (f);
+
+	g_assert_no_error (err);
+
+	trees[0] = create_test_tree (repo, git_dir, paths);
+
+	/* modify src/a.c, remove doc/d.c and add src/e.c */
+	filename = g_build_filename (git_dir, "src", "a.c", NULL);
+	g_file_set_contents (filename, "changed\n", -1, &err);
+	g_assert_no_error (err);
+	g_free (filename);
+
+	index = ggit_repository_get_index (repo, &err);
+	g_assert_no_error (err);
+
+	ggit_index_add_path (index, "src/a.c", &err);
+	g_assert_no_error (err);
+
+	filename = g_build_filename (git_dir, "doc", "d.c", NULL);
+	removed = g_file_new_for_path (filename);
+	g_free (filename);
+
+	ggit_index_remove (index, removed, 0, &err);
+	g_assert_no_error (err);
+	g_object_unref (removed);
+	g_object_unref (index);
+
+	trees[1] = create_test_tree (repo, git_dir, added);
+
+	manifests[0] = ggit_tree_export_manifest (trees[0], 2, &err);
+	g_assert_no_error (err);
+
+	manifests[1] = ggit_tree_export_manifest (trees[1], 2, &err);
+	g_assert_no_error (err);
+
+	/* the files are sorted by path, with their ids and modes */
+	g_assert_cmpuint (ggit_manifest_get_size (manifests[0]), ==, 5);
+
+	for (i = 0; paths[i] != NULL; ++i)
+	{
+		g_assert_cmpstr (ggit_manifest_get_path (manifests[0], i), ==, paths[i]);
+		g_assert_cmpint (ggit_manifest_lookup (manifests[0], paths[i]), ==, i);
+		g_assert_cmpint (ggit_manifest_get_mode (manifests[0], i), ==, GGIT_FILE_MODE_BLOB);
+
+		entry = ggit_tree_get_by_path (trees[0], paths[i], &err);
+		g_assert_no_error (err);
+
+		expected = ggit_tree_entry_get_id (entry);
+		oid = ggit_manifest_get_id (manifests[0], i);
+		g_assert (ggit_oid_equal (oid, expected));
+
+		ggit_oid_free (oid);
+		ggit_oid_free (expected);
+		ggit_tree_entry_unref (entry);
+	}
+
+	g_assert_cmpint (ggit_manifest_lookup (manifests[0], "src"), ==, -1);
+	g_assert_cmpint (ggit_manifest_lookup (manifests[0], "src/e.c"), ==, -1);
+
+	/* reading the subtrees on one thread gives the same manifest */
+	serial = ggit_tree_export_manifest (trees[1], 1, &err);
+	g_assert_no_error (err);
+
+	data.changes = g_string_new (NULL);
+	g_assert_cmpint (ggit_manifest_diff (serial, manifests[1], record_manifest_change, &data), ==, 0);
+	g_assert_cmpstr (data.changes->str, ==, "");
+	ggit_manifest_unref (serial);
+
+	g_assert_cmpint (ggit_manifest_diff (manifests[0], manifests[1], record_manifest_change, &data), ==, 0);
+	g_assert_cmpstr (data.changes->str, ==, "doc/d.c:1:-1|src/a.c:2:1|src/e.c:-1:3|");
+
+	/* a non-zero return stops the comparison */
+	g_string_truncate (data.changes, 0);
+	data.stop_with = 7;
+
+	g_assert_cmpint (ggit_manifest_diff (manifests[0], manifests[1], record_manifest_change, &data), ==, 7);
+	g_assert_cmpstr (data.changes->str, ==, "doc/d.c:1:-1|");
+
+	g_string_free (data.changes, TRUE);
+
+	for (i = 0; i < 2; ++i)
+	{
+		ggit_manifest_unref (manifests[i]);
+		g_object_unref (trees[i]);
+	}
+
+	g_object_unref (repo);
+}
+
+static GgitOId *
+lookup_index_id (GgitIndex   *index,
+                 const gchar *git_dir,
+                 const gchar *path)
+{
+	GgitIndexEntries *entries;
+	GgitIndexEntry *entry;
+	GgitOId *oid = NULL;
+	GFile *file;
+	gchar *filename;
+
+	filename = g_build_filename (git_dir, path, NULL);
+	file = g_file_new_for_path (filename);
+	g_free (filename);
+
+	entries = ggit_index_get_entries (index);
+	entry = ggit_index_entries_get_by_path (entries, file, 0);
+
+	if (entry != NULL)
+	{
+		oid = ggit_index_entry_get_id (entry);
+		ggit_index_entry_unref (entry);
+	}
+
+	ggit_index_entries_unref (entries);
+	g_object_unref (file);
+
+	return oid;
+}
+
+static void
+count_added_path (const gchar *path,
+                  gsize        n_done,
+                  gsize        n_total,
+                  gpointer     user_data)
+{
+	gsize *n_calls = user_data;
+
+	g_assert_cmpuint (n_done, ==, ++*n_calls);
+	g_assert_cmpuint (n_total, ==, 2);
+}
+
+static void
+test_repository_index_add_paths (const gchar *git_dir)
+{
+	const gchar *paths[] = { "a.txt", "b.txt", NULL };
+	/* .git can not be put in the index, so the last insertion fails */
+	const gchar *invalid_paths[] = { "a.txt", "b.txt", ".git/HEAD", NULL };
+	GFile *f;
+	GgitRepository *repo;
+	GgitIndex *index;
+	GError *err = NULL;
+	GgitOId *old_id;
+	GgitOId *oid;
+	gchar *filename;
+	gsize n_calls = 0;
+
+	f = g_file_new_for_path (git_dir);
+	repo = ggit_repository_init_repository (f, FALSE, &err);
+	g_object_unref (f);
+
+	g_assert_no_error (err);
+
+	index = ggit_repository_get_index (repo, &err);
+	g_assert_no_error (err);
+
+	/* unsaved changes of the index must survive a failure */
+	write_test_file (git_dir, "a.txt");
+	write_test_file (git_dir, "c.txt");
+
+	ggit_index_add_path (index, "a.txt", &err);
+	g_assert_no_error (err);
+
+	ggit_index_add_path (index, "c.txt", &err);
+	g_assert_no_error (err);
+
+	old_id = lookup_index_id (index, git_dir, "a.txt");
+	g_assert (old_id != NULL);
+
+	filename = g_build_filename (git_dir, "a.txt", NULL);
+	g_file_set_contents (filename, "changed\n", -1, &err);
+	g_assert_no_error (err);
+	g_free (filename);
+
+	write_test_file (git_dir, "b.txt");
+
+	g_assert (!ggit_index_add_paths (index, invalid_paths, 2, NULL, NULL, NULL, &err));
+	g_assert (err != NULL);
+	g_clear_error (&err);
+
+	oid = lookup_index_id (index, git_dir, "a.txt");
+	g_assert (ggit_oid_equal (oid, old_id));
+	ggit_oid_free (oid);
+
+	g_assert (lookup_index_id (index, git_dir, "b.txt") == NULL);
+	g_assert (lookup_index_id (index, git_dir, ".git/HEAD") == NULL);
+
+	oid = lookup_index_id (index, git_dir, "c.txt");
+	g_assert (oid != NULL);
+	ggit_oid_free (oid);
+
+	g_assert (ggit_index_add_paths (index, paths, 2, count_added_path, &n_calls, NULL, &err));
+	g_assert_no_error (err);
+	g_assert_cmpuint (n_calls, ==, 2);
+
+	oid = lookup_index_id (index, git_dir, "a.txt");
+	g_assert (!ggit_oid_equal (oid, old_id));
+	ggit_oid_free (oid);
+
+	oid = lookup_index_id (index, git_dir, "b.txt");
+	g_assert (oid != NULL);
+	ggit_oid_free (oid);
+
+	ggit_oid_free (old_id);
+	g_object_unref (index);
+	g_object_unref (repo);
+}
+
+static void
+test_repository_index_snapshot (const gchar *git_dir)
+{
+	const gchar *paths[] = { "b.txt", "a/x.txt", "c", NULL };
+	const gchar *sorted[] = { "a/x.txt", "b.txt", "c", NULL };
+	GFile *f;
+	GgitRepository *repo;
+	GgitIndex *index;
+	GgitIndexEntries *entries;
+	GgitIndexSnapshot *snapshot;
+	GgitOIdArray *ids;
+	GError *err = NULL;
+	GBytes *bytes;
+	const guint32 *modes;
+	const guint64 *file_sizes;
+	const gint64 *mtimes;
+	const guint32 *flags;
+	gchar **snapshot_paths;
+	gsize size;
+	gsize i;
+
+	f = g_file_new_for_path (git_dir);
+	repo = ggit_repository_init_repository (f, FALSE, &err);
+	g_object_unref (f);
+
+	g_assert_no_error (err);
+
+	index = ggit_repository_get_index (repo, &err);
+	g_assert_no_error (err);
+
+	for (i = 0; paths[i] != NULL; ++i)
+	{
+		write_test_file (git_dir, paths[i]);
+
+		ggit_index_add_path (index, paths[i], &err);
+		g_assert_no_error (err);
+	}
+
+	snapshot = ggit_index_get_snapshot (index);
+	g_assert_cmpuint (ggit_index_snapshot_get_size (snapshot), ==, 3);
+
+	/* the columns are in index order */
+	snapshot_paths = ggit_index_snapshot_get_paths (snapshot);
+	g_assert_cmpuint (g_strv_length (snapshot_paths), ==, 3);
+
+	for (i = 0; sorted[i] != NULL; ++i)
+	{
+		g_assert_cmpstr (snapshot_paths[i], ==, sorted[i]);
+		g_assert_cmpstr (ggit_index_snapshot_get_path (snapshot, i), ==, sorted[i]);
+	}
+
+	g_strfreev (snapshot_paths);
+
+	bytes = ggit_index_snapshot_get_path_data (snapshot);
+	g_assert_cmpuint (g_bytes_get_size (bytes), ==, 16);
+	g_assert (memcmp (g_bytes_get_data (bytes, NULL), "a/x.txt\0b.txt\0c\0", 16) == 0);
+	g_bytes_unref (bytes);
+
+	ids = ggit_index_snapshot_get_ids (snapshot);
+	g_assert_cmpuint (ggit_oid_array_get_size (ids), ==, 3);
+
+	bytes = ggit_index_snapshot_get_id_data (snapshot);
+	g_assert_cmpuint (g_bytes_get_size (bytes), ==, 3 * GGIT_OID_RAWSZ);
+	g_assert (memcmp (g_bytes_get_data (bytes, NULL),
+	                  ggit_oid_array_get_raw (ids, &size),
+	                  3 * GGIT_OID_RAWSZ) == 0);
+	g_bytes_unref (bytes);
+
+	bytes = ggit_index_snapshot_get_modes (snapshot);
+	g_assert_cmpuint (g_bytes_get_size (bytes), ==, 3 * sizeof (guint32));
+	modes = g_bytes_get_data (bytes, NULL);
+
+	for (i = 0; i < 3; ++i)
+	{
+		g_assert_cmpuint (modes[i], ==, GGIT_FILE_MODE_BLOB);
+	}
+
+	g_bytes_unref (bytes);
+
+	/* the content of each file is its path */
+	bytes = ggit_index_snapshot_get_file_sizes (snapshot);
+	g_assert_cmpuint (g_bytes_get_size (bytes), ==, 3 * sizeof (guint64));
+	file_sizes = g_bytes_get_data (bytes, NULL);
+
+	for (i = 0; i < 3; ++i)
+	{
+		g_assert_cmpuint (file_sizes[i], ==, strlen (sorted[i]));
+	}
+
+	g_bytes_unref (bytes);
+
+	entries = ggit_index_get_entries (index);
+
+	bytes = ggit_index_snapshot_get_mtimes (snapshot);
+	g_assert_cmpuint (g_bytes_get_size (bytes), ==, 3 * sizeof (gint64));
+	mtimes = g_bytes_get_data (bytes, NULL);
+
+	for (i = 0; i < 3; ++i)
+	{
+		GStatBuf buf;
+		gchar *filename;
+
+		filename = g_build_filename (git_dir, sorted[i], NULL);
+		g_assert (g_stat (filename, &buf) == 0);
+		g_free (filename);
+
+		g_assert_cmpint (mtimes[i] / G_GINT64_CONSTANT (1000000000), ==, buf.st_mtime);
+	}
+
+	g_bytes_unref (bytes);
+
+	bytes = ggit_index_snapshot_get_flags (snapshot);
+	g_assert_cmpuint (g_bytes_get_size (bytes), ==, 3 * sizeof (guint32));
+	flags = g_bytes_get_data (bytes, NULL);
+
+	for (i = 0; i < 3; ++i)
+	{
+		GgitIndexEntry *entry;
+		GgitOId *oid;
+		GgitOId *expected;
+
+		entry = ggit_index_entries_get_by_index (entries, i);
+
+		g_assert_cmpuint (flags[i], ==,
+		                  ggit_index_entry_get_flags (entry) |
+		                  (ggit_index_entry_get_flags_extended (entry) << 16));
+
+		oid = ggit_oid_array_get (ids, i);
+		expected = ggit_index_entry_get_id (entry);
+		g_assert (ggit_oid_equal (oid, expected));
+
+		ggit_oid_free (oid);
+		ggit_oid_free (expected);
+		ggit_index_entry_unref (entry);
+	}
+
+	g_bytes_unref (bytes);
+
+	ggit_index_entries_unref (entries);
+	ggit_oid_array_unref (ids);
+	ggit_index_snapshot_unref (snapshot);
+	g_object_unref (index);
+	g_object_unref (repo);
+}
+
+static void
+record_monitor_change (GgitStatusMonitor *monitor,
+                       const gchar       *path,
+                       GgitStatusFlags    status_flags,
+                       GString           *changes)
+{
+	g_string_append_printf (changes, "%s:%u\n", path, status_flags);
+}
+
+static void
+test_repository_status_monitor (const gchar *git_dir)
+{
+	GFile *f;
+	GgitRepository *repo;
+	GgitIndex *index;
+	GgitStatusMonitor *monitor;
+	GgitSignature *author;
+	GError *err = NULL;
+	GString *statuses;
+	GString *changes;
+	GgitOId *tree;
+	GgitOId *commit;
+	gchar *expected;
+	gchar *filename;
+	gint64 deadline;
+
+	f = g_file_new_for_path (git_dir);
+	repo = ggit_repository_init_repository (f, FALSE, &err);
+	g_object_unref (f);
+
+	g_assert_no_error (err);
+
+	write_test_file (git_dir, "a.txt");
+	write_test_file (git_dir, "b.txt");
+
+	index = ggit_repository_get_index (repo, &err);
+	g_assert_no_error (err);
+
+	ggit_index_add_path (index, "a.txt", &err);
+	g_assert_no_error (err);
+
+	ggit_index_write (index, &err);
+	g_assert_no_error (err);
+
+	monitor = ggit_status_monitor_new (repo, NULL, &err);
+	g_assert_no_error (err);
+
+	/* the initial statuses are gathered on construction */
+	statuses = g_string_new (NULL);
+	ggit_status_monitor_foreach (monitor, append_status, statuses, &err);
+	g_assert_no_error (err);
+
+	expected = g_strdup_printf ("a.txt:%u\nb.txt:%u\n",
+	                            GGIT_STATUS_INDEX_NEW,
+	                            GGIT_STATUS_WORKING_TREE_NEW);
+	g_assert_cmpstr (statuses->str, ==, expected);
+	g_free (expected);
+	g_string_free (statuses, TRUE);
+
+	g_assert_cmpuint (ggit_status_monitor_get_status (monitor, "c.txt", &err), ==,
+	                  GGIT_STATUS_CURRENT);
+	g_assert_no_error (err);
+
+	changes = g_string_new (NULL);
+	g_signal_connect (monitor, "changed", G_CALLBACK (record_monitor_change), changes);
+
+	/* a modification is picked up once its file monitor event is
+	 * delivered and the monitor refreshes */
+	filename = g_build_filename (git_dir, "a.txt", NULL);
+	g_file_set_contents (filename, "modified a.txt", -1, &err);
+	g_assert_no_error (err);
+	g_free (filename);
+
+	deadline = g_get_monotonic_time () + 5 * G_TIME_SPAN_SECOND;
+
+	while (changes->len == 0 && g_get_monotonic_time () < deadline)
+	{
+		while (g_main_context_iteration (NULL, FALSE));
+
+		ggit_status_monitor_refresh (monitor, &err);
+		g_assert_no_error (err);
+
+		g_usleep (10000);
+	}
+
+	expected = g_strdup_printf ("a.txt:%u\n",
+	                            GGIT_STATUS_INDEX_NEW |
+	                            GGIT_STATUS_WORKING_TREE_MODIFIED);
+	g_assert_cmpstr (changes->str, ==, expected);
+	g_free (expected);
+
+	g_assert_cmpuint (ggit_status_monitor_get_status (monitor, "a.txt", &err), ==,
+	                  GGIT_STATUS_INDEX_NEW | GGIT_STATUS_WORKING_TREE_MODIFIED);
+	g_assert_no_error (err);
+
+	/* an unchanged tree emits nothing */
+	g_string_truncate (changes, 0);
+
+	ggit_status_monitor_refresh (monitor, &err);
+	g_assert_no_error (err);
+	g_assert_cmpstr (changes->str, ==, "");
+
+	/* invalidating forces a full rescan without waiting for events;
+	 * removed entries are reported as current */
+	filename = g_build_filename (git_dir, "b.txt", NULL);
+	g_assert (g_unlink (filename) == 0);
+	g_free (filename);
+
+	ggit_status_monitor_invalidate (monitor);
+
+	ggit_status_monitor_refresh (monitor, &err);
+	g_assert_no_error (err);
+
+	expected = g_strdup_printf ("b.txt:%u\n", GGIT_STATUS_CURRENT);
+	g_assert_cmpstr (changes->str, ==, expected);
+	g_free (expected);
+
+	g_assert_cmpuint (ggit_status_monitor_get_status (monitor, "b.txt", &err), ==,
+	                  GGIT_STATUS_CURRENT);
+	g_assert_no_error (err);
+
+	/* committing only moves the current branch, which the monitor
+	 * notices from the main loop without being asked to refresh */
+	g_string_truncate (changes, 0);
+
+	tree = ggit_index_write_tree (index, &err);
+	g_assert_no_error (err);
+
+	author = ggit_signature_new_now ("Test", "test@example.com", &err);
+	g_assert_no_error (err);
+
+	commit = ggit_repository_create_commit_from_ids (repo,
+	                                                 "HEAD",
+	                                                 author,
+	                                                 author,
+	                                                 NULL,
+	                                                 "commit",
+	                                                 tree,
+	                                                 NULL,
+	                                                 0,
+	                                                 &err);
+	g_assert_no_error (err);
+
+	deadline = g_get_monotonic_time () + 5 * G_TIME_SPAN_SECOND;
+
+	while (changes->len == 0 && g_get_monotonic_time () < deadline)
+	{
+		while (g_main_context_iteration (NULL, FALSE));
+
+		g_usleep (10000);
+	}
+
+	expected = g_strdup_printf ("a.txt:%u\n", GGIT_STATUS_WORKING_TREE_MODIFIED);
+	g_assert_cmpstr (changes->str, ==, expected);
+	g_free (expected);
+
+	ggit_oid_free (commit);
+	ggit_oid_free (tree);
+	g_object_unref (author);
+
+	g_signal_handlers_disconnect_by_func (monitor, record_monitor_change, changes);
+	g_string_free (changes, TRUE);
+
+	g_object_unref (monitor);
+	g_object_unref (index);
+	g_object_unref (repo);
+}
+
+static gchar *
+collect_parallel_status (GgitRepository *repo,
+                         gboolean        use_untracked_cache)
+{
+	GError *err = NULL;
+	GString *parallel;
+
+	parallel = g_string_new (NULL);
+	ggit_repository_file_status_foreach_parallel (repo, NULL, 2, use_untracked_cache,
+	                                              append_status, parallel,
+	                                              &err);
+	g_assert_no_error (err);
+
+	return g_string_free (parallel, FALSE);
+}
+
+static void
+add_cached_untracked_file (const gchar *git_dir,
+                           const gchar *directory,
+                           const gchar *path)
+{
+	GError *err = NULL;
+	GVariant *data;
+	GVariant *value;
+	GVariantIter *directories;
+	GVariantBuilder builder;
+	gchar *filename;
+	gchar *contents;
+	gsize length;
+	guint64 stamp;
+	const gchar *name;
+	gboolean found = FALSE;
+
+	filename = g_build_filename (git_dir, ".git", "ggit-untracked-cache", NULL);
+	g_file_get_contents (filename, &contents, &length, &err);
+	g_assert_no_error (err);
+
+	data = g_variant_new_from_data (G_VARIANT_TYPE ("(ta{s(a(st)a(su))})"),
+	                                contents,
+	                                length,
+	                                FALSE,
+	                                g_free,
+	                                contents);
+
+	g_variant_get (data, "(ta{s(a(st)a(su))})", &stamp, &directories);
+	g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{s(a(st)a(su))}"));
+
+	while (g_variant_iter_loop (directories, "{&s@(a(st)a(su))}", &name, &value))
+	{
+		GVariant *stamps;
+		GVariantIter *files;
+		GVariantBuilder entries;
+		const gchar *entry_path;
+		guint status;
+
+		if (strcmp (name, directory) != 0)
+		{
+			g_variant_builder_add (&builder, "{s@(a(st)a(su))}", name, value);
+			continue;
+		}
+
+		g_variant_get (value, "(@a(st)a(su))", &stamps, &files);
+		g_variant_builder_init (&entries, G_VARIANT_TYPE ("a(su)"));
+
+		while (g_variant_iter_loop (files, "(&su)", &entry_path, &status))
+		{
+			g_variant_builder_add (&entries, "(su)", entry_path, status);
+		}
+
+		g_variant_builder_add (&entries, "(su)", path, GGIT_STATUS_WORKING_TREE_NEW);
+		g_variant_builder_add (&builder, "{s(@a(st)a(su))}", name, stamps, &entries);
+
+		g_variant_unref (stamps);
+		g_variant_iter_free (files);
+		found = TRUE;
+	}
+
+	g_assert (found);
+
+	g_variant_iter_free (directories);
+	g_variant_unref (data);
+
+	data = g_variant_ref_sink (g_variant_new ("(ta{s(a(st)a(su))})", stamp, &builder));
+
+	g_file_set_contents (filename,
+	                     g_variant_get_data (data),
+	                     g_variant_get_size (data),
+	                     &err);
+	g_assert_no_error (err);
+
+	g_variant_unref (data);
+	g_free (filename);
+}
+
+static gchar *
+dump_status_list (GgitStatusList *list)
+{
+	GString *str;
+	gsize i;
+
+	str = g_string_new (NULL);
+
+	for (i = 0; i < ggit_status_list_get_size (list); ++i)
+	{
+		g_string_append_printf (str, "%s:%u\n",
+		                        ggit_status_list_get_path (list, i),
+		                        ggit_status_list_get_status (list, i));
+	}
+
+	return g_string_free (str, FALSE);
+}
+
+static void
+test_repository_status_list (const gchar *git_dir)
+{
+	GFile *f;
+	GgitRepository *repo;
+	GgitIndex *index;
+	GgitStatusOptions *options;
+	GgitStatusList *list;
+	GError *err = NULL;
+	gchar *filename;
+	gchar *dump;
+	gchar *expected;
+	const gchar *none[] = { NULL };
+	const gchar *paths[] = { "a.txt", "b.txt", "c.txt", "new/z.txt", NULL };
+
+	f = g_file_new_for_path (git_dir);
+	repo = ggit_repository_init_repository (f, FALSE, &err);
+	g_object_unref (f);
+
+	g_assert_no_error (err);
+
+	write_test_file (git_dir, "a.txt");
+	write_test_file (git_dir, "b.txt");
+	write_test_file (git_dir, "new/x.txt");
+	write_test_file (git_dir, "new/sub/y.txt");
+	write_test_file (git_dir, "tracked/b.txt");
+
+	index = ggit_repository_get_index (repo, &err);
+	g_assert_no_error (err);
+
+	ggit_index_add_path (index, "a.txt", &err);
+	g_assert_no_error (err);
+
+	ggit_index_add_path (index, "tracked/b.txt", &err);
+	g_assert_no_error (err);
+
+	ggit_index_write (index, &err);
+	g_assert_no_error (err);
+
+	/* untracked directories are listed as a whole */
+	options = ggit_status_options_new (GGIT_STATUS_OPTION_INCLUDE_UNTRACKED,
+	                                   GGIT_STATUS_SHOW_INDEX_AND_WORKDIR,
+	                                   NULL);
+
+	list = ggit_status_list_new (repo, options, &err);
+	g_assert_no_error (err);
+
+	dump = dump_status_list (list);
+	expected = g_strdup_printf ("a.txt:%u\nb.txt:%u\nnew/:%u\ntracked/b.txt:%u\n",
+	                            GGIT_STATUS_INDEX_NEW,
+	                            GGIT_STATUS_WORKING_TREE_NEW,
+	                            GGIT_STATUS_WORKING_TREE_NEW,
+	                            GGIT_STATUS_INDEX_NEW);
+	g_assert_cmpstr (dump, ==, expected);
+	g_free (expected);
+	g_free (dump);
+
+	g_assert_cmpint (ggit_status_list_lookup (list, "a.txt"), ==, 0);
+	g_assert_cmpint (ggit_status_list_lookup (list, "b.txt"), ==, 1);
+	g_assert_cmpint (ggit_status_list_lookup (list, "new/"), ==, 2);
+	g_assert_cmpint (ggit_status_list_lookup (list, "tracked/b.txt"), ==, 3);
+	g_assert_cmpint (ggit_status_list_lookup (list, "0.txt"), ==, -1);
+	g_assert_cmpint (ggit_status_list_lookup (list, "c.txt"), ==, -1);
+	g_assert_cmpint (ggit_status_list_lookup (list, "z.txt"), ==, -1);
+	g_assert_cmpint (ggit_status_list_lookup (list, "new/x.txt"), ==, -1);
+
+	/* files in a collapsed directory get its status */
+	g_assert_cmpuint (ggit_status_list_get_file_status (list, "new/x.txt"), ==,
+	                  GGIT_STATUS_WORKING_TREE_NEW);
+	g_assert_cmpuint (ggit_status_list_get_file_status (list, "new/sub/y.txt"), ==,
+	                  GGIT_STATUS_WORKING_TREE_NEW);
+	g_assert_cmpuint (ggit_status_list_get_file_status (list, "tracked/b.txt"), ==,
+	                  GGIT_STATUS_INDEX_NEW);
+	g_assert_cmpuint (ggit_status_list_get_file_status (list, "tracked/c.txt"), ==,
+	                  GGIT_STATUS_CURRENT);
+	g_assert_cmpuint (ggit_status_list_get_file_status (list, "c.txt"), ==,
+	                  GGIT_STATUS_CURRENT);
+
+	/* single flags are counted, combinations are scanned */
+	g_assert_cmpuint (ggit_status_list_get_count (list, GGIT_STATUS_INDEX_NEW), ==, 2);
+	g_assert_cmpuint (ggit_status_list_get_count (list, GGIT_STATUS_WORKING_TREE_NEW), ==, 2);
+	g_assert_cmpuint (ggit_status_list_get_count (list, GGIT_STATUS_WORKING_TREE_MODIFIED), ==, 0);
+	g_assert_cmpuint (ggit_status_list_get_count (list,
+	                                              GGIT_STATUS_INDEX_NEW |
+	                                              GGIT_STATUS_WORKING_TREE_NEW), ==, 4);
+	g_assert_cmpuint (ggit_status_list_get_count (list, GGIT_STATUS_CURRENT), ==, 0);
+
+	ggit_status_list_refresh (list, none, &err);
+	g_assert_no_error (err);
+	g_assert_cmpuint (ggit_status_list_get_size (list), ==, 4);
+
+	/* modify, remove and add files, and only refresh some of them */
+	filename = g_build_filename (git_dir, "a.txt", NULL);
+	g_file_set_contents (filename, "modified a.txt", -1, &err);
+	g_assert_no_error (err);
+	g_free (filename);
+
+	filename = g_build_filename (git_dir, "b.txt", NULL);
+	g_assert (g_unlink (filename) == 0);
+	g_free (filename);
+
+	write_test_file (git_dir, "c.txt");
+	write_test_file (git_dir, "new/z.txt");
+	write_test_file (git_dir, "other.txt");
+
+	ggit_status_list_refresh (list, paths, &err);
+	g_assert_no_error (err);
+
+	/* other.txt was not refreshed */
+	dump = dump_status_list (list);
+	expected = g_strdup_printf ("a.txt:%u\nc.txt:%u\nnew/:%u\ntracked/b.txt:%u\n",
+	                            GGIT_STATUS_INDEX_NEW | GGIT_STATUS_WORKING_TREE_MODIFIED,
+	                            GGIT_STATUS_WORKING_TREE_NEW,
+	                            GGIT_STATUS_WORKING_TREE_NEW,
+	                            GGIT_STATUS_INDEX_NEW);
+	g_assert_cmpstr (dump, ==, expected);
+	g_free (expected);
+	g_free (dump);
+
+	g_assert_cmpint (ggit_status_list_lookup (list, "b.txt"), ==, -1);
+	g_assert_cmpint (ggit_status_list_lookup (list, "c.txt"), ==, 1);
+	g_assert_cmpint (ggit_status_list_lookup (list, "other.txt"), ==, -1);
+
+	g_assert_cmpuint (ggit_status_list_get_count (list, GGIT_STATUS_INDEX_NEW), ==, 2);
+	g_assert_cmpuint (ggit_status_list_get_count (list, GGIT_STATUS_WORKING_TREE_NEW), ==, 2);
+	g_assert_cmpuint (ggit_status_list_get_count (list, GGIT_STATUS_WORKING_TREE_MODIFIED), ==, 1);
+	g_assert_cmpuint (ggit_status_list_get_count (list,
+	                                              GGIT_STATUS_WORKING_TREE_NEW |
+	                                              GGIT_STATUS_WORKING_TREE_MODIFIED), ==, 3);
+
+	/* refreshing a directory refreshes the files below it */
+	filename = g_build_filename (git_dir, "tracked", "b.txt", NULL);
+	g_assert (g_unlink (filename) == 0);
+	g_free (filename);
+
+	paths[0] = "tracked";
+	paths[1] = NULL;
+
+	ggit_status_list_refresh (list, paths, &err);
+	g_assert_no_error (err);
+
+	g_assert_cmpint (ggit_status_list_lookup (list, "tracked/b.txt"), ==, 3);
+	g_assert_cmpuint (ggit_status_list_get_status (list, 3), ==,
+	                  GGIT_STATUS_INDEX_NEW | GGIT_STATUS_WORKING_TREE_DELETED);
+	g_assert_cmpuint (ggit_status_list_get_count (list, GGIT_STATUS_INDEX_NEW), ==, 2);
+	g_assert_cmpuint (ggit_status_list_get_count (list, GGIT_STATUS_WORKING_TREE_DELETED), ==, 1);
+	g_assert_cmpuint (ggit_status_list_get_size (list), ==, 4);
+
+	g_object_unref (list);
+	ggit_status_options_free (options);
+	g_object_unref (index);
+	g_object_unref (repo);
+}
+
+static GgitOId *
+create_test_blob_tree (GgitRepository *repo,
+                       GgitOId        *blob)
+{
+	GError *err = NULL;
+	GgitTreeBuilder *builder;
+	GgitTreeEntry *entry;
+	GgitOId *tree;
+
+	builder = ggit_repository_create_tree_builder (repo, &err);
+	g_assert_no_error (err);
+
+	entry = ggit_tree_builder_insert (builder, "blob", blob, GGIT_FILE_MODE_BLOB, &err);
+	g_assert_no_error (err);
+	ggit_tree_entry_unref (entry);
+
+	tree = ggit_tree_builder_write (builder, &err);
+	g_assert_no_error (err);
+
+	g_object_unref (builder);
+
+	return tree;
+}
+
+/* returns whether the blob was read at once instead of streamed */
+static gboolean
+assert_blob_stream (GgitRepository *repo,
+                    GgitOId        *oid,
+                    const gchar    *content)
+{
+	GError *err = NULL;
+	GInputStream *stream;
+	GOutputStream *output;
+	GBytes *bytes;
+	goffset size = -1;
+	gboolean in_memory;
+
+	stream = ggit_repository_open_blob_stream (repo, oid, &size, &err);
+	g_assert_no_error (err);
+	g_assert (stream != NULL);
+
+	in_memory = G_IS_MEMORY_INPUT_STREAM (stream);
+
+	output = g_memory_output_stream_new_resizable ();
+	g_output_stream_splice (output,
+	                        stream,
+	                        G_OUTPUT_STREAM_SPLICE_CLOSE_SOURCE |
+	                        G_OUTPUT_STREAM_SPLICE_CLOSE_TARGET,
+	                        NULL,
+	                        &err);
+	g_assert_no_error (err);
+
+	bytes = g_memory_output_stream_steal_as_bytes (G_MEMORY_OUTPUT_STREAM (output));
+
+	/* the returned size is the streamed length */
+	g_assert_cmpint (size, ==, (goffset)strlen (content));
+	g_assert_cmpuint (g_bytes_get_size (bytes), ==, strlen (content));
+	g_assert (memcmp (g_bytes_get_data (bytes, NULL), content, strlen (content)) == 0);
+
+	g_bytes_unref (bytes);
+	g_object_unref (output);
+	g_object_unref (stream);
+
+	return in_memory;
+}
+
+static void
+assert_not_blob_stream (GgitRepository *repo,
+                        GgitOId        *oid)
+{
+	GError *err = NULL;
+	GInputStream *stream;
+
+	stream = ggit_repository_open_blob_stream (repo, oid, NULL, &err);
+	g_assert_error (err, GGIT_ERROR, GGIT_ERROR_NOTFOUND);
+	g_assert (stream == NULL);
+
+	g_error_free (err);
+}
+
+static void
+test_repository_open_blob_stream (const gchar *git_dir)
+{
+	GFile *f;
+	GgitRepository *repo;
+	GgitOdb *odb;
+	GgitMempack *mempack;
+	GError *err = NULL;
+	GString *base;
+	GString *changed;
+	GgitOId *loose;
+	GgitOId *loose_tree;
+	GgitOId *packed[2];
+	GgitOId *packed_tree;
+	const gchar *msg = "hello world\n";
+	gint n_in_memory;
+	gint i;
+
+	f = g_file_new_for_path (git_dir);
+	repo = ggit_repository_init_repository (f, FALSE, &err);
+	g_object_unref (f);
+
+	g_assert_no_error (err);
+
+	/* loose objects are streamed by libgit2 */
+	loose = ggit_repository_create_blob_from_buffer (repo, msg, strlen (msg), &err);
+	g_assert_no_error (err);
+
+	assert_blob_stream (repo, loose, msg);
+
+	loose_tree = create_test_blob_tree (repo, loose);
+	assert_not_blob_stream (repo, loose_tree);
+
+	/* two similar blobs, one of which is stored as a delta of the other */
+	base = g_string_new (NULL);
+
+	for (i = 0; i < 1000; ++i)
+	{
+		g_string_append_printf (base, "line %d\n", i);
+	}
+
+	changed = g_string_new (base->str);
+	g_string_append (changed, "one more line\n");
+
+	odb = ggit_repository_get_odb (repo, &err);
+	g_assert_no_error (err);
+
+	mempack = ggit_mempack_new (&err);
+	g_assert_no_error (err);
+
+	ggit_odb_add_backend (odb, GGIT_ODB_BACKEND (mempack), 1000, &err);
+	g_assert_no_error (err);
+
+	packed[0] = ggit_repository_create_blob_from_buffer (repo, base->str, base->len, &err);
+	g_assert_no_error (err);
+
+	packed[1] = ggit_repository_create_blob_from_buffer (repo, changed->str, changed->len, &err);
+	g_assert_no_error (err);
+
+	packed_tree = create_test_blob_tree (repo, packed[0]);
+
+	ggit_mempack_write_pack (mempack, repo, &err);
+	g_assert_no_error (err);
+
+	/* the whole blob is inflated from the pack file as it is read, the
+	 * deltified one is read at once */
+	n_in_memory = assert_blob_stream (repo, packed[0], base->str);
+	n_in_memory += assert_blob_stream (repo, packed[1], changed->str);
+	g_assert_cmpint (n_in_memory, ==, 1);
+
+	assert_not_blob_stream (repo, packed_tree);
+
+	ggit_oid_free (packed_tree);
+	ggit_oid_free (packed[1]);
+	ggit_oid_free (packed[0]);
+	ggit_oid_free (loose_tree);
+	ggit_oid_free (loose);
+	g_string_free (changed, TRUE);
+	g_string_free (base, TRUE);
+	g_object_unref (mempack);
+	g_object_unref (odb);
+	g_object_unref (repo);
+}
+
+static void
+assert_convert_utf8 (const gchar *str,
+                     gssize       size,
+                     const gchar *from_charset,
+                     const gchar *expected)
+{
+	gchar *ret;
+
+	ret = ggit_convert_utf8 (str, size, from_charset);
+	g_assert_cmpstr (ret, ==, expected);
+	g_assert (g_utf8_validate (ret, -1, NULL));
+	g_free (ret);
+}
+
+static void
+test_repository_convert_utf8 (const gchar *git_dir)
+{
+	const gchar *strs[] = { "plain ascii", "caf\xe9", "na\xefve text over eight bytes" };
+	gchar *results[G_N_ELEMENTS (strs)];
+	guint i;
+
+	/* ASCII is copied as is, whatever the charset, also past the
+	 * first eight bytes scanned at once */
+	assert_convert_utf8 ("hello", -1, NULL, "hello");
+	assert_convert_utf8 ("hello", -1, "UTF-8", "hello");
+	assert_convert_utf8 ("hello", -1, "ISO-8859-1", "hello");
+	assert_convert_utf8 ("hello world, in ascii", -1, "ISO-8859-1", "hello world, in ascii");
+	assert_convert_utf8 ("hello world", 5, "UTF-8", "hello");
+	assert_convert_utf8 ("", 0, "ISO-8859-1", "");
+
+	/* Latin-1, before and after a long ASCII prefix */
+	assert_convert_utf8 ("caf\xe9", -1, "ISO-8859-1", "caf\xc3\xa9");
+	assert_convert_utf8 ("\xe9t\xe9", -1, "ISO-8859-1", "\xc3\xa9t\xc3\xa9");
+	assert_convert_utf8 ("a long ascii prefix, then caf\xe9", -1, "ISO-8859-1",
+	                     "a long ascii prefix, then caf\xc3\xa9");
+	assert_convert_utf8 ("caf\xe9 au lait", 4, "latin1", "caf\xc3\xa9");
+
+	/* valid UTF-8 is kept, invalid bytes are replaced one by one */
+	assert_convert_utf8 ("caf\xc3\xa9", -1, NULL, "caf\xc3\xa9");
+	assert_convert_utf8 ("caf\xc3\xa9", -1, "UTF-8", "caf\xc3\xa9");
+	assert_convert_utf8 ("a\xff" "b", -1, "UTF-8", "a?b");
+	assert_convert_utf8 ("a\xff\xfe" "b", -1, "utf-8", "a??b");
+	assert_convert_utf8 ("a long ascii prefix, \xc3(", -1, "UTF-8", "a long ascii prefix, ?(");
+	assert_convert_utf8 ("truncated \xc3", -1, "UTF-8", "truncated ?");
+
+	/* the batch gives the same results */
+	ggit_convert_utf8_batch (strs, NULL, G_N_ELEMENTS (strs), "ISO-8859-1", results);
+
+	for (i = 0; i < G_N_ELEMENTS (strs); ++i)
+	{
+		gchar *expected;
+
+		expected = ggit_convert_utf8 (strs[i], -1, "ISO-8859-1");
+		g_assert_cmpstr (results[i], ==, expected);
+
+		g_free (expected);
+		g_free (results[i]);
+	}
+}
+
+#define TEST_TREE_HEX    "4b825dc642cb6eb9a060e54bf8d69288fbee4904"
+#define TEST_PARENT1_HEX "1111111111111111111111111111111111111111"
+#define TEST_PARENT2_HEX "2222222222222222222222222222222222222222"
+
+static GgitCommitInfo *
+new_test_commit_info (const gchar  *data,
+                      GError      **error)
+{
+	git_oid id;
+
+	g_assert (git_oid_fromstr (&id, "3333333333333333333333333333333333333333") == 0);
+
+	return _ggit_commit_info_new (&id, data, strlen (data), error);
+}
+
+static void
+assert_commit_info_parent (GgitCommitInfo *info,
+                           guint           idx,
+                           const gchar    *hex)
+{
+	git_oid expected;
+
+	g_assert (git_oid_fromstr (&expected, hex) == 0);
+	g_assert (git_oid_equal (_ggit_commit_info_get_parent_id (info, idx), &expected));
+}
+
+static void
+test_repository_commit_info (const gchar *git_dir)
+{
+	GError *err = NULL;
+	GgitCommitInfo *info;
+	git_oid tree;
+
+	/* the signatures and the subject are in the encoding of the commit */
+	const gchar *encoded =
+		"tree " TEST_TREE_HEX "\n"
+		"parent " TEST_PARENT1_HEX "\n"
+		"author Andr\xe9 <andre@example.com> 1500000000 +0200\n"
+		"committer Ren\xe9" "e <renee@example.com> 1500000100 -0130\n"
+		"encoding ISO-8859-1\n"
+		"\n"
+		"Caf\xe9 au lait\n"
+		"\n"
+		"The body.\n";
+
+	/* the continuation lines of the signature are not headers */
+	const gchar *signed_commit =
+		"tree " TEST_TREE_HEX "\n"
+		"parent " TEST_PARENT1_HEX "\n"
+		"parent " TEST_PARENT2_HEX "\n"
+		"author A U Thor <author@example.com> 1500000000 +0000\n"
+		"committer C O Mitter <committer@example.com> 1500000200 +0000\n"
+		"gpgsig -----BEGIN PGP SIGNATURE-----\n"
+		" \n"
+		" iQEzBAABCAAdFiEEpZ8U1OCvMdqsIpgD\n"
+		" parent " TEST_PARENT2_HEX "\n"
+		" encoding ISO-8859-1\n"
+		" -----END PGP SIGNATURE-----\n"
+		"\n"
+		"Signed subject\n";
+
+	const gchar *invalid =
+		"tree " TEST_TREE_HEX "\n"
+		"author A U Thor <author@example.com> 1500000000 +0000\n"
+		"\n"
+		"No committer\n";
+
+	g_assert (git_oid_fromstr (&tree, TEST_TREE_HEX) == 0);
+
+	info = new_test_commit_info (encoded, &err);
+	g_assert_no_error (err);
+
+	g_assert (git_oid_equal (_ggit_commit_info_get_tree_id (info), &tree));
+	g_assert_cmpuint (ggit_commit_info_get_n_parents (info), ==, 1);
+	assert_commit_info_parent (info, 0, TEST_PARENT1_HEX);
+
+	g_assert_cmpstr (ggit_commit_info_get_author_name (info), ==, "Andr\xc3\xa9");
+	g_assert_cmpstr (ggit_commit_info_get_author_email (info), ==, "andre@example.com");
+	g_assert_cmpint (ggit_commit_info_get_author_time (info), ==, 1500000000);
+	g_assert_cmpint (ggit_commit_info_get_author_utc_offset (info), ==, 120);
+
+	g_assert_cmpstr (ggit_commit_info_get_committer_name (info), ==, "Ren\xc3\xa9" "e");
+	g_assert_cmpstr (ggit_commit_info_get_committer_email (info), ==, "renee@example.com");
+	g_assert_cmpint (ggit_commit_info_get_committer_time (info), ==, 1500000100);
+	g_assert_cmpint (ggit_commit_info_get_committer_utc_offset (info), ==, -90);
+
+	g_assert_cmpstr (ggit_commit_info_get_subject (info), ==, "Caf\xc3\xa9 au lait");
+	g_assert_cmpstr (ggit_commit_info_get_message_encoding (info), ==, "ISO-8859-1");
+
+	ggit_commit_info_unref (info);
+
+	info = new_test_commit_info (signed_commit, &err);
+	g_assert_no_error (err);
+
+	g_assert (git_oid_equal (_ggit_commit_info_get_tree_id (info), &tree));
+	g_assert_cmpuint (ggit_commit_info_get_n_parents (info), ==, 2);
+	assert_commit_info_parent (info, 0, TEST_PARENT1_HEX);
+	assert_commit_info_parent (info, 1, TEST_PARENT2_HEX);
+
+	g_assert_cmpstr (ggit_commit_info_get_author_name (info), ==, "A U Thor");
+	g_assert_cmpstr (ggit_commit_info_get_committer_name (info), ==, "C O Mitter");
+	g_assert_cmpint (ggit_commit_info_get_committer_time (info), ==, 1500000200);
+
+	g_assert_cmpstr (ggit_commit_info_get_subject (info), ==, "Signed subject");
+	g_assert_cmpstr (ggit_commit_info_get_message_encoding (info), ==, "UTF-8");
+
+	ggit_commit_info_unref (info);
+
+	info = new_test_commit_info (invalid, &err);
+	g_assert_error (err, GGIT_ERROR, GGIT_ERROR_GIT_ERROR);
+	g_assert (info == NULL);
+
+	g_clear_error (&err);
+}
+
+static void
+assert_commit_info (GgitCommitInfo *info,
+                    GgitOId        *oid,
+                    gsize           deletions)
+{
+	GgitOId *id;
+	gsize files_changed;
+	gsize insertions;
+	gsize n_deletions;
+
+	id = ggit_commit_info_get_id (info);
+	g_assert (ggit_oid_equal (id, oid));
+	ggit_oid_free (id);
+
+	/* each commit replaces the only line of a.txt */
+	g_assert (ggit_commit_info_get_diff_stats (info, &files_changed, &insertions, &n_deletions));
+	g_assert_cmpuint (files_changed, ==, 1);
+	g_assert_cmpuint (insertions, ==, 1);
+	g_assert_cmpuint (n_deletions, ==, deletions);
+}
+
+static void
+test_repository_log_pipeline (const gchar *git_dir)
+{
+	GFile *f;
+	GgitRepository *repo;
+	GgitRevisionWalker *walker;
+	GgitLogPipeline *pipeline;
+	GError *err = NULL;
+	GgitOId *oids[5];
+	GPtrArray *batch;
+	gint n_walked = 0;
+	gint i;
+
+	f = g_file_new_for_path (git_dir);
+	repo = ggit_repository_init_repository (f, FALSE, &err);
+	g_object_unref (f);
+
+	g_assert_no_error (err);
+
+	for (i = 0; i < (gint)G_N_ELEMENTS (oids); ++i)
+	{
+		gchar *content = g_strdup_printf ("%d\n", i);
+
+		oids[i] = commit_test_file (repo, git_dir, "a.txt", content,
+		                            i > 0 ? &oids[i - 1] : NULL, i > 0 ? 1 : 0);
+		g_free (content);
+	}
+
+	walker = new_test_walker (repo, oids[G_N_ELEMENTS (oids) - 1]);
+	pipeline = ggit_log_pipeline_new (walker, 2, TRUE);
+	g_object_unref (walker);
+
+	g_assert (ggit_log_pipeline_get_walker (pipeline) == walker);
+
+	/* the batches are in walk order, whatever the worker finishing first */
+	while (TRUE)
+	{
+		batch = ggit_log_pipeline_next (pipeline, 2, &err);
+		g_assert_no_error (err);
+
+		if (batch->len == 0)
+		{
+			g_ptr_array_unref (batch);
+			break;
+		}
+
+		g_assert_cmpuint (batch->len, <=, 2);
+
+		for (i = 0; i < (gint)batch->len; ++i, ++n_walked)
+		{
+			gint idx = G_N_ELEMENTS (oids) - 1 - n_walked;
+
+			assert_commit_info (g_ptr_array_index (batch, i), oids[idx], idx > 0 ? 1 : 0);
+		}
+
+		g_ptr_array_unref (batch);
+	}
+
+	g_assert_cmpint (n_walked, ==, G_N_ELEMENTS (oids));
+
+	/* the walk stays over */
+	batch = ggit_log_pipeline_next (pipeline, 2, &err);
+	g_assert_no_error (err);
+	g_assert_cmpuint (batch->len, ==, 0);
+	g_ptr_array_unref (batch);
+
+	g_object_unref (pipeline);
+
+	for (i = 0; i < (gint)G_N_ELEMENTS (oids); ++i)
+	{
+		ggit_oid_free (oids[i]);
+	}
+
+	g_object_unref (repo);
+}
+
+static void
+test_repository_log_pipeline_error (const gchar *git_dir)
+{
+	GFile *f;
+	GgitRepository *repo;
+	GgitRevisionWalker *walker;
+	GgitLogPipeline *pipeline;
+	GgitTree *tree;
+	GError *err = NULL;
+	GgitOId *oids[4];
+	GgitOId *tree_id;
+	GPtrArray *batch;
+	gchar *hex;
+	gchar *object;
+	gint i;
+
+	f = g_file_new_for_path (git_dir);
+	repo = ggit_repository_init_repository (f, FALSE, &err);
+	g_object_unref (f);
+
+	g_assert_no_error (err);
+
+	for (i = 0; i < (gint)G_N_ELEMENTS (oids); ++i)
+	{
+		gchar *content = g_strdup_printf ("%d\n", i);
+
+		oids[i] = commit_test_file (repo, git_dir, "a.txt", content,
+		                            i > 0 ? &oids[i - 1] : NULL, i > 0 ? 1 : 0);
+		g_free (content);
+	}
+
+	/* the walk does not need the trees, but the diff stats of the
+	 * commits of this tree and of its child do */
+	tree = lookup_commit_tree (repo, oids[1]);
+	tree_id = ggit_object_get_id (GGIT_OBJECT (tree));
+	g_object_unref (tree);
+
+	hex = ggit_oid_to_string (tree_id);
+	object = g_strdup_printf ("%s/.git/objects/%.2s/%s", git_dir, hex, hex + 2);
+	g_assert_cmpint (g_unlink (object), ==, 0);
+
+	/* reopen so that nothing is answered from the object cache */
+	g_object_unref (repo);
+
+	f = g_file_new_for_path (git_dir);
+	repo = ggit_repository_open (f, &err);
+	g_object_unref (f);
+
+	g_assert_no_error (err);
+
+	walker = new_test_walker (repo, oids[3]);
+	pipeline = ggit_log_pipeline_new (walker, 2, TRUE);
+	g_object_unref (walker);
+
+	/* the commit before the error is returned first */
+	batch = ggit_log_pipeline_next (pipeline, 10, &err);
+	g_assert_no_error (err);
+	g_assert_cmpuint (batch->len, ==, 1);
+	assert_commit_info (g_ptr_array_index (batch, 0), oids[3], 1);
+	g_ptr_array_unref (batch);
+
+	/* then the errors of the two commits that need the tree */
+	for (i = 0; i < 2; ++i)
+	{
+		batch = ggit_log_pipeline_next (pipeline, 10, &err);
+		g_assert (batch == NULL);
+		g_assert (err != NULL);
+		g_clear_error (&err);
+	}
+
+	/* and the walk goes on */
+	batch = ggit_log_pipeline_next (pipeline, 10, &err);
+	g_assert_no_error (err);
+	g_assert_cmpuint (batch->len, ==, 1);
+	assert_commit_info (g_ptr_array_index (batch, 0), oids[0], 0);
+	g_ptr_array_unref (batch);
+
+	batch = ggit_log_pipeline_next (pipeline, 10, &err);
+	g_assert_no_error (err);
+	g_assert_cmpuint (batch->len, ==, 0);
+	g_ptr_array_unref (batch);
+
+	g_object_unref (pipeline);
+
+	g_free (object);
+	g_free (hex);
+	ggit_oid_free (tree_id);
+
+	for (i = 0; i < (gint)G_N_ELEMENTS (oids); ++i)
+	{
+		ggit_oid_free (oids[i]);
+	}
+
+	g_object_unref (repo);
+}
+
+static GgitOId *
+create_test_merge (GgitRepository *repo,
+                   GgitOId        *tree,
+                   GgitOId       **parents)
+{
+	GError *err = NULL;
+	GgitSignature *author;
+	GgitOId *commit;
+
+	author = ggit_signature_new_now ("Test", "test@example.com", &err);
+	g_assert_no_error (err);
+
+	commit = ggit_repository_create_commit_from_ids (repo,
+	                                                 NULL,
+	                                                 author,
+	                                                 author,
+	                                                 NULL,
+	                                                 "merge",
+	                                                 tree,
+	                                                 parents,
+	                                                 2,
+	                                                 &err);
+	g_assert_no_error (err);
+
+	g_object_unref (author);
+
+	return commit;
+}
+
+/* the commits are only in walk order with topological sorting, as the
+ * test commits may all have the same time */
+static void
+assert_path_walk (GgitRepository *repo,
+                  GgitOId        *head,
+                  GgitSortMode    sort_mode,
+                  const gchar    *path,
+                  GgitOId       **expected,
+                  guint           n_expected)
+{
+	GError *err = NULL;
+	GgitRevisionWalker *walker;
+	GPtrArray *walked;
+	GgitOId *oid;
+	const gchar *paths[] = { path, NULL };
+	guint i;
+	guint j;
+
+	walker = ggit_revision_walker_new (repo, &err);
+	g_assert_no_error (err);
+
+	ggit_revision_walker_set_sort_mode (walker, sort_mode);
+	ggit_revision_walker_set_paths (walker, paths);
+
+	ggit_revision_walker_push (walker, head, &err);
+	g_assert_no_error (err);
+
+	walked = g_ptr_array_new_with_free_func ((GDestroyNotify)ggit_oid_free);
+
+	while ((oid = ggit_revision_walker_next (walker, &err)) != NULL)
+	{
+		g_ptr_array_add (walked, oid);
+	}
+
+	g_assert_no_error (err);
+	g_assert_cmpuint (walked->len, ==, n_expected);
+
+	for (i = 0; i < n_expected; ++i)
+	{
+		for (j = 0; j < walked->len; ++j)
+		{
+			if (ggit_oid_equal (g_ptr_array_index (walked, j), expected[i]))
+			{
+				break;
+			}
+		}
+
+		g_assert_cmpuint (j, <, walked->len);
+
+		if (sort_mode & GGIT_SORT_TOPOLOGICAL)
+		{
+			g_assert_cmpuint (j, ==, i);
+		}
+	}
+
+	g_ptr_array_unref (walked);
+	g_object_unref (walker);
+}
+
+static void
+test_repository_revision_walker_paths (const gchar *git_dir)
+{
+	GFile *f;
+	GgitRepository *repo;
+	GgitIndex *index;
+	GgitTree *tree;
+	GError *err = NULL;
+	GgitOId *root;
+	GgitOId *side;
+	GgitOId *trunk;
+	GgitOId *parents[2];
+	GgitOId *ours_tree;
+	GgitOId *theirs_tree;
+	GgitOId *ours;
+	GgitOId *theirs;
+	GgitOId *expected[4];
+
+	f = g_file_new_for_path (git_dir);
+	repo = ggit_repository_init_repository (f, FALSE, &err);
+	g_object_unref (f);
+
+	g_assert_no_error (err);
+
+	/* root: a.txt and b.txt; side: changes a.txt; trunk: changes b.txt */
+	stage_test_file (repo, git_dir, "b.txt", "0\n");
+	root = commit_test_file (repo, git_dir, "a.txt", "0\n", NULL, 0);
+	side = commit_test_file (repo, git_dir, "a.txt", "side\n", &root, 1);
+
+	stage_test_file (repo, git_dir, "a.txt", "0\n");
+	trunk = commit_test_file (repo, git_dir, "b.txt", "1\n", &root, 1);
+
+	parents[0] = trunk;
+	parents[1] = side;
+
+	/* a merge that keeps trunk, and one that takes a.txt from side */
+	tree = lookup_commit_tree (repo, trunk);
+	ours_tree = ggit_object_get_id (GGIT_OBJECT (tree));
+	g_object_unref (tree);
+
+	ours = create_test_merge (repo, ours_tree, parents);
+
+	stage_test_file (repo, git_dir, "a.txt", "side\n");
+
+	index = ggit_repository_get_index (repo, &err);
+	g_assert_no_error (err);
+
+	theirs_tree = ggit_index_write_tree (index, &err);
+	g_assert_no_error (err);
+
+	theirs = create_test_merge (repo, theirs_tree, parents);
+
+	/* the merge is TREESAME to trunk, so only trunk is followed and the
+	 * change of side is pruned */
+	expected[0] = root;
+	assert_path_walk (repo, ours, GGIT_SORT_TOPOLOGICAL, "a.txt", expected, 1);
+
+	expected[0] = trunk;
+	expected[1] = root;
+	assert_path_walk (repo, ours, GGIT_SORT_TOPOLOGICAL, "b.txt", expected, 2);
+
+	/* without topological sorting, commits are only filtered */
+	expected[0] = side;
+	expected[1] = root;
+	assert_path_walk (repo, ours, GGIT_SORT_TIME, "a.txt", expected, 2);
+
+	/* the merge is TREESAME to side along a.txt and to trunk along b.txt */
+	expected[0] = side;
+	expected[1] = root;
+	assert_path_walk (repo, theirs, GGIT_SORT_TOPOLOGICAL, "a.txt", expected, 2);
+
+	expected[0] = trunk;
+	expected[1] = root;
+	assert_path_walk (repo, theirs, GGIT_SORT_TOPOLOGICAL, "b.txt", expected, 2);
+
+	/* along the whole tree, the merge differs from both parents */
+	expected[0] = theirs;
+	expected[1] = trunk;
+	expected[2] = side;
+	expected[3] = root;
+	assert_path_walk (repo, theirs, GGIT_SORT_TIME, ".", expected, 4);
+
+	ggit_oid_free (theirs);
+	ggit_oid_free (theirs_tree);
+	ggit_oid_free (ours);
+	ggit_oid_free (ours_tree);
+	ggit_oid_free (trunk);
+	ggit_oid_free (side);
+	ggit_oid_free (root);
+	g_object_unref (index);
+	g_object_unref (repo);
+}
+
+static void
+on_async_ready (GObject      *source,
+                GAsyncResult *result,
+                gpointer      user_data)
+{
+	GAsyncResult **ret = user_data;
+
+	*ret = g_object_ref (result);
+}
+
+static GAsyncResult *
+wait_async_result (GAsyncResult **result)
+{
+	while (*result == NULL)
+	{
+		g_main_context_iteration (NULL, TRUE);
+	}
+
+	return *result;
+}
+
+static void
+assert_test_file (const gchar *git_dir,
+                  const gchar *path,
+                  const gchar *content)
+{
+	GError *err = NULL;
+	gchar *filename;
+	gchar *contents;
+
+	filename = g_build_filename (git_dir, path, NULL);
+	g_file_get_contents (filename, &contents, NULL, &err);
+	g_assert_no_error (err);
+
+	g_assert_cmpstr (contents, ==, content);
+
+	g_free (contents);
+	g_free (filename);
+}
+
+static void
+set_test_head (GgitRepository *repo,
+               GgitOId        *commit)
+{
+	GError *err = NULL;
+	GgitRef *ref;
+
+	ref = ggit_repository_create_reference (repo, "refs/heads/master", commit, "test", &err);
+	g_assert_no_error (err);
+
+	g_object_unref (ref);
+}
+
+static void
+test_repository_clone_async (const gchar *git_dir)
+{
+	GError *err = NULL;
+	GgitRepository *repo;
+	GgitRepository *cloned;
+	GAsyncResult *result = NULL;
+	GgitOId *commit;
+	GFile *f;
+	gchar *source;
+	gchar *target;
+
+	source = g_build_filename (git_dir, "source", NULL);
+	target = g_build_filename (git_dir, "clone", NULL);
+
+	f = g_file_new_for_path (source);
+	repo = ggit_repository_init_repository (f, FALSE, &err);
+	g_assert_no_error (err);
+	g_object_unref (f);
+
+	commit = commit_test_file (repo, source, "a", "one\n", NULL, 0);
+	set_test_head (repo, commit);
+
+	f = g_file_new_for_path (target);
+	ggit_repository_clone_async (source, f, NULL, NULL, on_async_ready, &result);
+
+	cloned = ggit_repository_clone_finish (wait_async_result (&result), &err);
+	g_assert_no_error (err);
+
+	assert_test_file (target, "a", "one\n");
+
+	g_object_unref (result);
+	g_object_unref (cloned);
+	g_object_unref (f);
+	ggit_oid_free (commit);
+	g_object_unref (repo);
+	g_free (target);
+	g_free (source);
+}
+
+/* Commits a, b and c with @content, one at a time, and returns the last
+ * commit.
+ */
+static GgitOId *
+commit_test_files (GgitRepository *repo,
+                   const gchar    *git_dir,
+                   const gchar    *content,
+                   GgitOId        *parent)
+{
+	const gchar *paths[] = { "a", "b", "c" };
+	GgitOId *commit = parent != NULL ? ggit_oid_copy (parent) : NULL;
+	guint i;
+
+	for (i = 0; i < G_N_ELEMENTS (paths); ++i)
+	{
+		GgitOId *next;
+
+		next = commit_test_file (repo,
+		                         git_dir,
+		                         paths[i],
+		                         content,
+		                         commit != NULL ? &commit : NULL,
+		                         commit != NULL ? 1 : 0);
+
+		if (commit != NULL)
+		{
+			ggit_oid_free (commit);
+		}
+
+		commit = next;
+	}
+
+	return commit;
+}
+
+static void
+test_repository_checkout_async (const gchar *git_dir)
+{
+	GError *err = NULL;
+	GgitRepository *repo;
+	GgitCheckoutOptions *options;
+	GgitTree *tree;
+	GgitObject *object;
+	GAsyncResult *result = NULL;
+	GgitOId *one;
+	GgitOId *two;
+	GFile *f;
+
+	f = g_file_new_for_path (git_dir);
+	repo = ggit_repository_init_repository (f, FALSE, &err);
+	g_assert_no_error (err);
+
+	one = commit_test_files (repo, git_dir, "one\n", NULL);
+	two = commit_test_files (repo, git_dir, "two\n", one);
+	set_test_head (repo, two);
+
+	tree = lookup_commit_tree (repo, one);
+
+	options = ggit_checkout_options_new ();
+	ggit_checkout_options_set_strategy (options, GGIT_CHECKOUT_SAFE);
+
+	ggit_repository_checkout_tree_async (repo,
+	                                     GGIT_OBJECT (tree),
+	                                     options,
+	                                     NULL,
+	                                     on_async_ready,
+	                                     &result);
+
+	/* the checkout runs on its own handle, so the repository stays
+	 * usable in the meantime */
+	object = ggit_repository_lookup (repo, two, GGIT_TYPE_COMMIT, &err);
+	g_assert_no_error (err);
+	g_object_unref (object);
+
+	ggit_repository_checkout_tree_finish (repo, wait_async_result (&result), &err);
+	g_assert_no_error (err);
+
+	assert_test_file (git_dir, "a", "one\n");
+	assert_test_file (git_dir, "b", "one\n");
+	assert_test_file (git_dir, "c", "one\n");
+
+	g_object_unref (result);
+	g_object_unref (options);
+	g_object_unref (tree);
+	ggit_oid_free (one);
+	ggit_oid_free (two);
+	g_object_unref (repo);
+	g_object_unref (f);
+}
+
+static void
+test_repository_merge_async (const gchar *git_dir)
+{
+	GError *err = NULL;
+	GgitRepository *repo;
+	GgitCheckoutOptions *options;
+	GgitAnnotatedCommit *head;
+	GgitTreeBuilder *builder;
+	GgitTreeEntry *entry;
+	GgitSignature *author;
+	GgitTree *base_tree;
+	GgitObject *object;
+	GgitRef *topic;
+	GAsyncResult *result = NULL;
+	GgitOId *base;
+	GgitOId *blob_id;
+	GgitOId *tree;
+	GgitOId *commit;
+	GFile *f;
+	gchar *filename;
+	gchar *merge_head;
+	gchar *hex;
+
+	f = g_file_new_for_path (git_dir);
+	repo = ggit_repository_init_repository (f, FALSE, &err);
+	g_assert_no_error (err);
+
+	base = commit_test_file (repo, git_dir, "a", "one\n", NULL, 0);
+	set_test_head (repo, base);
+
+	/* topic adds b without touching the working tree */
+	base_tree = lookup_commit_tree (repo, base);
+	builder = ggit_repository_create_tree_builder_from_tree (repo, base_tree, &err);
+	g_assert_no_error (err);
+
+	blob_id = ggit_repository_create_blob_from_buffer (repo, "two\n", 4, &err);
+	g_assert_no_error (err);
+
+	entry = ggit_tree_builder_insert (builder, "b", blob_id, GGIT_FILE_MODE_BLOB, &err);
+	g_assert_no_error (err);
+	ggit_tree_entry_unref (entry);
+
+	tree = ggit_tree_builder_write (builder, &err);
+	g_assert_no_error (err);
+
+	author = ggit_signature_new_now ("Test", "test@example.com", &err);
+	g_assert_no_error (err);
+
+	commit = ggit_repository_create_commit_from_ids (repo,
+	                                                 NULL,
+	                                                 author,
+	                                                 author,
+	                                                 NULL,
+	                                                 "topic",
+	                                                 tree,
+	                                                 &base,
+	                                                 1,
+	                                                 &err);
+	g_assert_no_error (err);
+
+	topic = ggit_repository_create_reference (repo, "refs/heads/topic", commit, "test", &err);
+	g_assert_no_error (err);
+
+	head = ggit_annotated_commit_new_from_ref (repo, topic, &err);
+	g_assert_no_error (err);
+
+	options = ggit_checkout_options_new ();
+	ggit_checkout_options_set_strategy (options, GGIT_CHECKOUT_SAFE);
+
+	ggit_repository_merge_async (repo,
+	                             &head,
+	                             1,
+	                             NULL,
+	                             options,
+	                             NULL,
+	                             on_async_ready,
+	                             &result);
+
+	object = ggit_repository_lookup (repo, commit, GGIT_TYPE_COMMIT, &err);
+	g_assert_no_error (err);
+	g_object_unref (object);
+
+	ggit_repository_merge_finish (repo, wait_async_result (&result), &err);
+	g_assert_no_error (err);
+
+	assert_test_file (git_dir, "a", "one\n");
+	assert_test_file (git_dir, "b", "two\n");
+
+	filename = g_build_filename (git_dir, ".git", "MERGE_HEAD", NULL);
+	g_file_get_contents (filename, &merge_head, NULL, &err);
+	g_assert_no_error (err);
+	hex = ggit_oid_to_string (commit);
+	g_assert (g_str_has_prefix (merge_head, hex));
+
+	g_free (hex);
+	g_free (merge_head);
+	g_free (filename);
+	g_object_unref (result);
+	g_object_unref (options);
+	ggit_annotated_commit_unref (head);
+	g_object_unref (topic);
+	g_object_unref (author);
+	g_object_unref (builder);
+	g_object_unref (base_tree);
+	ggit_oid_free (commit);
+	ggit_oid_free (tree);
+	ggit_oid_free (blob_id);
+	ggit_oid_free (base);
+	g_object_unref (repo);
+	g_object_unref (f);
+}
+
+static void
+test_repository_blame_async (const gchar *git_dir)
+{
+	GError *err = NULL;
+	GgitRepository *repo;
+	GgitRepository *bare;
+	GgitBlame *blame;
+	GAsyncResult *result = NULL;
+	GgitOId *commit;
+	GFile *f;
+	GFile *file;
+	GFile *outside;
+	gchar *path;
+
+	f = g_file_new_for_path (git_dir);
+	repo = ggit_repository_init_repository (f, FALSE, &err);
+	g_assert_no_error (err);
+
+	commit = commit_test_file (repo, git_dir, "a", "one\ntwo\n", NULL, 0);
+	set_test_head (repo, commit);
+
+	file = g_file_get_child (f, "a");
+
+	ggit_repository_blame_file_async (repo, file, NULL, NULL, on_async_ready, &result);
+
+	blame = ggit_repository_blame_file_finish (repo, wait_async_result (&result), &err);
+	g_assert_no_error (err);
+	g_assert_cmpuint (ggit_blame_get_hunk_count (blame), ==, 1);
+
+	g_object_unref (blame);
+	g_clear_object (&result);
+
+	/* a file outside of the working directory is an error, not a
+	 * NULL path handed to libgit2 */
+	outside = g_file_new_for_path (g_get_tmp_dir ());
+
+	blame = ggit_repository_blame_file (repo, outside, NULL, &err);
+	g_assert_error (err, G_IO_ERROR, G_IO_ERROR_NOT_FOUND);
+	g_assert (blame == NULL);
+	g_clear_error (&err);
+
+	ggit_repository_blame_file_async (repo, outside, NULL, NULL, on_async_ready, &result);
+
+	blame = ggit_repository_blame_file_finish (repo, wait_async_result (&result), &err);
+	g_assert_error (err, G_IO_ERROR, G_IO_ERROR_NOT_FOUND);
+	g_assert (blame == NULL);
+	g_clear_error (&err);
+	g_clear_object (&result);
+
+	/* and so is blaming in a bare repository */
+	path = g_build_filename (git_dir, "bare.git", NULL);
+	g_object_unref (f);
+	f = g_file_new_for_path (path);
+
+	bare = ggit_repository_init_repository (f, TRUE, &err);
+	g_assert_no_error (err);
+
+	blame = ggit_repository_blame_file (bare, file, NULL, &err);
+	g_assert_error (err, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED);
+	g_assert (blame == NULL);
+	g_clear_error (&err);
+
+	ggit_repository_blame_file_async (bare, file, NULL, NULL, on_async_ready, &result);
+
+	blame = ggit_repository_blame_file_finish (bare, wait_async_result (&result), &err);
+	g_assert_error (err, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED);
+	g_assert (blame == NULL);
+	g_clear_error (&err);
+	g_clear_object (&result);
+
+	g_object_unref (bare);
+	g_free (path);
+	g_object_unref (outside);
+	g_object_unref (file);
+	ggit_oid_free (commit);
+	g_object_unref (repo);
+	g_object_unref (f);
+}
+
+static void
+test_repository_status_async (const gchar *git_dir)
+{
+	GError *err = NULL;
+	GgitRepository *repo;
+	GAsyncResult *result = NULL;
+	GHashTable *statuses;
+	GgitOId *commit;
+	GFile *f;
+
+	f = g_file_new_for_path (git_dir);
+	repo = ggit_repository_init_repository (f, FALSE, &err);
+	g_assert_no_error (err);
+
+	commit = commit_test_file (repo, git_dir, "a", "one\n", NULL, 0);
+	set_test_head (repo, commit);
+
+	write_test_file (git_dir, "untracked");
+
+	ggit_repository_file_status_foreach_async (repo, NULL, NULL, on_async_ready, &result);
+
+	statuses = ggit_repository_file_status_foreach_finish (repo,
+	                                                       wait_async_result (&result),
+	                                                       &err);
+	g_assert_no_error (err);
+
+	g_assert_cmpuint (g_hash_table_size (statuses), ==, 1);
+	g_assert_cmpuint (GPOINTER_TO_UINT (g_hash_table_lookup (statuses, "untracked")), ==,
+	                  GGIT_STATUS_WORKING_TREE_NEW);
+
+	g_hash_table_unref (statuses);
+	g_object_unref (result);
+	ggit_oid_free (commit);
+	g_object_unref (repo);
+	g_object_unref (f);
+}
+
+/* Cancels its cancellable from the first checkout notification, so the
+ * checkout is cancelled from within libgit2 rather than before it starts.
+ */
+typedef struct
+{
+	GgitCheckoutOptions parent_instance;
+
+	GCancellable *cancellable;
+	guint n_notified;
+	guint n_progress;
+} TestCheckoutOptions;
+
+typedef struct
+{
+	GgitCheckoutOptionsClass parent_class;
+} TestCheckoutOptionsClass;
+
+GType test_checkout_options_get_type (void);
+
+G_DEFINE_TYPE (TestCheckoutOptions, test_checkout_options, GGIT_TYPE_CHECKOUT_OPTIONS)
+
+static gint
+test_checkout_options_notify (GgitCheckoutOptions     *options,
+                              GgitCheckoutNotifyFlags  why,
+                              const gchar             *path,
+                              GgitDiffFile            *baseline,
+                              GgitDiffFile            *target,
+                              GgitDiffFile            *workdir)
+{
+	TestCheckoutOptions *self = (TestCheckoutOptions *)options;
+
+	++self->n_notified;
+	g_cancellable_cancel (self->cancellable);
+
+	return 0;
+}
+
+static void
+test_checkout_options_progress (GgitCheckoutOptions *options,
+                                const gchar         *path,
+                                gsize                completed_steps,
+                                gsize                total_steps)
+{
+	TestCheckoutOptions *self = (TestCheckoutOptions *)options;
+
+	++self->n_progress;
+}
+
+static void
+test_checkout_options_finalize (GObject *object)
+{
+	TestCheckoutOptions *self = (TestCheckoutOptions *)object;
+
+	g_object_unref (self->cancellable);
+
+	G_OBJECT_CLASS (test_checkout_options_parent_class)->finalize (object);
+}
+
+static void
+test_checkout_options_class_init (TestCheckoutOptionsClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+	GgitCheckoutOptionsClass *options_class = GGIT_CHECKOUT_OPTIONS_CLASS (klass);
+
+	object_class->finalize = test_checkout_options_finalize;
+
+	options_class->notify = test_checkout_options_notify;
+	options_class->progress = test_checkout_options_progress;
+}
+
+static void
+test_checkout_options_init (TestCheckoutOptions *self)
+{
+	self->cancellable = g_cancellable_new ();
+}
+
+static void
+test_repository_checkout_async_cancel (const gchar *git_dir)
+{
+	GError *err = NULL;
+	GgitRepository *repo;
+	TestCheckoutOptions *options;
+	GgitTree *tree;
+	GAsyncResult *result = NULL;
+	GgitOId *one;
+	GgitOId *two;
+	GFile *f;
+	gboolean ret;
+
+	f = g_file_new_for_path (git_dir);
+	repo = ggit_repository_init_repository (f, FALSE, &err);
+	g_assert_no_error (err);
+
+	one = commit_test_files (repo, git_dir, "one\n", NULL);
+	two = commit_test_files (repo, git_dir, "two\n", one);
+	set_test_head (repo, two);
+
+	tree = lookup_commit_tree (repo, one);
+
+	options = g_object_new (test_checkout_options_get_type (), NULL);
+	ggit_checkout_options_set_strategy (GGIT_CHECKOUT_OPTIONS (options), GGIT_CHECKOUT_SAFE);
+	ggit_checkout_options_set_notify_flags (GGIT_CHECKOUT_OPTIONS (options),
+	                                        GGIT_CHECKOUT_NOTIFY_UPDATED);
+
+	ggit_repository_checkout_tree_async (repo,
+	                                     GGIT_OBJECT (tree),
+	                                     GGIT_CHECKOUT_OPTIONS (options),
+	                                     options->cancellable,
+	                                     on_async_ready,
+	                                     &result);
+
+	ret = ggit_repository_checkout_tree_finish (repo, wait_async_result (&result), &err);
+	g_assert_error (err, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+	g_assert (!ret);
+	g_clear_error (&err);
+
+	/* libgit2 stopped at the notification that followed the cancel,
+	 * before reporting progress or writing any file */
+	g_assert_cmpuint (options->n_notified, ==, 1);
+	g_assert_cmpuint (options->n_progress, ==, 0);
+
+	assert_test_file (git_dir, "a", "two\n");
+	assert_test_file (git_dir, "b", "two\n");
+	assert_test_file (git_dir, "c", "two\n");
+
+	g_object_unref (result);
+	g_object_unref (options);
+	g_object_unref (tree);
+	ggit_oid_free (one);
+	ggit_oid_free (two);
+	g_object_unref (repo);
+	g_object_unref (f);
+}
+
+/* Swaps the pack offsets of @a and @b in the only pack index of the
+ * repository, so that each id points to the content of the other.
+ */
+static void
+swap_pack_offsets (const gchar *git_dir,
+                   GgitOId     *a,
+                   GgitOId     *b)
+{
+	GError *err = NULL;
+	GDir *d;
+	gchar *path;
+	gchar *filename = NULL;
+	gchar *contents;
+	gsize length;
+	const gchar *name;
+	guint8 *data;
+	guint8 tmp[4];
+	guint32 n_objects;
+	guint32 pos[2] = { 0, 0 };
+	guint32 i;
+
+	path = g_build_filename (git_dir, ".git", "objects", "pack", NULL);
+	d = g_dir_open (path, 0, &err);
+	g_assert_no_error (err);
+
+	while ((name = g_dir_read_name (d)) != NULL)
+	{
+		if (g_str_has_suffix (name, ".idx"))
+		{
+			g_assert (filename == NULL);
+			filename = g_build_filename (path, name, NULL);
+		}
+	}
+
+	g_dir_close (d);
+	g_assert (filename != NULL);
+
+	g_file_get_contents (filename, &contents, &length, &err);
+	g_assert_no_error (err);
+
+	/* version 2: header, fan-out table, ids, crcs, offsets */
+	data = (guint8 *)contents;
+	g_assert (length > 8 + 256 * 4);
+	g_assert (memcmp (data, "\377tOc", 4) == 0);
+
+	memcpy (&n_objects, data + 8 + 255 * 4, 4);
+	n_objects = GUINT32_FROM_BE (n_objects);
+
+	for (i = 0; i < n_objects; ++i)
+	{
+		GgitOId *id;
+
+		id = ggit_oid_new_from_raw (data + 8 + 256 * 4 + i * 20);
+
+		if (ggit_oid_equal (id, a))
+		{
+			pos[0] = i;
+		}
+		else if (ggit_oid_equal (id, b))
+		{
+			pos[1] = i;
+		}
+
+		ggit_oid_free (id);
+	}
+
+	g_assert_cmpuint (pos[0], !=, pos[1]);
+
+	data += 8 + 256 * 4 + n_objects * (20 + 4);
+	memcpy (tmp, data + pos[0] * 4, 4);
+	memcpy (data + pos[0] * 4, data + pos[1] * 4, 4);
+	memcpy (data + pos[1] * 4, tmp, 4);
+
+	g_file_set_contents (filename, contents, length, &err);
+	g_assert_no_error (err);
+
+	g_free (contents);
+	g_free (filename);
+	g_free (path);
+}
+
+static void
+test_repository_open_blob_stream_corrupt (const gchar *git_dir)
+{
+	GFile *f;
+	GgitRepository *repo;
+	GgitOdb *odb;
+	GgitMempack *mempack;
+	GError *err = NULL;
+	GInputStream *stream;
+	GOutputStream *output;
+	GgitOId *a;
+	GgitOId *b;
+
+	f = g_file_new_for_path (git_dir);
+	repo = ggit_repository_init_repository (f, FALSE, &err);
+	g_object_unref (f);
+
+	g_assert_no_error (err);
+
+	odb = ggit_repository_get_odb (repo, &err);
+	g_assert_no_error (err);
+
+	mempack = ggit_mempack_new (&err);
+	g_assert_no_error (err);
+
+	ggit_odb_add_backend (odb, GGIT_ODB_BACKEND (mempack), 1000, &err);
+	g_assert_no_error (err);
+
+	/* same size, so only the id tells them apart */
+	a = ggit_repository_create_blob_from_buffer (repo, "aaaa\n", 5, &err);
+	g_assert_no_error (err);
+
+	b = ggit_repository_create_blob_from_buffer (repo, "bbbb\n", 5, &err);
+	g_assert_no_error (err);
+
+	ggit_mempack_write_pack (mempack, repo, &err);
+	g_assert_no_error (err);
+
+	swap_pack_offsets (git_dir, a, b);
+
+	stream = ggit_repository_open_blob_stream (repo, a, NULL, &err);
+	g_assert_no_error (err);
+	g_assert (stream != NULL);
+
+	output = g_memory_output_stream_new_resizable ();
+	g_output_stream_splice (output,
+	                        stream,
+	                        G_OUTPUT_STREAM_SPLICE_CLOSE_SOURCE |
+	                        G_OUTPUT_STREAM_SPLICE_CLOSE_TARGET,
+	                        NULL,
+	                        &err);
+	g_assert_error (err, G_IO_ERROR, G_IO_ERROR_INVALID_DATA);
+	g_clear_error (&err);
+
+	g_object_unref (output);
+	g_object_unref (stream);
+	ggit_oid_free (b);
+	ggit_oid_free (a);
+	g_object_unref (mempack);
+	g_object_unref (odb);
+	g_object_unref (repo);
+}
+
+static void
+assert_walk (GgitRepository  *repo,
+             GgitOId         *head,
+             GgitOId        **expected,
+             guint            n_expected)
+{
+	GError *err = NULL;
+	GgitRevisionWalker *walker;
+	GgitOId *oid;
+	guint i;
+
+	walker = new_test_walker (repo, head);
+
+	for (i = 0; i < n_expected; ++i)
+	{
+		oid = ggit_revision_walker_next (walker, &err);
+		g_assert_no_error (err);
+		g_assert (oid != NULL);
+		g_assert (ggit_oid_equal (oid, expected[i]));
+		ggit_oid_free (oid);
+	}
+
+	oid = ggit_revision_walker_next (walker, &err);
+	g_assert_no_error (err);
+	g_assert (oid == NULL);
+
+	g_object_unref (walker);
+}
+
+static void
+test_repository_commit_graph (const gchar *git_dir)
+{
+	GError *err = NULL;
+	GgitRepository *repo;
+	GgitRepository *reopened;
+	GgitConfig *config;
+	GgitOId *commits[5];
+	GgitOId *base;
+	GgitRef *ref;
+	GFile *f;
+	gchar *filename;
+	gsize ahead;
+	gsize behind;
+	gboolean ret;
+	gint i;
+
+	f = g_file_new_for_path (git_dir);
+	repo = ggit_repository_init_repository (f, FALSE, &err);
+	g_assert_no_error (err);
+
+	/* libgit2 only reads the commit-graph when this is enabled */
+	config = ggit_repository_get_config (repo, &err);
+	g_assert_no_error (err);
+
+	ggit_config_set_bool (config, "core.commitGraph", TRUE, &err);
+	g_assert_no_error (err);
+
+	/* 0 - 1 - 2 (master) - 4
+	 *  \
+	 *   3 (topic)
+	 */
+	commits[0] = commit_test_file (repo, git_dir, "a", "0\n", NULL, 0);
+	commits[1] = commit_test_file (repo, git_dir, "a", "1\n", &commits[0], 1);
+	commits[2] = commit_test_file (repo, git_dir, "a", "2\n", &commits[1], 1);
+	commits[3] = commit_test_file (repo, git_dir, "b", "3\n", &commits[0], 1);
+
+	set_test_head (repo, commits[2]);
+
+	ref = ggit_repository_create_reference (repo, "refs/heads/topic", commits[3], "test", &err);
+	g_assert_no_error (err);
+	g_object_unref (ref);
+
+	ret = ggit_repository_write_commit_graph (repo, &err);
+
+	if (g_error_matches (err, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED))
+	{
+		g_assert (!ret);
+		g_clear_error (&err);
+	}
+	else
+	{
+		g_assert_no_error (err);
+		g_assert (ret);
+
+		filename = g_build_filename (git_dir, ".git", "objects", "info", "commit-graph", NULL);
+		g_assert (g_file_test (filename, G_FILE_TEST_IS_REGULAR));
+		g_free (filename);
+	}
+
+	/* a commit the commit-graph does not know about */
+	commits[4] = commit_test_file (repo, git_dir, "a", "4\n", &commits[2], 1);
+
+	reopened = ggit_repository_open (f, &err);
+	g_assert_no_error (err);
+
+	ggit_repository_get_ahead_behind (reopened, commits[2], commits[3], &ahead, &behind, &err);
+	g_assert_no_error (err);
+	g_assert_cmpuint (ahead, ==, 2);
+	g_assert_cmpuint (behind, ==, 1);
+
+	ggit_repository_get_ahead_behind (reopened, commits[4], commits[3], &ahead, &behind, &err);
+	g_assert_no_error (err);
+	g_assert_cmpuint (ahead, ==, 3);
+	g_assert_cmpuint (behind, ==, 1);
+
+	g_assert (ggit_repository_get_descendant_of (reopened, commits[4], commits[0], &err));
+	g_assert_no_error (err);
+	g_assert (!ggit_repository_get_descendant_of (reopened, commits[3], commits[1], &err));
+	g_assert_no_error (err);
+
+	base = ggit_repository_merge_base (reopened, commits[4], commits[3], &err);
+	g_assert_no_error (err);
+	g_assert (ggit_oid_equal (base, commits[0]));
+	ggit_oid_free (base);
+
+	{
+		GgitOId *expected[] = { commits[4], commits[2], commits[1], commits[0] };
+
+		assert_walk (reopened, commits[4], expected, G_N_ELEMENTS (expected));
+	}
+
+	for (i = 0; i < 5; ++i)
+	{
+		ggit_oid_free (commits[i]);
+	}
+
+	g_object_unref (reopened);
+	g_object_unref (config);
+	g_object_unref (repo);
+	g_object_unref (f);
+}
+
+static void
+test_repository_patch_encoding (const gchar *git_dir)
+{
+	GFile *f;
+	GgitRepository *repo;
+	GError *err = NULL;
+	GgitDiff *diff;
+	GgitPatch *patch;
+	GgitDiffLine *line;
+	gchar *filename;
+	gchar **text;
+
+	f = g_file_new_for_path (git_dir);
+	repo = ggit_repository_init_repository (f, FALSE, &err);
+	g_object_unref (f);
+
+	g_assert_no_error (err);
+
+	filename = g_build_filename (git_dir, ".gitattributes", NULL);
+	g_file_set_contents (filename, "a.txt encoding=ISO-8859-1\n", -1, &err);
+	g_assert_no_error (err);
+	g_free (filename);
+
+	stage_test_file (repo, git_dir, "a.txt", "caf\xe9\n");
+
+	filename = g_build_filename (git_dir, "a.txt", NULL);
+	g_file_set_contents (filename, "th\xe9\n", -1, &err);
+	g_assert_no_error (err);
+	g_free (filename);
+
+	diff = ggit_diff_new_index_to_workdir (repo, NULL, NULL, &err);
+	g_assert_no_error (err);
+	g_assert_cmpuint (ggit_diff_get_num_deltas (diff), ==, 1);
+
+	patch = ggit_patch_new_from_diff (diff, 0, &err);
+	g_assert_no_error (err);
+	g_assert_cmpint (ggit_patch_get_num_lines_in_hunk (patch, 0), ==, 2);
+
+	/* the lines are converted from the encoding of the file */
+	line = ggit_patch_get_line_in_hunk (patch, 0, 0, &err);
+	g_assert_no_error (err);
+	g_assert_cmpstr (ggit_diff_line_get_text (line), ==, "caf\xc3\xa9\n");
+	ggit_diff_line_unref (line);
+
+	line = ggit_patch_get_line_in_hunk (patch, 0, 1, &err);
+	g_assert_no_error (err);
+	g_assert_cmpstr (ggit_diff_line_get_text (line), ==, "th\xc3\xa9\n");
+	ggit_diff_line_unref (line);
+
+	/* and so is the text of a whole hunk */
+	text = ggit_patch_get_hunk_text (patch, 0, &err);
+	g_assert_no_error (err);
+	g_assert_cmpuint (g_strv_length (text), ==, 2);
+	g_assert_cmpstr (text[0], ==, "caf\xc3\xa9\n");
+	g_assert_cmpstr (text[1], ==, "th\xc3\xa9\n");
+	g_strfreev (text);
+
+	ggit_patch_unref (patch);
+	g_object_unref (diff);
+	g_object_unref (repo);
+}
+
+typedef struct
+{
+	GgitDiffDelta *delta;
+	GgitDiffHunk *hunk;
+	GString *seen;
+} WrapperReuseData;
+
+static gint
+reuse_file_cb (GgitDiffDelta *delta,
+               gfloat         progress,
+               gpointer       user_data)
+{
+	WrapperReuseData *data = user_data;
+
+	data->delta = delta;
+	data->hunk = NULL;
+
+	return 0;
+}
+
+static gint
+reuse_binary_cb (GgitDiffDelta  *delta,
+                 GgitDiffBinary *binary,
+                 gpointer        user_data)
+{
+	return 0;
+}
+
+static gint
+reuse_hunk_cb (GgitDiffDelta *delta,
+               GgitDiffHunk  *hunk,
+               gpointer       user_data)
+{
+	WrapperReuseData *data = user_data;
+	GgitDiffFile *file;
+
+	g_assert (delta == data->delta);
+	data->hunk = hunk;
+
+	file = ggit_diff_delta_get_new_file (delta);
+	g_string_append_printf (data->seen, "%s@%d ",
+	                        ggit_diff_file_get_path (file),
+	                        ggit_diff_hunk_get_new_start (hunk));
+
+	return 0;
+}
+
+static gint
+reuse_line_cb (GgitDiffDelta *delta,
+               GgitDiffHunk  *hunk,
+               GgitDiffLine  *line,
+               gpointer       user_data)
+{
+	WrapperReuseData *data = user_data;
+
+	/* all callbacks of a delta and hunk get the same wrappers */
+	g_assert (delta == data->delta);
+	g_assert (hunk == data->hunk);
+
+	if (ggit_diff_line_get_origin (line) == GGIT_DIFF_LINE_ADDITION)
+	{
+		g_string_append (data->seen, ggit_diff_line_get_text (line));
+	}
+
+	return 0;
+}
+
+static void
+test_repository_diff_wrapper_reuse (const gchar *git_dir)
+{
+	GFile *f;
+	GgitRepository *repo;
+	GgitDiff *diff;
+	GgitTree *trees[2];
+	GError *err = NULL;
+	GgitOId *oids[4];
+	WrapperReuseData data = { NULL, };
+	guint i;
+
+	f = g_file_new_for_path (git_dir);
+	repo = ggit_repository_init_repository (f, FALSE, &err);
+	g_object_unref (f);
+
+	g_assert_no_error (err);
+
+	/* two files with two hunks each */
+	oids[0] = commit_test_file (repo, git_dir, "a.txt",
+	                            "1\n2\n3\n4\n5\n6\n7\n8\n9\n10\n11\n12\n",
+	                            NULL, 0);
+	oids[1] = commit_test_file (repo, git_dir, "b.txt",
+	                            "1\n2\n3\n4\n5\n6\n7\n8\n9\n10\n11\n12\n",
+	                            &oids[0], 1);
+	oids[2] = commit_test_file (repo, git_dir, "a.txt",
+	                            "one\n2\n3\n4\n5\n6\n7\n8\n9\n10\n11\ntwelve\n",
+	                            &oids[1], 1);
+	oids[3] = commit_test_file (repo, git_dir, "b.txt",
+	                            "uno\n2\n3\n4\n5\n6\n7\n8\n9\n10\n11\ndoce\n",
+	                            &oids[2], 1);
+
+	trees[0] = lookup_commit_tree (repo, oids[1]);
+	trees[1] = lookup_commit_tree (repo, oids[3]);
+
+	diff = ggit_diff_new_tree_to_tree (repo, trees[0], trees[1], NULL, &err);
+	g_assert_no_error (err);
+
+	data.seen = g_string_new (NULL);
+
+	ggit_diff_foreach (diff,
+	                   reuse_file_cb,
+	                   reuse_binary_cb,
+	                   reuse_hunk_cb,
+	                   reuse_line_cb,
+	                   (gpointer)&data,
+	                   &err);
+	g_assert_no_error (err);
+
+	/* and they still describe the current delta and hunk */
+	g_assert_cmpstr (data.seen->str, ==,
+	                 "a.txt@1 one\n"
+	                 "a.txt@9 twelve\n"
+	                 "b.txt@1 uno\n"
+	                 "b.txt@9 doce\n");
+
+	g_string_free (data.seen, TRUE);
+
+	g_object_unref (diff);
+	g_object_unref (trees[0]);
+	g_object_unref (trees[1]);
+
+	for (i = 0; i < G_N_ELEMENTS (oids); ++i)
+	{
+		ggit_oid_free (oids[i]);
+	}
+
+	g_object_unref (repo);
+}
+
+static void
+test_repository_status_parallel (const gchar *git_dir)
+{
+	GFile *f;
+	GgitRepository *repo;
+	GgitIndex *index;
+	GError *err = NULL;
+	gchar *status;
+
+	f = g_file_new_for_path (git_dir);
+	repo = ggit_repository_init_repository (f, FALSE, &err);
+	g_object_unref (f);
+
+	g_assert_no_error (err);
+
+	write_test_file (git_dir, "a.txt");
+	write_test_file (git_dir, "dir/b.txt");
+	write_test_file (git_dir, "dir/sub/c.txt");
+	write_test_file (git_dir, "other/d.txt");
+
+	index = ggit_repository_get_index (repo, &err);
+	g_assert_no_error (err);
+
+	ggit_index_add_path (index, "dir/b.txt", &err);
+	g_assert_no_error (err);
+
+	ggit_index_write (index, &err);
+	g_assert_no_error (err);
+
+	assert_parallel_status (repo);
+
+	/* a new file must invalidate the cache of its directory */
+	write_test_file (git_dir, "other/e.txt");
+	assert_parallel_status (repo);
+
+	/* an untracked file only known to the cache is reported as long as
+	 * the stamps of its directory do not change, which shows that the
+	 * directory was not scanned again */
+	add_cached_untracked_file (git_dir, "other", "other/ghost.txt");
+
+	status = collect_parallel_status (repo, TRUE);
+	g_assert (strstr (status, "other/ghost.txt:") != NULL);
+	g_free (status);
+
+	status = collect_parallel_status (repo, FALSE);
+	g_assert (strstr (status, "other/ghost.txt:") == NULL);
+	g_free (status);
+
+	write_test_file (git_dir, "other/sub/f.txt");
+
+	status = collect_parallel_status (repo, TRUE);
+	g_assert (strstr (status, "other/ghost.txt:") == NULL);
+	g_assert (strstr (status, "other/sub/f.txt:") != NULL);
+	g_free (status);
+
+	g_object_unref (index);
+	g_object_unref (repo);
+}
+
 int
 main (int    argc,
       char **argv)
@@ -375,8 +4549,44 @@ main (int    argc,
 
 	TEST ("init", init);
 	TEST ("init-bare", init_bare);
+	TEST ("open-async", open_async);
 	TEST ("blob-stream", blob_stream);
 	TEST ("encoding", encoding);
+	TEST ("shorten-oids", shorten_oids);
+	TEST ("status-parallel", status_parallel);
+	TEST ("patch-line", patch_line);
+	TEST ("read-many", read_many);
+	TEST ("odb", odb);
+	TEST ("odb-backend", odb_backend);
+	TEST ("shorten-oids-backend", shorten_oids_backend);
+	TEST ("oid-set", oid_set);
+	TEST ("oid-map", oid_map);
+	TEST ("oid-array", oid_array);
+	TEST ("diff-parallel", diff_parallel);
+	TEST ("revision-walker-batch", revision_walker_batch);
+	TEST ("revision-walker-batch-error", revision_walker_batch_error);
+	TEST ("tree-walk-pathspec", tree_walk_pathspec);
+	TEST ("manifest", manifest);
+	TEST ("index-add-paths", index_add_paths);
+	TEST ("index-snapshot", index_snapshot);
+	TEST ("status-monitor", status_monitor);
+	TEST ("status-list", status_list);
+	TEST ("open-blob-stream", open_blob_stream);
+	TEST ("convert-utf8", convert_utf8);
+	TEST ("commit-info", commit_info);
+	TEST ("log-pipeline", log_pipeline);
+	TEST ("log-pipeline-error", log_pipeline_error);
+	TEST ("revision-walker-paths", revision_walker_paths);
+	TEST ("clone-async", clone_async);
+	TEST ("checkout-async", checkout_async);
+	TEST ("merge-async", merge_async);
+	TEST ("blame-async", blame_async);
+	TEST ("status-async", status_async);
+	TEST ("checkout-async-cancel", checkout_async_cancel);
+	TEST ("open-blob-stream-corrupt", open_blob_stream_corrupt);
+	TEST ("commit-graph", commit_graph);
+	TEST ("patch-encoding", patch_encoding);
+	TEST ("diff-wrapper-reuse", diff_wrapper_reuse);
 
 	return g_test_run ();
 }